@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+This writes a .bgi index for a .bgen file, with the same SQLite schema
+(WITHOUT ROWID Variant table, plus Metadata table) as bgenix.  Layouts 1 and
+2 are supported.
+"""
+
+import argparse
+import os
+import sqlite3
+import struct
+import time
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-b', '--bgen', type=str, required=True,
+                             help="Full .bgen filename.")
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Full .bgi filename.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def read_str(bgen_file, len_blen):
+    if len_blen == 2:
+        slen = struct.unpack('<H', bgen_file.read(2))[0]
+    else:
+        slen = struct.unpack('<I', bgen_file.read(4))[0]
+    return bgen_file.read(slen).decode('ascii')
+
+
+def scan_variants(bgen_fname):
+    """
+    Yields (chromosome, position, rsid, alleles, file_start_position,
+    size_in_bytes) for each variant.
+    """
+    with open(bgen_fname, 'rb') as bgen_file:
+        variant_data_offset = struct.unpack('<I', bgen_file.read(4))[0] + 4
+        header_blen, variant_ct, sample_ct = struct.unpack('<III', bgen_file.read(12))
+        bgen_file.seek(header_blen)
+        flags = struct.unpack('<I', bgen_file.read(4))[0]
+        compression = flags & 3
+        layout = (flags >> 2) & 15
+        bgen_file.seek(variant_data_offset)
+        for _ in range(variant_ct):
+            start = bgen_file.tell()
+            if layout == 1:
+                bgen_file.read(4)
+            read_str(bgen_file, 2)
+            rsid = read_str(bgen_file, 2)
+            chrom = read_str(bgen_file, 2)
+            pos = struct.unpack('<I', bgen_file.read(4))[0]
+            if layout == 1:
+                allele_ct = 2
+            else:
+                allele_ct = struct.unpack('<H', bgen_file.read(2))[0]
+            alleles = [read_str(bgen_file, 4) for _ in range(allele_ct)]
+            if layout == 1 and not compression:
+                geno_blen = 6 * sample_ct
+            else:
+                geno_blen = struct.unpack('<I', bgen_file.read(4))[0]
+            bgen_file.seek(geno_blen, os.SEEK_CUR)
+            yield (chrom, pos, rsid, alleles, start, bgen_file.tell() - start)
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    bgen_fname = cmd_args.bgen
+    if os.path.exists(cmd_args.out):
+        os.remove(cmd_args.out)
+    conn = sqlite3.connect(cmd_args.out)
+    conn.execute('CREATE TABLE Variant ( chromosome TEXT NOT NULL, position INT NOT NULL, rsid TEXT NOT NULL, number_of_alleles INT NOT NULL, allele1 TEXT NOT NULL, allele2 TEXT NULL, file_start_position INT NOT NULL, size_in_bytes INT NOT NULL, PRIMARY KEY (chromosome, position, rsid, allele1, allele2, file_start_position ) ) WITHOUT ROWID')
+    conn.execute('CREATE TABLE Metadata ( filename TEXT NOT NULL, file_size INT NOT NULL, last_write_time INT NOT NULL, first_1000_bytes BLOB NOT NULL, index_creation_time INT NOT NULL )')
+    with open(bgen_fname, 'rb') as bgen_file:
+        first_1000_bytes = bgen_file.read(1000)
+    bgen_stat = os.stat(bgen_fname)
+    conn.execute('INSERT INTO Metadata VALUES (?, ?, ?, ?, ?)', (bgen_fname, bgen_stat.st_size, int(bgen_stat.st_mtime), first_1000_bytes, int(time.time())))
+    for chrom, pos, rsid, alleles, start, blen in scan_variants(bgen_fname):
+        conn.execute('INSERT INTO Variant VALUES (?, ?, ?, ?, ?, ?, ?, ?)', (chrom, pos, rsid, len(alleles), alleles[0], alleles[1] if len(alleles) > 1 else None, start, blen))
+    conn.commit()
+    conn.close()
+
+
+if __name__ == '__main__':
+    main()
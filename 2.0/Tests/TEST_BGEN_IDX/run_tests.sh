@@ -0,0 +1,56 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Skipped unless python3 has the sqlite3 module.
+if ! python3 -c 'import sqlite3' 2> /dev/null; then
+    echo "python3 sqlite3 module not found; skipping TEST_BGEN_IDX." >&2
+    exit 0
+fi
+
+# Three chromosomes of 1000 variants each, so that the .bgi's Variant b-tree
+# has interior pages, and a chromosome filter leaves one or two runs of
+# variants to read.
+$1/plink2 $2 $3 --dummy 30 3000 0.1 acgt dosage-freq=0.3 phase-freq=0.2 --out tmp_dummy
+awk 'BEGIN{FS="\t"; OFS="\t"} /^#/ {print; next} {$1 = 1 + int($2 / 1000); $2 = 10000 + 10 * $2; print}' tmp_dummy.pvar > tmp_data.pvar
+cp tmp_dummy.pgen tmp_data.pgen
+cp tmp_dummy.psam tmp_data.psam
+
+for fmt in bgen-1.1 bgen-1.2 bgen-1.3
+do
+    $1/plink2 $2 $3 --pfile tmp_data --export $fmt --out tmp_${fmt}
+    # Copy before indexing, so the index is newer than its data file.
+    cp tmp_${fmt}.bgen tmp_${fmt}_idx.bgen
+    python3 make_bgi.py -b tmp_${fmt}_idx.bgen -o tmp_${fmt}_idx.bgen.bgi
+    for filter in "--chr 2" "--chr 1,3" "--not-chr 1"
+    do
+        $1/plink2 $2 $3 --bgen tmp_${fmt}.bgen ref-first --sample tmp_${fmt}.sample $filter --make-pgen --out plain
+        $1/plink2 $2 $3 --bgen tmp_${fmt}_idx.bgen ref-first --sample tmp_${fmt}.sample $filter --make-pgen --out idx
+        grep -q "^--bgen: Using tmp_${fmt}_idx.bgen.bgi to skip" idx.log
+        diff -q plain.pgen idx.pgen
+        diff -q plain.pvar idx.pvar
+        diff -q plain.psam idx.psam
+    done
+done
+
+# Problems with the index file must produce a warning, and a full scan with
+# identical results.
+cp tmp_bgen-1.2.bgen tmp_bad.bgen
+$1/plink2 $2 $3 --bgen tmp_bad.bgen ref-first --sample tmp_bgen-1.2.sample --chr 2 --make-pgen --out plain
+# Truncated .bgi.
+head -c 20000 tmp_bgen-1.2_idx.bgen.bgi > tmp_bad.bgen.bgi
+$1/plink2 $2 $3 --bgen tmp_bad.bgen ref-first --sample tmp_bgen-1.2.sample --chr 2 --make-pgen --out bad
+grep -q "^Warning: tmp_bad.bgen.bgi is not a valid index for tmp_bad.bgen." bad.log
+diff -q plain.pgen bad.pgen
+diff -q plain.pvar bad.pvar
+# Garbage after a valid SQLite header.
+head -c 100 tmp_bgen-1.2_idx.bgen.bgi > tmp_bad.bgen.bgi
+head -c $(( $(wc -c < tmp_bgen-1.2_idx.bgen.bgi) - 100 )) /dev/urandom >> tmp_bad.bgen.bgi
+$1/plink2 $2 $3 --bgen tmp_bad.bgen ref-first --sample tmp_bgen-1.2.sample --chr 2 --make-pgen --out bad
+grep -q "^Warning: tmp_bad.bgen.bgi is not a valid index for tmp_bad.bgen." bad.log
+diff -q plain.pgen bad.pgen
+# Index for a different .bgen.
+cp tmp_bgen-1.3_idx.bgen.bgi tmp_bad.bgen.bgi
+$1/plink2 $2 $3 --bgen tmp_bad.bgen ref-first --sample tmp_bgen-1.2.sample --chr 2 --make-pgen --out bad
+grep -q "^Warning: tmp_bad.bgen.bgi is not a valid index for tmp_bad.bgen." bad.log
+diff -q plain.pgen bad.pgen
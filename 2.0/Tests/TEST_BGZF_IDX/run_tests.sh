@@ -0,0 +1,67 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Skipped unless bgzip, tabix, and bcftools are in the system PATH.
+for tool in bgzip tabix bcftools
+do
+    if ! command -v $tool > /dev/null; then
+        echo "$tool not found; skipping TEST_BGZF_IDX." >&2
+        exit 0
+    fi
+done
+
+# Indexed VCF/BCF import must yield the same variants as a full scan, for
+# --chr alone and with --from-bp/--to-bp.  Three copies of the 1kg chr21
+# sample, relabeled as chromosomes 20-22, with positions spread out so that a
+# range covers several 16 KiB linear-index windows and bgzf blocks.
+gunzip -c ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz > tmp_1kg.vcf
+grep '^#' tmp_1kg.vcf > tmp_multi.vcf
+for c in 20 21 22
+do
+    grep -v '^#' tmp_1kg.vcf | awk -v c=$c 'BEGIN{FS="\t"; OFS="\t"} {$1 = c; $2 = ($2 - 9411000) * 100; print}' >> tmp_multi.vcf
+done
+bgzip -c tmp_multi.vcf > tmp_plain.vcf.gz
+
+# Copy before indexing, so no index is older than its data file.
+cp tmp_plain.vcf.gz tmp_tbi.vcf.gz
+cp tmp_plain.vcf.gz tmp_csi.vcf.gz
+tabix -p vcf tmp_tbi.vcf.gz
+tabix -C -p vcf tmp_csi.vcf.gz
+
+$1/plink2 $2 $3 --vcf tmp_plain.vcf.gz --double-id --export bcf --out tmp_plain
+cp tmp_plain.bcf tmp_csi.bcf
+bcftools index -c tmp_csi.bcf
+
+i=0
+for filt in "--chr 21" "--chr 21 --from-bp 300000 --to-bp 900000" "--chr 22 --from-bp 650000" "--chr 20 --to-bp 400000"
+do
+    i=$((i+1))
+    $1/plink2 $2 $3 --vcf tmp_plain.vcf.gz --double-id $filt --export vcf --out plain_vcf$i
+    for idx in tbi csi
+    do
+        $1/plink2 $2 $3 --vcf tmp_$idx.vcf.gz --double-id $filt --export vcf --out ${idx}_vcf$i
+        grep -q "Using tmp_$idx.vcf.gz.$idx" ${idx}_vcf$i.log
+        diff -q plain_vcf$i.vcf ${idx}_vcf$i.vcf
+    done
+    $1/plink2 $2 $3 --bcf tmp_plain.bcf $filt --export vcf --out plain_bcf$i
+    $1/plink2 $2 $3 --bcf tmp_csi.bcf $filt --export vcf --out csi_bcf$i
+    grep -q "Using tmp_csi.bcf.csi" csi_bcf$i.log
+    diff -q plain_bcf$i.vcf csi_bcf$i.vcf
+done
+
+# After an index seek, errors identify the record by its position among the
+# records read, not by a (wrong) line number.
+grep '^#' tmp_multi.vcf > tmp_bad.vcf
+grep -v '^#' tmp_multi.vcf | awk 'BEGIN{FS="\t"; OFS="\t"} {if (($1 == 21) && ($2 > 500000) && (!done)) {$10 = "0|X"; done = 1} print}' >> tmp_bad.vcf
+bgzip -c tmp_bad.vcf > tmp_bad.vcf.gz
+tabix -p vcf tmp_bad.vcf.gz
+if $1/plink2 $2 $3 --vcf tmp_bad.vcf.gz --double-id --chr 21 --from-bp 300000 --to-bp 900000 --export vcf --out bad_idx; then
+    exit 1
+fi
+grep -q "Error: Record [0-9]* of --vcf file read via its index has an invalid GT field." bad_idx.log
+rm tmp_bad.vcf.gz.tbi
+if $1/plink2 $2 $3 --vcf tmp_bad.vcf.gz --double-id --chr 21 --from-bp 300000 --to-bp 900000 --export vcf --out bad_noidx; then
+    exit 1
+fi
+grep -q "Error: Line [0-9]* of --vcf file has an invalid GT field." bad_noidx.log
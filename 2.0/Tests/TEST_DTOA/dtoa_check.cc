@@ -0,0 +1,43 @@
+// Reads one decimal number per line from stdin, and prints it back followed
+// by its dtoa_g() and dtoa_g_p8() renderings, tab-separated.  The input is
+// parsed with strtod(), so denormals come through exactly.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/plink2_string.h"
+
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+int32_t DtoaCheckMain() {
+  char line[256];
+  char outbuf[768];
+  while (fgets(line, 256, stdin)) {
+    char* line_end = &(line[strcspn(line, "\r\n")]);
+    *line_end = '\0';
+    char* endptr;
+    const double dxx = strtod(line, &endptr);
+    if ((endptr == line) || (*endptr != '\0')) {
+      fprintf(stderr, "Invalid input line '%s'.\n", line);
+      return 1;
+    }
+    char* write_iter = strcpyax(outbuf, line, '\t');
+    write_iter = dtoa_g(dxx, write_iter);
+    *write_iter++ = '\t';
+    write_iter = dtoa_g_p8(dxx, write_iter);
+    AppendBinaryEoln(&write_iter);
+    fwrite(outbuf, 1, write_iter - outbuf, stdout);
+  }
+  return 0;
+}
+
+#ifdef __cplusplus
+}  // namespace plink2
+#endif
+
+int main() {
+  return plink2::DtoaCheckMain();
+}
@@ -0,0 +1,12 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Exact dtoa_g()/dtoa_g_p8() output for negative, zero, and denormal values,
+# and at the 6- and 8-significant-digit rounding boundaries.  plink2 flushes
+# denormal results to zero, so the denormal cases can't be reached through a
+# plink2 command; dtoa_check is built directly against include/ instead.
+# Output must match printf's %.6g and %.8g, except that -0 is printed as 0.
+${CXX:-g++} -std=c++11 -O2 dtoa_check.cc ../../include/plink2_string.cc ../../include/plink2_base.cc -o tmp_dtoa_check
+cut -f 1 expected.txt | ./tmp_dtoa_check > tmp_dtoa_out.txt
+diff -q expected.txt tmp_dtoa_out.txt
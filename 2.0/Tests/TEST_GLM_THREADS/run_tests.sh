@@ -0,0 +1,15 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Linear --glm without covariates takes the sparse-genotype path in
+# GlmLinearThread(), and its results must not depend on the thread count.
+# --threads is set explicitly below, so $2/$3 are only passed to the data
+# generation step.
+$1/plink2 $2 $3 --dummy 300 5000 0.05 scalar-pheno --make-pgen --out tmp_data
+for t in 1 2 4
+do
+    $1/plink2 --threads $t --pfile tmp_data --glm allow-no-covars --out glm_t$t
+done
+diff -q glm_t1.PHENO1.glm.linear glm_t2.PHENO1.glm.linear
+diff -q glm_t1.PHENO1.glm.linear glm_t4.PHENO1.glm.linear
@@ -0,0 +1,27 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# --make-king output must not depend on the thread count or on '--threads
+# numa'.  (On a single-NUMA-node machine, 'numa' leaves the per-node genotype
+# block replicas disabled, so only worker placement and the first-touch row
+# partition are exercised.)  --threads is set explicitly below, so $2/$3 are
+# only passed to the data generation step.
+$1/plink2 $2 $3 --dummy 600 3000 0.05 --make-pgen --out tmp_data
+for t in "1" "4" "4 numa"
+do
+    suffix=$(echo $t | tr ' ' '_')
+    $1/plink2 --threads $t --pfile tmp_data --make-king triangle bin --out king_t$suffix
+done
+cmp king_t1.king.bin king_t4.king.bin
+cmp king_t1.king.bin king_t4_numa.king.bin
+
+# 10000 samples don't fit in one pass with --memory 640.
+$1/plink2 $2 $3 --dummy 10000 300 0.05 --make-pgen --out tmp_big
+for t in "1" "4 numa"
+do
+    suffix=$(echo $t | tr ' ' '_')
+    $1/plink2 --threads $t --memory 640 --pfile tmp_big --make-king triangle bin --out king_big_t$suffix
+    grep -q "^--make-king pass 2/2" king_big_t$suffix.log
+done
+cmp king_big_t1.king.bin king_big_t4_numa.king.bin
@@ -0,0 +1,122 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# More than two vblocks, so that zstd-mode block loads can span several
+# frames.
+$1/plink2 $2 $3 --dummy 40 150000 0.01 --out tmp_data
+
+# pgen_compress -z: the zstd-mode file must decode to the same genotypes.
+$1/pgen_compress -z tmp_data.pgen tmp_zstd.pgen
+cp tmp_data.pvar tmp_zstd.pvar
+cp tmp_data.psam tmp_zstd.psam
+$1/plink2 $2 $3 --pfile tmp_zstd --make-pgen --out zstd_roundtrip
+diff -q tmp_data.pgen zstd_roundtrip.pgen
+$1/plink2 $2 $3 --pfile tmp_data --freq --geno-counts --out plain_freq
+$1/plink2 $2 $3 --pfile tmp_zstd --freq --geno-counts --out zstd_freq
+diff -q plain_freq.afreq zstd_freq.afreq
+diff -q plain_freq.gcount zstd_freq.gcount
+
+# --clump loads byte ranges which cross vblock boundaries, so this exercises
+# parallel frame decompression.
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars --out glm
+$1/plink2 $2 $3 --pfile tmp_data --clump glm.PHENO1.glm.logistic.hybrid --clump-p1 0.01 --clump-p2 0.05 --out plain_clump
+$1/plink2 $2 $3 --pfile tmp_zstd --clump glm.PHENO1.glm.logistic.hybrid --clump-p1 0.01 --clump-p2 0.05 --out zstd_clump
+diff -q plain_clump.clumps zstd_clump.clumps
+
+# Phased data, with a sample subset.
+$1/plink2 $2 $3 --vcf ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz --double-id --out tmp_phased
+$1/pgen_compress -z tmp_phased.pgen tmp_phased_zstd.pgen 19
+cp tmp_phased.pvar tmp_phased_zstd.pvar
+cp tmp_phased.psam tmp_phased_zstd.psam
+$1/plink2 $2 $3 --pfile tmp_phased_zstd --make-pgen --out phased_roundtrip
+diff -q tmp_phased.pgen phased_roundtrip.pgen
+$1/plink2 $2 $3 --pfile tmp_phased --thin-indiv 0.5 --seed 1 --export vcf --out plain_subset
+$1/plink2 $2 $3 --pfile tmp_phased_zstd --thin-indiv 0.5 --seed 1 --export vcf --out zstd_subset
+diff -q <(tail -n +3 plain_subset.vcf) <(tail -n +3 zstd_subset.vcf)
+
+# pgen_compress -p: PBWT-mode phase.  Six position-shifted copies of the 1kg
+# sample, so that haplotype-order replay crosses several reset points.
+# (pgen_compress doesn't preserve the nonref flags, so INFO is ignored.)
+gunzip -c ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz | grep '^#' > tmp_rep.vcf
+for k in 0 1 2 3 4 5; do
+  gunzip -c ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz | grep -v '^#' | awk -v k=$k 'BEGIN{OFS="\t"} {$2 += k * 1000000; $3 = $3 "_" k; print}' >> tmp_rep.vcf
+done
+$1/plink2 $2 $3 --vcf tmp_rep.vcf --double-id --out tmp_rep
+$1/pgen_compress -p tmp_rep.pgen tmp_rep_pbwt.pgen
+$1/pgen_compress -z tmp_rep_pbwt.pgen tmp_rep_pbwt_zstd.pgen
+for suffix in pbwt pbwt_zstd; do
+  cp tmp_rep.pvar tmp_rep_${suffix}.pvar
+  cp tmp_rep.psam tmp_rep_${suffix}.psam
+done
+$1/plink2 $2 $3 --pfile tmp_rep --export vcf --out rep_plain
+$1/plink2 $2 $3 --pfile tmp_rep --chr 21 --from-bp 10500000 --to-bp 13000000 --thin-indiv 0.5 --seed 1 --export vcf --out rep_plain_subset
+for suffix in pbwt pbwt_zstd; do
+  $1/plink2 $2 $3 --pfile tmp_rep_${suffix} --export vcf --out rep_${suffix}
+  diff -q <(grep -v '^#' rep_plain.vcf | cut -f 1-7,9-) <(grep -v '^#' rep_${suffix}.vcf | cut -f 1-7,9-)
+  $1/plink2 $2 $3 --pfile tmp_rep_${suffix} --chr 21 --from-bp 10500000 --to-bp 13000000 --thin-indiv 0.5 --seed 1 --export vcf --out rep_${suffix}_subset
+  diff -q <(grep -v '^#' rep_plain_subset.vcf | cut -f 1-7,9-) <(grep -v '^#' rep_${suffix}_subset.vcf | cut -f 1-7,9-)
+done
+
+# LD-window mode.  Each pair of 1kg variants (A, B) is followed by slightly
+# perturbed copies (A', B'), so A' is LD-compressed against the non-adjacent
+# base A.
+gunzip -c ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz | grep '^#' > tmp_interleaved.vcf
+gunzip -c ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz | grep -v '^#' | awk 'BEGIN{OFS="\t"} {if (NR % 2) {a = $0; next} n = split(a, x, "\t"); print a; print; x[2] = $2; x[3] = x[3] "_b"; x[10] = "1|1"; s = x[1]; for (i = 2; i <= n; ++i) {s = s "\t" x[i]} print s; $3 = $3 "_b"; $11 = "1|1"; print}' >> tmp_interleaved.vcf
+$1/plink2 $2 $3 --vcf tmp_interleaved.vcf --double-id --out tmp_interleaved
+$1/plink2 $2 $3 --pfile tmp_interleaved --make-pgen ld-window --out tmp_ldwin
+$1/pgen_compress -z tmp_ldwin.pgen tmp_ldwin_zstd.pgen
+cp tmp_ldwin.pvar tmp_ldwin_zstd.pvar
+cp tmp_ldwin.psam tmp_ldwin_zstd.psam
+$1/plink2 $2 $3 --pfile tmp_interleaved --make-pgen --out ldwin_plain
+for prefix in tmp_ldwin tmp_ldwin_zstd; do
+  $1/plink2 $2 $3 --pfile ${prefix} --make-pgen --out ${prefix}_roundtrip
+  diff -q ldwin_plain.pgen ${prefix}_roundtrip.pgen
+done
+for filter in "--thin 0.3 --seed 3" "--chr 21 --from-bp 9412835 --to-bp 9419241 --thin-indiv 0.5 --seed 4"; do
+  $1/plink2 $2 $3 --pfile tmp_interleaved $filter --export vcf --freq --geno-counts --out ldwin_plain_subset
+  for prefix in tmp_ldwin tmp_ldwin_zstd; do
+    $1/plink2 $2 $3 --pfile ${prefix} $filter --export vcf --freq --geno-counts --out ${prefix}_subset
+    diff -q <(tail -n +3 ldwin_plain_subset.vcf) <(tail -n +3 ${prefix}_subset.vcf)
+    diff -q ldwin_plain_subset.gcount ${prefix}_subset.gcount
+  done
+done
+
+# --export ind-major-bed and pgen_compress -s load runs of consecutive variants
+# with PgrGetBlock(), which patches LD-compressed variants from their base's
+# row when the base is in the same run.
+for filter in "" "--thin-indiv 0.5 --seed 5" "--thin 0.6 --thin-indiv 0.7 --seed 6"; do
+  $1/plink2 $2 $3 --pfile tmp_interleaved $filter --export ind-major-bed --out ldwin_plain_imaj
+  for prefix in tmp_ldwin tmp_ldwin_zstd; do
+    $1/plink2 $2 $3 --pfile ${prefix} $filter --export ind-major-bed --out ${prefix}_imaj
+    diff -q ldwin_plain_imaj.bed ${prefix}_imaj.bed
+  done
+done
+$1/pgen_compress -s tmp_interleaved.pgen ldwin_plain.pgen.smaj
+$1/pgen_compress -s tmp_ldwin.pgen tmp_ldwin.pgen.smaj
+cmp <(tail -c +33 ldwin_plain.pgen.smaj) <(tail -c +33 tmp_ldwin.pgen.smaj)
+
+# --export ind-major-bed reads hardcalls from <.pgen>.smaj when it's up to
+# date, and otherwise warns and falls back on the .pgen.
+filters=("" "--thin 0.6 --thin-indiv 0.7 --seed 7" "--maj-ref force --thin 0.5 --seed 8")
+for i in 0 1 2; do
+  $1/plink2 $2 $3 --pfile tmp_interleaved ${filters[$i]} --export ind-major-bed --out smaj_plain_$i
+done
+$1/pgen_compress -s tmp_interleaved.pgen tmp_interleaved.pgen.smaj
+for i in 0 1 2; do
+  $1/plink2 $2 $3 --pfile tmp_interleaved ${filters[$i]} --export ind-major-bed --out smaj_$i
+  grep -q "^--export ind-major-bed: Hardcalls loaded from tmp_interleaved.pgen.smaj." smaj_$i.log
+  diff -q smaj_plain_$i.bed smaj_$i.bed
+  diff -q smaj_plain_$i.bim smaj_$i.bim
+done
+# Stale sidecar next to a regenerated .pgen.
+$1/plink2 $2 $3 --vcf tmp_interleaved.vcf --double-id --make-pgen erase-phase --out tmp_interleaved
+$1/plink2 $2 $3 --pfile tmp_interleaved --export ind-major-bed --out smaj_stale
+grep -q "^Warning: Ignoring tmp_interleaved.pgen.smaj, since it was not generated" smaj_stale.log
+diff -q smaj_plain_0.bed smaj_stale.bed
+# Truncated sidecar.
+$1/pgen_compress -s tmp_interleaved.pgen tmp_smaj_full
+head -c 1000 tmp_smaj_full > tmp_interleaved.pgen.smaj
+$1/plink2 $2 $3 --pfile tmp_interleaved --export ind-major-bed --out smaj_truncated
+grep -q "^Warning: Ignoring tmp_interleaved.pgen.smaj, since it isn't a valid" smaj_truncated.log
+diff -q smaj_plain_0.bed smaj_truncated.bed
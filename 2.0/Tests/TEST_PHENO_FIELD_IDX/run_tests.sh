@@ -0,0 +1,52 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# --pheno/--pheno-name on a wide table skips most columns, so LoadPhenos()
+# lexes it with TextFieldIdx (in non-AVX2 builds).  Results must match loading
+# a narrow table containing just the selected columns, which goes through
+# TokenLexK().
+$1/plink2 $2 $3 --dummy 300 20 --make-pgen --out tmp_base
+
+# 3000 phenotypes; odd-numbered rows are space-delimited (sometimes with runs
+# of spaces), even-numbered rows are tab-delimited.
+awk 'BEGIN { srand(1); printf("#IID"); for (j = 1; j <= 3000; j++) { printf("\tc%d", j); } printf("\n"); }
+     NR > 1 { sep = (NR % 2)? "\t" : ((NR % 3)? " " : "   "); printf("%s", $1); for (j = 1; j <= 3000; j++) { if (rand() < 0.02) { printf("%sNA", sep); } else { printf("%s%.3f", sep, rand() * 100); } } printf("\n"); }' tmp_base.psam > tmp_wide.txt
+sed 's/$/\r/' tmp_wide.txt > tmp_wide_crlf.txt
+
+i=0
+for cols in "3000" "1500" "70 2000 2999" "100 101 102 103 104 105"
+do
+    i=$((i+1))
+    names=$(echo $cols | awk '{ for (j = 1; j <= NF; j++) { printf("%sc%d", (j > 1)? "," : "", $j); } }')
+    awk -v cols="$cols" 'BEGIN { n = split(cols, c, " "); } { printf("%s", $1); for (j = 1; j <= n; j++) { printf("\t%s", $(c[j] + 1)); } printf("\n"); }' tmp_wide.txt > tmp_narrow$i.txt
+    $1/plink2 $2 $3 --pfile tmp_base --pheno tmp_narrow$i.txt --pheno-name $names --make-just-psam --out narrow$i
+    $1/plink2 $2 $3 --pfile tmp_base --pheno tmp_wide.txt --pheno-name $names --make-just-psam --out wide$i
+    diff -q narrow$i.psam wide$i.psam
+    $1/plink2 $2 $3 --pfile tmp_base --pheno tmp_wide_crlf.txt --pheno-name $names --make-just-psam --out wide_crlf$i
+    diff -q narrow$i.psam wide_crlf$i.psam
+done
+
+# Lines longer than the 4 MiB index window must fall back on TokenLexK(), and
+# the lines after them must still be indexed correctly.  The long lines get a
+# 5 MiB token in a skipped column.
+awk 'BEGIN { big = "x"; while (length(big) < 5242880) { big = big big; } printf("#IID"); for (j = 1; j <= 200; j++) { printf("\tc%d", j); } printf("\n"); }
+     NR > 1 { printf("%s", $1); for (j = 1; j <= 200; j++) { if ((j == 50) && ((NR == 3) || (NR == 9) || (NR == 10))) { printf("\t%s", big); } else { printf("\t%d", (NR * j) % 97); } } printf("\n"); }' tmp_base.psam > tmp_long.txt
+awk '{ printf("%s\t%s\t%s\n", $1, $(100 + 1), $(200 + 1)); }' tmp_long.txt > tmp_long_narrow.txt
+$1/plink2 $2 $3 --pfile tmp_base --pheno tmp_long_narrow.txt --pheno-name c100,c200 --make-just-psam --out long_narrow
+$1/plink2 $2 $3 --pfile tmp_base --pheno tmp_long.txt --pheno-name c100,c200 --make-just-psam --out long_wide
+diff -q long_narrow.psam long_wide.psam
+
+# A line with too few tokens must be reported as such, with the right line
+# number, whether the missing column is far past the line end or just past it.
+for lf in tmp_wide.txt tmp_wide_crlf.txt
+do
+    for last_col in 1000 2999
+    do
+        awk -v last_col=$last_col 'NR == 151 { for (j = 1; j <= last_col + 1; j++) { printf("%s%s", (j > 1)? "\t" : "", $j); } if (substr($0, length($0)) == "\r") { printf("\r"); } printf("\n"); next } { print }' $lf > tmp_short.txt
+        if $1/plink2 $2 $3 --pfile tmp_base --pheno tmp_short.txt --pheno-name c3000 --make-just-psam --out short; then
+            exit 1
+        fi
+        grep -q "Error: Line 151 of tmp_short.txt has fewer tokens than expected." short.log
+    done
+done
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Two copies of the 1kg chr21 sample (QUAL/FILTER/INFO present), the second
+# relabeled as chromosome 22 with _b-suffixed IDs.
+gunzip -c ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz > tmp_1kg.vcf
+grep '^#' tmp_1kg.vcf > tmp_data.vcf
+grep -v '^#' tmp_1kg.vcf >> tmp_data.vcf
+grep -v '^#' tmp_1kg.vcf | awk 'BEGIN{FS="\t"; OFS="\t"} {$1 = 22; $3 = $3 "_b"; print}' >> tmp_data.vcf
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+
+# Writes the cache on the first run, and loads it on later runs; results must
+# be identical to a plain text parse either way.
+rm -f tmp_data.pvar.pvc
+for filter in "" "--chr 22" "--chr 21 --from-bp 9412000 --to-bp 9420000"
+do
+    $1/plink2 $2 $3 --pfile tmp_data $filter --make-pgen --freq --out plain
+    for pass in write load
+    do
+        $1/plink2 $2 $3 --pfile tmp_data $filter --pvar-cache --make-pgen --freq --out cache
+        if [ -z "$filter" ] && [ $pass = write ]; then
+            grep -q "^--pvar-cache: tmp_data.pvar.pvc written." cache.log
+            test -s tmp_data.pvar.pvc
+        else
+            grep -q "^--pvar-cache: Variant data loaded from tmp_data.pvar.pvc." cache.log
+        fi
+        diff -q plain.pvar cache.pvar
+        diff -q plain.pgen cache.pgen
+        diff -q plain.afreq cache.afreq
+    done
+done
+
+# A stale cache must be ignored (and rewritten): first an mtime-only change,
+# then a size change.
+touch tmp_data.pvar
+$1/plink2 $2 $3 --pfile tmp_data --pvar-cache --freq --out stale
+grep -q "^--pvar-cache: tmp_data.pvar.pvc written." stale.log
+$1/plink2 $2 $3 --pfile tmp_data --pvar-cache --freq --out cache
+grep -q "^--pvar-cache: Variant data loaded from tmp_data.pvar.pvc." cache.log
+sed -i 's/\trs/\tchanged_rs/' tmp_data.pvar
+grep -q changed_rs tmp_data.pvar
+$1/plink2 $2 $3 --pfile tmp_data --freq --out plain
+$1/plink2 $2 $3 --pfile tmp_data --pvar-cache --freq --out stale
+grep -q "^--pvar-cache: tmp_data.pvar.pvc written." stale.log
+diff -q plain.afreq stale.afreq
+$1/plink2 $2 $3 --pfile tmp_data --pvar-cache --freq --out cache
+grep -q "^--pvar-cache: Variant data loaded from tmp_data.pvar.pvc." cache.log
+diff -q plain.afreq cache.afreq
+
+# .bim with nonzero centimorgan positions.
+$1/plink2 $2 $3 --pfile tmp_data --make-bed --out tmp_bed
+awk 'BEGIN{OFS="\t"} {$3 = NR / 1000; print}' tmp_bed.bim > tmp_bed_cm.bim
+mv tmp_bed_cm.bim tmp_bed.bim
+$1/plink2 $2 $3 --bfile tmp_bed --make-just-pvar --out plain
+for pass in write load
+do
+    $1/plink2 $2 $3 --bfile tmp_bed --pvar-cache --make-just-pvar --out cache
+    diff -q plain.pvar cache.pvar
+done
+grep -q "^--pvar-cache: Variant data loaded from tmp_bed.bim.pvc." cache.log
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Phased VCF export renders a homozygous call as 0|0 or 0/0 depending on the
+# sample's most recent het call, which may lie in another thread's range or
+# in an earlier block.  Make a dataset with sparse phasing, multiallelic
+# variants, and more than two write blocks' worth of variants, and check that
+# the output doesn't depend on the thread count.
+# --threads is set explicitly below, so $2/$3 are only passed to the data
+# generation step.
+$1/plink2 $2 $3 --dummy 40 140000 0.03 --seed 1 --export vcf --out tmp_data_unphased
+awk 'BEGIN{OFS="\t"; srand(1)} /^#/{print; next} {
+  multi = (NR % 9 == 0)
+  if (multi) $5 = $5 ",G"
+  for (i = 10; i <= NF; ++i) {
+    g = $i
+    if (multi && (g == "1/1") && (rand() < 0.3)) g = "2/2"
+    else if (multi && (g == "0/1") && (rand() < 0.3)) g = "1/2"
+    if (rand() < 0.05) {
+      if ((g == "0/1") && (rand() < 0.5)) g = "1/0"
+      sub("/", "|", g)
+    }
+    $i = g
+  }
+  print
+}' tmp_data_unphased.vcf > tmp_data.vcf
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+for filter in "" "--thin-indiv 0.5 --seed 2"
+do
+    $1/plink2 --threads 1 --pfile tmp_data $filter --export vcf --out vcf_t1
+    for t in 2 3 8
+    do
+        $1/plink2 --threads $t --pfile tmp_data $filter --export vcf --out vcf_t$t
+        diff -q <(tail -n +3 vcf_t1.vcf) <(tail -n +3 vcf_t$t.vcf)
+    done
+done
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""
+This BGZF-compresses a file, the way 'bgzip -c' does: 65280-byte input
+blocks, each a gzip member with a BC extra subfield, followed by the standard
+empty EOF block.
+"""
+
+import argparse
+import struct
+import zlib
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-i', '--input', type=str, required=True,
+                             help='Uncompressed input file.')
+    requiredarg.add_argument('-o', '--output', type=str, required=True,
+                             help='BGZF output file.')
+    return parser.parse_args()
+
+def bgzf_block(data):
+    """
+    Returns one BGZF block containing data.
+    """
+    compressor = zlib.compressobj(6, zlib.DEFLATED, -15)
+    cdata = compressor.compress(data) + compressor.flush()
+    header = struct.pack('<BBBBIBBHBBHH', 31, 139, 8, 4, 0, 0, 255, 6,
+                         ord('B'), ord('C'), 2, len(cdata) + 25)
+    return header + cdata + struct.pack('<II', zlib.crc32(data), len(data))
+
+def main():
+    args = parse_commandline_args()
+    with open(args.input, 'rb') as infile:
+        data = infile.read()
+    with open(args.output, 'wb') as outfile:
+        for offset in range(0, len(data), 65280):
+            outfile.write(bgzf_block(data[offset:offset + 65280]))
+        outfile.write(bgzf_block(b''))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# With --threads > 1, the first --vcf pass over a large enough bgzf file is
+# split into byte ranges.  Output must be identical to the single-threaded
+# scan, and any line the serial scan would reject must produce the same error
+# message.  --threads is set explicitly below, so $2/$3 are only passed to the
+# data generation step.
+$1/plink2 $2 $3 --dummy 400 30000 0.1 acgt --make-pgen --out tmp_data
+# Four contigs, the last non-standard; every 7th variant gets a second ALT
+# allele.
+awk 'BEGIN{OFS="\t"} /^#/ {print; next} {$1 = (NR < 9000)? "1" : ((NR < 18000)? "2" : ((NR < 26000)? "3" : "scaffold1")); print}' tmp_data.pvar > tmp_data_contigs.pvar
+mv tmp_data_contigs.pvar tmp_data.pvar
+$1/plink2 $2 $3 --pfile tmp_data --allow-extra-chr --export vcf --out tmp_data
+awk 'BEGIN{FS="\t"; OFS="\t"} /^#/ {print; next} {if (NR % 7 == 0) {split("ACGT", b, ""); for (i = 1; (b[i] == $4) || (b[i] == $5); i++) {} $5 = $5 "," b[i]} print}' tmp_data.vcf > tmp_multi.vcf
+python3 make_bgzf.py -i tmp_multi.vcf -o tmp_multi.vcf.gz
+
+for filter in "" "--chr 2,3" "--not-chr 1 --max-alleles 2"
+do
+    for t in 1 4
+    do
+        $1/plink2 --threads $t --vcf tmp_multi.vcf.gz --allow-extra-chr $filter --make-pgen --out scan_t$t
+    done
+    grep -q "^--vcf: Scanning pass split across [2-4] byte ranges." scan_t4.log
+    for ext in pgen pvar psam
+    do
+        cmp scan_t1.$ext scan_t4.$ext
+    done
+done
+
+# Malformed lines late in the file: the parallel result is discarded, and the
+# serial scan reports the error.
+for bad_kind in short hash
+do
+    if [ $bad_kind = short ]; then
+        awk 'BEGIN{FS="\t"; OFS="\t"} /^#/ {print; next} {if (NR == 25000) {print $1, $2, $3, $4, $5} else {print}}' tmp_multi.vcf > tmp_bad.vcf
+    else
+        awk '{print} /^#/ {next} {if (NR == 25000) {print "##extra_header=1"}}' tmp_multi.vcf > tmp_bad.vcf
+    fi
+    python3 make_bgzf.py -i tmp_bad.vcf -o tmp_bad.vcf.gz
+    for t in 1 4
+    do
+        if $1/plink2 --threads $t --vcf tmp_bad.vcf.gz --allow-extra-chr --make-pgen --out bad_${bad_kind}_t$t; then
+            exit 1
+        fi
+    done
+    if grep -q "byte ranges" bad_${bad_kind}_t4.log; then
+        exit 1
+    fi
+    diff -q <(grep '^Error' bad_${bad_kind}_t1.log) <(grep '^Error' bad_${bad_kind}_t4.log)
+done
@@ -2,7 +2,10 @@
 
 # Usage: ./run_tests.sh {plink2 + pgen_compress build dir}
 #   {up to 2 args, e.g. --randmem, "--threads 1"}
-# Requires plink to be in the system PATH.
+# Requires plink to be in the system PATH.  TEST_BGZF_IDX is skipped unless
+# bgzip, tabix, and bcftools are also present, and TEST_BGEN_IDX is skipped
+# unless python3 has the sqlite3 module.  TEST_VCF_RANGE_SCAN requires
+# python3, and TEST_DTOA builds a small program with $CXX (default g++).
 
 set -exo pipefail
 
@@ -43,14 +46,64 @@ cd TEST_SAMPLE_SUBSET
 cd ..
 echo "TEST_SAMPLE_SUBSET passed."
 
+cd TEST_GLM_THREADS
+./run_tests.sh $d $2 $3 > TEST_GLM_THREADS.log
+cd ..
+echo "TEST_GLM_THREADS passed."
+
+cd TEST_VCF_EXPORT_THREADS
+./run_tests.sh $d $2 $3 > TEST_VCF_EXPORT_THREADS.log
+cd ..
+echo "TEST_VCF_EXPORT_THREADS passed."
+
 cd TEST_DOSAGE_ROUND_TRIP
 ./run_tests.sh $d $2 $3 > TEST_DOSAGE_ROUND_TRIP.log
 cd ..
 echo "TEST_DOSAGE_ROUND_TRIP passed."
 
+cd TEST_PGEN_COMPRESS
+./run_tests.sh $d $2 $3 > TEST_PGEN_COMPRESS.log
+cd ..
+echo "TEST_PGEN_COMPRESS passed."
+
+cd TEST_BGZF_IDX
+./run_tests.sh $d $2 $3 > TEST_BGZF_IDX.log
+cd ..
+echo "TEST_BGZF_IDX passed."
+
+cd TEST_BGEN_IDX
+./run_tests.sh $d $2 $3 > TEST_BGEN_IDX.log
+cd ..
+echo "TEST_BGEN_IDX passed."
+
+cd TEST_PVAR_CACHE
+./run_tests.sh $d $2 $3 > TEST_PVAR_CACHE.log
+cd ..
+echo "TEST_PVAR_CACHE passed."
+
+cd TEST_PHENO_FIELD_IDX
+./run_tests.sh $d $2 $3 > TEST_PHENO_FIELD_IDX.log
+cd ..
+echo "TEST_PHENO_FIELD_IDX passed."
+
 cd TEST_ONE_WAY_EXPORT
 ./run_tests.sh $d $2 $3 > TEST_ONE_WAY_EXPORT.log
 cd ..
 echo "TEST_ONE_WAY_EXPORT passed."
 
+cd TEST_KING_THREADS
+./run_tests.sh $d $2 $3 > TEST_KING_THREADS.log
+cd ..
+echo "TEST_KING_THREADS passed."
+
+cd TEST_VCF_RANGE_SCAN
+./run_tests.sh $d $2 $3 > TEST_VCF_RANGE_SCAN.log
+cd ..
+echo "TEST_VCF_RANGE_SCAN passed."
+
+cd TEST_DTOA
+./run_tests.sh $d $2 $3 > TEST_DTOA.log
+cd ..
+echo "TEST_DTOA passed."
+
 echo "All tests passed."
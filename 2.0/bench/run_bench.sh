@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Usage: ./run_bench.sh {plink2 build dir} {baseline build dir, or -}
+#   {repetition count} <plink2 flags...>
+# Runs "plink2 <flags> --out bench_<label>" repeatedly, and reports the best
+# wall-clock time for the current build and (if given) a baseline build.  When
+# a baseline is timed, every output file other than the .log must be
+# byte-identical between the two builds.  Generate input data first, e.g. with
+# --dummy, and run this in a directory without other bench_* files.  Not part
+# of Tests/run_tests.sh.
+
+set -eo pipefail
+
+d=$1
+baseline_d=$2
+rep_ct=$3
+shift 3
+
+run_timed() {
+    local label=$1
+    local bin_dir=$2
+    shift 2
+    local best=""
+    local start
+    local end
+    for ((rep = 0; rep < rep_ct; rep++)); do
+        start=$(date +%s.%N)
+        $bin_dir/plink2 "$@" --out bench_$label > /dev/null
+        end=$(date +%s.%N)
+        best=$(awk -v s="$start" -v e="$end" -v b="$best" 'BEGIN { el = e - s; if ((b == "") || (el < b)) { print el; } else { print b; } }')
+    done
+    printf "%-8s %8.3f s\n" $label $best
+}
+
+if [ "$baseline_d" != "-" ]; then
+    run_timed baseline $baseline_d "$@"
+fi
+run_timed current $d "$@"
+if [ "$baseline_d" != "-" ]; then
+    for fname in bench_current.*; do
+        if [ "$fname" != "bench_current.log" ]; then
+            cmp $fname bench_baseline.${fname#bench_current.}
+        fi
+    done
+fi
@@ -3625,6 +3625,108 @@ uint64_t PglHeaderBaseEndOffset(uint32_t variant_ct, uintptr_t vrec_len_byte_ct,
   return offset;
 }
 
+void PbwtInitHapOrder(uint32_t sample_ct, uint32_t* hap_order) {
+  const uint32_t hap_ct = 2 * sample_ct;
+  for (uint32_t hap_idx = 0; hap_idx != hap_ct; ++hap_idx) {
+    hap_order[hap_idx] = hap_idx;
+  }
+}
+
+static inline uint32_t PbwtSamplePhased(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, uint32_t sample_idx) {
+  if (phasepresent) {
+    return IsSet(phasepresent, sample_idx);
+  }
+  return (GetNyparrEntry(genovec, sample_idx) == 1);
+}
+
+void PbwtUpdateHapOrder(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uintptr_t* __restrict phaseinfo, uint32_t sample_ct, uint32_t* __restrict hap_order, uint32_t* __restrict hap_order_tmp) {
+  // Stable partition by haplotype allele.  Haplotypes carrying the alt allele
+  // are parked in hap_order_tmp; the others can be compacted in place.
+  const uint32_t hap_ct = 2 * sample_ct;
+  uint32_t zero_ct = 0;
+  uint32_t one_ct = 0;
+  for (uint32_t order_idx = 0; order_idx != hap_ct; ++order_idx) {
+    const uint32_t hap_idx = hap_order[order_idx];
+    const uint32_t sample_idx = hap_idx / 2;
+    const uintptr_t geno = GetNyparrEntry(genovec, sample_idx);
+    uint32_t allele = (geno == 2);
+    if (geno == 1) {
+      allele = hap_idx & 1;
+      if (PbwtSamplePhased(genovec, phasepresent, sample_idx)) {
+        allele ^= IsSet(phaseinfo, sample_idx);
+      }
+    }
+    if (allele) {
+      hap_order_tmp[one_ct++] = hap_idx;
+    } else {
+      hap_order[zero_ct++] = hap_idx;
+    }
+  }
+  memcpy(&(hap_order[zero_ct]), hap_order_tmp, one_ct * sizeof(int32_t));
+}
+
+unsigned char* PbwtEncodePhaseinfo(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uintptr_t* __restrict phaseinfo, const uint32_t* __restrict hap_order, uint32_t sample_ct, unsigned char* write_iter, unsigned char* write_limit) {
+  const uint32_t hap_ct = 2 * sample_ct;
+  uint32_t cur_bit = 0;
+  uint32_t run_len = 0;
+  for (uint32_t order_idx = 0; order_idx != hap_ct; ++order_idx) {
+    const uint32_t hap_idx = hap_order[order_idx];
+    if (hap_idx & 1) {
+      continue;
+    }
+    const uint32_t sample_idx = hap_idx / 2;
+    if ((GetNyparrEntry(genovec, sample_idx) != 1) || (!PbwtSamplePhased(genovec, phasepresent, sample_idx))) {
+      continue;
+    }
+    const uint32_t bit = IsSet(phaseinfo, sample_idx);
+    if (bit != cur_bit) {
+      // Vint32Append() writes at most 5 bytes.
+      if (S_CAST(uintptr_t, write_limit - write_iter) < 5) {
+        return nullptr;
+      }
+      write_iter = Vint32Append(run_len, write_iter);
+      cur_bit = bit;
+      run_len = 0;
+    }
+    ++run_len;
+  }
+  if (S_CAST(uintptr_t, write_limit - write_iter) < 5) {
+    return nullptr;
+  }
+  return Vint32Append(run_len, write_iter);
+}
+
+BoolErr PbwtDecodePhaseinfo(const unsigned char* fread_end, const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uint32_t* __restrict hap_order, uint32_t sample_ct, uint32_t phasepresent_ct, const unsigned char** fread_pp, uintptr_t* __restrict phaseinfo) {
+  const uint32_t hap_ct = 2 * sample_ct;
+  uint32_t remaining_ct = phasepresent_ct;
+  uint32_t run_remaining = 0;
+  // first run consists of zeroes
+  uint32_t cur_bit = 1;
+  for (uint32_t order_idx = 0; order_idx != hap_ct; ++order_idx) {
+    const uint32_t hap_idx = hap_order[order_idx];
+    if (hap_idx & 1) {
+      continue;
+    }
+    const uint32_t sample_idx = hap_idx / 2;
+    if ((GetNyparrEntry(genovec, sample_idx) != 1) || (!PbwtSamplePhased(genovec, phasepresent, sample_idx))) {
+      continue;
+    }
+    while (!run_remaining) {
+      run_remaining = GetVint31(fread_end, fread_pp);
+      if (unlikely(run_remaining > remaining_ct)) {
+        return 1;
+      }
+      cur_bit ^= 1;
+    }
+    if (cur_bit) {
+      SetBit(sample_idx, phaseinfo);
+    }
+    --run_remaining;
+    --remaining_ct;
+  }
+  return (remaining_ct != 0) || (run_remaining != 0);
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -627,6 +627,13 @@ HEADER_INLINE double MultiallelicDiploidMachR2(const uint64_t* __restrict sums,
 
 CONSTI32(kPglVblockSize, 65536);
 
+// PBWT-mode haplotype order reset interval; must divide kPglVblockSize.
+CONSTI32(kPglPbwtResetInterval, 1024);
+
+// Number of LD base candidates considered by the LD-window-mode writer.  The
+// format permits up to 256.
+CONSTI32(kPglLdWindowSize, 8);
+
 // kPglDifflistGroupSize defined in plink2_base
 
 // Currently chosen so that it plus kPglFwriteBlockSize + kCacheline - 2 is
@@ -647,7 +654,14 @@ FLAGSET_DEF_START()
   kfPgenGlobalHardcallPhasePresent = (1 << 3),
   kfPgenGlobalDosagePresent = (1 << 4),
   kfPgenGlobalDosagePhasePresent = (1 << 5),
-  kfPgenGlobalAllNonref = (1 << 6)
+  kfPgenGlobalAllNonref = (1 << 6),
+
+  // PBWT modes: biallelic hardcall-phase tracks may be PBWT-encoded.
+  kfPgenGlobalPbwtHphase = (1 << 7),
+
+  // LD-window modes: LD-compressed variants may reference any of the last 256
+  // non-LD-compressed variants in their vblock.
+  kfPgenGlobalLdWindow = (1 << 8)
 FLAGSET_DEF_END(PgenGlobalFlags);
 
 // difflist/LD compression must not involve more than
@@ -750,6 +764,21 @@ uint32_t CountNybble(const void* nybblearr, uintptr_t nybble_word, uintptr_t nyb
 //      versions of the PGEN specification, and 0 is off-limits (PLINK 1
 //      sample-major .bed).
 //      0x80..0xff can be safely used by developers for their own purposes.
+//      This version of pgenlib uses 0x82..0x8f for experimental variants of
+//      mode 0x10/0x11.  Bit 0 has the same meaning as in 0x10/0x11, and each
+//      of bits 1-3 enables one extension (0x80/0x81, with none enabled, are
+//      not used):
+//        bit 1 (0x82): the variant records in each vblock are stored as an
+//               independent zstd frame; see {4a}.  Produced by
+//               "pgen_compress -z".
+//        bit 2 (0x84): biallelic hardcall-phase tracks are preceded by an
+//               encoding byte, and may store phaseinfo as PBWT run lengths;
+//               see bit 4 of the vrtype coding below.  Produced by
+//               "pgen_compress -p".
+//        bit 3 (0x88): LD-compressed variants may use any of the last 256
+//               non-LD-compressed variants in their vblock as the base; see
+//               {4b.v}.  Produced by "pgen_compress -w".
+//      Below, these are referred to as the zstd, PBWT, and LD-window modes.
 //
 // 3. If not plink1-format,
 //    a. 4-byte # of variants; call this M.
@@ -797,6 +826,10 @@ uint32_t CountNybble(const void* nybblearr, uintptr_t nybble_word, uintptr_t nyb
 //    a. Array of 8-byte fpos values for the first variant in each vblock.
 //       (Note that this suggests a way to support in-place insertions: some
 //       unused space can be left between the vblocks.)
+//       In zstd modes, this instead has (vblock_ct + 1) entries: the fpos
+//       of each vblock's zstd frame, followed by the end of the last frame.
+//       Variant record lengths then refer to the uncompressed record stream,
+//       which is considered to start at the first frame's fpos.
 //    b. Sequence of header blocks, each containing information about
 //       kPglVblockSize variants (except the last may be shorter).  All values
 //       are known-width, to allow e.g. plink2 --make-pgen/--pmerge to compress
@@ -807,6 +840,10 @@ uint32_t CountNybble(const void* nybblearr, uintptr_t nybble_word, uintptr_t nyb
 //            bytes, or 2-4 bits).
 //       iii. if bits 4-5 of {3c} aren't 00, array of alt allele counts.
 //        iv. nonref flags info, if explicitly stored
+//         v. in LD-window modes, array of 1-byte LD base back-references.
+//            For an LD-compressed variant, k means that the base is the
+//            (k+1)th-most-recent non-LD-compressed variant in the vblock.  All
+//            other entries must be zero.
 //      (this representation allows more efficient random access)
 //    If mode 0x02-0x04, and nonref flags info explicitly stored, just that
 //    bitarray.
@@ -843,7 +880,8 @@ uint32_t CountNybble(const void* nybblearr, uintptr_t nybble_word, uintptr_t nyb
 //                   alignment/variant-calling technical artifacts that should
 //                   be removed.)
 //   010 = Differences-from-earlier-variant encoding ("LD compression").  The
-//         last variant without this type of encoding is the base.
+//         last variant without this type of encoding is the base (in
+//         LD-window modes, the header back-reference selects an earlier one).
 //         To simplify random access logic, the first variant in each vblock is
 //         prohibited from using this encoding.
 //   011 = Inverted differences-from-earlier-variant encoding.  (This covers
@@ -947,6 +985,21 @@ uint32_t CountNybble(const void* nybblearr, uintptr_t nybble_word, uintptr_t nyb
 //        subsetting).
 //        By default, entire chromosomes/contigs are assumed to be phased
 //        together.  (Todo: support contiguous phase sets.)
+//        In PBWT modes, the track of a biallelic variant (bit 3 unset)
+//        instead starts with an encoding byte.  0 means the track described
+//        above follows unchanged.  1 means phaseinfo is PBWT-encoded: the
+//        next byte(s) are the usual "first part" if phasepresent is
+//        explicit, or a single zero byte otherwise, followed by VINT run
+//        lengths of phaseinfo bits (alternating, starting with a possibly
+//        empty run of zeroes; the runs sum to phasepresent_ct).  The bits are
+//        visited in positional Burrows-Wheeler order over the 2N haplotypes:
+//        each phased het's bit is emitted when its first haplotype is
+//        reached.  The order is reset to (0, 1, ..., 2N - 1) at every
+//        multiple of kPglPbwtResetInterval (1024) variants, and is stably
+//        partitioned by haplotype allele after every biallelic
+//        hardcall-phased variant (unphased hets count as 0|1, missing calls
+//        as 0/0).  Decoders therefore need to replay from the last reset
+//        point up to the current variant.
 //
 // bits 5-6:
 //   00 = no dosage data.
@@ -1030,6 +1083,22 @@ CONSTI32(kPglMaxSampleCt, 0x7ffffffe);
 
 uint64_t PglHeaderBaseEndOffset(uint32_t variant_ct, uintptr_t vrec_len_byte_ct, uint32_t phase_or_dosage_present, uint32_t explicit_nonref_flags);
 
+// PBWT hardcall-phase helpers shared by the PBWT-mode reader and
+// writer.  hap_order has 2 * sample_ct entries; haplotype 2s is sample s's
+// first.  phasepresent and phaseinfo are sample-indexed bitarrays;
+// phasepresent == nullptr means every het is phased, and phaseinfo bits
+// outside the phased hets are ignored.
+void PbwtInitHapOrder(uint32_t sample_ct, uint32_t* hap_order);
+
+void PbwtUpdateHapOrder(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uintptr_t* __restrict phaseinfo, uint32_t sample_ct, uint32_t* __restrict hap_order, uint32_t* __restrict hap_order_tmp);
+
+// Returns nullptr if the run lengths don't fit before write_limit.
+unsigned char* PbwtEncodePhaseinfo(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uintptr_t* __restrict phaseinfo, const uint32_t* __restrict hap_order, uint32_t sample_ct, unsigned char* write_iter, unsigned char* write_limit);
+
+// phaseinfo must be zero-initialized.  phasepresent_ct must be the number of
+// phased hets.
+BoolErr PbwtDecodePhaseinfo(const unsigned char* fread_end, const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uint32_t* __restrict hap_order, uint32_t sample_ct, uint32_t phasepresent_ct, const unsigned char** fread_pp, uintptr_t* __restrict phaseinfo);
+
 // Current pgen-extension API assumes .pgen extension bodies fit comfortably in
 // memory.
 // It's easy to imagine a useful extension that breaks this assumption, e.g.
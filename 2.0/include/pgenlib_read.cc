@@ -16,9 +16,20 @@
 
 
 #include "pgenlib_read.h"
+#include "plink2_thread.h"  // MonotonicNs()
 
 #include <errno.h>
 
+#ifndef _WIN32
+#  include <fcntl.h>  // posix_fadvise(), F_RDADVISE
+#endif
+#ifndef NO_PREAD
+#  include <unistd.h>  // pread()
+#endif
+#ifndef NO_MMAP
+#  include <sys/mman.h>  // mmap(), madvise(), munmap()
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -593,6 +604,20 @@ void PreinitPgfi(PgenFileInfo* pgfip) {
   pgfip->shared_ff = nullptr;
   pgfip->pgi_ff = nullptr;
   pgfip->block_base = nullptr;
+  pgfip->multiread_byte_ct = 0;
+  pgfip->multiread_ns = 0;
+  pgfip->mmap_base = nullptr;
+  pgfip->mmap_byte_ct = 0;
+  pgfip->pread_fd = -1;
+  pgfip->vcache = nullptr;
+  pgfip->zframe_ct = 0;
+  pgfip->zcursor_ct = 0;
+  pgfip->zframe_fpos = nullptr;
+  pgfip->zcursors = nullptr;
+  pgfip->zparallel_for = nullptr;
+  pgfip->zrunner_arg = nullptr;
+  pgfip->ldbase_backrefs = nullptr;
+  pgfip->ldbase_reach = nullptr;
   // we want this for proper handling of e.g. sites-only VCFs
   pgfip->nonref_flags = nullptr;
 }
@@ -609,6 +634,25 @@ uintptr_t CountPgfiAllocCachelinesRequired(uint32_t raw_variant_ct) {
   return cachelines_required;
 }
 
+// Upper bound on the translated suffix of a PBWT-encoded record: the legacy
+// aux2 track, followed by any biallelic dosage tracks.
+static uintptr_t PbwtRecordBufByteCt(uint32_t raw_sample_ct, PgenGlobalFlags gflags) {
+  const uintptr_t bitvec_byte_ct = DivUp(raw_sample_ct, CHAR_BIT);
+  uintptr_t byte_ct = 2 + 2 * bitvec_byte_ct;
+  if (gflags & kfPgenGlobalDosagePresent) {
+    // aux3 is stored as a bitarray when a dosage list wouldn't be smaller
+    byte_ct += bitvec_byte_ct + 2 * S_CAST(uintptr_t, raw_sample_ct) + 16;
+    if (gflags & kfPgenGlobalDosagePhasePresent) {
+      byte_ct += bitvec_byte_ct + 2 * S_CAST(uintptr_t, raw_sample_ct);
+    }
+  }
+  return RoundUpPow2(byte_ct, kCacheline);
+}
+
+static inline uint32_t PbwtHphaseActive(PgenGlobalFlags gflags) {
+  return (gflags & (kfPgenGlobalPbwtHphase | kfPgenGlobalHardcallPhasePresent)) == (kfPgenGlobalPbwtHphase | kfPgenGlobalHardcallPhasePresent);
+}
+
 uintptr_t CountPgrAllocCachelinesRequired(uint32_t raw_sample_ct, PgenGlobalFlags gflags, uint32_t max_allele_ct, uint32_t fread_buf_byte_ct) {
   // ldbase_raw_genovec: always needed, 2 bits per entry, up to raw_sample_ct
   // entries
@@ -677,6 +721,20 @@ uintptr_t CountPgrAllocCachelinesRequired(uint32_t raw_sample_ct, PgenGlobalFlag
       // may need deltalist64 workspace in multiallelic dosage case
     }
   }
+  if (PbwtHphaseActive(gflags)) {
+    // pbwt_hap_order, pbwt_hap_order_tmp
+    cachelines_required += 2 * Int32CtToCachelineCt(2 * S_CAST(uintptr_t, raw_sample_ct));
+    // pbwt_genovec, pbwt_ldbase_genovec
+    cachelines_required += 2 * genovec_cacheline_req;
+    // pbwt_phasepresent, pbwt_phaseinfo
+    cachelines_required += 2 * bitvec_cacheline_req;
+    // pbwt_record_buf
+    cachelines_required += PbwtRecordBufByteCt(raw_sample_ct, gflags) / kCacheline;
+  }
+  if (gflags & kfPgenGlobalLdWindow) {
+    // ldwin_raw_genovecs
+    cachelines_required += kPglLdWindowSize * genovec_cacheline_req;
+  }
   return cachelines_required;
 }
 
@@ -696,6 +754,18 @@ PglErr PgfiInitPhase1(const char* fname, const char* pgi_fname, uint32_t raw_var
   pgfip->block_base = nullptr;
   // this should force overflow when value is uninitialized.
   pgfip->block_offset = 1LLU << 63;
+  pgfip->mmap_base = nullptr;
+  pgfip->mmap_byte_ct = 0;
+  pgfip->pread_fd = -1;
+  pgfip->vcache = nullptr;
+  pgfip->zframe_ct = 0;
+  pgfip->zcursor_ct = 0;
+  pgfip->zframe_fpos = nullptr;
+  pgfip->zcursors = nullptr;
+  pgfip->zparallel_for = nullptr;
+  pgfip->zrunner_arg = nullptr;
+  pgfip->ldbase_backrefs = nullptr;
+  pgfip->ldbase_reach = nullptr;
 
   uint64_t fsize;
   const unsigned char* fread_ptr;
@@ -799,6 +869,10 @@ PglErr PgfiInitPhase1(const char* fname, const char* pgi_fname, uint32_t raw_var
       snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is a .pgen.pgi index file, rather than a .pgen file.\n", fname);
       return kPglRetMalformedInput;
     }
+    if (unlikely(file_type_code == 0x40)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is a .pgen.smaj sample-major companion file, rather than a .pgen file.\n", fname);
+      return kPglRetMalformedInput;
+    }
     if (unlikely(fsize < 12)) {
       snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is too small to be a valid .pgen file.\n", fname);
       return kPglRetMalformedInput;
@@ -905,12 +979,20 @@ PglErr PgfiInitPhase1(const char* fname, const char* pgi_fname, uint32_t raw_var
     *pgfi_alloc_cacheline_ct_ptr = 0;
     return kPglRetSuccess;
   }
-  if (unlikely((file_type_code >= 0x12) && ((file_type_code & 0xfe) != 0x20))) {
+  // 0x82..0x8f: developer-range zstd/PBWT/LD-window variants of 0x10/0x11
+  const uint32_t dev_mode_bits = ((file_type_code & 0xf0) == 0x80)? (file_type_code & 0x0e) : 0;
+  if (unlikely((file_type_code >= 0x12) && ((file_type_code & 0xfe) != 0x20) && (!dev_mode_bits))) {
     snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Third byte of %s does not correspond to a storage mode supported by this version of pgenlib.\n", fname);
     return kPglRetNotYetSupported;
   }
   // plink 2 binary, general-purpose
   pgfip->extensions_present = file_type_code & 1;
+  if (dev_mode_bits & 4) {
+    pgfip->gflags |= kfPgenGlobalPbwtHphase;
+  }
+  if (dev_mode_bits & 8) {
+    pgfip->gflags |= kfPgenGlobalLdWindow;
+  }
   pgfip->const_fpos_offset = 0;
   pgfip->const_vrtype = UINT32_MAX;
   pgfip->const_vrec_width = 0;
@@ -951,7 +1033,23 @@ PglErr PgfiInitPhase1(const char* fname, const char* pgi_fname, uint32_t raw_var
       return kPglRetNotYetSupported;
     }
   }
-  *pgfi_alloc_cacheline_ct_ptr = CountPgfiAllocCachelinesRequired(raw_variant_ct);
+  uintptr_t pgfi_alloc_cacheline_ct = CountPgfiAllocCachelinesRequired(raw_variant_ct);
+  if (dev_mode_bits & 2) {
+    // per-vblock zstd frames; frame offset table is loaded into the same
+    // allocation
+    const uint32_t zframe_ct = DivUp(raw_variant_ct, kPglVblockSize);
+    pgfip->zframe_ct = zframe_ct;
+    pgfi_alloc_cacheline_ct += Int64CtToCachelineCt(zframe_ct + 1);
+  }
+  if (pgfip->gflags & kfPgenGlobalLdWindow) {
+    if (unlikely(header_ctrl & 8)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen header.\n");
+      return kPglRetMalformedInput;
+    }
+    // LD base back-reference and reach tables
+    pgfi_alloc_cacheline_ct += 2 * DivUp(raw_variant_ct, kCacheline);
+  }
+  *pgfi_alloc_cacheline_ct_ptr = pgfi_alloc_cacheline_ct;
   return kPglRetSuccess;
 }
 
@@ -1194,23 +1292,48 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
   uint32_t vblock_ct_m1 = (raw_variant_ct - 1) / kPglVblockSize;
   uint32_t max_vrec_width = 0;
   uint64_t variant_fpos;
-  if (vblock_idx_start) {
-    if (unlikely(fseeko(header_ff, vblock_idx_start * sizeof(int64_t), SEEK_CUR))) {
+  const uint32_t zframe_ct = pgfip->zframe_ct;
+  if (zframe_ct) {
+    // The whole frame offset table is needed for random access.  It's
+    // followed by the end of the last frame.
+    if (unlikely(vblock_idx_start)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitPhase2Ex() does not yet support nonzero vblock_idx_start for zstd-compressed .pgen files.\n");
+      return kPglRetNotYetSupported;
+    }
+    uint64_t* zframe_fpos = &(var_fpos_iter[(1 + (raw_variant_ct / kInt64PerCacheline)) * kInt64PerCacheline]);
+    if (unlikely(!fread_unlocked(zframe_fpos, (zframe_ct + 1) * sizeof(int64_t), 1, header_ff))) {
+      FillPgenHeaderReadErrstr(header_ff, is_pgi, errstr_buf);
+      return kPglRetReadFail;
+    }
+    for (uint32_t frame_idx = 0; frame_idx != zframe_ct; ++frame_idx) {
+      if (unlikely(zframe_fpos[frame_idx] > zframe_fpos[frame_idx + 1])) {
+        snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid zstd frame offset table in .pgen file.\n");
+        return kPglRetMalformedInput;
+      }
+    }
+    pgfip->zframe_fpos = zframe_fpos;
+    // The uncompressed record stream is defined to start where the first
+    // frame does.
+    variant_fpos = zframe_fpos[0];
+  } else {
+    if (vblock_idx_start) {
+      if (unlikely(fseeko(header_ff, vblock_idx_start * sizeof(int64_t), SEEK_CUR))) {
+        FillPgenHeaderReadErrstrFromNzErrno(is_pgi, errstr_buf);
+        return kPglRetReadFail;
+      }
+    }
+    if (unlikely(!fread_unlocked(&variant_fpos, sizeof(int64_t), 1, header_ff))) {
+      FillPgenHeaderReadErrstr(header_ff, is_pgi, errstr_buf);
+      return kPglRetReadFail;
+    }
+    // May also need to load the rest of these values in the future, if we
+    // want to support dynamic insertion into a memory-mapped file.  But skip
+    // them for now.
+    if (unlikely(fseeko(header_ff, (vblock_ct_m1 - vblock_idx_start) * sizeof(int64_t), SEEK_CUR))) {
       FillPgenHeaderReadErrstrFromNzErrno(is_pgi, errstr_buf);
       return kPglRetReadFail;
     }
   }
-  if (unlikely(!fread_unlocked(&variant_fpos, sizeof(int64_t), 1, header_ff))) {
-    FillPgenHeaderReadErrstr(header_ff, is_pgi, errstr_buf);
-    return kPglRetReadFail;
-  }
-  // May also need to load the rest of these values in the future, if we want
-  // to support dynamic insertion into a memory-mapped file.  But skip them
-  // for now.
-  if (unlikely(fseeko(header_ff, (vblock_ct_m1 - vblock_idx_start) * sizeof(int64_t), SEEK_CUR))) {
-    FillPgenHeaderReadErrstrFromNzErrno(is_pgi, errstr_buf);
-    return kPglRetReadFail;
-  }
   const uint32_t vrtype_and_fpos_storage = header_ctrl & 15;
   const uint32_t alt_allele_ct_byte_ct = (header_ctrl >> 4) & 3;
   if (alt_allele_ct_byte_ct) {
@@ -1220,6 +1343,18 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
       return kPglRetImproperFunctionCall;
     }
   }
+  unsigned char* ldbase_backrefs_iter = nullptr;
+  unsigned char* ldbase_reach_iter = nullptr;
+  if (pgfip->gflags & kfPgenGlobalLdWindow) {
+    uintptr_t ldbase_backrefs_offset = CountPgfiAllocCachelinesRequired(raw_variant_ct) * kCacheline;
+    if (zframe_ct) {
+      ldbase_backrefs_offset += Int64CtToCachelineCt(zframe_ct + 1) * kCacheline;
+    }
+    ldbase_backrefs_iter = &(pgfi_alloc[ldbase_backrefs_offset]);
+    pgfip->ldbase_backrefs = ldbase_backrefs_iter;
+    ldbase_reach_iter = &(ldbase_backrefs_iter[DivUp(raw_variant_ct, kCacheline) * kCacheline]);
+    pgfip->ldbase_reach = ldbase_reach_iter;
+  }
   uint32_t vblock_idx = vblock_idx_start;
   vblock_ct_m1 = (vidx_end - 1) / kPglVblockSize;
   if (vblock_idx) {
@@ -1227,6 +1362,9 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
     if (nonref_flags_stored) {
       header_vblock_byte_ct += kPglVblockSize / CHAR_BIT;
     }
+    if (ldbase_backrefs_iter) {
+      header_vblock_byte_ct += kPglVblockSize;
+    }
     if (vrtype_and_fpos_storage & 8) {
       header_vblock_byte_ct += kPglVblockSize >> (10 - vrtype_and_fpos_storage);
     } else {
@@ -1251,6 +1389,7 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
       }
       cur_vblock_variant_ct = ModNz(vidx_end, kPglVblockSize);
     }
+    const unsigned char* vblock_vrtypes = vrtypes_iter;
     // 1. handle vrtypes and var_fpos.
     if (vrtype_and_fpos_storage >= 8) {
       // Special encodings.
@@ -1481,6 +1620,54 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
       }
       nonref_flags_iter = &(nonref_flags_iter[cur_byte_ct]);
     }
+    // 4. LD base back-references?
+    if (ldbase_backrefs_iter) {
+      if (unlikely(!fread_unlocked(ldbase_backrefs_iter, cur_vblock_variant_ct, 1, header_ff))) {
+        FillPgenHeaderReadErrstr(header_ff, is_pgi, errstr_buf);
+        return kPglRetReadFail;
+      }
+      // each back-reference must resolve to an earlier variant in the same
+      // vblock
+      uint32_t ldbase_ct = 0;
+      for (uint32_t cur_vblock_vidx = 0; cur_vblock_vidx != cur_vblock_variant_ct; ++cur_vblock_vidx) {
+        const uint32_t backref = ldbase_backrefs_iter[cur_vblock_vidx];
+        if (VrtypeLdCompressed(vblock_vrtypes[cur_vblock_vidx])) {
+          if (unlikely(backref >= ldbase_ct)) {
+            snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid LD base back-reference in .pgen header.\n");
+            return kPglRetMalformedInput;
+          }
+        } else {
+          if (unlikely(backref)) {
+            snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid LD base back-reference in .pgen header.\n");
+            return kPglRetMalformedInput;
+          }
+          ++ldbase_ct;
+        }
+      }
+      // Backward pass for ldbase_reach.  Ranks are 0-based indexes among the
+      // vblock's non-LD-compressed variants.  A reach can't exceed 255: a
+      // later variant's base is at most backref (<= 255) non-LD-compressed
+      // variants before the last one preceding it.
+      uint32_t min_base_rank = UINT32_MAX;
+      uint32_t nonld_ct_before = ldbase_ct;
+      for (uint32_t cur_vblock_vidx = cur_vblock_variant_ct; cur_vblock_vidx; ) {
+        --cur_vblock_vidx;
+        uint32_t own_base_rank;
+        if (VrtypeLdCompressed(vblock_vrtypes[cur_vblock_vidx])) {
+          own_base_rank = nonld_ct_before - 1;
+          const uint32_t base_rank = own_base_rank - ldbase_backrefs_iter[cur_vblock_vidx];
+          if (base_rank < min_base_rank) {
+            min_base_rank = base_rank;
+          }
+        } else {
+          --nonld_ct_before;
+          own_base_rank = nonld_ct_before;
+        }
+        ldbase_reach_iter[cur_vblock_vidx] = (min_base_rank < own_base_rank)? (own_base_rank - min_base_rank) : 0;
+      }
+      ldbase_backrefs_iter = &(ldbase_backrefs_iter[cur_vblock_variant_ct]);
+      ldbase_reach_iter = &(ldbase_reach_iter[cur_vblock_variant_ct]);
+    }
   }
 
   const uint32_t last_word_byte_ct = cur_vblock_variant_ct % kBytesPerWord;
@@ -1496,7 +1683,8 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
     if (vidx_end < raw_variant_ct) {
       const uint32_t vrec_len_byte_ct = 1 + (vrtype_and_fpos_storage & 3);
       const uint32_t phase_or_dosage_present = (vrtype_and_fpos_storage >= 4);
-      const uint64_t ext_fpos = PglHeaderBaseEndOffset(raw_variant_ct, vrec_len_byte_ct, phase_or_dosage_present, nonref_flags_stored);
+      // zstd frame offset table has one extra entry
+      const uint64_t ext_fpos = PglHeaderBaseEndOffset(raw_variant_ct, vrec_len_byte_ct, phase_or_dosage_present, nonref_flags_stored) + (zframe_ct? sizeof(int64_t) : 0) + (pgfip->ldbase_backrefs? raw_variant_ct : 0);
       if (unlikely(fseeko(header_ff, ext_fpos, SEEK_SET))) {
         FillPgenHeaderReadErrstrFromNzErrno(is_pgi, errstr_buf);
         return kPglRetReadFail;
@@ -1667,7 +1855,7 @@ PglErr PgfiInitPhase2Ex(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_
     // vrtype_and_fpos_storage == 8.
     max_vrec_width = NypCtToByteCt(raw_sample_ct);
   }
-  *pgr_alloc_cacheline_ct_ptr = CountPgrAllocCachelinesRequired(raw_sample_ct, new_gflags, max_allele_ct, use_blockload? 0 : max_vrec_width);
+  *pgr_alloc_cacheline_ct_ptr = CountPgrAllocCachelinesRequired(raw_sample_ct, new_gflags | (pgfip->gflags & (kfPgenGlobalPbwtHphase | kfPgenGlobalLdWindow)), max_allele_ct, use_blockload? 0 : max_vrec_width);
   *max_vrec_width_ptr = max_vrec_width;
   return kPglRetSuccess;
 }
@@ -1787,7 +1975,7 @@ PglErr PgfiInitLoadExts(PgenHeaderCtrl header_ctrl, PgenFileInfo* pgfip, PgenExt
     const uint32_t vrec_len_byte_ct = 1 + (vrtype_and_fpos_storage & 3);
     const uint32_t phase_or_dosage_present = (vrtype_and_fpos_storage >= 4);
     const uint32_t nonref_flags_stored = ((header_ctrl >> 6) == 3);
-    const uint64_t ext_fpos = PglHeaderBaseEndOffset(pgfip->raw_variant_ct, vrec_len_byte_ct, phase_or_dosage_present, nonref_flags_stored);
+    const uint64_t ext_fpos = PglHeaderBaseEndOffset(pgfip->raw_variant_ct, vrec_len_byte_ct, phase_or_dosage_present, nonref_flags_stored) + (pgfip->zframe_ct? sizeof(int64_t) : 0) + (pgfip->ldbase_backrefs? pgfip->raw_variant_ct : 0);
     if (unlikely(fseeko(header_ff, ext_fpos, SEEK_SET))) {
       FillPgenHeaderReadErrstrFromNzErrno(is_pgi, errstr_buf);
       return kPglRetReadFail;
@@ -1886,14 +2074,61 @@ uint32_t GetLdbaseVidx(const unsigned char* vrtypes, uint32_t cur_vidx) {
 #endif
 }
 
+// Like GetLdbaseVidx(), but also follows LD-window-mode back-references.
+// Assumes vidx is LD-compressed.
+static uint32_t GetPgfiLdbaseVidx(const PgenFileInfo* pgfip, uint32_t vidx) {
+  const unsigned char* vrtypes = pgfip->vrtypes;
+  uint32_t ldbase_vidx = GetLdbaseVidx(vrtypes, vidx);
+  const unsigned char* ldbase_backrefs = pgfip->ldbase_backrefs;
+  if (ldbase_backrefs) {
+    // validated by PgfiInitPhase2Ex() to stay within the vblock
+    for (uint32_t backref = ldbase_backrefs[vidx]; backref; --backref) {
+      ldbase_vidx = GetLdbaseVidx(vrtypes, ldbase_vidx);
+    }
+  }
+  return ldbase_vidx;
+}
+
+// Returns 1 iff the (non-LD-compressed) variant vidx is the LD base of the
+// next variant, in which case readers should cache it.
+static inline uint32_t IsNextLdbase(const PgenFileInfo* pgfip, uint32_t vidx) {
+  if (!VrtypeLdCompressed(pgfip->vrtypes[vidx + 1])) {
+    return 0;
+  }
+  return (!pgfip->ldbase_backrefs) || (!pgfip->ldbase_backrefs[vidx + 1]);
+}
+
+// Returns the first variant whose record must be loaded alongside vidx's
+// (and those of any later variants in the same load).
+static uint32_t GetPgfiLoadStartVidx(const PgenFileInfo* pgfip, uint32_t vidx) {
+  if (PbwtHphaseActive(pgfip->gflags)) {
+    // PBWT haplotype order is replayed from the last reset point, and any
+    // replayed variant may be LD-compressed.
+    vidx = RoundDownPow2(vidx, kPglPbwtResetInterval);
+  }
+  const unsigned char* vrtypes = pgfip->vrtypes;
+  if (!vrtypes) {
+    return vidx;
+  }
+  uint32_t ldbase_vidx = vidx;
+  if ((vrtypes[vidx] & 6) == 2) {
+    ldbase_vidx = GetLdbaseVidx(vrtypes, vidx);
+  }
+  const unsigned char* ldbase_reach = pgfip->ldbase_reach;
+  if (ldbase_reach) {
+    // later variants in the load may reference earlier LD bases
+    for (uint32_t reach = ldbase_reach[vidx]; reach; --reach) {
+      ldbase_vidx = GetLdbaseVidx(vrtypes, ldbase_vidx);
+    }
+  }
+  return ldbase_vidx;
+}
+
 uint64_t GetPgfiLdbaseFpos(const PgenFileInfo* pgfip, uintptr_t vidx) {
   if (!pgfip->var_fpos) {
     return pgfip->const_fpos_offset + pgfip->const_vrec_width * S_CAST(uint64_t, vidx);
   }
-  if (pgfip->vrtypes && ((pgfip->vrtypes[vidx] & 6) == 2)) {
-    vidx = GetLdbaseVidx(pgfip->vrtypes, vidx);
-  }
-  return pgfip->var_fpos[vidx];
+  return pgfip->var_fpos[GetPgfiLoadStartVidx(pgfip, vidx)];
 }
 
 uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const PgenFileInfo* pgfip, uint32_t variant_ct, uint32_t block_size) {
@@ -1932,10 +2167,9 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
       variant_uidx_end = 1 + FindLast1BitBefore(variant_include, variant_uidx_end);
     }
     if (var_fpos) {
-      if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
-        // need to start loading from LD-buddy
-        variant_uidx_start = GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start);
-      }
+      // need to start loading from LD-buddy (or PBWT reset point, or
+      // earliest LD base referenced in LD-window mode)
+      variant_uidx_start = GetPgfiLoadStartVidx(pgfip, variant_uidx_start);
       uint64_t cur_block_byte_ct = var_fpos[variant_uidx_end] - var_fpos[variant_uidx_start];
       if (cur_block_byte_ct > max_block_byte_ct) {
         max_block_byte_ct = cur_block_byte_ct;
@@ -1958,22 +2192,363 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
   return DivUpU64(max_block_byte_ct, kCacheline);
 }
 
-PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
+#ifndef NO_PREAD
+// Returns 1 on read failure, with errno set to 0 on premature EOF.
+static BoolErr PreadChecked(int32_t fd, uint64_t fpos, uintptr_t len, unsigned char* dst) {
+  while (len) {
+    const ssize_t cur_bytes_read = pread(fd, dst, MINV(len, S_CAST(uintptr_t, kMaxBytesPerIO)), fpos);
+    if (cur_bytes_read <= 0) {
+      if (!cur_bytes_read) {
+        errno = 0;
+        return 1;
+      }
+      if (errno == EINTR) {
+        continue;
+      }
+      return 1;
+    }
+    dst = &(dst[S_CAST(uintptr_t, cur_bytes_read)]);
+    fpos += S_CAST(uintptr_t, cur_bytes_read);
+    len -= S_CAST(uintptr_t, cur_bytes_read);
+  }
+  return 0;
+}
+#endif
+
+// Size of each zstd cursor's input and skip buffers.
+CONSTI32(kZframeBufSize, 1 << 17);
+
+static BoolErr InitZframeCursor(PgenZframeCursor* zcp) {
+  zcp->frame_idx = UINT32_MAX;
+  zcp->in_byte_ct = 0;
+  zcp->dctx = ZSTD_createDCtx();
+  zcp->inbuf = S_CAST(unsigned char*, malloc(2 * kZframeBufSize));
+  if (unlikely((!zcp->dctx) || (!zcp->inbuf))) {
+    return 1;
+  }
+  zcp->discardbuf = &(zcp->inbuf[kZframeBufSize]);
+  return 0;
+}
+
+static void CleanupZframeCursor(PgenZframeCursor* zcp) {
+  // both functions are no-ops on nullptr
+  ZSTD_freeDCtx(zcp->dctx);
+  free(zcp->inbuf);
+  zcp->dctx = nullptr;
+  zcp->inbuf = nullptr;
+}
+
+// Decompresses bytes [out_fpos, out_fpos + len) of the uncompressed variant
+// record stream to dst; this range must be contained in the given frame.
+// Compressed input is read with pread() if fd != -1, and from ff otherwise.
+// When the target lies ahead of the cursor's current position in the same
+// frame, decompression resumes from there; otherwise, the frame is restarted.
+// Returns 1 on read failure, with errno set to 0 on premature EOF or invalid
+// zstd data.
+static BoolErr ZframeRead(const PgenFileInfo* pgfip, uint32_t frame_idx, uint64_t out_fpos, uintptr_t len, FILE* ff, int32_t fd, PgenZframeCursor* zcp, unsigned char* dst) {
+  if ((zcp->frame_idx != frame_idx) || (zcp->out_fpos > out_fpos)) {
+    ZSTD_DCtx_reset(zcp->dctx, ZSTD_reset_session_only);
+    zcp->frame_idx = frame_idx;
+    zcp->in_fpos = pgfip->zframe_fpos[frame_idx];
+    zcp->out_fpos = pgfip->var_fpos[frame_idx * kPglVblockSize];
+    zcp->in_pos = 0;
+    zcp->in_size = 0;
+  }
+  const uint64_t in_end = pgfip->zframe_fpos[frame_idx + 1];
+  while (len) {
+    if (zcp->in_pos == zcp->in_size) {
+      const uint64_t in_remaining = in_end - zcp->in_fpos;
+      if (unlikely(!in_remaining)) {
+        goto ZframeRead_ret_INVALID;
+      }
+      const uint32_t cur_read_size = MINV(in_remaining, kZframeBufSize);
+#ifndef NO_PREAD
+      if (fd != -1) {
+        if (unlikely(PreadChecked(fd, zcp->in_fpos, cur_read_size, zcp->inbuf))) {
+          zcp->frame_idx = UINT32_MAX;
+          return 1;
+        }
+      } else {
+#endif
+        if (unlikely(fseeko(ff, zcp->in_fpos, SEEK_SET) || (!fread_unlocked(zcp->inbuf, cur_read_size, 1, ff)))) {
+          if (feof_unlocked(ff)) {
+            errno = 0;
+          }
+          zcp->frame_idx = UINT32_MAX;
+          return 1;
+        }
+#ifndef NO_PREAD
+      }
+#endif
+      zcp->in_fpos += cur_read_size;
+      zcp->in_byte_ct += cur_read_size;
+      zcp->in_pos = 0;
+      zcp->in_size = cur_read_size;
+    }
+    ZSTD_inBuffer zib = {zcp->inbuf, zcp->in_size, zcp->in_pos};
+    // Bytes before out_fpos are decompressed to discardbuf.
+    const uint32_t skipping = (zcp->out_fpos < out_fpos);
+    ZSTD_outBuffer zob;
+    if (skipping) {
+      zob.dst = zcp->discardbuf;
+      zob.size = MINV(out_fpos - zcp->out_fpos, kZframeBufSize);
+    } else {
+      zob.dst = dst;
+      zob.size = len;
+    }
+    zob.pos = 0;
+    const uintptr_t zret = ZSTD_decompressStream(zcp->dctx, &zob, &zib);
+    if (unlikely(ZSTD_isError(zret))) {
+      goto ZframeRead_ret_INVALID;
+    }
+    zcp->in_pos = zib.pos;
+    zcp->out_fpos += zob.pos;
+    if (!skipping) {
+      dst = &(dst[zob.pos]);
+      len -= zob.pos;
+    }
+    if (unlikely((!zret) && len)) {
+      // frame ended too early
+      goto ZframeRead_ret_INVALID;
+    }
+  }
+  return 0;
+ ZframeRead_ret_INVALID:
+  zcp->frame_idx = UINT32_MAX;
+  errno = 0;
+  return 1;
+}
+
+static PglErr PgfiInitZstdCursors(uint32_t cursor_ct, PgenFileInfo* pgfip) {
+  if (cursor_ct <= pgfip->zcursor_ct) {
+    return kPglRetSuccess;
+  }
+  PgenZframeCursor* new_zcursors = S_CAST(PgenZframeCursor*, realloc(pgfip->zcursors, cursor_ct * sizeof(PgenZframeCursor)));
+  if (unlikely(!new_zcursors)) {
+    return kPglRetNomem;
+  }
+  pgfip->zcursors = new_zcursors;
+  for (uint32_t cursor_idx = pgfip->zcursor_ct; cursor_idx != cursor_ct; ++cursor_idx) {
+    PgenZframeCursor* zcp = &(new_zcursors[cursor_idx]);
+    if (unlikely(InitZframeCursor(zcp))) {
+      CleanupZframeCursor(zcp);
+      return kPglRetNomem;
+    }
+    pgfip->zcursor_ct = cursor_idx + 1;
+  }
+  return kPglRetSuccess;
+}
+
+PglErr PgfiInitZstdRunner(uint32_t cursor_ct, PglParallelForFunc parallel_for, void* runner_arg, PgenFileInfo* pgfip) {
+  if (!pgfip->zframe_ct) {
+    return kPglRetSuccess;
+  }
+#ifdef NO_PREAD
+  // concurrent cursors would fight over shared_ff's file position
+  cursor_ct = 1;
+#endif
+  // no point in having more cursors than frames
+  if (cursor_ct > pgfip->zframe_ct) {
+    cursor_ct = pgfip->zframe_ct;
+  }
+  if (cursor_ct > kBitsPerWord) {
+    cursor_ct = kBitsPerWord;
+  }
+  if ((!parallel_for) || (cursor_ct < 2)) {
+    parallel_for = nullptr;
+    runner_arg = nullptr;
+  }
+  pgfip->zparallel_for = parallel_for;
+  pgfip->zrunner_arg = runner_arg;
+  return PgfiInitZstdCursors(cursor_ct, pgfip);
+}
+
+typedef struct ZframeJobStruct {
+  unsigned char* dst;
+  uint64_t out_fpos;
+  uintptr_t len;
+  uint32_t frame_idx;
+} ZframeJob;
+
+CONSTI32(kZframeJobBatchSize, 64);
+
+// Frame f is always handled by cursor (f % zcursor_ct), so a cursor which
+// stopped partway through a frame can resume there on the next
+// PgfiMultiread() call.  Task i of a batch runs all jobs for cursor
+// cursor_idxs[i].
+typedef struct ZframeBatchCtxStruct {
+  const PgenFileInfo* pgfip;
+  const ZframeJob* jobs;
+  uint32_t job_ct;
+  uint32_t cursor_idxs[kBitsPerWord];
+  BoolErr errs[kBitsPerWord];
+  int32_t errnos[kBitsPerWord];
+} ZframeBatchCtx;
+
+static void ZframeBatchTask(void* raw_ctx, uint32_t task_idx) {
+  ZframeBatchCtx* ctx = S_CAST(ZframeBatchCtx*, raw_ctx);
+  const PgenFileInfo* pgfip = ctx->pgfip;
+  const uint32_t cursor_idx = ctx->cursor_idxs[task_idx];
+  PgenZframeCursor* zcp = &(pgfip->zcursors[cursor_idx]);
+  const uint32_t cursor_ct = pgfip->zcursor_ct;
+  int32_t fd = -1;
+#ifndef NO_PREAD
+  fd = fileno(pgfip->shared_ff);
+#endif
+  const ZframeJob* jobs = ctx->jobs;
+  const uint32_t job_ct = ctx->job_ct;
+  ctx->errs[task_idx] = 0;
+  for (uint32_t job_idx = 0; job_idx != job_ct; ++job_idx) {
+    const ZframeJob* jobp = &(jobs[job_idx]);
+    if ((jobp->frame_idx % cursor_ct) != cursor_idx) {
+      continue;
+    }
+    if (unlikely(ZframeRead(pgfip, jobp->frame_idx, jobp->out_fpos, jobp->len, pgfip->shared_ff, fd, zcp, jobp->dst))) {
+      ctx->errs[task_idx] = 1;
+      ctx->errnos[task_idx] = errno;
+      return;
+    }
+  }
+}
+
+static BoolErr ZframeBatchFlush(const ZframeJob* jobs, uint32_t job_ct, const PgenFileInfo* pgfip) {
+  if (!job_ct) {
+    return 0;
+  }
+  const uint32_t cursor_ct = pgfip->zcursor_ct;
+  uintptr_t used_cursors = 0;
+  for (uint32_t job_idx = 0; job_idx != job_ct; ++job_idx) {
+    used_cursors |= k1LU << (jobs[job_idx].frame_idx % cursor_ct);
+  }
+  ZframeBatchCtx ctx;
+  ctx.pgfip = pgfip;
+  ctx.jobs = jobs;
+  ctx.job_ct = job_ct;
+  uint32_t task_ct = 0;
+  for (; used_cursors; used_cursors &= used_cursors - 1) {
+    ctx.cursor_idxs[task_ct++] = ctzw(used_cursors);
+  }
+  if ((task_ct == 1) || (!pgfip->zparallel_for)) {
+    for (uint32_t task_idx = 0; task_idx != task_ct; ++task_idx) {
+      ZframeBatchTask(&ctx, task_idx);
+    }
+  } else {
+    pgfip->zparallel_for(pgfip->zrunner_arg, task_ct, ZframeBatchTask, &ctx);
+  }
+  for (uint32_t task_idx = 0; task_idx != task_ct; ++task_idx) {
+    if (unlikely(ctx.errs[task_idx])) {
+      errno = ctx.errnos[task_idx];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// PgfiMultiread() implementation for zstd modes.  block_base receives the
+// same bytes it would for an uncompressed file, except that gaps between
+// separately-read ranges are left uninitialized.
+static PglErr PgfiMultireadZstd(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
+  if (!pgfip->zcursor_ct) {
+    PglErr reterr = PgfiInitZstdCursors(1, pgfip);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+  }
+  const uint64_t* var_fpos = pgfip->var_fpos;
+  uint32_t read_uidx_start = GetPgfiLoadStartVidx(pgfip, variant_uidx_start);
+  const uint64_t block_offset = var_fpos[read_uidx_start];
+  pgfip->block_offset = block_offset;
+  unsigned char* block_base = K_CAST(unsigned char*, pgfip->block_base);
+  PgenZframeCursor* zcursors = pgfip->zcursors;
+  const uint32_t cursor_ct = pgfip->zcursor_ct;
+  uint64_t in_byte_ct_start = 0;
+  for (uint32_t cursor_idx = 0; cursor_idx != cursor_ct; ++cursor_idx) {
+    in_byte_ct_start += zcursors[cursor_idx].in_byte_ct;
+  }
+  ZframeJob jobs[kZframeJobBatchSize];
+  uint32_t job_ct = 0;
+  // Unlike the uncompressed case, there's no point in merging ranges across
+  // a frame boundary, but within a frame it's always cheaper to decompress
+  // through a gap than to restart.
+  do {
+    uint32_t cur_read_uidx_start = read_uidx_start;
+    uint32_t cur_read_uidx_end;
+    while (1) {
+      cur_read_uidx_end = variant_uidx_end;
+      if (cur_read_uidx_end - variant_uidx_start == load_variant_ct) {
+        load_variant_ct = 0;
+        break;
+      }
+      cur_read_uidx_end = AdvTo0Bit(variant_include, variant_uidx_start);
+      load_variant_ct -= cur_read_uidx_end - variant_uidx_start;
+      if (!load_variant_ct) {
+        break;
+      }
+      variant_uidx_start = AdvTo1Bit(variant_include, cur_read_uidx_end);
+      read_uidx_start = GetPgfiLoadStartVidx(pgfip, variant_uidx_start);
+      if (read_uidx_start <= cur_read_uidx_end) {
+        continue;
+      }
+      if ((read_uidx_start / kPglVblockSize) != ((cur_read_uidx_end - 1) / kPglVblockSize)) {
+        break;
+      }
+    }
+    // [cur_read_uidx_start, cur_read_uidx_end) may span multiple frames.
+    for (uint32_t frame_idx = cur_read_uidx_start / kPglVblockSize; ; ++frame_idx) {
+      const uint32_t frame_uidx_end = (frame_idx + 1) * kPglVblockSize;
+      const uint32_t seg_uidx_end = MINV(frame_uidx_end, cur_read_uidx_end);
+      const uint64_t seg_start_fpos = var_fpos[MAXV(cur_read_uidx_start, frame_idx * kPglVblockSize)];
+      const uint64_t seg_end_fpos = var_fpos[seg_uidx_end];
+      if (seg_end_fpos != seg_start_fpos) {
+        if (job_ct == kZframeJobBatchSize) {
+          if (unlikely(ZframeBatchFlush(jobs, job_ct, pgfip))) {
+            return kPglRetReadFail;
+          }
+          job_ct = 0;
+        }
+        ZframeJob* jobp = &(jobs[job_ct++]);
+        jobp->dst = &(block_base[seg_start_fpos - block_offset]);
+        jobp->out_fpos = seg_start_fpos;
+        jobp->len = seg_end_fpos - seg_start_fpos;
+        jobp->frame_idx = frame_idx;
+      }
+      if (seg_uidx_end == cur_read_uidx_end) {
+        break;
+      }
+    }
+  } while (load_variant_ct);
+  if (unlikely(ZframeBatchFlush(jobs, job_ct, pgfip))) {
+    return kPglRetReadFail;
+  }
+  uint64_t in_byte_ct_end = 0;
+  for (uint32_t cursor_idx = 0; cursor_idx != cursor_ct; ++cursor_idx) {
+    in_byte_ct_end += zcursors[cursor_idx].in_byte_ct;
+  }
+  pgfip->multiread_byte_ct += in_byte_ct_end - in_byte_ct_start;
+  return kPglRetSuccess;
+}
+
+static PglErr PgfiMultireadUntimed(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
   // we could permit 0, but that encourages lots of unnecessary thread wakeups
   assert(load_variant_ct);
+  if (pgfip->mmap_base) {
+    // Everything's already "loaded".
+    pgfip->block_base = pgfip->mmap_base;
+    pgfip->block_offset = 0;
+    return kPglRetSuccess;
+  }
   if (variant_include) {
     variant_uidx_start = AdvTo1Bit(variant_include, variant_uidx_start);
   }
   assert(variant_uidx_start < pgfip->raw_variant_ct);
-  uint64_t block_offset;
-  if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
-    // need to start loading from LD-buddy
-    // assume for now that we can't skip any variants between the LD-buddy and
-    // the actual first variant; should remove this assumption later
-    block_offset = pgfip->var_fpos[GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start)];
-  } else {
-    block_offset = GetPgfiFpos(pgfip, variant_uidx_start);
-  }
+  if (pgfip->zframe_ct) {
+    return PgfiMultireadZstd(variant_include, variant_uidx_start, variant_uidx_end, load_variant_ct, pgfip);
+  }
+  // need to start loading from LD-buddy (or PBWT reset point, or earliest
+  // LD base referenced in LD-window mode)
+  // assume for now that we can't skip any variants between the LD-buddy and
+  // the actual first variant; should remove this assumption later
+  const uint64_t block_offset = GetPgfiLdbaseFpos(pgfip, variant_uidx_start);
   pgfip->block_offset = block_offset;
   uint64_t next_read_start_fpos = block_offset;
   // break this up into multiple freads whenever this lets us skip an entire
@@ -1998,12 +2573,14 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
       }
       variant_uidx_start = AdvTo1Bit(variant_include, cur_read_uidx_end);
       next_read_start_fpos = GetPgfiFpos(pgfip, variant_uidx_start);
-      if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
-        const uint32_t variant_read_uidx_start = GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start);
-        if (variant_read_uidx_start <= cur_read_uidx_end) {
-          continue;
+      if (pgfip->var_fpos) {
+        const uint32_t variant_read_uidx_start = GetPgfiLoadStartVidx(pgfip, variant_uidx_start);
+        if (variant_read_uidx_start != variant_uidx_start) {
+          if (variant_read_uidx_start <= cur_read_uidx_end) {
+            continue;
+          }
+          next_read_start_fpos = pgfip->var_fpos[variant_read_uidx_start];
         }
-        next_read_start_fpos = pgfip->var_fpos[variant_read_uidx_start];
       }
       // bugfix: can't use do..while, since previous "continue" needs to skip
       // this check
@@ -2022,14 +2599,393 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
       }
       return kPglRetReadFail;
     }
+    pgfip->multiread_byte_ct += len;
   } while (load_variant_ct);
   return kPglRetSuccess;
 }
 
+PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
+  const uint64_t start_ns = MonotonicNs();
+  const PglErr reterr = PgfiMultireadUntimed(variant_include, variant_uidx_start, variant_uidx_end, load_variant_ct, pgfip);
+  pgfip->multiread_ns += MonotonicNs() - start_ns;
+  return reterr;
+}
+
+void PgfiMultireadAdvise(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, const PgenFileInfo* pgfip) {
+#ifndef _WIN32
+  FILE* shared_ff = pgfip->shared_ff;
+  if ((!shared_ff) || pgfip->mmap_base) {
+    return;
+  }
+  if (variant_include) {
+    variant_uidx_start = AdvBoundedTo1Bit(variant_include, variant_uidx_start, variant_uidx_end);
+    if (variant_uidx_start == variant_uidx_end) {
+      return;
+    }
+  }
+  uint64_t start_fpos = GetPgfiLdbaseFpos(pgfip, variant_uidx_start);
+  // Gaps between the requested variants are not worth excluding here; the
+  // kernel only schedules the reads, and PgfiMultiread() skips them anyway.
+  uint64_t end_fpos = GetPgfiFpos(pgfip, variant_uidx_end);
+  if (pgfip->zframe_ct) {
+    // advise the compressed frames covering the range instead
+    start_fpos = pgfip->zframe_fpos[variant_uidx_start / kPglVblockSize];
+    end_fpos = pgfip->zframe_fpos[DivUp(variant_uidx_end, kPglVblockSize)];
+  }
+  if (end_fpos <= start_fpos) {
+    return;
+  }
+  const int fd = fileno(shared_ff);
+#  if defined(POSIX_FADV_WILLNEED)
+  posix_fadvise(fd, start_fpos, end_fpos - start_fpos, POSIX_FADV_WILLNEED);
+#  elif defined(F_RDADVISE)
+  struct radvisory ra;
+  ra.ra_offset = start_fpos;
+  ra.ra_count = MINV(end_fpos - start_fpos, 0x7fffffff);
+  fcntl(fd, F_RDADVISE, &ra);
+#  endif
+#endif
+}
+
+PglErr PgfiInitMmap(PgfiMmapAdvice advice, PgenFileInfo* pgfip, char* errstr_buf) {
+#ifdef NO_MMAP
+  snprintf(errstr_buf, kPglErrstrBufBlen, "Error: This build of pgenlib does not support mmap mode.\n");
+  return kPglRetNotYetSupported;
+#else
+  FILE* shared_ff = pgfip->shared_ff;
+  if (unlikely((!shared_ff) || pgfip->mmap_base || (pgfip->pread_fd != -1))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitMmap() must be called after PgfiInitPhase2() and before PgrInit(), and cannot be combined with PgfiInitPread().\n");
+    return kPglRetImproperFunctionCall;
+  }
+  if (unlikely(pgfip->zframe_ct)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: mmap mode is not supported for zstd-compressed .pgen files.\n");
+    return kPglRetNotYetSupported;
+  }
+  if (unlikely(fseeko(shared_ff, 0, SEEK_END))) {
+    FillPgenReadErrstrFromNzErrno(errstr_buf);
+    return kPglRetReadFail;
+  }
+  const uint64_t fsize = ftello(shared_ff);
+#ifndef __LP64__
+  if (unlikely(fsize > 0x7fffffff)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen file too large to mmap in 32-bit pgenlib.\n");
+    return kPglRetNomem;
+  }
+#endif
+  void* mmap_result = mmap(nullptr, fsize, PROT_READ, MAP_SHARED, fileno(shared_ff), 0);
+  if (unlikely(mmap_result == MAP_FAILED)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to mmap .pgen file: %s.\n", strerror(errno));
+    return kPglRetReadFail;
+  }
+  if (advice != kPgfiMmapAdviceNormal) {
+    int advice_flag = MADV_RANDOM;
+    if (advice == kPgfiMmapAdviceSequential) {
+      advice_flag = MADV_SEQUENTIAL;
+    } else if (advice == kPgfiMmapAdviceWillneed) {
+      advice_flag = MADV_WILLNEED;
+    }
+    // just a hint, ok to ignore failure
+    madvise(mmap_result, fsize, advice_flag);
+  }
+  // The mapping remains valid after the file is closed.
+  if (unlikely(fclose_null(&pgfip->shared_ff))) {
+    munmap(mmap_result, fsize);
+    FillPgenReadErrstrFromNzErrno(errstr_buf);
+    return kPglRetReadFail;
+  }
+  pgfip->mmap_base = S_CAST(const unsigned char*, mmap_result);
+  pgfip->mmap_byte_ct = fsize;
+  pgfip->block_base = pgfip->mmap_base;
+  pgfip->block_offset = 0;
+  return kPglRetSuccess;
+#endif
+}
+
+PglErr PgfiInitPread(PgenFileInfo* pgfip, char* errstr_buf) {
+#ifdef NO_PREAD
+  snprintf(errstr_buf, kPglErrstrBufBlen, "Error: This build of pgenlib does not support pread mode.\n");
+  return kPglRetNotYetSupported;
+#else
+  FILE* shared_ff = pgfip->shared_ff;
+  if (unlikely((!shared_ff) || pgfip->mmap_base)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitPread() must be called after PgfiInitPhase2() and before PgrInit(), and cannot be combined with PgfiInitMmap().\n");
+    return kPglRetImproperFunctionCall;
+  }
+  pgfip->pread_fd = fileno(shared_ff);
+  return kPglRetSuccess;
+#endif
+}
+
+static inline uintptr_t VcacheStripeStride() {
+  return RoundUpPow2(sizeof(PgenVcacheStripe), kCacheline);
+}
+
+uintptr_t PgfiVcacheAllocByteCt(uint32_t raw_variant_ct, uint32_t raw_sample_ct, uint32_t slot_ct) {
+  uintptr_t byte_ct = RoundUpPow2(sizeof(PgenVariantCache), kCacheline);
+  byte_ct += kPglVcacheMaxStripeCt * VcacheStripeStride();
+  byte_ct += kPglVcacheSubsetCt * BitCtToCachelineCt(raw_sample_ct) * kCacheline;
+  byte_ct += RoundUpPow2(raw_variant_ct * sizeof(int32_t), kCacheline);
+  // slot_vidxs, slot_prevs, slot_nexts, slot_subset_ids
+  byte_ct += 4 * RoundUpPow2(slot_ct * sizeof(int32_t), kCacheline);
+  byte_ct += S_CAST(uintptr_t, slot_ct) * NypCtToCachelineCt(raw_sample_ct) * kCacheline;
+  return byte_ct;
+}
+
+static inline PgenVcacheStripe* GetVcacheStripe(uint32_t stripe_idx, PgenVariantCache* vcache) {
+  return R_CAST(PgenVcacheStripe*, &(vcache->stripes_base[stripe_idx * vcache->stripe_stride]));
+}
+
+static inline void VcacheLock(PgenVcacheStripe* stripe) {
+#ifdef _WIN32
+  EnterCriticalSection(&stripe->lock);
+#else
+  pthread_mutex_lock(&stripe->lock);
+#endif
+}
+
+static inline void VcacheUnlock(PgenVcacheStripe* stripe) {
+#ifdef _WIN32
+  LeaveCriticalSection(&stripe->lock);
+#else
+  pthread_mutex_unlock(&stripe->lock);
+#endif
+}
+
+static void VcacheDestroyLocks(uint32_t stripe_ct, PgenVariantCache* vcache) {
+  for (uint32_t stripe_idx = 0; stripe_idx != stripe_ct; ++stripe_idx) {
+#ifdef _WIN32
+    DeleteCriticalSection(&(GetVcacheStripe(stripe_idx, vcache)->lock));
+#else
+    pthread_mutex_destroy(&(GetVcacheStripe(stripe_idx, vcache)->lock));
+#endif
+  }
+}
+
+// Always acquired in stripe order.
+static void VcacheLockAll(PgenVariantCache* vcache) {
+  const uint32_t stripe_ct = vcache->stripe_ct;
+  for (uint32_t stripe_idx = 0; stripe_idx != stripe_ct; ++stripe_idx) {
+    VcacheLock(GetVcacheStripe(stripe_idx, vcache));
+  }
+}
+
+static void VcacheUnlockAll(PgenVariantCache* vcache) {
+  const uint32_t stripe_ct = vcache->stripe_ct;
+  for (uint32_t stripe_idx = 0; stripe_idx != stripe_ct; ++stripe_idx) {
+    VcacheUnlock(GetVcacheStripe(stripe_idx, vcache));
+  }
+}
+
+PglErr PgfiInitVcache(uint32_t slot_ct, unsigned char* vcache_alloc, PgenFileInfo* pgfip, char* errstr_buf) {
+  if (unlikely((!slot_ct) || pgfip->vcache)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitVcache() requires a positive slot_ct, and can only be called once.\n");
+    return kPglRetImproperFunctionCall;
+  }
+  const uint32_t raw_variant_ct = pgfip->raw_variant_ct;
+  const uint32_t raw_sample_ct = pgfip->raw_sample_ct;
+  const uint32_t stripe_ct = MINV(slot_ct, kPglVcacheMaxStripeCt);
+  unsigned char* alloc_iter = vcache_alloc;
+  PgenVariantCache* vcache = S_CAST(PgenVariantCache*, arena_alloc_raw_rd(sizeof(PgenVariantCache), &alloc_iter));
+  vcache->stripe_stride = VcacheStripeStride();
+  vcache->stripes_base = S_CAST(unsigned char*, arena_alloc_raw(kPglVcacheMaxStripeCt * vcache->stripe_stride, &alloc_iter));
+  const uint32_t subset_cacheline_ct = BitCtToCachelineCt(raw_sample_ct);
+  vcache->subset_sample_includes = S_CAST(uintptr_t*, arena_alloc_raw(kPglVcacheSubsetCt * subset_cacheline_ct * kCacheline, &alloc_iter));
+  vcache->vidx_to_slot = S_CAST(uint32_t*, arena_alloc_raw_rd(raw_variant_ct * sizeof(int32_t), &alloc_iter));
+  vcache->slot_vidxs = S_CAST(uint32_t*, arena_alloc_raw_rd(slot_ct * sizeof(int32_t), &alloc_iter));
+  vcache->slot_prevs = S_CAST(uint32_t*, arena_alloc_raw_rd(slot_ct * sizeof(int32_t), &alloc_iter));
+  vcache->slot_nexts = S_CAST(uint32_t*, arena_alloc_raw_rd(slot_ct * sizeof(int32_t), &alloc_iter));
+  vcache->slot_subset_ids = S_CAST(uint32_t*, arena_alloc_raw_rd(slot_ct * sizeof(int32_t), &alloc_iter));
+  const uint32_t slot_cacheline_ct = NypCtToCachelineCt(raw_sample_ct);
+  vcache->slot_genovecs = S_CAST(uintptr_t*, arena_alloc_raw(S_CAST(uintptr_t, slot_ct) * slot_cacheline_ct * kCacheline, &alloc_iter));
+  for (uint32_t stripe_idx = 0; stripe_idx != stripe_ct; ++stripe_idx) {
+    PgenVcacheStripe* stripe = GetVcacheStripe(stripe_idx, vcache);
+#ifdef _WIN32
+    InitializeCriticalSection(&stripe->lock);
+#else
+    if (unlikely(pthread_mutex_init(&stripe->lock, nullptr))) {
+      VcacheDestroyLocks(stripe_idx, vcache);
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to initialize .pgen decoded-variant cache mutex.\n");
+      return kPglRetThreadCreateFail;
+    }
+#endif
+    stripe->slot_start = (S_CAST(uint64_t, stripe_idx) * slot_ct) / stripe_ct;
+    stripe->slot_end = (S_CAST(uint64_t, stripe_idx + 1) * slot_ct) / stripe_ct;
+    stripe->slot_used_end = stripe->slot_start;
+    stripe->lru_head = UINT32_MAX;
+    stripe->lru_tail = UINT32_MAX;
+    stripe->hit_ct = 0;
+    stripe->miss_ct = 0;
+  }
+  vcache->stripe_ct = stripe_ct;
+  vcache->slot_vec_ct = slot_cacheline_ct * kVecsPerCacheline;
+  vcache->subset_ct = 0;
+  vcache->raw_sample_ctaw = subset_cacheline_ct * kWordsPerCacheline;
+  memset(vcache->vidx_to_slot, 255, raw_variant_ct * sizeof(int32_t));
+  pgfip->vcache = vcache;
+  return kPglRetSuccess;
+}
+
+void PgfiVcacheClear(PgenFileInfo* pgfip) {
+  PgenVariantCache* vcache = pgfip->vcache;
+  if (!vcache) {
+    return;
+  }
+  VcacheLockAll(vcache);
+  const uint32_t stripe_ct = vcache->stripe_ct;
+  for (uint32_t stripe_idx = 0; stripe_idx != stripe_ct; ++stripe_idx) {
+    PgenVcacheStripe* stripe = GetVcacheStripe(stripe_idx, vcache);
+    const uint32_t slot_used_end = stripe->slot_used_end;
+    for (uint32_t slot_idx = stripe->slot_start; slot_idx != slot_used_end; ++slot_idx) {
+      vcache->vidx_to_slot[vcache->slot_vidxs[slot_idx]] = UINT32_MAX;
+    }
+    stripe->slot_used_end = stripe->slot_start;
+    stripe->lru_head = UINT32_MAX;
+    stripe->lru_tail = UINT32_MAX;
+  }
+  vcache->subset_ct = 0;
+  VcacheUnlockAll(vcache);
+}
+
+void PgfiVcacheGetStats(PgenFileInfo* pgfip, uint64_t* hit_ct_ptr, uint64_t* miss_ct_ptr) {
+  PgenVariantCache* vcache = pgfip->vcache;
+  uint64_t hit_ct = 0;
+  uint64_t miss_ct = 0;
+  if (vcache) {
+    const uint32_t stripe_ct = vcache->stripe_ct;
+    for (uint32_t stripe_idx = 0; stripe_idx != stripe_ct; ++stripe_idx) {
+      PgenVcacheStripe* stripe = GetVcacheStripe(stripe_idx, vcache);
+      VcacheLock(stripe);
+      hit_ct += stripe->hit_ct;
+      miss_ct += stripe->miss_ct;
+      VcacheUnlock(stripe);
+    }
+  }
+  *hit_ct_ptr = hit_ct;
+  *miss_ct_ptr = miss_ct;
+}
+
+// Caller must hold the stripe lock.
+static void VcacheMoveToFront(uint32_t slot_idx, PgenVariantCache* vcache, PgenVcacheStripe* stripe) {
+  if (stripe->lru_head == slot_idx) {
+    return;
+  }
+  uint32_t* slot_prevs = vcache->slot_prevs;
+  uint32_t* slot_nexts = vcache->slot_nexts;
+  const uint32_t prev_slot_idx = slot_prevs[slot_idx];
+  const uint32_t next_slot_idx = slot_nexts[slot_idx];
+  // detach (no-op for a fresh slot, which has prev == next == UINT32_MAX and
+  // isn't the head)
+  if (prev_slot_idx != UINT32_MAX) {
+    slot_nexts[prev_slot_idx] = next_slot_idx;
+  }
+  if (next_slot_idx != UINT32_MAX) {
+    slot_prevs[next_slot_idx] = prev_slot_idx;
+  } else if (stripe->lru_tail == slot_idx) {
+    stripe->lru_tail = prev_slot_idx;
+  }
+  slot_prevs[slot_idx] = UINT32_MAX;
+  slot_nexts[slot_idx] = stripe->lru_head;
+  if (stripe->lru_head != UINT32_MAX) {
+    slot_prevs[stripe->lru_head] = slot_idx;
+  }
+  stripe->lru_head = slot_idx;
+  if (stripe->lru_tail == UINT32_MAX) {
+    stripe->lru_tail = slot_idx;
+  }
+}
+
+// Caller must hold at least one stripe lock.  Returns the subset ID of
+// sample_include, or UINT32_MAX if it isn't registered.
+static uint32_t VcacheFindSubset(const uintptr_t* sample_include, uint32_t raw_sample_ct, uint32_t sample_ct, const PgenVariantCache* vcache) {
+  if (sample_ct == raw_sample_ct) {
+    return 0;
+  }
+  const uint32_t raw_sample_ctl_m1 = (raw_sample_ct - 1) / kBitsPerWord;
+  const uintptr_t last_word = bzhi_max(sample_include[raw_sample_ctl_m1], ModNz(raw_sample_ct, kBitsPerWord));
+  const uint32_t subset_ct = vcache->subset_ct;
+  const uintptr_t* subset_sample_include = vcache->subset_sample_includes;
+  for (uint32_t subset_idx = 0; subset_idx != subset_ct; ++subset_idx, subset_sample_include = &(subset_sample_include[vcache->raw_sample_ctaw])) {
+    if ((vcache->subset_sample_cts[subset_idx] == sample_ct) && (subset_sample_include[raw_sample_ctl_m1] == last_word) && memequal(subset_sample_include, sample_include, raw_sample_ctl_m1 * sizeof(intptr_t))) {
+      return subset_idx + 1;
+    }
+  }
+  return UINT32_MAX;
+}
+
+// Returns UINT32_MAX if the registry is full.  Caller must not hold any stripe
+// lock.
+static uint32_t VcacheRegisterSubset(const uintptr_t* sample_include, uint32_t raw_sample_ct, uint32_t sample_ct, PgenVariantCache* vcache) {
+  VcacheLockAll(vcache);
+  // another thread may have gotten here first
+  uint32_t subset_id = VcacheFindSubset(sample_include, raw_sample_ct, sample_ct, vcache);
+  if ((subset_id == UINT32_MAX) && (vcache->subset_ct != kPglVcacheSubsetCt)) {
+    const uint32_t subset_idx = vcache->subset_ct;
+    uintptr_t* subset_sample_include = &(vcache->subset_sample_includes[subset_idx * vcache->raw_sample_ctaw]);
+    const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+    memcpy(subset_sample_include, sample_include, raw_sample_ctl * sizeof(intptr_t));
+    ZeroTrailingBits(raw_sample_ct, subset_sample_include);
+    vcache->subset_sample_cts[subset_idx] = sample_ct;
+    vcache->subset_ct = subset_idx + 1;
+    subset_id = subset_idx + 1;
+  }
+  VcacheUnlockAll(vcache);
+  return subset_id;
+}
+
+// Returns 1 and fills genovec on hit.
+static uint32_t VcacheLookup(const uintptr_t* sample_include, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t vidx, PgenVariantCache* vcache, uintptr_t* genovec) {
+  PgenVcacheStripe* stripe = GetVcacheStripe(vidx % vcache->stripe_ct, vcache);
+  VcacheLock(stripe);
+  const uint32_t slot_idx = vcache->vidx_to_slot[vidx];
+  if ((slot_idx == UINT32_MAX) || (vcache->slot_subset_ids[slot_idx] != VcacheFindSubset(sample_include, raw_sample_ct, sample_ct, vcache))) {
+    stripe->miss_ct += 1;
+    VcacheUnlock(stripe);
+    return 0;
+  }
+  stripe->hit_ct += 1;
+  VcacheMoveToFront(slot_idx, vcache, stripe);
+  memcpy(genovec, &(vcache->slot_genovecs[S_CAST(uintptr_t, slot_idx) * vcache->slot_vec_ct * kWordsPerVec]), NypCtToVecCt(sample_ct) * kBytesPerVec);
+  VcacheUnlock(stripe);
+  return 1;
+}
+
+static void VcacheInsert(const uintptr_t* sample_include, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t vidx, const uintptr_t* genovec, PgenVariantCache* vcache) {
+  PgenVcacheStripe* stripe = GetVcacheStripe(vidx % vcache->stripe_ct, vcache);
+  VcacheLock(stripe);
+  uint32_t subset_id = VcacheFindSubset(sample_include, raw_sample_ct, sample_ct, vcache);
+  if (subset_id == UINT32_MAX) {
+    VcacheUnlock(stripe);
+    subset_id = VcacheRegisterSubset(sample_include, raw_sample_ct, sample_ct, vcache);
+    if (subset_id == UINT32_MAX) {
+      return;
+    }
+    VcacheLock(stripe);
+  }
+  uint32_t slot_idx = vcache->vidx_to_slot[vidx];
+  if (slot_idx == UINT32_MAX) {
+    if (stripe->slot_used_end != stripe->slot_end) {
+      slot_idx = stripe->slot_used_end;
+      stripe->slot_used_end += 1;
+      vcache->slot_prevs[slot_idx] = UINT32_MAX;
+      vcache->slot_nexts[slot_idx] = UINT32_MAX;
+    } else {
+      // evict least-recently-used entry
+      slot_idx = stripe->lru_tail;
+      vcache->vidx_to_slot[vcache->slot_vidxs[slot_idx]] = UINT32_MAX;
+    }
+    vcache->slot_vidxs[slot_idx] = vidx;
+    vcache->vidx_to_slot[vidx] = slot_idx;
+  }
+  vcache->slot_subset_ids[slot_idx] = subset_id;
+  VcacheMoveToFront(slot_idx, vcache, stripe);
+  memcpy(&(vcache->slot_genovecs[S_CAST(uintptr_t, slot_idx) * vcache->slot_vec_ct * kWordsPerVec]), genovec, NypCtToVecCt(sample_ct) * kBytesPerVec);
+  VcacheUnlock(stripe);
+}
 
 void PreinitPgr(PgenReader* pgr_ptr) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
   pgrp->ff = nullptr;
+  pgrp->zcursor = nullptr;
 }
 
 PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip, PgenReader* pgr_ptr, unsigned char* pgr_alloc) {
@@ -2042,8 +2998,11 @@ PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip,
   // Mode 2 (per-variant fread): block_base == nullptr.  fname must be
   //   non-null, though it isn't actually referenced during the first
   //   PgenReader initialization (instead shared_ff is moved).
+  // Mode 2 + pread: block_base == nullptr, pread_fd != -1.  fname must be
+  //   nullptr; shared_ff stays put.
   unsigned char* pgr_alloc_iter = pgr_alloc;
-  if (pgfip->block_base != nullptr) {
+  const uint32_t per_variant_read = (pgfip->block_base == nullptr);
+  if ((!per_variant_read) || (pgfip->pread_fd != -1)) {
     if (unlikely(fname != nullptr)) {
       return kPglRetImproperFunctionCall;
     }
@@ -2075,10 +3034,21 @@ PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip,
     }
   }
   pgrp->fi = *pgfip;  // struct copy
-  if (fname) {
+  pgrp->zcursor = nullptr;
+  if (per_variant_read) {
     // Mode 2 per-reader load buffer
     pgrp->fread_buf = pgr_alloc_iter;
     pgr_alloc_iter = &(pgr_alloc_iter[RoundUpPow2(max_vrec_width, kCacheline)]);
+    if (pgfip->zframe_ct) {
+      PgenZframeCursor* zcp = S_CAST(PgenZframeCursor*, malloc(sizeof(PgenZframeCursor)));
+      if (unlikely(!zcp)) {
+        return kPglRetNomem;
+      }
+      pgrp->zcursor = zcp;
+      if (unlikely(InitZframeCursor(zcp))) {
+        return kPglRetNomem;
+      }
+    }
   }
   pgrp->fp_vidx = 0;
   pgrp->ldbase_vidx = UINT32_MAX;
@@ -2142,6 +3112,33 @@ PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip,
       }
     }
   }
+  pgrp->ldwin_raw_genovecs = nullptr;
+  if (gflags & kfPgenGlobalLdWindow) {
+    pgrp->ldwin_raw_genovecs = S_CAST(uintptr_t*, arena_alloc_raw(kPglLdWindowSize * genovec_bytes_req, &pgr_alloc_iter));
+    for (uint32_t slot_idx = 0; slot_idx != kPglLdWindowSize; ++slot_idx) {
+      pgrp->ldwin_vidxs[slot_idx] = UINT32_MAX;
+    }
+    pgrp->ldwin_next_slot = 0;
+  }
+  pgrp->pbwt_hap_order = nullptr;
+  pgrp->pbwt_hap_order_tmp = nullptr;
+  pgrp->pbwt_vidx = UINT32_MAX;
+  pgrp->pbwt_ldbase_vidx = UINT32_MAX;
+  pgrp->pbwt_genovec = nullptr;
+  pgrp->pbwt_ldbase_genovec = nullptr;
+  pgrp->pbwt_phasepresent = nullptr;
+  pgrp->pbwt_phaseinfo = nullptr;
+  pgrp->pbwt_record_buf = nullptr;
+  if (PbwtHphaseActive(gflags)) {
+    const uintptr_t hap_order_bytes_req = Int32CtToCachelineCt(2 * S_CAST(uintptr_t, raw_sample_ct)) * kCacheline;
+    pgrp->pbwt_hap_order = S_CAST(uint32_t*, arena_alloc_raw(hap_order_bytes_req, &pgr_alloc_iter));
+    pgrp->pbwt_hap_order_tmp = S_CAST(uint32_t*, arena_alloc_raw(hap_order_bytes_req, &pgr_alloc_iter));
+    pgrp->pbwt_genovec = S_CAST(uintptr_t*, arena_alloc_raw(genovec_bytes_req, &pgr_alloc_iter));
+    pgrp->pbwt_ldbase_genovec = S_CAST(uintptr_t*, arena_alloc_raw(genovec_bytes_req, &pgr_alloc_iter));
+    pgrp->pbwt_phasepresent = S_CAST(uintptr_t*, arena_alloc_raw(bitvec_bytes_req, &pgr_alloc_iter));
+    pgrp->pbwt_phaseinfo = S_CAST(uintptr_t*, arena_alloc_raw(bitvec_bytes_req, &pgr_alloc_iter));
+    pgrp->pbwt_record_buf = S_CAST(unsigned char*, arena_alloc_raw(PbwtRecordBufByteCt(raw_sample_ct, gflags), &pgr_alloc_iter));
+  }
   return kPglRetSuccess;
 }
 
@@ -2730,6 +3727,53 @@ PglErr ParseNonLdGenovecSubsetUnsafe(const unsigned char* fread_end, const uintp
   return kPglRetSuccess;
 }
 
+// Decodes a non-LD-compressed, non-all-hom-ref record into a raw genovec.
+static PglErr ParseLdbaseRawGenovec(const unsigned char* fread_end, uint32_t vrtype, const unsigned char** fread_pp, PgenReaderMain* pgrp, uintptr_t* __restrict raw_genovec) {
+  assert((vrtype & 7) != 5); // all-hom-ref can't be ldbase
+  if (!(vrtype & 4)) {
+    return Parse1or2bitGenoarrUnsafe(fread_end, vrtype, fread_pp, pgrp, raw_genovec);
+  }
+  const uint32_t vrtype_low2 = vrtype & 3;
+  vecset(raw_genovec, vrtype_low2 * kMask5555, NypCtToVecCt(pgrp->fi.raw_sample_ct));
+  return ParseAndApplyDifflist(fread_end, fread_pp, pgrp, raw_genovec);
+}
+
+BoolErr InitReadPtrs(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp);
+
+// LD-window modes: fills ldbase_raw_genovec (only) with
+// pgrp->ldbase_vidx's genotypes, from the ldwin_raw_genovecs ring if
+// possible.  Returns 1 on failure, in which case the caller should load the
+// base the usual way (and will report the error).
+static uint32_t LdwinLoadRawBase(PgenReaderMain* pgrp) {
+  const uint32_t ldbase_vidx = pgrp->ldbase_vidx;
+  const uintptr_t genovec_word_ct = NypCtToVecCt(pgrp->fi.raw_sample_ct) * kWordsPerVec;
+  uint32_t slot_idx = 0;
+  for (; slot_idx != kPglLdWindowSize; ++slot_idx) {
+    if (pgrp->ldwin_vidxs[slot_idx] == ldbase_vidx) {
+      break;
+    }
+  }
+  uintptr_t* slot_genovec;
+  if (slot_idx != kPglLdWindowSize) {
+    slot_genovec = &(pgrp->ldwin_raw_genovecs[slot_idx * genovec_word_ct]);
+  } else {
+    slot_idx = pgrp->ldwin_next_slot;
+    slot_genovec = &(pgrp->ldwin_raw_genovecs[slot_idx * genovec_word_ct]);
+    pgrp->ldwin_vidxs[slot_idx] = UINT32_MAX;
+    pgrp->ldbase_stypes = kfPgrLdcache0;
+    const unsigned char* fread_ptr;
+    const unsigned char* fread_end;
+    if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end) || ParseLdbaseRawGenovec(fread_end, pgrp->fi.vrtypes[ldbase_vidx], &fread_ptr, pgrp, slot_genovec))) {
+      return 1;
+    }
+    pgrp->ldwin_vidxs[slot_idx] = ldbase_vidx;
+    pgrp->ldwin_next_slot = (slot_idx + 1) % kPglLdWindowSize;
+  }
+  memcpy(pgrp->ldbase_raw_genovec, slot_genovec, genovec_word_ct * sizeof(intptr_t));
+  pgrp->ldbase_stypes = kfPgrLdcacheRawNyp;
+  return 0;
+}
+
 uint32_t LdLoadNecessary(uint32_t cur_vidx, PgenReaderMain* pgrp) {
   // Determines whether LD base variant needs to be loaded (in addition to the
   // current variant), assuming we need (possibly subsetted) hardcalls.
@@ -2738,6 +3782,17 @@ uint32_t LdLoadNecessary(uint32_t cur_vidx, PgenReaderMain* pgrp) {
   // bugfix (22 May 2018): this only checked whether ldbase_stypes was nonzero;
   // there was an AllHets + cache-clear edge case where that's not good enough.
   // now that AllHets has been removed, though, it should be safe again.
+  if (pgrp->fi.ldbase_backrefs) {
+    // LD-window modes: consecutive LD-compressed variants may have different
+    // bases, so the fast path below doesn't apply.  On a base change, the
+    // new base is taken from (or decoded into) the ldwin_raw_genovecs ring.
+    const uint32_t old_ldbase_vidx = pgrp->ldbase_vidx;
+    pgrp->ldbase_vidx = GetPgfiLdbaseVidx(&(pgrp->fi), cur_vidx);
+    if ((pgrp->ldbase_vidx == old_ldbase_vidx) && pgrp->ldbase_stypes) {
+      return 0;
+    }
+    return LdwinLoadRawBase(pgrp);
+  }
   if (pgrp->ldbase_stypes && (cur_vidx == pgrp->fp_vidx)) {
     // ldbase variant guaranteed to be up-to-date if we didn't skip the last
     // variant, and cache wasn't cleared
@@ -2750,6 +3805,20 @@ uint32_t LdLoadNecessary(uint32_t cur_vidx, PgenReaderMain* pgrp) {
   return (pgrp->ldbase_vidx != old_ldbase_vidx);
 }
 
+// Loads a variant record into fread_buf in zstd and pread modes, neither of
+// which tracks the reader's FILE* position.
+static BoolErr ReadVrecDirect(uint32_t vidx, uint64_t fpos, uintptr_t vrec_width, PgenReaderMain* pgrp) {
+  if (pgrp->zcursor) {
+    // pread_fd is -1 unless we're in pread mode.
+    return ZframeRead(&(pgrp->fi), vidx / kPglVblockSize, fpos, vrec_width, pgrp->ff, pgrp->fi.pread_fd, pgrp->zcursor, pgrp->fread_buf);
+  }
+#ifndef NO_PREAD
+  return PreadChecked(pgrp->fi.pread_fd, fpos, vrec_width, pgrp->fread_buf);
+#else
+  return 1;
+#endif
+}
+
 BoolErr InitReadPtrs(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp) {
   const unsigned char* block_base = pgrp->fi.block_base;
   if (block_base != nullptr) {
@@ -2763,12 +3832,21 @@ BoolErr InitReadPtrs(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char**
 
     return 0;
   }
+  const uintptr_t cur_vrec_width = GetPgfiVrecWidth(&(pgrp->fi), vidx);
+  if (pgrp->zcursor || (!pgrp->ff)) {
+    if (unlikely(ReadVrecDirect(vidx, GetPgfiFpos(&(pgrp->fi), vidx), cur_vrec_width, pgrp))) {
+      return 1;
+    }
+    *fread_pp = pgrp->fread_buf;
+    *fread_endp = &(pgrp->fread_buf[cur_vrec_width]);
+    pgrp->fp_vidx = vidx + 1;
+    return 0;
+  }
   if (pgrp->fp_vidx != vidx) {
     if (unlikely(fseeko(pgrp->ff, GetPgfiFpos(&(pgrp->fi), vidx), SEEK_SET))) {
       return 1;
     }
   }
-  const uintptr_t cur_vrec_width = GetPgfiVrecWidth(&(pgrp->fi), vidx);
 #ifdef __LP64__
   if (unlikely(fread_checked(pgrp->fread_buf, cur_vrec_width, pgrp->ff))) {
     if (feof_unlocked(pgrp->ff)) {
@@ -2791,6 +3869,195 @@ BoolErr InitReadPtrs(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char**
   return 0;
 }
 
+// Decodes vidx's raw genovec for PBWT replay.  Uses pbwt_ldbase_genovec
+// instead of the main LD cache, so the caller's LD state is unaffected.  On
+// success, *fread_pp points to the end of the main track.
+static PglErr PbwtReadRawGenovec(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp, uintptr_t* __restrict raw_genovec) {
+  const unsigned char* vrtypes = pgrp->fi.vrtypes;
+  const uint32_t vrtype = vrtypes[vidx];
+  const uint32_t raw_sample_ct = pgrp->fi.raw_sample_ct;
+  const uint32_t vec_ct = NypCtToVecCt(raw_sample_ct);
+  PglErr reterr;
+  if (VrtypeLdCompressed(vrtype)) {
+    const uint32_t ldbase_vidx = GetPgfiLdbaseVidx(&(pgrp->fi), vidx);
+    if (pgrp->pbwt_ldbase_vidx != ldbase_vidx) {
+      pgrp->pbwt_ldbase_vidx = UINT32_MAX;
+      reterr = PbwtReadRawGenovec(ldbase_vidx, pgrp, fread_pp, fread_endp, pgrp->pbwt_ldbase_genovec);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+    }
+    if (unlikely(InitReadPtrs(vidx, pgrp, fread_pp, fread_endp))) {
+      return kPglRetReadFail;
+    }
+    memcpy(raw_genovec, pgrp->pbwt_ldbase_genovec, vec_ct * kBytesPerVec);
+    reterr = ParseAndApplyDifflist(*fread_endp, fread_pp, pgrp, raw_genovec);
+    if ((vrtype & 7) == 3) {
+      GenovecInvertUnsafe(raw_sample_ct, raw_genovec);
+    }
+    return reterr;
+  }
+  if (unlikely(InitReadPtrs(vidx, pgrp, fread_pp, fread_endp))) {
+    return kPglRetReadFail;
+  }
+  if (!(vrtype & 4)) {
+    reterr = Parse1or2bitGenoarrUnsafe(*fread_endp, vrtype, fread_pp, pgrp, raw_genovec);
+  } else {
+    const uint32_t vrtype_low2 = vrtype & 3;
+    if (vrtype_low2 == 1) {
+      // all-hom-ref
+      ZeroWArr(NypCtToWordCt(raw_sample_ct), raw_genovec);
+      return kPglRetSuccess;
+    }
+    vecset(raw_genovec, vrtype_low2 * kMask5555, vec_ct);
+    reterr = ParseAndApplyDifflist(*fread_endp, fread_pp, pgrp, raw_genovec);
+  }
+  if ((!reterr) && IsNextLdbase(&(pgrp->fi), vidx)) {
+    if (raw_genovec != pgrp->pbwt_ldbase_genovec) {
+      memcpy(pgrp->pbwt_ldbase_genovec, raw_genovec, vec_ct * kBytesPerVec);
+    }
+    pgrp->pbwt_ldbase_vidx = vidx;
+  }
+  return reterr;
+}
+
+// Decodes the hardcall-phase track of biallelic variant vidx (legacy or PBWT
+// encoding) and advances pbwt_hap_order past it.  If fread_pp is non-null,
+// the legacy encoding of the track, followed by the rest of the record, is
+// also written to pbwt_record_buf.
+static PglErr PbwtProcessVariant(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp) {
+  const uint32_t raw_sample_ct = pgrp->fi.raw_sample_ct;
+  const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+  uintptr_t* genovec = pgrp->pbwt_genovec;
+  const unsigned char* fread_ptr;
+  const unsigned char* fread_end;
+  PglErr reterr = PbwtReadRawGenovec(vidx, pgrp, &fread_ptr, &fread_end, genovec);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  ZeroTrailingNyps(raw_sample_ct, genovec);
+  uint32_t het_ct;
+  uint32_t hom_alt_ct;
+  GenovecCount12Unsafe(genovec, raw_sample_ct, &het_ct, &hom_alt_ct);
+  if (unlikely((!het_ct) || (fread_end - fread_ptr < 2))) {
+    return kPglRetMalformedInput;
+  }
+  const uint32_t pbwt_encoded = *fread_ptr++;
+  if (unlikely(pbwt_encoded > 1)) {
+    return kPglRetMalformedInput;
+  }
+  const unsigned char* aux2_start = fread_ptr;
+  const uint32_t aux2_first_part_byte_ct = 1 + (het_ct / CHAR_BIT);
+  const uint32_t explicit_phasepresent = fread_ptr[0] & 1;
+  const uint32_t genoword_ct = NypCtToWordCt(raw_sample_ct);
+  uintptr_t* phasepresent = pgrp->pbwt_phasepresent;
+  uintptr_t* phaseinfo = pgrp->pbwt_phaseinfo;
+  ZeroWArr(raw_sample_ctl, phaseinfo);
+  uint32_t phasepresent_ct = het_ct;
+  if (explicit_phasepresent) {
+    if (PtrAddCk(fread_end, aux2_first_part_byte_ct, &fread_ptr)) {
+      return kPglRetMalformedInput;
+    }
+    ZeroWArr(raw_sample_ctl, phasepresent);
+    ExpandBytearrFromGenoarr(aux2_start, genovec, kMask5555, genoword_ct, het_ct, 1, phasepresent);
+    phasepresent_ct = PopcountWords(phasepresent, raw_sample_ctl);
+    if (unlikely(!phasepresent_ct)) {
+      return kPglRetMalformedInput;
+    }
+  }
+  const uintptr_t* phasepresent_or_null = explicit_phasepresent? phasepresent : nullptr;
+  if (!pbwt_encoded) {
+    if (explicit_phasepresent) {
+      const unsigned char* phaseinfo_start = fread_ptr;
+      if (PtrAddCk(fread_end, DivUp(phasepresent_ct, CHAR_BIT), &fread_ptr)) {
+        return kPglRetMalformedInput;
+      }
+      ExpandBytearr(phaseinfo_start, phasepresent, raw_sample_ctl, phasepresent_ct, 0, phaseinfo);
+    } else {
+      if (PtrAddCk(fread_end, aux2_first_part_byte_ct, &fread_ptr)) {
+        return kPglRetMalformedInput;
+      }
+      ExpandBytearrFromGenoarr(aux2_start, genovec, kMask5555, genoword_ct, het_ct, 1, phaseinfo);
+    }
+  } else {
+    if (!explicit_phasepresent) {
+      // single zero byte
+      ++fread_ptr;
+    }
+    if (unlikely(PbwtDecodePhaseinfo(fread_end, genovec, phasepresent_or_null, pgrp->pbwt_hap_order, raw_sample_ct, phasepresent_ct, &fread_ptr, phaseinfo))) {
+      return kPglRetMalformedInput;
+    }
+  }
+  if (fread_pp) {
+    if (!pbwt_encoded) {
+      *fread_pp = aux2_start;
+      *fread_endp = fread_end;
+    } else {
+      unsigned char* write_iter = pgrp->pbwt_record_buf;
+      if (explicit_phasepresent) {
+        write_iter = memcpyua(write_iter, aux2_start, aux2_first_part_byte_ct);
+        CopyBitarrSubsetToUnaligned(phaseinfo, phasepresent, phasepresent_ct, write_iter);
+        write_iter = &(write_iter[DivUp(phasepresent_ct, CHAR_BIT)]);
+      } else {
+        CopyGenomatchSubset(phaseinfo, genovec, kMask5555, 1, het_ct, write_iter);
+        write_iter = &(write_iter[aux2_first_part_byte_ct]);
+      }
+      const uintptr_t remaining_byte_ct = fread_end - fread_ptr;
+      if (unlikely(S_CAST(uintptr_t, write_iter - pgrp->pbwt_record_buf) + remaining_byte_ct > PbwtRecordBufByteCt(raw_sample_ct, pgrp->fi.gflags))) {
+        return kPglRetMalformedInput;
+      }
+      memcpy(write_iter, fread_ptr, remaining_byte_ct);
+      *fread_pp = pgrp->pbwt_record_buf;
+      *fread_endp = &(write_iter[remaining_byte_ct]);
+    }
+  }
+  PbwtUpdateHapOrder(genovec, phasepresent_or_null, phaseinfo, raw_sample_ct, pgrp->pbwt_hap_order, pgrp->pbwt_hap_order_tmp);
+  return kPglRetSuccess;
+}
+
+// *fread_pp must point to the hardcall-phase track of biallelic variant vidx,
+// in a PBWT-mode file.  Afterward, it points to the legacy encoding of
+// that track, followed by the rest of the record.
+static PglErr PbwtTranslateAux2(uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp) {
+  const unsigned char* fread_ptr = *fread_pp;
+  if (unlikely(fread_ptr == *fread_endp)) {
+    return kPglRetMalformedInput;
+  }
+  if (!(*fread_ptr)) {
+    // legacy encoding; no need to bring the haplotype order up to date yet
+    *fread_pp = &(fread_ptr[1]);
+    return kPglRetSuccess;
+  }
+  const uint32_t reset_vidx = RoundDownPow2(vidx, kPglPbwtResetInterval);
+  uint32_t replay_vidx = pgrp->pbwt_vidx;
+  if ((replay_vidx > vidx) || (replay_vidx < reset_vidx)) {
+    PbwtInitHapOrder(pgrp->fi.raw_sample_ct, pgrp->pbwt_hap_order);
+    replay_vidx = reset_vidx;
+  }
+  // invalid until we're done
+  pgrp->pbwt_vidx = UINT32_MAX;
+  const unsigned char* vrtypes = pgrp->fi.vrtypes;
+  for (; replay_vidx != vidx; ++replay_vidx) {
+    if ((vrtypes[replay_vidx] & 0x18) == 0x10) {
+      PglErr reterr = PbwtProcessVariant(replay_vidx, pgrp, nullptr, nullptr);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+    }
+  }
+  // Reload vidx itself, since replay may have clobbered fread_buf.
+  PglErr reterr = PbwtProcessVariant(vidx, pgrp, fread_pp, fread_endp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  pgrp->pbwt_vidx = vidx + 1;
+  return kPglRetSuccess;
+}
+
+static inline uint32_t PbwtTranslationNeeded(uint32_t vidx, const PgenReaderMain* pgrp) {
+  return pgrp->pbwt_record_buf && ((pgrp->fi.vrtypes[vidx] & 0x18) == 0x10);
+}
+
 // Fills dest with subsetted ldbase contents, and ensures ldcache is filled so
 // no explicit reload of ldbase is needed for next variant if we're extracting
 // the same sample subset.  (Reload is occasionally needed if next variant is
@@ -2834,7 +4101,7 @@ PglErr LdLoadAndCopyGenovecSubset(const uintptr_t* __restrict sample_include, co
 //   het-ref = 1
 //   two nonref = 2
 //   missing = 3
-PglErr ReadGenovecSubsetUnsafe(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp, uintptr_t* __restrict genovec) {
+PglErr ReadGenovecSubsetUncached(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp, uintptr_t* __restrict genovec) {
   // Side effects:
   //   may use pgr.workspace_raregeno_tmp_loadbuf (any difflist)
   const uint32_t vrtype = GetPgfiVrtype(&(pgrp->fi), vidx);
@@ -2878,7 +4145,7 @@ PglErr ReadGenovecSubsetUnsafe(const uintptr_t* __restrict sample_include, const
   if (vrtype == kPglVrtypePlink1) {
     PgrPlink1ToPlink2InplaceUnsafe(sample_ct, genovec);
   } else {
-    const uint32_t is_ldbase = pgrp->fi.vrtypes && VrtypeLdCompressed(pgrp->fi.vrtypes[vidx + 1]);
+    const uint32_t is_ldbase = pgrp->fi.vrtypes && IsNextLdbase(&(pgrp->fi), vidx);
     const uint32_t ldbase_raw_genovec_saved = (sample_ct != pgrp->fi.raw_sample_ct) && (!(maintrack_vrtype & 4));
     if (is_ldbase) {
       CopyNyparr(genovec, sample_ct, pgrp->ldbase_genovec);
@@ -2899,6 +4166,31 @@ PglErr ReadGenovecSubsetUnsafe(const uintptr_t* __restrict sample_include, const
   return kPglRetSuccess;
 }
 
+PglErr ReadGenovecSubsetUnsafe(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, const unsigned char** fread_endp, uintptr_t* __restrict genovec) {
+  if (fread_pp) {
+    // Internal callers which go on to parse the rest of the record bypass the
+    // cache.
+    PglErr reterr = ReadGenovecSubsetUncached(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, fread_pp, fread_endp, genovec);
+    if (reterr || (!PbwtTranslationNeeded(vidx, pgrp))) {
+      return reterr;
+    }
+    return PbwtTranslateAux2(vidx, pgrp, fread_pp, fread_endp);
+  }
+  PgenVariantCache* vcache = pgrp->fi.vcache;
+  if (!vcache) {
+    return ReadGenovecSubsetUncached(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, nullptr, nullptr, genovec);
+  }
+  const uint32_t raw_sample_ct = pgrp->fi.raw_sample_ct;
+  if (VcacheLookup(sample_include, raw_sample_ct, sample_ct, vidx, vcache, genovec)) {
+    return kPglRetSuccess;
+  }
+  const PglErr reterr = ReadGenovecSubsetUncached(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, nullptr, nullptr, genovec);
+  if (likely(!reterr)) {
+    VcacheInsert(sample_include, raw_sample_ct, sample_ct, vidx, genovec, vcache);
+  }
+  return reterr;
+}
+
 PglErr PgrGet(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict genovec) {
   if (!sample_ct) {
     return kPglRetSuccess;
@@ -2908,6 +4200,89 @@ PglErr PgrGet(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex p
   return ReadGenovecSubsetUnsafe(sample_include, GetSicp(pssi), sample_ct, vidx, pgrp, nullptr, nullptr, genovec);
 }
 
+PglErr PgrGetBlock(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx_start, uint32_t vidx_end, PgenReader* pgr_ptr, uintptr_t genovec_word_stride, uintptr_t* __restrict genovecs) {
+  if ((!sample_ct) || (vidx_start == vidx_end)) {
+    return kPglRetSuccess;
+  }
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  assert(vidx_end <= pgrp->fi.raw_variant_ct);
+  const uint32_t* sample_include_cumulative_popcounts = GetSicp(pssi);
+  if (pgrp->fi.vcache) {
+    // Keep the cache in the loop.
+    uintptr_t* genovec_iter = genovecs;
+    for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+      const PglErr reterr = ReadGenovecSubsetUnsafe(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, nullptr, nullptr, genovec_iter);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      genovec_iter = &(genovec_iter[genovec_word_stride]);
+    }
+    return kPglRetSuccess;
+  }
+  const unsigned char* vrtypes = pgrp->fi.vrtypes;
+  const uint32_t raw_genovec_clobbered = (sample_ct != pgrp->fi.raw_sample_ct);
+  // Rows decoded earlier in this call serve as LD bases directly, so the
+  // reader's LD-base cache is neither filled nor consulted for them; it's
+  // brought up to date once at the end.
+  uint32_t last_ldbase_vidx = UINT32_MAX;
+  uintptr_t* genovec_iter = genovecs;
+  for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+    const uint32_t vrtype = GetPgfiVrtype(&(pgrp->fi), vidx);
+    const uint32_t maintrack_vrtype = vrtype & 7;
+    const unsigned char* fread_ptr;
+    const unsigned char* fread_end;
+    PglErr reterr;
+    if (VrtypeLdCompressed(maintrack_vrtype)) {
+      // ldbase_backrefs[] never reaches outside the vblock, and neither does
+      // the implicit base.
+      const uint32_t ldbase_vidx = pgrp->fi.ldbase_backrefs? GetPgfiLdbaseVidx(&(pgrp->fi), vidx) : GetLdbaseVidx(vrtypes, vidx);
+      if (ldbase_vidx >= vidx_start) {
+        CopyNyparr(&(genovecs[(ldbase_vidx - vidx_start) * genovec_word_stride]), sample_ct, genovec_iter);
+      } else {
+        reterr = LdLoadAndCopyGenovecSubset(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, genovec_iter);
+        if (unlikely(reterr)) {
+          return reterr;
+        }
+      }
+      if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
+        return kPglRetReadFail;
+      }
+      reterr = ParseAndApplyDifflistSubset(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, &fread_ptr, pgrp, genovec_iter);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      if (maintrack_vrtype == 3) {
+        GenovecInvertUnsafe(sample_ct, genovec_iter);
+      }
+    } else {
+      if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
+        return kPglRetReadFail;
+      }
+      reterr = ParseNonLdGenovecSubsetUnsafe(fread_end, sample_include, sample_include_cumulative_popcounts, sample_ct, maintrack_vrtype, &fread_ptr, pgrp, genovec_iter);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      if (vrtype == kPglVrtypePlink1) {
+        PgrPlink1ToPlink2InplaceUnsafe(sample_ct, genovec_iter);
+      } else if (vrtypes) {
+        if (raw_genovec_clobbered && (!(maintrack_vrtype & 4))) {
+          pgrp->ldbase_stypes &= ~kfPgrLdcacheRawNyp;
+        }
+        if (IsNextLdbase(&(pgrp->fi), vidx)) {
+          last_ldbase_vidx = vidx;
+        }
+      }
+    }
+    genovec_iter = &(genovec_iter[genovec_word_stride]);
+  }
+  if (last_ldbase_vidx != UINT32_MAX) {
+    CopyNyparr(&(genovecs[(last_ldbase_vidx - vidx_start) * genovec_word_stride]), sample_ct, pgrp->ldbase_genovec);
+    pgrp->ldbase_vidx = last_ldbase_vidx;
+    pgrp->ldbase_stypes = kfPgrLdcacheNyp;
+  }
+  return kPglRetSuccess;
+}
+
 // Fills dest with ldbase contents, and ensures ldcache is filled so no
 // explicit reload of ldbase is needed for next variant.
 PglErr LdLoadAndCopyRawGenovec(uint32_t subsetting_required, uint32_t vidx, PgenReaderMain* pgrp, uintptr_t* dest) {
@@ -2919,18 +4294,9 @@ PglErr LdLoadAndCopyRawGenovec(uint32_t subsetting_required, uint32_t vidx, Pgen
     if (unlikely(InitReadPtrs(ldbase_vidx, pgrp, &fread_ptr, &fread_end))) {
       return kPglRetReadFail;
     }
-    const uint32_t vrtype = pgrp->fi.vrtypes[ldbase_vidx];
     pgrp->ldbase_stypes = kfPgrLdcacheRawNyp;
-    assert((vrtype & 7) != 5); // all-hom-ref can't be ldbase
     uintptr_t* raw_genovec = pgrp->ldbase_raw_genovec;
-    PglErr reterr;
-    if (!(vrtype & 4)) {
-      reterr = Parse1or2bitGenoarrUnsafe(fread_end, vrtype, &fread_ptr, pgrp, raw_genovec);
-    } else {
-      const uint32_t vrtype_low2 = vrtype & 3;
-      vecset(raw_genovec, vrtype_low2 * kMask5555, DivUp(genovec_byte_ct, kBytesPerVec));
-      reterr = ParseAndApplyDifflist(fread_end, &fread_ptr, pgrp, raw_genovec);
-    }
+    PglErr reterr = ParseLdbaseRawGenovec(fread_end, pgrp->fi.vrtypes[ldbase_vidx], &fread_ptr, pgrp, raw_genovec);
     memcpy(dest, raw_genovec, genovec_byte_ct);
     return reterr;
   }
@@ -2970,6 +4336,9 @@ PglErr ReadRawGenovec(uint32_t subsetting_required, uint32_t vidx, PgenReaderMai
     if (maintrack_vrtype == 3) {
       GenovecInvertUnsafe(raw_sample_ct, raw_genovec);
     }
+    if (PbwtTranslationNeeded(vidx, pgrp)) {
+      return PbwtTranslateAux2(vidx, pgrp, fread_pp, fread_endp);
+    }
     return kPglRetSuccess;
   }
   if (unlikely(InitReadPtrs(vidx, pgrp, fread_pp, fread_endp))) {
@@ -2993,13 +4362,16 @@ PglErr ReadRawGenovec(uint32_t subsetting_required, uint32_t vidx, PgenReaderMai
   if (vrtype == kPglVrtypePlink1) {
     PgrPlink1ToPlink2InplaceUnsafe(raw_sample_ct, raw_genovec);
   } else {
-    const uint32_t is_ldbase = pgrp->fi.vrtypes && VrtypeLdCompressed(pgrp->fi.vrtypes[vidx + 1]);
+    const uint32_t is_ldbase = pgrp->fi.vrtypes && IsNextLdbase(&(pgrp->fi), vidx);
     if (is_ldbase) {
       CopyNyparr(raw_genovec, raw_sample_ct, pgrp->ldbase_raw_genovec);
       pgrp->ldbase_vidx = vidx;
       pgrp->ldbase_stypes = kfPgrLdcacheRawNyp;
     }
   }
+  if ((!reterr) && PbwtTranslationNeeded(vidx, pgrp)) {
+    return PbwtTranslateAux2(vidx, pgrp, fread_pp, fread_endp);
+  }
   return reterr;
 }
 /*
@@ -3086,11 +4458,23 @@ PglErr LdLoadMinimalSubsetIfNecessary(const uintptr_t* __restrict sample_include
     }
     pgrp->fp_vidx = ldbase_vidx + 1;
   } else {
-    if (unlikely(fseeko(pgrp->ff, pgrp->fi.var_fpos[ldbase_vidx], SEEK_SET))) {
-      return kPglRetReadFail;
-    }
     const uintptr_t cur_vrec_width = pgrp->fi.var_fpos[ldbase_vidx + 1] - cur_vidx_fpos;
     pgrp->fp_vidx = ldbase_vidx + 1;
+    if (pgrp->zcursor || (!pgrp->ff)) {
+      if (unlikely(ReadVrecDirect(ldbase_vidx, cur_vidx_fpos, cur_vrec_width, pgrp))) {
+        return kPglRetReadFail;
+      }
+      fread_ptr = pgrp->fread_buf;
+      fread_end = &(pgrp->fread_buf[cur_vrec_width]);
+      if (!(ldbase_vrtype & 4)) {
+        reterr = Parse1or2bitGenoarrUnsafe(fread_end, ldbase_vrtype, &fread_ptr, pgrp, raw_genovec);
+        goto LdLoadMinimalSubsetIfNecessary_genovec_finish;
+      }
+      goto LdLoadMinimalSubsetIfNecessary_difflist;
+    }
+    if (unlikely(fseeko(pgrp->ff, cur_vidx_fpos, SEEK_SET))) {
+      return kPglRetReadFail;
+    }
     if (!(ldbase_vrtype & 7)) {
       // don't actually need to fread the whole record in this case
       const uint32_t raw_sample_ct4 = NypCtToByteCt(raw_sample_ct);
@@ -3119,6 +4503,7 @@ PglErr LdLoadMinimalSubsetIfNecessary(const uintptr_t* __restrict sample_include
       goto LdLoadMinimalSubsetIfNecessary_genovec_finish;
     }
   }
+ LdLoadMinimalSubsetIfNecessary_difflist:
   uint32_t ldbase_difflist_len;
   if (!subsetting_required) {
     reterr = ParseAndSaveDifflist(fread_end, raw_sample_ct, &fread_ptr, pgrp->ldbase_raregeno, pgrp->ldbase_difflist_sample_ids, &ldbase_difflist_len);
@@ -3180,7 +4565,12 @@ PglErr ReadDifflistOrGenovecSubsetUnsafe(const uintptr_t* __restrict sample_incl
       CopyNyparr(pgrp->ldbase_genovec, sample_ct, genovec);
     } else {
       assert(pgrp->ldbase_stypes & kfPgrLdcacheRawNyp);
-      CopyNyparrNonemptySubset(pgrp->ldbase_raw_genovec, sample_include, raw_sample_ct, sample_ct, genovec);
+      // (RawNyp-only without subsetting is possible in LD-window modes.)
+      if (subsetting_required) {
+        CopyNyparrNonemptySubset(pgrp->ldbase_raw_genovec, sample_include, raw_sample_ct, sample_ct, genovec);
+      } else {
+        CopyNyparr(pgrp->ldbase_raw_genovec, sample_ct, genovec);
+      }
       CopyNyparr(genovec, sample_ct, pgrp->ldbase_genovec);
       pgrp->ldbase_stypes |= kfPgrLdcacheNyp;
     }
@@ -3203,9 +4593,13 @@ PglErr ReadDifflistOrGenovecSubsetUnsafe(const uintptr_t* __restrict sample_incl
   if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
     return kPglRetReadFail;
   }
-  const uint32_t is_ldbase = pgrp->fi.vrtypes && VrtypeLdCompressed(pgrp->fi.vrtypes[vidx + 1]);
+  const uint32_t is_ldbase = pgrp->fi.vrtypes && IsNextLdbase(&(pgrp->fi), vidx);
   const uint32_t saved_difflist_len = VrtypeDifflist(vrtype)? PeekVint31(fread_ptr, fread_end) : raw_sample_ct;
-  pgrp->ldbase_vidx = vidx;
+  if (is_ldbase) {
+    // (in LD-window modes, the previously cached LD base may still be
+    // referenced later, so leave it alone otherwise)
+    pgrp->ldbase_vidx = vidx;
+  }
   // no limit is slightly better than /16 but substantially worse than /32 on
   // the large test dataset (/64 is slightly worse than /32)
   // no limit is best on the small test dataset
@@ -3589,7 +4983,12 @@ PglErr LdLoadGenovecSubsetIfNecessary(const uintptr_t* __restrict sample_include
       PgrDifflistToGenovecUnsafe(pgrp->ldbase_raregeno, pgrp->ldbase_difflist_sample_ids, pgrp->fi.vrtypes[pgrp->ldbase_vidx] & 3, sample_ct, pgrp->ldbase_difflist_len, pgrp->ldbase_genovec);
     } else {
       assert(pgrp->ldbase_stypes & kfPgrLdcacheRawNyp);
-      CopyNyparrNonemptySubset(pgrp->ldbase_raw_genovec, sample_include, pgrp->fi.raw_sample_ct, sample_ct, pgrp->ldbase_genovec);
+      if (sample_ct != pgrp->fi.raw_sample_ct) {
+        CopyNyparrNonemptySubset(pgrp->ldbase_raw_genovec, sample_include, pgrp->fi.raw_sample_ct, sample_ct, pgrp->ldbase_genovec);
+      } else {
+        // possible in LD-window modes
+        CopyNyparr(pgrp->ldbase_raw_genovec, sample_ct, pgrp->ldbase_genovec);
+      }
     }
     pgrp->ldbase_stypes |= kfPgrLdcacheNyp;
   }
@@ -3637,7 +5036,7 @@ PglErr GetBasicGenotypeCounts(const uintptr_t* __restrict sample_include, const
     if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
       return kPglRetReadFail;
     }
-    const uint32_t is_ldbase = pgrp->fi.vrtypes && VrtypeLdCompressed(pgrp->fi.vrtypes[vidx + 1]);
+    const uint32_t is_ldbase = pgrp->fi.vrtypes && IsNextLdbase(&(pgrp->fi), vidx);
     if (is_ldbase) {
       // difflists are very efficient to count directly when not subsetting
       // (since we can entirely ignore the sample IDs), but it's often better
@@ -3701,6 +5100,18 @@ PglErr GetBasicGenotypeCounts(const uintptr_t* __restrict sample_include, const
   }
   assert((!subsetting_required) && ((vrtype & 0x18) == 0x10));
   const uint32_t het_ct = genocounts[1];
+  if (pgrp->pbwt_record_buf) {
+    // Skip the encoding byte.  The phasepresent bitarray (if any) comes next
+    // in both encodings, and the PBWT encoding uses a single zero byte in
+    // place of the first part when every het is phased.
+    if (PtrCheck(fread_end, fread_ptr, 2)) {
+      return kPglRetMalformedInput;
+    }
+    ++fread_ptr;
+    if (!(fread_ptr[0] & 1)) {
+      return kPglRetSuccess;
+    }
+  }
   const uint32_t aux2_first_part_byte_ct = 1 + (het_ct / CHAR_BIT);
   if (PtrCheck(fread_end, fread_ptr, aux2_first_part_byte_ct)) {
     return kPglRetMalformedInput;
@@ -9707,7 +11118,7 @@ BoolErr ValidateGeno(const unsigned char* fread_end, uint32_t vidx, PgenReaderMa
     }
     return 0;
   }
-  const uint32_t is_ldbase = VrtypeLdCompressed(pgrp->fi.vrtypes[vidx + 1]);
+  const uint32_t is_ldbase = IsNextLdbase(&(pgrp->fi), vidx);
   if (!(vrtype & 4)) {
     if (vrtype & 1) {
       if (unlikely(ValidateOnebit(fread_end, fread_pp, pgrp, genovec))) {
@@ -9750,6 +11161,8 @@ BoolErr ValidateGeno(const unsigned char* fread_end, uint32_t vidx, PgenReaderMa
   }
   if (is_ldbase) {
     CopyNyparr(genovec, sample_ct, pgrp->ldbase_genovec);
+    pgrp->ldbase_vidx = vidx;
+    pgrp->ldbase_stypes = kfPgrLdcacheNyp;
   }
   return 0;
 }
@@ -10157,6 +11570,64 @@ BoolErr ValidateHphase(const unsigned char* fread_end, uint32_t vidx, uint32_t h
   return 0;
 }
 
+// PBWT-mode biallelic hardcall-phase track.  Run lengths are only
+// checked for consistency with phasepresent_ct; any such sequence decodes to
+// valid phaseinfo.
+BoolErr ValidatePbwtHphase(const unsigned char* fread_end, uint32_t vidx, uint32_t het_ct, const unsigned char** fread_pp, char* errstr_buf) {
+  if (unlikely(*fread_pp == fread_end)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid hardcall phase track present for (0-based) variant #%u.\n", vidx);
+    return 1;
+  }
+  const uint32_t pbwt_encoded = *((*fread_pp)++);
+  if (!pbwt_encoded) {
+    return ValidateHphase(fread_end, vidx, het_ct, fread_pp, errstr_buf);
+  }
+  if (unlikely(pbwt_encoded != 1)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Hardcall phase track for (0-based) variant #%u has an invalid encoding byte.\n", vidx);
+    return 1;
+  }
+  if (unlikely(!het_ct)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Hardcall phase track present for (0-based) variant #%u, but there were no heterozygous calls.\n", vidx);
+    return 1;
+  }
+  uint32_t phasepresent_ct = het_ct;
+  const unsigned char* aux2_first_part = *fread_pp;
+  if ((*fread_pp != fread_end) && ((*aux2_first_part) & 1)) {
+    // same phasepresent checks as ValidateHphase()
+    const uint32_t aux2_first_part_byte_ct = 1 + (het_ct / CHAR_BIT);
+    if (PtrAddCk(fread_end, aux2_first_part_byte_ct, fread_pp)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid hardcall phase track present for (0-based) variant #%u.\n", vidx);
+      return 1;
+    }
+    const uint32_t het_ct_p1_mod8 = (het_ct + 1) % CHAR_BIT;
+    if (unlikely(het_ct_p1_mod8 && ((*fread_pp)[-1] >> het_ct_p1_mod8))) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Hardcall phase track for (0-based) variant #%u has nonzero trailing bits.\n", vidx);
+      return 1;
+    }
+    phasepresent_ct = PopcountBytes(aux2_first_part, aux2_first_part_byte_ct) - 1;
+    if (unlikely(!phasepresent_ct)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Hardcall phase track for (0-based) variant #%u does not have any actual phase information.\n", vidx);
+      return 1;
+    }
+  } else {
+    if (unlikely((*fread_pp == fread_end) || (*aux2_first_part))) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid hardcall phase track present for (0-based) variant #%u.\n", vidx);
+      return 1;
+    }
+    ++(*fread_pp);
+  }
+  uint32_t remaining_ct = phasepresent_ct;
+  do {
+    const uint32_t run_len = GetVint31(fread_end, fread_pp);
+    if (unlikely(run_len > remaining_ct)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Hardcall phase track for (0-based) variant #%u has invalid PBWT run lengths.\n", vidx);
+      return 1;
+    }
+    remaining_ct -= run_len;
+  } while (remaining_ct);
+  return 0;
+}
+
 PglErr ValidateDosage16(const unsigned char* fread_end, uint32_t vidx, PgenReaderMain* pgrp, const unsigned char** fread_pp, char* errstr_buf) {
   // similar to ParseDosage16().  doesn't support multiallelic data yet.
   const uint32_t vrtype = pgrp->fi.vrtypes[vidx];
@@ -10296,14 +11767,13 @@ PglErr ValidateDosage16(const unsigned char* fread_end, uint32_t vidx, PgenReade
   return kPglRetSuccess;
 }
 
-static_assert(kPglVblockSize == 65536, "PgrValidate() needs to have an error message updated.");
-PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf) {
+static_assert(kPglVblockSize == 65536, "PgrValidateIndex() needs to have an error message updated.");
+PglErr PgrValidateIndex(PgenReader* pgr_ptr, char* errstr_buf) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
-  // Performs all validation which isn't done by pgfi_init_phase{1,2}() and
-  // PgrInit().
+  // Performs all header/index validation which isn't done by
+  // pgfi_init_phase{1,2}() and PgrInit().
   const uintptr_t* allele_idx_offsets = pgrp->fi.allele_idx_offsets;
   const uint32_t variant_ct = pgrp->fi.raw_variant_ct;
-  const uint32_t sample_ct = pgrp->fi.raw_sample_ct;
   const uint32_t const_vrtype = pgrp->fi.const_vrtype;
   if (const_vrtype != UINT32_MAX) {
     if (unlikely(allele_idx_offsets && (allele_idx_offsets[variant_ct] != 2 * variant_ct))) {
@@ -10312,24 +11782,8 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     }
     // const uintptr_t const_vrec_width = pgrp->fi.const_vrec_width;
     if ((!const_vrtype) || (const_vrtype == kPglVrtypePlink1)) {
-      // only thing that can go wrong is nonzero trailing bits
-      const uint32_t dbl_sample_ct_mod4 = 2 * (sample_ct % 4);
-      if (!dbl_sample_ct_mod4) {
-        return kPglRetSuccess;
-      }
-      for (uint32_t vidx = 0; vidx != variant_ct; ++vidx) {
-        const unsigned char* fread_ptr;
-        const unsigned char* fread_end = nullptr;
-        if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
-          FillPgenReadErrstrFromErrno(errstr_buf);
-          return kPglRetReadFail;
-        }
-        const uint32_t last_byte_in_record = fread_end[-1];
-        if (unlikely(last_byte_in_record >> dbl_sample_ct_mod4)) {
-          snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Last byte of (0-based) variant #%u has nonzero trailing bits.\n", vidx);
-          return kPglRetMalformedInput;
-        }
-      }
+      // only thing that can go wrong is nonzero trailing bits, which is
+      // checked by PgrValidateRecords()
       return kPglRetSuccess;
     }
     // todo: 16-bit dosage entries can't be in [32769,65534]
@@ -10346,15 +11800,20 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
   // file size may not be validated yet.
   uint64_t fsize;
   FILE* ff = pgrp->ff;
+  if (unlikely(!ff)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgrValidate() requires a per-variant-fread PgenReader.\n");
+    return kPglRetImproperFunctionCall;
+  }
   if (unlikely(fseeko(ff, 0, SEEK_END))) {
     FillPgenReadErrstrFromNzErrno(errstr_buf);
     return kPglRetReadFail;
   }
   fsize = ftello(ff);
-  pgrp->fp_vidx = 1;  // force fseek when loading first variant
   // todo: verify equality if no mode-0x11 footer; and if there is a footer,
   // validate it
-  const uint64_t expected_fsize_min = pgrp->fi.var_fpos[variant_ct];
+  const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+  const uint64_t* zframe_fpos = pgrp->fi.zframe_fpos;
+  const uint64_t expected_fsize_min = zframe_fpos? zframe_fpos[vblock_ct] : pgrp->fi.var_fpos[variant_ct];
   if (unlikely(expected_fsize_min > fsize)) {
     char* write_iter = strcpya_k(errstr_buf, "Error: .pgen header indicates that file size should be at least ");
     write_iter = i64toa(expected_fsize_min, write_iter);
@@ -10363,7 +11822,6 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     strcpy_k(write_iter, " bytes.\n");
     return kPglRetMalformedInput;
   }
-  const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
   uint32_t header_ctrl = 0;
   if (unlikely(fseeko(ff, 11, SEEK_SET))) {
     FillPgenReadErrstrFromNzErrno(errstr_buf);
@@ -10374,26 +11832,37 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     FillPgenReadErrstr(ff, errstr_buf);
     return kPglRetReadFail;
   }
-  for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
-    uint64_t vblock_start_fpos;
-    if (unlikely(!fread_unlocked(&vblock_start_fpos, sizeof(int64_t), 1, ff))) {
-      FillPgenReadErrstr(ff, errstr_buf);
-      return kPglRetReadFail;
-    }
-    if (unlikely(vblock_start_fpos != pgrp->fi.var_fpos[vblock_idx * kPglVblockSize])) {
-      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen header vblock-start index is inconsistent with variant record length index.\n");
-      return kPglRetMalformedInput;
+  // In zstd modes, this index holds the zstd frame offsets instead (which
+  // were already loaded in full), followed by one extra entry.
+  uint64_t header_base_byte_ct = 20;
+  if (zframe_fpos) {
+    header_base_byte_ct += sizeof(int64_t);
+  } else {
+    for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
+      uint64_t vblock_start_fpos;
+      if (unlikely(!fread_unlocked(&vblock_start_fpos, sizeof(int64_t), 1, ff))) {
+        FillPgenReadErrstr(ff, errstr_buf);
+        return kPglRetReadFail;
+      }
+      if (unlikely(vblock_start_fpos != pgrp->fi.var_fpos[vblock_idx * kPglVblockSize])) {
+        snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen header vblock-start index is inconsistent with variant record length index.\n");
+        return kPglRetMalformedInput;
+      }
     }
   }
   const uint32_t vrtype_and_fpos_storage = header_ctrl & 15;
   const uint32_t alt_allele_ct_byte_ct = (header_ctrl >> 4) & 3;
   const uint32_t nonref_flags_stored = ((header_ctrl >> 6) == 3);
+  const uint32_t ldbase_backrefs_present = (pgrp->fi.ldbase_backrefs != nullptr);
 
   // does not include vrtypes yet
   uint64_t vblock_index_byte_ct = kPglVblockSize * (1 + (vrtype_and_fpos_storage & 3) + alt_allele_ct_byte_ct);
   if (nonref_flags_stored) {
     vblock_index_byte_ct += kPglVblockSize / CHAR_BIT;
   }
+  if (ldbase_backrefs_present) {
+    vblock_index_byte_ct += kPglVblockSize;
+  }
   uint64_t last_vrtype_byte_offset = 0;
   uint32_t trailing_shift = 4;
   if (vrtype_and_fpos_storage & 8) {
@@ -10401,20 +11870,20 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     if (vrtype_and_fpos_storage == 8) {
       const uint32_t variant_ct_mod4 = variant_ct % 4;
       if (variant_ct_mod4) {
-        last_vrtype_byte_offset = 20 + (vblock_ct - 1) * (vblock_index_byte_ct + sizeof(int64_t)) + ((variant_ct % kPglVblockSize) / 4);
+        last_vrtype_byte_offset = header_base_byte_ct + (vblock_ct - 1) * (vblock_index_byte_ct + sizeof(int64_t)) + ((variant_ct % kPglVblockSize) / 4);
         trailing_shift = variant_ct_mod4 * 2;
       }
     } else {
       assert(vrtype_and_fpos_storage == 9);
       if (variant_ct % 2) {
-        last_vrtype_byte_offset = 20 + (vblock_ct - 1) * (vblock_index_byte_ct + sizeof(int64_t)) + ((variant_ct % kPglVblockSize) / 2);
+        last_vrtype_byte_offset = header_base_byte_ct + (vblock_ct - 1) * (vblock_index_byte_ct + sizeof(int64_t)) + ((variant_ct % kPglVblockSize) / 2);
       }
     }
   } else if (!(vrtype_and_fpos_storage & 4)) {
     vblock_index_byte_ct += kPglVblockSize / 2;
     if (variant_ct % 2) {
       // bugfix (22 Nov 2017): forgot to add offset in last block
-      last_vrtype_byte_offset = 20 + (vblock_ct - 1) * (vblock_index_byte_ct + sizeof(int64_t)) + ((variant_ct % kPglVblockSize) / 2);
+      last_vrtype_byte_offset = header_base_byte_ct + (vblock_ct - 1) * (vblock_index_byte_ct + sizeof(int64_t)) + ((variant_ct % kPglVblockSize) / 2);
     }
     /*
   } else {
@@ -10448,10 +11917,49 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     }
   }
 
-  // could move most of this into plink2_common and make it multithreaded, if
-  // speed is ever an issue.
+  return kPglRetSuccess;
+}
+
+PglErr PgrValidateRecords(uint32_t variant_idx_start, uint32_t variant_idx_end, PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf) {
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  const uintptr_t* allele_idx_offsets = pgrp->fi.allele_idx_offsets;
+  const uint32_t sample_ct = pgrp->fi.raw_sample_ct;
+  const uint32_t const_vrtype = pgrp->fi.const_vrtype;
+  pgrp->fp_vidx = variant_idx_start + 1;  // force fseek when loading first variant
+  if (const_vrtype != UINT32_MAX) {
+    // PgrValidateIndex() already rejected the other fixed-width types.
+    const uint32_t dbl_sample_ct_mod4 = 2 * (sample_ct % 4);
+    if (!dbl_sample_ct_mod4) {
+      return kPglRetSuccess;
+    }
+    for (uint32_t vidx = variant_idx_start; vidx != variant_idx_end; ++vidx) {
+      const unsigned char* fread_ptr;
+      const unsigned char* fread_end = nullptr;
+      if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
+        FillPgenReadErrstrFromErrno(errstr_buf);
+        return kPglRetReadFail;
+      }
+      const uint32_t last_byte_in_record = fread_end[-1];
+      if (unlikely(last_byte_in_record >> dbl_sample_ct_mod4)) {
+        snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Last byte of (0-based) variant #%u has nonzero trailing bits.\n", vidx);
+        return kPglRetMalformedInput;
+      }
+    }
+    return kPglRetSuccess;
+  }
+  const unsigned char* vrtypes = pgrp->fi.vrtypes;
+  const uint32_t pbwt_hphase = (pgrp->fi.gflags / kfPgenGlobalPbwtHphase) & 1;
   uint32_t allele_ct = 2;
-  for (uint32_t vidx = 0; vidx != variant_ct; ++vidx) {
+  const unsigned char* ldbase_backrefs = pgrp->fi.ldbase_backrefs;
+  for (uint32_t vidx = variant_idx_start; vidx != variant_idx_end; ++vidx) {
+    if (ldbase_backrefs && VrtypeLdCompressed(vrtypes[vidx])) {
+      // The LD base may not be the most recently validated one; it's safe to
+      // reload it with the regular parser at this point.
+      if (unlikely(LdLoadGenovecSubsetIfNecessary(nullptr, nullptr, sample_ct, vidx, pgrp))) {
+        snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to reload LD base of (0-based) variant #%u.\n", vidx);
+        return kPglRetMalformedInput;
+      }
+    }
     const unsigned char* fread_ptr;
     const unsigned char* fread_end;
     if (unlikely(InitReadPtrs(vidx, pgrp, &fread_ptr, &fread_end))) {
@@ -10475,7 +11983,11 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
     }
     // don't need genovec_buf to store main genotypes past this point.
     if (VrtypeHphase(vrtype)) {
-      if (unlikely(ValidateHphase(fread_end, vidx, het_ct, &fread_ptr, errstr_buf))) {
+      if (pbwt_hphase && (!VrtypeMultiallelicHc(vrtype))) {
+        if (unlikely(ValidatePbwtHphase(fread_end, vidx, het_ct, &fread_ptr, errstr_buf))) {
+          return kPglRetMalformedInput;
+        }
+      } else if (unlikely(ValidateHphase(fread_end, vidx, het_ct, &fread_ptr, errstr_buf))) {
         return kPglRetMalformedInput;
       }
     }
@@ -10506,9 +12018,261 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
   return kPglRetSuccess;
 }
 
+PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf) {
+  const PglErr reterr = PgrValidateIndex(pgr_ptr, errstr_buf);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  return PgrValidateRecords(0, GetPgrp(pgr_ptr)->fi.raw_variant_ct, pgr_ptr, genovec_buf, errstr_buf);
+}
+
+void PreinitSmaj(PgenSmajReader* psrp) {
+  psrp->ff = nullptr;
+}
+
+PglErr SmajGetPgenKey(const char* pgen_fname, unsigned char* key, char* errstr_buf) {
+  FILE* ff = fopen(pgen_fname, FOPEN_RB);
+  if (unlikely(!ff)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to open %s : %s.\n", pgen_fname, strerror(errno));
+    return kPglRetOpenFail;
+  }
+  if (unlikely(fseeko(ff, 0, SEEK_END))) {
+    goto SmajGetPgenKey_ret_READ_FAIL;
+  }
+  {
+    const uint64_t fsize = ftello(ff);
+    rewind(ff);
+    uint64_t hash = 0xcbf29ce484222325LLU;
+    uint32_t bytes_left = MINV(fsize, kPglSmajPgenKeyPrefixSize);
+    unsigned char buf[4096];
+    while (bytes_left) {
+      const uint32_t cur_byte_ct = MINV(bytes_left, sizeof(buf));
+      if (unlikely(!fread_unlocked(buf, cur_byte_ct, 1, ff))) {
+        goto SmajGetPgenKey_ret_READ_FAIL;
+      }
+      for (uint32_t uii = 0; uii != cur_byte_ct; ++uii) {
+        hash = (hash ^ buf[uii]) * 0x100000001b3LLU;
+      }
+      bytes_left -= cur_byte_ct;
+    }
+    fclose(ff);
+    memcpy(key, &fsize, sizeof(int64_t));
+    memcpy(&(key[sizeof(int64_t)]), &hash, sizeof(int64_t));
+    return kPglRetSuccess;
+  }
+ SmajGetPgenKey_ret_READ_FAIL:
+  if (feof_unlocked(ff)) {
+    errno = 0;
+  }
+  snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", pgen_fname, strerror(errno));
+  fclose(ff);
+  return kPglRetReadFail;
+}
+
+PglErr SmajInitPhase1(const char* fname, const char* pgen_fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, PgenSmajReader* psrp, uintptr_t* smaj_alloc_cacheline_ct_ptr, char* errstr_buf) {
+  psrp->ff = fopen(fname, FOPEN_RB);
+  FILE* ff = psrp->ff;
+  if (unlikely(!ff)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to open %s : %s.\n", fname, strerror(errno));
+    return kPglRetOpenFail;
+  }
+  unsigned char header_buf[kPglSmajHeaderBlen];
+  if (unlikely(fseeko(ff, 0, SEEK_END))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", fname, strerror(errno));
+    return kPglRetReadFail;
+  }
+  const uint64_t fsize = ftello(ff);
+  if (unlikely(fsize < kPglSmajHeaderBlen + 16)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is too small to be a valid .pgen.smaj file.\n", fname);
+    return kPglRetMalformedInput;
+  }
+  rewind(ff);
+  if (unlikely(!fread_unlocked(header_buf, kPglSmajHeaderBlen, 1, ff))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", fname, strerror(errno));
+    return kPglRetReadFail;
+  }
+  if (unlikely(!memequal_k(header_buf, "l\x1b\x40", 3))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is not a .pgen.smaj file (first three bytes don't match the magic number).\n", fname);
+    return kPglRetMalformedInput;
+  }
+  if (unlikely(header_buf[3])) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has an unsupported .pgen.smaj format version.\n", fname);
+    return kPglRetNotYetSupported;
+  }
+  uint32_t header_variant_ct;
+  uint32_t header_sample_ct;
+  uint32_t vblock_size;
+  memcpy(&header_variant_ct, &(header_buf[4]), sizeof(int32_t));
+  memcpy(&header_sample_ct, &(header_buf[8]), sizeof(int32_t));
+  memcpy(&vblock_size, &(header_buf[12]), sizeof(int32_t));
+  // deliberate underflow
+  if (unlikely(((header_variant_ct - 1) > (kPglMaxVariantCt - 1)) || ((header_sample_ct - 1) > (kPglMaxSampleCt - 1)) || (!vblock_size) || (vblock_size % kPglSmajVblockAlign))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid header in %s.\n", fname);
+    return kPglRetMalformedInput;
+  }
+  if (unlikely((raw_variant_ct != UINT32_MAX) && (raw_variant_ct != header_variant_ct))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: SmajInitPhase1() was called with raw_variant_ct == %u, but %s contains %u variant%s.\n", raw_variant_ct, fname, header_variant_ct, (header_variant_ct == 1)? "" : "s");
+    return kPglRetInconsistentInput;
+  }
+  if (unlikely((raw_sample_ct != UINT32_MAX) && (raw_sample_ct != header_sample_ct))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: SmajInitPhase1() was called with raw_sample_ct == %u, but %s contains %u sample%s.\n", raw_sample_ct, fname, header_sample_ct, (header_sample_ct == 1)? "" : "s");
+    return kPglRetInconsistentInput;
+  }
+  if (pgen_fname) {
+    unsigned char pgen_key[kPglSmajPgenKeyBlen];
+    const PglErr reterr = SmajGetPgenKey(pgen_fname, pgen_key, errstr_buf);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+    if (unlikely(!memequal(pgen_key, &(header_buf[16]), kPglSmajPgenKeyBlen))) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s was not generated from the current version of %s (regenerate it with pgen_compress -s).\n", fname, pgen_fname);
+      return kPglRetInconsistentInput;
+    }
+  }
+  const uint32_t vblock_ct = DivUp(header_variant_ct, vblock_size);
+  const uint32_t last_vblock_size = header_variant_ct - (vblock_ct - 1) * vblock_size;
+  const uint64_t expected_fsize = kPglSmajHeaderBlen + (vblock_ct + 1) * S_CAST(uint64_t, sizeof(int64_t)) + header_sample_ct * ((vblock_ct - 1) * S_CAST(uint64_t, NypCtToByteCt(vblock_size)) + NypCtToByteCt(last_vblock_size));
+  if (unlikely(fsize != expected_fsize)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has an unexpected size (truncated or corrupted file?).\n", fname);
+    return kPglRetMalformedInput;
+  }
+  psrp->raw_variant_ct = header_variant_ct;
+  psrp->raw_sample_ct = header_sample_ct;
+  psrp->vblock_size = vblock_size;
+  psrp->vblock_ct = vblock_ct;
+  *smaj_alloc_cacheline_ct_ptr = Int64CtToCachelineCt(vblock_ct + 1) + WordCtToCachelineCt(NypCtToWordCt(vblock_size) + 1);
+  return kPglRetSuccess;
+}
+
+PglErr SmajInitPhase2(PgenSmajReader* psrp, unsigned char* smaj_alloc, char* errstr_buf) {
+  const uint32_t vblock_ct = psrp->vblock_ct;
+  psrp->vblock_fpos = R_CAST(uint64_t*, smaj_alloc);
+  psrp->readbuf = R_CAST(uintptr_t*, &(smaj_alloc[Int64CtToCachelineCt(vblock_ct + 1) * kCacheline]));
+  psrp->readbuf[NypCtToWordCt(psrp->vblock_size)] = 0;
+  uint64_t* vblock_fpos = psrp->vblock_fpos;
+  // Phase 1 left the file position right after the header.
+  if (unlikely(!fread_unlocked(vblock_fpos, (vblock_ct + 1) * sizeof(int64_t), 1, psrp->ff))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen.smaj read failure: %s.\n", strerror(errno));
+    return kPglRetReadFail;
+  }
+  // The tiles are currently fixed-size, so the block index is redundant with
+  // the header; verify that it's consistent.
+  const uint32_t raw_variant_ct = psrp->raw_variant_ct;
+  const uint32_t vblock_size = psrp->vblock_size;
+  const uint64_t row_ct = psrp->raw_sample_ct;
+  uint64_t expected_fpos = kPglSmajHeaderBlen + (vblock_ct + 1) * S_CAST(uint64_t, sizeof(int64_t));
+  for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
+    if (unlikely(vblock_fpos[vblock_idx] != expected_fpos)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen.smaj block index entry %u.\n", vblock_idx);
+      return kPglRetMalformedInput;
+    }
+    const uint32_t cur_vblock_size = MINV(vblock_size, raw_variant_ct - vblock_idx * vblock_size);
+    expected_fpos += row_ct * NypCtToByteCt(cur_vblock_size);
+  }
+  if (unlikely(vblock_fpos[vblock_ct] != expected_fpos)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Invalid .pgen.smaj block index entry %u.\n", vblock_ct);
+    return kPglRetMalformedInput;
+  }
+  return kPglRetSuccess;
+}
+
+// Copies nyp_ct nyps, starting at nyp src_offset (< 4) of src, to dst,
+// starting at nyp dst_idx.  Previous contents of dst before dst_idx are
+// preserved.  src is clobbered, and must have a readable word past the last
+// one containing copied nyps.
+static void SmajCopyNyps(uint32_t src_offset, uint32_t nyp_ct, uint32_t dst_idx, uintptr_t* src, uintptr_t* dst) {
+  if (src_offset) {
+    const uint32_t src_word_ct = NypCtToWordCt(src_offset + nyp_ct);
+    const uint32_t rshift = 2 * src_offset;
+    const uint32_t lshift = kBitsPerWord - rshift;
+    for (uint32_t widx = 0; widx != src_word_ct; ++widx) {
+      src[widx] = (src[widx] >> rshift) | (src[widx + 1] << lshift);
+    }
+  }
+  ZeroTrailingNyps(nyp_ct, src);
+  const uint32_t word_ct = NypCtToWordCt(nyp_ct);
+  uintptr_t* dst_iter = &(dst[dst_idx / kBitsPerWordD2]);
+  const uint32_t lshift = 2 * (dst_idx % kBitsPerWordD2);
+  if (!lshift) {
+    memcpy(dst_iter, src, word_ct * kBytesPerWord);
+    return;
+  }
+  const uint32_t rshift = kBitsPerWord - lshift;
+  uintptr_t carry = bzhi(dst_iter[0], lshift);
+  for (uint32_t widx = 0; widx != word_ct; ++widx) {
+    const uintptr_t cur_word = src[widx];
+    dst_iter[widx] = carry | (cur_word << lshift);
+    carry = cur_word >> rshift;
+  }
+  if (NypCtToWordCt((dst_idx % kBitsPerWordD2) + nyp_ct) > word_ct) {
+    dst_iter[word_ct] = carry;
+  }
+}
+
+PglErr SmajGet(uint32_t sample_uidx, uint32_t vidx_start, uint32_t vidx_end, PgenSmajReader* psrp, uintptr_t* __restrict genovec) {
+  if (vidx_start == vidx_end) {
+    return kPglRetSuccess;
+  }
+  FILE* ff = psrp->ff;
+  const uint32_t raw_variant_ct = psrp->raw_variant_ct;
+  const uint32_t vblock_size = psrp->vblock_size;
+  const uint32_t direct_read = !(vidx_start % kBitsPerWordD2);
+  uint32_t vblock_idx = vidx_start / vblock_size;
+  uint32_t vidx = vidx_start;
+  do {
+    const uint32_t vblock_vidx_start = vblock_idx * vblock_size;
+    const uint32_t cur_vblock_size = MINV(vblock_size, raw_variant_ct - vblock_vidx_start);
+    const uint32_t cur_vidx_end = MINV(vidx_end, vblock_vidx_start + cur_vblock_size);
+    const uint32_t row_byte_start = (vidx - vblock_vidx_start) / 4;
+    const uint32_t row_byte_end = NypCtToByteCt(cur_vidx_end - vblock_vidx_start);
+    const uint64_t fpos = psrp->vblock_fpos[vblock_idx] + S_CAST(uint64_t, sample_uidx) * NypCtToByteCt(cur_vblock_size) + row_byte_start;
+    const uint32_t dst_idx = vidx - vidx_start;
+    // Since vblock_size is a multiple of kBitsPerWordD2, dst_idx is always
+    // word-aligned in the direct_read case.
+    uintptr_t* read_target = direct_read? (&(genovec[dst_idx / kBitsPerWordD2])) : psrp->readbuf;
+    if (unlikely(fseeko(ff, fpos, SEEK_SET) ||
+                 (!fread_unlocked(read_target, row_byte_end - row_byte_start, 1, ff)))) {
+      return kPglRetReadFail;
+    }
+    if (!direct_read) {
+      SmajCopyNyps(vidx % 4, cur_vidx_end - vidx, dst_idx, read_target, genovec);
+    }
+    vidx = cur_vidx_end;
+    ++vblock_idx;
+  } while (vidx < vidx_end);
+  ZeroTrailingNyps(vidx_end - vidx_start, genovec);
+  return kPglRetSuccess;
+}
+
 
 BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp) {
   // memory is the responsibility of the caller
+  if (pgfip->vcache) {
+    VcacheDestroyLocks(pgfip->vcache->stripe_ct, pgfip->vcache);
+    pgfip->vcache = nullptr;
+  }
+  if (pgfip->zcursors) {
+    for (uint32_t cursor_idx = 0; cursor_idx != pgfip->zcursor_ct; ++cursor_idx) {
+      CleanupZframeCursor(&(pgfip->zcursors[cursor_idx]));
+    }
+    free(pgfip->zcursors);
+    pgfip->zcursors = nullptr;
+    pgfip->zcursor_ct = 0;
+    pgfip->zparallel_for = nullptr;
+    pgfip->zrunner_arg = nullptr;
+  }
+#ifndef NO_MMAP
+  if (pgfip->mmap_base) {
+    const BoolErr munmap_err = (munmap(K_CAST(unsigned char*, pgfip->mmap_base), pgfip->mmap_byte_ct) != 0);
+    pgfip->mmap_base = nullptr;
+    pgfip->mmap_byte_ct = 0;
+    pgfip->block_base = nullptr;
+    if (unlikely(munmap_err && (*reterrp == kPglRetSuccess))) {
+      *reterrp = kPglRetReadFail;
+      return 1;
+    }
+  }
+#endif
   if (pgfip->shared_ff) {
     BoolErr pgi_fclose_err = 0;
     if (pgfip->pgi_ff) {
@@ -10529,7 +12293,13 @@ BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp) {
 BoolErr CleanupPgr(PgenReader* pgr_ptr, PglErr* reterrp) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
   // assume file is open if pgr.ff is not null
-  // memory is the responsibility of the caller for now
+  // memory is the responsibility of the caller for now, except for the zstd
+  // cursor
+  if (pgrp->zcursor) {
+    CleanupZframeCursor(pgrp->zcursor);
+    free(pgrp->zcursor);
+    pgrp->zcursor = nullptr;
+  }
   if (!pgrp->ff) {
     return 0;
   }
@@ -10542,6 +12312,19 @@ BoolErr CleanupPgr(PgenReader* pgr_ptr, PglErr* reterrp) {
   return 0;
 }
 
+BoolErr CleanupSmaj(PgenSmajReader* psrp, PglErr* reterrp) {
+  if (!psrp->ff) {
+    return 0;
+  }
+  if (fclose_null(&(psrp->ff))) {
+    if (*reterrp == kPglRetSuccess) {
+      *reterrp = kPglRetReadFail;
+      return 1;
+    }
+  }
+  return 0;
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -22,6 +22,27 @@
 
 #include "pgenlib_misc.h"
 
+#ifndef NO_MMAP
+#  ifdef _WIN32
+#    define NO_MMAP
+#  endif
+#endif
+#ifndef NO_PREAD
+#  ifdef _WIN32
+#    define NO_PREAD
+#  endif
+#endif
+
+#ifndef _WIN32
+#  include <pthread.h>
+#endif
+
+#ifdef IGNORE_BUNDLED_ZSTD
+#  include <zstd.h>
+#else
+#  include "../zstd/lib/zstd.h"
+#endif
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -35,6 +56,94 @@ FLAGSET_DEF_START()
   kfPgrLdcacheBasicGenocounts = (1 << 3)
 FLAGSET_DEF_END(PgrLdcacheFlags);
 
+// Optional size-bounded LRU cache of decoded hardcall genovecs, shared by all
+// PgenReaders based on the same PgenFileInfo.  See PgfiInitVcache() below.
+// Treat as private.
+
+// Variant vidx is always cached in stripe (vidx % stripe_ct).  Each stripe
+// owns a contiguous range of slots, with its own LRU list and lock.
+typedef struct PgenVcacheStripeStruct {
+#ifdef _WIN32
+  CRITICAL_SECTION lock;
+#else
+  pthread_mutex_t lock;
+#endif
+  uint32_t slot_start;
+  uint32_t slot_end;
+  uint32_t slot_used_end;
+
+  // most-recently-used and least-recently-used slots
+  uint32_t lru_head;
+  uint32_t lru_tail;
+
+  uint64_t hit_ct;
+  uint64_t miss_ct;
+} PgenVcacheStripe;
+
+CONSTI32(kPglVcacheMaxStripeCt, 32);
+
+// Maximum number of distinct proper sample subsets which can have cache
+// entries at the same time; loads under any other subset bypass the cache.
+CONSTI32(kPglVcacheSubsetCt, 8);
+
+typedef struct PgenVariantCacheStruct {
+  uint32_t stripe_ct;
+  uint32_t slot_vec_ct;
+
+  // Registered proper sample subsets.  Subset ID 0 is the full sample set; ID
+  // k > 0 refers to the subset_sample_cts[k - 1]-sample subset at
+  // subset_sample_includes[(k - 1) * raw_sample_ctaw], with trailing bits
+  // cleared.  Only modified while all stripe locks are held, so holding any
+  // one of them is enough to read it.
+  uint32_t subset_ct;
+  uint32_t raw_sample_ctaw;
+  uint32_t subset_sample_cts[kPglVcacheSubsetCt];
+  uintptr_t* subset_sample_includes;
+
+  // Stripe i starts at byte offset i * stripe_stride (a multiple of
+  // kCacheline) from stripes_base.
+  unsigned char* stripes_base;
+  uintptr_t stripe_stride;
+
+  // length raw_variant_ct; UINT32_MAX if the variant isn't cached
+  uint32_t* vidx_to_slot;
+
+  uint32_t* slot_vidxs;
+  uint32_t* slot_prevs;
+  uint32_t* slot_nexts;
+
+  // An entry is only valid for the sample subset it was decoded under.
+  uint32_t* slot_subset_ids;
+  uintptr_t* slot_genovecs;
+} PgenVariantCache;
+
+// Caller-owned parallel executor.  A PglParallelForFunc must call
+// task_func(task_arg, task_idx) exactly once for each task_idx in
+// [0, task_ct), possibly concurrently, and return only after all of those
+// calls have returned.  pgenlib never creates threads itself; functions which
+// can use several cores accept one of these, so the work runs on whatever
+// threads the caller already manages.
+typedef void (*PglTaskFunc)(void* task_arg, uint32_t task_idx);
+typedef void (*PglParallelForFunc)(void* runner_arg, uint32_t task_ct, PglTaskFunc task_func, void* task_arg);
+
+// Streaming-decompression state for one thread reading variant records from a
+// zstd-mode (compressed vblock) .pgen.  Treat as private.
+typedef struct PgenZframeCursorStruct {
+  ZSTD_DCtx* dctx;
+  unsigned char* inbuf;
+  unsigned char* discardbuf;
+  // file offset of the next compressed byte to load into inbuf
+  uint64_t in_fpos;
+  // cumulative compressed bytes loaded into inbuf
+  uint64_t in_byte_ct;
+  // uncompressed-record-stream offset of the next decompressed byte
+  uint64_t out_fpos;
+  // UINT32_MAX if no frame is in progress
+  uint32_t frame_idx;
+  uint32_t in_pos;
+  uint32_t in_size;
+} PgenZframeCursor;
+
 // PgenFileInfo and PgenReader are the main exported "classes".
 // Exported functions involving these data structure should all have
 // "pgfi"/"pgr" in their names.
@@ -104,6 +213,56 @@ typedef struct PgenFileInfoStruct {
 
   const unsigned char* block_base;  // nullptr if using per-variant fread()
   uint64_t block_offset;
+
+  // Cumulative number of bytes PgfiMultiread() has successfully read from the
+  // file (compressed bytes, in zstd modes).  Skipped gaps aren't counted, and
+  // this stays at zero in mmap mode.
+  uint64_t multiread_byte_ct;
+  // Cumulative wall-clock time spent in PgfiMultiread() calls.
+  uint64_t multiread_ns;
+
+  // Only non-null after a successful PgfiInitMmap() call.  block_base is
+  // initialized to the same address, with block_offset == 0.
+  const unsigned char* mmap_base;
+  uint64_t mmap_byte_ct;
+
+  // -1 unless PgfiInitPread() has been called.  This is just fileno() of
+  // shared_ff, which then stays with the PgenFileInfo instead of being moved
+  // to the first PgenReader.
+  int32_t pread_fd;
+
+  // nullptr unless PgfiInitVcache() has been called.
+  PgenVariantCache* vcache;
+
+  // Number of zstd frames (one per vblock) in zstd modes, 0 otherwise.
+  // In these modes, var_fpos[] values are positions in the uncompressed
+  // variant record stream, which is defined to start at zframe_fpos[0].
+  uint32_t zframe_ct;
+
+  // Number of PgfiMultiread() decompression cursors.
+  uint32_t zcursor_ct;
+
+  // zframe_ct + 1 entries: file offset of each frame, followed by the end of
+  // the last frame.
+  uint64_t* zframe_fpos;
+
+  // zcursor_ct entries.  Allocated by PgfiInitZstdRunner(), or by the first
+  // PgfiMultiread() call.
+  PgenZframeCursor* zcursors;
+
+  // Set by PgfiInitZstdRunner(); nullptr if PgfiMultiread() should decompress
+  // on the calling thread.
+  PglParallelForFunc zparallel_for;
+  void* zrunner_arg;
+
+  // LD-window-mode base back-references (one byte per variant), nullptr
+  // otherwise.  Use GetPgfiLdbaseVidx() instead of accessing this directly.
+  unsigned char* ldbase_backrefs;
+  // Also LD-window mode only: ldbase_reach[vidx] is the number of additional
+  // non-LD-compressed variants, before vidx's own LD base (or vidx itself if
+  // it isn't LD-compressed), referenced by vidx or any later variant in its
+  // vblock.  Determines where block loads must start.
+  unsigned char* ldbase_reach;
 } PgenFileInfo;
 
 typedef struct PgenReaderMainStruct {
@@ -116,10 +275,12 @@ typedef struct PgenReaderMainStruct {
   // If we don't fseek, what's the next variant we'd read?
   uint32_t fp_vidx;
 
-  // ** per-variant fread()-only **
-  FILE* ff;
+  // ** per-variant fread()/pread()-only **
+  FILE* ff;  // nullptr in pread mode
   unsigned char* fread_buf;
-  // ** end per-variant fread()-only **
+  // zstd modes only; malloc'ed by PgrInit(), freed by CleanupPgr()
+  PgenZframeCursor* zcursor;
+  // ** end per-variant fread()/pread()-only **
 
   // if LD compression is present, cache the last non-LD-compressed variant
   uint32_t ldbase_vidx;
@@ -168,6 +329,33 @@ typedef struct PgenReaderMainStruct {
   uintptr_t* workspace_dosage_present;
   uintptr_t* workspace_dphase_present;
 
+  // ** LD-window modes only (nullptr otherwise) **
+  // Raw genovecs of the last kPglLdWindowSize LD bases loaded by
+  // LdLoadNecessary(), so that alternating back-references don't force the
+  // same bases to be reloaded.
+  uintptr_t* ldwin_raw_genovecs;
+  uint32_t ldwin_vidxs[kPglLdWindowSize];
+  uint32_t ldwin_next_slot;
+  // ** end LD-window modes **
+
+  // ** PBWT modes with hardcall phase only (nullptr otherwise) **
+  // PBWT haplotype order (2 * raw_sample_ct entries), valid for pbwt_vidx;
+  // UINT32_MAX when it must be rebuilt from the last reset point (see
+  // kPglPbwtResetInterval).
+  uint32_t* pbwt_hap_order;
+  uint32_t* pbwt_hap_order_tmp;
+  uint32_t pbwt_vidx;
+  // Replay never touches the ldbase_* cache above; it has its own.
+  uint32_t pbwt_ldbase_vidx;
+  uintptr_t* pbwt_genovec;
+  uintptr_t* pbwt_ldbase_genovec;
+  uintptr_t* pbwt_phasepresent;
+  uintptr_t* pbwt_phaseinfo;
+  // PBWT-encoded tracks are translated to the legacy aux2 encoding (with the
+  // rest of the record appended) here.
+  unsigned char* pbwt_record_buf;
+  // ** end PBWT modes **
+
   // phase set loading (footer track in mode 0x11) unimplemented for now;
   // should be a sequence of (sample ID, [uint32_t phase set begin, set end),
   // [set begin, set end), ...).
@@ -408,7 +596,7 @@ typedef uint32_t PgenHeaderCtrl;
 
 void PreinitPgfi(PgenFileInfo* pgfip);
 
-// There are two modes of operation:
+// There are three modes of operation:
 // 1. fread block-load.  Block-load operations are single-threaded, while
 //    decompression/counting is multithreaded.  Appropriate for whole-genome
 //    queries, since even with a SSD, reading from multiple parts of a file
@@ -416,14 +604,21 @@ void PreinitPgfi(PgenFileInfo* pgfip);
 // 2. fread single-variant-at-a-time.  Simpler interface than block-load, and
 //    doesn't share its inability to handle multiple queries at a time, but
 //    less performant for CPU-heavy operations on the whole genome.
+// 3. mmap.  The entire .pgen is mapped read-only, and any number of
+//    PgenReaders (on any number of threads) decode directly from the mapped
+//    variant records, without per-reader load buffers or seeks.  Appropriate
+//    for e.g. a server backend addressing many small queries in parallel.
+//    Not available on Windows.
 // First mode corresponds to use_blockload == 1 in phase2, and second mode
-// corresponds to use_blockload == 0.
+// corresponds to use_blockload == 0.  Third mode also requires
+// use_blockload == 1 in phase2, followed by a PgfiInitMmap() call.
 //
-// There was originally a third mmap-based mode, which was removed on 14 Mar
-// 2022.  If you are interested in building e.g. a webserver backend that can
-// address multiple queries in parallel, refer to plink-ng commit c470317,
-// which captures the state of the codebase immediately preceding removal of
-// the mmap mode.
+// (The original mmap mode was removed on 14 Mar 2022, since it was
+// interleaved with header parsing and rarely outperformed fread for
+// whole-genome plink2 workloads.  The current version is layered on top of
+// the block-load interface instead: the header is still parsed with fread,
+// and the mapping is then simply treated as a single block that never needs
+// to be reloaded.)
 //
 // Other notes:
 // - If pgi_fname is nullptr but the .pgen has an external index file, the
@@ -460,8 +655,113 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
 // IMPORTANT: pgfi.block_offset must be manually copied to each reader for now.
 //   (todo: probably replace pgr.fi with a pointer.  when doing that, need to
 //   ensure multiple per-variant readers still works.)
+// In mmap mode, this just resets block_base/block_offset to point to the
+// mapping.
 PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip);
 
+// Hints to the OS that the given variant range will be loaded by an upcoming
+// PgfiMultiread() call, so that the disk read can overlap with computation on
+// the current block.  Returns immediately; no-op in mmap mode and on
+// platforms without posix_fadvise()/F_RDADVISE.
+// (This is a kernel hint rather than a background reader because pgenlib
+// never creates threads itself, and the callers' thread pools are all busy
+// with computation while the next block should be loading.)
+void PgfiMultireadAdvise(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, const PgenFileInfo* pgfip);
+
+ENUM_U31_DEF_START()
+  kPgfiMmapAdviceNormal,
+  // Best for many small scattered queries: disables kernel readahead.
+  kPgfiMmapAdviceRandom,
+  // Best for whole-file scans.
+  kPgfiMmapAdviceSequential,
+  // Also starts prefetching the entire file.
+  kPgfiMmapAdviceWillneed
+ENUM_U31_DEF_END(PgfiMmapAdvice);
+
+// Switches an initialized PgenFileInfo to mmap mode.  Must be called after
+// PgfiInitPhase2(..., use_blockload=1, ...) (and PgfiInitLoadExts(), if
+// relevant), and before any PgrInit() call; the readers must then be
+// initialized in mode 1 (fname == nullptr).  shared_ff is closed on success.
+//
+// The mapping is only read from, so the PgenReaders can be used concurrently
+// without any synchronization, as long as each thread has its own reader.
+// CleanupPgfi() unmaps the file, so it must be called after all readers are
+// done.
+PglErr PgfiInitMmap(PgfiMmapAdvice advice, PgenFileInfo* pgfip, char* errstr_buf);
+
+HEADER_INLINE uint32_t PgfiIsMmapped(const PgenFileInfo* pgfip) {
+  return (pgfip->mmap_base != nullptr);
+}
+
+// Enables pread mode: per-variant PgenReaders which issue positioned reads
+// against shared_ff's file descriptor, instead of each owning a FILE* and
+// seeking around in it.  Must be called after PgfiInitPhase2() (and
+// PgfiInitLoadExts(), if relevant), and before the PgrInit() calls it should
+// affect.  Those calls must then pass fname == nullptr and a pgr_alloc block
+// with room for the fread_buf, as in mode 2.
+//
+// Since the readers have no seek state, any number of them can be used
+// concurrently (one per thread) without opening more file descriptors.  The
+// PgenFileInfo keeps shared_ff, so PgfiMultiread() continues to work, and
+// CleanupPgfi() must not be called until all pread-mode readers are done.
+PglErr PgfiInitPread(PgenFileInfo* pgfip, char* errstr_buf);
+
+HEADER_INLINE uint32_t PgfiIsPread(const PgenFileInfo* pgfip) {
+  return (pgfip->pread_fd != -1);
+}
+
+// In the zstd modes, each vblock's variant records are stored as an
+// independent zstd frame; see the format description in pgenlib_misc.h.
+// Everything works as usual, except that mmap mode is unavailable and
+// vblock_idx_start must be zero:
+// - PgfiMultiread() decompresses exactly the requested byte range of the
+//   uncompressed record stream into block_base, so block buffers are sized
+//   the same way as for an uncompressed file.  When several frames are
+//   involved, they can be decompressed in parallel; see below.
+// - Per-variant readers keep a streaming decompressor open, so sequential
+//   access only decompresses each frame once, and a random access
+//   decompresses at most one vblock.
+// This lets PgfiMultiread() decompress up to cursor_ct frames at once, via
+// parallel_for(runner_arg, ...) calls made from the PgfiMultiread() caller's
+// thread.  Without it, or when pread() is unavailable, PgfiMultiread()
+// decompresses one frame at a time on the calling thread.  Must be called
+// after PgfiInitPhase2(); no-op for other modes.  Memory is freed by
+// CleanupPgfi(), and the runner must stay valid until then.
+PglErr PgfiInitZstdRunner(uint32_t cursor_ct, PglParallelForFunc parallel_for, void* runner_arg, PgenFileInfo* pgfip);
+
+// Decoded-variant cache.  Once enabled, plain hardcall loads (PgrGet(),
+// PgrGet1(), PgrGetInv1(), etc.; not the phase/dosage-returning variants)
+// first check the cache, and store their result there on a miss, so window-
+// based algorithms which repeatedly load overlapping variant sets (including
+// LD-compressed variants, which otherwise require their LD-base to be
+// re-decoded) mostly just perform a memcpy.
+//
+// The cache is shared by all readers created by later PgrInit() calls.  It's
+// split into up to kPglVcacheMaxStripeCt independently-locked stripes by
+// variant index, so it's safe (and normally uncontended) to use from multiple
+// threads, each with its own reader; LRU eviction is per-stripe.  Entries are
+// tagged with the exact sample subset they were decoded under, so callers
+// don't need to do anything special when sample_include changes, though only
+// kPglVcacheSubsetCt distinct proper subsets can be cached between
+// PgfiVcacheClear() calls.  PgfiVcacheClear() empties the cache, and is only
+// needed to prevent stale entries from occupying space.
+//
+// Caller is responsible for providing a
+// PgfiVcacheAllocByteCt(raw_variant_ct, raw_sample_ct, slot_ct)-byte,
+// cacheline-aligned memory block which outlives all the readers.
+// CleanupPgfi() releases the mutexes.
+uintptr_t PgfiVcacheAllocByteCt(uint32_t raw_variant_ct, uint32_t raw_sample_ct, uint32_t slot_ct);
+
+PglErr PgfiInitVcache(uint32_t slot_ct, unsigned char* vcache_alloc, PgenFileInfo* pgfip, char* errstr_buf);
+
+void PgfiVcacheClear(PgenFileInfo* pgfip);
+
+HEADER_INLINE uint32_t PgfiVcacheEnabled(const PgenFileInfo* pgfip) {
+  return (pgfip->vcache != nullptr);
+}
+
+void PgfiVcacheGetStats(PgenFileInfo* pgfip, uint64_t* hit_ct_ptr, uint64_t* miss_ct_ptr);
+
 
 void PreinitPgr(PgenReader* pgr_ptr);
 
@@ -471,10 +771,11 @@ void PreinitPgr(PgenReader* pgr_ptr);
 //
 // There's also a modal usage difference:
 //
-// * Mode 1 (block-fread): There is one PgenFileInfo per file which doesn't
-//   belong to any reader.  After it's initialized, multiple PgenReaders can be
-//   based off of it.  When the PgenFileInfo is destroyed, those PgenReaders
-//   are invalidated and should be destroyed if that hasn't already happened.
+// * Mode 1 (block-fread or mmap): There is one PgenFileInfo per file which
+//   doesn't belong to any reader.  After it's initialized, multiple
+//   PgenReaders can be based off of it.  When the PgenFileInfo is destroyed,
+//   those PgenReaders are invalidated and should be destroyed if that hasn't
+//   already happened.
 //
 //   fname parameter must be nullptr.
 //
@@ -489,6 +790,13 @@ void PreinitPgr(PgenReader* pgr_ptr);
 //   header.
 //
 //   fname parameter must be non-null.
+//
+// * Mode 2 with PgfiInitPread() (per-variant pread): Like mode 2, except that
+//   all readers share the PgenFileInfo's file descriptor, so the
+//   PgenFileInfo must outlive them (as in mode 1).  Selected when
+//   block_base == nullptr and PgfiIsPread().
+//
+//   fname parameter must be nullptr.
 
 // max_vrec_width ignored when using mode 1.
 PglErr PgrInit(const char* fname, uint32_t max_vrec_width, PgenFileInfo* pgfip, PgenReader* pgr_ptr, unsigned char* pgr_alloc);
@@ -552,6 +860,17 @@ void PgrPlink2ToPlink1InplaceUnsafe(uint32_t sample_ct, uintptr_t* genovec);
 // Ok if genovec only has space for sample_ct values.
 PglErr PgrGet(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict genovec);
 
+// Batch version of PgrGet(): loads variants [vidx_start, vidx_end) into a
+// variant-major matrix with the given row stride (in words).  Results are
+// identical to calling PgrGet() on each variant in turn.  LD-compressed
+// variants whose base is in the same range are patched from the base's
+// already-subsetted row, instead of going through the reader's LD-base cache
+// (which, in LD-window modes, would otherwise re-subset the base from a raw
+// genovec on every base change).
+// In mode 1, all variants in the range must be in the currently loaded
+// block.  Falls back on the per-variant path when a vcache is attached.
+PglErr PgrGetBlock(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx_start, uint32_t vidx_end, PgenReader* pgr_ptr, uintptr_t genovec_word_stride, uintptr_t* __restrict genovecs);
+
 // Loads the specified variant as a difflist if that's more efficient, setting
 // difflist_common_geno to the common genotype value in that case.  Otherwise,
 // genovec is populated and difflist_common_geno is set to UINT32_MAX.
@@ -702,8 +1021,21 @@ PglErr PgrGetMDp(const uintptr_t* __restrict sample_include, PgrSampleSubsetInde
 // to maximize parallelism
 PglErr PgrGetRaw(uint32_t vidx, PgenGlobalFlags read_gflags, PgenReader* pgr_ptr, uintptr_t** loadbuf_iter_ptr, unsigned char* loaded_vrtype_ptr);
 
+// Performs all validation which isn't done by PgfiInitPhase{1,2}() and
+// PgrInit().  Requires a per-variant-fread PgenReader.
 PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf);
 
+// The two halves of PgrValidate().  PgrValidateIndex() only checks header and
+// index consistency, and requires a per-variant-fread PgenReader.
+// PgrValidateRecords() checks the variant records in
+// [variant_idx_start, variant_idx_end); variant_idx_start must be a multiple
+// of kPglVblockSize, and PgrValidateIndex() must have already succeeded.
+// Different vblock ranges can be validated concurrently with separate
+// PgenReaders.
+PglErr PgrValidateIndex(PgenReader* pgr_ptr, char* errstr_buf);
+
+PglErr PgrValidateRecords(uint32_t variant_idx_start, uint32_t variant_idx_end, PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf);
+
 // missingness bit is set iff hardcall is not present (even if dosage info *is*
 // present)
 PglErr PgrGetMissingness(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict missingness, uintptr_t* __restrict genovec_buf);
@@ -714,12 +1046,91 @@ PglErr PgrGetMissingness(const uintptr_t* __restrict sample_include, PgrSampleSu
 PglErr PgrGetMissingnessD(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict missingness_hc, uintptr_t* __restrict missingness_dosage, uintptr_t* __restrict hets, uintptr_t* __restrict genovec_buf);
 
 
+// Sample-major companion file (.pgen.smaj).
+//
+// Since a .pgen is variant-major, extracting all hardcalls for a handful of
+// samples requires every variant record to be decoded.  The optional
+// .pgen.smaj sidecar (pgen_compress -s builds one) stores the hardcalls a
+// second time, transposed, so that one sample's calls for a range of variants
+// can be read with one small fread per variant block.  Format:
+//   3-byte magic number 0x6c 0x1b 0x40
+//   1 reserved byte, currently must be zero
+//   uint32 raw_variant_ct, uint32 raw_sample_ct, uint32 vblock_size
+//     (little-endian).  vblock_size must be a positive multiple of
+//     kPglSmajVblockAlign.
+//   kPglSmajPgenKeyBlen-byte key of the file the sidecar was generated from;
+//     see SmajGetPgenKey().
+//   (vblock_ct + 1) uint64 block index entries, where vblock_ct =
+//     DivUp(raw_variant_ct, vblock_size).  Entry i is the file offset of
+//     variant block i's tile, and the last entry is the file size.
+//   Tiles.  Each consists of raw_sample_ct rows of NypCtToByteCt(block
+//     variant count) bytes; row j contains sample j's hardcalls for the
+//     block's variants, encoded as PgrGet() returns them (so multiallelic
+//     hardcalls are collapsed), with trailing bits zeroed.
+//
+// Dosages and phase information are not included.  The sidecar must be
+// regenerated whenever the .pgen changes; the key lets SmajInitPhase1() catch
+// most failures to do so.
+CONSTI32(kPglSmajVblockAlign, 512);
+
+CONSTI32(kPglSmajPgenKeyBlen, 16);
+CONSTI32(kPglSmajHeaderBlen, 16 + kPglSmajPgenKeyBlen);
+
+// Number of leading .pgen bytes hashed by SmajGetPgenKey().
+CONSTI32(kPglSmajPgenKeyPrefixSize, 65536);
+
+typedef struct PgenSmajReaderStruct {
+  NONCOPYABLE(PgenSmajReaderStruct);
+  FILE* ff;
+  uint32_t raw_variant_ct;
+  uint32_t raw_sample_ct;
+  uint32_t vblock_size;
+  uint32_t vblock_ct;
+
+  // vblock_ct + 1 entries
+  uint64_t* vblock_fpos;
+
+  // room for one row, plus a word of slack
+  uintptr_t* readbuf;
+} PgenSmajReader;
+
+void PreinitSmaj(PgenSmajReader* psrp);
+
+// Computes the key that ties a .pgen.smaj to the file it was generated from:
+// the file's byte count (uint64, little-endian), followed by a 64-bit FNV-1a
+// hash of its first kPglSmajPgenKeyPrefixSize bytes (or the whole file, if
+// it's smaller).  The prefix covers the .pgen header and the start of the
+// variant record index, so this is cheap to check, but it isn't a checksum:
+// an edit which doesn't change the file size or the prefix goes unnoticed.
+PglErr SmajGetPgenKey(const char* pgen_fname, unsigned char* key, char* errstr_buf);
+
+// Opens the file and validates its header and size.  raw_variant_ct and
+// raw_sample_ct should be UINT32_MAX if not previously known (otherwise they
+// must match the header).  If pgen_fname is non-null, that file's
+// SmajGetPgenKey() key must match the stored one.  Caller must then provide a
+// smaj_alloc_cacheline_ct * 64-byte, 64-byte-aligned block to
+// SmajInitPhase2(), which loads and validates the block index.
+PglErr SmajInitPhase1(const char* fname, const char* pgen_fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, PgenSmajReader* psrp, uintptr_t* smaj_alloc_cacheline_ct_ptr, char* errstr_buf);
+
+PglErr SmajInitPhase2(PgenSmajReader* psrp, unsigned char* smaj_alloc, char* errstr_buf);
+
+// Loads sample_uidx's hardcalls for variants [vidx_start, vidx_end) into
+// genovec, which must have room for NypCtToWordCt(vidx_end - vidx_start)
+// words.  Trailing bits are zeroed.  Results are identical to transposing the
+// corresponding PgrGet() calls.  An empty range is a no-op.
+// When vidx_start is a multiple of kBitsPerWordD2, the tile rows are read
+// directly into genovec.
+PglErr SmajGet(uint32_t sample_uidx, uint32_t vidx_start, uint32_t vidx_end, PgenSmajReader* psrp, uintptr_t* __restrict genovec);
+
+
 // error-return iff reterr was success and was changed to kPglRetReadFail (i.e.
 // an error message should be printed).
 BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp);
 
 BoolErr CleanupPgr(PgenReader* pgr_ptr, PglErr* reterrp);
 
+BoolErr CleanupSmaj(PgenSmajReader* psrp, PglErr* reterrp);
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -80,8 +80,11 @@ PglErr PwcInitPhase1(const char* __restrict fname, uintptr_t* explicit_nonref_fl
   pwcp->footer_exts = footer_exts;
   pwcp->variant_ct_limit = variant_ct_limit;
   pwcp->sample_ct = sample_ct;
+  const uint32_t ld_window = (phase_dosage_gflags / kfPgenGlobalLdWindow) & 1;
+  phase_dosage_gflags &= ~kfPgenGlobalLdWindow;
   pwcp->phase_dosage_gflags = phase_dosage_gflags;
   pwcp->nonref_flags_storage = nonref_flags_storage;
+  pwcp->ld_window = ld_window;
   pwcp->vrec_len_byte_ct = vrec_len_byte_ct;
 #ifndef NDEBUG
   pwcp->vblock_fpos = nullptr;
@@ -95,6 +98,15 @@ PglErr PwcInitPhase1(const char* __restrict fname, uintptr_t* explicit_nonref_fl
   pwcp->ldbase_raregeno = nullptr;
   pwcp->ldbase_difflist_sample_ids = nullptr;
 #endif
+  pwcp->pbwt_hap_order = nullptr;
+  pwcp->pbwt_hap_order_tmp = nullptr;
+  pwcp->pbwt_runbuf = nullptr;
+  pwcp->pbwt_segment_idx = UINT32_MAX;
+  pwcp->ldbase_backref_buf = nullptr;
+  pwcp->ldwin_genovecs = nullptr;
+  pwcp->ldwin_genocounts = nullptr;
+  pwcp->ldwin_ct = 0;
+  pwcp->ldwin_head = 0;
   pwcp->vidx = 0;
 
   *pgen_outfile_ptr = nullptr;
@@ -102,6 +114,22 @@ PglErr PwcInitPhase1(const char* __restrict fname, uintptr_t* explicit_nonref_fl
   *fname_buf_ptr = nullptr;
   const int32_t ext_present = (header_exts != nullptr) || (footer_exts != nullptr);
   const int32_t third_byte = ((write_mode == kPgenWriteSeparateIndex)? 0x20 : 0x10) + ext_present;
+  // PBWT-encoded hardcall phase only has single-file mode bytes (0x84/0x85).
+  int32_t pbwt_mode_incr = 0;
+  if (phase_dosage_gflags & kfPgenGlobalPbwtHphase) {
+    if (unlikely((write_mode == kPgenWriteSeparateIndex) || (!(phase_dosage_gflags & kfPgenGlobalHardcallPhasePresent)))) {
+      return kPglRetImproperFunctionCall;
+    }
+    pbwt_mode_incr = 4;
+  }
+  // Likewise for the LD window (0x88/0x89).
+  int32_t ldwin_mode_incr = 0;
+  if (ld_window) {
+    if (unlikely(write_mode == kPgenWriteSeparateIndex)) {
+      return kPglRetImproperFunctionCall;
+    }
+    ldwin_mode_incr = 8;
+  }
   if (write_mode != kPgenWriteBackwardSeek) {
     const uint32_t fname_slen = strlen(fname);
     if (fname_slen > kPglFnamesize - 5) {
@@ -149,7 +177,10 @@ PglErr PwcInitPhase1(const char* __restrict fname, uintptr_t* explicit_nonref_fl
     *pgi_or_final_pgen_outfile_ptr = header_ff;
   }
   fwrite_unlocked("l\x1b", 2, 1, header_ff);
-  if (unlikely(putc_checked(third_byte, header_ff))) {
+  const int32_t dev_mode_incr = pbwt_mode_incr + ldwin_mode_incr;
+  // 0x10 -> 0x8c etc.; see the storage mode list in pgenlib_misc.h.
+  const int32_t header_byte = dev_mode_incr? (third_byte + 0x70 + dev_mode_incr) : third_byte;
+  if (unlikely(putc_checked(header_byte, header_ff))) {
     return kPglRetWriteFail;
   }
   if (write_mode != kPgenWriteBackwardSeek) {
@@ -157,6 +188,10 @@ PglErr PwcInitPhase1(const char* __restrict fname, uintptr_t* explicit_nonref_fl
   }
 
   uint64_t header_bytes_left = PglHeaderBaseEndOffset(variant_ct_limit, vrec_len_byte_ct, phase_dosage_gflags != kfPgenGlobal0, nonref_flags_storage == 3) - 3;
+  if (ld_window) {
+    // LD base back-references
+    header_bytes_left += variant_ct_limit;
+  }
   if (ext_present) {
     // Additional header contents:
     // 1. Flag varint describing which header extensions are present.
@@ -224,6 +259,26 @@ PglErr PwcInitPhase1(const char* __restrict fname, uintptr_t* explicit_nonref_fl
   return kPglRetSuccess;
 }
 
+static inline uint32_t PbwtHphaseWriteActive(PgenGlobalFlags phase_dosage_gflags) {
+  return (phase_dosage_gflags & (kfPgenGlobalPbwtHphase | kfPgenGlobalHardcallPhasePresent)) == (kfPgenGlobalPbwtHphase | kfPgenGlobalHardcallPhasePresent);
+}
+
+static uintptr_t CountPbwtWriteCachelinesRequired(uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags) {
+  if (!PbwtHphaseWriteActive(phase_dosage_gflags)) {
+    return 0;
+  }
+  // pbwt_hap_order, pbwt_hap_order_tmp, pbwt_runbuf
+  return 2 * Int32CtToCachelineCt(2 * S_CAST(uintptr_t, sample_ct)) + DivUp(DivUp(sample_ct, CHAR_BIT) + 8, kCacheline);
+}
+
+static uintptr_t CountLdWindowWriteCachelinesRequired(uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags) {
+  if (!(phase_dosage_gflags & kfPgenGlobalLdWindow)) {
+    return 0;
+  }
+  // ldwin_genovecs (including scratch slot), ldwin_genocounts
+  return (kPglLdWindowSize + 1) * NypCtToCachelineCt(sample_ct) + Int32CtToCachelineCt(4 * kPglLdWindowSize);
+}
+
 uintptr_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct_limit, uint32_t sample_ct, PgenGlobalFlags phase_dosage_gflags, uint32_t max_vrec_len) {
   // vblock_fpos
   const uint32_t vblock_ct_limit = DivUp(variant_ct_limit, kPglVblockSize);
@@ -233,8 +288,13 @@ uintptr_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct_limit, uint32_t s
   const uintptr_t vrec_len_byte_ct = BytesToRepresentNzU32(max_vrec_len);
   cachelines_required += DivUp(variant_ct_limit * vrec_len_byte_ct, kCacheline);
 
+  // ldbase_backref_buf
+  if (phase_dosage_gflags & kfPgenGlobalLdWindow) {
+    cachelines_required += DivUp(variant_ct_limit, kCacheline);
+  }
+
   // vrtype_buf
-  if (phase_dosage_gflags) {
+  if (phase_dosage_gflags & (~kfPgenGlobalLdWindow)) {
     cachelines_required += DivUp(variant_ct_limit, kCacheline);
   } else {
     cachelines_required += DivUp(variant_ct_limit, kCacheline * 2);
@@ -250,6 +310,9 @@ uintptr_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct_limit, uint32_t s
   // ldbase_difflist_sample_ids
   cachelines_required += 1 + (max_difflist_len / kInt32PerCacheline);
 
+  cachelines_required += CountPbwtWriteCachelinesRequired(sample_ct, phase_dosage_gflags);
+  cachelines_required += CountLdWindowWriteCachelinesRequired(sample_ct, phase_dosage_gflags);
+
   // fwrite_buf
   // + (5 + sizeof(AlleleCode)) * kPglDifflistGroupSize to avoid buffer
   // overflow in middle of difflist writing
@@ -300,8 +363,8 @@ PglErr SpgwInitPhase1Ex(const char* __restrict fname, const uintptr_t* __restric
     // out when trying to write a larger compressed record.
   }
   if (phase_dosage_gflags & kfPgenGlobalHardcallPhasePresent) {
-    // phasepresent, phaseinfo
-    max_vrec_len += 2 * DivUp(sample_ct, CHAR_BIT);
+    // phasepresent, phaseinfo, PBWT encoding byte
+    max_vrec_len += 2 * DivUp(sample_ct, CHAR_BIT) + ((phase_dosage_gflags / kfPgenGlobalPbwtHphase) & 1);
   }
   if (phase_dosage_gflags & kfPgenGlobalDosagePresent) {
     const uint32_t dphase_gflag = (phase_dosage_gflags / kfPgenGlobalDosagePhasePresent) & 1;
@@ -343,8 +406,13 @@ void MpgwInitPhase1(const uintptr_t* __restrict allele_idx_offsets, uint32_t var
   const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
   uint32_t alloc_base_cacheline_ct = Int64CtToCachelineCt(vblock_ct);
 
+  // ldbase_backref_buf
+  if (phase_dosage_gflags & kfPgenGlobalLdWindow) {
+    alloc_base_cacheline_ct += DivUp(variant_ct, kCacheline);
+  }
+
   // vrtype_buf
-  if (phase_dosage_gflags) {
+  if (phase_dosage_gflags & (~kfPgenGlobalLdWindow)) {
     alloc_base_cacheline_ct += DivUp(variant_ct, kCacheline);
   } else {
     alloc_base_cacheline_ct += DivUp(variant_ct, kCacheline * 2);
@@ -365,9 +433,12 @@ void MpgwInitPhase1(const uintptr_t* __restrict allele_idx_offsets, uint32_t var
   // ldbase_difflist_sample_ids
   alloc_per_thread_cacheline_ct += 1 + (max_difflist_len / kInt32PerCacheline);
 
+  alloc_per_thread_cacheline_ct += CountPbwtWriteCachelinesRequired(sample_ct, phase_dosage_gflags);
+  alloc_per_thread_cacheline_ct += CountLdWindowWriteCachelinesRequired(sample_ct, phase_dosage_gflags);
+
   uint64_t max_vrec_len = NypCtToByteCt(sample_ct);
   if (phase_dosage_gflags & kfPgenGlobalHardcallPhasePresent) {
-    max_vrec_len += 2 * DivUp(sample_ct, CHAR_BIT);
+    max_vrec_len += 2 * DivUp(sample_ct, CHAR_BIT) + ((phase_dosage_gflags / kfPgenGlobalPbwtHphase) & 1);
   }
   const uint32_t dosage_gflag = (phase_dosage_gflags / kfPgenGlobalDosagePresent) & 1;
   const uint32_t dosage_phase_gflag = (phase_dosage_gflags / kfPgenGlobalDosagePhasePresent) & 1;
@@ -524,6 +595,13 @@ void PwcInitPhase2(uintptr_t fwrite_cacheline_ct, uint32_t thread_ct, PgenWriter
   // the PwcAppend... functions assume these bytes are zeroed out
   memset(pwcs[0]->vrtype_buf, 0, vrtype_buf_byte_ct);
 
+  const uint32_t ld_window = pwcs[0]->ld_window;
+  if (ld_window) {
+    // only LD-compressed variants set their entries
+    pwcs[0]->ldbase_backref_buf = S_CAST(unsigned char*, arena_alloc_raw_rd(variant_ct_limit, &alloc_iter));
+    memset(pwcs[0]->ldbase_backref_buf, 0, variant_ct_limit);
+  }
+
   const uint32_t sample_ct = pwcs[0]->sample_ct;
   const uint32_t genovec_byte_alloc = NypCtToCachelineCt(sample_ct) * kCacheline;
   const uint32_t max_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
@@ -532,6 +610,7 @@ void PwcInitPhase2(uintptr_t fwrite_cacheline_ct, uint32_t thread_ct, PgenWriter
       pwcs[tidx]->vblock_fpos = pwcs[0]->vblock_fpos;
       pwcs[tidx]->vrec_len_buf = pwcs[0]->vrec_len_buf;
       pwcs[tidx]->vrtype_buf = pwcs[0]->vrtype_buf;
+      pwcs[tidx]->ldbase_backref_buf = pwcs[0]->ldbase_backref_buf;
     }
     pwcs[tidx]->genovec_hets_buf = S_CAST(uintptr_t*, arena_alloc_raw(genovec_byte_alloc, &alloc_iter));
     pwcs[tidx]->genovec_invert_buf = S_CAST(uintptr_t*, arena_alloc_raw(genovec_byte_alloc, &alloc_iter));
@@ -539,6 +618,15 @@ void PwcInitPhase2(uintptr_t fwrite_cacheline_ct, uint32_t thread_ct, PgenWriter
 
     pwcs[tidx]->ldbase_raregeno = S_CAST(uintptr_t*, arena_alloc_raw(NypCtToCachelineCt(max_difflist_len) * kCacheline, &alloc_iter));
     pwcs[tidx]->ldbase_difflist_sample_ids = S_CAST(uint32_t*, arena_alloc_raw_rd((max_difflist_len + 1) * sizeof(int32_t), &alloc_iter));
+    if (PbwtHphaseWriteActive(phase_dosage_gflags)) {
+      pwcs[tidx]->pbwt_hap_order = S_CAST(uint32_t*, arena_alloc_raw_rd(2 * S_CAST(uintptr_t, sample_ct) * sizeof(int32_t), &alloc_iter));
+      pwcs[tidx]->pbwt_hap_order_tmp = S_CAST(uint32_t*, arena_alloc_raw_rd(2 * S_CAST(uintptr_t, sample_ct) * sizeof(int32_t), &alloc_iter));
+      pwcs[tidx]->pbwt_runbuf = S_CAST(unsigned char*, arena_alloc_raw_rd(DivUp(sample_ct, CHAR_BIT) + 8, &alloc_iter));
+    }
+    if (ld_window) {
+      pwcs[tidx]->ldwin_genovecs = S_CAST(uintptr_t*, arena_alloc_raw((kPglLdWindowSize + 1) * S_CAST(uintptr_t, genovec_byte_alloc), &alloc_iter));
+      pwcs[tidx]->ldwin_genocounts = S_CAST(STD_ARRAY_PTR_TYPE(uint32_t, 4), arena_alloc_raw_rd(kPglLdWindowSize * 4 * sizeof(int32_t), &alloc_iter));
+    }
 
     pwcs[tidx]->fwrite_buf = alloc_iter;
     pwcs[tidx]->fwrite_bufp = alloc_iter;
@@ -906,6 +994,76 @@ uint32_t SaveOnebit(const uintptr_t* __restrict genovec, uint32_t common2_code,
   }
 }
 
+// Returns 1 unless the genotype-count differences between the current variant
+// and a candidate LD base already imply at least ld_diff_threshold LD (and
+// inverted-LD) differences.
+static inline uint32_t LdCompressionPossible(STD_ARRAY_KREF(uint32_t, 4) genocounts, STD_ARRAY_KREF(uint32_t, 4) ldbase_genocounts, uint32_t ld_diff_threshold) {
+  // number of changes between current genovec and LD reference is bounded
+  // below by sum(genocounts[x] - ldbase_genocounts[x]) / 2
+  const int32_t count02_limit = 2 * ld_diff_threshold - abs_i32(genocounts[1] - ldbase_genocounts[1]) + abs_i32(genocounts[3] - ldbase_genocounts[3]);
+  return (S_CAST(int32_t, abs_i32(genocounts[0] - ldbase_genocounts[0]) + abs_i32(genocounts[2] - ldbase_genocounts[2])) < count02_limit) || (S_CAST(int32_t, abs_i32(genocounts[0] - ldbase_genocounts[2]) + abs_i32(genocounts[2] - ldbase_genocounts[0])) < count02_limit);
+}
+
+// LD-window mode: appends genovec to the ring of candidate LD bases.
+static void LdWindowPush(const uintptr_t* __restrict genovec, STD_ARRAY_KREF(uint32_t, 4) genocounts, PgenWriterCommon* pwcp) {
+  const uint32_t sample_ct = pwcp->sample_ct;
+  uint32_t slot_idx = pwcp->ldwin_head + 1;
+  if (slot_idx == kPglLdWindowSize) {
+    slot_idx = 0;
+  }
+  pwcp->ldwin_head = slot_idx;
+  if (pwcp->ldwin_ct != kPglLdWindowSize) {
+    pwcp->ldwin_ct += 1;
+  }
+  uintptr_t* slot_genovec = &(pwcp->ldwin_genovecs[slot_idx * NypCtToCachelineCt(sample_ct) * kWordsPerCacheline]);
+  memcpy(slot_genovec, genovec, NypCtToWordCt(sample_ct) * sizeof(intptr_t));
+  STD_ARRAY_COPY(genocounts, 4, pwcp->ldwin_genocounts[slot_idx]);
+}
+
+// LD-window mode: diffs genovec against each candidate LD base (most recent
+// first), and LD-compresses it against the one requiring the fewest
+// differences.  Returns vrec_len, or UINT32_MAX if no candidate gets below
+// ld_diff_threshold.
+static uint32_t SaveLdWindowDifflist(const uintptr_t* __restrict genovec, STD_ARRAY_KREF(uint32_t, 4) genocounts, uint32_t vidx, uint32_t ld_diff_threshold, PgenWriterCommon* pwcp, unsigned char* vrtype_ptr) {
+  const uint32_t sample_ct = pwcp->sample_ct;
+  const uintptr_t slot_word_ct = NypCtToCachelineCt(sample_ct) * kWordsPerCacheline;
+  const uint32_t ldwin_ct = pwcp->ldwin_ct;
+  uint32_t best_diff_ct = ld_diff_threshold;
+  uint32_t best_backref = UINT32_MAX;
+  uint32_t best_slot_idx = 0;
+  uint32_t best_invert = 0;
+  uint32_t slot_idx = pwcp->ldwin_head;
+  for (uint32_t backref = 0; backref != ldwin_ct; ++backref) {
+    // tighten the prefilter as better candidates are found
+    if (LdCompressionPossible(genocounts, pwcp->ldwin_genocounts[slot_idx], best_diff_ct)) {
+      uint32_t ld_diff_ct;
+      uint32_t ld_inv_diff_ct;
+      CountLdAndInvertedLdDiffs(&(pwcp->ldwin_genovecs[slot_idx * slot_word_ct]), genovec, sample_ct, &ld_diff_ct, &ld_inv_diff_ct);
+      const uint32_t invert = (ld_inv_diff_ct < ld_diff_ct);
+      if (invert) {
+        ld_diff_ct = ld_inv_diff_ct;
+      }
+      if (ld_diff_ct < best_diff_ct) {
+        best_diff_ct = ld_diff_ct;
+        best_backref = backref;
+        best_slot_idx = slot_idx;
+        best_invert = invert;
+      }
+    }
+    slot_idx = (slot_idx? slot_idx : kPglLdWindowSize) - 1;
+  }
+  if (best_backref == UINT32_MAX) {
+    return UINT32_MAX;
+  }
+  pwcp->ldbase_backref_buf[vidx] = best_backref;
+  *vrtype_ptr = 2 + best_invert;
+  if (best_invert) {
+    GenovecInvertCopyUnsafe(genovec, sample_ct, pwcp->genovec_invert_buf);
+    genovec = pwcp->genovec_invert_buf;
+  }
+  return SaveLdDifflist(genovec, &(pwcp->ldwin_genovecs[best_slot_idx * slot_word_ct]), 0, best_diff_ct, pwcp);
+}
+
 // returns vrec_len
 uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint32_t vidx, PgenWriterCommon* pwcp, uint32_t* het_ct_ptr, uint32_t* altxy_ct_ptr, unsigned char* vrtype_ptr) {
   const uint32_t sample_ct = pwcp->sample_ct;
@@ -956,14 +1114,17 @@ uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint
     // er, need to use a relative offset in the multithreaded case, absolute
     // position isn't known
     pwcp->vblock_fpos[vidx / kPglVblockSize] = pwcp->vblock_fpos_offset + S_CAST(uintptr_t, pwcp->fwrite_bufp - pwcp->fwrite_buf);
+    pwcp->ldwin_ct = 0;
   } else if (difflist_len > sample_ctd64) {
     // do not use LD compression if there are at least this many differences.
     // tune this threshold in the future.
     const uint32_t ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
-    // number of changes between current genovec and LD reference is bounded
-    // below by sum(genocounts[x] - ldbase_genocounts[x]) / 2
-    const int32_t count02_limit = 2 * ld_diff_threshold - abs_i32(genocounts[1] - ldbase_genocounts[1]) + abs_i32(genocounts[3] - ldbase_genocounts[3]);
-    if ((S_CAST(int32_t, abs_i32(genocounts[0] - ldbase_genocounts[0]) + abs_i32(genocounts[2] - ldbase_genocounts[2])) < count02_limit) || (S_CAST(int32_t, abs_i32(genocounts[0] - ldbase_genocounts[2]) + abs_i32(genocounts[2] - ldbase_genocounts[0])) < count02_limit)) {
+    if (pwcp->ldwin_genovecs) {
+      const uint32_t vrec_len = SaveLdWindowDifflist(genovec, genocounts, vidx, ld_diff_threshold, pwcp, vrtype_ptr);
+      if (vrec_len != UINT32_MAX) {
+        return vrec_len;
+      }
+    } else if (LdCompressionPossible(genocounts, ldbase_genocounts, ld_diff_threshold)) {
       uint32_t ld_diff_ct;
       uint32_t ld_inv_diff_ct;
       // okay, perform a brute-force diff
@@ -989,6 +1150,9 @@ uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint
   const uint32_t genovec_word_ct = NypCtToWordCt(sample_ct);
   STD_ARRAY_COPY(genocounts, 4, ldbase_genocounts);
   pwcp->ldbase_common_geno = UINT32_MAX;
+  if (pwcp->ldwin_genovecs) {
+    LdWindowPush(genovec, genocounts, pwcp);
+  }
   if ((!difflist_viable) && (rare_2_geno_ct_sum < sample_ct / (2 * kPglMaxDifflistLenDivisor))) {
     *vrtype_ptr = 1;
     uint32_t larger_common_geno = second_most_common_geno;
@@ -1187,6 +1351,14 @@ uint32_t PwcAppendBiallelicDifflistLimitedMain(const uintptr_t* __restrict rareg
   assert(difflist_common_geno < 4);
   assert((!(difflist_len % kBitsPerWordD2)) || (!(raregeno[difflist_len / kBitsPerWordD2] >> (2 * (difflist_len % kBitsPerWordD2)))));
   assert(difflist_sample_ids[difflist_len] == sample_ct);
+  if (pwcp->ldwin_genovecs) {
+    // LD-window search is only implemented for full genovecs; expand to the
+    // scratch slot.
+    uintptr_t* genobuf = &(pwcp->ldwin_genovecs[kPglLdWindowSize * NypCtToCachelineCt(sample_ct) * kWordsPerCacheline]);
+    PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, sample_ct, difflist_len, genobuf);
+    ZeroTrailingNyps(sample_ct, genobuf);
+    return PwcAppendBiallelicGenovecMain(genobuf, vidx, pwcp, nullptr, nullptr, vrtype_ptr);
+  }
   STD_ARRAY_DECL(uint32_t, 4, genocounts);
   GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
   assert(!genocounts[difflist_common_geno]);
@@ -1216,10 +1388,7 @@ uint32_t PwcAppendBiallelicDifflistLimitedMain(const uintptr_t* __restrict rareg
     pwcp->vblock_fpos[vidx / kPglVblockSize] = pwcp->vblock_fpos_offset + S_CAST(uintptr_t, pwcp->fwrite_bufp - pwcp->fwrite_buf);
   } else if (difflist_len > sample_ctd64) {
     const uint32_t ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
-    // number of changes between current genovec and LD reference is bounded
-    // below by sum(genocounts[x] - ldbase_genocounts[x]) / 2
-    const int32_t count02_limit = 2 * ld_diff_threshold - abs_i32(genocounts[1] - ldbase_genocounts[1]) + abs_i32(genocounts[3] - ldbase_genocounts[3]);
-    if ((S_CAST(int32_t, abs_i32(genocounts[0] - ldbase_genocounts[0]) + abs_i32(genocounts[2] - ldbase_genocounts[2])) < count02_limit) || (S_CAST(int32_t, abs_i32(genocounts[0] - ldbase_genocounts[2]) + abs_i32(genocounts[2] - ldbase_genocounts[0])) < count02_limit)) {
+    if (LdCompressionPossible(genocounts, ldbase_genocounts, ld_diff_threshold)) {
       uint32_t ld_diff_ct;
       uint32_t ld_inv_diff_ct;
       if (pwcp->ldbase_common_geno < 4) {
@@ -2106,6 +2275,47 @@ BoolErr AppendHphase(const uintptr_t* __restrict genoarr_hets, const uintptr_t*
   return 0;
 }
 
+// Mode 0x84/0x85: biallelic hardcall-phase tracks are prefixed by an encoding
+// byte.  Writes that byte (legacy for now), and resets the haplotype order at
+// every multiple of kPglPbwtResetInterval.
+static unsigned char* PbwtHphaseStart(uint32_t vidx, PgenWriterCommon* pwcp, uint32_t* vrec_len_ptr) {
+  const uint32_t segment_idx = vidx / kPglPbwtResetInterval;
+  if (segment_idx != pwcp->pbwt_segment_idx) {
+    PbwtInitHapOrder(pwcp->sample_ct, pwcp->pbwt_hap_order);
+    pwcp->pbwt_segment_idx = segment_idx;
+  }
+  if (unlikely(CheckedVrecLenIncr(1, vrec_len_ptr))) {
+    return nullptr;
+  }
+  unsigned char* aux2_start = pwcp->fwrite_bufp;
+  *aux2_start = 0;
+  pwcp->fwrite_bufp = &(aux2_start[1]);
+  return aux2_start;
+}
+
+// Replaces the just-written legacy track with the PBWT encoding when the
+// latter is strictly smaller, then advances the haplotype order.
+static void PbwtHphaseFinish(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uintptr_t* __restrict phaseinfo, uint32_t het_ct, uint32_t phasepresent_ct, unsigned char* aux2_start, PgenWriterCommon* pwcp, uint32_t* vrec_len_ptr) {
+  const uint32_t sample_ct = pwcp->sample_ct;
+  const uint32_t legacy_byte_ct = pwcp->fwrite_bufp - (&(aux2_start[1]));
+  const uint32_t first_byte_ct = (het_ct == phasepresent_ct)? 1 : (1 + (het_ct / CHAR_BIT));
+  if (legacy_byte_ct > first_byte_ct + 1) {
+    unsigned char* runbuf = pwcp->pbwt_runbuf;
+    unsigned char* runbuf_end = PbwtEncodePhaseinfo(genovec, phasepresent, phaseinfo, pwcp->pbwt_hap_order, sample_ct, runbuf, &(runbuf[legacy_byte_ct - first_byte_ct - 1]));
+    if (runbuf_end) {
+      const uint32_t run_byte_ct = runbuf_end - runbuf;
+      aux2_start[0] = 1;
+      if (het_ct == phasepresent_ct) {
+        aux2_start[1] = 0;
+      }
+      memcpy(&(aux2_start[1 + first_byte_ct]), runbuf, run_byte_ct);
+      *vrec_len_ptr -= legacy_byte_ct - first_byte_ct - run_byte_ct;
+      pwcp->fwrite_bufp = &(aux2_start[1 + first_byte_ct + run_byte_ct]);
+    }
+  }
+  PbwtUpdateHapOrder(genovec, (het_ct == phasepresent_ct)? nullptr : phasepresent, phaseinfo, sample_ct, pwcp->pbwt_hap_order, pwcp->pbwt_hap_order_tmp);
+}
+
 void PwcAppendBiallelicGenovecHphase(const uintptr_t* __restrict genovec, const uintptr_t* __restrict phasepresent, const uintptr_t* __restrict phaseinfo, PgenWriterCommon* pwcp) {
   // assumes phase_dosage_gflags is nonzero
   const uint32_t vidx = pwcp->vidx;
@@ -2119,7 +2329,14 @@ void PwcAppendBiallelicGenovecHphase(const uintptr_t* __restrict genovec, const
   unsigned char* vrec_len_dest = &(pwcp->vrec_len_buf[vidx * vrec_len_byte_ct]);
   const uint32_t phasepresent_ct = phasepresent? PopcountWords(phasepresent, sample_ctl) : het_ct;
   if (phasepresent_ct) {
+    unsigned char* pbwt_aux2_start = nullptr;
+    if (pwcp->pbwt_hap_order) {
+      pbwt_aux2_start = PbwtHphaseStart(vidx, pwcp, &vrec_len);
+    }
     AppendHphase(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len);
+    if (pbwt_aux2_start) {
+      PbwtHphaseFinish(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pbwt_aux2_start, pwcp, &vrec_len);
+    }
   }
   SubU32Store(vrec_len, vrec_len_byte_ct, vrec_len_dest);
 }
@@ -2222,7 +2439,14 @@ BoolErr PwcAppendBiallelicGenovecHphaseDosage16(const uintptr_t* __restrict geno
   unsigned char* vrec_len_dest = &(pwcp->vrec_len_buf[vidx * vrec_len_byte_ct]);
   const uint32_t phasepresent_ct = phasepresent? PopcountWords(phasepresent, sample_ctl) : het_ct;
   if (phasepresent_ct) {
+    unsigned char* pbwt_aux2_start = nullptr;
+    if (pwcp->pbwt_hap_order) {
+      pbwt_aux2_start = PbwtHphaseStart(vidx, pwcp, &vrec_len);
+    }
     AppendHphase(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len);
+    if (pbwt_aux2_start) {
+      PbwtHphaseFinish(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pbwt_aux2_start, pwcp, &vrec_len);
+    }
   }
   if (dosage_ct) {
     if (unlikely(AppendDosage16(dosage_present, dosage_main, dosage_ct, 0, pwcp, vrtype_dest, &vrec_len))) {
@@ -2268,7 +2492,14 @@ BoolErr PwcAppendBiallelicGenovecDphase16(const uintptr_t* __restrict genovec, c
   unsigned char* vrec_len_dest = &(pwcp->vrec_len_buf[vidx * vrec_len_byte_ct]);
   const uint32_t phasepresent_ct = phasepresent? PopcountWords(phasepresent, sample_ctl) : het_ct;
   if (phasepresent_ct) {
+    unsigned char* pbwt_aux2_start = nullptr;
+    if (pwcp->pbwt_hap_order) {
+      pbwt_aux2_start = PbwtHphaseStart(vidx, pwcp, &vrec_len);
+    }
     AppendHphase(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pwcp, vrtype_dest, &vrec_len);
+    if (pbwt_aux2_start) {
+      PbwtHphaseFinish(genovec, phasepresent, phaseinfo, het_ct, phasepresent_ct, pbwt_aux2_start, pwcp, &vrec_len);
+    }
   }
   if (dosage_ct) {
     if (unlikely(AppendDosage16(dosage_present, dosage_main, dosage_ct, dphase_ct, pwcp, vrtype_dest, &vrec_len))) {
@@ -2411,6 +2642,10 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr, FILE** pgi_or_
     if (pwcp->explicit_nonref_flags) {
       index_size += DivUp(variant_ct, CHAR_BIT);
     }
+    // LD base back-references
+    if (pwcp->ldbase_backref_buf) {
+      index_size += variant_ct;
+    }
     for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
       pwcp->vblock_fpos[vblock_idx] += index_size;
     }
@@ -2421,6 +2656,8 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr, FILE** pgi_or_
   uint32_t vrec_iter_incr = kPglVblockSize * vrec_len_byte_ct;
   uint32_t vrtype_buf_iter_incr = phase_dosage_gflags? kPglVblockSize : (kPglVblockSize / 2);
   uint32_t nonref_flags_write_byte_ct = kPglVblockSize / CHAR_BIT;
+  uint32_t backref_write_byte_ct = kPglVblockSize;
+  const unsigned char* backref_buf_iter = pwcp->ldbase_backref_buf;
   const unsigned char* vrec_len_buf_last = &(vrec_len_buf_iter[S_CAST(uintptr_t, vblock_ct - 1) * vrec_iter_incr]);
   uintptr_t* explicit_nonref_flags = pwcp->explicit_nonref_flags;
   uintptr_t* explicit_nonref_flags_iter = explicit_nonref_flags;
@@ -2433,6 +2670,7 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr, FILE** pgi_or_
       vrtype_buf_iter_incr = phase_dosage_gflags? vblock_size : DivUp(vblock_size, 2);
       vrec_iter_incr = vblock_size * vrec_len_byte_ct;
       nonref_flags_write_byte_ct = DivUp(vblock_size, CHAR_BIT);
+      backref_write_byte_ct = vblock_size;
     }
     // 4b(i): array of 4-bit or 1-byte vrtypes
     fwrite_unlocked(vrtype_buf_iter, vrtype_buf_iter_incr, 1, header_ff);
@@ -2452,6 +2690,14 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr, FILE** pgi_or_
       }
       explicit_nonref_flags_iter = &(explicit_nonref_flags_iter[kPglVblockSize / kBitsPerWord]);
     }
+
+    // 4b(v): LD base back-references
+    if (backref_buf_iter) {
+      if (unlikely(fwrite_checked(backref_buf_iter, backref_write_byte_ct, header_ff))) {
+        return kPglRetWriteFail;
+      }
+      backref_buf_iter = &(backref_buf_iter[kPglVblockSize]);
+    }
   }
   if (pwcp->header_exts || pwcp->footer_exts) {
     if (unlikely(AppendExtVarint(pwcp->header_exts, header_ff) ||
@@ -39,6 +39,8 @@ typedef struct PgenWriterCommonStruct {
   uint32_t sample_ct;
   PgenGlobalFlags phase_dosage_gflags;  // subset of gflags
   unsigned char nonref_flags_storage;
+  // kfPgenGlobalLdWindow is moved here from phase_dosage_gflags.
+  unsigned char ld_window;
 
   // I'll cache this for now
   uintptr_t vrec_len_byte_ct;
@@ -49,6 +51,10 @@ typedef struct PgenWriterCommonStruct {
   uintptr_t* vrtype_buf;
   uintptr_t* explicit_nonref_flags;  // usually nullptr
 
+  // LD-window modes only, nullptr otherwise.
+  // variant_ct_limit entries, zero-initialized.
+  unsigned char* ldbase_backref_buf;
+
   // needed for multiallelic-phased case
   uintptr_t* genovec_hets_buf;
 
@@ -80,6 +86,23 @@ typedef struct PgenWriterCommonStruct {
   uint32_t ldbase_common_geno;  // UINT32_MAX if ldbase_genovec present
   uint32_t ldbase_difflist_len;
 
+  // PBWT-encoded hardcall phase (mode 0x84/0x85) only, nullptr otherwise.
+  // hap_order arrays must hold 2 * sample_ct entries.
+  uint32_t* pbwt_hap_order;
+  uint32_t* pbwt_hap_order_tmp;
+  unsigned char* pbwt_runbuf;
+  // kPglPbwtResetInterval-variant segment pbwt_hap_order currently belongs to
+  uint32_t pbwt_segment_idx;
+
+  // LD-window mode only, nullptr otherwise.  Ring buffer of the last
+  // kPglLdWindowSize non-LD-compressed genovecs in the current vblock (each
+  // padded to a cacheline multiple), followed by one scratch genovec; and the
+  // ring entries' genotype counts.
+  uintptr_t* ldwin_genovecs;
+  STD_ARRAY_PTR_DECL(uint32_t, 4, ldwin_genocounts);
+  uint32_t ldwin_ct;
+  uint32_t ldwin_head;  // slot holding the most recent entry
+
   uint32_t vidx;
 } PgenWriterCommon;
 
@@ -167,6 +190,11 @@ void PreinitMpgw(MTPgenWriter* mpgwp);
 // phase_dosage_gflags zero vs. nonzero is most important: this determines size
 // of header.  Otherwise, setting more flags than necessary just increases
 // memory requirements.
+// kfPgenGlobalLdWindow is an exception: it doesn't count toward the
+// zero/nonzero test, and instead requests an LD-window-mode file where each
+// LD-compressed variant is diffed against the best of the last
+// kPglLdWindowSize non-LD-compressed variants, instead of just the last one.
+// This is not supported in kPgenWriteSeparateIndex mode.
 //
 // nonref_flags_storage values:
 //   0 = no info stored
@@ -487,11 +487,13 @@ PglErr BgzfRawMtStreamRead(unsigned char* dst_end, BgzfRawMtDecompressStream* bg
   return BgzfReadJoinAndRespawn(dst_end, bgzfp, dst_iterp, errmsgp);
 }
 
-PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bgzfp, FILE* next_ff, const char** errmsgp) {
+// Joins the worker threads and resets all buffer state, in preparation for
+// repositioning bodyp->ff.  The reader thread reinitializes itself on the next
+// spawn.
+static PglErr BgzfRawMtStreamPrepRetarget(BgzfRawMtDecompressStream* bgzfp, const char** errmsgp) {
   BgzfMtReadBody* bodyp = &bgzfp->body;
-  ThreadGroup* tgp = &bgzfp->tg;
   if (!bgzfp->eof) {
-    JoinThreads(tgp);
+    JoinThreads(&bgzfp->tg);
     const uint32_t prev_producer_parity = 1 - bgzfp->consumer_parity;
     BgzfMtReadCommWithD* prev_cwd = bodyp->cwd[prev_producer_parity];
     if (unlikely(prev_cwd->invalid_bgzf)) {
@@ -516,8 +518,23 @@ PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bg
     bgzfp->overflow_start[parity] = 0;
     bgzfp->overflow_end[parity] = 0;
   }
-  BgzfMtReadCommWithR* next_cwr = bodyp->cwr[next_producer_parity];
-  next_cwr->locked_start = kBgzfRawMtStreamRetargetCode;
+  bodyp->cwr[next_producer_parity]->locked_start = kBgzfRawMtStreamRetargetCode;
+  return kPglRetSuccess;
+}
+
+static PglErr BgzfRawMtStreamFinishRetarget(BgzfRawMtDecompressStream* bgzfp, const char** errmsgp) {
+  SpawnThreads(&bgzfp->tg);
+  bgzfp->eof = 0;
+  // Turn the crank once, for the same reason we do so during stream creation.
+  return BgzfReadJoinAndRespawn(nullptr, bgzfp, nullptr, errmsgp);
+}
+
+PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bgzfp, FILE* next_ff, const char** errmsgp) {
+  PglErr reterr = BgzfRawMtStreamPrepRetarget(bgzfp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  BgzfMtReadBody* bodyp = &bgzfp->body;
   if (next_ff == nullptr) {
     rewind(bodyp->ff);
     // bugfix (8 Feb 2020): need to explicitly read the first 16 bytes.
@@ -530,10 +547,25 @@ PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bg
     // bugfix (5 Oct 2019): forgot this
     memcpy(bodyp->in, header, 16);
   }
-  SpawnThreads(tgp);
-  bgzfp->eof = 0;
-  // Turn the crank once, for the same reason we do so during stream creation.
-  return BgzfReadJoinAndRespawn(nullptr, bgzfp, nullptr, errmsgp);
+  return BgzfRawMtStreamFinishRetarget(bgzfp, errmsgp);
+}
+
+PglErr BgzfRawMtStreamSeek(uint64_t coffset, BgzfRawMtDecompressStream* bgzfp, const char** errmsgp) {
+  PglErr reterr = BgzfRawMtStreamPrepRetarget(bgzfp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  BgzfMtReadBody* bodyp = &bgzfp->body;
+  FILE* ff = bodyp->ff;
+  if (unlikely(fseeko(ff, coffset, SEEK_SET))) {
+    *errmsgp = strerror(errno);
+    return kPglRetReadFail;
+  }
+  if (unlikely((!fread_unlocked(bodyp->in, 16, 1, ff)) || (!IsBgzfHeader(bodyp->in)))) {
+    *errmsgp = kShortErrInvalidBgzf;
+    return kPglRetDecompressFail;
+  }
+  return BgzfRawMtStreamFinishRetarget(bgzfp, errmsgp);
 }
 
 void CleanupBgzfRawMtStream(BgzfRawMtDecompressStream* bgzfp) {
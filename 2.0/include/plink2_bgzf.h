@@ -164,6 +164,12 @@ PglErr BgzfRawMtStreamRead(unsigned char* dst_end, BgzfRawMtDecompressStream* bg
 
 PglErr BgzfRawMtStreamRetarget(const char* header, BgzfRawMtDecompressStream* bgzfp, FILE* next_ff, const char** errmsgp);
 
+// Repositions the stream at the BGZF block starting at byte offset coffset of
+// the underlying file.  To resume from a BGZF virtual offset voffset, call
+// this with coffset = voffset >> 16, and then read and discard the next
+// (voffset & 0xffff) decompressed bytes.
+PglErr BgzfRawMtStreamSeek(uint64_t coffset, BgzfRawMtDecompressStream* bgzfp, const char** errmsgp);
+
 HEADER_INLINE PglErr BgzfRawMtStreamRewind(BgzfRawMtDecompressStream* bgzfp, const char** errmsgp) {
   return BgzfRawMtStreamRetarget(nullptr, bgzfp, nullptr, errmsgp);
 }
@@ -2916,7 +2916,7 @@ void Reduce8to4bitInplaceUnsafe(uintptr_t entry_ct, uintptr_t* mainvec) {
     vmainvec[write_vidx] = vecw_gather_even(v0, v1, m8);
   }
   uintptr_t write_idx = fullvec_ct * kWordsPerVec;
-  if (write_idx == entry_ct * 2) {
+  if (write_idx * kBytesPerWord * 2 == entry_ct) {
     return;
   }
 #else
@@ -1949,6 +1949,45 @@ const char* CsvLexK(const char* str_iter, const uint32_t* col_types, const uint3
 }
 #endif
 
+#ifndef USE_AVX2
+void IndexDelimsAndEolns(const char* src, uintptr_t word_ct, uint32_t delim_char_code, uintptr_t* __restrict delim_bitarr, uintptr_t* __restrict eoln_bitarr) {
+#ifdef __LP64__
+  // Same saturating-add trick as TokenLexK0(): bytes >= delim_char_code end up
+  // with their high bit set.
+  const VecUc* src_viter = R_CAST(const VecUc*, src);
+  const VecUc vvec_nondelim_add = vecuc_set1(128 - delim_char_code);
+  const VecUc vvec_all96 = vecuc_set1(96);
+  const VecUc vvec_all_tab = vecuc_set1(9);
+  for (uintptr_t widx = 0; widx != word_ct; ++widx) {
+    uintptr_t nondelim_word = 0;
+    uintptr_t noneoln_word = 0;
+    for (uint32_t vidx_in_word = 0; vidx_in_word != kBitsPerWord / kBytesPerVec; ++vidx_in_word) {
+      const VecUc cur_vvec = *src_viter++;
+      const uintptr_t nondelim_bytes = vecuc_movemask(vecuc_adds(cur_vvec, vvec_nondelim_add));
+      const uintptr_t noneoln_bytes = vecuc_movemask(vecuc_adds(cur_vvec, vvec_all96)) | vecuc_movemask(cur_vvec == vvec_all_tab);
+      nondelim_word |= nondelim_bytes << (vidx_in_word * kBytesPerVec);
+      noneoln_word |= noneoln_bytes << (vidx_in_word * kBytesPerVec);
+    }
+    delim_bitarr[widx] = ~nondelim_word;
+    eoln_bitarr[widx] = ~noneoln_word;
+  }
+#else
+  const unsigned char* src_iter = R_CAST(const unsigned char*, src);
+  for (uintptr_t widx = 0; widx != word_ct; ++widx) {
+    uintptr_t delim_word = 0;
+    uintptr_t eoln_word = 0;
+    for (uint32_t bit_idx = 0; bit_idx != kBitsPerWord; ++bit_idx) {
+      const uint32_t ucc = *src_iter++;
+      delim_word |= S_CAST(uintptr_t, ucc < delim_char_code) << bit_idx;
+      eoln_word |= S_CAST(uintptr_t, (ucc < 32) && (ucc != 9)) << bit_idx;
+    }
+    delim_bitarr[widx] = delim_word;
+    eoln_bitarr[widx] = eoln_word;
+  }
+#endif
+}
+#endif
+
 uint32_t CountTokens(const char* str_iter) {
   uint32_t token_ct = 0;
   str_iter = FirstNonTspace(str_iter);
@@ -2433,10 +2472,11 @@ char* dtoa_g(double dxx, char* start) {
   if (dxx != dxx) {
     return strcpya_k(start, "nan");
   }
-  if (dxx < 0) {
-    *start++ = '-';
-    dxx = -dxx;
-  }
+  // Sign is frequently unpredictable (betas, PC loadings, relationship
+  // coefficients), so don't branch on it.
+  *start = '-';
+  start += (dxx < 0);
+  dxx = fabs(dxx);
   if (dxx < 9.9999949999999e-5) {
     // 6 sig fig exponential notation, small
     if (dxx < 9.9999949999999e-16) {
@@ -2569,10 +2609,9 @@ char* dtoa_g_p8(double dxx, char* start) {
   if (dxx != dxx) {
     return strcpya_k(start, "nan");
   }
-  if (dxx < 0) {
-    *wpos++ = '-';
-    dxx = -dxx;
-  }
+  *wpos = '-';
+  wpos += (dxx < 0);
+  dxx = fabs(dxx);
   if (dxx < 9.9999999499999e-5) {
     // 8 sig fig exponential notation, small
     if (dxx < 9.9999999499999e-16) {
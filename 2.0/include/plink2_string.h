@@ -1347,6 +1347,17 @@ HEADER_INLINE char* TokenLex0(char* str_iter, const uint32_t* col_types, const u
   return K_CAST(char*, TokenLexK0(str_iter, col_types, col_skips, relevant_col_ct, K_CAST(const char**, token_ptrs), token_slens));
 }
 
+#ifndef USE_AVX2
+// Structural-index pass over word_ct * kBitsPerWord bytes starting at src,
+// which must be kBitsPerWord-byte aligned.  Bit i of delim_bitarr is set iff
+// ctou32(src[i]) < delim_char_code (32 for tab-delimited text, 33 when spaces
+// also separate fields), and bit i of eoln_bitarr is set iff src[i] is a
+// non-tab control character.  Field-skipping against the result reduces to
+// popcounts; see TextFieldIdx in plink2_text.h.
+// delim_char_code must be in 1..128.
+void IndexDelimsAndEolns(const char* src, uintptr_t word_ct, uint32_t delim_char_code, uintptr_t* __restrict delim_bitarr, uintptr_t* __restrict eoln_bitarr);
+#endif
+
 // ct must be positive for these functions.
 CXXCONST_CP NextCsvMult(const char* str_iter, uint32_t ct);
 
@@ -789,6 +789,7 @@ BoolErr CleanupTextFile(textFILE* txf_ptr, PglErr* reterrp) {
 void PreinitTextStream(TextStream* txs_ptr) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   EraseTextFileBase(&txsp->base);
+  txsp->advance_ct = 0;
   txsp->syncp = nullptr;
 }
 
@@ -824,6 +825,7 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
 #endif
   const uint32_t enforced_max_line_blen = basep->enforced_max_line_blen;
   const char* new_fname = nullptr;
+  uint64_t bgzf_voffset = 0;
   const uint32_t is_token_stream = (enforced_max_line_blen == 0);
   while (1) {
     TxsInterrupt interrupt = kTxsInterruptNone;
@@ -1179,6 +1181,7 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
     // must be in critical section here, or be holding the mutex.
     if (interrupt == kTxsInterruptRetarget) {
       new_fname = syncp->new_fname;
+      bgzf_voffset = syncp->new_bgzf_voffset;
       syncp->interrupt = kTxsInterruptNone;
       syncp->reterr = kPglRetSuccess;
     }
@@ -1195,7 +1198,22 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
     read_head = buf;
     if (!new_fname) {
       if (file_type == kFileBgzf) {
-        reterr = BgzfRawMtStreamRewind(&rdsp->bgzf, &syncp->errmsg);
+        if (!bgzf_voffset) {
+          reterr = BgzfRawMtStreamRewind(&rdsp->bgzf, &syncp->errmsg);
+        } else {
+          reterr = BgzfRawMtStreamSeek(bgzf_voffset >> 16, &rdsp->bgzf, &syncp->errmsg);
+          if (likely(!reterr)) {
+            // Discard the part of the block in front of the target line.  buf
+            // is always larger than a decompressed block.
+            unsigned char* skip_end = CToUc(&(buf[bgzf_voffset & 0xffff]));
+            unsigned char* skip_iter = CToUc(buf);
+            reterr = BgzfRawMtStreamRead(skip_end, &rdsp->bgzf, &skip_iter, &syncp->errmsg);
+            if (unlikely((!reterr) && (skip_iter != skip_end))) {
+              syncp->errmsg = kShortErrInvalidBgzf;
+              reterr = kPglRetDecompressFail;
+            }
+          }
+        }
         if (unlikely(reterr)) {
           goto TextStreamThread_MISC_FAIL;
         }
@@ -1412,6 +1430,7 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
     syncp->dst_reallocated = 0;
     syncp->interrupt = kTxsInterruptNone;
     syncp->new_fname = nullptr;
+    syncp->new_bgzf_voffset = 0;
 #ifdef _WIN32
     syncp->read_thread = nullptr;
     // apparently this can raise a low-memory exception in older Windows
@@ -1503,6 +1522,7 @@ PglErr TextAdvance(TextStream* txs_ptr) {
   TextFileBase* basep = &txsp->base;
   char* consume_iter = basep->consume_iter;
   TextStreamSync* syncp = txsp->syncp;
+  ++txsp->advance_ct;
 #ifdef _WIN32
   CRITICAL_SECTION* critical_sectionp = &syncp->critical_section;
   HANDLE consumer_progress_event = syncp->consumer_progress_event;
@@ -1631,6 +1651,142 @@ PglErr TextAdvance(TextStream* txs_ptr) {
 #endif
 }
 
+#ifndef USE_AVX2
+void TextFieldIdxInit(uint32_t delim_char_code, uintptr_t word_capacity, uintptr_t* delim_bitarr, uintptr_t* eoln_bitarr, TextFieldIdx* tfip) {
+  assert(word_capacity && (word_capacity <= kMaxTextFieldIdxWords));
+  tfip->base = nullptr;
+  tfip->end = nullptr;
+  tfip->delim_bitarr = delim_bitarr;
+  tfip->eoln_bitarr = eoln_bitarr;
+  tfip->word_capacity = word_capacity;
+  tfip->line_end_bit = 0;
+  tfip->delim_char_code = delim_char_code;
+  tfip->advance_ct = 0;
+}
+
+uint32_t TextFieldIdxStartLine(TextStream* txs_ptr, const char* line_start, TextFieldIdx* tfip) {
+  TextStreamMain* txsp = GetTxsp(txs_ptr);
+  if ((line_start < tfip->base) || (line_start >= tfip->end) || (tfip->advance_ct != txsp->advance_ct)) {
+    // Index everything from the current line to the end of the loaded block,
+    // up to capacity.  The first and last words may include bytes outside
+    // the block; that's safe since kBitsPerWord-byte-aligned reads can't
+    // cross a page boundary, and those bits are never examined.
+    const char* consume_stop = txsp->base.consume_stop;
+    const char* new_base = R_CAST(const char*, RoundDownPow2(R_CAST(uintptr_t, line_start), kBitsPerWord));
+    uintptr_t word_ct = DivUp(consume_stop - new_base, kBitsPerWord);
+    const char* new_end = consume_stop;
+    if (word_ct > tfip->word_capacity) {
+      word_ct = tfip->word_capacity;
+      new_end = &(new_base[word_ct * kBitsPerWord]);
+    }
+    IndexDelimsAndEolns(new_base, word_ct, tfip->delim_char_code, tfip->delim_bitarr, tfip->eoln_bitarr);
+    tfip->base = new_base;
+    tfip->end = new_end;
+    tfip->advance_ct = txsp->advance_ct;
+  }
+  const uint32_t start_bit = line_start - tfip->base;
+  const uint32_t end_bit = tfip->end - tfip->base;
+  const uintptr_t* eoln_bitarr = tfip->eoln_bitarr;
+  uint32_t widx = start_bit / kBitsPerWord;
+  uintptr_t cur_word = eoln_bitarr[widx] & ((~k0LU) << (start_bit % kBitsPerWord));
+  const uint32_t last_widx = (end_bit - 1) / kBitsPerWord;
+  while (!cur_word) {
+    if (widx == last_widx) {
+      return 0;
+    }
+    cur_word = eoln_bitarr[++widx];
+  }
+  const uint32_t line_end_bit = widx * kBitsPerWord + ctzw(cur_word);
+  if (line_end_bit >= end_bit) {
+    return 0;
+  }
+  tfip->line_end_bit = line_end_bit;
+  return 1;
+}
+
+const char* TextFieldIdxNextTokenMult(const TextFieldIdx* tfip, const char* str_iter, uint32_t ct) {
+  // Token starts are the non-delimiter bytes preceded by a delimiter; we want
+  // the ct-th one strictly after str_iter, and it must precede the line end.
+  const uintptr_t* delim_bitarr = tfip->delim_bitarr;
+  const uint32_t cur_bit = str_iter - tfip->base;
+  uint32_t widx = cur_bit / kBitsPerWord;
+  const uint32_t last_widx = tfip->line_end_bit / kBitsPerWord;
+  uintptr_t cur_delims = delim_bitarr[widx];
+  // If str_iter is in the first word, the bit before it is irrelevant.
+  uintptr_t prev_delim_highbit = widx? (delim_bitarr[widx - 1] >> (kBitsPerWord - 1)) : 1;
+  uintptr_t token_starts = (~cur_delims) & ((cur_delims << 1) | prev_delim_highbit) & ((~k1LU) << (cur_bit % kBitsPerWord));
+  while (1) {
+    const uint32_t cur_ct = PopcountWord(token_starts);
+    if (cur_ct >= ct) {
+      const uint32_t result_bit = widx * kBitsPerWord + WordBitIdxToUidx(token_starts, ct - 1);
+      if (result_bit > tfip->line_end_bit) {
+        return nullptr;
+      }
+      return &(tfip->base[result_bit]);
+    }
+    if (widx == last_widx) {
+      return nullptr;
+    }
+    ct -= cur_ct;
+    prev_delim_highbit = cur_delims >> (kBitsPerWord - 1);
+    cur_delims = delim_bitarr[++widx];
+    token_starts = (~cur_delims) & ((cur_delims << 1) | prev_delim_highbit);
+  }
+}
+
+const char* TextFieldIdxAdvToNthDelim(const TextFieldIdx* tfip, const char* str_iter, uint32_t ct) {
+  const uintptr_t* delim_bitarr = tfip->delim_bitarr;
+  const uint32_t cur_bit = str_iter - tfip->base;
+  uint32_t widx = cur_bit / kBitsPerWord;
+  const uint32_t last_widx = tfip->line_end_bit / kBitsPerWord;
+  uintptr_t cur_delims = delim_bitarr[widx] & ((~k0LU) << (cur_bit % kBitsPerWord));
+  while (1) {
+    const uint32_t cur_ct = PopcountWord(cur_delims);
+    if (cur_ct >= ct) {
+      const uint32_t result_bit = widx * kBitsPerWord + WordBitIdxToUidx(cur_delims, ct - 1);
+      // The line end is itself a delimiter, so too few fields manifests as
+      // landing on or past it.
+      if (result_bit >= tfip->line_end_bit) {
+        return nullptr;
+      }
+      return &(tfip->base[result_bit]);
+    }
+    if (widx == last_widx) {
+      return nullptr;
+    }
+    ct -= cur_ct;
+    cur_delims = delim_bitarr[++widx];
+  }
+}
+
+const char* TextFieldIdxFieldEnd(const TextFieldIdx* tfip, const char* str_iter) {
+  // No bounds check needed, since the line end is a delimiter.
+  const uintptr_t* delim_bitarr = tfip->delim_bitarr;
+  const uint32_t cur_bit = str_iter - tfip->base;
+  uint32_t widx = cur_bit / kBitsPerWord;
+  uintptr_t cur_delims = delim_bitarr[widx] & ((~k0LU) << (cur_bit % kBitsPerWord));
+  while (!cur_delims) {
+    cur_delims = delim_bitarr[++widx];
+  }
+  return &(tfip->base[widx * kBitsPerWord + ctzw(cur_delims)]);
+}
+
+const char* TextFieldIdxTokenLexK(const TextFieldIdx* tfip, const char* str_iter, const uint32_t* col_types, const uint32_t* col_skips, uint32_t relevant_col_ct, const char** token_ptrs, uint32_t* token_slens) {
+  for (uint32_t relevant_col_idx = 0; relevant_col_idx != relevant_col_ct; ++relevant_col_idx) {
+    const uint32_t cur_col_type = col_types[relevant_col_idx];
+    str_iter = TextFieldIdxNextTokenMult(tfip, str_iter, col_skips[relevant_col_idx]);
+    if (!str_iter) {
+      return nullptr;
+    }
+    token_ptrs[cur_col_type] = str_iter;
+    const char* token_end = TextFieldIdxFieldEnd(tfip, str_iter);
+    token_slens[cur_col_type] = token_end - str_iter;
+    str_iter = token_end;
+  }
+  return str_iter;
+}
+#endif
+
 PglErr TextOnlyEmptyLinesLeft(TextStream* txs_ptr) {
   TextFileBase* basep = &GetTxsp(txs_ptr)->base;
   char* line_start = basep->consume_iter;
@@ -1723,10 +1879,11 @@ PglErr TextSkipNz(uintptr_t skip_ct, TextStream* txs_ptr) {
 #endif
 }
 
-PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
+static PglErr TextRetargetInternal(const char* new_fname, uint64_t bgzf_voffset, TextStream* txs_ptr) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* basep = &txsp->base;
   TextStreamSync* syncp = txsp->syncp;
+  ++txsp->advance_ct;
 #ifdef _WIN32
   CRITICAL_SECTION* critical_sectionp = &syncp->critical_section;
   EnterCriticalSection(critical_sectionp);
@@ -1758,6 +1915,7 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   // outweigh disadvantages, but I'll wait till --pmerge development to make a
   // decision since that's the main function that actually cares.
   syncp->new_fname = new_fname;
+  syncp->new_bgzf_voffset = bgzf_voffset;
   SetEvent(syncp->consumer_progress_event);
   LeaveCriticalSection(critical_sectionp);
 #else
@@ -1784,6 +1942,7 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   syncp->dst_reallocated = 0;
   syncp->interrupt = kTxsInterruptRetarget;
   syncp->new_fname = new_fname;
+  syncp->new_bgzf_voffset = bgzf_voffset;
   syncp->consumer_progress_state = 1;
   pthread_cond_signal(consumer_progress_condvarp);
   pthread_mutex_unlock(sync_mutexp);
@@ -1793,6 +1952,15 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   return kPglRetSuccess;
 }
 
+PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
+  return TextRetargetInternal(new_fname, 0, txs_ptr);
+}
+
+PglErr TextBgzfSeek(uint64_t voffset, TextStream* txs_ptr) {
+  assert(GetTxsp(txs_ptr)->base.file_type == kFileBgzf);
+  return TextRetargetInternal(nullptr, voffset, txs_ptr);
+}
+
 BoolErr CleanupTextStream(TextStream* txs_ptr, PglErr* reterrp) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* basep = &txsp->base;
@@ -366,6 +366,8 @@ typedef struct TextStreamSyncStruct {
   uint32_t dst_reallocated;
   TxsInterrupt interrupt;
   const char* new_fname;
+  // BGZF virtual offset to resume from on a same-file retarget (0 = rewind).
+  uint64_t new_bgzf_voffset;
 } TextStreamSync;
 
 typedef union {
@@ -378,6 +380,9 @@ typedef struct TextStreamMainStruct {
   TextFileBase base;
   RawMtDecompressStream rds;
   uint32_t decompress_thread_ct;
+  // incremented on every TextAdvance()/TextRetarget() call, so that derived
+  // per-block state (e.g. TextFieldIdx) can tell when it's stale
+  uint32_t advance_ct;
   TextStreamSync* syncp;
 } TextStreamMain;
 
@@ -414,6 +419,82 @@ HEADER_INLINE char* TextLineEnd(TextStream* txs_ptr) {
   return GET_PRIVATE(*txs_ptr, m).base.consume_iter;
 }
 
+// End of the currently loaded lines.  Everything between the current line and
+// this point consists of complete \n-terminated lines, which stay valid until
+// the next TextAdvance() call; useful for handing a batch of lines to worker
+// threads.
+HEADER_INLINE char* TextConsumeStop(TextStream* txs_ptr) {
+  return GET_PRIVATE(*txs_ptr, m).base.consume_stop;
+}
+
+#ifndef USE_AVX2
+// Structural index over (a prefix of) the currently loaded lines, built by one
+// IndexDelimsAndEolns() pass, so that skipping fields costs one popcount per
+// 64 bytes instead of a byte-by-byte scan.  Worthwhile when many columns are
+// skipped per line (wide phenotype tables, etc.).
+// Not compiled in AVX2 builds: TokenLexK() already skips fields 32 bytes at a
+// time there, and already runs at text-decompression speed on a 5000-column
+// table, so there's nothing left for the index to win.
+// Bit i of delim_bitarr/eoln_bitarr describes base[i].
+typedef struct TextFieldIdxStruct {
+  const char* base;
+  const char* end;
+  uintptr_t* delim_bitarr;
+  uintptr_t* eoln_bitarr;
+  uintptr_t word_capacity;
+  uint32_t line_end_bit;
+  uint32_t delim_char_code;
+  uint32_t advance_ct;
+} TextFieldIdx;
+
+// Up to word_capacity * kBitsPerWord bytes are indexed at a time; longer lines
+// are never covered.  Both bitarrays must have word_capacity entries.
+// delim_char_code is 32 for tab-delimited text, and 33 when spaces also
+// separate fields.
+CONSTI32(kMaxTextFieldIdxWords, 1 << 25);
+
+// 4 MiB window, i.e. 1 MiB of bitarrays.
+CONSTI32(kTextFieldIdxDefaultWords, (4 * kDecompressChunkSize) / kBitsPerWord);
+
+CONSTI32(kTextFieldIdxMinSkip, 64);
+
+// Indexing costs a pass over every byte of each line, so it only beats
+// TokenLexK() when a decent fraction of the fields are skipped (break-even is
+// ~10% on a 5000-column table).
+HEADER_INLINE uint32_t TextFieldIdxWorthwhile(uint32_t skipped_field_ct, uint32_t field_ct) {
+  return (skipped_field_ct >= S_CAST(uint32_t, kTextFieldIdxMinSkip)) && (skipped_field_ct >= field_ct / 8);
+}
+
+void TextFieldIdxInit(uint32_t delim_char_code, uintptr_t word_capacity, uintptr_t* delim_bitarr, uintptr_t* eoln_bitarr, TextFieldIdx* tfip);
+
+// Call on each line to be lexed with the functions below; line_start must be
+// within the currently loaded lines.  (Re)indexes from line_start when
+// necessary.  Returns 1 iff the entire line is covered; otherwise, the caller
+// must fall back on the ordinary scanning functions for this line.
+// The index reflects buffer contents at indexing time; it's fine to e.g.
+// null-terminate tokens afterward.
+uint32_t TextFieldIdxStartLine(TextStream* txs_ptr, const char* line_start, TextFieldIdx* tfip);
+
+// Indexed equivalents of NextTokenMult() (whitespace-delimited, ct must be
+// positive), AdvToNthDelimChecked() against the line end (tab-delimited), and
+// the non-AVX2 TokenLexK().  Only valid on the line passed to the last
+// successful TextFieldIdxStartLine() call.
+const char* TextFieldIdxNextTokenMult(const TextFieldIdx* tfip, const char* str_iter, uint32_t ct);
+
+const char* TextFieldIdxAdvToNthDelim(const TextFieldIdx* tfip, const char* str_iter, uint32_t ct);
+
+// First delimiter at or after str_iter.
+const char* TextFieldIdxFieldEnd(const TextFieldIdx* tfip, const char* str_iter);
+
+const char* TextFieldIdxTokenLexK(const TextFieldIdx* tfip, const char* str_iter, const uint32_t* col_types, const uint32_t* col_skips, uint32_t relevant_col_ct, const char** token_ptrs, uint32_t* token_slens);
+
+// Position of the current line's terminating control character (usually \n,
+// but may be \r), so callers don't need to rescan the rest of the line.
+HEADER_INLINE const char* TextFieldIdxLineEnd(const TextFieldIdx* tfip) {
+  return &(tfip->base[tfip->line_end_bit]);
+}
+#endif
+
 HEADER_INLINE int32_t TextIsOpen(const TextStream* txs_ptr) {
   return (GET_PRIVATE(*txs_ptr, m).base.ff != nullptr);
 }
@@ -607,12 +688,21 @@ HEADER_INLINE uint32_t TextIsMt(const TextStream* txs_ptr) {
   return (GET_PRIVATE(*txs_ptr, m).base.file_type == kFileBgzf);
 }
 
+HEADER_INLINE uint32_t TextIsBgzf(const TextStream* txs_ptr) {
+  return (GET_PRIVATE(*txs_ptr, m).base.file_type == kFileBgzf);
+}
+
 PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr);
 
 HEADER_INLINE PglErr TextRewind(TextStream* txs_ptr) {
   return TextRetarget(nullptr, txs_ptr);
 }
 
+// Like TextRewind(), but resumes from the given BGZF virtual offset (e.g. one
+// taken from a .tbi/.csi index) instead of the beginning of the file.  File
+// must be BGZF-compressed, and voffset should point to the start of a line.
+PglErr TextBgzfSeek(uint64_t voffset, TextStream* txs_ptr);
+
 HEADER_INLINE const char* TextStreamError(const TextStream* txs_ptr) {
   return GET_PRIVATE(*txs_ptr, m).base.errmsg;
 }
@@ -106,7 +106,7 @@ BoolErr SetThreadCt(uint32_t thread_ct, ThreadGroup* tg_ptr) {
   memset(tgp->threads, 0, thread_ct * sizeof(HANDLE));
   memptr = &(memptr[thread_ct * sizeof(HANDLE)]);
 #else
-  unsigned char* memptr = S_CAST(unsigned char*, malloc(thread_ct * (sizeof(pthread_t) + sizeof(ThreadGroupFuncArg))));
+  unsigned char* memptr = S_CAST(unsigned char*, malloc(thread_ct * (sizeof(pthread_t) + sizeof(ThreadGroupFuncArg) + sizeof(int32_t))));
   if (unlikely(!memptr)) {
     return 1;
   }
@@ -119,11 +119,362 @@ BoolErr SetThreadCt(uint32_t thread_ct, ThreadGroup* tg_ptr) {
   ThreadGroupControlBlock* cbp = GetCbp(&tgp->shared);
   cbp->active_ct = 0;
   tgp->thread_args = R_CAST(ThreadGroupFuncArg*, memptr);
+#ifndef _WIN32
+  tgp->pool_slots = R_CAST(uint32_t*, &(memptr[thread_ct * sizeof(ThreadGroupFuncArg)]));
+#endif
 
   cbp->thread_ct = thread_ct;
   return 0;
 }
 
+#ifndef _WIN32
+typedef struct ThreadPoolWorkerStruct {
+  pthread_t thread;
+  pthread_cond_t start_condvar;
+  THREAD_FUNCPTR_T(func_ptr);
+  void* arg;
+  // 0 = idle, 1 = running a thread function, 2 = finished but not yet joined
+  uint32_t state;
+} ThreadPoolWorker;
+
+typedef struct ThreadPoolStruct {
+  pthread_mutex_t mutex;
+  pthread_cond_t done_condvar;
+  pthread_attr_t smallstack_thread_attr;
+  ThreadPoolWorker* workers;
+  uint32_t worker_ct;
+  uint32_t worker_capacity;
+  uint32_t is_init;
+  uint32_t shutdown;
+#  ifdef __linux__
+  cpu_set_t cpus;
+  uint32_t cpu_ct;
+  // kThreadPinNumaNode only
+  cpu_set_t node_cpus[kMaxNumaNodes];
+#  endif
+  uint32_t numa_node_ct;
+  ThreadPinMode pin_mode;
+  uint32_t pinned_ct;
+} ThreadPool;
+
+static ThreadPool g_thread_pool;
+#endif
+
+// Log-only statistics; g_thread_reuse_ct is updated under the pool mutex, the
+// others aren't synchronized.
+static uint64_t g_thread_launch_ct = 0;
+static uint64_t g_thread_reuse_ct = 0;
+static uint64_t g_thread_spawn_ns = 0;
+
+#ifndef _WIN32
+static THREAD_FUNC_DECL ThreadPoolWorkerMain(void* raw_arg) {
+  ThreadPoolWorker* wp = S_CAST(ThreadPoolWorker*, raw_arg);
+  ThreadPool* poolp = &g_thread_pool;
+  pthread_mutex_lock(&poolp->mutex);
+  while (1) {
+    while ((wp->state != 1) && (!poolp->shutdown)) {
+      pthread_cond_wait(&wp->start_condvar, &poolp->mutex);
+    }
+    if (wp->state != 1) {
+      break;
+    }
+    THREAD_FUNCPTR_T(func_ptr) = wp->func_ptr;
+    void* arg = wp->arg;
+    pthread_mutex_unlock(&poolp->mutex);
+    func_ptr(arg);
+    pthread_mutex_lock(&poolp->mutex);
+    wp->state = 2;
+    pthread_cond_broadcast(&poolp->done_condvar);
+  }
+  pthread_mutex_unlock(&poolp->mutex);
+  THREAD_RETURN;
+}
+
+// Assumes mutex is held.
+static BoolErr ThreadPoolAddWorker(ThreadPool* poolp) {
+  const uint32_t worker_idx = poolp->worker_ct;
+  ThreadPoolWorker* wp = &(poolp->workers[worker_idx]);
+  if (unlikely(pthread_cond_init(&wp->start_condvar, nullptr))) {
+    return 1;
+  }
+  wp->func_ptr = nullptr;
+  wp->arg = nullptr;
+  wp->state = 0;
+  if (unlikely(pthread_create(&wp->thread, &poolp->smallstack_thread_attr, ThreadPoolWorkerMain, wp))) {
+    pthread_cond_destroy(&wp->start_condvar);
+    return 1;
+  }
+#  ifdef __linux__
+  if (poolp->numa_node_ct > 1) {
+    if (!pthread_setaffinity_np(wp->thread, sizeof(cpu_set_t), &(poolp->node_cpus[worker_idx % poolp->numa_node_ct]))) {
+      poolp->pinned_ct += 1;
+    }
+  } else if ((poolp->pin_mode == kThreadPinCpu) && poolp->cpu_ct) {
+    // worker_idx mod cpu_ct'th CPU in the original mask
+    uint32_t skip_ct = worker_idx % poolp->cpu_ct;
+    uint32_t cpu_idx = 0;
+    for (; ; ++cpu_idx) {
+      if (CPU_ISSET(cpu_idx, &poolp->cpus)) {
+        if (!skip_ct) {
+          break;
+        }
+        --skip_ct;
+      }
+    }
+    cpu_set_t cur_cpu;
+    CPU_ZERO(&cur_cpu);
+    CPU_SET(cpu_idx, &cur_cpu);
+    if (!pthread_setaffinity_np(wp->thread, sizeof(cpu_set_t), &cur_cpu)) {
+      poolp->pinned_ct += 1;
+    }
+  }
+#  endif
+  poolp->worker_ct = worker_idx + 1;
+  return 0;
+}
+
+#  ifdef __linux__
+// Fills node_cpus[] with the CPU sets of the NUMA nodes (per sysfs) that
+// intersect *allowedp, and returns the number of such nodes.  Returns 0 if
+// the topology can't be read.
+static uint32_t DetectNumaNodes(const cpu_set_t* allowedp, cpu_set_t* node_cpus) {
+  uint32_t node_ct = 0;
+  char fname[64];
+  char buf[4096];
+  for (uint32_t node_id = 0; node_id != kMaxNumaNodes; ++node_id) {
+    snprintf(fname, 64, "/sys/devices/system/node/node%u/cpulist", node_id);
+    FILE* infile = fopen(fname, FOPEN_RB);
+    if (!infile) {
+      // node IDs can have gaps
+      continue;
+    }
+    const uintptr_t read_ct = fread(buf, 1, 4095, infile);
+    fclose(infile);
+    buf[read_ct] = '\0';
+    // format: comma-separated list of CPU indices and ranges, e.g. "0-15,32-47"
+    cpu_set_t* cur_cpus = &(node_cpus[node_ct]);
+    CPU_ZERO(cur_cpus);
+    const char* read_iter = buf;
+    while (1) {
+      if ((*read_iter < '0') || (*read_iter > '9')) {
+        break;
+      }
+      uint32_t range_start = 0;
+      do {
+        range_start = range_start * 10 + S_CAST(uint32_t, *read_iter++ - '0');
+      } while ((*read_iter >= '0') && (*read_iter <= '9') && (range_start < CPU_SETSIZE));
+      uint32_t range_last = range_start;
+      if (*read_iter == '-') {
+        ++read_iter;
+        range_last = 0;
+        while ((*read_iter >= '0') && (*read_iter <= '9') && (range_last < CPU_SETSIZE)) {
+          range_last = range_last * 10 + S_CAST(uint32_t, *read_iter++ - '0');
+        }
+      }
+      if (range_last >= CPU_SETSIZE) {
+        range_last = CPU_SETSIZE - 1;
+      }
+      for (uint32_t cpu_idx = range_start; cpu_idx <= range_last; ++cpu_idx) {
+        if (CPU_ISSET(cpu_idx, allowedp)) {
+          CPU_SET(cpu_idx, cur_cpus);
+        }
+      }
+      if (*read_iter != ',') {
+        break;
+      }
+      ++read_iter;
+    }
+    if (CPU_COUNT(cur_cpus)) {
+      ++node_ct;
+    }
+  }
+  return node_ct;
+}
+#  endif
+
+BoolErr InitThreadPool(uint32_t worker_ct, ThreadPinMode pin_mode) {
+  ThreadPool* poolp = &g_thread_pool;
+  assert(!poolp->is_init);
+  // Enough for several concurrently active thread groups at the maximum
+  // thread count; any excess falls back to direct thread creation.
+  const uint32_t worker_capacity = 4 * kMaxThreads;
+  if (worker_ct > worker_capacity) {
+    worker_ct = worker_capacity;
+  }
+  poolp->workers = S_CAST(ThreadPoolWorker*, malloc(worker_capacity * sizeof(ThreadPoolWorker)));
+  if (unlikely(!poolp->workers)) {
+    return 1;
+  }
+  if (unlikely(pthread_mutex_init(&poolp->mutex, nullptr))) {
+    free(poolp->workers);
+    return 1;
+  }
+  if (unlikely(pthread_cond_init(&poolp->done_condvar, nullptr))) {
+    pthread_mutex_destroy(&poolp->mutex);
+    free(poolp->workers);
+    return 1;
+  }
+  if (unlikely(pthread_attr_init(&poolp->smallstack_thread_attr))) {
+    pthread_cond_destroy(&poolp->done_condvar);
+    pthread_mutex_destroy(&poolp->mutex);
+    free(poolp->workers);
+    return 1;
+  }
+  pthread_attr_setstacksize(&poolp->smallstack_thread_attr, kDefaultThreadStack);
+  poolp->worker_ct = 0;
+  poolp->worker_capacity = worker_capacity;
+  poolp->shutdown = 0;
+  poolp->pin_mode = pin_mode;
+  poolp->pinned_ct = 0;
+  poolp->numa_node_ct = 1;
+#  ifdef __linux__
+  poolp->cpu_ct = 0;
+  if ((pin_mode != kThreadPinNone) && (sched_getaffinity(0, sizeof(cpu_set_t), &poolp->cpus) == 0)) {
+    poolp->cpu_ct = CPU_COUNT(&poolp->cpus);
+    if (pin_mode == kThreadPinNumaNode) {
+      const uint32_t node_ct = DetectNumaNodes(&poolp->cpus, poolp->node_cpus);
+      if (node_ct > 1) {
+        poolp->numa_node_ct = node_ct;
+      }
+    }
+  }
+#  endif
+  poolp->is_init = 1;
+  const uint64_t spawn_start_ns = MonotonicNs();
+  pthread_mutex_lock(&poolp->mutex);
+  for (uint32_t worker_idx = 0; worker_idx != worker_ct; ++worker_idx) {
+    if (unlikely(ThreadPoolAddWorker(poolp))) {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&poolp->mutex);
+  g_thread_spawn_ns += MonotonicNs() - spawn_start_ns;
+  return (poolp->worker_ct == 0);
+}
+
+// Returns UINT32_MAX if the pool is uninitialized or can't supply a worker;
+// the caller should create the thread directly in that case.
+static uint32_t ThreadPoolLaunch(THREAD_FUNCPTR_T(start_routine), void* arg) {
+  ThreadPool* poolp = &g_thread_pool;
+  if (!poolp->is_init) {
+    return UINT32_MAX;
+  }
+  pthread_mutex_lock(&poolp->mutex);
+  const uint32_t worker_ct = poolp->worker_ct;
+  ThreadPoolWorker* workers = poolp->workers;
+  uint32_t worker_idx = 0;
+  for (; worker_idx != worker_ct; ++worker_idx) {
+    if (!workers[worker_idx].state) {
+      break;
+    }
+  }
+  if (worker_idx == worker_ct) {
+    if ((worker_ct == poolp->worker_capacity) || ThreadPoolAddWorker(poolp)) {
+      pthread_mutex_unlock(&poolp->mutex);
+      return UINT32_MAX;
+    }
+  } else {
+    g_thread_reuse_ct += 1;
+  }
+  ThreadPoolWorker* wp = &(workers[worker_idx]);
+  wp->func_ptr = start_routine;
+  wp->arg = arg;
+  wp->state = 1;
+  pthread_cond_signal(&wp->start_condvar);
+  pthread_mutex_unlock(&poolp->mutex);
+  return worker_idx;
+}
+
+// Waits for the thread function to return, then makes the worker available
+// again.
+static void ThreadPoolJoin(uint32_t worker_idx) {
+  ThreadPool* poolp = &g_thread_pool;
+  ThreadPoolWorker* wp = &(poolp->workers[worker_idx]);
+  pthread_mutex_lock(&poolp->mutex);
+  while (wp->state != 2) {
+    pthread_cond_wait(&poolp->done_condvar, &poolp->mutex);
+  }
+  wp->state = 0;
+  pthread_mutex_unlock(&poolp->mutex);
+}
+
+void CleanupThreadPool() {
+  ThreadPool* poolp = &g_thread_pool;
+  if (!poolp->is_init) {
+    return;
+  }
+  pthread_mutex_lock(&poolp->mutex);
+  poolp->shutdown = 1;
+  const uint32_t worker_ct = poolp->worker_ct;
+  for (uint32_t worker_idx = 0; worker_idx != worker_ct; ++worker_idx) {
+    pthread_cond_signal(&poolp->workers[worker_idx].start_condvar);
+  }
+  pthread_mutex_unlock(&poolp->mutex);
+  for (uint32_t worker_idx = 0; worker_idx != worker_ct; ++worker_idx) {
+    ThreadPoolWorker* wp = &(poolp->workers[worker_idx]);
+    pthread_join(wp->thread, nullptr);
+    pthread_cond_destroy(&wp->start_condvar);
+  }
+  pthread_attr_destroy(&poolp->smallstack_thread_attr);
+  pthread_cond_destroy(&poolp->done_condvar);
+  pthread_mutex_destroy(&poolp->mutex);
+  free(poolp->workers);
+  poolp->workers = nullptr;
+  poolp->worker_ct = 0;
+  poolp->is_init = 0;
+}
+
+uint32_t ThreadPoolNumaNodeCt() {
+  return g_thread_pool.is_init? g_thread_pool.numa_node_ct : 1;
+}
+
+uint32_t CurNumaNode() {
+#  ifdef __linux__
+  if (ThreadPoolNumaNodeCt() > 1) {
+    const int32_t cpu_idx = sched_getcpu();
+    if (cpu_idx >= 0) {
+      const uint32_t node_ct = g_thread_pool.numa_node_ct;
+      for (uint32_t node_idx = 0; node_idx != node_ct; ++node_idx) {
+        if (CPU_ISSET(cpu_idx, &(g_thread_pool.node_cpus[node_idx]))) {
+          return node_idx;
+        }
+      }
+    }
+  }
+#  endif
+  return 0;
+}
+#else
+BoolErr InitThreadPool(__maybe_unused uint32_t worker_ct, __maybe_unused ThreadPinMode pin_mode) {
+  return 1;
+}
+
+void CleanupThreadPool() {
+}
+
+uint32_t ThreadPoolNumaNodeCt() {
+  return 1;
+}
+
+uint32_t CurNumaNode() {
+  return 0;
+}
+#endif
+
+void GetThreadPoolStats(ThreadPoolStats* statsp) {
+  statsp->launch_ct = g_thread_launch_ct;
+  statsp->reuse_ct = g_thread_reuse_ct;
+  statsp->spawn_ns = g_thread_spawn_ns;
+#ifdef _WIN32
+  statsp->worker_ct = 0;
+  statsp->pinned_ct = 0;
+#else
+  statsp->worker_ct = g_thread_pool.worker_ct;
+  statsp->pinned_ct = g_thread_pool.pinned_ct;
+#endif
+  statsp->numa_node_ct = ThreadPoolNumaNodeCt();
+}
+
 // Note that thread_ct is permitted to be less than tgp->shared.cb.thread_ct,
 // to support the SpawnThreads() error cases.
 void JoinThreadsInternal(uint32_t thread_ct, ThreadGroupMain* tgp) {
@@ -152,7 +503,12 @@ void JoinThreadsInternal(uint32_t thread_ct, ThreadGroupMain* tgp) {
     // keep mutex until next block loaded
   } else {
     for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
-      pthread_join(tgp->threads[tidx], nullptr);
+      const uint32_t pool_slot = tgp->pool_slots[tidx];
+      if (pool_slot != UINT32_MAX) {
+        ThreadPoolJoin(pool_slot);
+      } else {
+        pthread_join(tgp->threads[tidx], nullptr);
+      }
     }
     pthread_mutex_destroy(&cbp->sync_mutex);
     pthread_cond_destroy(&cbp->cur_block_done_condvar);
@@ -259,10 +615,17 @@ BoolErr SpawnThreads(ThreadGroup* tg_ptr) {
     }
     pthread_attr_setstacksize(&smallstack_thread_attr, kDefaultThreadStack);
 #  endif
+    const uint64_t spawn_start_ns = MonotonicNs();
+    g_thread_launch_ct += thread_ct;
     for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
       ThreadGroupFuncArg* arg_slot = &(tgp->thread_args[tidx]);
       arg_slot->sharedp = &(tgp->shared);
       arg_slot->tidx = tidx;
+      const uint32_t pool_slot = ThreadPoolLaunch(tgp->thread_func_ptr, arg_slot);
+      tgp->pool_slots[tidx] = pool_slot;
+      if (pool_slot != UINT32_MAX) {
+        continue;
+      }
       const int32_t pthread_create_result =
         pthread_create(&(threads[tidx]),
 #  ifdef __cplusplus
@@ -298,6 +661,7 @@ BoolErr SpawnThreads(ThreadGroup* tg_ptr) {
 #  ifndef __cplusplus
     pthread_attr_destroy(&smallstack_thread_attr);
 #  endif
+    g_thread_spawn_ns += MonotonicNs() - spawn_start_ns;
     tgp->is_active = 1;
   } else {
     cbp->spawn_ct += 1;
@@ -395,6 +759,120 @@ void UpdateU64IfSmaller(uint64_t newval, uint64_t* oldval_ptr) {
   }
 }
 
+void InitTaskDeques(uint32_t thread_ct, unsigned char* tdq_alloc, TaskDeques* tdqp) {
+  tdqp->slots = R_CAST(uint64_t*, tdq_alloc);
+  tdqp->thread_ct = thread_ct;
+  tdqp->grain = 1;
+  tdqp->block_start_ns = 0;
+  tdqp->idle_ns = 0;
+  tdqp->thread_ns = 0;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    tdqp->slots[tidx * kInt64PerCacheline] = 0;
+  }
+}
+
+void ResetTaskDeques(uint32_t item_ct, uint32_t grain, TaskDeques* tdqp) {
+  const uint32_t thread_ct = tdqp->thread_ct;
+  uint64_t* slots = tdqp->slots;
+  uint32_t range_start = 0;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    const uint32_t range_end = (S_CAST(uint64_t, tidx + 1) * item_ct) / thread_ct;
+    uint64_t* slot = &(slots[tidx * kInt64PerCacheline]);
+    slot[0] = (S_CAST(uint64_t, range_start) << 32) | range_end;
+    slot[1] = 0;
+    range_start = range_end;
+  }
+  tdqp->grain = grain;
+  tdqp->block_start_ns = MonotonicNs();
+}
+
+// Moves the back half of the largest remaining range into thread tidx's
+// (empty) range.  Returns 0 if there was nothing to steal.
+static uint32_t StealTasks(uint32_t tidx, TaskDeques* tdqp) {
+  const uint32_t thread_ct = tdqp->thread_ct;
+  uint64_t* slots = tdqp->slots;
+  while (1) {
+    uint32_t victim_tidx = UINT32_MAX;
+    uint32_t best_len = 0;
+    uint64_t victim_range = 0;
+    for (uint32_t cur_tidx = 0; cur_tidx != thread_ct; ++cur_tidx) {
+      if (cur_tidx == tidx) {
+        continue;
+      }
+      // A stale value here only affects victim selection; the
+      // compare-and-swap below catches it.
+      const uint64_t cur_range = __atomic_load_n(&(slots[cur_tidx * kInt64PerCacheline]), __ATOMIC_ACQUIRE);
+      const uint32_t range_start = cur_range >> 32;
+      const uint32_t range_end = S_CAST(uint32_t, cur_range);
+      if ((range_end > range_start) && (range_end - range_start > best_len)) {
+        best_len = range_end - range_start;
+        victim_tidx = cur_tidx;
+        victim_range = cur_range;
+      }
+    }
+    if (victim_tidx == UINT32_MAX) {
+      return 0;
+    }
+    const uint32_t range_start = victim_range >> 32;
+    const uint32_t range_end = S_CAST(uint32_t, victim_range);
+    const uint32_t range_mid = range_start + (best_len / 2);
+    const uint64_t new_victim_range = (S_CAST(uint64_t, range_start) << 32) | range_mid;
+    if (ATOMIC_COMPARE_EXCHANGE_N_U64(&(slots[victim_tidx * kInt64PerCacheline]), &victim_range, new_victim_range, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      // Other threads may still attempt to steal from our empty range, so
+      // this must be a compare-and-swap as well.
+      uint64_t* own_slot = &(slots[tidx * kInt64PerCacheline]);
+      uint64_t own_range = __atomic_load_n(own_slot, __ATOMIC_ACQUIRE);
+      const uint64_t new_own_range = (S_CAST(uint64_t, range_mid) << 32) | range_end;
+      while (!ATOMIC_COMPARE_EXCHANGE_N_U64(own_slot, &own_range, new_own_range, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+      return 1;
+    }
+  }
+}
+
+uint32_t TaskDequesNext(uint32_t tidx, TaskDeques* tdqp, uint32_t* item_start_ptr, uint32_t* item_end_ptr) {
+  uint64_t* own_slot = &(tdqp->slots[tidx * kInt64PerCacheline]);
+  const uint32_t grain = tdqp->grain;
+  uint64_t cur_range = __atomic_load_n(own_slot, __ATOMIC_ACQUIRE);
+  while (1) {
+    const uint32_t range_start = cur_range >> 32;
+    const uint32_t range_end = S_CAST(uint32_t, cur_range);
+    if (range_start < range_end) {
+      const uint32_t chunk_end = (range_end - range_start > grain)? (range_start + grain) : range_end;
+      const uint64_t new_range = (S_CAST(uint64_t, chunk_end) << 32) | range_end;
+      if (ATOMIC_COMPARE_EXCHANGE_N_U64(own_slot, &cur_range, new_range, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        *item_start_ptr = range_start;
+        *item_end_ptr = chunk_end;
+        return 1;
+      }
+      continue;
+    }
+    if (!StealTasks(tidx, tdqp)) {
+      own_slot[1] = MonotonicNs();
+      return 0;
+    }
+    cur_range = __atomic_load_n(own_slot, __ATOMIC_ACQUIRE);
+  }
+}
+
+void TaskDequesBlockDone(TaskDeques* tdqp) {
+  const uint32_t thread_ct = tdqp->thread_ct;
+  const uint64_t* slots = tdqp->slots;
+  uint64_t block_end_ns = tdqp->block_start_ns;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    const uint64_t done_ns = slots[tidx * kInt64PerCacheline + 1];
+    if (done_ns > block_end_ns) {
+      block_end_ns = done_ns;
+    }
+  }
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    const uint64_t done_ns = slots[tidx * kInt64PerCacheline + 1];
+    if (done_ns) {
+      tdqp->idle_ns += block_end_ns - done_ns;
+    }
+  }
+  tdqp->thread_ns += S_CAST(uint64_t, thread_ct) * (block_end_ns - tdqp->block_start_ns);
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -33,6 +33,7 @@
 #  include <process.h>
 #else
 #  include <pthread.h>
+#  include <time.h>
 #endif
 
 // Most thread functions should be of the form
@@ -81,6 +82,7 @@
 #  define __ATOMIC_SEQ_CST 5
 #  define __atomic_fetch_add(ptr, val, memorder) __sync_fetch_and_add((ptr), (val))
 #  define __atomic_fetch_sub(ptr, val, memorder) __sync_fetch_and_sub((ptr), (val))
+#  define __atomic_load_n(ptr, memorder) __sync_fetch_and_add((ptr), 0)
 #  define __atomic_sub_fetch(ptr, val, memorder) __sync_sub_and_fetch((ptr), (val))
 
 HEADER_INLINE uint32_t ATOMIC_COMPARE_EXCHANGE_N_U32(uint32_t* ptr, uint32_t* expected, uint32_t desired, __maybe_unused int weak, __maybe_unused int success_memorder, __maybe_unused int failure_memorder) {
@@ -171,6 +173,11 @@ typedef struct ThreadGroupMainStruct {
   THREAD_FUNCPTR_T(thread_func_ptr);
   pthread_t* threads;
   ThreadGroupFuncArg* thread_args;
+#ifndef _WIN32
+  // Worker-pool slot borrowed by each thread, or UINT32_MAX if it was created
+  // directly.
+  uint32_t* pool_slots;
+#endif
   // Generally favor uint16_t/uint32_t over unsigned char/uint8_t for isolated
   // bools, since in the latter case the compiler is fairly likely to generate
   // worse code due to aliasing paranoia; see e.g.
@@ -314,10 +321,128 @@ HEADER_INLINE void JoinThreads0(ThreadGroup* tg_ptr) {
   }
 }
 
+// Process-wide pool of parked worker threads.  Once InitThreadPool() has been
+// called, SpawnThreads() borrows idle pool workers instead of creating new
+// threads, and the final JoinThreads() returns them to the pool instead of
+// joining them; the ThreadGroup interface is otherwise unchanged.  The pool
+// grows on demand when several thread groups are active at once.  Without
+// InitThreadPool() (or on Windows), every ThreadGroup creates and joins its
+// own threads, as before.
+//
+// Pinning is Linux-only, and ignored elsewhere.
+ENUM_U31_DEF_START()
+  kThreadPinNone,
+  // worker i is pinned to the (i mod n)th CPU in the process's affinity mask
+  kThreadPinCpu,
+  // worker i is pinned to the CPUs of the (i mod n)th NUMA node that
+  // intersects the affinity mask; see ThreadPoolNumaNodeCt()
+  kThreadPinNumaNode
+ENUM_U31_DEF_END(ThreadPinMode);
+
+CONSTI32(kMaxNumaNodes, 64);
+
+// Returns 1 if no worker could be started; SpawnThreads() still works in that
+// case.
+BoolErr InitThreadPool(uint32_t worker_ct, ThreadPinMode pin_mode);
+
+// Number of NUMA nodes the pool's workers are spread across.  This is 1
+// unless the pool was initialized with kThreadPinNumaNode on a multi-node
+// machine.  When it's larger than 1, commands can keep one copy of hot
+// read-only data per node, and CurNumaNode() tells a thread function which
+// copy to read.
+uint32_t ThreadPoolNumaNodeCt();
+
+// Index (in [0, ThreadPoolNumaNodeCt())) of the node the calling thread is
+// running on.  Always 0 when ThreadPoolNumaNodeCt() == 1.
+uint32_t CurNumaNode();
+
+typedef struct ThreadPoolStatsStruct {
+  // Total thread launches by SpawnThreads(), and how many of those were
+  // served by an already-running pool worker.
+  uint64_t launch_ct;
+  uint64_t reuse_ct;
+  // Wall-clock time spent launching threads, including pool startup.
+  uint64_t spawn_ns;
+  uint32_t worker_ct;
+  uint32_t pinned_ct;
+  uint32_t numa_node_ct;
+} ThreadPoolStats;
+
+void GetThreadPoolStats(ThreadPoolStats* statsp);
+
+// Joins all pool workers.  Assumes every ThreadGroup has been cleaned up.
+void CleanupThreadPool();
+
 // This comes in handy a lot in multithreaded error-reporting code when
 // deterministic behavior is desired.
 void UpdateU64IfSmaller(uint64_t newval, uint64_t* oldval_ptr);
 
+// Monotonic wall-clock time in nanoseconds, for throughput reporting.  Only
+// differences between two calls are meaningful.
+HEADER_INLINE uint64_t MonotonicNs() {
+#ifdef _WIN32
+  LARGE_INTEGER freq;
+  LARGE_INTEGER ct;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&ct);
+  return S_CAST(uint64_t, ct.QuadPart / freq.QuadPart) * 1000000000LLU + S_CAST(uint64_t, ct.QuadPart % freq.QuadPart) * 1000000000LLU / S_CAST(uint64_t, freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return S_CAST(uint64_t, ts.tv_sec) * 1000000000LLU + S_CAST(uint64_t, ts.tv_nsec);
+#endif
+}
+
+// Work-stealing scheduler for thread blocks whose items (usually variants) can
+// be processed in any order, with results written to item-indexed locations;
+// output is then independent of which thread handled which item.
+//
+// Each thread starts with an equal contiguous share of [0, item_ct), and takes
+// grain-sized chunks off the front of its own range.  Once that's empty, it
+// steals the back half of the largest remaining range.  Each range is packed
+// into a single 64-bit word and only updated with compare-and-swap, so no
+// locks are needed.
+//
+// Usage: InitTaskDeques() once after SetThreadCt(); ResetTaskDeques() before
+// each SpawnThreads() call; in the thread function,
+//   uint32_t item_start;
+//   uint32_t item_end;
+//   while (TaskDequesNext(tidx, tdqp, &item_start, &item_end)) {
+//     ... // process [item_start, item_end)
+//   }
+// and TaskDequesBlockDone() after each JoinThreads() call.
+typedef struct TaskDequesStruct {
+  // One cacheline per thread.  Word 0 is the thread's remaining range, packed
+  // as (start << 32) | end; word 1 is the time the thread ran out of work in
+  // the current block.
+  uint64_t* slots;
+  uint32_t thread_ct;
+  uint32_t grain;
+  uint64_t block_start_ns;
+
+  // Accumulated by TaskDequesBlockDone(): total time threads spent waiting at
+  // the end-of-block barrier, and total thread-time.
+  uint64_t idle_ns;
+  uint64_t thread_ns;
+} TaskDeques;
+
+HEADER_INLINE uintptr_t TaskDequesAllocCachelineCt(uint32_t thread_ct) {
+  return thread_ct;
+}
+
+// tdq_alloc must be cacheline-aligned, with room for
+// TaskDequesAllocCachelineCt(thread_ct) cachelines.
+void InitTaskDeques(uint32_t thread_ct, unsigned char* tdq_alloc, TaskDeques* tdqp);
+
+// grain must be positive.
+void ResetTaskDeques(uint32_t item_ct, uint32_t grain, TaskDeques* tdqp);
+
+// Returns 0 once no work is left in the current block.  Otherwise,
+// [*item_start_ptr, *item_end_ptr) is nonempty.
+uint32_t TaskDequesNext(uint32_t tidx, TaskDeques* tdqp, uint32_t* item_start_ptr, uint32_t* item_end_ptr);
+
+void TaskDequesBlockDone(TaskDeques* tdqp);
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -1,8 +1,200 @@
 #include "include/pgenlib_read.h"
 #include "include/pgenlib_write.h"
+#include "include/plink2_thread.h"
+
+#include <time.h>
 
 // #define SUBSET_TEST
 
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+// Per-thread .bed output buffer size (x2 for double-buffering) for -u.
+CONSTI32(kDecompressThreadBufBytes, 1 << 22);
+
+uint64_t FileByteCt(const char* fname) {
+  FILE* infile = fopen(fname, FOPEN_RB);
+  if (!infile) {
+    return 0;
+  }
+  uint64_t byte_ct = 0;
+  if (!fseeko(infile, 0, SEEK_END)) {
+    byte_ct = ftello(infile);
+  }
+  fclose(infile);
+  return byte_ct;
+}
+
+void PrintThroughput(const char* verb, uint32_t variant_ct, uint64_t elapsed_ns, uint64_t src_byte_ct, uint64_t dst_byte_ct) {
+  const double secs = S_CAST(double, elapsed_ns) * 1e-9;
+  printf("\r%u variant%s %s in %.3f sec", variant_ct, (variant_ct == 1)? "" : "s", verb, secs);
+  if (secs > 0.0) {
+    printf(" (%.0f variants/sec, %.1f MiB/s in)", S_CAST(double, variant_ct) / secs, S_CAST(double, src_byte_ct) / (1048576.0 * secs));
+  }
+  printf(".\n%.1f MiB -> %.1f MiB", S_CAST(double, src_byte_ct) / 1048576.0, S_CAST(double, dst_byte_ct) / 1048576.0);
+  if (src_byte_ct) {
+    printf(" (%.1f%%)", 100.0 * S_CAST(double, dst_byte_ct) / S_CAST(double, src_byte_ct));
+  }
+  printf(".\n");
+}
+
+typedef struct DecompressCtxStruct {
+  PgenReader* pgrs;
+  unsigned char* thread_bufs;
+  unsigned char* bed_bufs[2];
+  uintptr_t thread_buf_stride;
+  uint32_t sample_ct;
+  uint32_t variant_ct;
+  uint32_t thread_batch_size;
+
+  uint32_t cur_vidx_start;
+  uint32_t parity;
+
+  uint64_t err_info;
+} DecompressCtx;
+
+// Each thread converts a contiguous run of up to thread_batch_size variants
+// to .bed format, in bed_bufs[parity].
+THREAD_FUNC_DECL DecompressThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  DecompressCtx* ctx = S_CAST(DecompressCtx*, arg->sharedp->context);
+
+  PgenReader* pgrp = &(ctx->pgrs[tidx]);
+  uintptr_t* genovec = R_CAST(uintptr_t*, &(ctx->thread_bufs[tidx * ctx->thread_buf_stride]));
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t variant_ct = ctx->variant_ct;
+  const uint32_t thread_batch_size = ctx->thread_batch_size;
+  const uintptr_t final_mask = (k1LU << ((sample_ct % kBitsPerWordD2) * 2)) - k1LU;
+  const uint32_t final_widx = NypCtToWordCt(sample_ct) - 1;
+  const uintptr_t variant_byte_ct = NypCtToByteCt(sample_ct);
+  PgrSampleSubsetIndex pssi;
+  PgrClearSampleSubsetIndex(pgrp, &pssi);
+  do {
+    const uint32_t vidx_start = ctx->cur_vidx_start + tidx * thread_batch_size;
+    if (vidx_start < variant_ct) {
+      const uint32_t vidx_end = MINV(vidx_start + thread_batch_size, variant_ct);
+      unsigned char* bed_iter = &(ctx->bed_bufs[ctx->parity][tidx * thread_batch_size * variant_byte_ct]);
+      for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+        const PglErr reterr = PgrGet(nullptr, pssi, sample_ct, vidx, pgrp, genovec);
+        if (unlikely(reterr)) {
+          UpdateU64IfSmaller((S_CAST(uint64_t, vidx) << 32) | S_CAST(uint32_t, reterr), &ctx->err_info);
+          break;
+        }
+        PgrPlink2ToPlink1InplaceUnsafe(sample_ct, genovec);
+        if (final_mask) {
+          genovec[final_widx] &= final_mask;
+        }
+        bed_iter = memcpyua(bed_iter, genovec, variant_byte_ct);
+      }
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+// Per-thread workspace for CompressThread(): genovec, raregeno,
+// difflist_sample_ids, phasepresent, phaseinfo.
+uintptr_t CompressThreadBufByteCt(uint32_t sample_ct) {
+  const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
+  return NypCtToVecCt(sample_ct) * kBytesPerVec + RoundUpPow2((max_returned_difflist_len + 3) / 4, kCacheline) + RoundUpPow2((max_returned_difflist_len + 1) * sizeof(int32_t), kCacheline) + 2 * BitCtToVecCt(sample_ct) * kBytesPerVec;
+}
+
+typedef struct CompressCtxStruct {
+  const uintptr_t* sample_include;
+  const uint32_t* sample_include_cumulative_popcounts;
+  PgenReader* pgrs;
+  PgenWriterCommon** pwcs;
+  unsigned char* thread_bufs;
+  uintptr_t thread_buf_stride;
+  uint32_t sample_ct;
+  uint32_t variant_ct;
+  uint32_t write_sample_ct;
+  uint32_t pbwt_convert;
+
+  uint32_t cur_vblock_idx_start;
+
+  uint64_t err_info;
+} CompressCtx;
+
+// MTPgenWriter requires thread tidx to fill vblock (cur_vblock_idx_start +
+// tidx).
+THREAD_FUNC_DECL CompressThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  CompressCtx* ctx = S_CAST(CompressCtx*, arg->sharedp->context);
+
+  const uintptr_t* sample_include = ctx->sample_include;
+  PgenReader* pgrp = &(ctx->pgrs[tidx]);
+  PgenWriterCommon* pwcp = ctx->pwcs[tidx];
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
+  unsigned char* thread_buf_iter = &(ctx->thread_bufs[tidx * ctx->thread_buf_stride]);
+  uintptr_t* genovec = R_CAST(uintptr_t*, thread_buf_iter);
+  thread_buf_iter = &(thread_buf_iter[NypCtToVecCt(sample_ct) * kBytesPerVec]);
+  uintptr_t* raregeno = R_CAST(uintptr_t*, thread_buf_iter);
+  thread_buf_iter = &(thread_buf_iter[RoundUpPow2((max_returned_difflist_len + 3) / 4, kCacheline)]);
+  uint32_t* difflist_sample_ids = R_CAST(uint32_t*, thread_buf_iter);
+  thread_buf_iter = &(thread_buf_iter[RoundUpPow2((max_returned_difflist_len + 1) * sizeof(int32_t), kCacheline)]);
+  uintptr_t* phasepresent = R_CAST(uintptr_t*, thread_buf_iter);
+  uintptr_t* phaseinfo = R_CAST(uintptr_t*, &(thread_buf_iter[BitCtToVecCt(sample_ct) * kBytesPerVec]));
+  const uint32_t variant_ct = ctx->variant_ct;
+  const uint32_t write_sample_ct = ctx->write_sample_ct;
+  const uint32_t pbwt_convert = ctx->pbwt_convert;
+  const uint32_t max_simple_difflist_len = sample_ct / kBitsPerWordD2;
+  const uint32_t max_difflist_len = 2 * (write_sample_ct / kPglMaxDifflistLenDivisor);
+  PgrSampleSubsetIndex pssi;
+  PgrSetSampleSubsetIndex(ctx->sample_include_cumulative_popcounts, pgrp, &pssi);
+  do {
+    const uint32_t vidx_start = (ctx->cur_vblock_idx_start + tidx) * kPglVblockSize;
+    if (vidx_start < variant_ct) {
+      const uint32_t vidx_end = MINV(vidx_start + kPglVblockSize, variant_ct);
+      for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+        PglErr reterr;
+        if (pbwt_convert) {
+          uint32_t phasepresent_ct;
+          reterr = PgrGetP(sample_include, pssi, write_sample_ct, vidx, pgrp, genovec, phasepresent, phaseinfo, &phasepresent_ct);
+          if (unlikely(reterr)) {
+            UpdateU64IfSmaller((S_CAST(uint64_t, vidx) << 32) | S_CAST(uint32_t, reterr), &ctx->err_info);
+            break;
+          }
+          ZeroTrailingNyps(write_sample_ct, genovec);
+          if (phasepresent_ct) {
+            PwcAppendBiallelicGenovecHphase(genovec, phasepresent, phaseinfo, pwcp);
+          } else {
+            PwcAppendBiallelicGenovec(genovec, pwcp);
+          }
+          continue;
+        }
+        uint32_t difflist_common_geno;
+        uint32_t difflist_len;
+        reterr = PgrGetDifflistOrGenovec(sample_include, pssi, write_sample_ct, max_simple_difflist_len, vidx, pgrp, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+        if (unlikely(reterr)) {
+          UpdateU64IfSmaller((S_CAST(uint64_t, vidx) << 32) | S_CAST(uint32_t, reterr), &ctx->err_info);
+          break;
+        }
+        if (difflist_common_geno == UINT32_MAX) {
+          ZeroTrailingNyps(write_sample_ct, genovec);
+          PwcAppendBiallelicGenovec(genovec, pwcp);
+        } else if (difflist_len <= max_difflist_len) {
+          ZeroTrailingNyps(difflist_len, raregeno);
+          difflist_sample_ids[difflist_len] = write_sample_ct;
+          PwcAppendBiallelicDifflistLimited(raregeno, difflist_sample_ids, difflist_common_geno, difflist_len, pwcp);
+        } else {
+          PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, write_sample_ct, difflist_len, genovec);
+          ZeroTrailingNyps(write_sample_ct, genovec);
+          PwcAppendBiallelicGenovec(genovec, pwcp);
+        }
+      }
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+#ifdef __cplusplus
+}  // namespace plink2
+#endif
+
 int32_t main(int32_t argc, char** argv) {
 #ifdef __cplusplus
   using namespace plink2;
@@ -12,37 +204,92 @@ int32_t main(int32_t argc, char** argv) {
   unsigned char* pgr_alloc = nullptr;
   unsigned char* spgw_alloc = nullptr;
   uintptr_t* genovec = nullptr;
+  uintptr_t* genovec_block = nullptr;
+  uintptr_t* smaj_tile = nullptr;
+  VecW* transpose_buf = nullptr;
   uintptr_t* raregeno = nullptr;
+  uintptr_t* phasepresent = nullptr;
+  uintptr_t* phaseinfo = nullptr;
   uintptr_t* sample_include = nullptr;
   uint32_t* sample_include_cumulative_popcounts = nullptr;
   uint32_t* difflist_sample_ids = nullptr;
+  unsigned char* zstd_buf = nullptr;
+  uint64_t* zframe_fpos = nullptr;
+  ZSTD_CCtx* cctx = nullptr;
+  FILE* infile = nullptr;
   FILE* outfile = nullptr;
   PgenHeaderCtrl header_ctrl;
   STPgenWriter spgw;
   uint32_t write_sample_ct;
   PgenFileInfo pgfi;
   PgenReader pgr;
+  // -t mode only
+  ThreadGroup tg;
+  PgenReader* pgrs = nullptr;
+  unsigned char* pgrs_alloc = nullptr;
+  unsigned char* thread_bufs = nullptr;
+  unsigned char* bed_bufs = nullptr;
+  unsigned char* mpgw_alloc = nullptr;
+  MTPgenWriter* mpgwp = nullptr;
+  uint32_t calc_thread_ct = 1;
   PreinitPgfi(&pgfi);
   PreinitPgr(&pgr);
   PreinitSpgw(&spgw);
+  PreinitThreads(&tg);
   {
+    uint32_t max_thread_ct = 1;
+    if ((argc >= 3) && (!strcmp(argv[1], "-t"))) {
+      if (ScanPosintDefcap(argv[2], &max_thread_ct)) {
+        fprintf(stderr, "error: invalid thread count\n");
+        goto main_ret_INVALID_CMDLINE;
+      }
+      if (max_thread_ct > kMaxThreads) {
+        max_thread_ct = kMaxThreads;
+      }
+      argc -= 2;
+      argv = &(argv[2]);
+    }
     if ((argc < 3) || (argc > 6)) {
       fputs(
 "Usage:\n"
-"pgen_compress [-i] <input .bed or .pgen> <output filename> [sample_ct]\n"
+"pgen_compress [-t <thread_ct>] [-i] <input .bed or .pgen> <output filename>\n"
+"              [sample_ct]\n"
 "  * sample_ct is required when loading a .bed file\n"
 "  * -i causes the index to be saved to a separate .pgen.pgi file (usually it's\n"
 "    embedded at the front of the .pgen); this is compatible with fully\n"
 "    sequential .pgen writing\n"
-"pgen_compress -u <input .pgen> <output .bed>\n"
+"  * -t (which must come first) sets the number of threads used for\n"
+"    compression (via MTPgenWriter, one 65536-variant block per thread at a\n"
+"    time) and -u decoding.  Defaults to 1.\n"
+"pgen_compress [-t <thread_ct>] -u <input .pgen> <output .bed>\n"
+"pgen_compress -s <input .bed or .pgen> <output .pgen.smaj> [sample_ct]\n"
+"  * -s writes a sample-major companion file, for fast extraction of all\n"
+"    hardcalls for a few samples (see SmajGet()).  plink2 --export\n"
+"    ind-major-bed reads <.pgen filename>.smaj when it's up to date.\n"
+"pgen_compress -z <input .pgen> <output .pgen> [zstd level]\n"
+"  * -z converts a mode-0x10 .pgen to mode 0x82, where each 65536-variant block\n"
+"    of variant records is a separately-seekable zstd frame (a mode-0x84 input\n"
+"    becomes mode 0x86)\n"
+"pgen_compress -p <input .pgen> <output .pgen>\n"
+"  * -p writes a mode-0x84 .pgen, where biallelic hardcall-phase tracks are\n"
+"    stored as PBWT run lengths when that's smaller.  Input must be\n"
+"    biallelic and dosage-free.\n"
+"pgen_compress -w <input .bed or .pgen> <output .pgen> [sample_ct]\n"
+"  * -w writes a mode-0x88 .pgen, where each LD-compressed variant record can\n"
+"    refer to any of the last 8 non-LD-compressed variants in its block\n"
             , stdout);
       goto main_ret_INVALID_CMDLINE;
     }
     const uint32_t write_separate_index = (argv[1][0] == '-') && (argv[1][1] == 'i') && (argv[1][2] == '\0');
     const uint32_t decompress = (argv[1][0] == '-') && (argv[1][1] == 'u') && (argv[1][2] == '\0');
-    const uint32_t input_idx = 1 + write_separate_index + decompress;
+    const uint32_t sample_major = (argv[1][0] == '-') && (argv[1][1] == 's') && (argv[1][2] == '\0');
+    const uint32_t zstd_convert = (argv[1][0] == '-') && (argv[1][1] == 'z') && (argv[1][2] == '\0');
+    const uint32_t pbwt_convert = (argv[1][0] == '-') && (argv[1][1] == 'p') && (argv[1][2] == '\0');
+    const uint32_t ldwin_convert = (argv[1][0] == '-') && (argv[1][1] == 'w') && (argv[1][2] == '\0');
+    const uint32_t input_idx = 1 + write_separate_index + decompress + sample_major + zstd_convert + pbwt_convert + ldwin_convert;
+    const uint32_t is_compress = !(decompress || sample_major || zstd_convert);
     uint32_t sample_ct = 0xffffffffU;
-    if (S_CAST(uint32_t, argc) == input_idx + 3) {
+    if ((S_CAST(uint32_t, argc) == input_idx + 3) && (!zstd_convert) && (!pbwt_convert)) {
       if (ScanPosintDefcap(argv[input_idx + 2], &sample_ct)) {
         fprintf(stderr, "error: invalid sample_ct\n");
         goto main_ret_INVALID_CMDLINE;
@@ -75,7 +322,8 @@ int32_t main(int32_t argc, char** argv) {
       fputs(errstr_buf, stderr);
       goto main_ret_1;
     }
-    if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &pgr_alloc)) {
+    const uintptr_t pgr_alloc_cacheline_ct = cur_alloc_cacheline_ct;
+    if (cachealigned_malloc(pgr_alloc_cacheline_ct * kCacheline, &pgr_alloc)) {
       goto main_ret_NOMEM;
     }
 
@@ -85,42 +333,216 @@ int32_t main(int32_t argc, char** argv) {
       fprintf(stderr, "PgrInit error %u\n", S_CAST(uint32_t, reterr));
       goto main_ret_1;
     }
-
-    if (S_CAST(uint32_t, argc) == input_idx + 3) {
+    if ((S_CAST(uint32_t, argc) == input_idx + 3) && (!zstd_convert) && (!pbwt_convert)) {
       printf("%u variant%s detected.\n", variant_ct, (variant_ct == 1)? "" : "s");
     } else {
       printf("%u variant%s and %u sample%s detected.\n", variant_ct, (variant_ct == 1)? "" : "s", sample_ct, (sample_ct == 1)? "" : "s");
     }
+    // Compression threads each handle one vblock at a time; -u threads each
+    // handle up to kDecompressThreadBufBytes of .bed output.
+    const uint32_t decompress_thread_batch_size = MAXV(1, MINV(kPglVblockSize, kDecompressThreadBufBytes / NypCtToByteCt(sample_ct)));
+    if (is_compress) {
+      calc_thread_ct = MINV(max_thread_ct, DivUp(variant_ct, kPglVblockSize));
+    } else if (decompress) {
+      calc_thread_ct = MINV(max_thread_ct, DivUp(variant_ct, decompress_thread_batch_size));
+    }
+    if (calc_thread_ct > 1) {
+      // Each thread gets its own reader.  pgr is left idle.
+      pgrs = S_CAST(PgenReader*, malloc(calc_thread_ct * sizeof(PgenReader)));
+      if (!pgrs) {
+        goto main_ret_NOMEM;
+      }
+      for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+        PreinitPgr(&(pgrs[tidx]));
+      }
+      if (cachealigned_malloc(calc_thread_ct * pgr_alloc_cacheline_ct * kCacheline, &pgrs_alloc)) {
+        goto main_ret_NOMEM;
+      }
+      for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+        reterr = PgrInit(argv[input_idx], max_vrec_width, &pgfi, &(pgrs[tidx]), &(pgrs_alloc[tidx * pgr_alloc_cacheline_ct * kCacheline]));
+        if (reterr) {
+          fprintf(stderr, "PgrInit error %u\n", S_CAST(uint32_t, reterr));
+          goto main_ret_1;
+        }
+      }
+      if (SetThreadCt(calc_thread_ct, &tg)) {
+        goto main_ret_NOMEM;
+      }
+      printf("Using %u threads.\n", calc_thread_ct);
+    }
     if (cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &genovec)) {
       goto main_ret_NOMEM;
     }
     if (decompress) {
-      outfile = fopen(argv[3], FOPEN_WB);
+      outfile = fopen(argv[input_idx + 1], FOPEN_WB);
       if (!outfile) {
         goto main_ret_OPEN_FAIL;
       }
+      const uintptr_t variant_byte_ct = NypCtToByteCt(sample_ct);
+      fwrite("l\x1b\x01", 3, 1, outfile);
+      const uint64_t start_ns = MonotonicNs();
+      if (calc_thread_ct > 1) {
+        const uintptr_t thread_buf_stride = NypCtToVecCt(sample_ct) * kBytesPerVec;
+        const uintptr_t bed_buf_byte_ct = calc_thread_ct * decompress_thread_batch_size * variant_byte_ct;
+        if (cachealigned_malloc(calc_thread_ct * thread_buf_stride, &thread_bufs) ||
+            cachealigned_malloc(2 * bed_buf_byte_ct, &bed_bufs)) {
+          goto main_ret_NOMEM;
+        }
+        DecompressCtx ctx;
+        ctx.pgrs = pgrs;
+        ctx.thread_bufs = thread_bufs;
+        ctx.bed_bufs[0] = bed_bufs;
+        ctx.bed_bufs[1] = &(bed_bufs[bed_buf_byte_ct]);
+        ctx.thread_buf_stride = thread_buf_stride;
+        ctx.sample_ct = sample_ct;
+        ctx.variant_ct = variant_ct;
+        ctx.thread_batch_size = decompress_thread_batch_size;
+        ctx.err_info = (~0LLU) << 32;
+        SetThreadFuncAndData(DecompressThread, &ctx, &tg);
+        const uint32_t batch_size = calc_thread_ct * decompress_thread_batch_size;
+        // Write batch n while batch (n+1) is being decoded.
+        uint32_t vidx_start = 0;
+        uint32_t prev_batch_vidx_ct = 0;
+        for (uint32_t parity = 0; ; parity = 1 - parity) {
+          if (prev_batch_vidx_ct) {
+            JoinThreads(&tg);
+            if (ctx.err_info != ((~0LLU) << 32)) {
+              reterr = S_CAST(PglErr, ctx.err_info & UINT32_MAX);
+              fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), S_CAST(uint32_t, ctx.err_info >> 32));
+              goto main_ret_1;
+            }
+          }
+          const uint32_t cur_batch_vidx_ct = MINV(variant_ct - vidx_start, batch_size);
+          if (cur_batch_vidx_ct) {
+            ctx.cur_vidx_start = vidx_start;
+            ctx.parity = parity;
+            if (vidx_start + cur_batch_vidx_ct == variant_ct) {
+              DeclareLastThreadBlock(&tg);
+            }
+            if (SpawnThreads(&tg)) {
+              goto main_ret_THREAD_CREATE_FAIL;
+            }
+          }
+          if (prev_batch_vidx_ct) {
+            if (fwrite_checked(ctx.bed_bufs[1 - parity], prev_batch_vidx_ct * variant_byte_ct, outfile)) {
+              goto main_ret_WRITE_FAIL;
+            }
+            printf("\r%u/%u variants decompressed.", vidx_start, variant_ct);
+            fflush(stdout);
+          }
+          if (!cur_batch_vidx_ct) {
+            break;
+          }
+          vidx_start += cur_batch_vidx_ct;
+          prev_batch_vidx_ct = cur_batch_vidx_ct;
+        }
+      } else {
+        PgrSampleSubsetIndex pssi;
+        PgrClearSampleSubsetIndex(&pgr, &pssi);
+        const uintptr_t final_mask = (k1LU << ((sample_ct % kBitsPerWordD2) * 2)) - k1LU;
+        const uint32_t final_widx = NypCtToWordCt(sample_ct) - 1;
+        for (uint32_t vidx = 0; vidx < variant_ct; ) {
+          reterr = PgrGet(nullptr, pssi, sample_ct, vidx, &pgr, genovec);
+          if (reterr) {
+            fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+            goto main_ret_1;
+          }
+          PgrPlink2ToPlink1InplaceUnsafe(sample_ct, genovec);
+          if (final_mask) {
+            genovec[final_widx] &= final_mask;
+          }
+          fwrite(genovec, variant_byte_ct, 1, outfile);
+          ++vidx;
+          if (!(vidx % 100000)) {
+            printf("\r%u.%um variants decompressed.", vidx / 1000000, (vidx / 100000) % 10);
+            fflush(stdout);
+          }
+        }
+      }
+      if (fclose_null(&outfile)) {
+        goto main_ret_WRITE_FAIL;
+      }
+      PrintThroughput("decompressed", variant_ct, MonotonicNs() - start_ns, FileByteCt(argv[input_idx]), 3 + variant_ct * S_CAST(uint64_t, variant_byte_ct));
+      goto main_ret_1;
+    }
+    if (sample_major) {
+      // Keep the tile buffer (one vblock across all samples) within ~1 GiB.
+      uint32_t vblock_size = kPglVblockSize;
+      while ((vblock_size > kPglSmajVblockAlign) && (S_CAST(uint64_t, sample_ct) * (vblock_size / 4) > (1LLU << 30))) {
+        vblock_size /= 2;
+      }
+      const uint32_t vblock_ct = DivUp(variant_ct, vblock_size);
+      const uintptr_t genovec_word_stride = NypCtToVecCt(sample_ct) * kWordsPerVec;
+      const uintptr_t tile_word_stride = vblock_size / kBitsPerWordD2;
+      // TransposeNypblock() may write up to 3 rows past the end of a partial
+      // sample batch.
+      if (cachealigned_malloc(kPglNypTransposeBatch * genovec_word_stride * sizeof(intptr_t), &genovec_block) ||
+          cachealigned_malloc(RoundUpPow2(sample_ct, 4) * tile_word_stride * sizeof(intptr_t), &smaj_tile) ||
+          cachealigned_malloc(kPglNypTransposeBufbytes, &transpose_buf)) {
+        goto main_ret_NOMEM;
+      }
+      outfile = fopen(argv[input_idx + 1], FOPEN_WB);
+      if (!outfile) {
+        goto main_ret_OPEN_FAIL;
+      }
+      unsigned char header_buf[kPglSmajHeaderBlen];
+      memcpy(header_buf, "l\x1b\x40", 3);
+      header_buf[3] = 0;
+      memcpy(&(header_buf[4]), &variant_ct, sizeof(int32_t));
+      memcpy(&(header_buf[8]), &sample_ct, sizeof(int32_t));
+      memcpy(&(header_buf[12]), &vblock_size, sizeof(int32_t));
+      reterr = SmajGetPgenKey(argv[input_idx], &(header_buf[16]), errstr_buf);
+      if (reterr) {
+        fputs(errstr_buf, stderr);
+        goto main_ret_1;
+      }
+      fwrite(header_buf, kPglSmajHeaderBlen, 1, outfile);
+      uint64_t vblock_fpos = kPglSmajHeaderBlen + (vblock_ct + 1) * S_CAST(uint64_t, sizeof(int64_t));
+      for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
+        fwrite(&vblock_fpos, sizeof(int64_t), 1, outfile);
+        const uint32_t cur_vblock_size = MINV(vblock_size, variant_ct - vblock_idx * vblock_size);
+        vblock_fpos += S_CAST(uint64_t, sample_ct) * NypCtToByteCt(cur_vblock_size);
+      }
+      fwrite(&vblock_fpos, sizeof(int64_t), 1, outfile);
       PgrSampleSubsetIndex pssi;
       PgrClearSampleSubsetIndex(&pgr, &pssi);
-      const uintptr_t final_mask = (k1LU << ((sample_ct % kBitsPerWordD2) * 2)) - k1LU;
-      const uint32_t final_widx = NypCtToWordCt(sample_ct) - 1;
-      const uint32_t variant_byte_ct = (sample_ct + 3) / 4;
-      fwrite("l\x1b\x01", 3, 1, outfile);
-      for (uint32_t vidx = 0; vidx < variant_ct; ) {
-        reterr = PgrGet(nullptr, pssi, sample_ct, vidx, &pgr, genovec);
-        if (reterr) {
-          fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
-          goto main_ret_1;
+      const uint32_t sample_batch_ct = DivUp(sample_ct, kPglNypTransposeBatch);
+      for (uint32_t vblock_vidx_start = 0; vblock_vidx_start < variant_ct; vblock_vidx_start += vblock_size) {
+        const uint32_t vblock_vidx_end = MINV(vblock_vidx_start + vblock_size, variant_ct);
+        uintptr_t* tile_col_iter = smaj_tile;
+        for (uint32_t batch_vidx_start = vblock_vidx_start; batch_vidx_start < vblock_vidx_end; batch_vidx_start += kPglNypTransposeBatch) {
+          const uint32_t batch_vidx_end = MINV(batch_vidx_start + kPglNypTransposeBatch, vblock_vidx_end);
+          reterr = PgrGetBlock(nullptr, pssi, sample_ct, batch_vidx_start, batch_vidx_end, &pgr, genovec_word_stride, genovec_block);
+          if (reterr) {
+            fprintf(stderr, "\nread error %u, vidx=%u..%u\n", S_CAST(uint32_t, reterr), batch_vidx_start, batch_vidx_end - 1);
+            goto main_ret_1;
+          }
+          uint32_t sample_batch_size = kPglNypTransposeBatch;
+          for (uint32_t sample_batch_idx = 0; sample_batch_idx != sample_batch_ct; ++sample_batch_idx) {
+            if (sample_batch_idx == sample_batch_ct - 1) {
+              sample_batch_size = ModNz(sample_ct, kPglNypTransposeBatch);
+            }
+            TransposeNypblock(&(genovec_block[sample_batch_idx * kPglNypTransposeWords]), genovec_word_stride, tile_word_stride, batch_vidx_end - batch_vidx_start, sample_batch_size, &(tile_col_iter[sample_batch_idx * kPglNypTransposeBatch * tile_word_stride]), transpose_buf);
+          }
+          tile_col_iter = &(tile_col_iter[kPglNypTransposeWords]);
         }
-        PgrPlink2ToPlink1InplaceUnsafe(sample_ct, genovec);
-        if (final_mask) {
-          genovec[final_widx] &= final_mask;
+        const uint32_t cur_vblock_size = vblock_vidx_end - vblock_vidx_start;
+        const uintptr_t row_byte_ct = NypCtToByteCt(cur_vblock_size);
+        if (cur_vblock_size == vblock_size) {
+          fwrite(smaj_tile, sample_ct * row_byte_ct, 1, outfile);
+        } else {
+          uintptr_t* tile_row_iter = smaj_tile;
+          for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+            ZeroTrailingNyps(cur_vblock_size, tile_row_iter);
+            fwrite(tile_row_iter, row_byte_ct, 1, outfile);
+            tile_row_iter = &(tile_row_iter[tile_word_stride]);
+          }
         }
-        fwrite(genovec, variant_byte_ct, 1, outfile);
-        ++vidx;
-        if (!(vidx % 100000)) {
-          printf("\r%u.%um variants decompressed.", vidx / 1000000, (vidx / 100000) % 10);
-          fflush(stdout);
+        if (ferror_unlocked(outfile)) {
+          goto main_ret_WRITE_FAIL;
         }
+        printf("\r%u/%u variants transposed.", vblock_vidx_end, variant_ct);
+        fflush(stdout);
       }
       if (fclose_null(&outfile)) {
         goto main_ret_WRITE_FAIL;
@@ -128,6 +550,106 @@ int32_t main(int32_t argc, char** argv) {
       printf("\n");
       goto main_ret_1;
     }
+    if (zstd_convert) {
+      int32_t level = ZSTD_CLEVEL_DEFAULT;
+      if (S_CAST(uint32_t, argc) == input_idx + 3) {
+        uint32_t level_u32;
+        if (ScanPosintDefcap(argv[input_idx + 2], &level_u32) || (level_u32 > S_CAST(uint32_t, ZSTD_maxCLevel()))) {
+          fprintf(stderr, "error: invalid zstd level\n");
+          goto main_ret_INVALID_CMDLINE;
+        }
+        level = level_u32;
+      }
+      // Header bytes are copied verbatim, apart from the mode byte and the
+      // vblock index (which gains an extra entry).
+      const uint64_t* var_fpos = pgfi.var_fpos;
+      const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+      const uint64_t header_byte_ct = var_fpos? var_fpos[0] : 0;
+      const uintptr_t inbuf_size = ZSTD_CStreamInSize();
+      const uintptr_t outbuf_size = ZSTD_CStreamOutSize();
+      infile = fopen(argv[input_idx], FOPEN_RB);
+      if (!infile) {
+        goto main_ret_OPEN_FAIL;
+      }
+      zstd_buf = S_CAST(unsigned char*, malloc(MAXV(header_byte_ct, inbuf_size) + outbuf_size));
+      zframe_fpos = S_CAST(uint64_t*, malloc((vblock_ct + 1) * sizeof(int64_t)));
+      cctx = ZSTD_createCCtx();
+      if ((!zstd_buf) || (!zframe_fpos) || (!cctx)) {
+        goto main_ret_NOMEM;
+      }
+      unsigned char* outbuf = &(zstd_buf[MAXV(header_byte_ct, inbuf_size)]);
+      if ((!var_fpos) || (!fread_unlocked(zstd_buf, header_byte_ct, 1, infile)) || ((zstd_buf[2] != 0x10) && (((zstd_buf[2] & 0xf3) != 0x80) || (zstd_buf[2] == 0x80)))) {
+        fprintf(stderr, "error: -z requires a mode 0x10, 0x84, 0x88, or 0x8c .pgen input\n");
+        goto main_ret_INVALID_CMDLINE;
+      }
+      if (ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level)) ||
+          ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1))) {
+        goto main_ret_NOMEM;
+      }
+      outfile = fopen(argv[input_idx + 1], FOPEN_WB);
+      if (!outfile) {
+        goto main_ret_OPEN_FAIL;
+      }
+      zstd_buf[2] = (zstd_buf[2] == 0x10)? 0x82 : (zstd_buf[2] + 2);
+      const uint64_t old_index_end = 12 + vblock_ct * S_CAST(uint64_t, sizeof(int64_t));
+      fwrite(zstd_buf, 12, 1, outfile);
+      // placeholder, filled in at the end
+      memset(zframe_fpos, 0, (vblock_ct + 1) * sizeof(int64_t));
+      fwrite(zframe_fpos, (vblock_ct + 1) * sizeof(int64_t), 1, outfile);
+      fwrite(&(zstd_buf[old_index_end]), header_byte_ct - old_index_end, 1, outfile);
+      zframe_fpos[0] = header_byte_ct + sizeof(int64_t);
+      for (uint32_t vblock_idx = 0; vblock_idx != vblock_ct; ++vblock_idx) {
+        const uint64_t src_start = var_fpos[vblock_idx * kPglVblockSize];
+        uint64_t src_remaining = var_fpos[MINV((vblock_idx + 1) * kPglVblockSize, variant_ct)] - src_start;
+        if (fseeko(infile, src_start, SEEK_SET)) {
+          goto main_ret_READ_FAIL;
+        }
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+        ZSTD_CCtx_setPledgedSrcSize(cctx, src_remaining);
+        do {
+          const uintptr_t cur_read_size = MINV(src_remaining, inbuf_size);
+          if (cur_read_size && (!fread_unlocked(zstd_buf, cur_read_size, 1, infile))) {
+            goto main_ret_READ_FAIL;
+          }
+          src_remaining -= cur_read_size;
+          const ZSTD_EndDirective end_op = src_remaining? ZSTD_e_continue : ZSTD_e_end;
+          ZSTD_inBuffer zib = {zstd_buf, cur_read_size, 0};
+          uint32_t finished;
+          do {
+            ZSTD_outBuffer zob = {outbuf, outbuf_size, 0};
+            const uintptr_t zret = ZSTD_compressStream2(cctx, &zob, &zib, end_op);
+            if (ZSTD_isError(zret)) {
+              fprintf(stderr, "\nzstd error: %s\n", ZSTD_getErrorName(zret));
+              reterr = kPglRetInternalError;
+              goto main_ret_1;
+            }
+            fwrite(outbuf, zob.pos, 1, outfile);
+            finished = src_remaining? (zib.pos == zib.size) : (!zret);
+          } while (!finished);
+        } while (src_remaining);
+        if (ferror_unlocked(outfile)) {
+          goto main_ret_WRITE_FAIL;
+        }
+        zframe_fpos[vblock_idx + 1] = ftello(outfile);
+        printf("\r%u/%u variant blocks compressed.", vblock_idx + 1, vblock_ct);
+        fflush(stdout);
+      }
+      if (fseeko(outfile, 12, SEEK_SET)) {
+        goto main_ret_WRITE_FAIL;
+      }
+      fwrite(zframe_fpos, (vblock_ct + 1) * sizeof(int64_t), 1, outfile);
+      if (fclose_null(&outfile)) {
+        goto main_ret_WRITE_FAIL;
+      }
+      const uint64_t src_byte_ct = var_fpos[variant_ct] - header_byte_ct;
+      const uint64_t dst_byte_ct = zframe_fpos[vblock_ct] - zframe_fpos[0];
+      printf("\nVariant records: %.1f MiB -> %.1f MiB", S_CAST(double, src_byte_ct) / 1048576.0, S_CAST(double, dst_byte_ct) / 1048576.0);
+      if (src_byte_ct) {
+        printf(" (%.1f%%)", 100.0 * S_CAST(double, dst_byte_ct) / S_CAST(double, src_byte_ct));
+      }
+      printf("\n");
+      goto main_ret_1;
+    }
 #ifdef SUBSET_TEST
     // write_sample_ct = sample_ct - 3;
     write_sample_ct = 3;
@@ -139,24 +661,25 @@ int32_t main(int32_t argc, char** argv) {
     // Also demonstrate automatic 8-bit -> 4-bit index compaction when
     // write_separate_index is true, we declare that hardcall-phase is present,
     // but we never write any hardcall-phase data.
-    uint32_t max_vrec_len;
-    reterr = SpgwInitPhase1(argv[input_idx + 1], nullptr, nullptr, write_separate_index? (variant_ct * 2) : variant_ct, write_sample_ct, 0, write_separate_index? kPgenWriteSeparateIndex : kPgenWriteBackwardSeek, write_separate_index? kfPgenGlobalHardcallPhasePresent : kfPgenGlobal0, 2, &spgw, &cur_alloc_cacheline_ct, &max_vrec_len);
-    if (reterr) {
-      fprintf(stderr, "compression phase 1 error %u\n", S_CAST(uint32_t, reterr));
-      goto main_ret_1;
-    }
-    if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &spgw_alloc)) {
-      goto main_ret_NOMEM;
+    PgenGlobalFlags write_gflags = write_separate_index? kfPgenGlobalHardcallPhasePresent : kfPgenGlobal0;
+    if (pbwt_convert) {
+      if (pgfi.gflags & (kfPgenGlobalMultiallelicHardcallFound | kfPgenGlobalDosagePresent)) {
+        fprintf(stderr, "error: -p requires a biallelic, dosage-free .pgen input\n");
+        goto main_ret_INVALID_CMDLINE;
+      }
+      write_gflags = kfPgenGlobalHardcallPhasePresent | kfPgenGlobalPbwtHphase;
+    } else if (ldwin_convert) {
+      write_gflags = kfPgenGlobalLdWindow;
     }
-    SpgwInitPhase2(max_vrec_len, &spgw, spgw_alloc);
-
     const uint32_t max_simple_difflist_len = sample_ct / kBitsPerWordD2;
     const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
     const uint32_t max_difflist_len = 2 * (write_sample_ct / kPglMaxDifflistLenDivisor);
     if (cachealigned_malloc(RoundUpPow2((max_returned_difflist_len + 3) / 4, kCacheline), &raregeno) ||
         cachealigned_malloc(RoundUpPow2((sample_ct + 7) / 8, kCacheline), &sample_include) ||
         cachealigned_malloc(RoundUpPow2((1 + (sample_ct / kBitsPerWord)) * sizeof(int32_t), kCacheline), &sample_include_cumulative_popcounts) ||
-        cachealigned_malloc(RoundUpPow2((max_returned_difflist_len + 1) * sizeof(int32_t), kCacheline), &difflist_sample_ids)) {
+        cachealigned_malloc(RoundUpPow2((max_returned_difflist_len + 1) * sizeof(int32_t), kCacheline), &difflist_sample_ids) ||
+        cachealigned_malloc(BitCtToVecCt(sample_ct) * kBytesPerVec, &phasepresent) ||
+        cachealigned_malloc(BitCtToVecCt(sample_ct) * kBytesPerVec, &phaseinfo)) {
       goto main_ret_NOMEM;
     }
 #ifdef SUBSET_TEST
@@ -171,42 +694,159 @@ int32_t main(int32_t argc, char** argv) {
     SetAllBits(sample_ct, sample_include);
 #endif
     FillCumulativePopcounts(sample_include, 1 + (sample_ct / kBitsPerWord), sample_include_cumulative_popcounts);
-    PgrSampleSubsetIndex pssi;
-    PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, &pgr, &pssi);
-    for (uint32_t vidx = 0; vidx < variant_ct; ) {
-      uint32_t difflist_common_geno;
-      uint32_t difflist_len;
-      reterr = PgrGetDifflistOrGenovec(sample_include, pssi, write_sample_ct, max_simple_difflist_len, vidx, &pgr, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+    const uint64_t start_ns = MonotonicNs();
+    if (calc_thread_ct > 1) {
+      // MTPgenWriter needs the exact variant count, so the
+      // variant_ct_limit-overestimate demonstration is skipped here.
+      uintptr_t alloc_base_cacheline_ct;
+      uint64_t mpgw_per_thread_cacheline_ct;
+      uint32_t vrec_len_byte_ct;
+      uint64_t vblock_cacheline_ct;
+      MpgwInitPhase1(nullptr, variant_ct, write_sample_ct, write_gflags, &alloc_base_cacheline_ct, &mpgw_per_thread_cacheline_ct, &vrec_len_byte_ct, &vblock_cacheline_ct);
+      mpgwp = S_CAST(MTPgenWriter*, malloc(sizeof(MTPgenWriter) + calc_thread_ct * sizeof(intptr_t)));
+      if (!mpgwp) {
+        goto main_ret_NOMEM;
+      }
+      PreinitMpgw(mpgwp);
+      const uintptr_t thread_buf_stride = CompressThreadBufByteCt(sample_ct);
+      if (cachealigned_malloc((alloc_base_cacheline_ct + mpgw_per_thread_cacheline_ct * calc_thread_ct) * kCacheline, &mpgw_alloc) ||
+          cachealigned_malloc(calc_thread_ct * thread_buf_stride, &thread_bufs)) {
+        fprintf(stderr, "error: insufficient memory for %u compression threads\n", calc_thread_ct);
+        goto main_ret_NOMEM;
+      }
+      reterr = MpgwInitPhase2(argv[input_idx + 1], nullptr, variant_ct, write_sample_ct, write_separate_index? kPgenWriteSeparateIndex : kPgenWriteBackwardSeek, write_gflags, 2, vrec_len_byte_ct, vblock_cacheline_ct, calc_thread_ct, mpgw_alloc, mpgwp);
       if (reterr) {
-        fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+        fprintf(stderr, "compression phase 2 error %u\n", S_CAST(uint32_t, reterr));
         goto main_ret_1;
       }
-      if (difflist_common_geno == 0xffffffffU) {
-        ZeroTrailingBits(write_sample_ct * 2, genovec);
-        reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
-      } else if (difflist_len <= max_difflist_len) {
-        ZeroTrailingBits(2 * difflist_len, raregeno);
-        difflist_sample_ids[difflist_len] = write_sample_ct;
-        reterr = SpgwAppendBiallelicDifflistLimited(raregeno, difflist_sample_ids, difflist_common_geno, difflist_len, &spgw);
-      } else {
-        PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, write_sample_ct, difflist_len, genovec);
-        ZeroTrailingBits(write_sample_ct * 2, genovec);
-        reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
+      CompressCtx ctx;
+      ctx.sample_include = sample_include;
+      ctx.sample_include_cumulative_popcounts = sample_include_cumulative_popcounts;
+      ctx.pgrs = pgrs;
+      ctx.pwcs = mpgwp->pwcs;
+      ctx.thread_bufs = thread_bufs;
+      ctx.thread_buf_stride = thread_buf_stride;
+      ctx.sample_ct = sample_ct;
+      ctx.variant_ct = variant_ct;
+      ctx.write_sample_ct = write_sample_ct;
+      ctx.pbwt_convert = pbwt_convert;
+      ctx.err_info = (~0LLU) << 32;
+      SetThreadFuncAndData(CompressThread, &ctx, &tg);
+      const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+      for (uint32_t vblock_idx_start = 0; ; ) {
+        ctx.cur_vblock_idx_start = vblock_idx_start;
+        vblock_idx_start += calc_thread_ct;
+        if (vblock_idx_start >= vblock_ct) {
+          DeclareLastThreadBlock(&tg);
+        }
+        if (SpawnThreads(&tg)) {
+          goto main_ret_THREAD_CREATE_FAIL;
+        }
+        JoinThreads(&tg);
+        if (ctx.err_info != ((~0LLU) << 32)) {
+          reterr = S_CAST(PglErr, ctx.err_info & UINT32_MAX);
+          fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), S_CAST(uint32_t, ctx.err_info >> 32));
+          goto main_ret_1;
+        }
+        // Last flush also backfills the header and closes the file.
+        reterr = MpgwFlush(mpgwp);
+        if (reterr) {
+          fprintf(stderr, "\ncompress/write error %u\n", S_CAST(uint32_t, reterr));
+          goto main_ret_1;
+        }
+        if (vblock_idx_start >= vblock_ct) {
+          break;
+        }
+        printf("\r%u/%u variants compressed.", vblock_idx_start * kPglVblockSize, variant_ct);
+        fflush(stdout);
       }
+    } else {
+      uint32_t max_vrec_len;
+      reterr = SpgwInitPhase1(argv[input_idx + 1], nullptr, nullptr, write_separate_index? (variant_ct * 2) : variant_ct, write_sample_ct, 0, write_separate_index? kPgenWriteSeparateIndex : kPgenWriteBackwardSeek, write_gflags, 2, &spgw, &cur_alloc_cacheline_ct, &max_vrec_len);
       if (reterr) {
-        fprintf(stderr, "\ncompress/write error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+        fprintf(stderr, "compression phase 1 error %u\n", S_CAST(uint32_t, reterr));
         goto main_ret_1;
       }
-      ++vidx;
-      if (!(vidx % 100000)) {
-        printf("\r%u.%um variants compressed.", vidx / 1000000, (vidx / 100000) % 10);
-        fflush(stdout);
+      if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &spgw_alloc)) {
+        goto main_ret_NOMEM;
       }
+      SpgwInitPhase2(max_vrec_len, &spgw, spgw_alloc);
+
+      PgrSampleSubsetIndex pssi;
+      PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, &pgr, &pssi);
+      for (uint32_t vidx = 0; vidx < variant_ct; ) {
+        if (pbwt_convert) {
+          uint32_t phasepresent_ct;
+          reterr = PgrGetP(sample_include, pssi, write_sample_ct, vidx, &pgr, genovec, phasepresent, phaseinfo, &phasepresent_ct);
+          if (reterr) {
+            fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+            goto main_ret_1;
+          }
+          ZeroTrailingNyps(write_sample_ct, genovec);
+          if (phasepresent_ct) {
+            reterr = SpgwAppendBiallelicGenovecHphase(genovec, phasepresent, phaseinfo, &spgw);
+          } else {
+            reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
+          }
+          if (reterr) {
+            fprintf(stderr, "\ncompress/write error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+            goto main_ret_1;
+          }
+          ++vidx;
+          if (!(vidx % 100000)) {
+            printf("\r%u.%um variants compressed.", vidx / 1000000, (vidx / 100000) % 10);
+            fflush(stdout);
+          }
+          continue;
+        }
+        uint32_t difflist_common_geno;
+        uint32_t difflist_len;
+        reterr = PgrGetDifflistOrGenovec(sample_include, pssi, write_sample_ct, max_simple_difflist_len, vidx, &pgr, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+        if (reterr) {
+          fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+          goto main_ret_1;
+        }
+        if (difflist_common_geno == 0xffffffffU) {
+          ZeroTrailingBits(write_sample_ct * 2, genovec);
+          reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
+        } else if (difflist_len <= max_difflist_len) {
+          ZeroTrailingBits(2 * difflist_len, raregeno);
+          difflist_sample_ids[difflist_len] = write_sample_ct;
+          reterr = SpgwAppendBiallelicDifflistLimited(raregeno, difflist_sample_ids, difflist_common_geno, difflist_len, &spgw);
+        } else {
+          PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, write_sample_ct, difflist_len, genovec);
+          ZeroTrailingBits(write_sample_ct * 2, genovec);
+          reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
+        }
+        if (reterr) {
+          fprintf(stderr, "\ncompress/write error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+          goto main_ret_1;
+        }
+        ++vidx;
+        if (!(vidx % 100000)) {
+          printf("\r%u.%um variants compressed.", vidx / 1000000, (vidx / 100000) % 10);
+          fflush(stdout);
+        }
+      }
+      reterr = SpgwFinish(&spgw);
+      if (reterr) {
+        goto main_ret_1;
+      }
+    }
+    const uint64_t elapsed_ns = MonotonicNs() - start_ns;
+    uint64_t dst_byte_ct = FileByteCt(argv[input_idx + 1]);
+    if (write_separate_index) {
+      const uint32_t outname_slen = strlen(argv[input_idx + 1]);
+      char* pgi_name = S_CAST(char*, malloc(outname_slen + 5));
+      if (!pgi_name) {
+        goto main_ret_NOMEM;
+      }
+      snprintf(pgi_name, outname_slen + 5, "%s.pgi", argv[input_idx + 1]);
+      dst_byte_ct += FileByteCt(pgi_name);
+      free(pgi_name);
     }
+    PrintThroughput("compressed", variant_ct, elapsed_ns, FileByteCt(argv[input_idx]), dst_byte_ct);
   }
-  printf("\n");
-
-  reterr = SpgwFinish(&spgw);
   while (0) {
   main_ret_NOMEM:
     reterr = kPglRetNomem;
@@ -214,17 +854,44 @@ int32_t main(int32_t argc, char** argv) {
   main_ret_OPEN_FAIL:
     reterr = kPglRetOpenFail;
     break;
+  main_ret_READ_FAIL:
+    reterr = kPglRetReadFail;
+    break;
   main_ret_WRITE_FAIL:
     reterr = kPglRetWriteFail;
     break;
   main_ret_INVALID_CMDLINE:
     reterr = kPglRetInvalidCmdline;
     break;
+  main_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
   }
  main_ret_1:
+  CleanupThreads(&tg);
+  if (pgrs) {
+    for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+      CleanupPgr(&(pgrs[tidx]), &reterr);
+    }
+    free(pgrs);
+  }
   CleanupPgr(&pgr, &reterr);
   CleanupPgfi(&pgfi, &reterr);
   CleanupSpgw(&spgw, &reterr);
+  CleanupMpgw(mpgwp, &reterr);
+  free(mpgwp);
+  if (pgrs_alloc) {
+    aligned_free(pgrs_alloc);
+  }
+  if (thread_bufs) {
+    aligned_free(thread_bufs);
+  }
+  if (bed_bufs) {
+    aligned_free(bed_bufs);
+  }
+  if (mpgw_alloc) {
+    aligned_free(mpgw_alloc);
+  }
   if (pgfi_alloc) {
     aligned_free(pgfi_alloc);
   }
@@ -237,9 +904,24 @@ int32_t main(int32_t argc, char** argv) {
   if (genovec) {
     aligned_free(genovec);
   }
+  if (genovec_block) {
+    aligned_free(genovec_block);
+  }
+  if (smaj_tile) {
+    aligned_free(smaj_tile);
+  }
+  if (transpose_buf) {
+    aligned_free(transpose_buf);
+  }
   if (raregeno) {
     aligned_free(raregeno);
   }
+  if (phasepresent) {
+    aligned_free(phasepresent);
+  }
+  if (phaseinfo) {
+    aligned_free(phaseinfo);
+  }
   if (sample_include) {
     aligned_free(sample_include);
   }
@@ -249,6 +931,12 @@ int32_t main(int32_t argc, char** argv) {
   if (difflist_sample_ids) {
     aligned_free(difflist_sample_ids);
   }
+  free(zstd_buf);
+  free(zframe_fpos);
+  ZSTD_freeCCtx(cctx);
+  if (infile) {
+    fclose(infile);
+  }
   if (outfile) {
     fclose(outfile);
   }
@@ -435,6 +435,7 @@ typedef struct Plink2CmdlineStruct {
   uint32_t filter_min_allele_ct;
   uint32_t filter_max_allele_ct;
   uint32_t bed_border_bp;
+  uint32_t pgen_cache_mib;
   char input_missing_geno_char;
   char output_missing_geno_char;
   char legacy_output_missing_geno_char;
@@ -638,6 +639,224 @@ uint32_t GrmKeepIsNeeded(Command1Flags command_flags1, PcaFlags pca_flags) {
   return ((command_flags1 & kfCommand1Pca) && (!(pca_flags & kfPcaApprox)));
 }
 
+// Dimensions for the --memory auto/plan planner, from the .pgen header (or
+// .bed size + .fam line count).  Returns nonzero if they can't be determined
+// without a full load.
+BoolErr GetPlanCounts(const char* pgenname, const char* psamname, uint32_t* raw_sample_ct_ptr, uint32_t* raw_variant_ct_ptr, uintptr_t* record_byte_ct_ptr) {
+  FILE* pgenfile = fopen(pgenname, FOPEN_RB);
+  if (!pgenfile) {
+    return 1;
+  }
+  unsigned char header[11];
+  const uint32_t header_read_fail = (!fread_unlocked(header, 11, 1, pgenfile)) || fseeko(pgenfile, 0, SEEK_END);
+  const int64_t fsize = header_read_fail? -1 : ftello(pgenfile);
+  fclose(pgenfile);
+  if ((fsize < 11) || (header[0] != 0x6c) || (header[1] != 0x1b)) {
+    return 1;
+  }
+  uint32_t raw_sample_ct;
+  uint32_t raw_variant_ct;
+  if (header[2] == 1) {
+    // PLINK 1 .bed: count .fam/.psam data lines
+    textFILE txf;
+    PreinitTextFile(&txf);
+    if (TextFileOpen(psamname, &txf)) {
+      CleanupTextFile(&txf, nullptr);
+      return 1;
+    }
+    raw_sample_ct = 0;
+    while (1) {
+      char* line_start;
+      if (TextFileNextLineLstrip(&txf, &line_start)) {
+        break;
+      }
+      if ((*line_start != '#') && (!IsEolnKns(*line_start))) {
+        ++raw_sample_ct;
+      }
+    }
+    CleanupTextFile(&txf, nullptr);
+    if (!raw_sample_ct) {
+      return 1;
+    }
+    raw_variant_ct = (fsize - 3) / NypCtToByteCt(raw_sample_ct);
+  } else if (header[2] >= 2) {
+    memcpy(&raw_variant_ct, &(header[3]), sizeof(int32_t));
+    memcpy(&raw_sample_ct, &(header[7]), sizeof(int32_t));
+  } else {
+    return 1;
+  }
+  if ((!raw_sample_ct) || (!raw_variant_ct)) {
+    return 1;
+  }
+  *raw_sample_ct_ptr = raw_sample_ct;
+  *raw_variant_ct_ptr = raw_variant_ct;
+  // Average record size.  Slight overestimate due to the header and index.
+  *record_byte_ct_ptr = 1 + S_CAST(uint64_t, fsize) / raw_variant_ct;
+  return 0;
+}
+
+// Number of non-ID columns in a --covar file's header line.
+uint32_t CountPlanCovars(const char* covar_fname) {
+  textFILE txf;
+  PreinitTextFile(&txf);
+  uint32_t covar_ct = 0;
+  char* line_start;
+  if ((!TextFileOpen(covar_fname, &txf)) && (!TextFileNextLineLstrip(&txf, &line_start))) {
+    const char* token_iter = line_start;
+    if (*token_iter == '#') {
+      ++token_iter;
+    }
+    const uint32_t token_ct = CountTokens(token_iter);
+    uint32_t id_col_ct = 0;
+    for (; id_col_ct != token_ct; ++id_col_ct) {
+      const char* token_end = CurTokenEnd(token_iter);
+      const uint32_t token_slen = token_end - token_iter;
+      if ((!strequal_k(token_iter, "FID", token_slen)) && (!strequal_k(token_iter, "IID", token_slen)) && (!strequal_k(token_iter, "SID", token_slen))) {
+        break;
+      }
+      token_iter = FirstNonTspace(token_end);
+    }
+    if ((!id_col_ct) && (token_ct >= 2)) {
+      // headerless: FID IID
+      id_col_ct = 2;
+    }
+    covar_ct = token_ct - id_col_ct;
+  }
+  CleanupTextFile(&txf, nullptr);
+  return covar_ct;
+}
+
+ENUM_U31_DEF_START()
+  kMemoryPlanNone,
+  kMemoryPlanAuto,
+  kMemoryPlanDryRun
+ENUM_U31_DEF_END(MemoryPlanMode);
+
+CONSTI32(kMaxMemoryPlanRows, 8);
+
+// Rough per-sample/per-variant footprint of the loaded .psam/.pvar
+// information, allele frequencies, and the usual include bitarrays.
+CONSTI32(kPlanBytesPerSample, 256);
+CONSTI32(kPlanBytesPerVariant, 96);
+
+// --memory auto/plan: estimate each requested command's minimum and
+// comfortable workspace from the raw dataset dimensions, and pick a --memory
+// value before anything is loaded.  This lets a job fail (or shrink its
+// reservation) up front, instead of running out of memory after earlier
+// steps have already completed.
+PglErr PlanMemory(const Plink2Cmdline* pcp, const char* pgenname, const char* psamname, MemoryPlanMode plan_mode, BigstackFlags bigstack_flags, intptr_t* malloc_size_mib_ptr) {
+  const char* flagname = (plan_mode == kMemoryPlanDryRun)? "--memory plan" : "--memory auto";
+  uint32_t raw_sample_ct;
+  uint32_t raw_variant_ct;
+  uintptr_t record_byte_ct;
+  if (GetPlanCounts(pgenname, psamname, &raw_sample_ct, &raw_variant_ct, &record_byte_ct)) {
+    logerrprintfww("Warning: %s: Dataset dimensions can't be determined before import%s\n", flagname, (plan_mode == kMemoryPlanAuto)? "; using default workspace size." : ".");
+    return kPglRetSuccess;
+  }
+  const Command1Flags command_flags1 = pcp->command_flags1;
+  const uint32_t max_thread_ct = pcp->max_thread_ct;
+  const char* row_names[kMaxMemoryPlanRows];
+  MemReq row_reqs[kMaxMemoryPlanRows];
+  uint32_t row_ct = 0;
+  PgenMtLoadMemReq(raw_sample_ct, raw_variant_ct, record_byte_ct, max_thread_ct, NypCtToCachelineCt(raw_sample_ct) * kCacheline, 0, &(row_reqs[0]));
+  row_names[0] = "other genotype passes";
+  row_ct = 1;
+  if (command_flags1 & (kfCommand1MakeKing | kfCommand1KingCutoff)) {
+    if (pcp->king_flags & kfKingColAll) {
+      row_names[row_ct] = "--make-king-table";
+    } else if (command_flags1 & kfCommand1MakeKing) {
+      row_names[row_ct] = "--make-king";
+    } else {
+      row_names[row_ct] = "--king-cutoff";
+    }
+    CalcKingMemReq(raw_sample_ct, raw_variant_ct, record_byte_ct, pcp->king_flags, pcp->king_cutoff != -1, pcp->parallel_idx, pcp->parallel_tot, max_thread_ct, &(row_reqs[row_ct]));
+    ++row_ct;
+  }
+  if (command_flags1 & kfCommand1MakeRel) {
+    row_names[row_ct] = "--make-rel/--make-grm";
+    CalcGrmMemReq(raw_sample_ct, record_byte_ct, pcp->grm_flags, pcp->parallel_idx, pcp->parallel_tot, &(row_reqs[row_ct]));
+    ++row_ct;
+  }
+#ifndef NOLAPACK
+  if (command_flags1 & kfCommand1Pca) {
+    row_names[row_ct] = (pcp->pca_flags & kfPcaApprox)? "--pca approx" : "--pca";
+    CalcPcaMemReq(raw_sample_ct, raw_variant_ct, record_byte_ct, pcp->pca_ct, pcp->grm_flags, pcp->pca_flags, max_thread_ct, &(row_reqs[row_ct]));
+    ++row_ct;
+  }
+#endif
+  if (command_flags1 & kfCommand1Glm) {
+    const uint32_t covar_ct = pcp->covar_fname? CountPlanCovars(pcp->covar_fname) : 0;
+    row_names[row_ct] = "--glm";
+    GlmMemReq(raw_sample_ct, raw_variant_ct, record_byte_ct, 1, covar_ct, pcp->glm_info.flags, max_thread_ct, &(row_reqs[row_ct]));
+    ++row_ct;
+  }
+  if (command_flags1 & kfCommand1Clump) {
+    row_names[row_ct] = "--clump";
+    ClumpMemReq(raw_sample_ct, raw_variant_ct, record_byte_ct, max_thread_ct, &(row_reqs[row_ct]));
+    ++row_ct;
+  }
+  const uint64_t dataset_byte_ct = S_CAST(uint64_t, raw_sample_ct) * kPlanBytesPerSample + S_CAST(uint64_t, raw_variant_ct) * kPlanBytesPerVariant;
+  uint64_t min_byte_ct = 0;
+  uint64_t comfortable_byte_ct = 0;
+  uint32_t min_row_idx = 0;
+  for (uint32_t row_idx = 0; row_idx != row_ct; ++row_idx) {
+    if (row_reqs[row_idx].min_byte_ct > min_byte_ct) {
+      min_byte_ct = row_reqs[row_idx].min_byte_ct;
+      min_row_idx = row_idx;
+    }
+    if (row_reqs[row_idx].comfortable_byte_ct > comfortable_byte_ct) {
+      comfortable_byte_ct = row_reqs[row_idx].comfortable_byte_ct;
+    }
+  }
+  uint64_t min_mib = DivUpU64(dataset_byte_ct + min_byte_ct, 1048576);
+  uint64_t comfortable_mib = DivUpU64(dataset_byte_ct + comfortable_byte_ct, 1048576);
+  if (min_mib < kBigstackMinMib) {
+    min_mib = kBigstackMinMib;
+  }
+  if (comfortable_mib < kBigstackMinMib) {
+    comfortable_mib = kBigstackMinMib;
+  }
+  // Leave the same headroom CmdlineParsePhase3() does.
+  uint64_t usable_mib = ~0LLU;
+  const uint64_t total_mib = DetectMib();
+  if (total_mib) {
+    const uint64_t mem_available_kib = GetMemAvailableKib();
+    const uint64_t mem_available_mib = (mem_available_kib == (~0LLU))? total_mib : (mem_available_kib / 1024);
+    usable_mib = (mem_available_mib > (kNonBigstackMin >> 20))? (mem_available_mib - (kNonBigstackMin >> 20)) : 0;
+  }
+#ifndef __LP64__
+  if (usable_mib > kMalloc32bitMibMax) {
+    usable_mib = kMalloc32bitMibMax;
+  }
+#endif
+
+  logprintf("%s: %u sample%s, %u variant%s (before filtering), %u thread%s.\n", flagname, raw_sample_ct, (raw_sample_ct == 1)? "" : "s", raw_variant_ct, (raw_variant_ct == 1)? "" : "s", max_thread_ct, (max_thread_ct == 1)? "" : "s");
+  logprintf("  %-24s %10" PRIu64 " MiB\n", "loaded dataset", DivUpU64(dataset_byte_ct, 1048576));
+  for (uint32_t row_idx = 0; row_idx != row_ct; ++row_idx) {
+    logprintf("  %-24s %10" PRIu64 " MiB minimum, %10" PRIu64 " MiB full speed\n", row_names[row_idx], DivUpU64(row_reqs[row_idx].min_byte_ct, 1048576), DivUpU64(row_reqs[row_idx].comfortable_byte_ct, 1048576));
+  }
+  uint64_t chosen_mib;
+  if (comfortable_mib <= usable_mib) {
+    chosen_mib = comfortable_mib;
+    logprintf("Workspace plan: %" PRIu64 " MiB (every command at full speed).\n", chosen_mib);
+  } else if (min_mib <= usable_mib) {
+    chosen_mib = usable_mib;
+    logprintfww("Workspace plan: %" PRIu64 " MiB available of %" PRIu64 " MiB for full speed; some commands will use smaller blocks or extra passes.\n", chosen_mib, comfortable_mib);
+  } else {
+    logerrprintfww("Error: %s needs an estimated %" PRIu64 " MiB of workspace, but only %" PRIu64 " MiB appears to be available.\n", row_names[min_row_idx], min_mib, usable_mib);
+    if (plan_mode == kMemoryPlanDryRun) {
+      return kPglRetSuccess;
+    }
+    return kPglRetNomem;
+  }
+  if (plan_mode == kMemoryPlanDryRun) {
+    logprintf("Use \"--memory %" PRIu64 "%s\" to reserve this.\n", chosen_mib, (bigstack_flags & kfBigstackRequire)? " require" : "");
+    return kPglRetSuccess;
+  }
+  *malloc_size_mib_ptr = chosen_mib;
+  return kPglRetSuccess;
+}
+
 void ReportGenotypingRate(const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_missing_cts, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t y_sample_ct, uint32_t variant_ct, uint32_t is_dosage) {
   // Each variant has equal weight.
   // By default, only males are considered on chrY; with
@@ -794,8 +1013,10 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
   PglErr reterr = kPglRetSuccess;
   PgenFileInfo pgfi;
   PgenReader simple_pgr;
+  PgenTaskRunner zstd_runner;
   PreinitPgfi(&pgfi);
   PreinitPgr(&simple_pgr);
+  PreinitPgenTaskRunner(&zstd_runner);
   PgenExtensionLl ext_slot; // shouldn't have shorter lifetime than pgfi
   ext_slot.contents = nullptr;
   {
@@ -1064,7 +1285,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         }
         char* pgenname_end = memcpya(pgenname, outname, outname_end - outname);
         pgenname_end = strcpya_k(pgenname_end, ".pgen");
-        const uint32_t no_vmaj_ext = (pcp->command_flags1 & kfCommand1MakePlink2) && (!pcp->filter_flags) && ((make_plink2_flags & (kfMakePgen | (kfMakePgenFormatBase * 3))) == kfMakePgen);
+        const uint32_t no_vmaj_ext = (pcp->command_flags1 & kfCommand1MakePlink2) && (!pcp->filter_flags) && ((make_plink2_flags & (kfMakePgen | (kfMakePgenFormatBase * 3) | kfMakePgenLdWindow)) == kfMakePgen);
         if (no_vmaj_ext) {
           *pgenname_end = '\0';
           make_plink2_flags &= ~kfMakePgen;
@@ -1154,45 +1375,90 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           goto Plink2Core_ret_1;
         }
       }
+      if (pcp->pgen_cache_mib) {
+        // Must precede all PgrInit() calls, since each reader copies pgfi.
+        const uintptr_t cache_byte_ct = S_CAST(uintptr_t, pcp->pgen_cache_mib) << 20;
+        const uintptr_t base_byte_ct = PgfiVcacheAllocByteCt(raw_variant_ct, raw_sample_ct, 0);
+        // slot arrays are small relative to this
+        const uintptr_t per_slot_byte_ct = NypCtToCachelineCt(raw_sample_ct) * kCacheline + 32;
+        uint32_t slot_ct = 0;
+        if (cache_byte_ct > base_byte_ct) {
+          slot_ct = MINV((cache_byte_ct - base_byte_ct) / per_slot_byte_ct, raw_variant_ct);
+        }
+        if (unlikely(!slot_ct)) {
+          logerrputs("Error: --pgen-cache size too small to hold a single variant.\n");
+          goto Plink2Core_ret_INVALID_CMDLINE;
+        }
+        unsigned char* vcache_alloc;
+        if (unlikely(bigstack_alloc_uc(PgfiVcacheAllocByteCt(raw_variant_ct, raw_sample_ct, slot_ct), &vcache_alloc))) {
+          goto Plink2Core_ret_NOMEM;
+        }
+        reterr = PgfiInitVcache(slot_ct, vcache_alloc, &pgfi, g_logbuf);
+        if (unlikely(reterr)) {
+          logerrputsb();
+          goto Plink2Core_ret_1;
+        }
+        logprintf("--pgen-cache: Up to %u decoded variant%s will be cached.\n", slot_ct, (slot_ct == 1)? "" : "s");
+      }
+      if (pgfi.zframe_ct && (pcp->max_thread_ct > 1)) {
+        // zstd-compressed .pgen: let block loads decompress multiple frames in
+        // parallel.
+        // (PgfiInitZstdRunner() caps the number of cursors at kBitsPerWord.)
+        const uint32_t zstd_thread_ct = MINV(MINV(pcp->max_thread_ct, pgfi.zframe_ct), kBitsPerWord);
+        if (unlikely(InitPgenTaskRunner(zstd_thread_ct, &zstd_runner) ||
+                     PgfiInitZstdRunner(zstd_thread_ct, PgenTaskRunnerParallelFor, &zstd_runner, &pgfi))) {
+          goto Plink2Core_ret_NOMEM;
+        }
+      }
       if (SingleVariantLoaderIsNeeded(king_cutoff_fprefix, pcp->command_flags1, make_plink2_flags, pcp->rmdup_mode, pcp->hwe_ln_thresh)) {
-        // ugly kludge, probably want to add pgenlib_internal support for this
-        // hybrid use pattern
-        FILE* shared_ff_copy = pgfi.shared_ff;
-        pgfi.shared_ff = nullptr;
         unsigned char* simple_pgr_alloc;
         if (unlikely(bigstack_alloc_uc((pgr_alloc_cacheline_ct + DivUp(max_vrec_width, kCacheline)) * kCacheline, &simple_pgr_alloc))) {
           goto Plink2Core_ret_NOMEM;
         }
-        reterr = PgrInit(pgenname, max_vrec_width, &pgfi, &simple_pgr, simple_pgr_alloc);
-        if (unlikely(reterr)) {
-          if (reterr == kPglRetOpenFail) {
-            logerrprintfww(kErrprintfFopen, pgenname, strerror(errno));
-          } else {
-            assert(reterr == kPglRetReadFail);
-            logerrprintfww(kErrprintfFread, pgenname, rstrerror(errno));
+#ifndef NO_PREAD
+        // PgrValidateIndex() still needs its own FILE*.  Otherwise, let simple_pgr
+        // share pgfi's file descriptor via pread(), so it doesn't have to
+        // open the file a second time or maintain its own seek position.
+        if (!(pcp->command_flags1 & kfCommand1Validate)) {
+          reterr = PgfiInitPread(&pgfi, g_logbuf);
+          if (unlikely(reterr)) {
+            logerrputsb();
+            goto Plink2Core_ret_1;
           }
-          goto Plink2Core_ret_1;
-        }
-        pgfi.shared_ff = shared_ff_copy;
-        if (pcp->command_flags1 & kfCommand1Validate) {
-          uintptr_t* genovec_buf;
-          if (unlikely(bigstack_alloc_w(NypCtToWordCt(raw_sample_ct), &genovec_buf))) {
+          // only possible failure is a zstd decompressor allocation
+          if (unlikely(PgrInit(nullptr, max_vrec_width, &pgfi, &simple_pgr, simple_pgr_alloc))) {
             goto Plink2Core_ret_NOMEM;
           }
-          logprintfww5("Validating %s... ", pgenname);
-          fflush(stdout);
-          reterr = PgrValidate(&simple_pgr, genovec_buf, g_logbuf);
+        } else {
+#endif
+          // ugly kludge, probably want to add pgenlib_internal support for
+          // this hybrid use pattern
+          FILE* shared_ff_copy = pgfi.shared_ff;
+          pgfi.shared_ff = nullptr;
+          reterr = PgrInit(pgenname, max_vrec_width, &pgfi, &simple_pgr, simple_pgr_alloc);
+          if (unlikely(reterr)) {
+            if (reterr == kPglRetOpenFail) {
+              logerrprintfww(kErrprintfFopen, pgenname, strerror(errno));
+            } else if (reterr == kPglRetNomem) {
+              goto Plink2Core_ret_NOMEM;
+            } else {
+              assert(reterr == kPglRetReadFail);
+              logerrprintfww(kErrprintfFread, pgenname, rstrerror(errno));
+            }
+            goto Plink2Core_ret_1;
+          }
+          pgfi.shared_ff = shared_ff_copy;
+#ifndef NO_PREAD
+        }
+#endif
+        if (pcp->command_flags1 & kfCommand1Validate) {
+          reterr = ValidatePgen(pgenname, max_vrec_width, pgr_alloc_cacheline_ct, (pcp->misc_flags / kfMiscValidateQuick) & 1, pcp->max_thread_ct, &pgfi, &simple_pgr);
           if (unlikely(reterr)) {
-            logputs("\n");
-            WordWrapB(0);
-            logerrputsb();
             goto Plink2Core_ret_1;
           }
-          logputs("done.\n");
           if (pcp->command_flags1 == kfCommand1Validate) {
             goto Plink2Core_ret_1;
           }
-          BigstackReset(genovec_buf);
         }
       }
       // any functions using blockload must perform its own PgrInit(), etc.
@@ -2391,6 +2657,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          LogBigstackPeak("--make-king-table");
+          BigstackReleaseFree();
         } else {
           if (king_cutoff_fprefix) {
             if (pcp->king_flags & kfKingCutoffTable) {
@@ -2404,6 +2672,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          LogBigstackPeak((pcp->command_flags1 & kfCommand1MakeKing)? "--make-king" : "--king-cutoff");
+          BigstackReleaseFree();
           if (pcp->command_flags1 & kfCommand1KingCutoff) {
             snprintf(outname_end, kMaxOutfnameExtBlen, ".king.cutoff.in.id");
             reterr = WriteSampleIds(sample_include, &pii.sii, outname, sample_ct);
@@ -2429,6 +2699,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("Relationship matrix computation");
+        BigstackReleaseFree();
         // Retire --rel-cutoff, since --king-cutoff is pretty clearly better.
         // KING-robust has significant systematic biases when interracial
         // couples are involved, though.  Still may be okay for first-degree
@@ -2510,6 +2782,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--pca");
+        BigstackReleaseFree();
       }
 #endif
 
@@ -2701,15 +2975,19 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          LogBigstackPeak("--make-pgen/--make-bed");
+          BigstackReleaseFree();
           // no BigstackReset needed here, since allele_presents only needed
           // if 'trim-alts', and later operations are prohibited in that case
         }
 
         if (pcp->command_flags1 & kfCommand1Exportf) {
-          reterr = Exportf(sample_include, &pii, sex_nm, sex_male, pheno_cols, pheno_names, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, allele_permute, pvar_qual_present, pvar_quals, pvar_filter_present, pvar_filter_npass, pvar_filter_storage, info_reload_slen? pvarname : nullptr, variant_cms, &(pcp->exportf_info), pcp->legacy_output_missing_pheno, contig_lens, xheader_blen, info_flags, raw_sample_ct, sample_ct, pheno_ct, max_pheno_name_blen, raw_variant_ct, variant_ct, max_variant_id_slen, max_allele_slen, max_filter_slen, info_reload_slen, pcp->input_missing_geno_char, pcp->output_missing_geno_char, pcp->legacy_output_missing_geno_char, pcp->max_thread_ct, make_plink2_flags, pgr_alloc_cacheline_ct, xheader, &pgfi, &simple_pgr, outname, outname_end);
+          reterr = Exportf(sample_include, &pii, sex_nm, sex_male, pheno_cols, pheno_names, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, allele_permute, pvar_qual_present, pvar_quals, pvar_filter_present, pvar_filter_npass, pvar_filter_storage, info_reload_slen? pvarname : nullptr, variant_cms, &(pcp->exportf_info), pcp->legacy_output_missing_pheno, contig_lens, xheader_blen, info_flags, raw_sample_ct, sample_ct, pheno_ct, max_pheno_name_blen, raw_variant_ct, variant_ct, max_variant_id_slen, max_allele_slen, max_filter_slen, info_reload_slen, pcp->input_missing_geno_char, pcp->output_missing_geno_char, pcp->legacy_output_missing_geno_char, pcp->max_thread_ct, make_plink2_flags, pgr_alloc_cacheline_ct, xheader, pgenname, &pgfi, &simple_pgr, outname, outname_end);
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          LogBigstackPeak("--export");
+          BigstackReleaseFree();
         }
 
         if (variant_bps_backup) {
@@ -2749,6 +3027,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("LD-based pruning");
+        BigstackReleaseFree();
       }
 
       if (pcp->command_flags1 & kfCommand1Ld) {
@@ -2771,6 +3051,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--r[2]");
+        BigstackReleaseFree();
       }
 
       if (pcp->command_flags1 & kfCommand1Het) {
@@ -2778,6 +3060,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--het");
+        BigstackReleaseFree();
       }
 
       if (pcp->command_flags1 & kfCommand1Fst) {
@@ -2785,6 +3069,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--fst");
+        BigstackReleaseFree();
       }
 
       if (pcp->command_flags1 & kfCommand1Score) {
@@ -2792,12 +3078,16 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--score");
+        BigstackReleaseFree();
       }
       if (pcp->command_flags1 & kfCommand1Vscore) {
         reterr = Vscore(variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, sample_include, &pii.sii, sex_male, allele_freqs, pcp->vscore_fname, &(pcp->vscore_col_idx_range_list), raw_variant_ct, variant_ct, raw_sample_ct, sample_ct, nosex_ct, max_allele_slen, pcp->vscore_flags, pcp->xchr_model, pcp->max_thread_ct, pgr_alloc_cacheline_ct, &pgfi, outname, outname_end);
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--variant-score");
+        BigstackReleaseFree();
       }
       // eventually check for nonzero pheno_ct here?
 
@@ -2810,6 +3100,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
+        LogBigstackPeak("--glm");
+        BigstackReleaseFree();
       }
     }
     if (pcp->command_flags1 & kfCommand1Clump) {
@@ -2822,7 +3114,36 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       if (unlikely(reterr)) {
         goto Plink2Core_ret_1;
       }
+      LogBigstackPeak("--clump");
+      BigstackReleaseFree();
+    }
+  }
+  if (pgfi.multiread_byte_ct) {
+    // Log-file only.  Time is spent blocked in PgfiMultiread(); with
+    // effective readahead, this should be a small fraction of the run.
+    const double read_mib = u63tod(pgfi.multiread_byte_ct) * (1.0 / 1048576);
+    const double read_sec = u63tod(pgfi.multiread_ns) * 1e-9;
+    snprintf(g_logbuf, kLogbufSize, ".pgen block reads: %.1f MiB, %.3fs blocking (%.1f MiB/s).\n", read_mib, read_sec, (read_sec > 0.0)? (read_mib / read_sec) : 0.0);
+    logputs_silent(g_logbuf);
+  }
+  if (PgfiVcacheEnabled(&pgfi)) {
+    uint64_t vcache_hit_ct;
+    uint64_t vcache_miss_ct;
+    PgfiVcacheGetStats(&pgfi, &vcache_hit_ct, &vcache_miss_ct);
+    char* write_iter = strcpya_k(g_logbuf, "--pgen-cache: ");
+    write_iter = i64toa(vcache_hit_ct, write_iter);
+    write_iter = strcpya_k(write_iter, " hit");
+    if (vcache_hit_ct != 1) {
+      *write_iter++ = 's';
+    }
+    write_iter = strcpya_k(write_iter, ", ");
+    write_iter = i64toa(vcache_miss_ct, write_iter);
+    write_iter = strcpya_k(write_iter, " miss");
+    if (vcache_miss_ct != 1) {
+      write_iter = strcpya_k(write_iter, "es");
     }
+    strcpy_k(write_iter, ".\n");
+    logputsb();
   }
   while (0) {
   Plink2Core_ret_NOMEM:
@@ -2858,6 +3179,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
   CleanupPgr2(".pgen file", &simple_pgr, &reterr);
   free_cond(ext_slot.contents);
   CleanupPgfi2(".pgen file", &pgfi, &reterr);
+  CleanupPgenTaskRunner(&zstd_runner);
   assert(pgfi.block_base == nullptr);
   // no BigstackReset() needed?
   return reterr;
@@ -3815,6 +4137,7 @@ int main(int argc, char** argv) {
     pc.filter_min_allele_ct = 0;
     pc.filter_max_allele_ct = UINT32_MAX;
     pc.bed_border_bp = 0;
+    pc.pgen_cache_mib = 0;
     pc.input_missing_geno_char = '0';
     pc.output_missing_geno_char = '.';
     pc.legacy_output_missing_geno_char = '0';
@@ -3823,6 +4146,7 @@ int main(int argc, char** argv) {
     int32_t vcf_min_dp = -1;
     int32_t vcf_max_dp = 0x7fffffff;
     intptr_t malloc_size_mib = 0;
+    MemoryPlanMode memory_plan_mode = kMemoryPlanNone;
     LoadParams load_params = kfLoadParams0;
     Xload xload = kfXload0;
     uint32_t rseed_ct = 0;
@@ -3840,7 +4164,8 @@ int main(int argc, char** argv) {
     uint32_t score_col_nums_present = 0;
     uint32_t r2_required = 0;
     uint32_t permit_multiple_inclusion_filters = 0;
-    uint32_t memory_require = 0;
+    BigstackFlags bigstack_flags = kfBigstack0;
+    ThreadPinMode thread_pin_mode = kThreadPinNone;
 #ifdef USE_MKL
     uint32_t mkl_native = 0;
 #endif
@@ -7403,22 +7728,36 @@ int main(int argc, char** argv) {
 
       case 'm':
         if (strequal_k_unsafe(flagname_p2, "emory")) {
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 3))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
-          uint32_t mb_modif_idx = 1;
-          if (param_ct == 2) {
-            if (unlikely(CheckExtraParam(&(argvk[arg_idx]), "require", &mb_modif_idx))) {
+          const char* mb_modif = nullptr;
+          for (uint32_t param_idx = 1; param_idx <= param_ct; ++param_idx) {
+            const char* cur_modif = argvk[arg_idx + param_idx];
+            if (strequal_k_unsafe(cur_modif, "require") && (!(bigstack_flags & kfBigstackRequire))) {
+              bigstack_flags |= kfBigstackRequire;
+            } else if (strequal_k_unsafe(cur_modif, "hugetlb") && (!(bigstack_flags & kfBigstackHugetlb))) {
+              bigstack_flags |= kfBigstackHugetlb;
+            } else if (likely(!mb_modif)) {
+              mb_modif = cur_modif;
+            } else {
+              logerrputs("Error: Invalid --memory argument sequence.\n");
               goto main_ret_INVALID_CMDLINE_A;
             }
-            memory_require = 1;
           }
-          const char* mb_modif = argvk[arg_idx + mb_modif_idx];
-          if (unlikely(ScanPosintptrx(mb_modif, R_CAST(uintptr_t*, &malloc_size_mib)))) {
+          if (unlikely(!mb_modif)) {
+            logerrputs("Error: --memory requires a size argument.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          if (!strcmp(mb_modif, "auto")) {
+            memory_plan_mode = kMemoryPlanAuto;
+          } else if (!strcmp(mb_modif, "plan")) {
+            memory_plan_mode = kMemoryPlanDryRun;
+          } else if (unlikely(ScanPosintptrx(mb_modif, R_CAST(uintptr_t*, &malloc_size_mib)))) {
             snprintf(g_logbuf, kLogbufSize, "Error: Invalid --memory argument '%s'.\n", mb_modif);
             goto main_ret_INVALID_CMDLINE_WWA;
           }
-          if (unlikely(malloc_size_mib < S_CAST(intptr_t, kBigstackMinMib))) {
+          if (unlikely((!memory_plan_mode) && (malloc_size_mib < S_CAST(intptr_t, kBigstackMinMib)))) {
             snprintf(g_logbuf, kLogbufSize, "Error: Invalid --memory argument '%s' (minimum %u).\n", mb_modif, kBigstackMinMib);
             goto main_ret_INVALID_CMDLINE_WWA;
           }
@@ -7567,8 +7906,10 @@ int main(int argc, char** argv) {
               make_plink2_flags |= kfMakePgenEraseDosage;
             } else if (strequal_k(cur_modif, "fill-missing-from-dosage", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenFillMissingFromDosage;
-            } else if (likely(strequal_k(cur_modif, "writer-ver", cur_modif_slen))) {
+            } else if (strequal_k(cur_modif, "writer-ver", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenWriterVer;
+            } else if (likely(strequal_k(cur_modif, "ld-window", cur_modif_slen))) {
+              make_plink2_flags |= kfMakePgenLdWindow;
             } else {
               snprintf(g_logbuf, kLogbufSize, "Error: Invalid --make-bpgen argument '%s'.\n", cur_modif);
               goto main_ret_INVALID_CMDLINE_WWA;
@@ -7578,6 +7919,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-bpgen 'trim-alts' and 'erase-alt2+' modifiers cannot be used\ntogether.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely((make_plink2_flags & kfMakePgenLdWindow) && (make_plink2_flags & (kfMakePgenFormatBase * 3)))) {
+            logerrputs("Error: --make-bpgen 'ld-window' and 'format=' modifiers cannot be used together.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (varid_semicolon) {
             if (unlikely((make_plink2_flags & kfMakePlink2VaridDup) || (varid_semicolon & (varid_semicolon - 1)))) {
               logerrputs("Error: --make-bpgen 'varid-split', 'varid-split-dup', 'varid-dup', and\n'varid-join' modifiers are mutually exclusive.\n");
@@ -7704,6 +8049,8 @@ int main(int argc, char** argv) {
               make_plink2_flags |= kfMakePgenFillMissingFromDosage;
             } else if (strequal_k(cur_modif, "writer-ver", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenWriterVer;
+            } else if (strequal_k(cur_modif, "ld-window", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenLdWindow;
             } else if (likely(StrStartsWith0(cur_modif, "psam-cols=", cur_modif_slen))) {
               if (unlikely(explicit_psam_cols)) {
                 logerrputs("Error: Multiple --make-pgen psam-cols= modifiers.\n");
@@ -7723,6 +8070,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-pgen 'trim-alts' and 'erase-alt2+' modifiers cannot be used\ntogether.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely((make_plink2_flags & kfMakePgenLdWindow) && (make_plink2_flags & (kfMakePgenFormatBase * 3)))) {
+            logerrputs("Error: --make-pgen 'ld-window' and 'format=' modifiers cannot be used together.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (varid_semicolon) {
             if (unlikely((make_plink2_flags & kfMakePlink2VaridDup) || (varid_semicolon & (varid_semicolon - 1)))) {
               logerrputs("Error: --make-pgen 'varid-split', 'varid-split-dup', 'varid-dup', and\n'varid-join' modifiers are mutually exclusive.\n");
@@ -9235,6 +9586,14 @@ int main(int argc, char** argv) {
             goto main_ret_OPEN_FAIL;
           }
           memcpy(pvarname, fname, slen + 1);
+        } else if (strequal_k_unsafe(flagname_p2, "var-cache")) {
+#ifdef _WIN32
+          logerrputs("Error: --pvar-cache is not supported on Windows.\n");
+          goto main_ret_INVALID_CMDLINE_A;
+#else
+          pc.pvar_psam_flags |= kfPvarCache;
+          goto main_param_zero;
+#endif
         } else if (strequal_k_unsafe(flagname_p2, "heno")) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -9458,10 +9817,28 @@ int main(int argc, char** argv) {
           }
           pc.command_flags1 |= kfCommand1Pca;
           pc.dependency_flags |= kfFilterAllReq;
+        } else if (strequal_k_unsafe(flagname_p2, "gen-cache")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          const char* cur_modif = argvk[arg_idx + 1];
+          if (unlikely(ScanPosintCappedx(cur_modif, 0x7fffffff, &pc.pgen_cache_mib))) {
+            snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pgen-cache argument '%s'.\n", cur_modif);
+            goto main_ret_INVALID_CMDLINE_WWA;
+          }
         } else if (strequal_k_unsafe(flagname_p2, "gen-info")) {
           pc.command_flags1 |= kfCommand1PgenInfo;
           pc.dependency_flags |= kfFilterAllReq;
           goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "gen-readahead")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          const char* cur_modif = argvk[arg_idx + 1];
+          if (unlikely(ScanUintCappedx(cur_modif, 64, &g_pgen_readahead_block_ct))) {
+            snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pgen-readahead argument '%s'.\n", cur_modif);
+            goto main_ret_INVALID_CMDLINE_WWA;
+          }
         } else if (strequal_k_unsafe(flagname_p2, "merge")) {
           if (unlikely(import_flags & kfImportKeepAutoconv)) {
             logerrputs("Error: --pmerge cannot be used with --keep-autoconv.\n");
@@ -10974,6 +11351,20 @@ int main(int argc, char** argv) {
           }
           pmerge_info.flags |= kfPmergeSampleInnerJoin;
           goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "pill-dir")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+#ifdef _WIN32
+          logerrputs("Error: --spill-dir is not supported on Windows.\n");
+          goto main_ret_INVALID_CMDLINE_A;
+#else
+          const char* spill_dirname = argvk[arg_idx + 1];
+          if (unlikely(SetSpillDir(spill_dirname))) {
+            snprintf(g_logbuf, kLogbufSize, "Error: --spill-dir directory '%s' does not exist or is not writable.\n", spill_dirname);
+            goto main_ret_INVALID_CMDLINE_WWA;
+          }
+#endif
         } else if (unlikely(!strequal_k_unsafe(flagname_p2, "ilent"))) {
           goto main_ret_INVALID_CMDLINE_UNRECOGNIZED;
         }
@@ -10981,11 +11372,31 @@ int main(int argc, char** argv) {
 
       case 't':
         if (strequal_k_unsafe(flagname_p2, "hreads")) {
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
-          if (unlikely(ScanPosintDefcapx(argvk[arg_idx + 1], &pc.max_thread_ct))) {
-            snprintf(g_logbuf, kLogbufSize, "Error: Invalid --threads argument '%s'.\n", argvk[arg_idx + 1]);
+          uint32_t ct_modif_idx = 1;
+          if (param_ct == 2) {
+            for (uint32_t param_idx = 1; param_idx != 3; ++param_idx) {
+              const char* cur_modif = argvk[arg_idx + param_idx];
+              if (strequal_k_unsafe(cur_modif, "pin")) {
+                thread_pin_mode = kThreadPinCpu;
+              } else if (strequal_k_unsafe(cur_modif, "numa")) {
+                thread_pin_mode = kThreadPinNumaNode;
+              } else {
+                continue;
+              }
+              ct_modif_idx = 3 - param_idx;
+              break;
+            }
+            if (unlikely(thread_pin_mode == kThreadPinNone)) {
+              logerrputs("Error: Invalid --threads argument sequence.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
+          const char* ct_modif = argvk[arg_idx + ct_modif_idx];
+          if (unlikely(ScanPosintDefcapx(ct_modif, &pc.max_thread_ct))) {
+            snprintf(g_logbuf, kLogbufSize, "Error: Invalid --threads argument '%s'.\n", ct_modif);
             goto main_ret_INVALID_CMDLINE_WWA;
           }
           if (pc.max_thread_ct > kMaxThreads) {
@@ -11628,9 +12039,19 @@ int main(int argc, char** argv) {
           pmerge_info.flags |= kfPmergeVariantInnerJoin;
           goto main_param_zero;
         } else if (likely(strequal_k_unsafe(flagname_p2, "alidate"))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          if (param_ct) {
+            const char* cur_modif = argvk[arg_idx + 1];
+            if (unlikely(!strequal_k_unsafe(cur_modif, "quick"))) {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --validate argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+            pc.misc_flags |= kfMiscValidateQuick;
+          }
           pc.command_flags1 |= kfCommand1Validate;
           pc.dependency_flags |= kfFilterAllReq;
-          goto main_param_zero;
         } else {
           goto main_ret_INVALID_CMDLINE_UNRECOGNIZED;
         }
@@ -12025,7 +12446,13 @@ int main(int argc, char** argv) {
       rseeds = nullptr;
     }
 
-    if (unlikely(CmdlineParsePhase3(0, malloc_size_mib, memory_require, &pcm, &bigstack_ua))) {
+    if (memory_plan_mode != kMemoryPlanNone) {
+      reterr = PlanMemory(&pc, pgenname, psamname, memory_plan_mode, bigstack_flags, &malloc_size_mib);
+      if (unlikely(reterr) || (memory_plan_mode == kMemoryPlanDryRun)) {
+        goto main_ret_1;
+      }
+    }
+    if (unlikely(CmdlineParsePhase3(0, malloc_size_mib, bigstack_flags, &pcm, &bigstack_ua))) {
       goto main_ret_NOMEM;
     }
 
@@ -12039,11 +12466,32 @@ int main(int argc, char** argv) {
       // to justify only 1 compute thread.
       logprintf("Using %s%u compute thread%s.\n", (pc.max_thread_ct > 1)? "up to " : "", pc.max_thread_ct, (pc.max_thread_ct == 1)? "" : "s");
     }
+    if (pc.max_thread_ct > 1) {
+      // Commands borrow these workers through the usual ThreadGroup
+      // interface, so per-command thread creation is avoided.  Failure just
+      // means they fall back to creating their own threads.
+      InitThreadPool(pc.max_thread_ct, thread_pin_mode);
+#if !defined(__linux__)
+      if (thread_pin_mode != kThreadPinNone) {
+        logerrputs("Warning: --threads 'pin'/'numa' are only supported on Linux; ignoring.\n");
+      }
+#else
+      if (thread_pin_mode == kThreadPinNumaNode) {
+        const uint32_t numa_node_ct = ThreadPoolNumaNodeCt();
+        if (numa_node_ct > 1) {
+          logprintf("--threads numa: Workers spread across %u NUMA nodes (experimental).\n", numa_node_ct);
+        } else {
+          logputs("Note: --threads numa has no effect on a single-NUMA-node machine.\n");
+        }
+      }
+#endif
+    }
     if (randmem) {
       reterr = RandomizeBigstack(pc.max_thread_ct, &main_sfmt);
       if (unlikely(reterr)) {
         goto main_ret_1;
       }
+      DisableBigstackUsageTracking();
     }
 
     print_end_time = 1;
@@ -12130,9 +12578,9 @@ int main(int argc, char** argv) {
             g_zst_level = 1;
           }
           if (is_vcf) {
-            reterr = VcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, !!pc.update_sex_info.fname, !!pc.splitpar_bound2, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, import_max_allele_ct, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
+            reterr = VcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, !!pc.update_sex_info.fname, !!pc.splitpar_bound2, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, import_max_allele_ct, pc.from_bp, pc.to_bp, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
           } else {
-            reterr = BcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, !!pc.update_sex_info.fname, !!pc.splitpar_bound2, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, import_max_allele_ct, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
+            reterr = BcfToPgen(pgenname, (load_params & kfLoadParamsPsam)? psamname : nullptr, const_fid, vcf_dosage_import_field, pc.misc_flags, import_flags, no_samples_ok, !!pc.update_sex_info.fname, !!pc.splitpar_bound2, pc.hard_call_thresh, pc.dosage_erase_thresh, import_dosage_certainty, id_delim, idspace_to, vcf_min_gq, vcf_min_dp, vcf_max_dp, vcf_half_call, pc.fam_cols, import_max_allele_ct, pc.from_bp, pc.to_bp, pc.max_thread_ct, outname, convname_end, &chr_info, &pgen_generated, &psam_generated);
           }
           g_zst_level = zst_level;
         } else {
@@ -12328,6 +12776,17 @@ int main(int argc, char** argv) {
     break;
   }
  main_ret_1:
+  {
+    ThreadPoolStats thread_pool_stats;
+    GetThreadPoolStats(&thread_pool_stats);
+    if (thread_pool_stats.worker_ct) {
+      // Log-file only.
+      snprintf(g_logbuf, kLogbufSize, "Worker pool: %u thread%s (%u pinned, %u NUMA node%s); %" PRIu64 " of %" PRIu64 " thread launches reused a pooled worker; %.3fms total spawn overhead.\n", thread_pool_stats.worker_ct, (thread_pool_stats.worker_ct == 1)? "" : "s", thread_pool_stats.pinned_ct, thread_pool_stats.numa_node_ct, (thread_pool_stats.numa_node_ct == 1)? "" : "s", thread_pool_stats.reuse_ct, thread_pool_stats.launch_ct, u63tod(thread_pool_stats.spawn_ns) * 1e-6);
+      logputs_silent(g_logbuf);
+    }
+  }
+  LogBigstackHighWater();
+  LogSpillTotals();
   if (reterr == kPglRetNomemCustomMsg) {
     if (g_failed_alloc_attempt_size) {
       logerrprintf("Failed allocation size: %" PRIu64 "\n", g_failed_alloc_attempt_size);
@@ -12353,6 +12812,8 @@ int main(int argc, char** argv) {
   free_cond(import_single_chr_str);
   free_cond(const_fid);
   free_cond(rseeds);
+  CleanupThreadPool();
+  CleanupSpillArena();
   CleanupPlink2CmdlineMeta(&pcm);
   CleanupAdjust(&adjust_file_info);
   free_cond(king_cutoff_fprefix);
@@ -12465,7 +12926,7 @@ int main(int argc, char** argv) {
     reterr = kPglRetWriteFail;
   }
   if (bigstack_ua) {
-    free(bigstack_ua);
+    CleanupBigstack(bigstack_ua);
   }
   return S_CAST(int32_t, reterr);
 }
@@ -0,0 +1,716 @@
+// This file is part of PLINK 2.0, copyright (C) 2005-2024 Shaun Purcell,
+// Christopher Chang.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "plink2_bgi.h"
+
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+// Minimal read-only SQLite reader.  Only the parts of the file format
+// exercised by bgenix-style .bgi indexes are supported.
+typedef struct SqliteDbStruct {
+  const unsigned char* data;
+  uint32_t page_size;
+  uint32_t usable_size;
+  uint32_t page_ct;
+  // Records which spill onto overflow pages are reassembled here.
+  uint32_t payload_buf_size;
+  unsigned char* payload_buf;
+} SqliteDb;
+
+typedef struct SqliteCursorStruct {
+  const SqliteDb* dbp;
+  uint32_t* page_stack;
+  uintptr_t* visited_pages;
+  uint32_t stack_size;
+  uint32_t page_type;
+  const unsigned char* page;
+  const unsigned char* cell_ptrs;
+  uint32_t cell_idx;
+  uint32_t cell_ct;
+} SqliteCursor;
+
+static inline uint32_t SqliteU16(const unsigned char* buf) {
+  return (S_CAST(uint32_t, buf[0]) << 8) | buf[1];
+}
+
+static inline uint32_t SqliteU32(const unsigned char* buf) {
+  return (S_CAST(uint32_t, buf[0]) << 24) | (S_CAST(uint32_t, buf[1]) << 16) | (S_CAST(uint32_t, buf[2]) << 8) | buf[3];
+}
+
+static BoolErr SqliteScanVarint(const unsigned char* buf_end, const unsigned char** buf_iterp, uint64_t* valp) {
+  const unsigned char* buf_iter = *buf_iterp;
+  uint64_t val = 0;
+  for (uint32_t byte_idx = 0; byte_idx != 8; ++byte_idx) {
+    if (buf_iter == buf_end) {
+      return 1;
+    }
+    const uint32_t cur_byte = *buf_iter++;
+    val = (val << 7) | (cur_byte & 127);
+    if (cur_byte < 128) {
+      *valp = val;
+      *buf_iterp = buf_iter;
+      return 0;
+    }
+  }
+  if (buf_iter == buf_end) {
+    return 1;
+  }
+  *valp = (val << 8) | (*buf_iter++);
+  *buf_iterp = buf_iter;
+  return 0;
+}
+
+static BoolErr SqliteDbInit(const unsigned char* data, uint64_t data_size, unsigned char* payload_buf, uint32_t payload_buf_size, SqliteDb* dbp) {
+  // the 16-byte magic string includes the null terminator
+  if ((data_size < 512) || (!memequal(data, "SQLite format 3", 16))) {
+    return 1;
+  }
+  uint32_t page_size = SqliteU16(&(data[16]));
+  if (page_size == 1) {
+    page_size = 65536;
+  }
+  // text encoding must be UTF-8
+  if ((page_size < 512) || (page_size & (page_size - 1)) || (SqliteU32(&(data[56])) != 1) || (data_size % page_size) || (data_size / page_size > UINT32_MAX)) {
+    return 1;
+  }
+  const uint32_t usable_size = page_size - data[20];
+  if (usable_size < 480) {
+    return 1;
+  }
+  dbp->data = data;
+  dbp->page_size = page_size;
+  dbp->usable_size = usable_size;
+  dbp->page_ct = data_size / page_size;
+  dbp->payload_buf_size = payload_buf_size;
+  dbp->payload_buf = payload_buf;
+  return 0;
+}
+
+// page_stack[] must have room for page_ct entries, and visited_pages[] must be
+// a zero-initialized bitarray of the same length.
+static void SqliteCursorInit(const SqliteDb* dbp, uint32_t root_page, uint32_t* page_stack, uintptr_t* visited_pages, SqliteCursor* cursorp) {
+  cursorp->dbp = dbp;
+  cursorp->page_stack = page_stack;
+  cursorp->visited_pages = visited_pages;
+  page_stack[0] = root_page;
+  cursorp->stack_size = 1;
+  cursorp->cell_idx = 0;
+  cursorp->cell_ct = 0;
+}
+
+static BoolErr SqliteCursorPush(uint32_t page_idx, SqliteCursor* cursorp) {
+  if (cursorp->stack_size == cursorp->dbp->page_ct) {
+    return 1;
+  }
+  cursorp->page_stack[cursorp->stack_size++] = page_idx;
+  return 0;
+}
+
+// Sets *payload_ptr and *payload_size_ptr to the next record in the b-tree
+// rooted at the cursor's initial page, or *payload_ptr to nullptr after the
+// last record.  Records are visited in no particular order; for index
+// b-trees (which include WITHOUT ROWID tables), that includes the keys
+// stored on interior pages.  Returns 1 on malformed input.
+static BoolErr SqliteCursorNext(SqliteCursor* cursorp, const unsigned char** payload_ptr, uint32_t* payload_size_ptr) {
+  const SqliteDb* dbp = cursorp->dbp;
+  const uint32_t usable_size = dbp->usable_size;
+  while (1) {
+    while (cursorp->cell_idx == cursorp->cell_ct) {
+      if (!cursorp->stack_size) {
+        *payload_ptr = nullptr;
+        return 0;
+      }
+      // 1-based
+      const uint32_t page_idx = cursorp->page_stack[--cursorp->stack_size];
+      if ((!page_idx) || (page_idx > dbp->page_ct) || IsSet(cursorp->visited_pages, page_idx - 1)) {
+        return 1;
+      }
+      SetBit(page_idx - 1, cursorp->visited_pages);
+      const unsigned char* page = &(dbp->data[S_CAST(uint64_t, page_idx - 1) * dbp->page_size]);
+      const unsigned char* page_header = (page_idx == 1)? (&(page[100])) : page;
+      const uint32_t page_type = page_header[0];
+      if ((page_type != 2) && (page_type != 5) && (page_type != 10) && (page_type != 13)) {
+        return 1;
+      }
+      const uint32_t cell_ct = SqliteU16(&(page_header[3]));
+      const unsigned char* cell_ptrs = &(page_header[8]);
+      if (page_type < 10) {
+        // interior page; right-most child pointer
+        if (SqliteCursorPush(SqliteU32(cell_ptrs), cursorp)) {
+          return 1;
+        }
+        cell_ptrs = &(cell_ptrs[4]);
+      }
+      if (S_CAST(uintptr_t, &(page[usable_size]) - cell_ptrs) < 2 * cell_ct) {
+        return 1;
+      }
+      cursorp->page_type = page_type;
+      cursorp->page = page;
+      cursorp->cell_ptrs = cell_ptrs;
+      cursorp->cell_idx = 0;
+      cursorp->cell_ct = cell_ct;
+    }
+    const unsigned char* page_end = &(cursorp->page[usable_size]);
+    const uint32_t cell_offset = SqliteU16(&(cursorp->cell_ptrs[2 * cursorp->cell_idx]));
+    ++cursorp->cell_idx;
+    if (cell_offset >= usable_size) {
+      return 1;
+    }
+    const unsigned char* cell_iter = &(cursorp->page[cell_offset]);
+    const uint32_t page_type = cursorp->page_type;
+    if (page_type < 10) {
+      if (cell_offset + 4 > usable_size) {
+        return 1;
+      }
+      if (SqliteCursorPush(SqliteU32(cell_iter), cursorp)) {
+        return 1;
+      }
+      if (page_type == 5) {
+        // table interior cells contain only a child pointer and a rowid
+        continue;
+      }
+      cell_iter = &(cell_iter[4]);
+    }
+    uint64_t payload_size;
+    if (SqliteScanVarint(page_end, &cell_iter, &payload_size)) {
+      return 1;
+    }
+    const uint32_t is_index = (page_type != 13);
+    if (!is_index) {
+      uint64_t rowid;
+      if (SqliteScanVarint(page_end, &cell_iter, &rowid)) {
+        return 1;
+      }
+    }
+    // See "Cell Payload Overflow Pages" in the SQLite file format spec.
+    const uint32_t max_local = is_index? ((((usable_size - 12) * 64) / 255) - 23) : (usable_size - 35);
+    if (payload_size <= max_local) {
+      if (S_CAST(uintptr_t, page_end - cell_iter) < payload_size) {
+        return 1;
+      }
+      *payload_ptr = cell_iter;
+      *payload_size_ptr = payload_size;
+      return 0;
+    }
+    if (payload_size > dbp->payload_buf_size) {
+      return 1;
+    }
+    const uint32_t min_local = (((usable_size - 12) * 32) / 255) - 23;
+    uint32_t local_size = min_local + ((payload_size - min_local) % (usable_size - 4));
+    if (local_size > max_local) {
+      local_size = min_local;
+    }
+    if (S_CAST(uintptr_t, page_end - cell_iter) < local_size + 4) {
+      return 1;
+    }
+    unsigned char* payload_write_iter = memcpyua(dbp->payload_buf, cell_iter, local_size);
+    uint32_t overflow_page_idx = SqliteU32(&(cell_iter[local_size]));
+    uint32_t bytes_left = payload_size - local_size;
+    // guard against cycles
+    for (uint32_t overflow_page_ct = 0; bytes_left; ++overflow_page_ct) {
+      if ((!overflow_page_idx) || (overflow_page_idx > dbp->page_ct) || (overflow_page_ct == dbp->page_ct)) {
+        return 1;
+      }
+      const unsigned char* overflow_page = &(dbp->data[S_CAST(uint64_t, overflow_page_idx - 1) * dbp->page_size]);
+      const uint32_t cur_size = MINV(bytes_left, usable_size - 4);
+      payload_write_iter = memcpyua(payload_write_iter, &(overflow_page[4]), cur_size);
+      bytes_left -= cur_size;
+      overflow_page_idx = SqliteU32(overflow_page);
+    }
+    *payload_ptr = dbp->payload_buf;
+    *payload_size_ptr = payload_size;
+    return 0;
+  }
+}
+
+// Locates column col_idx (in on-disk order) of a record.
+static BoolErr SqliteRecordCol(const unsigned char* payload, uint32_t payload_size, uint32_t col_idx, uint64_t* serial_type_ptr, const unsigned char** col_start_ptr, uint32_t* col_blen_ptr) {
+  const unsigned char* payload_end = &(payload[payload_size]);
+  const unsigned char* header_iter = payload;
+  uint64_t header_size;
+  if (SqliteScanVarint(payload_end, &header_iter, &header_size) || (header_size > payload_size)) {
+    return 1;
+  }
+  const unsigned char* header_end = &(payload[header_size]);
+  const unsigned char* body_iter = header_end;
+  for (uint32_t cur_col_idx = 0; ; ++cur_col_idx) {
+    uint64_t serial_type;
+    if (SqliteScanVarint(header_end, &header_iter, &serial_type)) {
+      return 1;
+    }
+    uint64_t col_blen;
+    if (serial_type >= 12) {
+      col_blen = (serial_type - 12) / 2;
+    } else if ((serial_type == 10) || (serial_type == 11)) {
+      return 1;
+    } else {
+      // 0 (NULL), 8, and 9 (integer constants 0 and 1) have no body
+      static const unsigned char kSerialTypeBlens[10] = {0, 1, 2, 3, 4, 6, 8, 8, 0, 0};
+      col_blen = kSerialTypeBlens[serial_type];
+    }
+    if (S_CAST(uint64_t, payload_end - body_iter) < col_blen) {
+      return 1;
+    }
+    if (cur_col_idx == col_idx) {
+      *serial_type_ptr = serial_type;
+      *col_start_ptr = body_iter;
+      *col_blen_ptr = col_blen;
+      return 0;
+    }
+    body_iter = &(body_iter[col_blen]);
+  }
+}
+
+static BoolErr SqliteRecordText(const unsigned char* payload, uint32_t payload_size, uint32_t col_idx, const char** text_ptr, uint32_t* slen_ptr) {
+  uint64_t serial_type;
+  const unsigned char* col_start;
+  if (SqliteRecordCol(payload, payload_size, col_idx, &serial_type, &col_start, slen_ptr) || (serial_type < 13) || (!(serial_type & 1))) {
+    return 1;
+  }
+  *text_ptr = R_CAST(const char*, col_start);
+  return 0;
+}
+
+static BoolErr SqliteRecordInt(const unsigned char* payload, uint32_t payload_size, uint32_t col_idx, int64_t* valp) {
+  uint64_t serial_type;
+  const unsigned char* col_start;
+  uint32_t col_blen;
+  if (SqliteRecordCol(payload, payload_size, col_idx, &serial_type, &col_start, &col_blen) || (!serial_type) || (serial_type == 7) || (serial_type >= 10)) {
+    return 1;
+  }
+  if (serial_type >= 8) {
+    *valp = serial_type - 8;
+    return 0;
+  }
+  // big-endian two's complement
+  uint64_t val = (col_start[0] & 128)? UINT64_MAX : 0;
+  for (uint32_t byte_idx = 0; byte_idx != col_blen; ++byte_idx) {
+    val = (val << 8) | col_start[byte_idx];
+  }
+  *valp = S_CAST(int64_t, val);
+  return 0;
+}
+
+static const char* SqliteSkipSpace(const char* sql_iter, const char* sql_end) {
+  while ((sql_iter < sql_end) && (ctou32(*sql_iter) <= ' ')) {
+    ++sql_iter;
+  }
+  return sql_iter;
+}
+
+static const char* SqliteSkipIdentifier(const char* sql_iter, const char* sql_end) {
+  while ((sql_iter < sql_end) && (ctou32(*sql_iter) > ' ') && (*sql_iter != ',') && (*sql_iter != '(') && (*sql_iter != ')')) {
+    ++sql_iter;
+  }
+  return sql_iter;
+}
+
+// Sets *name_start_ptr/*name_slen_ptr to the (unquoted) identifier starting at
+// sql_iter, and returns a pointer to the end of the identifier.
+static const char* SqliteIdentifier(const char* sql_iter, const char* sql_end, const char** name_start_ptr, uint32_t* name_slen_ptr) {
+  sql_iter = SqliteSkipSpace(sql_iter, sql_end);
+  const char* name_end = SqliteSkipIdentifier(sql_iter, sql_end);
+  const char* name_start = sql_iter;
+  if ((name_end != name_start) && ((*name_start == '"') || (*name_start == '`') || (*name_start == '[') || (*name_start == '\''))) {
+    ++name_start;
+    if ((name_end != name_start) && ((name_end[-1] == '"') || (name_end[-1] == '`') || (name_end[-1] == ']') || (name_end[-1] == '\''))) {
+      --name_end;
+    }
+  }
+  *name_start_ptr = name_start;
+  *name_slen_ptr = name_end - name_start;
+  return name_end;
+}
+
+CONSTI32(kSqliteMaxCols, 64);
+
+// Determines where the named columns of a CREATE TABLE statement are stored
+// in each record.  In a WITHOUT ROWID table, the PRIMARY KEY columns are
+// stored first.  Only identifier-level parsing is performed; quoted names
+// containing whitespace, commas or parentheses are not supported.
+static BoolErr SqliteTableColIdxs(const char* sql, uint32_t sql_slen, const char* const* col_names, uint32_t col_name_ct, uint32_t* col_idxs) {
+  const char* sql_end = &(sql[sql_slen]);
+  const char* body_start = S_CAST(const char*, memchr(sql, '(', sql_slen));
+  if (!body_start) {
+    return 1;
+  }
+  ++body_start;
+  const char* body_end = sql_end;
+  do {
+    if (body_end == body_start) {
+      return 1;
+    }
+    --body_end;
+  } while (*body_end != ')');
+  uint32_t without_rowid = 0;
+  {
+    const char* tail_iter = &(body_end[1]);
+    while (1) {
+      tail_iter = SqliteSkipSpace(tail_iter, sql_end);
+      if ((tail_iter >= sql_end) || (*tail_iter == ';')) {
+        break;
+      }
+      const char* token_end = SqliteSkipIdentifier(tail_iter, sql_end);
+      if (MatchUpperKLen(tail_iter, "ROWID", token_end - tail_iter)) {
+        without_rowid = 1;
+      }
+      if (token_end == tail_iter) {
+        ++token_end;
+      }
+      tail_iter = token_end;
+    }
+  }
+  // Collect column names, and the table-constraint PRIMARY KEY column list.
+  const char* col_starts[kSqliteMaxCols];
+  uint32_t col_slens[kSqliteMaxCols];
+  uint32_t col_ct = 0;
+  const char* pk_list_start = nullptr;
+  for (const char* item_start = body_start; item_start < body_end; ) {
+    // find end of comma-delimited item, respecting parentheses
+    const char* item_end = item_start;
+    uint32_t paren_depth = 0;
+    for (; item_end != body_end; ++item_end) {
+      const char cc = *item_end;
+      if (cc == '(') {
+        ++paren_depth;
+      } else if (cc == ')') {
+        if (!paren_depth) {
+          return 1;
+        }
+        --paren_depth;
+      } else if ((cc == ',') && (!paren_depth)) {
+        break;
+      }
+    }
+    const char* first_token = SqliteSkipSpace(item_start, item_end);
+    const char* first_token_end = SqliteSkipIdentifier(first_token, item_end);
+    const uint32_t first_token_slen = first_token_end - first_token;
+    if (MatchUpperKLen(first_token, "PRIMARY", first_token_slen)) {
+      pk_list_start = S_CAST(const char*, memchr(first_token_end, '(', item_end - first_token_end));
+      if (!pk_list_start) {
+        return 1;
+      }
+      ++pk_list_start;
+    } else if ((!MatchUpperKLen(first_token, "CONSTRAINT", first_token_slen)) &&
+               (!MatchUpperKLen(first_token, "UNIQUE", first_token_slen)) &&
+               (!MatchUpperKLen(first_token, "CHECK", first_token_slen)) &&
+               (!MatchUpperKLen(first_token, "FOREIGN", first_token_slen))) {
+      if (col_ct == kSqliteMaxCols) {
+        return 1;
+      }
+      SqliteIdentifier(item_start, item_end, &(col_starts[col_ct]), &(col_slens[col_ct]));
+      if (!col_slens[col_ct]) {
+        return 1;
+      }
+      ++col_ct;
+    }
+    item_start = &(item_end[1]);
+  }
+  // storage_order[i] = declaration index of the i-th stored column
+  uint32_t storage_order[kSqliteMaxCols];
+  uint32_t stored_ct = 0;
+  uintptr_t pk_cols[BitCtToWordCt(kSqliteMaxCols)];
+  ZeroWArr(BitCtToWordCt(kSqliteMaxCols), pk_cols);
+  if (without_rowid) {
+    if (!pk_list_start) {
+      return 1;
+    }
+    const char* pk_iter = pk_list_start;
+    while (1) {
+      const char* pk_name;
+      uint32_t pk_slen;
+      pk_iter = SqliteIdentifier(pk_iter, body_end, &pk_name, &pk_slen);
+      uint32_t col_idx = 0;
+      for (; col_idx != col_ct; ++col_idx) {
+        if ((col_slens[col_idx] == pk_slen) && memequal(col_starts[col_idx], pk_name, pk_slen)) {
+          break;
+        }
+      }
+      if ((col_idx == col_ct) || IsSet(pk_cols, col_idx)) {
+        return 1;
+      }
+      SetBit(col_idx, pk_cols);
+      storage_order[stored_ct++] = col_idx;
+      // skip ASC/DESC/COLLATE etc.
+      while ((pk_iter < body_end) && (*pk_iter != ',') && (*pk_iter != ')')) {
+        ++pk_iter;
+      }
+      if ((pk_iter == body_end) || (*pk_iter == ')')) {
+        break;
+      }
+      ++pk_iter;
+    }
+  }
+  for (uint32_t col_idx = 0; col_idx != col_ct; ++col_idx) {
+    if (!IsSet(pk_cols, col_idx)) {
+      storage_order[stored_ct++] = col_idx;
+    }
+  }
+  for (uint32_t name_idx = 0; name_idx != col_name_ct; ++name_idx) {
+    const char* cur_name = col_names[name_idx];
+    const uint32_t cur_slen = strlen(cur_name);
+    uint32_t stored_idx = 0;
+    for (; stored_idx != stored_ct; ++stored_idx) {
+      const uint32_t col_idx = storage_order[stored_idx];
+      if ((col_slens[col_idx] == cur_slen) && memequal(col_starts[col_idx], cur_name, cur_slen)) {
+        break;
+      }
+    }
+    if (stored_idx == stored_ct) {
+      return 1;
+    }
+    col_idxs[name_idx] = stored_idx;
+  }
+  return 0;
+}
+
+PglErr BgenIdxNextVariant(BgenIdxCursor* cursorp, FILE* bgenfile) {
+  if (!cursorp->run_variants_left) {
+    if (cursorp->run_idx == cursorp->run_ct) {
+      return kPglRetEof;
+    }
+    const BgenIdxRun* cur_run = &(cursorp->runs[cursorp->run_idx]);
+    ++cursorp->run_idx;
+    if (unlikely(fseeko(bgenfile, cur_run->foffset, SEEK_SET))) {
+      return kPglRetReadFail;
+    }
+    cursorp->run_variants_left = cur_run->variant_ct;
+  }
+  --cursorp->run_variants_left;
+  return kPglRetSuccess;
+}
+
+PglErr LoadBgenIdx(const char* bgenname, const ChrInfo* cip, uint64_t variant_data_foffset, uint32_t header_variant_ct, uint32_t prohibit_extra_chr, BgenIdxCursor* cursorp) {
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  FILE* idxfile = nullptr;
+  char idx_fname[kPglFnamesize];
+  cursorp->run_ct = 0;
+  BgenIdxRewind(cursorp);
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint32_t bgenname_slen = strlen(bgenname);
+    if (bgenname_slen + 5 > kPglFnamesize) {
+      goto LoadBgenIdx_ret_1;
+    }
+    snprintf(memcpya(idx_fname, bgenname, bgenname_slen), 5, ".bgi");
+    idxfile = fopen(idx_fname, FOPEN_RB);
+    if (!idxfile) {
+      goto LoadBgenIdx_ret_1;
+    }
+    uint64_t bgen_size = UINT64_MAX;
+#ifndef _WIN32
+    struct stat data_statbuf;
+    struct stat idx_statbuf;
+    if ((!stat(bgenname, &data_statbuf)) && (!stat(idx_fname, &idx_statbuf))) {
+      if (idx_statbuf.st_mtime < data_statbuf.st_mtime) {
+        logerrprintfww("Warning: %s is older than %s; ignoring it.\n", idx_fname, bgenname);
+        goto LoadBgenIdx_ret_1;
+      }
+      bgen_size = data_statbuf.st_size;
+    }
+#endif
+    if (unlikely(fseeko(idxfile, 0, SEEK_END))) {
+      goto LoadBgenIdx_ret_READ_FAIL;
+    }
+    const int64_t db_size = ftello(idxfile);
+    if (db_size < 0) {
+      goto LoadBgenIdx_ret_READ_FAIL;
+    }
+    // db contents, variant offsets, page stack, visited-page bitarray,
+    // payload buffer
+    const uint64_t payload_buf_size = MINV(S_CAST(uint64_t, db_size), 16LLU << 20);
+    const uint64_t page_ct_ub = db_size / 512;
+    if (S_CAST(uint64_t, db_size) + header_variant_ct * sizeof(int64_t) + page_ct_ub * (sizeof(int32_t) + 1) + payload_buf_size + 4 * kEndAllocAlign >= bigstack_left() / 2) {
+      // Don't turn a workable job into a NOMEM error.
+      logerrprintfww("Warning: Insufficient memory to load %s. Performing full --bgen scan instead.\n", idx_fname);
+      goto LoadBgenIdx_ret_1;
+    }
+    unsigned char* db_data = S_CAST(unsigned char*, bigstack_end_alloc_raw_rd(db_size));
+    rewind(idxfile);
+    if (unlikely(fread_checked(db_data, db_size, idxfile))) {
+      goto LoadBgenIdx_ret_READ_FAIL;
+    }
+    fclose(idxfile);
+    idxfile = nullptr;
+    unsigned char* payload_buf = S_CAST(unsigned char*, bigstack_end_alloc_raw_rd(payload_buf_size));
+    SqliteDb db;
+    if (SqliteDbInit(db_data, db_size, payload_buf, payload_buf_size, &db)) {
+      goto LoadBgenIdx_ret_MALFORMED;
+    }
+    uint32_t* page_stack = S_CAST(uint32_t*, bigstack_end_alloc_raw_rd(db.page_ct * sizeof(int32_t)));
+    const uintptr_t page_ctl = BitCtToWordCt(db.page_ct);
+    uintptr_t* visited_pages = S_CAST(uintptr_t*, bigstack_end_alloc_raw_rd(page_ctl * sizeof(intptr_t)));
+
+    // Find the Variant table in the schema table (page 1).
+    ZeroWArr(page_ctl, visited_pages);
+    SqliteCursor cursor;
+    SqliteCursorInit(&db, 1, page_stack, visited_pages, &cursor);
+    uint32_t variant_root_page = 0;
+    // chromosome, file_start_position
+    uint32_t col_idxs[2];
+    while (1) {
+      const unsigned char* payload;
+      uint32_t payload_size;
+      if (SqliteCursorNext(&cursor, &payload, &payload_size)) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      if (!payload) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      // schema columns: type, name, tbl_name, rootpage, sql
+      const char* type_str;
+      uint32_t type_slen;
+      const char* name_str;
+      uint32_t name_slen;
+      if (SqliteRecordText(payload, payload_size, 0, &type_str, &type_slen) ||
+          SqliteRecordText(payload, payload_size, 1, &name_str, &name_slen)) {
+        continue;
+      }
+      if ((!strequal_k(type_str, "table", type_slen)) || (!strequal_k(name_str, "Variant", name_slen))) {
+        continue;
+      }
+      int64_t root_page;
+      const char* sql;
+      uint32_t sql_slen;
+      if (SqliteRecordInt(payload, payload_size, 3, &root_page) ||
+          (root_page < 2) || (root_page > db.page_ct) ||
+          SqliteRecordText(payload, payload_size, 4, &sql, &sql_slen)) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      const char* col_names[2] = {"chromosome", "file_start_position"};
+      if (SqliteTableColIdxs(sql, sql_slen, col_names, 2, col_idxs)) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      variant_root_page = root_page;
+      break;
+    }
+
+    // Collect (file offset << 1) | may_be_kept for each variant.
+    uint64_t* variant_keys = S_CAST(uint64_t*, bigstack_end_alloc_raw_rd(header_variant_ct * sizeof(int64_t)));
+    ZeroWArr(page_ctl, visited_pages);
+    SqliteCursorInit(&db, variant_root_page, page_stack, visited_pages, &cursor);
+    char prev_chr_buf[kMaxIdBlen];
+    uint32_t prev_chr_slen = UINT32_MAX;
+    uint32_t prev_may_be_kept = 0;
+    uint32_t variant_ct = 0;
+    while (1) {
+      const unsigned char* payload;
+      uint32_t payload_size;
+      if (SqliteCursorNext(&cursor, &payload, &payload_size)) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      if (!payload) {
+        break;
+      }
+      const char* chr_name;
+      uint32_t chr_slen;
+      int64_t foffset;
+      if (SqliteRecordText(payload, payload_size, col_idxs[0], &chr_name, &chr_slen) ||
+          SqliteRecordInt(payload, payload_size, col_idxs[1], &foffset) ||
+          (S_CAST(uint64_t, foffset) < variant_data_foffset) ||
+          (S_CAST(uint64_t, foffset) >= bgen_size) ||
+          (variant_ct == header_variant_ct)) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      if ((chr_slen != prev_chr_slen) || (!memequal(chr_name, prev_chr_buf, chr_slen))) {
+        if (chr_slen > kMaxIdSlen) {
+          // let the main loop report the error
+          prev_chr_slen = UINT32_MAX;
+          prev_may_be_kept = 1;
+        } else {
+          memcpyx(prev_chr_buf, chr_name, chr_slen, '\0');
+          prev_chr_slen = chr_slen;
+          if (strequal_k(chr_name, "NA", chr_slen)) {
+            // same conversion as the main loop
+            prev_may_be_kept = ChrNameMayBeKept(cip, "0", 1, prohibit_extra_chr);
+          } else {
+            prev_may_be_kept = ChrNameMayBeKept(cip, prev_chr_buf, chr_slen, prohibit_extra_chr);
+          }
+        }
+      }
+      variant_keys[variant_ct++] = (S_CAST(uint64_t, foffset) << 1) | prev_may_be_kept;
+    }
+    if (variant_ct != header_variant_ct) {
+      logerrprintfww("Warning: %s and %s have different variant counts. Performing full --bgen scan instead.\n", idx_fname, bgenname);
+      goto LoadBgenIdx_ret_1;
+    }
+    STD_SORT(variant_ct, u64cmp, variant_keys);
+    if ((variant_keys[0] >> 1) != variant_data_foffset) {
+      goto LoadBgenIdx_ret_MALFORMED;
+    }
+    uint32_t keep_ct = 0;
+    uint32_t run_ct = 0;
+    uint32_t prev_kept = 0;
+    for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+      const uint64_t cur_key = variant_keys[variant_idx];
+      if (variant_idx && ((cur_key >> 1) == (variant_keys[variant_idx - 1] >> 1))) {
+        goto LoadBgenIdx_ret_MALFORMED;
+      }
+      const uint32_t cur_kept = cur_key & 1;
+      keep_ct += cur_kept;
+      run_ct += cur_kept & (~prev_kept);
+      prev_kept = cur_kept;
+    }
+    if ((!keep_ct) || (keep_ct == variant_ct)) {
+      // no point; let the main loop handle this
+      goto LoadBgenIdx_ret_1;
+    }
+    BgenIdxRun* runs;
+    if (unlikely(BIGSTACK_ALLOC_X(BgenIdxRun, run_ct, &runs))) {
+      goto LoadBgenIdx_ret_NOMEM;
+    }
+    BgenIdxRun* run_iter = runs;
+    prev_kept = 0;
+    for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+      const uint64_t cur_key = variant_keys[variant_idx];
+      const uint32_t cur_kept = cur_key & 1;
+      if (cur_kept) {
+        if (!prev_kept) {
+          run_iter->foffset = cur_key >> 1;
+          run_iter->variant_ct = 0;
+          ++run_iter;
+        }
+        run_iter[-1].variant_ct += 1;
+      }
+      prev_kept = cur_kept;
+    }
+    cursorp->runs = runs;
+    cursorp->run_ct = run_ct;
+    logprintfww("--bgen: Using %s to skip %u of %u variant%s.\n", idx_fname, variant_ct - keep_ct, variant_ct, (variant_ct == 1)? "" : "s");
+  }
+  while (0) {
+  LoadBgenIdx_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  LoadBgenIdx_ret_READ_FAIL:
+    logerrprintfww("Warning: Failed to read %s : %s. Performing full --bgen scan instead.\n", idx_fname, strerror(errno));
+    break;
+  LoadBgenIdx_ret_MALFORMED:
+    logerrprintfww("Warning: %s is not a valid index for %s. Performing full --bgen scan instead.\n", idx_fname, bgenname);
+    break;
+  }
+ LoadBgenIdx_ret_1:
+  fclose_cond(idxfile);
+  BigstackEndReset(bigstack_end_mark);
+  return reterr;
+}
+
+#ifdef __cplusplus
+}  // namespace plink2
+#endif
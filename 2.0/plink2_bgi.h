@@ -0,0 +1,66 @@
+#ifndef __PLINK2_BGI_H__
+#define __PLINK2_BGI_H__
+
+// This file is part of PLINK 2.0, copyright (C) 2005-2024 Shaun Purcell,
+// Christopher Chang.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Reader for bgenix-style .bgi indexes.  Import functions only support
+// chromosome filters, so all we take from the index is each variant's
+// chromosome and file offset; runs of file-adjacent variants which may be
+// kept are then read without touching anything in between.
+
+#include "plink2_common.h"
+
+#ifdef __cplusplus
+namespace plink2 {
+#endif
+
+// A maximal set of file-adjacent variants which must be read.
+typedef struct BgenIdxRunStruct {
+  uint64_t foffset;
+  uint32_t variant_ct;
+} BgenIdxRun;
+
+typedef struct BgenIdxCursorStruct {
+  BgenIdxRun* runs;
+  uint32_t run_ct;
+  uint32_t run_idx;
+  uint32_t run_variants_left;
+} BgenIdxCursor;
+
+HEADER_INLINE void BgenIdxRewind(BgenIdxCursor* cursorp) {
+  cursorp->run_idx = 0;
+  cursorp->run_variants_left = 0;
+}
+
+// Call before reading each variant record.  Jumps to the next run when the
+// current one is exhausted; returns kPglRetEof after the last run.
+PglErr BgenIdxNextVariant(BgenIdxCursor* cursorp, FILE* bgenfile);
+
+// Looks for bgenname + ".bgi".  If it's usable and at least one variant can
+// be skipped, the runs of variants which may be kept are allocated from the
+// bottom of bigstack; otherwise cursorp->run_ct is set to zero.  Only
+// kPglRetNomem is returned as an error; problems with the index file itself
+// just produce a warning, since the caller can always fall back on a full
+// scan.
+PglErr LoadBgenIdx(const char* bgenname, const ChrInfo* cip, uint64_t variant_data_foffset, uint32_t header_variant_ct, uint32_t prohibit_extra_chr, BgenIdxCursor* cursorp);
+
+#ifdef __cplusplus
+}  // namespace plink2
+#endif
+
+#endif  // __PLINK2_BGI_H__
@@ -27,6 +27,9 @@
 #include <fcntl.h>  // open()
 #include <time.h>  // time(), ctime()
 #include <unistd.h>  // getcwd(), gethostname(), sysconf(), fstat()
+#ifndef _WIN32
+#  include <sys/mman.h>  // mmap(), madvise(), mincore()
+#endif
 
 #ifdef __cplusplus
 namespace plink2 {
@@ -81,6 +84,16 @@ void logputs_silent(const char* str) {
   }
 }
 
+void LogTaskDequesIdle(const char* phase_descrip, const TaskDeques* tdqp) {
+  if (!tdqp->thread_ns) {
+    return;
+  }
+  const double idle_sec = u63tod(tdqp->idle_ns) * 1e-9;
+  const double thread_sec = u63tod(tdqp->thread_ns) * 1e-9;
+  snprintf(g_logbuf, kLogbufSize, "%s: %.3fs of %.3fs thread time idle at block barriers (%.1f%%).\n", phase_descrip, idle_sec, thread_sec, (100.0 * idle_sec) / thread_sec);
+  logputs_silent(g_logbuf);
+}
+
 void logputs(const char* str) {
   logputs_silent(str);
   fputs(str, stdout);
@@ -594,6 +607,24 @@ BoolErr CleanupLogfile(uint32_t print_end_time) {
 unsigned char* g_bigstack_base = nullptr;
 unsigned char* g_bigstack_end = nullptr;
 
+// Backing-store bookkeeping.  g_bigstack_map_size is zero when the workspace
+// came from malloc().
+CONSTI32(kHugePageSize, 2097152);
+
+ENUM_U31_DEF_START()
+  kBigstackPagesMalloc,
+  kBigstackPagesMmap,
+  kBigstackPagesThp,
+  kBigstackPagesHugetlb
+ENUM_U31_DEF_END(BigstackPageKind);
+
+static BigstackPageKind g_bigstack_page_kind = kBigstackPagesMalloc;
+static uintptr_t g_bigstack_map_size = 0;
+static unsigned char* g_bigstack_initial_base = nullptr;
+static unsigned char* g_bigstack_initial_end = nullptr;
+static uintptr_t g_bigstack_high_water = 0;
+static uint32_t g_bigstack_usage_untracked = 0;
+
 uint64_t DetectMib() {
   int64_t llxx;
   // return zero if detection failed
@@ -677,7 +708,55 @@ uint64_t GetMemAvailableKib() {
 #endif
 }
 
-PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr) {
+// Returns nullptr on failure.  On success, *map_size_ptr is set to the size
+// to pass to munmap(), or zero if the block should be freed with free().
+static unsigned char* BigstackMap(uintptr_t byte_ct, __maybe_unused BigstackFlags flags, uintptr_t* map_size_ptr) {
+#ifdef _WIN32
+  *map_size_ptr = 0;
+  g_bigstack_page_kind = kBigstackPagesMalloc;
+  return S_CAST(unsigned char*, malloc(byte_ct));
+#else
+  void* ptr;
+#  ifdef MAP_HUGETLB
+  if (flags & kfBigstackHugetlb) {
+    const uintptr_t map_size = RoundUpPow2(byte_ct, kHugePageSize);
+    ptr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      *map_size_ptr = map_size;
+      g_bigstack_page_kind = kBigstackPagesHugetlb;
+      return S_CAST(unsigned char*, ptr);
+    }
+  }
+#  endif
+  // Extra huge page so the usable region can be aligned to a huge page
+  // boundary.
+  const uintptr_t map_size = byte_ct + kHugePageSize;
+  ptr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+  *map_size_ptr = map_size;
+  g_bigstack_page_kind = kBigstackPagesMmap;
+#  ifdef MADV_HUGEPAGE
+  if (!madvise(ptr, map_size, MADV_HUGEPAGE)) {
+    g_bigstack_page_kind = kBigstackPagesThp;
+  }
+#  endif
+  return S_CAST(unsigned char*, ptr);
+#endif
+}
+
+static void BigstackUnmap(unsigned char* bigstack_ua, uintptr_t map_size) {
+#ifndef _WIN32
+  if (map_size) {
+    munmap(bigstack_ua, map_size);
+    return;
+  }
+#endif
+  free(bigstack_ua);
+}
+
+PglErr InitBigstack(uintptr_t malloc_size_mib, BigstackFlags flags, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr) {
   // guarantee contiguous malloc space outside of main workspace
   unsigned char* bubble;
 
@@ -693,14 +772,15 @@ PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr,
 #endif
   // don't use pgl_malloc here since we don't automatically want to set
   // g_failed_alloc_attempt_size on failure
-  unsigned char* bigstack_ua = S_CAST(unsigned char*, malloc(malloc_size_mib * 1048576 * sizeof(char)));
+  uintptr_t map_size;
+  unsigned char* bigstack_ua = BigstackMap(malloc_size_mib * 1048576 * sizeof(char), flags, &map_size);
   // this is thwarted by overcommit, but still better than nothing...
   while (!bigstack_ua) {
     malloc_size_mib = (malloc_size_mib * 3) / 4;
     if (malloc_size_mib < kBigstackMinMib) {
       malloc_size_mib = kBigstackMinMib;
     }
-    bigstack_ua = S_CAST(unsigned char*, malloc(malloc_size_mib * 1048576 * sizeof(char)));
+    bigstack_ua = BigstackMap(malloc_size_mib * 1048576 * sizeof(char), flags, &map_size);
     if (unlikely((!bigstack_ua) && (malloc_size_mib == kBigstackMinMib))) {
       // switch to "goto cleanup" pattern if any more exit points are needed
       g_failed_alloc_attempt_size = kBigstackMinMib * 1048576;
@@ -708,11 +788,22 @@ PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr,
       return kPglRetNomem;
     }
   }
-  // force 64-byte align to make cache line sensitivity work
-  unsigned char* bigstack_initial_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, bigstack_ua), kCacheline));
+  g_bigstack_map_size = map_size;
+  // force 64-byte align to make cache line sensitivity work; mmapped
+  // workspaces are huge-page-aligned, so khugepaged doesn't have to split the
+  // first and last pages
+  unsigned char* bigstack_initial_base;
+  if (map_size) {
+    bigstack_initial_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, bigstack_ua), kHugePageSize));
+  } else {
+    bigstack_initial_base = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, bigstack_ua), kCacheline));
+  }
   g_bigstack_base = bigstack_initial_base;
   // last 576 bytes now reserved for g_one_char_strs + overread buffer
-  g_bigstack_end = &(bigstack_initial_base[RoundDownPow2(malloc_size_mib * 1048576 - 576 - S_CAST(uintptr_t, bigstack_initial_base - bigstack_ua), kCacheline)]);
+  const uintptr_t ua_byte_ct = map_size? map_size : (malloc_size_mib * 1048576);
+  g_bigstack_end = &(bigstack_initial_base[RoundDownPow2(MINV(malloc_size_mib * 1048576, ua_byte_ct - S_CAST(uintptr_t, bigstack_initial_base - bigstack_ua)) - 576, kCacheline)]);
+  g_bigstack_initial_base = bigstack_initial_base;
+  g_bigstack_initial_end = g_bigstack_end;
   free(bubble);
   uintptr_t* one_char_iter = R_CAST(uintptr_t*, g_bigstack_end);
 #ifdef __LP64__
@@ -736,6 +827,241 @@ PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr,
   return kPglRetSuccess;
 }
 
+void CleanupBigstack(unsigned char* bigstack_ua) {
+  BigstackUnmap(bigstack_ua, g_bigstack_map_size);
+  g_bigstack_base = nullptr;
+  g_bigstack_end = nullptr;
+}
+
+const char* BigstackPageDesc() {
+  switch (g_bigstack_page_kind) {
+  case kBigstackPagesMmap:
+    return "anonymous mmap";
+  case kBigstackPagesThp:
+    return "anonymous mmap, transparent huge pages requested";
+  case kBigstackPagesHugetlb:
+    return "explicit huge pages";
+  default:
+    return "malloc";
+  }
+}
+
+#ifdef __linux__
+// Number of resident bytes in [start, end); start must be page-aligned.
+static uintptr_t BigstackResidentByteCt(unsigned char* start, const unsigned char* end) {
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  unsigned char vec[4096];
+  uintptr_t resident_page_ct = 0;
+  while (start < end) {
+    const uintptr_t page_ct = MINV(DivUp(S_CAST(uintptr_t, end - start), page_size), 4096);
+    if (mincore(start, page_ct * page_size, vec)) {
+      return 0;
+    }
+    for (uintptr_t page_idx = 0; page_idx != page_ct; ++page_idx) {
+      resident_page_ct += vec[page_idx] & 1;
+    }
+    start = &(start[page_ct * page_size]);
+  }
+  return resident_page_ct * page_size;
+}
+
+static uint32_t BigstackUsageTracked() {
+  return g_bigstack_map_size && (!g_bigstack_usage_untracked);
+}
+
+void BigstackReleaseFree() {
+  if (!BigstackUsageTracked()) {
+    return;
+  }
+  // Whole huge pages only, so surviving allocations don't get split off.
+  unsigned char* discard_start = R_CAST(unsigned char*, RoundUpPow2(R_CAST(uintptr_t, g_bigstack_base), kHugePageSize));
+  unsigned char* discard_end = R_CAST(unsigned char*, RoundDownPow2(R_CAST(uintptr_t, g_bigstack_end), kHugePageSize));
+  if (discard_start < discard_end) {
+    madvise(discard_start, discard_end - discard_start, MADV_DONTNEED);
+  }
+}
+
+void LogBigstackPeak(const char* cmd_name) {
+  if (!BigstackUsageTracked()) {
+    return;
+  }
+  const uintptr_t peak = BigstackResidentByteCt(g_bigstack_initial_base, g_bigstack_initial_end);
+  if (peak > g_bigstack_high_water) {
+    g_bigstack_high_water = peak;
+  }
+  snprintf(g_logbuf, kLogbufSize, "%s: Peak workspace usage %" PRIuPTR " MiB.\n", cmd_name, DivUp(peak, 1048576));
+  logputs_silent(g_logbuf);
+}
+
+void LogBigstackHighWater() {
+  if (!BigstackUsageTracked()) {
+    return;
+  }
+  const uintptr_t cur_usage = BigstackResidentByteCt(g_bigstack_initial_base, g_bigstack_initial_end);
+  if (cur_usage > g_bigstack_high_water) {
+    g_bigstack_high_water = cur_usage;
+  }
+  snprintf(g_logbuf, kLogbufSize, "Workspace high-water mark: %" PRIuPTR " of %" PRIuPTR " MiB.\n", DivUp(g_bigstack_high_water, 1048576), S_CAST(uintptr_t, g_bigstack_initial_end - g_bigstack_initial_base) / 1048576);
+  logputs_silent(g_logbuf);
+}
+#else
+void BigstackReleaseFree() {
+}
+
+void LogBigstackPeak(__maybe_unused const char* cmd_name) {
+}
+
+void LogBigstackHighWater() {
+}
+#endif
+
+void DisableBigstackUsageTracking() {
+  g_bigstack_usage_untracked = 1;
+}
+
+#ifndef _WIN32
+CONSTI32(kMaxSpillAllocs, 16);
+
+typedef struct SpillAllocStruct {
+  unsigned char* base;
+  uint64_t byte_ct;
+} SpillAlloc;
+
+static char* g_spill_dir = nullptr;
+static SpillAlloc g_spill_allocs[kMaxSpillAllocs];
+static uint64_t g_spill_cur_byte_ct = 0;
+static uint64_t g_spill_peak_byte_ct = 0;
+static uint64_t g_spill_total_byte_ct = 0;
+static uint32_t g_spill_alloc_ct = 0;
+
+BoolErr SetSpillDir(const char* dirname) {
+  struct stat statbuf;
+  if (stat(dirname, &statbuf) || (!S_ISDIR(statbuf.st_mode)) || access(dirname, W_OK | X_OK)) {
+    return 1;
+  }
+  free_cond(g_spill_dir);
+  g_spill_dir = strdup(dirname);
+  return !g_spill_dir;
+}
+
+BoolErr SpillCalloc(uint64_t byte_ct, const char* purpose, void** ptr_ptr) {
+  if ((!g_spill_dir) || (!byte_ct)) {
+    return 1;
+  }
+#ifndef __LP64__
+  if (byte_ct > 0x7fffffff) {
+    return 1;
+  }
+#endif
+  uint32_t slot_idx = 0;
+  for (; slot_idx != kMaxSpillAllocs; ++slot_idx) {
+    if (!g_spill_allocs[slot_idx].base) {
+      break;
+    }
+  }
+  if (slot_idx == kMaxSpillAllocs) {
+    return 1;
+  }
+  char fname[kPglFnamesize];
+  if (snprintf(fname, kPglFnamesize, "%s/plink2-spill-XXXXXX", g_spill_dir) >= kPglFnamesize) {
+    return 1;
+  }
+  const int32_t fd = mkstemp(fname);
+  if (fd == -1) {
+    return 1;
+  }
+  unlink(fname);
+  // Reserve the blocks up front, so a full disk is reported here instead of
+  // via SIGBUS in the middle of a computation.  Fresh blocks read as zero.
+  void* spill_map = MAP_FAILED;
+  if (!posix_fallocate(fd, 0, byte_ct)) {
+    spill_map = mmap(nullptr, byte_ct, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (spill_map == MAP_FAILED) {
+    return 1;
+  }
+  g_spill_allocs[slot_idx].base = S_CAST(unsigned char*, spill_map);
+  g_spill_allocs[slot_idx].byte_ct = byte_ct;
+  g_spill_cur_byte_ct += byte_ct;
+  if (g_spill_cur_byte_ct > g_spill_peak_byte_ct) {
+    g_spill_peak_byte_ct = g_spill_cur_byte_ct;
+  }
+  g_spill_total_byte_ct += byte_ct;
+  ++g_spill_alloc_ct;
+  logprintfww("%s: Main workspace exhausted; spilling %" PRIu64 " MiB to %s .\n", purpose, DivUpU64(byte_ct, 1048576), g_spill_dir);
+  *ptr_ptr = spill_map;
+  return 0;
+}
+
+void SpillFree(const void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  for (uint32_t slot_idx = 0; slot_idx != kMaxSpillAllocs; ++slot_idx) {
+    if (g_spill_allocs[slot_idx].base == ptr) {
+      munmap(g_spill_allocs[slot_idx].base, g_spill_allocs[slot_idx].byte_ct);
+      g_spill_cur_byte_ct -= g_spill_allocs[slot_idx].byte_ct;
+      g_spill_allocs[slot_idx].base = nullptr;
+      return;
+    }
+  }
+}
+
+uint32_t IsSpilled(const void* ptr) {
+  if (!ptr) {
+    return 0;
+  }
+  for (uint32_t slot_idx = 0; slot_idx != kMaxSpillAllocs; ++slot_idx) {
+    if (g_spill_allocs[slot_idx].base == ptr) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void LogSpillTotals() {
+  if (!g_spill_alloc_ct) {
+    return;
+  }
+  snprintf(g_logbuf, kLogbufSize, "Spilled to disk: %" PRIu64 " MiB in %u buffer%s (peak %" PRIu64 " MiB at once).\n", DivUpU64(g_spill_total_byte_ct, 1048576), g_spill_alloc_ct, (g_spill_alloc_ct == 1)? "" : "s", DivUpU64(g_spill_peak_byte_ct, 1048576));
+  logputs_silent(g_logbuf);
+}
+
+void CleanupSpillArena() {
+  for (uint32_t slot_idx = 0; slot_idx != kMaxSpillAllocs; ++slot_idx) {
+    if (g_spill_allocs[slot_idx].base) {
+      munmap(g_spill_allocs[slot_idx].base, g_spill_allocs[slot_idx].byte_ct);
+      g_spill_allocs[slot_idx].base = nullptr;
+    }
+  }
+  g_spill_cur_byte_ct = 0;
+  free_cond(g_spill_dir);
+  g_spill_dir = nullptr;
+}
+#else
+BoolErr SetSpillDir(__maybe_unused const char* dirname) {
+  return 1;
+}
+
+BoolErr SpillCalloc(__maybe_unused uint64_t byte_ct, __maybe_unused const char* purpose, __maybe_unused void** ptr_ptr) {
+  return 1;
+}
+
+void SpillFree(__maybe_unused const void* ptr) {
+}
+
+uint32_t IsSpilled(__maybe_unused const void* ptr) {
+  return 0;
+}
+
+void LogSpillTotals() {
+}
+
+void CleanupSpillArena() {
+}
+#endif
+
 
 BoolErr bigstack_calloc_uc(uintptr_t ct, unsigned char** uc_arr_ptr) {
   *uc_arr_ptr = S_CAST(unsigned char*, bigstack_alloc(ct));
@@ -4235,7 +4561,7 @@ PglErr CmdlineParsePhase2(const char* ver_str, const char* errstr_append, const
   return reterr;
 }
 
-PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, uint32_t memory_require, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr) {
+PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, BigstackFlags bigstack_flags, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr) {
   PglErr reterr = kPglRetSuccess;
   {
     if (pcmp->subst_argv) {
@@ -4288,7 +4614,7 @@ PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib,
         logprintf("%" PRIu64 " MiB RAM detected; reserving %" PRIuPTR " MiB for main workspace.\n", total_mib, malloc_size_mib);
       } else {
         const uint64_t mem_available_mib = mem_available_kib / 1024;
-        if ((mem_available_mib < malloc_size_mib + (kNonBigstackMin >> 20)) && (!memory_require)) {
+        if ((mem_available_mib < malloc_size_mib + (kNonBigstackMin >> 20)) && (!(bigstack_flags & kfBigstackRequire))) {
           if (mem_available_mib < kBigstackMinMib + (kNonBigstackMin >> 20)) {
             malloc_size_mib = kBigstackMinMib;
           } else {
@@ -4301,11 +4627,16 @@ PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib,
       logprintf("Failed to determine total system memory.  Attempting to reserve %" PRIuPTR " MiB.\n", malloc_size_mib);
     }
     uintptr_t malloc_mib_final;
-    if (unlikely(InitBigstack(malloc_size_mib, &malloc_mib_final, bigstack_ua_ptr))) {
+    if (unlikely(InitBigstack(malloc_size_mib, bigstack_flags, &malloc_mib_final, bigstack_ua_ptr))) {
       goto CmdlineParsePhase3_ret_NOMEM;
     }
+    if ((bigstack_flags & kfBigstackHugetlb) && (g_bigstack_page_kind != kBigstackPagesHugetlb)) {
+      logerrputs("Warning: Unable to reserve explicit huge pages for the main workspace (check\n/proc/sys/vm/nr_hugepages); using regular pages instead.\n");
+    }
+    snprintf(g_logbuf, kLogbufSize, "Workspace backing: %s.\n", BigstackPageDesc());
+    logputs_silent(g_logbuf);
     if (malloc_size_mib != malloc_mib_final) {
-      if (unlikely(memory_require)) {
+      if (unlikely(bigstack_flags & kfBigstackRequire)) {
         goto CmdlineParsePhase3_ret_NOMEM;
       }
       logprintf("Allocated %" PRIuPTR " MiB successfully, after larger attempt(s) failed.\n", malloc_mib_final);
@@ -200,6 +200,10 @@ HEADER_INLINE void logprintfww5(const char* fmt, ...) {
   logputsb();
 }
 
+// Log-file only.  Reports the time worker threads spent idle at block
+// barriers over a TaskDeques-scheduled phase.
+void LogTaskDequesIdle(const char* phase_descrip, const TaskDeques* tdqp);
+
 HEADER_INLINE void DebugPrintf(const char* fmt, ...) {
   if (g_debug_on) {
     va_list args;
@@ -519,8 +523,64 @@ uintptr_t GetDefaultAllocMib();
 // Uses g_textbuf.
 uint64_t GetMemAvailableKib();
 
-// caller is responsible for freeing bigstack_ua
-PglErr InitBigstack(uintptr_t malloc_size_mib, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr);
+FLAGSET_DEF_START()
+  kfBigstack0,
+  // error out instead of shrinking the request when it can't be satisfied
+  kfBigstackRequire = (1 << 0),
+  // try explicitly reserved (MAP_HUGETLB) huge pages first
+  kfBigstackHugetlb = (1 << 1)
+FLAGSET_DEF_END(BigstackFlags);
+
+// On Unix-like systems, the workspace is an anonymous mmap (2 MiB-aligned and
+// marked MADV_HUGEPAGE where supported, to cut TLB misses on big random-access
+// workloads) instead of a malloc.  Caller is responsible for calling
+// CleanupBigstack(bigstack_ua).
+PglErr InitBigstack(uintptr_t malloc_size_mib, BigstackFlags flags, uintptr_t* malloc_mib_final_ptr, unsigned char** bigstack_ua_ptr);
+
+void CleanupBigstack(unsigned char* bigstack_ua);
+
+// Short description of what's backing the workspace ("transparent huge
+// pages", etc.), for the log.
+const char* BigstackPageDesc();
+
+// Workspace usage instrumentation (Linux only; no-ops elsewhere, and after
+// --randmem touches the whole workspace).  Usage is measured as the number of
+// resident workspace pages, so it also counts memory a command claimed
+// implicitly with bigstack_left().
+// LogBigstackPeak() logs (to the .log only) the workspace peak since the
+// previous BigstackReleaseFree() call.
+void LogBigstackPeak(const char* cmd_name);
+
+// Logs the whole-run high-water mark (.log only).
+void LogBigstackHighWater();
+
+// Call after deliberately touching every workspace page.
+void DisableBigstackUsageTracking();
+
+// File-backed overflow arena (--spill-dir; Unix-like systems only).  A few
+// large matrices that are allocated once and released as a unit (the GRM, the
+// missingness-correction triangle, the "--pca approx" projection matrix) fall
+// back to this when the main workspace is exhausted.  Each spilled buffer is
+// an mmap of its own temporary file, which is unlinked immediately so nothing
+// is left behind if the process is killed; the kernel pages it in and out as
+// needed, so throughput degrades with disk speed instead of the run aborting.
+BoolErr SetSpillDir(const char* dirname);
+
+// Zero-initialized.  Returns 1 (without logging an error) if spilling is
+// disabled or the file can't be created at full size; otherwise logs the
+// spill.
+BoolErr SpillCalloc(uint64_t byte_ct, const char* purpose, void** ptr_ptr);
+
+// No-op on nullptr and on pointers that weren't returned by SpillCalloc(), so
+// it's safe to call on the result of a bigstack_or_spill_...() call.
+void SpillFree(const void* ptr);
+
+uint32_t IsSpilled(const void* ptr);
+
+// Logs (to the .log only) how much was spilled over the whole run.
+void LogSpillTotals();
+
+void CleanupSpillArena();
 
 
 HEADER_INLINE uintptr_t bigstack_left() {
@@ -832,6 +892,28 @@ HEADER_INLINE BoolErr bigstack_calloc64_d(uint64_t ct, double** d_arr_ptr) {
 BoolErr bigstack_calloc64_d(uint64_t ct, double** d_arr_ptr);
 #endif
 
+// Fall back on the spill arena when the main workspace is exhausted.
+// Release with SpillFree() in addition to the usual bigstack reset.
+HEADER_INLINE BoolErr bigstack_or_spill_calloc64_d(uint64_t ct, const char* purpose, double** d_arr_ptr) {
+  if (!bigstack_calloc64_d(ct, d_arr_ptr)) {
+    return 0;
+  }
+  return SpillCalloc(ct * sizeof(double), purpose, R_CAST(void**, d_arr_ptr));
+}
+
+HEADER_INLINE BoolErr bigstack_or_spill_calloc64_u32(uint64_t ct, const char* purpose, uint32_t** u32_arr_ptr) {
+#ifdef __LP64__
+  if (!bigstack_calloc_u32(ct, u32_arr_ptr)) {
+    return 0;
+  }
+#else
+  if ((ct <= 0x7fffffff / sizeof(int32_t)) && (!bigstack_calloc_u32(ct, u32_arr_ptr))) {
+    return 0;
+  }
+#endif
+  return SpillCalloc(ct * sizeof(int32_t), purpose, R_CAST(void**, u32_arr_ptr));
+}
+
 #if __cplusplus >= 201103L
 
 template <class T> BoolErr BigstackAllocX(uintptr_t ct, T** x_arr_ptr) {
@@ -867,6 +949,13 @@ HEADER_INLINE void BigstackDoubleReset(void* new_base, void* new_end) {
   BigstackEndReset(new_end);
 }
 
+// Returns the currently-free part of the workspace to the OS.  This is a
+// syscall, so only call it between top-level commands (after
+// LogBigstackPeak()), not in ordinary BigstackReset() paths; the next
+// LogBigstackPeak() call then measures the next command in isolation.  No-op
+// when workspace usage isn't tracked.
+void BigstackReleaseFree();
+
 // assumes we've already been writing to wptr and have previously performed
 // bounds-checking.
 HEADER_INLINE void BigstackFinalizeW(__maybe_unused const uintptr_t* wptr, uintptr_t ct) {
@@ -2092,7 +2181,7 @@ HEADER_INLINE void InvalidArg(const char* cur_arg) {
   logpreprintfww("Error: Unrecognized flag ('%s').\n", cur_arg);
 }
 
-PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, uint32_t memory_require, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr);
+PglErr CmdlineParsePhase3(uintptr_t max_default_mib, uintptr_t malloc_size_mib, BigstackFlags bigstack_flags, Plink2CmdlineMeta* pcmp, unsigned char** bigstack_ua_ptr);
 
 void CleanupPlink2CmdlineMeta(Plink2CmdlineMeta* pcmp);
 
@@ -2209,6 +2209,26 @@ PglErr TryToAddChrName(const char* chr_name, const char* file_descrip, uintptr_t
   return kPglRetSuccess;
 }
 
+uint32_t ChrNameMayBeKept(const ChrInfo* cip, const char* chr_name, uint32_t name_slen, uint32_t prohibit_extra_chr) {
+  const uint32_t chr_code = GetChrCode(chr_name, cip, name_slen);
+  if (!IsI32Neg(chr_code)) {
+    return IsSet(cip->chr_mask, chr_code);
+  }
+  if ((chr_code == UINT32_MAXM1) || prohibit_extra_chr) {
+    // let the main loop report the error
+    return 1;
+  }
+  // Same rule as TryToAddChrName() above.
+  uint32_t in_name_stack = 0;
+  for (const LlStr* name_stack_ptr = cip->incl_excl_name_stack; name_stack_ptr; name_stack_ptr = name_stack_ptr->next) {
+    if (!strcmp(chr_name, name_stack_ptr->str)) {
+      in_name_stack = 1;
+      break;
+    }
+  }
+  return (in_name_stack == cip->is_include_stack);
+}
+
 
 /*
 uintptr_t count_11_vecs(const VecW* geno_vvec, uintptr_t vec_ct) {
@@ -3406,6 +3426,85 @@ PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint
   return kPglRetSuccess;
 }
 
+void PgenMtLoadMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, uint32_t calc_thread_ct, uintptr_t thread_xalloc_byte_ct, uintptr_t per_variant_xalloc_byte_ct, MemReq* mrp) {
+  const uint64_t thread_alloc = (2 + 1 + NypCtToCachelineCt(sample_ct)) * S_CAST(uint64_t, kCacheline) + RoundUpPow2(sizeof(PgenReader), kCacheline) + EstimatePgrAllocByteCt(sample_ct) + thread_xalloc_byte_ct;
+  const uint64_t variant_byte_ct = record_byte_ct + per_variant_xalloc_byte_ct;
+  // PgenMtLoadInit() wants 4x the double-buffered block allocation to be
+  // available, and the per-thread allocations come out of what's left after
+  // the two load buffers.
+  const uint64_t min_block_alloc = S_CAST(uint64_t, kBitsPerVec) * variant_byte_ct;
+  mrp->min_byte_ct = MAXV(4 * min_block_alloc, 2 * min_block_alloc + thread_alloc);
+  uint32_t full_read_block_size = kPglVblockSize;
+  if (variant_ct < full_read_block_size) {
+    full_read_block_size = RoundUpPow2(MAXV(variant_ct, 1), kBitsPerVec);
+  }
+  if (calc_thread_ct > full_read_block_size) {
+    calc_thread_ct = full_read_block_size;
+  }
+  const uint64_t full_block_alloc = S_CAST(uint64_t, full_read_block_size) * variant_byte_ct;
+  mrp->comfortable_byte_ct = MAXV(4 * full_block_alloc, 2 * full_block_alloc + calc_thread_ct * thread_alloc);
+}
+
+void PreinitPgenTaskRunner(PgenTaskRunner* runnerp) {
+  PreinitThreads(&runnerp->tg);
+  runnerp->task_func = nullptr;
+  runnerp->task_arg = nullptr;
+  runnerp->task_ct = 0;
+  runnerp->thread_ct = 0;
+}
+
+THREAD_FUNC_DECL PgenTaskRunnerThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  PgenTaskRunner* runnerp = S_CAST(PgenTaskRunner*, arg->sharedp->context);
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
+  do {
+    const uint32_t task_ct = runnerp->task_ct;
+    PglTaskFunc task_func = runnerp->task_func;
+    void* task_arg = runnerp->task_arg;
+    for (uint32_t task_idx = tidx; task_idx < task_ct; task_idx += thread_ct) {
+      task_func(task_arg, task_idx);
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+PglErr InitPgenTaskRunner(uint32_t thread_ct, PgenTaskRunner* runnerp) {
+  if (unlikely(SetThreadCt(thread_ct, &runnerp->tg))) {
+    return kPglRetNomem;
+  }
+  SetThreadFuncAndData(PgenTaskRunnerThread, runnerp, &runnerp->tg);
+  runnerp->thread_ct = thread_ct;
+  return kPglRetSuccess;
+}
+
+void PgenTaskRunnerParallelFor(void* runner_arg, uint32_t task_ct, PglTaskFunc task_func, void* task_arg) {
+  PgenTaskRunner* runnerp = S_CAST(PgenTaskRunner*, runner_arg);
+  ThreadGroup* tgp = &runnerp->tg;
+  if (runnerp->thread_ct) {
+    runnerp->task_func = task_func;
+    runnerp->task_arg = task_arg;
+    runnerp->task_ct = task_ct;
+    if (likely(!SpawnThreads(tgp))) {
+      JoinThreads(tgp);
+      return;
+    }
+    // don't try again
+    CleanupThreads(tgp);
+    runnerp->thread_ct = 0;
+  }
+  for (uint32_t task_idx = 0; task_idx != task_ct; ++task_idx) {
+    task_func(task_arg, task_idx);
+  }
+}
+
+void CleanupPgenTaskRunner(PgenTaskRunner* runnerp) {
+  CleanupThreads(&runnerp->tg);
+  runnerp->thread_ct = 0;
+}
+
+uint32_t g_pgen_readahead_block_ct = 1;
+
 uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp) {
   if (IsLastBlock(tgp)) {
     return 0;
@@ -3432,10 +3531,204 @@ uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup*
     }
   }
   *read_block_idxp = read_block_idx;
-  *reterrp = PgfiMultiread(variant_include, offset, offset + cur_read_block_size, cur_block_write_ct, pgfip);
+  const uint32_t variant_uidx_end = offset + cur_read_block_size;
+  *reterrp = PgfiMultiread(variant_include, offset, variant_uidx_end, cur_block_write_ct, pgfip);
+  const uint32_t readahead_block_ct = g_pgen_readahead_block_ct;
+  if (readahead_block_ct && (variant_uidx_end < raw_variant_ct)) {
+    // The caller hands this block to the worker threads and then calls us
+    // again for the next one; ask the kernel to start on that read now, so
+    // that it overlaps with the computation.
+    uint32_t readahead_uidx_end = raw_variant_ct;
+    if (S_CAST(uint64_t, readahead_block_ct) * read_block_size < raw_variant_ct - variant_uidx_end) {
+      readahead_uidx_end = variant_uidx_end + readahead_block_ct * read_block_size;
+    }
+    PgfiMultireadAdvise(variant_include, variant_uidx_end, readahead_uidx_end, pgfip);
+  }
   return cur_block_write_ct;
 }
 
+typedef struct ValidatePgenCtxStruct {
+  uint32_t variant_ct;
+  PgenReader** pgr_ptrs;
+  uintptr_t** genovec_bufs;
+  char** errstr_bufs;
+
+  uint32_t cur_vblock_idx_start;
+
+  uint64_t err_info;
+} ValidatePgenCtx;
+
+THREAD_FUNC_DECL ValidatePgenThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  ValidatePgenCtx* ctx = S_CAST(ValidatePgenCtx*, arg->sharedp->context);
+
+  const uint32_t variant_ct = ctx->variant_ct;
+  PgenReader* pgrp = ctx->pgr_ptrs[tidx];
+  uintptr_t* genovec_buf = ctx->genovec_bufs[tidx];
+  char* errstr_buf = ctx->errstr_bufs[tidx];
+  do {
+    const uint32_t vblock_idx = ctx->cur_vblock_idx_start + tidx;
+    const uint32_t variant_idx_start = vblock_idx * kPglVblockSize;
+    if (variant_idx_start < variant_ct) {
+      const uint32_t variant_idx_end = MINV(variant_idx_start + kPglVblockSize, variant_ct);
+      const PglErr reterr = PgrValidateRecords(variant_idx_start, variant_idx_end, pgrp, genovec_buf, errstr_buf);
+      if (unlikely(reterr)) {
+        // Records within a vblock are validated in order, so the
+        // lowest-index failing vblock reports the lowest-index failing
+        // variant.
+        const uint64_t new_err_info = (S_CAST(uint64_t, vblock_idx) << 32) | S_CAST(uint32_t, reterr);
+        UpdateU64IfSmaller(new_err_info, &ctx->err_info);
+      }
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+PglErr ValidatePgen(const char* pgenname, uint32_t max_vrec_width, uintptr_t pgr_alloc_cacheline_ct, uint32_t quick, uint32_t max_thread_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  ThreadGroup tg;
+  PreinitThreads(&tg);
+  ValidatePgenCtx ctx;
+  // number of PgenReaders needing cleanup
+  uint32_t pgr_ct = 0;
+  {
+    logprintfww5("Validating %s%s... ", pgenname, quick? " index" : "");
+    fflush(stdout);
+    reterr = PgrValidateIndex(simple_pgrp, g_logbuf);
+    if (unlikely(reterr)) {
+      goto ValidatePgen_ret_PGR_FAIL;
+    }
+    if (quick) {
+      logputs("done.\n");
+      goto ValidatePgen_ret_1;
+    }
+    const uint32_t variant_ct = pgfip->raw_variant_ct;
+    const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+    const uintptr_t genovec_byte_ct = NypCtToVecCt(pgfip->raw_sample_ct) * kBytesPerVec;
+    if ((max_thread_ct < 2) || (vblock_ct < 2)) {
+      uintptr_t* genovec_buf;
+      if (unlikely(bigstack_alloc_w(genovec_byte_ct / kBytesPerWord, &genovec_buf))) {
+        goto ValidatePgen_ret_NOMEM;
+      }
+      reterr = PgrValidateRecords(0, variant_ct, simple_pgrp, genovec_buf, g_logbuf);
+      if (unlikely(reterr)) {
+        goto ValidatePgen_ret_PGR_FAIL;
+      }
+      logputs("done.\n");
+      goto ValidatePgen_ret_1;
+    }
+    // Each thread gets its own per-variant-fread PgenReader, and validates one
+    // vblock at a time, since LD-compressed records can't be validated without
+    // the rest of their vblock.
+    uint32_t calc_thread_ct = MINV(max_thread_ct, vblock_ct);
+    const uintptr_t pgr_struct_alloc = RoundUpPow2(sizeof(PgenReader), kCacheline);
+    const uintptr_t pgr_alloc = (pgr_alloc_cacheline_ct + DivUp(max_vrec_width, kCacheline)) * kCacheline;
+    const uintptr_t thread_alloc = pgr_struct_alloc + pgr_alloc + RoundUpPow2(genovec_byte_ct, kCacheline) + RoundUpPow2(kPglErrstrBufBlen, kCacheline);
+    ctx.pgr_ptrs = S_CAST(PgenReader**, bigstack_alloc(calc_thread_ct * sizeof(intptr_t)));
+    if (unlikely((!ctx.pgr_ptrs) ||
+                 bigstack_alloc_wp(calc_thread_ct, &ctx.genovec_bufs) ||
+                 bigstack_alloc_cp(calc_thread_ct, &ctx.errstr_bufs))) {
+      goto ValidatePgen_ret_NOMEM;
+    }
+    if (bigstack_left() < thread_alloc * calc_thread_ct) {
+      calc_thread_ct = bigstack_left() / thread_alloc;
+      if (unlikely(!calc_thread_ct)) {
+        goto ValidatePgen_ret_NOMEM;
+      }
+    }
+    for (; pgr_ct != calc_thread_ct; ++pgr_ct) {
+      ctx.pgr_ptrs[pgr_ct] = S_CAST(PgenReader*, bigstack_alloc_raw(pgr_struct_alloc));
+      PreinitPgr(ctx.pgr_ptrs[pgr_ct]);
+    }
+    // Same hybrid-mode kludge as in Plink2Core(): hide pgfip->shared_ff so
+    // that each PgrInit() call opens its own FILE*.
+    FILE* shared_ff_copy = pgfip->shared_ff;
+    pgfip->shared_ff = nullptr;
+    for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+      unsigned char* cur_pgr_alloc = S_CAST(unsigned char*, bigstack_alloc_raw(pgr_alloc));
+      reterr = PgrInit(pgenname, max_vrec_width, pgfip, ctx.pgr_ptrs[tidx], cur_pgr_alloc);
+      if (unlikely(reterr)) {
+        pgfip->shared_ff = shared_ff_copy;
+        if (reterr == kPglRetOpenFail) {
+          logputs("\n");
+          logerrprintfww(kErrprintfFopen, pgenname, strerror(errno));
+          goto ValidatePgen_ret_1;
+        }
+        if (reterr == kPglRetNomem) {
+          goto ValidatePgen_ret_NOMEM;
+        }
+        logputs("\n");
+        logerrprintfww(kErrprintfFread, pgenname, rstrerror(errno));
+        goto ValidatePgen_ret_1;
+      }
+      ctx.genovec_bufs[tidx] = S_CAST(uintptr_t*, bigstack_alloc_raw_rd(genovec_byte_ct));
+      ctx.errstr_bufs[tidx] = S_CAST(char*, bigstack_alloc_raw_rd(kPglErrstrBufBlen));
+    }
+    pgfip->shared_ff = shared_ff_copy;
+    ctx.variant_ct = variant_ct;
+    ctx.err_info = (~0LLU) << 32;
+    if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
+      goto ValidatePgen_ret_NOMEM;
+    }
+    SetThreadFuncAndData(ValidatePgenThread, &ctx, &tg);
+    fputs("0%", stdout);
+    fflush(stdout);
+    uint32_t pct = 0;
+    for (uint32_t vblock_idx_start = 0; vblock_idx_start < vblock_ct; vblock_idx_start += calc_thread_ct) {
+      ctx.cur_vblock_idx_start = vblock_idx_start;
+      if (vblock_idx_start + calc_thread_ct >= vblock_ct) {
+        DeclareLastThreadBlock(&tg);
+      }
+      if (unlikely(SpawnThreads(&tg))) {
+        goto ValidatePgen_ret_THREAD_CREATE_FAIL;
+      }
+      JoinThreads(&tg);
+      reterr = S_CAST(PglErr, ctx.err_info);
+      if (unlikely(reterr)) {
+        const uint32_t failing_tidx = (ctx.err_info >> 32) - vblock_idx_start;
+        strcpy(g_logbuf, ctx.errstr_bufs[failing_tidx]);
+        goto ValidatePgen_ret_PGR_FAIL;
+      }
+      const uint32_t new_pct = (S_CAST(uint64_t, vblock_idx_start + calc_thread_ct) * 100) / vblock_ct;
+      if ((new_pct > pct) && (new_pct < 100)) {
+        if (pct > 10) {
+          putc_unlocked('\b', stdout);
+        }
+        pct = new_pct;
+        printf("\b\b%u%%", pct);
+        fflush(stdout);
+      }
+    }
+    if (pct > 10) {
+      putc_unlocked('\b', stdout);
+    }
+    fputs("\b\b", stdout);
+    logputs("done.\n");
+  }
+  while (0) {
+  ValidatePgen_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  ValidatePgen_ret_PGR_FAIL:
+    logputs("\n");
+    WordWrapB(0);
+    logerrputsb();
+    break;
+  ValidatePgen_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  }
+ ValidatePgen_ret_1:
+  CleanupThreads(&tg);
+  for (uint32_t tidx = 0; tidx != pgr_ct; ++tidx) {
+    CleanupPgr2(".pgen file", ctx.pgr_ptrs[tidx], &reterr);
+  }
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
 void ExpandMhc(uint32_t sample_ct, uintptr_t* mhc, uintptr_t** patch_01_set_ptr, AlleleCode** patch_01_vals_ptr, uintptr_t** patch_10_set_ptr, AlleleCode** patch_10_vals_ptr) {
   const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
   *patch_01_set_ptr = mhc;
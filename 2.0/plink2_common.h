@@ -160,7 +160,8 @@ FLAGSET64_DEF_START()
   kfMiscMakeFoundersRequire2Missing = (1LLU << 48),
   kfMiscYNosexMissingStats = (1LLU << 49),
   kfMiscNeg9PhenoReallyMissing = (1LLU << 50),
-  kfMiscAlt1Allele = (1LLU << 51)
+  kfMiscAlt1Allele = (1LLU << 51),
+  kfMiscValidateQuick = (1LLU << 52)
 FLAGSET64_DEF_END(MiscFlags);
 
 FLAGSET64_DEF_START()
@@ -252,7 +253,10 @@ FLAGSET_DEF_START()
   kfPsamColPheno1 = (1 << 18),
   kfPsamColPhenos = (1 << 19),
   kfPsamColDefault = (kfPsamColMaybefid | kfPsamColMaybesid | kfPsamColMaybeparents | kfPsamColSex | kfPsamColPhenos),
-  kfPsamColAll = ((kfPsamColPhenos * 2) - kfPsamColMaybefid)
+  kfPsamColAll = ((kfPsamColPhenos * 2) - kfPsamColMaybefid),
+
+  // use/refresh <.pvar/.bim filename>.pvc sidecar
+  kfPvarCache = (1 << 20)
 FLAGSET_DEF_END(PvarPsamFlags);
 
 // may want to rename FidPresent to FidMayBePresent
@@ -921,6 +925,12 @@ HEADER_INLINE void GetXymtCodeStartAndEndUnsafe(const ChrInfo* cip, uint32_t xym
 // now assumes chr_name is null-terminated
 PglErr TryToAddChrName(const char* chr_name, const char* file_descrip, uintptr_t line_idx, uint32_t name_slen, uint32_t prohibit_extra_chrs, uint32_t* chr_idx_ptr, ChrInfo* cip);
 
+// Returns 1 unless every record on the named contig is guaranteed to be
+// skipped by the chromosome filter without raising an error.  Unlike
+// TryToAddChrName(), does not modify cip, so indexed readers can use this to
+// decide which contigs to skip without affecting contig-table insertion order.
+uint32_t ChrNameMayBeKept(const ChrInfo* cip, const char* chr_name, uint32_t name_slen, uint32_t prohibit_extra_chr);
+
 HEADER_INLINE PglErr GetOrAddChrCode(const char* chr_name, const char* file_descrip, uintptr_t line_idx, uint32_t name_slen, uint32_t prohibit_extra_chrs, ChrInfo* cip, uint32_t* chr_idx_ptr) {
   *chr_idx_ptr = GetChrCode(chr_name, cip, name_slen);
   if (!IsI32Neg(*chr_idx_ptr)) {
@@ -1185,6 +1195,55 @@ uintptr_t GetMhcWordCt(uintptr_t sample_ct);
 // caller should reset pgfip->block_base to nullptr when it exits
 PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uintptr_t bytes_avail, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uintptr_t per_variant_xalloc_byte_ct, uintptr_t per_alt_allele_xalloc_byte_ct, PgenFileInfo* pgfip, uint32_t* calc_thread_ct_ptr, uintptr_t*** genovecs_ptr, uintptr_t*** mhc_ptr, uintptr_t*** phasepresent_ptr, uintptr_t*** phaseinfo_ptr, uintptr_t*** dosage_present_ptr, Dosage*** dosage_mains_ptr, uintptr_t*** dphase_present_ptr, SDosage*** dphase_delta_ptr, uint32_t* read_block_size_ptr, uintptr_t* max_alt_allele_block_size_ptr, STD_ARRAY_REF(unsigned char*, 2) main_loadbufs, PgenReader*** pgr_pps, uint32_t** read_variant_uidx_starts_ptr);
 
+// Workspace estimate for one command, used by the --memory auto/plan planner.
+// min_byte_ct is the smallest workspace the command can finish in (possibly
+// with smaller blocks, fewer threads, or extra passes); comfortable_byte_ct
+// is the point past which more memory no longer helps.  These are computed
+// from raw counts before anything is loaded, so they're approximate.
+typedef struct MemReqStruct {
+  uint64_t min_byte_ct;
+  uint64_t comfortable_byte_ct;
+} MemReq;
+
+// Rough PgenReader allocation size, in lieu of GetPgrAllocCachelineReq()
+// output when the .pgen header hasn't been parsed yet.
+HEADER_INLINE uintptr_t EstimatePgrAllocByteCt(uint32_t sample_ct) {
+  return 4 * NypCtToCachelineCt(sample_ct) * S_CAST(uintptr_t, kCacheline) + 3 * S_CAST(uintptr_t, sample_ct) * sizeof(int32_t) + 1024 * S_CAST(uintptr_t, kCacheline);
+}
+
+// Mirrors PgenMtLoadInit()'s sizing rules.  record_byte_ct is the average
+// .pgen variant record size.
+void PgenMtLoadMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, uint32_t calc_thread_ct, uintptr_t thread_xalloc_byte_ct, uintptr_t per_variant_xalloc_byte_ct, MemReq* mrp);
+
+// Persistent worker group backing a PglParallelForFunc, for
+// PgfiInitZstdRunner().  Unlike the usual per-command thread groups, it lives
+// as long as the PgenFileInfo it's attached to, and its workers park between
+// PgfiMultiread() calls.
+typedef struct PgenTaskRunnerStruct {
+  ThreadGroup tg;
+  PglTaskFunc task_func;
+  void* task_arg;
+  uint32_t task_ct;
+  // 0 if the workers are unavailable
+  uint32_t thread_ct;
+} PgenTaskRunner;
+
+void PreinitPgenTaskRunner(PgenTaskRunner* runnerp);
+
+// Only possible error is kPglRetNomem.
+PglErr InitPgenTaskRunner(uint32_t thread_ct, PgenTaskRunner* runnerp);
+
+// PglParallelForFunc implementation; runner_arg must point to an initialized
+// PgenTaskRunner.  Falls back to running the tasks on the calling thread if
+// the workers can't be launched.
+void PgenTaskRunnerParallelFor(void* runner_arg, uint32_t task_ct, PglTaskFunc task_func, void* task_arg);
+
+void CleanupPgenTaskRunner(PgenTaskRunner* runnerp);
+
+// Number of blocks past the current one that MultireadNonempty() asks the OS
+// to prefetch (--pgen-readahead).  0 disables readahead hints.
+extern uint32_t g_pgen_readahead_block_ct;
+
 // Returns number of variants in current block.  Increases read_block_idx as
 // necessary (to get to a nonempty block).
 // reterr can be ReadFail but not MalformedInput, since this function just
@@ -1192,6 +1251,11 @@ PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint
 uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp);
 
 // Assumes mhc != nullptr, and is vector-aligned.
+// Validates the .pgen file underlying simple_pgrp, which must be a
+// per-variant-fread PgenReader.  If quick is set, only the header and index
+// are checked; otherwise records are also validated, one vblock per thread.
+PglErr ValidatePgen(const char* pgenname, uint32_t max_vrec_width, uintptr_t pgr_alloc_cacheline_ct, uint32_t quick, uint32_t max_thread_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp);
+
 void ExpandMhc(uint32_t sample_ct, uintptr_t* mhc, uintptr_t** patch_01_set_ptr, AlleleCode** patch_01_vals_ptr, uintptr_t** patch_10_set_ptr, AlleleCode** patch_10_vals_ptr);
 
 HEADER_INLINE void SetPgvMhc(uint32_t sample_ct, uintptr_t* mhc, PgenVariant* pgvp) {
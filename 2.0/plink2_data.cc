@@ -2262,7 +2262,8 @@ typedef struct LoadAlleleAndGenoCountsCtxStruct {
   // only possible error for now
   uint64_t err_info;
 
-  uint32_t cur_block_size;
+  TaskDeques tdq;
+  uint32_t cur_block_uidx_start;
 
   unsigned char* allele_presents_bytearr;
   uint64_t* allele_ddosages;
@@ -2287,7 +2288,6 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
   const uintptr_t* variant_include = ctx->variant_include;
   const ChrInfo* cip = ctx->cip;
   const uintptr_t* allele_idx_offsets = ctx->allele_idx_offsets;
-  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
   const uint32_t subset_ct = (ctx->founder_info != nullptr) + 1;
   const uint32_t raw_sample_ct = ctx->raw_sample_ct;
   const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
@@ -2319,132 +2319,104 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
   uint32_t allele_ct = 2;
   uint64_t new_err_info;
   do {
-    const uintptr_t cur_block_size = ctx->cur_block_size;
-    // no overflow danger since cur_block_size <= 2^16, tidx < (2^16 - 1)
-    const uint32_t cur_idx_end = ((tidx + 1) * cur_block_size) / thread_ct;
-    const uintptr_t* sample_include = ctx->sample_include;
-    const uintptr_t* sample_include_interleaved_vec = ctx->sample_include_interleaved_vec;
-    const uint32_t* sample_include_cumulative_popcounts = ctx->sample_include_cumulative_popcounts;
-    const uintptr_t* sex_male = ctx->sex_male;
-    const uintptr_t* sex_male_interleaved_vec = ctx->sex_male_interleaved_vec;
-    const uintptr_t* sex_nonfemale = ctx->sex_nonfemale;
-    const uintptr_t* sex_nonfemale_interleaved_vec = ctx->sex_nonfemale_interleaved_vec;
-    const uint32_t* sex_nonfemale_cumulative_popcounts = ctx->sex_nonfemale_cumulative_popcounts;
-    const uintptr_t* nosex_interleaved_vec = ctx->nosex_interleaved_vec;
-    uint32_t sample_ct = ctx->sample_ct;
-    uint32_t male_ct = ctx->male_ct;
-    uint32_t nosex_ct = ctx->nosex_ct;
-    uint32_t nonfemale_ct = male_ct + nosex_ct;
-    uint32_t chry_missingstat_sample_ct = ctx->chry_missingstat_sample_ct;
-    unsigned char* allele_presents_bytearr = ctx->allele_presents_bytearr;
-    uint64_t* allele_ddosages = ctx->allele_ddosages;
-    STD_ARRAY_PTR_DECL(uint32_t, 3, raw_geno_cts) = ctx->raw_geno_cts;
-    uint32_t* variant_missing_hc_cts = ctx->variant_missing_hc_cts;
-    uint32_t* variant_missing_dosage_cts = ctx->variant_missing_dosage_cts;
-    uint32_t* variant_hethap_cts = ctx->variant_hethap_cts;
-    STD_ARRAY_PTR_DECL(uint32_t, 3, x_male_geno_cts) = ctx->x_male_geno_cts;
-    STD_ARRAY_PTR_DECL(uint32_t, 3, x_nosex_geno_cts) = ctx->x_nosex_geno_cts;
-    double* imp_r2_vals = ctx->imp_r2_vals;
-    pgv.dosage_ct = 0;
-    for (uint32_t subset_idx = 0; ; ) {
-      // bugfix (29 Dec 2019): this boolean can change with subset_idx
-      const uint32_t no_multiallelic_branch = (!variant_hethap_cts) && (!allele_presents_bytearr) && (!allele_ddosages) && (!imp_r2_vals);
-      PgrSampleSubsetIndex pssi;
-      PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, pgrp, &pssi);
-      uint32_t cur_idx = (tidx * cur_block_size) / thread_ct;
-      uintptr_t variant_uidx_base;
-      uintptr_t variant_include_bits;
-      BitIter1Start(variant_include, ctx->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
-      uint32_t chr_end = 0;
-      uint32_t is_x_or_y = 0;
-      STD_ARRAY_DECL(uint32_t, 4, genocounts);
-      STD_ARRAY_DECL(uint32_t, 4, sex_specific_genocounts);
-      for (; cur_idx != cur_idx_end; ++cur_idx) {
-        const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
-        if (variant_uidx >= chr_end) {
-          const uint32_t chr_fo_idx = GetVariantChrFoIdx(cip, variant_uidx);
-          const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
-          chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
-          is_y = 0;
-          is_nonxy_haploid = 0;
-          if (chr_idx == x_code) {
-            is_x_or_y = 1;
-            PgrClearSampleSubsetIndex(pgrp, &pssi);
-          } else if (chr_idx == y_code) {
-            is_x_or_y = 1;
-            is_y = 1;
-            // ugh
-            if ((nonfemale_ct == chry_missingstat_sample_ct) && ((!allele_presents_bytearr) || (sample_ct == nonfemale_ct))) {
-              PgrSetSampleSubsetIndex(sex_nonfemale_cumulative_popcounts, pgrp, &pssi);
-            } else {
+    const uint32_t block_uidx_start = ctx->cur_block_uidx_start;
+    uint32_t task_idx_start;
+    uint32_t cur_idx_end;
+    // Tasks taken from our own range arrive in increasing order, so the
+    // variant_include scan resumes from the previous task start unless we
+    // just stole an earlier range.
+    uint32_t prev_task_idx_start = 0;
+    uint32_t prev_task_uidx_start = block_uidx_start;
+    while (TaskDequesNext(tidx, &ctx->tdq, &task_idx_start, &cur_idx_end)) {
+      if (task_idx_start < prev_task_idx_start) {
+        prev_task_idx_start = 0;
+        prev_task_uidx_start = block_uidx_start;
+      }
+      const uint32_t task_uidx_start = FindNth1BitFrom(variant_include, prev_task_uidx_start, task_idx_start - prev_task_idx_start + 1);
+      prev_task_idx_start = task_idx_start;
+      prev_task_uidx_start = task_uidx_start;
+      const uintptr_t* sample_include = ctx->sample_include;
+      const uintptr_t* sample_include_interleaved_vec = ctx->sample_include_interleaved_vec;
+      const uint32_t* sample_include_cumulative_popcounts = ctx->sample_include_cumulative_popcounts;
+      const uintptr_t* sex_male = ctx->sex_male;
+      const uintptr_t* sex_male_interleaved_vec = ctx->sex_male_interleaved_vec;
+      const uintptr_t* sex_nonfemale = ctx->sex_nonfemale;
+      const uintptr_t* sex_nonfemale_interleaved_vec = ctx->sex_nonfemale_interleaved_vec;
+      const uint32_t* sex_nonfemale_cumulative_popcounts = ctx->sex_nonfemale_cumulative_popcounts;
+      const uintptr_t* nosex_interleaved_vec = ctx->nosex_interleaved_vec;
+      uint32_t sample_ct = ctx->sample_ct;
+      uint32_t male_ct = ctx->male_ct;
+      uint32_t nosex_ct = ctx->nosex_ct;
+      uint32_t nonfemale_ct = male_ct + nosex_ct;
+      uint32_t chry_missingstat_sample_ct = ctx->chry_missingstat_sample_ct;
+      unsigned char* allele_presents_bytearr = ctx->allele_presents_bytearr;
+      uint64_t* allele_ddosages = ctx->allele_ddosages;
+      STD_ARRAY_PTR_DECL(uint32_t, 3, raw_geno_cts) = ctx->raw_geno_cts;
+      uint32_t* variant_missing_hc_cts = ctx->variant_missing_hc_cts;
+      uint32_t* variant_missing_dosage_cts = ctx->variant_missing_dosage_cts;
+      uint32_t* variant_hethap_cts = ctx->variant_hethap_cts;
+      STD_ARRAY_PTR_DECL(uint32_t, 3, x_male_geno_cts) = ctx->x_male_geno_cts;
+      STD_ARRAY_PTR_DECL(uint32_t, 3, x_nosex_geno_cts) = ctx->x_nosex_geno_cts;
+      double* imp_r2_vals = ctx->imp_r2_vals;
+      pgv.dosage_ct = 0;
+      for (uint32_t subset_idx = 0; ; ) {
+        // bugfix (29 Dec 2019): this boolean can change with subset_idx
+        const uint32_t no_multiallelic_branch = (!variant_hethap_cts) && (!allele_presents_bytearr) && (!allele_ddosages) && (!imp_r2_vals);
+        PgrSampleSubsetIndex pssi;
+        PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, pgrp, &pssi);
+        uint32_t cur_idx = task_idx_start;
+        uintptr_t variant_uidx_base;
+        uintptr_t variant_include_bits;
+        BitIter1Start(variant_include, task_uidx_start, &variant_uidx_base, &variant_include_bits);
+        uint32_t chr_end = 0;
+        uint32_t is_x_or_y = 0;
+        STD_ARRAY_DECL(uint32_t, 4, genocounts);
+        STD_ARRAY_DECL(uint32_t, 4, sex_specific_genocounts);
+        for (; cur_idx != cur_idx_end; ++cur_idx) {
+          const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
+          if (variant_uidx >= chr_end) {
+            const uint32_t chr_fo_idx = GetVariantChrFoIdx(cip, variant_uidx);
+            const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+            chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+            is_y = 0;
+            is_nonxy_haploid = 0;
+            if (chr_idx == x_code) {
+              is_x_or_y = 1;
               PgrClearSampleSubsetIndex(pgrp, &pssi);
-            }
-          } else {
-            if (is_x_or_y) {
-              PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, pgrp, &pssi);
-            }
-            is_x_or_y = 0;
-            // true for MT
-            is_nonxy_haploid = IsSet(cip->haploid_mask, chr_idx);
-          }
-        }
-        uintptr_t cur_allele_idx_offset;
-        if (!allele_idx_offsets) {
-          cur_allele_idx_offset = 2 * variant_uidx;
-        } else {
-          cur_allele_idx_offset = allele_idx_offsets[variant_uidx];
-          allele_ct = allele_idx_offsets[variant_uidx + 1] - cur_allele_idx_offset;
-        }
-        uint32_t hethap_ct;
-        if ((allele_ct == 2) || no_multiallelic_branch) {
-          uint64_t cur_dosages[2];
-          if (!is_x_or_y) {
-            const PglErr reterr = PgrGetDCounts(sample_include, sample_include_interleaved_vec, pssi, sample_ct, variant_uidx, is_minimac3_r2, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, genocounts, cur_dosages);
-            if (unlikely(reterr)) {
-              new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-              goto LoadAlleleAndGenoCountsThread_err;
-            }
-            if (allele_presents_bytearr) {
-              if (cur_dosages[0]) {
-                allele_presents_bytearr[cur_allele_idx_offset] = 128;
-              }
-              if (cur_dosages[1]) {
-                allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
-              }
-            }
-            if (!is_nonxy_haploid) {
-              hethap_ct = 0;
-              if (allele_ddosages) {
-                // ...but save all allele counts here.
-                allele_ddosages[cur_allele_idx_offset] = cur_dosages[0] * 2;
-                allele_ddosages[cur_allele_idx_offset + 1] = cur_dosages[1] * 2;
+            } else if (chr_idx == y_code) {
+              is_x_or_y = 1;
+              is_y = 1;
+              // ugh
+              if ((nonfemale_ct == chry_missingstat_sample_ct) && ((!allele_presents_bytearr) || (sample_ct == nonfemale_ct))) {
+                PgrSetSampleSubsetIndex(sex_nonfemale_cumulative_popcounts, pgrp, &pssi);
+              } else {
+                PgrClearSampleSubsetIndex(pgrp, &pssi);
               }
             } else {
-              // this hethap_ct can be inaccurate in multiallelic case
-              hethap_ct = genocounts[1];
-              if (imp_r2_vals && (!is_minimac3_r2)) {
-                // Assuming the input data isn't malformed "phased haploid",
-                // minimac3-r2 is independent of haploid/diploid state; only
-                // mach-r2 requires a haploid correction.
-                imp_r2_vals[variant_uidx] *= 0.5;
-              }
-              if (allele_ddosages) {
-                allele_ddosages[cur_allele_idx_offset] = cur_dosages[0];
-                allele_ddosages[cur_allele_idx_offset + 1] = cur_dosages[1];
+              if (is_x_or_y) {
+                PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, pgrp, &pssi);
               }
+              is_x_or_y = 0;
+              // true for MT
+              is_nonxy_haploid = IsSet(cip->haploid_mask, chr_idx);
             }
-          } else if (is_y) {
-            if ((nonfemale_ct == chry_missingstat_sample_ct) && ((!allele_presents_bytearr) || (sample_ct == nonfemale_ct))) {
-              const PglErr reterr = PgrGetDCounts(sex_nonfemale, sex_nonfemale_interleaved_vec, pssi, nonfemale_ct, variant_uidx, 0, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, genocounts, cur_dosages);
+          }
+          uintptr_t cur_allele_idx_offset;
+          if (!allele_idx_offsets) {
+            cur_allele_idx_offset = 2 * variant_uidx;
+          } else {
+            cur_allele_idx_offset = allele_idx_offsets[variant_uidx];
+            allele_ct = allele_idx_offsets[variant_uidx + 1] - cur_allele_idx_offset;
+          }
+          uint32_t hethap_ct;
+          if ((allele_ct == 2) || no_multiallelic_branch) {
+            uint64_t cur_dosages[2];
+            if (!is_x_or_y) {
+              const PglErr reterr = PgrGetDCounts(sample_include, sample_include_interleaved_vec, pssi, sample_ct, variant_uidx, is_minimac3_r2, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, genocounts, cur_dosages);
               if (unlikely(reterr)) {
                 new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
                 goto LoadAlleleAndGenoCountsThread_err;
               }
-              hethap_ct = genocounts[1];
-              if (imp_r2_vals && (!is_minimac3_r2)) {
-                // note that female is not counted here
-                imp_r2_vals[variant_uidx] *= 0.5;
-              }
               if (allele_presents_bytearr) {
                 if (cur_dosages[0]) {
                   allele_presents_bytearr[cur_allele_idx_offset] = 128;
@@ -2453,44 +2425,201 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
                   allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
                 }
               }
-              if (allele_ddosages) {
-                allele_ddosages[cur_allele_idx_offset] = cur_dosages[0];
-                allele_ddosages[cur_allele_idx_offset + 1] = cur_dosages[1];
+              if (!is_nonxy_haploid) {
+                hethap_ct = 0;
+                if (allele_ddosages) {
+                  // ...but save all allele counts here.
+                  allele_ddosages[cur_allele_idx_offset] = cur_dosages[0] * 2;
+                  allele_ddosages[cur_allele_idx_offset + 1] = cur_dosages[1] * 2;
+                }
+              } else {
+                // this hethap_ct can be inaccurate in multiallelic case
+                hethap_ct = genocounts[1];
+                if (imp_r2_vals && (!is_minimac3_r2)) {
+                  // Assuming the input data isn't malformed "phased haploid",
+                  // minimac3-r2 is independent of haploid/diploid state; only
+                  // mach-r2 requires a haploid correction.
+                  imp_r2_vals[variant_uidx] *= 0.5;
+                }
+                if (allele_ddosages) {
+                  allele_ddosages[cur_allele_idx_offset] = cur_dosages[0];
+                  allele_ddosages[cur_allele_idx_offset + 1] = cur_dosages[1];
+                }
               }
-              if (raw_geno_cts) {
-                STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
-                cur_raw_geno_cts[0] = genocounts[0];
-                cur_raw_geno_cts[1] = genocounts[1];
-                cur_raw_geno_cts[2] = genocounts[2];
+            } else if (is_y) {
+              if ((nonfemale_ct == chry_missingstat_sample_ct) && ((!allele_presents_bytearr) || (sample_ct == nonfemale_ct))) {
+                const PglErr reterr = PgrGetDCounts(sex_nonfemale, sex_nonfemale_interleaved_vec, pssi, nonfemale_ct, variant_uidx, 0, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, genocounts, cur_dosages);
+                if (unlikely(reterr)) {
+                  new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+                  goto LoadAlleleAndGenoCountsThread_err;
+                }
+                hethap_ct = genocounts[1];
+                if (imp_r2_vals && (!is_minimac3_r2)) {
+                  // note that female is not counted here
+                  imp_r2_vals[variant_uidx] *= 0.5;
+                }
+                if (allele_presents_bytearr) {
+                  if (cur_dosages[0]) {
+                    allele_presents_bytearr[cur_allele_idx_offset] = 128;
+                  }
+                  if (cur_dosages[1]) {
+                    allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
+                  }
+                }
+                if (allele_ddosages) {
+                  allele_ddosages[cur_allele_idx_offset] = cur_dosages[0];
+                  allele_ddosages[cur_allele_idx_offset + 1] = cur_dosages[1];
+                }
+                if (raw_geno_cts) {
+                  STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
+                  cur_raw_geno_cts[0] = genocounts[0];
+                  cur_raw_geno_cts[1] = genocounts[1];
+                  cur_raw_geno_cts[2] = genocounts[2];
+                }
+              } else {
+                // females need to be counted for allele_presents, and ignored
+                // elsewhere.
+                // unknown-sex might need to be excluded from missing-genotype
+                // and hethap counts.
+                const PglErr reterr = PgrGetD(nullptr, pssi, raw_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &pgv.dosage_ct);
+                if (unlikely(reterr)) {
+                  new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+                  goto LoadAlleleAndGenoCountsThread_err;
+                }
+                const uint32_t dosage_is_relevant = pgv.dosage_ct && ((sample_ct == raw_sample_ct) || (!IntersectionIsEmpty(sample_include, pgv.dosage_present, raw_sample_ctl)));
+                if (allele_presents_bytearr) {
+                  if (dosage_is_relevant) {
+                    // at least one dosage value is present, that's all we need
+                    // to know
+                    allele_presents_bytearr[cur_allele_idx_offset] = 128;
+                    allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
+                  } else {
+                    // only hardcalls matter
+                    // bugfix (31 Jul 2018): forgot to initialize genocounts here
+                    // possible todo: use a specialized function which just
+                    // checks which alleles exist
+                    if (sample_ct == raw_sample_ct) {
+                      ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
+                      GenoarrCountFreqsUnsafe(pgv.genovec, sample_ct, genocounts);
+                    } else {
+                      GenoarrCountSubsetFreqs(pgv.genovec, sample_include_interleaved_vec, raw_sample_ct, sample_ct, genocounts);
+                    }
+                    if (genocounts[0] || genocounts[1]) {
+                      allele_presents_bytearr[cur_allele_idx_offset] = 128;
+                    }
+                    if (genocounts[1] || genocounts[2]) {
+                      allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
+                    }
+                  }
+                }
+                GenoarrCountSubsetFreqs(pgv.genovec, sex_nonfemale_interleaved_vec, raw_sample_ct, nonfemale_ct, genocounts);
+                hethap_ct = genocounts[1];
+                // x2, x4 since this is haploid
+                uintptr_t alt1_ct_x2 = genocounts[2] * 2 + hethap_ct;
+                uintptr_t alt1_sq_sum_x4 = genocounts[2] * (4 * k1LU) + hethap_ct;
+                uint64_t alt1_ddosage = 0;  // in 32768ths
+                uint64_t alt1_ddosage_sq_sum = 0;
+                uint32_t additional_dosage_ct = 0;
+                if (dosage_is_relevant) {
+                  uintptr_t sample_widx = 0;
+                  uintptr_t dosage_present_bits = pgv.dosage_present[0];
+                  uint32_t sample_uidx = 0;
+                  for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                    const uintptr_t lowbit = BitIter1y(pgv.dosage_present, &sample_widx, &dosage_present_bits);
+                    if (sample_include[sample_widx] & lowbit) {
+                      const uintptr_t cur_dosage_val = pgv.dosage_main[dosage_idx];
+                      alt1_ddosage += cur_dosage_val;
+                      alt1_ddosage_sq_sum += cur_dosage_val * cur_dosage_val;
+                      const uintptr_t hardcall_code = GetNyparrEntry(pgv.genovec, sample_uidx);
+                      if (hardcall_code != 3) {
+                        alt1_ct_x2 -= hardcall_code;
+                        alt1_sq_sum_x4 -= hardcall_code * hardcall_code;
+                      } else {
+                        ++additional_dosage_ct;
+                      }
+                    }
+                  }
+                }
+                const uintptr_t obs_ct = nonfemale_ct + additional_dosage_ct - genocounts[3];
+                alt1_ddosage += alt1_ct_x2 * S_CAST(uint64_t, kDosageMid);
+                alt1_ddosage_sq_sum += alt1_sq_sum_x4 * 0x10000000LLU;
+                cur_dosages[0] = obs_ct * S_CAST(uint64_t, kDosageMax) - alt1_ddosage;
+                cur_dosages[1] = alt1_ddosage;
+                if (imp_r2_vals) {
+                  // minimac3-r2 and mach-r2 are identical in haploid case
+                  const double dosage_sumd = u63tod(alt1_ddosage);
+                  const double dosage_avg = dosage_sumd / u31tod(obs_ct);
+                  const double dosage_variance = u63tod(alt1_ddosage_sq_sum) - dosage_sumd * dosage_avg;
+                  imp_r2_vals[variant_uidx] = dosage_variance / (dosage_sumd * (32768 - dosage_avg));
+                }
+                if (allele_ddosages) {
+                  allele_ddosages[cur_allele_idx_offset] = cur_dosages[0];
+                  allele_ddosages[cur_allele_idx_offset + 1] = alt1_ddosage;
+                }
+                // argh, these values must be saved before potential male-only
+                // clobber.
+                if (raw_geno_cts) {
+                  STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
+                  cur_raw_geno_cts[0] = genocounts[0];
+                  cur_raw_geno_cts[1] = genocounts[1];
+                  cur_raw_geno_cts[2] = genocounts[2];
+                }
+                if (chry_missingstat_sample_ct != nonfemale_ct) {
+                  // By default, we include unknown-sex samples in
+                  // allele-frequency and imputation-r2 computations, but exclude
+                  // them from missing-rate stats (and hethap stats because they
+                  // can't be cleanly separated out)
+                  GenoarrCountSubsetFreqs(pgv.genovec, sex_male_interleaved_vec, raw_sample_ct, male_ct, genocounts);
+                  hethap_ct = genocounts[1];
+                  // cur_dosages[0] + cur_dosages[1] used later to compute
+                  // missing-dosage rate.
+                  uint32_t male_missing_ct = genocounts[3];
+                  if (dosage_is_relevant && male_missing_ct) {
+                    const uint32_t raw_sample_ctl2 = NypCtToWordCt(raw_sample_ct);
+                    const uintptr_t* genovec = pgv.genovec;
+                    const Halfword* sex_male_hwalias = DowncastKWToHW(sex_male);
+                    const Halfword* dosage_present_hwalias = DowncastWToHW(pgv.dosage_present);
+                    for (uint32_t widx = 0; widx != raw_sample_ctl2; ++widx) {
+                      const Halfword hw = Pack11ToHalfword(genovec[widx]) & sex_male_hwalias[widx] & dosage_present_hwalias[widx];
+                      if (hw) {
+                        male_missing_ct -= PopcountHW(hw);
+                      }
+                    }
+                  }
+                  const uintptr_t male_dosage_obs_ct = male_ct - male_missing_ct;
+                  cur_dosages[0] = male_dosage_obs_ct * S_CAST(uint64_t, kDosageMax);
+                  cur_dosages[1] = 0;
+                }
               }
             } else {
-              // females need to be counted for allele_presents, and ignored
-              // elsewhere.
-              // unknown-sex might need to be excluded from missing-genotype
-              // and hethap counts.
+              // chrX
               const PglErr reterr = PgrGetD(nullptr, pssi, raw_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &pgv.dosage_ct);
               if (unlikely(reterr)) {
                 new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
                 goto LoadAlleleAndGenoCountsThread_err;
               }
-              const uint32_t dosage_is_relevant = pgv.dosage_ct && ((sample_ct == raw_sample_ct) || (!IntersectionIsEmpty(sample_include, pgv.dosage_present, raw_sample_ctl)));
+              if (sample_ct == raw_sample_ct) {
+                ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
+                GenoarrCountFreqsUnsafe(pgv.genovec, sample_ct, genocounts);
+              } else {
+                GenoarrCountSubsetFreqs(pgv.genovec, sample_include_interleaved_vec, raw_sample_ct, sample_ct, genocounts);
+              }
+              GenoarrCountSubsetFreqs(pgv.genovec, sex_male_interleaved_vec, raw_sample_ct, male_ct, sex_specific_genocounts);
+              hethap_ct = sex_specific_genocounts[1];
+              // Could compute imputation r2 iff there are no unknown-sex
+              // samples, but probably not worth it since larger datasets could
+              // have a small number of Klinefelter syndrome cases, etc. coded as
+              // unknown-sex, and we don't want to discourage their inclusion;
+              // let's delegate that chrX filter to other software for now.
+
               if (allele_presents_bytearr) {
-                if (dosage_is_relevant) {
-                  // at least one dosage value is present, that's all we need
-                  // to know
+                if (pgv.dosage_ct && ((sample_ct == raw_sample_ct) || (!IntersectionIsEmpty(sample_include, pgv.dosage_present, raw_sample_ctl)))) {
+                  // at least one dosage value is present, that's all we need to
+                  // know
                   allele_presents_bytearr[cur_allele_idx_offset] = 128;
                   allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
                 } else {
                   // only hardcalls matter
-                  // bugfix (31 Jul 2018): forgot to initialize genocounts here
-                  // possible todo: use a specialized function which just
-                  // checks which alleles exist
-                  if (sample_ct == raw_sample_ct) {
-                    ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
-                    GenoarrCountFreqsUnsafe(pgv.genovec, sample_ct, genocounts);
-                  } else {
-                    GenoarrCountSubsetFreqs(pgv.genovec, sample_include_interleaved_vec, raw_sample_ct, sample_ct, genocounts);
-                  }
                   if (genocounts[0] || genocounts[1]) {
                     allele_presents_bytearr[cur_allele_idx_offset] = 128;
                   }
@@ -2499,155 +2628,25 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
                   }
                 }
               }
-              GenoarrCountSubsetFreqs(pgv.genovec, sex_nonfemale_interleaved_vec, raw_sample_ct, nonfemale_ct, genocounts);
-              hethap_ct = genocounts[1];
-              // x2, x4 since this is haploid
-              uintptr_t alt1_ct_x2 = genocounts[2] * 2 + hethap_ct;
-              uintptr_t alt1_sq_sum_x4 = genocounts[2] * (4 * k1LU) + hethap_ct;
-              uint64_t alt1_ddosage = 0;  // in 32768ths
-              uint64_t alt1_ddosage_sq_sum = 0;
-              uint32_t additional_dosage_ct = 0;
-              if (dosage_is_relevant) {
-                uintptr_t sample_widx = 0;
-                uintptr_t dosage_present_bits = pgv.dosage_present[0];
-                uint32_t sample_uidx = 0;
-                for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                  const uintptr_t lowbit = BitIter1y(pgv.dosage_present, &sample_widx, &dosage_present_bits);
-                  if (sample_include[sample_widx] & lowbit) {
-                    const uintptr_t cur_dosage_val = pgv.dosage_main[dosage_idx];
-                    alt1_ddosage += cur_dosage_val;
-                    alt1_ddosage_sq_sum += cur_dosage_val * cur_dosage_val;
-                    const uintptr_t hardcall_code = GetNyparrEntry(pgv.genovec, sample_uidx);
-                    if (hardcall_code != 3) {
-                      alt1_ct_x2 -= hardcall_code;
-                      alt1_sq_sum_x4 -= hardcall_code * hardcall_code;
-                    } else {
-                      ++additional_dosage_ct;
-                    }
-                  }
-                }
-              }
-              const uintptr_t obs_ct = nonfemale_ct + additional_dosage_ct - genocounts[3];
-              alt1_ddosage += alt1_ct_x2 * S_CAST(uint64_t, kDosageMid);
-              alt1_ddosage_sq_sum += alt1_sq_sum_x4 * 0x10000000LLU;
-              cur_dosages[0] = obs_ct * S_CAST(uint64_t, kDosageMax) - alt1_ddosage;
-              cur_dosages[1] = alt1_ddosage;
-              if (imp_r2_vals) {
-                // minimac3-r2 and mach-r2 are identical in haploid case
-                const double dosage_sumd = u63tod(alt1_ddosage);
-                const double dosage_avg = dosage_sumd / u31tod(obs_ct);
-                const double dosage_variance = u63tod(alt1_ddosage_sq_sum) - dosage_sumd * dosage_avg;
-                imp_r2_vals[variant_uidx] = dosage_variance / (dosage_sumd * (32768 - dosage_avg));
-              }
               if (allele_ddosages) {
-                allele_ddosages[cur_allele_idx_offset] = cur_dosages[0];
-                allele_ddosages[cur_allele_idx_offset + 1] = alt1_ddosage;
-              }
-              // argh, these values must be saved before potential male-only
-              // clobber.
-              if (raw_geno_cts) {
-                STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
-                cur_raw_geno_cts[0] = genocounts[0];
-                cur_raw_geno_cts[1] = genocounts[1];
-                cur_raw_geno_cts[2] = genocounts[2];
-              }
-              if (chry_missingstat_sample_ct != nonfemale_ct) {
-                // By default, we include unknown-sex samples in
-                // allele-frequency and imputation-r2 computations, but exclude
-                // them from missing-rate stats (and hethap stats because they
-                // can't be cleanly separated out)
-                GenoarrCountSubsetFreqs(pgv.genovec, sex_male_interleaved_vec, raw_sample_ct, male_ct, genocounts);
-                hethap_ct = genocounts[1];
-                // cur_dosages[0] + cur_dosages[1] used later to compute
-                // missing-dosage rate.
-                uint32_t male_missing_ct = genocounts[3];
-                if (dosage_is_relevant && male_missing_ct) {
-                  const uint32_t raw_sample_ctl2 = NypCtToWordCt(raw_sample_ct);
-                  const uintptr_t* genovec = pgv.genovec;
-                  const Halfword* sex_male_hwalias = DowncastKWToHW(sex_male);
-                  const Halfword* dosage_present_hwalias = DowncastWToHW(pgv.dosage_present);
-                  for (uint32_t widx = 0; widx != raw_sample_ctl2; ++widx) {
-                    const Halfword hw = Pack11ToHalfword(genovec[widx]) & sex_male_hwalias[widx] & dosage_present_hwalias[widx];
-                    if (hw) {
-                      male_missing_ct -= PopcountHW(hw);
-                    }
-                  }
-                }
-                const uintptr_t male_dosage_obs_ct = male_ct - male_missing_ct;
-                cur_dosages[0] = male_dosage_obs_ct * S_CAST(uint64_t, kDosageMax);
-                cur_dosages[1] = 0;
-              }
-            }
-          } else {
-            // chrX
-            const PglErr reterr = PgrGetD(nullptr, pssi, raw_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &pgv.dosage_ct);
-            if (unlikely(reterr)) {
-              new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-              goto LoadAlleleAndGenoCountsThread_err;
-            }
-            if (sample_ct == raw_sample_ct) {
-              ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
-              GenoarrCountFreqsUnsafe(pgv.genovec, sample_ct, genocounts);
-            } else {
-              GenoarrCountSubsetFreqs(pgv.genovec, sample_include_interleaved_vec, raw_sample_ct, sample_ct, genocounts);
-            }
-            GenoarrCountSubsetFreqs(pgv.genovec, sex_male_interleaved_vec, raw_sample_ct, male_ct, sex_specific_genocounts);
-            hethap_ct = sex_specific_genocounts[1];
-            // Could compute imputation r2 iff there are no unknown-sex
-            // samples, but probably not worth it since larger datasets could
-            // have a small number of Klinefelter syndrome cases, etc. coded as
-            // unknown-sex, and we don't want to discourage their inclusion;
-            // let's delegate that chrX filter to other software for now.
-
-            if (allele_presents_bytearr) {
-              if (pgv.dosage_ct && ((sample_ct == raw_sample_ct) || (!IntersectionIsEmpty(sample_include, pgv.dosage_present, raw_sample_ctl)))) {
-                // at least one dosage value is present, that's all we need to
-                // know
-                allele_presents_bytearr[cur_allele_idx_offset] = 128;
-                allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
-              } else {
-                // only hardcalls matter
-                if (genocounts[0] || genocounts[1]) {
-                  allele_presents_bytearr[cur_allele_idx_offset] = 128;
-                }
-                if (genocounts[1] || genocounts[2]) {
-                  allele_presents_bytearr[cur_allele_idx_offset + 1] = 128;
-                }
-              }
-            }
-            if (allele_ddosages) {
-              uintptr_t alt1_ct = 4 * genocounts[2] + 2 * genocounts[1] - 2 * sex_specific_genocounts[2] - hethap_ct;  // nonmales count twice
-              uint64_t alt1_ddosage = 0;  // in 32768ths, nonmales count twice
-              uint32_t additional_dosage_ct = 0;  // missing hardcalls only; nonmales count twice
-              // bugfix (12 Jul 2018): dosage_present may be null if dosage_ct
-              // == 0
-              if (pgv.dosage_ct) {
-                uintptr_t sample_uidx_base = 0;
-                uintptr_t dosage_present_bits = pgv.dosage_present[0];
-                if (sample_ct == raw_sample_ct) {
-                  for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                    const uintptr_t sample_uidx = BitIter1(pgv.dosage_present, &sample_uidx_base, &dosage_present_bits);
-                    const uintptr_t cur_dosage_val = pgv.dosage_main[dosage_idx];
-                    const uintptr_t sex_multiplier = 2 - IsSet(sex_male, sample_uidx);
-                    alt1_ddosage += cur_dosage_val * sex_multiplier;
-
-                    // could call GenoarrCountSubsetIntersectFreqs() twice
-                    // instead, but since we've already manually extracted the
-                    // sex bit it probably doesn't help?
-                    const uintptr_t hardcall_code = GetNyparrEntry(pgv.genovec, sample_uidx);
-                    if (hardcall_code != 3) {
-                      alt1_ct -= hardcall_code * sex_multiplier;
-                    } else {
-                      additional_dosage_ct += sex_multiplier;
-                    }
-                  }
-                } else {
-                  for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                    const uintptr_t sample_uidx = BitIter1(pgv.dosage_present, &sample_uidx_base, &dosage_present_bits);
-                    if (IsSet(sample_include, sample_uidx)) {
+                uintptr_t alt1_ct = 4 * genocounts[2] + 2 * genocounts[1] - 2 * sex_specific_genocounts[2] - hethap_ct;  // nonmales count twice
+                uint64_t alt1_ddosage = 0;  // in 32768ths, nonmales count twice
+                uint32_t additional_dosage_ct = 0;  // missing hardcalls only; nonmales count twice
+                // bugfix (12 Jul 2018): dosage_present may be null if dosage_ct
+                // == 0
+                if (pgv.dosage_ct) {
+                  uintptr_t sample_uidx_base = 0;
+                  uintptr_t dosage_present_bits = pgv.dosage_present[0];
+                  if (sample_ct == raw_sample_ct) {
+                    for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                      const uintptr_t sample_uidx = BitIter1(pgv.dosage_present, &sample_uidx_base, &dosage_present_bits);
                       const uintptr_t cur_dosage_val = pgv.dosage_main[dosage_idx];
                       const uintptr_t sex_multiplier = 2 - IsSet(sex_male, sample_uidx);
                       alt1_ddosage += cur_dosage_val * sex_multiplier;
+
+                      // could call GenoarrCountSubsetIntersectFreqs() twice
+                      // instead, but since we've already manually extracted the
+                      // sex bit it probably doesn't help?
                       const uintptr_t hardcall_code = GetNyparrEntry(pgv.genovec, sample_uidx);
                       if (hardcall_code != 3) {
                         alt1_ct -= hardcall_code * sex_multiplier;
@@ -2655,88 +2654,70 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
                         additional_dosage_ct += sex_multiplier;
                       }
                     }
+                  } else {
+                    for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                      const uintptr_t sample_uidx = BitIter1(pgv.dosage_present, &sample_uidx_base, &dosage_present_bits);
+                      if (IsSet(sample_include, sample_uidx)) {
+                        const uintptr_t cur_dosage_val = pgv.dosage_main[dosage_idx];
+                        const uintptr_t sex_multiplier = 2 - IsSet(sex_male, sample_uidx);
+                        alt1_ddosage += cur_dosage_val * sex_multiplier;
+                        const uintptr_t hardcall_code = GetNyparrEntry(pgv.genovec, sample_uidx);
+                        if (hardcall_code != 3) {
+                          alt1_ct -= hardcall_code * sex_multiplier;
+                        } else {
+                          additional_dosage_ct += sex_multiplier;
+                        }
+                      }
+                    }
                   }
                 }
-              }
-              alt1_ddosage += alt1_ct * S_CAST(uint64_t, kDosageMid);
+                alt1_ddosage += alt1_ct * S_CAST(uint64_t, kDosageMid);
 
-              // bugfix (14 May 2018): this didn't correctly distinguish
-              // between missing vs. 'replaced' hardcalls
-              const uintptr_t weighted_obs_ct = (2 * (sample_ct - genocounts[3]) - male_ct + sex_specific_genocounts[3] + additional_dosage_ct) * (2 * k1LU);
+                // bugfix (14 May 2018): this didn't correctly distinguish
+                // between missing vs. 'replaced' hardcalls
+                const uintptr_t weighted_obs_ct = (2 * (sample_ct - genocounts[3]) - male_ct + sex_specific_genocounts[3] + additional_dosage_ct) * (2 * k1LU);
 
-              allele_ddosages[cur_allele_idx_offset] = weighted_obs_ct * S_CAST(uint64_t, kDosageMid) - alt1_ddosage;
-              allele_ddosages[cur_allele_idx_offset + 1] = alt1_ddosage;
-            }
-            if (x_male_geno_cts) {
-              STD_ARRAY_REF(uint32_t, 3) cur_x_male_geno_cts = x_male_geno_cts[variant_uidx - x_start];
-              cur_x_male_geno_cts[0] = sex_specific_genocounts[0];
-              cur_x_male_geno_cts[1] = sex_specific_genocounts[1];
-              cur_x_male_geno_cts[2] = sex_specific_genocounts[2];
-              if (x_nosex_geno_cts) {
-                GenoarrCountSubsetFreqs(pgv.genovec, nosex_interleaved_vec, raw_sample_ct, nosex_ct, sex_specific_genocounts);
-                STD_ARRAY_REF(uint32_t, 3) cur_nosex_geno_cts = x_nosex_geno_cts[variant_uidx - x_start];
-                cur_nosex_geno_cts[0] = sex_specific_genocounts[0];
-                cur_nosex_geno_cts[1] = sex_specific_genocounts[1];
-                cur_nosex_geno_cts[2] = sex_specific_genocounts[2];
-              }
-            }
-          }
-          if (variant_missing_dosage_cts) {
-            uint32_t missing_dosage_ct;
-            if (!is_x_or_y) {
-              missing_dosage_ct = sample_ct - ((cur_dosages[0] + cur_dosages[1]) / kDosageMax);
-            } else if (is_y) {
-              missing_dosage_ct = chry_missingstat_sample_ct - ((cur_dosages[0] + cur_dosages[1]) / kDosageMax);
-            } else {
-              if (pgv.dosage_ct) {
-                ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
-                missing_dosage_ct = GenoarrCountMissingInvsubsetUnsafe(pgv.genovec, pgv.dosage_present, raw_sample_ct);
-              } else {
-                missing_dosage_ct = genocounts[3];
+                allele_ddosages[cur_allele_idx_offset] = weighted_obs_ct * S_CAST(uint64_t, kDosageMid) - alt1_ddosage;
+                allele_ddosages[cur_allele_idx_offset + 1] = alt1_ddosage;
               }
-            }
-            variant_missing_dosage_cts[variant_uidx] = missing_dosage_ct;
-          }
-        } else {
-          // multiallelic cases
-          if (!is_x_or_y) {
-            const PglErr reterr = PgrGetMDCounts(sample_include, sample_include_interleaved_vec, pssi, sample_ct, variant_uidx, is_minimac3_r2, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, &hethap_ct, genocounts, all_dosages);
-            if (unlikely(reterr)) {
-              new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-              goto LoadAlleleAndGenoCountsThread_err;
-            }
-            if (allele_presents_bytearr) {
-              for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
-                if (all_dosages[aidx]) {
-                  allele_presents_bytearr[cur_allele_idx_offset + aidx] = 128;
+              if (x_male_geno_cts) {
+                STD_ARRAY_REF(uint32_t, 3) cur_x_male_geno_cts = x_male_geno_cts[variant_uidx - x_start];
+                cur_x_male_geno_cts[0] = sex_specific_genocounts[0];
+                cur_x_male_geno_cts[1] = sex_specific_genocounts[1];
+                cur_x_male_geno_cts[2] = sex_specific_genocounts[2];
+                if (x_nosex_geno_cts) {
+                  GenoarrCountSubsetFreqs(pgv.genovec, nosex_interleaved_vec, raw_sample_ct, nosex_ct, sex_specific_genocounts);
+                  STD_ARRAY_REF(uint32_t, 3) cur_nosex_geno_cts = x_nosex_geno_cts[variant_uidx - x_start];
+                  cur_nosex_geno_cts[0] = sex_specific_genocounts[0];
+                  cur_nosex_geno_cts[1] = sex_specific_genocounts[1];
+                  cur_nosex_geno_cts[2] = sex_specific_genocounts[2];
                 }
               }
             }
-            if (!is_nonxy_haploid) {
-              hethap_ct = 0;
-              if (allele_ddosages) {
-                for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
-                  allele_ddosages[cur_allele_idx_offset + aidx] = all_dosages[aidx] * 2;
+            if (variant_missing_dosage_cts) {
+              uint32_t missing_dosage_ct;
+              if (!is_x_or_y) {
+                missing_dosage_ct = sample_ct - ((cur_dosages[0] + cur_dosages[1]) / kDosageMax);
+              } else if (is_y) {
+                missing_dosage_ct = chry_missingstat_sample_ct - ((cur_dosages[0] + cur_dosages[1]) / kDosageMax);
+              } else {
+                if (pgv.dosage_ct) {
+                  ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
+                  missing_dosage_ct = GenoarrCountMissingInvsubsetUnsafe(pgv.genovec, pgv.dosage_present, raw_sample_ct);
+                } else {
+                  missing_dosage_ct = genocounts[3];
                 }
               }
-            } else {
-              if (imp_r2_vals && (!is_minimac3_r2)) {
-                imp_r2_vals[variant_uidx] *= 0.5;
-              }
-              if (allele_ddosages) {
-                memcpy(&(allele_ddosages[cur_allele_idx_offset]), all_dosages, allele_ct * sizeof(int64_t));
-              }
+              variant_missing_dosage_cts[variant_uidx] = missing_dosage_ct;
             }
-          } else if (is_y) {
-            if ((nonfemale_ct == chry_missingstat_sample_ct) && ((!allele_presents_bytearr) || (sample_ct == nonfemale_ct))) {
-              const PglErr reterr = PgrGetMDCounts(sex_nonfemale, sex_nonfemale_interleaved_vec, pssi, nonfemale_ct, variant_uidx, 0, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, &hethap_ct, genocounts, all_dosages);
+          } else {
+            // multiallelic cases
+            if (!is_x_or_y) {
+              const PglErr reterr = PgrGetMDCounts(sample_include, sample_include_interleaved_vec, pssi, sample_ct, variant_uidx, is_minimac3_r2, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, &hethap_ct, genocounts, all_dosages);
               if (unlikely(reterr)) {
                 new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
                 goto LoadAlleleAndGenoCountsThread_err;
               }
-              if (imp_r2_vals && (!is_minimac3_r2)) {
-                imp_r2_vals[variant_uidx] *= 0.5;
-              }
               if (allele_presents_bytearr) {
                 for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
                   if (all_dosages[aidx]) {
@@ -2744,198 +2725,231 @@ THREAD_FUNC_DECL LoadAlleleAndGenoCountsThread(void* raw_arg) {
                   }
                 }
               }
-              if (allele_ddosages) {
-                memcpy(&(allele_ddosages[cur_allele_idx_offset]), all_dosages, allele_ct * sizeof(int64_t));
+              if (!is_nonxy_haploid) {
+                hethap_ct = 0;
+                if (allele_ddosages) {
+                  for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
+                    allele_ddosages[cur_allele_idx_offset + aidx] = all_dosages[aidx] * 2;
+                  }
+                }
+              } else {
+                if (imp_r2_vals && (!is_minimac3_r2)) {
+                  imp_r2_vals[variant_uidx] *= 0.5;
+                }
+                if (allele_ddosages) {
+                  memcpy(&(allele_ddosages[cur_allele_idx_offset]), all_dosages, allele_ct * sizeof(int64_t));
+                }
               }
-              if (raw_geno_cts) {
-                STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
-                cur_raw_geno_cts[0] = genocounts[0];
-                cur_raw_geno_cts[1] = genocounts[1];
-                cur_raw_geno_cts[2] = genocounts[2];
+            } else if (is_y) {
+              if ((nonfemale_ct == chry_missingstat_sample_ct) && ((!allele_presents_bytearr) || (sample_ct == nonfemale_ct))) {
+                const PglErr reterr = PgrGetMDCounts(sex_nonfemale, sex_nonfemale_interleaved_vec, pssi, nonfemale_ct, variant_uidx, 0, pgrp, imp_r2_vals? (&(imp_r2_vals[variant_uidx])) : nullptr, &hethap_ct, genocounts, all_dosages);
+                if (unlikely(reterr)) {
+                  new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+                  goto LoadAlleleAndGenoCountsThread_err;
+                }
+                if (imp_r2_vals && (!is_minimac3_r2)) {
+                  imp_r2_vals[variant_uidx] *= 0.5;
+                }
+                if (allele_presents_bytearr) {
+                  for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
+                    if (all_dosages[aidx]) {
+                      allele_presents_bytearr[cur_allele_idx_offset + aidx] = 128;
+                    }
+                  }
+                }
+                if (allele_ddosages) {
+                  memcpy(&(allele_ddosages[cur_allele_idx_offset]), all_dosages, allele_ct * sizeof(int64_t));
+                }
+                if (raw_geno_cts) {
+                  STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
+                  cur_raw_geno_cts[0] = genocounts[0];
+                  cur_raw_geno_cts[1] = genocounts[1];
+                  cur_raw_geno_cts[2] = genocounts[2];
+                }
+              } else {
+                // females need to be counted for allele_presents, and ignored
+                // elsewhere.
+                // unknown-sex might need to be excluded from missing-genotype
+                // and hethap counts.
+                const PglErr reterr = PgrGetM(nullptr, pssi, raw_sample_ct, variant_uidx, pgrp, &pgv);
+                if (unlikely(reterr)) {
+                  new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+                  goto LoadAlleleAndGenoCountsThread_err;
+                }
+                // possible todo: use a specialized function which just checks
+                // which alleles exist
+                ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
+                GetMFlatCounts64(sample_include, sample_include_interleaved_vec, &pgv, raw_sample_ct, sample_ct, allele_ct, genocounts, all_dosages);
+                if (allele_presents_bytearr) {
+                  for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
+                    if (all_dosages[aidx]) {
+                      allele_presents_bytearr[cur_allele_idx_offset + aidx] = 128;
+                    }
+                  }
+                }
+
+                uint64_t* two_cts = &(all_dosages[allele_ct]);
+                GetMCounts64(sex_nonfemale, sex_nonfemale_interleaved_vec, &pgv, raw_sample_ct, nonfemale_ct, allele_ct, genocounts, all_dosages, two_cts);
+                if (allele_ddosages) {
+                  for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
+                    allele_ddosages[cur_allele_idx_offset + aidx] = all_dosages[aidx] * kDosageMid + two_cts[aidx] * kDosageMax;
+                  }
+                }
+                if (imp_r2_vals) {
+                  for (uint32_t aidx = 0; aidx != allele_ct; ++aidx) {
+                    const uint64_t one_ct = allele_ddosages[aidx];
+                    const uint64_t two_ct = two_cts[aidx];
+                    // now sums
+                    allele_ddosages[aidx] = one_ct * kDosageMid + two_ct * kDosageMax;
+                    // now ssqs
+                    two_cts[aidx] = one_ct * kDosageMid * kDosageMid + two_ct * kDosageMax * kDosageMax;
+                  }
+                  imp_r2_vals[variant_uidx] = 0.5 * MultiallelicDiploidMachR2(all_dosages, two_cts, nonfemale_ct - genocounts[3], allele_ct);
+                }
+                // argh
+                if (raw_geno_cts) {
+                  STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
+                  cur_raw_geno_cts[0] = genocounts[0];
+                  cur_raw_geno_cts[1] = genocounts[1];
+                  cur_raw_geno_cts[2] = genocounts[2];
+                }
+                if (nonfemale_ct != chry_missingstat_sample_ct) {
+                  GetMCounts64(sex_male, sex_male_interleaved_vec, &pgv, raw_sample_ct, male_ct, allele_ct, genocounts, all_dosages, two_cts);
+                }
+                uintptr_t hethap_x2 = 0;
+                for (uint32_t aidx = 0; aidx != allele_ct; ++aidx) {
+                  hethap_x2 += all_dosages[aidx];
+                }
+                hethap_ct = hethap_x2 / 2;
               }
             } else {
-              // females need to be counted for allele_presents, and ignored
-              // elsewhere.
-              // unknown-sex might need to be excluded from missing-genotype
-              // and hethap counts.
+              // chrX
+              // multiallelic dosages not supported yet
               const PglErr reterr = PgrGetM(nullptr, pssi, raw_sample_ct, variant_uidx, pgrp, &pgv);
               if (unlikely(reterr)) {
                 new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
                 goto LoadAlleleAndGenoCountsThread_err;
               }
-              // possible todo: use a specialized function which just checks
-              // which alleles exist
               ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
+              // We don't attempt to compute imp_r2 on chrX, so flat counts are
+              // fine.
               GetMFlatCounts64(sample_include, sample_include_interleaved_vec, &pgv, raw_sample_ct, sample_ct, allele_ct, genocounts, all_dosages);
-              if (allele_presents_bytearr) {
-                for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
-                  if (all_dosages[aidx]) {
-                    allele_presents_bytearr[cur_allele_idx_offset + aidx] = 128;
-                  }
-                }
-              }
 
-              uint64_t* two_cts = &(all_dosages[allele_ct]);
-              GetMCounts64(sex_nonfemale, sex_nonfemale_interleaved_vec, &pgv, raw_sample_ct, nonfemale_ct, allele_ct, genocounts, all_dosages, two_cts);
-              if (allele_ddosages) {
-                for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
-                  allele_ddosages[cur_allele_idx_offset + aidx] = all_dosages[aidx] * kDosageMid + two_cts[aidx] * kDosageMax;
-                }
-              }
-              if (imp_r2_vals) {
-                for (uint32_t aidx = 0; aidx != allele_ct; ++aidx) {
-                  const uint64_t one_ct = allele_ddosages[aidx];
-                  const uint64_t two_ct = two_cts[aidx];
-                  // now sums
-                  allele_ddosages[aidx] = one_ct * kDosageMid + two_ct * kDosageMax;
-                  // now ssqs
-                  two_cts[aidx] = one_ct * kDosageMid * kDosageMid + two_ct * kDosageMax * kDosageMax;
-                }
-                imp_r2_vals[variant_uidx] = 0.5 * MultiallelicDiploidMachR2(all_dosages, two_cts, nonfemale_ct - genocounts[3], allele_ct);
-              }
-              // argh
-              if (raw_geno_cts) {
-                STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
-                cur_raw_geno_cts[0] = genocounts[0];
-                cur_raw_geno_cts[1] = genocounts[1];
-                cur_raw_geno_cts[2] = genocounts[2];
-              }
-              if (nonfemale_ct != chry_missingstat_sample_ct) {
-                GetMCounts64(sex_male, sex_male_interleaved_vec, &pgv, raw_sample_ct, male_ct, allele_ct, genocounts, all_dosages, two_cts);
-              }
-              uintptr_t hethap_x2 = 0;
+              // Double all counts, then subtract male counts.
               for (uint32_t aidx = 0; aidx != allele_ct; ++aidx) {
-                hethap_x2 += all_dosages[aidx];
+                all_dosages[aidx] *= 2;
               }
-              hethap_ct = hethap_x2 / 2;
-            }
-          } else {
-            // chrX
-            // multiallelic dosages not supported yet
-            const PglErr reterr = PgrGetM(nullptr, pssi, raw_sample_ct, variant_uidx, pgrp, &pgv);
-            if (unlikely(reterr)) {
-              new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-              goto LoadAlleleAndGenoCountsThread_err;
-            }
-            ZeroTrailingNyps(raw_sample_ct, pgv.genovec);
-            // We don't attempt to compute imp_r2 on chrX, so flat counts are
-            // fine.
-            GetMFlatCounts64(sample_include, sample_include_interleaved_vec, &pgv, raw_sample_ct, sample_ct, allele_ct, genocounts, all_dosages);
-
-            // Double all counts, then subtract male counts.
-            for (uint32_t aidx = 0; aidx != allele_ct; ++aidx) {
-              all_dosages[aidx] *= 2;
-            }
-            GenoarrCountSubsetFreqs(pgv.genovec, sex_male_interleaved_vec, raw_sample_ct, male_ct, sex_specific_genocounts);
-            hethap_ct = sex_specific_genocounts[1];
-            if (male_ct) {
-              all_dosages[0] -= 2 * sex_specific_genocounts[0] + hethap_ct;
-
-              // may underflow
-              all_dosages[1] -= 2 * sex_specific_genocounts[2] + hethap_ct;
-
-              if (pgv.patch_01_ct) {
-                uintptr_t sample_widx = 0;
-                uintptr_t patch_01_bits = pgv.patch_01_set[0];
-                uint32_t male_patch_01_ct = 0;
-                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                  const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &patch_01_bits);
-                  if (sex_male[sample_widx] & lowbit) {
-                    ++male_patch_01_ct;
-                    all_dosages[pgv.patch_01_vals[uii]] -= 1;
+              GenoarrCountSubsetFreqs(pgv.genovec, sex_male_interleaved_vec, raw_sample_ct, male_ct, sex_specific_genocounts);
+              hethap_ct = sex_specific_genocounts[1];
+              if (male_ct) {
+                all_dosages[0] -= 2 * sex_specific_genocounts[0] + hethap_ct;
+
+                // may underflow
+                all_dosages[1] -= 2 * sex_specific_genocounts[2] + hethap_ct;
+
+                if (pgv.patch_01_ct) {
+                  uintptr_t sample_widx = 0;
+                  uintptr_t patch_01_bits = pgv.patch_01_set[0];
+                  uint32_t male_patch_01_ct = 0;
+                  for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                    const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &patch_01_bits);
+                    if (sex_male[sample_widx] & lowbit) {
+                      ++male_patch_01_ct;
+                      all_dosages[pgv.patch_01_vals[uii]] -= 1;
+                    }
+                  }
+                  all_dosages[1] += male_patch_01_ct;
+                }
+                if (pgv.patch_10_ct) {
+                  uintptr_t sample_widx = 0;
+                  uintptr_t patch_10_bits = pgv.patch_10_set[0];
+                  uint32_t male_patch_10_ct = 0;
+                  for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                    const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &patch_10_bits);
+                    if (sex_male[sample_widx] & lowbit) {
+                      ++male_patch_10_ct;
+                      const AlleleCode code_lo = pgv.patch_10_vals[2 * uii];
+                      const AlleleCode code_hi = pgv.patch_10_vals[2 * uii + 1];
+                      all_dosages[code_lo] -= 1;
+                      all_dosages[code_hi] -= 1;
+                      hethap_ct += (code_lo != code_hi);
+                    }
                   }
+                  all_dosages[1] += male_patch_10_ct * 2;
                 }
-                all_dosages[1] += male_patch_01_ct;
               }
-              if (pgv.patch_10_ct) {
-                uintptr_t sample_widx = 0;
-                uintptr_t patch_10_bits = pgv.patch_10_set[0];
-                uint32_t male_patch_10_ct = 0;
-                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                  const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &patch_10_bits);
-                  if (sex_male[sample_widx] & lowbit) {
-                    ++male_patch_10_ct;
-                    const AlleleCode code_lo = pgv.patch_10_vals[2 * uii];
-                    const AlleleCode code_hi = pgv.patch_10_vals[2 * uii + 1];
-                    all_dosages[code_lo] -= 1;
-                    all_dosages[code_hi] -= 1;
-                    hethap_ct += (code_lo != code_hi);
+              if (allele_presents_bytearr) {
+                for (uintptr_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                  if (all_dosages[allele_idx]) {
+                    allele_presents_bytearr[cur_allele_idx_offset + allele_idx] = 128;
                   }
                 }
-                all_dosages[1] += male_patch_10_ct * 2;
               }
-            }
-            if (allele_presents_bytearr) {
-              for (uintptr_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                if (all_dosages[allele_idx]) {
-                  allele_presents_bytearr[cur_allele_idx_offset + allele_idx] = 128;
+              if (allele_ddosages) {
+                for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
+                  allele_ddosages[cur_allele_idx_offset + aidx] = all_dosages[aidx] * kDosageMid;
                 }
               }
-            }
-            if (allele_ddosages) {
-              for (uintptr_t aidx = 0; aidx != allele_ct; ++aidx) {
-                allele_ddosages[cur_allele_idx_offset + aidx] = all_dosages[aidx] * kDosageMid;
+              if (x_male_geno_cts) {
+                STD_ARRAY_REF(uint32_t, 3) cur_x_male_geno_cts = x_male_geno_cts[variant_uidx - x_start];
+                cur_x_male_geno_cts[0] = sex_specific_genocounts[0];
+                cur_x_male_geno_cts[1] = sex_specific_genocounts[1];
+                cur_x_male_geno_cts[2] = sex_specific_genocounts[2];
+                if (x_nosex_geno_cts) {
+                  GenoarrCountSubsetFreqs(pgv.genovec, nosex_interleaved_vec, raw_sample_ct, nosex_ct, sex_specific_genocounts);
+                  STD_ARRAY_REF(uint32_t, 3) cur_nosex_geno_cts = x_nosex_geno_cts[variant_uidx - x_start];
+                  cur_nosex_geno_cts[0] = sex_specific_genocounts[0];
+                  cur_nosex_geno_cts[1] = sex_specific_genocounts[1];
+                  cur_nosex_geno_cts[2] = sex_specific_genocounts[2];
+                }
               }
             }
-            if (x_male_geno_cts) {
-              STD_ARRAY_REF(uint32_t, 3) cur_x_male_geno_cts = x_male_geno_cts[variant_uidx - x_start];
-              cur_x_male_geno_cts[0] = sex_specific_genocounts[0];
-              cur_x_male_geno_cts[1] = sex_specific_genocounts[1];
-              cur_x_male_geno_cts[2] = sex_specific_genocounts[2];
-              if (x_nosex_geno_cts) {
-                GenoarrCountSubsetFreqs(pgv.genovec, nosex_interleaved_vec, raw_sample_ct, nosex_ct, sex_specific_genocounts);
-                STD_ARRAY_REF(uint32_t, 3) cur_nosex_geno_cts = x_nosex_geno_cts[variant_uidx - x_start];
-                cur_nosex_geno_cts[0] = sex_specific_genocounts[0];
-                cur_nosex_geno_cts[1] = sex_specific_genocounts[1];
-                cur_nosex_geno_cts[2] = sex_specific_genocounts[2];
-              }
+            if (variant_missing_dosage_cts) {
+              // multiallelic dosage not supported yet
+              variant_missing_dosage_cts[variant_uidx] = genocounts[3];
             }
           }
-          if (variant_missing_dosage_cts) {
-            // multiallelic dosage not supported yet
-            variant_missing_dosage_cts[variant_uidx] = genocounts[3];
+          if (raw_geno_cts && (!is_y)) {
+            STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
+            cur_raw_geno_cts[0] = genocounts[0];
+            cur_raw_geno_cts[1] = genocounts[1];
+            cur_raw_geno_cts[2] = genocounts[2];
           }
-        }
-        if (raw_geno_cts && (!is_y)) {
-          STD_ARRAY_REF(uint32_t, 3) cur_raw_geno_cts = raw_geno_cts[variant_uidx];
-          cur_raw_geno_cts[0] = genocounts[0];
-          cur_raw_geno_cts[1] = genocounts[1];
-          cur_raw_geno_cts[2] = genocounts[2];
-        }
-        if (variant_missing_hc_cts) {
-          variant_missing_hc_cts[variant_uidx] = genocounts[3];
-          if (variant_hethap_cts && (variant_uidx >= first_hap_uidx)) {
-            variant_hethap_cts[variant_uidx - first_hap_uidx] = hethap_ct;
+          if (variant_missing_hc_cts) {
+            variant_missing_hc_cts[variant_uidx] = genocounts[3];
+            if (variant_hethap_cts && (variant_uidx >= first_hap_uidx)) {
+              variant_hethap_cts[variant_uidx - first_hap_uidx] = hethap_ct;
+            }
           }
         }
+        if (++subset_idx == subset_ct) {
+          break;
+        }
+        sample_include = ctx->founder_info;
+        sample_include_interleaved_vec = ctx->founder_info_interleaved_vec;
+        sample_include_cumulative_popcounts = ctx->founder_info_cumulative_popcounts;
+        sex_male = ctx->founder_male;
+        sex_male_interleaved_vec = ctx->founder_male_interleaved_vec;
+        sex_nonfemale = ctx->founder_nonfemale;
+        sex_nonfemale_interleaved_vec = ctx->founder_nonfemale_interleaved_vec;
+        sex_nonfemale_cumulative_popcounts = ctx->founder_nonfemale_cumulative_popcounts;
+
+        nosex_interleaved_vec = ctx->founder_nosex_interleaved_vec;
+
+        sample_ct = ctx->founder_ct;
+        male_ct = ctx->founder_male_ct;
+        nosex_ct = ctx->founder_nosex_ct;
+        nonfemale_ct = male_ct + nosex_ct;
+        chry_missingstat_sample_ct = ctx->founder_chry_missingstat_sample_ct;
+        allele_presents_bytearr = nullptr;
+        allele_ddosages = ctx->founder_allele_ddosages;
+        variant_missing_hc_cts = nullptr;
+        variant_missing_dosage_cts = nullptr;
+        raw_geno_cts = ctx->founder_raw_geno_cts;
+        x_male_geno_cts = ctx->founder_x_male_geno_cts;
+        x_nosex_geno_cts = ctx->founder_x_nosex_geno_cts;
+        imp_r2_vals = nullptr;
       }
-      if (++subset_idx == subset_ct) {
-        break;
-      }
-      sample_include = ctx->founder_info;
-      sample_include_interleaved_vec = ctx->founder_info_interleaved_vec;
-      sample_include_cumulative_popcounts = ctx->founder_info_cumulative_popcounts;
-      sex_male = ctx->founder_male;
-      sex_male_interleaved_vec = ctx->founder_male_interleaved_vec;
-      sex_nonfemale = ctx->founder_nonfemale;
-      sex_nonfemale_interleaved_vec = ctx->founder_nonfemale_interleaved_vec;
-      sex_nonfemale_cumulative_popcounts = ctx->founder_nonfemale_cumulative_popcounts;
-
-      nosex_interleaved_vec = ctx->founder_nosex_interleaved_vec;
-
-      sample_ct = ctx->founder_ct;
-      male_ct = ctx->founder_male_ct;
-      nosex_ct = ctx->founder_nosex_ct;
-      nonfemale_ct = male_ct + nosex_ct;
-      chry_missingstat_sample_ct = ctx->founder_chry_missingstat_sample_ct;
-      allele_presents_bytearr = nullptr;
-      allele_ddosages = ctx->founder_allele_ddosages;
-      variant_missing_hc_cts = nullptr;
-      variant_missing_dosage_cts = nullptr;
-      raw_geno_cts = ctx->founder_raw_geno_cts;
-      x_male_geno_cts = ctx->founder_x_male_geno_cts;
-      x_nosex_geno_cts = ctx->founder_x_nosex_geno_cts;
-      imp_r2_vals = nullptr;
     }
     while (0) {
     LoadAlleleAndGenoCountsThread_err:
@@ -3185,6 +3199,11 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
     } else {
       ctx.all_dosages = nullptr;
     }
+    // PgenMtLoadInit() may reduce calc_thread_ct, but not increase it.
+    unsigned char* tdq_alloc;
+    if (unlikely(bigstack_alloc_uc(TaskDequesAllocCachelineCt(calc_thread_ct) * kCacheline, &tdq_alloc))) {
+      goto LoadAlleleAndGenoCounts_ret_NOMEM;
+    }
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
     // defensive
     ctx.dosage_presents = nullptr;
@@ -3197,6 +3216,7 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
     if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
       goto LoadAlleleAndGenoCounts_ret_NOMEM;
     }
+    InitTaskDeques(calc_thread_ct, tdq_alloc, &ctx.tdq);
     ctx.variant_include = variant_include;
     ctx.allele_idx_offsets = allele_idx_offsets;
     ctx.err_info = (~0LLU) << 32;
@@ -3217,6 +3237,7 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
       }
       if (variant_idx) {
         JoinThreads(&tg);
+        TaskDequesBlockDone(&ctx.tdq);
         reterr = S_CAST(PglErr, ctx.err_info);
         if (unlikely(reterr)) {
           PgenErrPrintNV(reterr, ctx.err_info >> 32);
@@ -3224,8 +3245,8 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
         }
       }
       if (!IsLastBlock(&tg)) {
-        ctx.cur_block_size = cur_block_size;
-        ComputeUidxStartPartition(variant_include, cur_block_size, calc_thread_ct, read_block_idx * read_block_size, ctx.read_variant_uidx_starts);
+        ctx.cur_block_uidx_start = AdvTo1Bit(variant_include, read_block_idx * read_block_size);
+        ResetTaskDeques(cur_block_size, DivUp(cur_block_size, calc_thread_ct * 16), &ctx.tdq);
         PgrCopyBaseAndOffset(pgfip, calc_thread_ct, ctx.pgr_ptrs);
         if (variant_idx + cur_block_size == variant_ct) {
           DeclareLastThreadBlock(&tg);
@@ -3284,6 +3305,7 @@ PglErr LoadAlleleAndGenoCounts(const uintptr_t* sample_include, const uintptr_t*
     }
     fputs("\b\b", stdout);
     logputs("done.\n");
+    LogTaskDequesIdle("Allele frequency calculation", &ctx.tdq);
   }
   while (0) {
   LoadAlleleAndGenoCounts_ret_NOMEM:
@@ -6643,6 +6665,9 @@ PglErr MakePgenRobust(const uintptr_t* sample_include, const uint32_t* new_sampl
       const uint32_t read_phase_present = !!(read_gflags & (kfPgenGlobalHardcallPhasePresent | kfPgenGlobalDosagePhasePresent));
       const uint32_t read_dphase_present = (read_gflags / kfPgenGlobalDosagePhasePresent) & 1;
       PgenGlobalFlags write_gflags = read_gflags;
+      if (make_plink2_flags & kfMakePgenLdWindow) {
+        write_gflags |= kfPgenGlobalLdWindow;
+      }
       // When --hard-call-threshold is specified, if either hphase or dphase
       // values exist, the other can be generated.
       uint32_t read_or_write_phase_present = read_phase_present;
@@ -7710,6 +7735,9 @@ PglErr MakePlink2NoVsort(const uintptr_t* sample_include, const PedigreeIdInfo*
       const uint32_t read_phase_present = !!(read_gflags & (kfPgenGlobalHardcallPhasePresent | kfPgenGlobalDosagePhasePresent));
       const uint32_t read_dphase_present = (read_gflags / kfPgenGlobalDosagePhasePresent) & 1;
       PgenGlobalFlags write_gflags = read_gflags;
+      if (make_plink2_flags & kfMakePgenLdWindow) {
+        write_gflags |= kfPgenGlobalLdWindow;
+      }
       uint32_t read_or_write_phase_present = read_phase_present;
       uint32_t read_or_write_dphase_present = read_dphase_present;
       if ((mc.hard_call_halfdist || fill_missing_from_dosage) && (read_phase_present || read_or_write_dphase_present)) {
@@ -56,7 +56,8 @@ FLAGSET_DEF_START()
   kfMakePgenErasePhase = (1 << 20),
   kfMakePgenEraseDosage = (1 << 21),
   kfMakePgenFillMissingFromDosage = (1 << 22),
-  kfMakePgenWriterVer = (1 << 23)
+  kfMakePgenWriterVer = (1 << 23),
+  kfMakePgenLdWindow = (1 << 24)
 FLAGSET_DEF_END(MakePlink2Flags);
 
 FLAGSET_DEF_START()
@@ -4052,1920 +4052,2321 @@ char* AppendVcfMultiallelicDsForcePhased(uint32_t allele_ct_m2, uint32_t hds_for
   return write_iter;
 }
 
-PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const SampleIdInfo* siip, const uintptr_t* sex_male_collapsed, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* allele_permute, const uintptr_t* pvar_qual_present, const float* pvar_quals, const uintptr_t* pvar_filter_present, const uintptr_t* pvar_filter_npass, const char* const* pvar_filter_storage, const char* pvar_info_reload, const uint32_t* contig_lens, uintptr_t xheader_blen, InfoFlags info_flags, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_slen, uint32_t max_filter_slen, uint32_t info_reload_slen, uint32_t max_thread_ct, ExportfFlags exportf_flags, VcfExportMode vcf_mode, IdpasteFlags exportf_id_paste, char exportf_id_delim, char* xheader, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
-  unsigned char* bigstack_mark = g_bigstack_base;
-  PglErr reterr = kPglRetSuccess;
-  TextStream pvar_reload_txs;
-  BgzfCompressStream bgzf;
-  PreinitTextStream(&pvar_reload_txs);
-  PreinitBgzfCompressStream(&bgzf);
-  {
-    {
-      uint32_t clvl = 0;
-      if (!(exportf_flags & kfExportfBgz)) {
-        snprintf(outname_end, kMaxOutfnameExtBlen, ".vcf");
+typedef struct ExportVcfCtxStruct {
+  const uintptr_t* variant_include;
+  const ChrInfo* cip;
+  const uintptr_t* allele_idx_offsets;
+  const AlleleCode* allele_permute;
+  const uintptr_t* sample_include;
+  const uint32_t* sample_include_cumulative_popcounts;
+  const uintptr_t* sex_male_collapsed;
+  uint32_t sample_ct;
+  uint32_t write_some_dosage;
+  uint32_t write_ds;
+  uint32_t write_hds;
+  uint32_t ds_force;
+  uint32_t ds_only;
+  uint32_t hds_force;
+  uint32_t some_phased;
+
+  // See ExportVcf() for descriptions.
+  uint32_t basic_genotext[4];
+  uint32_t basic_genotext4[1024] ALIGNV16;
+  uint32_t phased_genotext2[492];
+  uint16_t ds_inttext[8];
+  uint16_t ds_inttext4[1024];
+  uint64_t hds_inttext[6];
+
+  PgenReader** pgr_ptrs;
+  uintptr_t** genovecs;
+  uintptr_t** thread_mhc;
+  uintptr_t** phasepresents;
+  uintptr_t** phaseinfos;
+  uintptr_t** dosage_presents;
+  Dosage** dosage_mains;
+  uintptr_t** dphase_presents;
+  SDosage** dphase_deltas;
+  uint32_t* read_variant_uidx_starts;
+
+  // only non-null when some_phased is set.  prev_phaseds[tidx] is the state
+  // just before thread tidx's first variant.
+  uintptr_t** prev_phaseds;
+
+  // only non-null when some_phased is set and there's more than one thread.
+  // Before each block is rendered, it's dispatched once with
+  // phase_summary_pass set; thread tidx then zeroes and fills
+  // het_seens[tidx + 1] (samples with a het call in its range) and
+  // prev_phaseds[tidx + 1] (their last phasepresent bit), from which the main
+  // thread derives every thread's starting state.
+  uintptr_t** het_seens;
+  uint32_t phase_summary_pass;
+
+  uint32_t cur_block_write_ct;
+
+  uintptr_t genotext_slot_blen;
+  char* genotext_bufs[2];
+  uintptr_t* genotext_blens[2];
+
+  // high 32 bits = variant_uidx, earlier one takes precedence
+  // low 32 bits = uint32_t(PglErr)
+  uint64_t err_info;
+} ExportVcfCtx;
+
+// Appends FORMAT and genotype columns (not including the line ending) for
+// one variant.  Doesn't print anything on error; kPglRetNotYetSupported
+// indicates that multiallelic rotation was needed.
+PglErr AppendVcfGenotext(const ExportVcfCtx* ctx, PgrSampleSubsetIndex pssi, uint32_t variant_uidx, uint32_t allele_ct, uint32_t ref_allele_idx, uint32_t alt1_allele_idx, uint32_t is_x, uint32_t is_haploid, PgenReader* pgrp, PgenVariant* pgvp, uintptr_t* prev_phased, char** write_iter_ptr) {
+  const uintptr_t* sample_include = ctx->sample_include;
+  const uintptr_t* sex_male_collapsed = ctx->sex_male_collapsed;
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
+  const uint32_t sample_ctl2_m1 = (sample_ct - 1) / kBitsPerWordD2;
+  const uint32_t write_some_dosage = ctx->write_some_dosage;
+  const uint32_t write_ds = ctx->write_ds;
+  const uint32_t write_hds = ctx->write_hds;
+  const uint32_t ds_force = ctx->ds_force;
+  const uint32_t ds_only = ctx->ds_only;
+  const uint32_t hds_force = ctx->hds_force;
+  const uint32_t some_phased = ctx->some_phased;
+  const uint32_t* basic_genotext = ctx->basic_genotext;
+  const uint32_t* basic_genotext4 = ctx->basic_genotext4;
+  const uint32_t* phased_genotext2 = ctx->phased_genotext2;
+  const uint16_t* ds_inttext = ctx->ds_inttext;
+  const uint16_t* ds_inttext4 = ctx->ds_inttext4;
+  const uint64_t* hds_inttext = ctx->hds_inttext;
+
+  // chrX: nonmales are diploid and use indices 0..3, males are 4..7
+  // other: all haploid, indices 0..3
+  uint32_t haploid_genotext_blen[8];
+  haploid_genotext_blen[1] = 4;
+  haploid_genotext_blen[4] = 2;
+  haploid_genotext_blen[5] = 4;
+  haploid_genotext_blen[6] = 2;
+  haploid_genotext_blen[7] = 2;
+
+  // [4]..[7] = haploid unphased; == 4 for phased
+  uint32_t hds_inttext_blen[8];
+  hds_inttext_blen[4] = 2;
+  hds_inttext_blen[5] = 4;
+  hds_inttext_blen[6] = 2;
+  hds_inttext_blen[7] = 2;
+  if (is_haploid && (!is_x)) {
+    haploid_genotext_blen[0] = 2;
+    haploid_genotext_blen[2] = 2;
+    haploid_genotext_blen[3] = 2;
+    hds_inttext_blen[0] = 2;
+    hds_inttext_blen[1] = 4;
+    hds_inttext_blen[2] = 2;
+    hds_inttext_blen[3] = 2;
+  } else {
+    haploid_genotext_blen[0] = 4;
+    haploid_genotext_blen[2] = 4;
+    haploid_genotext_blen[3] = 4;
+    hds_inttext_blen[0] = 4;
+    hds_inttext_blen[1] = 8;
+    hds_inttext_blen[2] = 4;
+    hds_inttext_blen[3] = 4;
+  }
+  char* write_iter = *write_iter_ptr;
+  PglErr reterr;
+  // FORMAT
+  if (!ds_only) {
+    write_iter = strcpya_k(write_iter, "\tGT");
+  }
+
+  // could defensively zero out more counts
+  pgvp->dosage_ct = 0;
+  pgvp->dphase_ct = 0;
+  uint32_t inner_loop_last = kBitsPerWordD2 - 1;
+  if (allele_ct == 2) {
+    if (!some_phased) {
+      // biallelic, nothing phased in entire file
+      // (technically possible for dosage-phase to be present, if no
+      // hardcalls are phased and HDS output not requested)
+      if (!write_some_dosage) {
+        reterr = PgrGet(sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp->genovec);
       } else {
-        snprintf(outname_end, kMaxOutfnameExtBlen, ".vcf.gz");
-        clvl = kBgzfDefaultClvl;
+        reterr = PgrGetD(sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp->genovec, pgvp->dosage_present, pgvp->dosage_main, &(pgvp->dosage_ct));
       }
-      reterr = InitBgzfCompressStreamEx(outname, 0, clvl, max_thread_ct, &bgzf);
       if (unlikely(reterr)) {
-        if (reterr == kPglRetOpenFail) {
-          logerrprintfww(kErrprintfFopen, outname, strerror(errno));
+        return reterr;
+      }
+      if (!alt1_allele_idx) {
+        // assumes biallelic
+        GenovecInvertUnsafe(sample_ct, pgvp->genovec);
+        if (pgvp->dosage_ct) {
+          BiallelicDosage16Invert(pgvp->dosage_ct, pgvp->dosage_main);
         }
-        goto ExportVcf_ret_1;
       }
-    }
-    const uint32_t max_chr_blen = GetMaxChrSlen(cip) + 1;
-    // CHROM, POS, ID, REF, one ALT, eoln
-    uintptr_t writebuf_blen = kMaxIdSlen + 32 + max_chr_blen + 2 * max_allele_slen;
-    // QUAL, FILTER, INFO, FORMAT, genotypes, eoln
-    // needs to be larger for >9 alt alleles
-    uint32_t write_some_dosage = 0;
-    uint32_t write_ds = 0;
-    uint32_t write_hds = 0;
-    uint32_t ds_force = 0;
-    uint32_t ds_only = 0;
-    uint32_t hds_force = 0;
-    if (vcf_mode != kVcfExport0) {
-      write_some_dosage = 1;
-      if (vcf_mode != kVcfExportGp) {
-        write_ds = 1;
-        if (vcf_mode == kVcfExportDsForce) {
-          ds_force = 1;
-        } else if (vcf_mode == kVcfExportDsOnly) {
-          // quasi-bugfix (16 Mar 2022): DS-only is now prohibited when partly-
-          // haploid or all-haploid variants are present, since without GT
-          // there to indicate ploidy, 0..1 vs. 0..2 scaling is not adequately
-          // defined.
-          if (unlikely((cip->haploid_mask[0] & 1) ||
-                       XymtIsNonempty(variant_include, cip, kChrOffsetX) ||
-                       XymtIsNonempty(variant_include, cip, kChrOffsetY) ||
-                       XymtIsNonempty(variant_include, cip, kChrOffsetMT))) {
-            logerrputs("Error: --export vcf-dosage=DS-only mode can only be used with all-diploid data.\n");
-            goto ExportVcf_ret_INCONSISTENT_INPUT;
+      if ((!pgvp->dosage_ct) && (!ds_force)) {
+        if (!is_haploid) {
+          // always 4 bytes wide, exploit that
+          GenoarrLookup256x4bx4(pgvp->genovec, basic_genotext4, sample_ct, write_iter);
+          write_iter = &(write_iter[sample_ct * 4]);
+        } else {
+          // chrX: male homozygous/missing calls use only one character +
+          //       tab
+          // other haploid/MT: this is true for nonmales too
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            uint32_t sex_male_hw = is_x * (DowncastKWToHW(sex_male_collapsed)[widx]);
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = sex_male_hw & 1;
+              memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+              write_iter = &(write_iter[haploid_genotext_blen[cur_geno + cur_is_male * 4]]);
+              genovec_word >>= 2;
+              sex_male_hw >>= 1;
+            }
           }
-          ds_force = 1;
-          ds_only = 1;
-        } else if (vcf_mode != kVcfExportDs) {
-          write_hds = 1;
-          if (vcf_mode == kVcfExportHdsForce) {
-            ds_force = 1;
-            hds_force = 1;
+        }
+      } else if ((!pgvp->dosage_ct) && ds_only && (!is_haploid)) {
+        write_iter = strcpya_k(write_iter, "\tDS");
+        // always 2 bytes wide, exploit that
+        GenoarrLookup256x2bx4(pgvp->genovec, ds_inttext4, sample_ct, write_iter);
+        write_iter = &(write_iter[sample_ct * 2]);
+      } else {
+        // some dosages present, or {H}DS-force; unphased
+        if (write_ds) {
+          if (ds_only) {
+            write_iter = strcpya_k(write_iter, "\tDS");
+          } else {
+            write_iter = strcpya_k(write_iter, ":DS");
+            if (hds_force) {
+              write_iter = strcpya_k(write_iter, ":HDS");
+            }
           }
+        } else {
+          write_iter = strcpya_k(write_iter, ":GP");
         }
-      }
-    }
-    if ((!ds_force) && write_some_dosage && (!(pgfip->gflags & kfPgenGlobalDosagePresent))) {
-      write_some_dosage = 0;
-      logerrprintf("Warning: No dosage data present.  %s will not be exported.\n", write_hds? "DS and HDS fields" : (write_ds? "DS field" : "GP field"));
-      write_ds = 0;
-      write_hds = 0;
-    }
-    // max_allele_ct == 2:
-    //   GT: 4 bytes (unless ds_only)
-    //   GP: 3 limited-precision numbers, up to (7 chars + delim) * 3
-    //   DS + HDS: also 3 limited precision numbers
-    //   DS only: 1 limited-precision number
-    // max_allele_ct > 2:
-    //   GT: 2 + 2 * UintSlen(max_allele_ct + 1) (unless ds_only)
-    //   GP: if requested, check max_gp_allele_ct among multiallelic-dosage
-    //         variants.
-    //       if none found (always true for now), 24 chars.
-    //       if present, (max_gp_allele_ct * (max_gp_allele_ct + 1) / 2) * 8,
-    //         which sucks ass
-    //   DS + HDS: 3 * (max_allele_ct - 1) limited-precision numbers
-    //   DS only: (max_allele_ct - 1) limited-precision numbers
-    uintptr_t output_bytes_per_sample;
-    if (!allele_idx_offsets) {
-      if (write_some_dosage) {
-        if (ds_only) {
-          output_bytes_per_sample = 8;
+        Dosage* dosage_main_iter = pgvp->dosage_main;
+        uint32_t dosage_present_hw = 0;
+        if (!is_haploid) {
+          // autosomal diploid, unphased
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (pgvp->dosage_ct) {
+              dosage_present_hw = DowncastWToHW(pgvp->dosage_present)[widx];
+            }
+            if (ds_only) {
+              for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+                const uint32_t cur_geno = genovec_word & 3;
+                if (dosage_present_hw & 1) {
+                  *write_iter++ = '\t';
+                  const uint32_t dosage_int = *dosage_main_iter++;
+                  write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
+                } else {
+                  write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                }
+                genovec_word >>= 2;
+                dosage_present_hw >>= 1;
+              }
+            } else {
+              for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+                const uint32_t cur_geno = genovec_word & 3;
+                write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
+                if (dosage_present_hw & 1) {
+                  *write_iter++ = ':';
+                  const uint32_t dosage_int = *dosage_main_iter++;
+                  write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
+                  if (hds_force) {
+                    *write_iter++ = ':';
+                    char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
+                    write_iter2[0] = ',';
+                    write_iter = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
+                  }
+                } else if (ds_force) {
+                  write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                  if (hds_force) {
+                    memcpy(write_iter, &(hds_inttext[cur_geno]), 8);
+                    write_iter = &(write_iter[hds_inttext_blen[cur_geno]]);
+                  }
+                }
+                genovec_word >>= 2;
+                dosage_present_hw >>= 1;
+              }
+            }
+          }
         } else {
-          output_bytes_per_sample = (write_ds && (!write_hds))? 12 : 28;
+          // at least partly haploid, unphased
+          const char ds_prechar = ds_only? '\t' : ':';
+          uint32_t sex_male_hw = 0;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (is_x) {
+              sex_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
+            }
+            if (pgvp->dosage_ct) {
+              dosage_present_hw = DowncastWToHW(pgvp->dosage_present)[widx];
+            }
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = sex_male_hw & 1;
+              const uint32_t cur_genotext_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
+              memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+              write_iter = &(write_iter[cur_genotext_blen]);
+              if (dosage_present_hw & 1) {
+                *write_iter++ = ds_prechar;
+                uint32_t dosage_int = *dosage_main_iter++;
+                if (cur_genotext_blen == 2) {
+                  // render current hardcall as haploid
+                  if (write_ds) {
+                    char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
+                    if (hds_force) {
+                      write_iter2[0] = ':';
+                      write_iter2 = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
+                    }
+                    write_iter = write_iter2;
+                  } else {
+                    // GP
+                    write_iter = PrintHaploidNonintDosage(kDosageMax - dosage_int, write_iter);
+                    *write_iter++ = ',';
+                    write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
+                  }
+                } else {
+                  // render current hardcall as diploid (female X, or het
+                  // haploid)
+                  write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
+                  if (hds_force) {
+                    *write_iter++ = ':';
+                    char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
+                    if (is_x && (!cur_is_male)) {
+                      // but do not render phased-dosage as diploid in het
+                      // haploid case
+                      write_iter2[0] = ',';
+                      write_iter2 = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
+                    }
+                    write_iter = write_iter2;
+                  }
+                }
+              } else if (ds_force) {
+                write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno + 8 - 2 * cur_genotext_blen]), 2);
+                if (hds_force) {
+                  memcpy(write_iter, &(hds_inttext[cur_geno]), 8);
+                  write_iter = &(write_iter[hds_inttext_blen[cur_is_male * 4 + cur_geno]]);
+                }
+              }
+              genovec_word >>= 2;
+              sex_male_hw >>= 1;
+              dosage_present_hw >>= 1;
+            }
+          }
         }
-      } else {
-        output_bytes_per_sample = 4;
       }
     } else {
-      const uint32_t max_allele_ct = PgrGetMaxAlleleCt(simple_pgrp);
-      if (ds_only) {
-        output_bytes_per_sample = 8 * (max_allele_ct - 1);
+      // biallelic, phased
+      if (!write_some_dosage) {
+        reterr = PgrGetP(sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp->genovec, pgvp->phasepresent, pgvp->phaseinfo, &(pgvp->phasepresent_ct));
       } else {
-        output_bytes_per_sample = 2 + 2 * UintSlen(max_allele_ct + 1);
-        if (write_some_dosage) {
-          if (write_ds) {
-            if (write_hds) {
-              output_bytes_per_sample += 24 * (max_allele_ct - 1);
-            } else {
-              output_bytes_per_sample += 8 * (max_allele_ct - 1);
+        reterr = PgrGetDp(sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp);
+      }
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      if (!alt1_allele_idx) {
+        // assumes biallelic
+        GenovecInvertUnsafe(sample_ct, pgvp->genovec);
+        if (pgvp->phasepresent_ct) {
+          BitvecInvert(sample_ctl, pgvp->phaseinfo);
+        }
+        if (pgvp->dosage_ct) {
+          BiallelicDosage16Invert(pgvp->dosage_ct, pgvp->dosage_main);
+          if (pgvp->dphase_ct) {
+            BiallelicDphase16Invert(pgvp->dphase_ct, pgvp->dphase_delta);
+          }
+        }
+      }
+      // little point in trying to optimize this case, thanks to
+      // prev_phased.  Instead, we might want to have a fast path for the
+      // all-phased case.
+      if (!pgvp->phasepresent_ct) {
+        ZeroWArr(sample_ctl, pgvp->phasepresent);
+      }
+      if ((!pgvp->dosage_ct) && (!ds_force)) {
+        if (!is_haploid) {
+          ZeroTrailingNyps(sample_ct, pgvp->genovec);
+          UpdateVcfPrevPhased(pgvp->genovec, pgvp->phasepresent, sample_ct, prev_phased);
+          BitvecAnd(pgvp->phasepresent, sample_ctl, pgvp->phaseinfo);
+          VcfPhaseLookup4b(pgvp->genovec, prev_phased, pgvp->phaseinfo, phased_genotext2, sample_ct, write_iter);
+          write_iter = &(write_iter[sample_ct * 4]);
+        } else {
+          uint32_t is_male_hw = 0;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
             }
-          } else {
-            // GP should only be written for biallelic variants, for now
-            // would need to take max of this and GT length, but this is always
-            // larger
-            output_bytes_per_sample = 28;
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (is_x) {
+              is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
+            }
+            uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+
+            const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+            const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = is_male_hw & 1;
+              const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
+              memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+              write_iter = &(write_iter[cur_blen]);
+              if (cur_blen == 4) {
+                if (cur_geno == 1) {
+                  // a bit redundant with how is_male_hw is handled, but
+                  // updating this on every loop iteration doesn't seem
+                  // better
+                  const uint32_t cur_shift = (1U << sample_idx_lowbits);
+                  if (phasepresent_hw & cur_shift) {
+                    prev_phased_halfword |= cur_shift;
+                    if (phaseinfo_hw & cur_shift) {
+                      memcpy(&(write_iter[-4]), "\t1|0", 4);
+                    } else {
+                      write_iter[-2] = '|';
+                    }
+                  } else {
+                    prev_phased_halfword &= ~cur_shift;
+                  }
+                } else if ((prev_phased_halfword >> sample_idx_lowbits) & 1) {
+                  write_iter[-2] = '|';
+                }
+              }
+              genovec_word >>= 2;
+              is_male_hw >>= 1;
+            }
+            DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
           }
         }
-      }
-    }
-    const uintptr_t writebuf_blen_lbound = sample_ct * output_bytes_per_sample + 32 + max_filter_slen + info_reload_slen;
-    if (writebuf_blen < writebuf_blen_lbound) {
-      writebuf_blen = writebuf_blen_lbound;
-    }
-    writebuf_blen += kMaxMediumLine;
-    char* writebuf;
-    if (unlikely(bigstack_alloc_c(writebuf_blen, &writebuf))) {
-      goto ExportVcf_ret_NOMEM;
-    }
-    char* writebuf_flush = &(writebuf[kMaxMediumLine]);
-    char* write_iter = writebuf;
-    const uint32_t v43 = (exportf_flags / kfExportfVcf43) & 1;
-    AppendVcfHeaderStart(v43, &write_iter);
-    if (cip->chrset_source) {
-      AppendChrsetLine(cip, &write_iter);
-    }
-    if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf))) {
-      goto ExportVcf_ret_WRITE_FAIL;
-    }
-    const uint32_t chr_ctl = BitCtToWordCt(cip->chr_ct);
-    uintptr_t* written_contig_header_lines;
-    if (unlikely(bigstack_calloc_w(chr_ctl, &written_contig_header_lines))) {
-      goto ExportVcf_ret_NOMEM;
-    }
-    // bugfix (30 Aug 2018): remove extraneous PAR1/PAR2 ##contig header lines,
-    // count them as part of chrX
-    const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
-    const uint32_t par1_code = cip->xymt_codes[kChrOffsetPAR1];
-    const uint32_t par2_code = cip->xymt_codes[kChrOffsetPAR2];
-    uint32_t contig_zero_written = 0;
-    uint32_t x_contig_line_written = 0;
-    if (xheader) {
-      memcpyo_k(writebuf, "##contig=<ID=", 13);
-      char* xheader_end = &(xheader[xheader_blen]);
-      for (char* line_end = xheader; line_end != xheader_end; ) {
-        char* xheader_iter = line_end;
-        line_end = AdvPastDelim(xheader_iter, '\n');
-        if (StrStartsWithUnsafe(xheader_iter, "##contig=<")) {
-          xheader_iter = &(xheader_iter[strlen("##contig=<")]);
-          char* idval;
-          uint32_t id_slen;
-          if (unlikely(HkvlineId(&xheader_iter, &idval, &id_slen))) {
-            logerrputs("Error: Malformed ##contig line in .pvar file.\n");
-            goto ExportVcf_ret_MALFORMED_INPUT;
-          }
-          if (xheader_iter[-1] == '>') {
-            // regenerate instead of keeping
-            continue;
-          }
-          // if GetChrCodeCounted() is modified to not mutate idval[], xheader
-          // can be changed to const char*
-          const uint32_t chr_idx = GetChrCodeCounted(cip, id_slen, idval);
-          // bugfix (8 Sep 2018): must exclude ##contig lines not present in
-          // input, otherwise chr_fo_idx == 0xffffffffU, etc.
-          if (IsI32Neg(chr_idx) || (!IsSet(cip->chr_mask, chr_idx)) || (chr_idx == par1_code) || (chr_idx == par2_code)) {
-            continue;
-          }
-          if (chr_idx == x_code) {
-            x_contig_line_written = 1;
-          }
-          const uint32_t chr_fo_idx = cip->chr_idx_to_foidx[chr_idx];
-          if (unlikely(IsSet(written_contig_header_lines, chr_fo_idx))) {
-            logerrputs("Error: Duplicate ##contig line in .pvar file.\n");
-            goto ExportVcf_ret_MALFORMED_INPUT;
+      } else {
+        // both dosage (or {H}DS-force) and phase present
+        if (write_ds) {
+          write_iter = strcpya_k(write_iter, ":DS");
+          if (hds_force || pgvp->dphase_ct ||
+              (write_hds && pgvp->phasepresent_ct && pgvp->dosage_ct && (!IntersectionIsEmpty(pgvp->phasepresent, pgvp->dosage_present, sample_ctl)))) {
+            write_iter = strcpya_k(write_iter, ":HDS");
+            // dphase_present can be nullptr, so we zero-initialize
+            // dphase_present_hw and never refresh it when dphase_ct == 0.
           }
-          SetBit(chr_fo_idx, written_contig_header_lines);
-          // if --output-chr was used at some point, we need to sync the
-          // ##contig chromosome code with the code in the VCF body.
-          char* contig_write_start = &(writebuf[13]);
-          write_iter = chrtoa(cip, chr_idx, contig_write_start);
-          if ((*contig_write_start == '0') && (write_iter == &(contig_write_start[1]))) {
-            // --allow-extra-chr 0 special case
-            contig_zero_written = 1;  // technically we write this a bit later
-            continue;
+        } else {
+          write_iter = strcpya_k(write_iter, ":GP");
+        }
+        Dosage* dosage_main_iter = pgvp->dosage_main;
+        SDosage* dphase_delta_iter = pgvp->dphase_delta;
+        uint32_t dosage_present_hw = 0;
+        uint32_t dphase_present_hw = 0;
+        if (!is_haploid) {
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+            const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+            const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+            if (pgvp->dosage_ct) {
+              dosage_present_hw = DowncastWToHW(pgvp->dosage_present)[widx];
+              if (pgvp->dphase_ct) {
+                dphase_present_hw = DowncastWToHW(pgvp->dphase_present)[widx];
+              }
+            }
+            uint32_t cur_shift = 1;
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
+              if (cur_geno == 1) {
+                if (phasepresent_hw & cur_shift) {
+                  prev_phased_halfword |= cur_shift;
+                  if (phaseinfo_hw & cur_shift) {
+                    memcpy(&(write_iter[-4]), "\t1|0", 4);
+                  }
+                } else {
+                  prev_phased_halfword &= ~cur_shift;
+                }
+              }
+              if (prev_phased_halfword & cur_shift) {
+                write_iter[-2] = '|';
+              }
+              if (dosage_present_hw & cur_shift) {
+                *write_iter++ = ':';
+                const uint32_t dosage_int = *dosage_main_iter++;
+                write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
+                // bugfix (29 May 2018): don't print HDS field if not
+                // requested
+                if (write_hds) {
+                  if ((phasepresent_hw | dphase_present_hw) & cur_shift) {
+                    int32_t cur_dphase_delta;
+                    if (dphase_present_hw & cur_shift) {
+                      cur_dphase_delta = *dphase_delta_iter++;
+                    } else {
+                      cur_dphase_delta = DosageHomdist(dosage_int);
+                      if (!(phaseinfo_hw & cur_shift)) {
+                        cur_dphase_delta = -cur_dphase_delta;
+                      }
+                    }
+                    *write_iter++ = ':';
+                    write_iter = PrintHdsPair(dosage_int, cur_dphase_delta, write_iter);
+                  } else if (hds_force) {
+                    *write_iter++ = ':';
+                    char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
+                    write_iter2[0] = ',';
+                    write_iter = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
+                  }
+                }
+              } else if (ds_force) {
+                write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                if (hds_force) {
+                  uint32_t hds_inttext_index = cur_geno;
+                  uint32_t tmp_blen = hds_inttext_blen[cur_geno];
+                  if (phasepresent_hw & cur_shift) {
+                    // do we want to remove this branch?  doubt it's
+                    // worthwhile since variable-length memcpy will branch
+                    // anyway...
+                    hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
+                    tmp_blen = 4;
+                  }
+                  memcpy(write_iter, &(hds_inttext[hds_inttext_index]), 8);
+                  write_iter = &(write_iter[tmp_blen]);
+                }
+              }
+              genovec_word >>= 2;
+              cur_shift <<= 1;
+            }
+            DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
           }
-          if (unlikely(!ValidVcfContigName(contig_write_start, write_iter, v43))) {
-            goto ExportVcf_ret_MALFORMED_INPUT;
+        } else {
+          // dosage (or {H}DS-force) and phase present, partly/fully
+          // haploid
+          uint32_t is_male_hw = 0;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (is_x) {
+              is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
+            }
+            uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+            const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+            const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+            if (pgvp->dosage_ct) {
+              dosage_present_hw = DowncastWToHW(pgvp->dosage_present)[widx];
+              if (pgvp->dphase_ct) {
+                dphase_present_hw = DowncastWToHW(pgvp->dphase_present)[widx];
+              }
+            }
+            uint32_t cur_shift = 1;
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = is_male_hw & 1;
+              const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
+              memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+              write_iter = &(write_iter[cur_blen]);
+              if (cur_blen == 4) {
+                // render current hardcall as diploid (chrX nonmale, or het
+                // haploid)
+                if (cur_geno == 1) {
+                  if (phasepresent_hw & cur_shift) {
+                    prev_phased_halfword |= cur_shift;
+                    if (phaseinfo_hw & cur_shift) {
+                      memcpy(&(write_iter[-4]), "\t1|0", 4);
+                    }
+                  } else {
+                    prev_phased_halfword &= ~cur_shift;
+                  }
+                }
+                if (prev_phased_halfword & cur_shift) {
+                  write_iter[-2] = '|';
+                }
+                if (dosage_present_hw & cur_shift) {
+                  *write_iter++ = ':';
+                  const uint32_t dosage_int = *dosage_main_iter++;
+                  write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
+                  if (write_hds) {
+                    if ((phasepresent_hw | dphase_present_hw) & cur_shift) {
+                      int32_t cur_dphase_delta;
+                      if (dphase_present_hw & cur_shift) {
+                        cur_dphase_delta = *dphase_delta_iter++;
+                      } else {
+                        cur_dphase_delta = DosageHomdist(dosage_int);
+                        if (!(phaseinfo_hw & cur_shift)) {
+                          cur_dphase_delta = -cur_dphase_delta;
+                        }
+                      }
+                      *write_iter++ = ':';
+                      write_iter = PrintHdsPair(dosage_int, cur_dphase_delta, write_iter);
+                    } else if (hds_force) {
+                      *write_iter++ = ':';
+                      char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
+                      // do not render phased-dosage as diploid in unphased
+                      // het haploid case
+                      if (is_x && (!cur_is_male)) {
+                        write_iter2[0] = ',';
+                        write_iter2 = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
+                      }
+                      write_iter = write_iter2;
+                    }
+                  }
+                } else if (ds_force) {
+                  write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                  if (hds_force) {
+                    uint32_t hds_inttext_index = cur_geno;
+                    uint32_t tmp_blen;
+                    if (phasepresent_hw & cur_shift) {
+                      // do we want to remove this branch?  doubt it's
+                      // worthwhile since variable-length memcpy will
+                      // branch anyway...
+                      hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
+                      tmp_blen = 4;
+                    } else {
+                      // do not render phased-dosage as diploid in het
+                      // haploid case
+                      tmp_blen = hds_inttext_blen[cur_is_male * 4 + cur_geno];
+                    }
+                    memcpy(write_iter, &(hds_inttext[hds_inttext_index]), 8);
+                    write_iter = &(write_iter[tmp_blen]);
+                  }
+                }
+              } else {
+                // render current hardcall as haploid
+                // (can't get here for hardcall-phased)
+                if (dosage_present_hw & cur_shift) {
+                  *write_iter++ = ':';
+                  const uint32_t dosage_int = *dosage_main_iter++;
+                  if (write_ds) {
+                    write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
+                    if (dphase_present_hw & cur_shift) {
+                      // explicit dosage-phase, so render HDS as diploid
+                      const int32_t cur_dphase_delta = *dphase_delta_iter++;
+                      *write_iter++ = ':';
+                      write_iter = PrintHdsPair(dosage_int, cur_dphase_delta, write_iter);
+                    } else if (hds_force) {
+                      *write_iter++ = ':';
+                      write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
+                    }
+                  } else {
+                    // GP
+                    write_iter = PrintHaploidNonintDosage(kDosageMax - dosage_int, write_iter);
+                    *write_iter++ = ',';
+                    write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
+                  }
+                } else if (ds_force) {
+                  write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno + 4]), 2);
+                  if (hds_force) {
+                    memcpy(write_iter, &(hds_inttext[cur_geno]), 8);
+                    write_iter = &(write_iter[hds_inttext_blen[cur_geno + 4]]);
+                  }
+                }
+              }
+              genovec_word >>= 2;
+              is_male_hw >>= 1;
+              cur_shift <<= 1;
+            }
+            DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
           }
-          if (contig_lens && contig_lens[chr_idx]) {
-            *write_iter++ = ',';
-            if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf))) {
-              goto ExportVcf_ret_WRITE_FAIL;
+        }
+      }
+    }
+  } else {
+    // multiallelic cases
+    // multiallelic dosage not supported yet
+    // don't bother supporting multiallelic GP export when dosages present:
+    // no clean way to handle e.g. dosage(A) = dosage(C) = dosage(G) =
+    // dosage(T)=0.5
+    if (ref_allele_idx || (alt1_allele_idx != 1)) {
+      // todo: rotation function that can also be used by --make-pgen
+      // maybe add a PgrGetM2() function too
+      return kPglRetNotYetSupported;
+    }
+    if (!some_phased) {
+      reterr = PgrGetM(sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      if (!ds_force) {
+        if (!is_haploid) {
+          if (allele_ct <= 10) {
+            GenoarrLookup256x4bx4(pgvp->genovec, basic_genotext4, sample_ct, write_iter);
+            if (pgvp->patch_01_ct) {
+              // Patch some 0/1 entries to 0/x.
+              char* genotext_offset3 = &(write_iter[3]);
+              uintptr_t sample_idx_base = 0;
+              uintptr_t patch_01_bits = pgvp->patch_01_set[0];
+              for (uint32_t uii = 0; uii != pgvp->patch_01_ct; ++uii) {
+                const uintptr_t sample_idx = BitIter1(pgvp->patch_01_set, &sample_idx_base, &patch_01_bits);
+                genotext_offset3[4 * sample_idx] = '0' + pgvp->patch_01_vals[uii];
+              }
             }
-            reterr = BgzfFixAndWriteContigHeaderLine(xheader_iter, idval, line_end, id_slen, contig_lens[chr_idx], &bgzf);
-            if (unlikely(reterr)) {
-              goto ExportVcf_ret_1;
+            if (pgvp->patch_10_ct) {
+              // Patch some 1/1 entries to x/y.
+              char* genotext_offset1 = &(write_iter[1]);
+              uintptr_t sample_idx_base = 0;
+              uintptr_t patch_10_bits = pgvp->patch_10_set[0];
+              for (uint32_t uii = 0; uii != pgvp->patch_10_ct; ++uii) {
+                const uintptr_t sample_idx = BitIter1(pgvp->patch_10_set, &sample_idx_base, &patch_10_bits);
+                genotext_offset1[4 * sample_idx] = '0' + pgvp->patch_10_vals[2 * uii];
+                genotext_offset1[4 * sample_idx + 2] = '0' + pgvp->patch_10_vals[2 * uii + 1];
+              }
             }
+            write_iter = &(write_iter[sample_ct * 4]);
           } else {
-            if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf) ||
-                         BgzfWriteRestOfHeaderLine(xheader_iter, idval, line_end, id_slen, &bgzf))) {
-              goto ExportVcf_ret_WRITE_FAIL;
+            if (!pgvp->patch_01_ct) {
+              ZeroWArr(sample_ctl, pgvp->patch_01_set);
+            }
+            if (!pgvp->patch_10_ct) {
+              ZeroWArr(sample_ctl, pgvp->patch_10_set);
+            }
+            const AlleleCode* patch_01_vals_iter = pgvp->patch_01_vals;
+            const AlleleCode* patch_10_vals_iter = pgvp->patch_10_vals;
+            for (uint32_t widx = 0; ; ++widx) {
+              if (widx >= sample_ctl2_m1) {
+                if (widx > sample_ctl2_m1) {
+                  break;
+                }
+                inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+              }
+              uintptr_t genovec_word = pgvp->genovec[widx];
+              uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+              for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+                const uint32_t cur_geno = genovec_word & 3;
+                if (!(multiallelic_hw & 1)) {
+                  write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
+                } else if (cur_geno == 1) {
+                  write_iter = strcpya_k(write_iter, "\t0/");
+                  const AlleleCode ac = *patch_01_vals_iter++;
+                  write_iter = u32toa(ac, write_iter);
+                } else {
+                  AlleleCode ac = *patch_10_vals_iter++;
+                  *write_iter++ = '\t';
+                  write_iter = u32toa_x(ac, '/', write_iter);
+                  ac = *patch_10_vals_iter++;
+                  write_iter = u32toa(ac, write_iter);
+                }
+                genovec_word >>= 2;
+                multiallelic_hw >>= 1;
+              }
             }
           }
-        } else if (xheader_iter[1] == '#') {
-          // quasi-bugfix (23 Jan 2021): don't export pre-#CHROM header lines
-          // starting with a single '#'
-          const uint32_t slen = line_end - xheader_iter;
-          if (unlikely(!ValidVcfMetaLine(xheader_iter, slen, v43))) {
-            goto ExportVcf_ret_INCONSISTENT_INPUT;
+        } else {
+          if (!pgvp->patch_01_ct) {
+            ZeroWArr(sample_ctl, pgvp->patch_01_set);
           }
-          if (unlikely(BgzfWrite(xheader_iter, slen, &bgzf))) {
-            goto ExportVcf_ret_WRITE_FAIL;
+          if (!pgvp->patch_10_ct) {
+            ZeroWArr(sample_ctl, pgvp->patch_10_set);
+          }
+          // at least partially haploid, !ds_force
+          // We don't separately the allele_ct <= 10 vs. > 10 cases when
+          // entries are already variable-width in the <= 10 case.
+          const AlleleCode* patch_01_vals_iter = pgvp->patch_01_vals;
+          const AlleleCode* patch_10_vals_iter = pgvp->patch_10_vals;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            uint32_t sex_male_hw = is_x * (DowncastKWToHW(sex_male_collapsed)[widx]);
+            // no need to separate patch_01 and patch_10 since this
+            // information is redundant with genovec_word contents
+            uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+            // probable todo: multiallelic_hw == 0 fast path, check
+            // whether <= inner_loop_last vs. < inner_loop_end makes a
+            // difference, etc.
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = sex_male_hw & 1;
+              if (!(multiallelic_hw & 1)) {
+                memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+                write_iter = &(write_iter[haploid_genotext_blen[cur_geno + cur_is_male * 4]]);
+              } else if (cur_geno == 1) {
+                // always heterozygous, 4 characters
+                write_iter = strcpya_k(write_iter, "\t0/");
+                const AlleleCode ac = *patch_01_vals_iter++;
+                write_iter = u32toa(ac, write_iter);
+              } else {
+                const AlleleCode ac0 = *patch_10_vals_iter++;
+                const AlleleCode ac1 = *patch_10_vals_iter++;
+                *write_iter++ = '\t';
+                write_iter = u32toa(ac0, write_iter);
+                if ((ac0 != ac1) || (haploid_genotext_blen[2 + cur_is_male * 4] == 4)) {
+                  *write_iter++ = '/';
+                  write_iter = u32toa(ac1, write_iter);
+                }
+              }
+              genovec_word >>= 2;
+              sex_male_hw >>= 1;
+              multiallelic_hw >>= 1;
+            }
           }
         }
-      }
-    }
-    write_iter = writebuf;
-    // fill in the missing ##contig lines
-    if (contig_zero_written) {
-      write_iter = strcpya_k(write_iter, "##contig=<ID=0,length=2147483645>" EOLN_STR);
-    }
-    uint32_t chrx_exists = 0;
-    for (uint32_t chr_fo_idx = 0; chr_fo_idx != cip->chr_ct; ++chr_fo_idx) {
-      if (IsSet(written_contig_header_lines, chr_fo_idx)) {
-        continue;
-      }
-      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
-      if ((!IsSet(cip->chr_mask, chr_idx)) || AllBitsAreZero(variant_include, cip->chr_fo_vidx_start[chr_fo_idx], cip->chr_fo_vidx_start[chr_fo_idx + 1])) {
-        continue;
-      }
-      if ((chr_idx == x_code) || (chr_idx == par1_code) || (chr_idx == par2_code)) {
-        chrx_exists = 1;
-        continue;
-      }
-      char* chr_name_write_start = strcpya_k(write_iter, "##contig=<ID=");
-      char* chr_name_write_end = chrtoa(cip, chr_idx, chr_name_write_start);
-      if ((*chr_name_write_start == '0') && (chr_name_write_end == &(chr_name_write_start[1]))) {
-        // --allow-extra-chr 0 special case
-        if (contig_zero_written) {
-          continue;
-        }
-        contig_zero_written = 1;
-        write_iter = strcpya_k(chr_name_write_end, ",length=2147483645");
       } else {
-        if (unlikely(!ValidVcfContigName(chr_name_write_start, chr_name_write_end, v43))) {
-          goto ExportVcf_ret_MALFORMED_INPUT;
+        if (!pgvp->patch_01_ct) {
+          ZeroWArr(sample_ctl, pgvp->patch_01_set);
         }
-        write_iter = chr_name_write_end;
-        if (contig_lens && contig_lens[chr_idx]) {
-          write_iter = strcpya_k(write_iter, ",length=");
-          write_iter = u32toa(contig_lens[chr_idx], write_iter);
+        if (!pgvp->patch_10_ct) {
+          ZeroWArr(sample_ctl, pgvp->patch_10_set);
+        }
+        // ds_force, !some_phased
+        if (ds_only) {
+          write_iter = strcpya_k(write_iter, "\tDS");
+        } else {
+          write_iter = strcpya_k(write_iter, ":DS");
+          if (hds_force) {
+            write_iter = strcpya_k(write_iter, ":HDS");
+          }
+        }
+        const uint32_t allele_ct_m2 = allele_ct - 2;
+        const AlleleCode* patch_01_vals_iter = pgvp->patch_01_vals;
+        const AlleleCode* patch_10_vals_iter = pgvp->patch_10_vals;
+        if (!is_haploid) {
+          // DS-force, autosomal diploid, unphased, dosage_ct == 0
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              if (!(multiallelic_hw & 1)) {
+                if (!ds_only) {
+                  write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
+                }
+                // DS
+                write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                if (cur_geno != 3) {
+                  // repeat ",0" if nonmissing
+                  write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                  if (hds_force) {
+                    uint64_t cur_inttext = hds_inttext[cur_geno];
+                    const uint32_t hap_blen = hds_inttext_blen[cur_geno + 4];
+                    memcpy(write_iter, &cur_inttext, 4);
+                    write_iter = &(write_iter[hap_blen]);
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                    cur_inttext = cur_inttext >> (8 * hap_blen);
+                    memcpy(write_iter, &cur_inttext, 4);
+                    write_iter = &(write_iter[hap_blen]);
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                  }
+                } else {
+                  if (hds_force) {
+                    write_iter = strcpya_k(write_iter, ":.,.");
+                  }
+                }
+              } else if (cur_geno == 1) {
+                const AlleleCode ac = *patch_01_vals_iter++;
+                write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, ds_only, ds_force, ac, 0, write_iter);
+              } else {
+                const AlleleCode ac0 = *patch_10_vals_iter++;
+                const AlleleCode ac1 = *patch_10_vals_iter++;
+                if (ac0 != ac1) {
+                  write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, ds_only, hds_force, ac0, ac1, 0, write_iter);
+                } else {
+                  write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, ds_only, hds_force, ac0, '/', write_iter);
+                }
+              }
+              genovec_word >>= 2;
+              multiallelic_hw >>= 1;
+            }
+          }
+        } else {
+          // DS-force, at least partly haploid, unphased
+          uint32_t sex_male_hw = 0;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (is_x) {
+              sex_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
+            }
+            uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = sex_male_hw & 1;
+              const uint32_t should_be_diploid = is_x && (!cur_is_male);
+              if (!(multiallelic_hw & 1)) {
+                const uint32_t cur_genotext_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
+                memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+                write_iter = &(write_iter[cur_genotext_blen]);
+                // DS
+                write_iter = memcpya(write_iter, &(ds_inttext[cur_geno + 8 - 2 * cur_genotext_blen]), 2);
+                if (cur_geno != 3) {
+                  // repeat ",0"
+                  write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                  if (hds_force) {
+                    uint64_t cur_inttext = hds_inttext[cur_geno];
+                    const uint32_t hap_blen = hds_inttext_blen[4 + cur_geno];
+                    memcpy(write_iter, &cur_inttext, 4);
+                    write_iter = &(write_iter[hap_blen]);
+                    if (should_be_diploid) {
+                      write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                      cur_inttext = cur_inttext >> (8 * hap_blen);
+                      memcpy(write_iter, &cur_inttext, 4);
+                      write_iter = &(write_iter[hap_blen]);
+                    }
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                  }
+                } else {
+                  if (hds_force) {
+                    strcpy_k(write_iter, ":.,.");
+                    write_iter = &(write_iter[2 + 2 * (is_x & (~cur_is_male))]);
+                  }
+                }
+              } else if (cur_geno == 1) {
+                const AlleleCode ac = *patch_01_vals_iter++;
+                write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, ds_only, hds_force, ac, !should_be_diploid, write_iter);
+              } else {
+                const AlleleCode ac0 = *patch_10_vals_iter++;
+                const AlleleCode ac1 = *patch_10_vals_iter++;
+                if (ac0 != ac1) {
+                  write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, ds_only, hds_force, ac0, ac1, !should_be_diploid, write_iter);
+                } else if (haploid_genotext_blen[cur_geno + cur_is_male * 4] == 2) {
+                  write_iter = AppendVcfMultiallelicDsForce10Haploid(allele_ct_m2, ds_only, hds_force, ac0, write_iter);
+                } else {
+                  write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, ds_only, hds_force, ac0, '/', write_iter);
+                }
+              }
+              genovec_word >>= 2;
+              multiallelic_hw >>= 1;
+            }
+          }
         }
       }
-      *write_iter++ = '>';
-      AppendBinaryEoln(&write_iter);
-      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
-        goto ExportVcf_ret_WRITE_FAIL;
-      }
-    }
-    if (chrx_exists && (!x_contig_line_written)) {
-      char* chr_name_write_start = strcpya_k(write_iter, "##contig=<ID=");
-      char* chr_name_write_end = chrtoa(cip, x_code, chr_name_write_start);
-      write_iter = strcpya_k(chr_name_write_end, ">" EOLN_STR);
-      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
-        goto ExportVcf_ret_WRITE_FAIL;
-      }
-    }
-    BigstackReset(written_contig_header_lines);
-    const uintptr_t* nonref_flags = pgfip->nonref_flags;
-    const uint32_t all_nonref = (pgfip->gflags & kfPgenGlobalAllNonref) && (!nonref_flags);
-    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
-    uint32_t write_pr = all_nonref;
-    if (nonref_flags) {
-      write_pr = !IntersectionIsEmpty(variant_include, nonref_flags, raw_variant_ctl);
-    }
-    const uint32_t info_pr_flag_present = (info_flags / kfInfoPrFlagPresent) & 1;
-    if (write_pr) {
-      if (unlikely(info_flags & kfInfoPrNonflagPresent)) {
-        logerrputs("Error: Conflicting INFO/PR definitions.  Either fix all REF alleles so that the\n'provisional reference' flag is no longer needed, or remove/rename the other\nuse of the INFO/PR key.\n");
-        goto ExportVcf_ret_INCONSISTENT_INPUT;
-      }
-      if (!info_pr_flag_present) {
-        write_iter = strcpya_k(write_iter, "##INFO=<ID=PR,Number=0,Type=Flag,Description=\"Provisional reference allele, may not be based on real reference genome\">" EOLN_STR);
+    } else {
+      // multiallelic, phased
+      reterr = PgrGetMP(sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp);
+      if (unlikely(reterr)) {
+        return reterr;
+      }
+      if (!pgvp->patch_01_ct) {
+        ZeroWArr(sample_ctl, pgvp->patch_01_set);
+      }
+      if (!pgvp->patch_10_ct) {
+        ZeroWArr(sample_ctl, pgvp->patch_10_set);
+      }
+      if (!pgvp->phasepresent_ct) {
+        ZeroWArr(sample_ctl, pgvp->phasepresent);
+      }
+      const AlleleCode* patch_01_vals_iter = pgvp->patch_01_vals;
+      const AlleleCode* patch_10_vals_iter = pgvp->patch_10_vals;
+      if (!ds_force) {
+        if (!is_haploid) {
+          if (allele_ct <= 10) {
+            for (uint32_t widx = 0; ; ++widx) {
+              if (widx >= sample_ctl2_m1) {
+                if (widx > sample_ctl2_m1) {
+                  break;
+                }
+                inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+              }
+              uintptr_t genovec_word = pgvp->genovec[widx];
+              const uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+              uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+              const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+              const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+              uint32_t cur_shift = 1;
+              for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+                const uintptr_t cur_geno = genovec_word & 3;
+                uint32_t cur_basic_genotext;
+                if (!(multiallelic_hw & cur_shift)) {
+                  // usually "\t0/0", etc.
+                  cur_basic_genotext = basic_genotext[cur_geno];
+                  if (cur_geno == 1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        cur_basic_genotext ^= 0x1000100;  // 0|1 -> 1|0
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  }
+                } else {
+                  AlleleCode ac0;
+                  AlleleCode ac1;
+                  if (cur_geno == 1) {
+                    ac0 = 0;
+                    ac1 = *patch_01_vals_iter++;
+                  } else {
+                    ac0 = *patch_10_vals_iter++;
+                    ac1 = *patch_10_vals_iter++;
+                  }
+                  if (ac0 != ac1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        const AlleleCode ac_swap = ac0;
+                        ac0 = ac1;
+                        ac1 = ac_swap;
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  }
+                  cur_basic_genotext = 0x302f3009 + (ac0 * 256) + (ac1 * 0x1000000);
+                }
+                // '/' = ascii 47, '|' = ascii 124
+                CAppendU32(cur_basic_genotext + 0x4d0000 * ((prev_phased_halfword >> sample_idx_lowbits) & 1), &write_iter);
+                genovec_word >>= 2;
+                cur_shift = cur_shift * 2;
+              }
+              DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
+            }
+          } else {
+            // phased, allele_ct > 10, !is_haploid, !ds_force
+            for (uint32_t widx = 0; ; ++widx) {
+              if (widx >= sample_ctl2_m1) {
+                if (widx > sample_ctl2_m1) {
+                  break;
+                }
+                inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+              }
+              uintptr_t genovec_word = pgvp->genovec[widx];
+              const uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+              uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+              const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+              const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+              uint32_t cur_shift = 1;
+              for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+                const uint32_t cur_geno = genovec_word & 3;
+                if (!(multiallelic_hw & cur_shift)) {
+                  write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
+                  if (cur_geno == 1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        memcpy(&(write_iter[-4]), "\t1|0", 4);
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  }
+                  if (prev_phased_halfword & cur_shift) {
+                    write_iter[-2] = '|';
+                  }
+                } else {
+                  AlleleCode ac0;
+                  AlleleCode ac1;
+                  if (cur_geno == 1) {
+                    ac0 = 0;
+                    ac1 = *patch_01_vals_iter++;
+                  } else {
+                    ac0 = *patch_10_vals_iter++;
+                    ac1 = *patch_10_vals_iter++;
+                  }
+                  if (ac0 != ac1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        const AlleleCode ac_swap = ac0;
+                        ac0 = ac1;
+                        ac1 = ac_swap;
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  }
+                  *write_iter++ = '\t';
+                  write_iter = u32toa(ac0, write_iter);
+                  if (prev_phased_halfword & cur_shift) {
+                    *write_iter++ = '|';
+                  } else {
+                    *write_iter++ = '/';
+                  }
+                  write_iter = u32toa(ac1, write_iter);
+                }
+                genovec_word >>= 2;
+                cur_shift = cur_shift * 2;
+              }
+              DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
+            }
+          }
+        } else {
+          // phased, at least partially haploid, !ds_force
+          // probable todo: merge this with biallelic code, do the same for
+          // other less-common biallelic-variable-width cases
+          uint32_t is_male_hw = 0;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (is_x) {
+              is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
+            }
+            const uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+            uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+            const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+            const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+            uint32_t cur_shift = 1;
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = is_male_hw & 1;
+              if (!(multiallelic_hw & cur_shift)) {
+                const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
+                memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+                write_iter = &(write_iter[cur_blen]);
+                if (cur_blen == 4) {
+                  if (cur_geno == 1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        memcpy(&(write_iter[-4]), "\t1|0", 4);
+                      } else {
+                        write_iter[-2] = '|';
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  } else if ((prev_phased_halfword >> sample_idx_lowbits) & 1) {
+                    write_iter[-2] = '|';
+                  }
+                }
+              } else {
+                AlleleCode ac0;
+                AlleleCode ac1;
+                if (cur_geno == 1) {
+                  ac0 = 0;
+                  ac1 = *patch_01_vals_iter++;
+                } else {
+                  ac0 = *patch_10_vals_iter++;
+                  ac1 = *patch_10_vals_iter++;
+                }
+                *write_iter++ = '\t';
+                if ((ac0 != ac1) || (haploid_genotext_blen[2 + cur_is_male * 4] == 4)) {
+                  if (ac0 != ac1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        const AlleleCode ac_swap = ac0;
+                        ac0 = ac1;
+                        ac1 = ac_swap;
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  }
+                  write_iter = u32toa(ac0, write_iter);
+                  if (prev_phased_halfword & cur_shift) {
+                    *write_iter++ = '|';
+                  } else {
+                    *write_iter++ = '/';
+                  }
+                }
+                write_iter = u32toa(ac1, write_iter);
+              }
+              genovec_word >>= 2;
+              is_male_hw >>= 1;
+              cur_shift = cur_shift * 2;
+            }
+            DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
+          }
+        }
+      } else {
+        // phased, ds_force
+        write_iter = strcpya_k(write_iter, ":DS");
+        if (hds_force) {
+          write_iter = strcpya_k(write_iter, ":HDS");
+        }
+        const uint32_t allele_ct_m2 = allele_ct - 2;
+        if (!is_haploid) {
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            const uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+            uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+            const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+            const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+            uint32_t cur_shift = 1;
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              if (!(multiallelic_hw & cur_shift)) {
+                write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
+                if (cur_geno == 1) {
+                  if (phasepresent_hw & cur_shift) {
+                    prev_phased_halfword |= cur_shift;
+                    if (phaseinfo_hw & cur_shift) {
+                      memcpy(&(write_iter[-4]), "\t1|0", 4);
+                    }
+                  } else {
+                    prev_phased_halfword &= ~cur_shift;
+                  }
+                }
+                if (prev_phased_halfword & cur_shift) {
+                  write_iter[-2] = '|';
+                }
+                // DS
+                write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                if (cur_geno != 3) {
+                  // repeat ",0" if nonmissing
+                  write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                  if (hds_force) {
+                    uint32_t hds_inttext_index = cur_geno;
+                    // bugfix (8 Mar 2020): hap_blen was set incorrectly in
+                    // phased case
+                    uint32_t hap_blen = 2;
+                    if (phasepresent_hw & cur_shift) {
+                      hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
+                    } else {
+                      hap_blen = hds_inttext_blen[hds_inttext_index] / 2;
+                    }
+                    uint64_t cur_inttext = hds_inttext[hds_inttext_index];
+                    memcpy(write_iter, &cur_inttext, 4);
+                    write_iter = &(write_iter[hap_blen]);
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                    cur_inttext = cur_inttext >> (8 * hap_blen);
+                    memcpy(write_iter, &cur_inttext, 4);
+                    write_iter = &(write_iter[hap_blen]);
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                  }
+                } else {
+                  if (hds_force) {
+                    write_iter = strcpya_k(write_iter, ":.,.");
+                  }
+                }
+              } else {
+                AlleleCode ac0;
+                AlleleCode ac1;
+                if (cur_geno == 1) {
+                  ac0 = 0;
+                  ac1 = *patch_01_vals_iter++;
+                } else {
+                  ac0 = *patch_10_vals_iter++;
+                  ac1 = *patch_10_vals_iter++;
+                }
+                if (ac0 != ac1) {
+                  if (phasepresent_hw & cur_shift) {
+                    prev_phased_halfword |= cur_shift;
+                    write_iter = AppendVcfMultiallelicDsForcePhased(allele_ct_m2, hds_force, ac0, ac1, phaseinfo_hw & cur_shift, write_iter);
+                  } else {
+                    prev_phased_halfword &= ~cur_shift;
+                    if (!ac0) {
+                      write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, 0, hds_force, ac1, 0, write_iter);
+                    } else {
+                      write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, 0, hds_force, ac0, ac1, 0, write_iter);
+                    }
+                  }
+                } else {
+                  write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, 0, hds_force, ac0, (prev_phased_halfword & cur_shift)? '|' : '/', write_iter);
+                }
+              }
+              genovec_word >>= 2;
+              cur_shift <<= 1;
+            }
+            DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
+          }
+        } else {
+          // dosage (or {H}DS-force) and phase present, partly/fully
+          // haploid
+          uint32_t is_male_hw = 0;
+          for (uint32_t widx = 0; ; ++widx) {
+            if (widx >= sample_ctl2_m1) {
+              if (widx > sample_ctl2_m1) {
+                break;
+              }
+              inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
+            }
+            uintptr_t genovec_word = pgvp->genovec[widx];
+            if (is_x) {
+              is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
+            }
+            const uint32_t multiallelic_hw = (DowncastKWToHW(pgvp->patch_01_set)[widx]) | (DowncastKWToHW(pgvp->patch_10_set)[widx]);
+            uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
+            const uint32_t phasepresent_hw = DowncastWToHW(pgvp->phasepresent)[widx];
+            const uint32_t phaseinfo_hw = DowncastWToHW(pgvp->phaseinfo)[widx];
+            uint32_t cur_shift = 1;
+            for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
+              const uint32_t cur_geno = genovec_word & 3;
+              const uint32_t cur_is_male = is_male_hw & 1;
+              const uint32_t should_be_diploid = is_x && (!cur_is_male);
+              // bugfix (29 Dec 2018): need to check correct bit here
+              if (!(multiallelic_hw & cur_shift)) {
+                const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
+                memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
+                write_iter = &(write_iter[cur_blen]);
+                if (cur_blen == 4) {
+                  // render current hardcall as diploid (chrX nonmale, or
+                  // het haploid)
+                  if (cur_geno == 1) {
+                    if (phasepresent_hw & cur_shift) {
+                      prev_phased_halfword |= cur_shift;
+                      if (phaseinfo_hw & cur_shift) {
+                        memcpy(&(write_iter[-4]), "\t1|0", 4);
+                      }
+                    } else {
+                      prev_phased_halfword &= ~cur_shift;
+                    }
+                  }
+                  if (prev_phased_halfword & cur_shift) {
+                    write_iter[-2] = '|';
+                  }
+                  // DS
+                  write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
+                  if (cur_geno != 3) {
+                    // repeat ",0"
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                    if (hds_force) {
+                      uint32_t hds_inttext_index = cur_geno;
+                      uint32_t hap_blen = 2;
+                      if (phasepresent_hw & cur_shift) {
+                        hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
+                      } else {
+                        hap_blen = hds_inttext_blen[hds_inttext_index] / 2;
+                      }
+                      uint64_t cur_inttext = hds_inttext[hds_inttext_index];
+                      memcpy(write_iter, &cur_inttext, 4);
+                      write_iter = &(write_iter[hap_blen]);
+                      write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                      // Don't render unphased het haploid as diploid here
+                      if (should_be_diploid || (phasepresent_hw & cur_shift)) {
+                        cur_inttext = cur_inttext >> (8 * hap_blen);
+                        memcpy(write_iter, &cur_inttext, 4);
+                        write_iter = &(write_iter[hap_blen]);
+                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                      }
+                    }
+                  } else {
+                    if (hds_force) {
+                      strcpy_k(write_iter, ":.,.");
+                      write_iter = &(write_iter[2 + 2 * should_be_diploid]);
+                    }
+                  }
+                } else {
+                  // render current hardcall as haploid
+                  // (can't get here for hardcall-phased)
+                  write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno + 4]), 2);
+                  if (cur_geno != 3) {
+                    // repeat ",0"
+                    write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                    if (hds_force) {
+                      // don't need to perform generic copy from
+                      // hds_inttext, since only possibilities are :0 and
+                      // :1
+                      CAppendU16(0x303a + 128 * cur_geno, &write_iter);
+                      write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
+                    }
+                  } else {
+                    if (hds_force) {
+                      write_iter = strcpya_k(write_iter, ":.");
+                    }
+                  }
+                }
+              } else {
+                AlleleCode ac0;
+                AlleleCode ac1;
+                if (cur_geno == 1) {
+                  ac0 = 0;
+                  ac1 = *patch_01_vals_iter++;
+                } else {
+                  ac0 = *patch_10_vals_iter++;
+                  ac1 = *patch_10_vals_iter++;
+                }
+                if (ac0 != ac1) {
+                  if (phasepresent_hw & cur_shift) {
+                    prev_phased_halfword |= cur_shift;
+                    write_iter = AppendVcfMultiallelicDsForcePhased(allele_ct_m2, hds_force, ac0, ac1, phaseinfo_hw & cur_shift, write_iter);
+                  } else {
+                    prev_phased_halfword &= ~cur_shift;
+                    if (!ac0) {
+                      write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, 0, hds_force, ac1, !should_be_diploid, write_iter);
+                    } else {
+                      write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, 0, hds_force, ac0, ac1, !should_be_diploid, write_iter);
+                    }
+                  }
+                } else {
+                  if (should_be_diploid) {
+                    write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, 0, hds_force, ac0, (prev_phased_halfword & cur_shift)? '|' : '/', write_iter);
+                  } else {
+                    write_iter = AppendVcfMultiallelicDsForce10Haploid(allele_ct_m2, 0, hds_force, ac0, write_iter);
+                  }
+                }
+              }
+              genovec_word >>= 2;
+              is_male_hw >>= 1;
+              cur_shift <<= 1;
+            }
+            DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
+          }
+        }
       }
     }
-    if (write_ds) {
-      write_iter = strcpya_k(write_iter, "##FORMAT=<ID=DS,Number=A,Type=Float,Description=\"Estimated Alternate Allele Dosage : [P(0/1)+2*P(1/1)]\">" EOLN_STR);
-      if (write_hds) {
-        // bugfix (3 May 2018): 'Number=2' was inaccurate for haploid calls.
+  }
+  *write_iter_ptr = write_iter;
+  return kPglRetSuccess;
+}
 
-        // Note that HDS ploidy intentionally does NOT match GT ploidy in the
-        // unphased het haploid case.
-        write_iter = strcpya_k(write_iter, "##FORMAT=<ID=HDS,Number=.,Type=Float,Description=\"Estimated Haploid Alternate Allele Dosage \">" EOLN_STR);
-      }
-    } else if (write_some_dosage) {
-      write_iter = strcpya_k(write_iter, "##FORMAT=<ID=GP,Number=G,Type=Float,Description=\"Estimated Posterior Probabilities for Genotypes 0/0, 0/1 and 1/1 \">" EOLN_STR);
+// Applies AppendVcfGenotext()'s prev_phased update for one variant without
+// rendering anything, and sets het_seen bits for the samples it touched.
+// Every branch of AppendVcfGenotext() follows the same rule: a heterozygous
+// call (including a multiallelic x/y call with x != y) sets the sample's
+// prev_phased bit to its phasepresent bit, and other calls leave it alone.
+PglErr UpdateVcfPhaseSummary(const ExportVcfCtx* ctx, PgrSampleSubsetIndex pssi, uint32_t variant_uidx, uint32_t allele_ct, PgenReader* pgrp, PgenVariant* pgvp, uintptr_t* prev_phased, uintptr_t* het_seen) {
+  const uint32_t sample_ct = ctx->sample_ct;
+  PglErr reterr;
+  pgvp->patch_10_ct = 0;
+  if (allele_ct == 2) {
+    reterr = PgrGetP(ctx->sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp->genovec, pgvp->phasepresent, pgvp->phaseinfo, &(pgvp->phasepresent_ct));
+  } else {
+    reterr = PgrGetMP(ctx->sample_include, pssi, sample_ct, variant_uidx, pgrp, pgvp);
+  }
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
+  if (!pgvp->phasepresent_ct) {
+    ZeroWArr(sample_ctl, pgvp->phasepresent);
+  }
+  ZeroTrailingNyps(sample_ct, pgvp->genovec);
+  const uintptr_t* genovec = pgvp->genovec;
+  const uintptr_t* phasepresent = pgvp->phasepresent;
+  for (uint32_t widx = 0; widx != sample_ctl; ++widx) {
+    const uintptr_t geno_lo = genovec[2 * widx];
+    const uintptr_t geno_hi = genovec[2 * widx + 1];
+    if (!(geno_lo || geno_hi)) {
+      continue;
     }
-    // possible todo: if there is ever a real standard for encoding pedigree
-    // information in the VCF header, do it here and make --vcf be able to read
-    // it
-    if (!ds_only) {
-      write_iter = strcpya_k(write_iter, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">" EOLN_STR);
+    const uintptr_t het_word = PackWordToHalfwordMask5555(geno_lo & (~(geno_lo >> 1))) | (S_CAST(uintptr_t, PackWordToHalfwordMask5555(geno_hi & (~(geno_hi >> 1)))) << kBitsPerWordD2);
+    prev_phased[widx] = (prev_phased[widx] & (~het_word)) | phasepresent[widx];
+    het_seen[widx] |= het_word;
+  }
+  if (pgvp->patch_10_ct) {
+    // x/y entries are stored with hardcall 2, so the loop above didn't touch
+    // them.
+    uintptr_t sample_idx_base = 0;
+    uintptr_t patch_10_bits = pgvp->patch_10_set[0];
+    for (uint32_t uii = 0; uii != pgvp->patch_10_ct; ++uii) {
+      const uintptr_t sample_idx = BitIter1(pgvp->patch_10_set, &sample_idx_base, &patch_10_bits);
+      if (pgvp->patch_10_vals[2 * uii] != pgvp->patch_10_vals[2 * uii + 1]) {
+        AssignBit(sample_idx, IsSet(phasepresent, sample_idx), prev_phased);
+        SetBit(sample_idx, het_seen);
+      }
     }
-    write_iter = strcpya_k(write_iter, "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT");
-    char* exported_sample_ids;
-    uintptr_t max_exported_sample_id_blen;
-    if (unlikely(ExportIdpaste(sample_include, siip, "vcf", "vcf", sample_ct, exportf_id_paste, exportf_id_delim, &max_exported_sample_id_blen, &exported_sample_ids))) {
-      goto ExportVcf_ret_NOMEM;
-    }
-    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
-      *write_iter++ = '\t';
-      write_iter = strcpya(write_iter, &(exported_sample_ids[sample_idx * max_exported_sample_id_blen]));
-      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
-        goto ExportVcf_ret_WRITE_FAIL;
-      }
-    }
-    AppendBinaryEoln(&write_iter);
-    BigstackReset(exported_sample_ids);
-
-    logprintfww5("--export vcf%s to %s ... ", (exportf_flags & kfExportfBgz)? " bgz" : "", outname);
-    fputs("0%", stdout);
-    fflush(stdout);
-
-    // includes trailing tab
-    char* chr_buf;
+  }
+  return kPglRetSuccess;
+}
 
-    const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
-    PgenVariant pgv;
-    if (unlikely(bigstack_alloc_c(max_chr_blen, &chr_buf) ||
-                 bigstack_alloc_w(sample_ctl * 2, &pgv.genovec))) {
-      goto ExportVcf_ret_NOMEM;
-    }
-    pgv.genovec[sample_ctl * 2 - 1] = 0;
-    pgv.patch_01_set = nullptr;
-    pgv.patch_01_vals = nullptr;
-    pgv.patch_10_set = nullptr;
-    pgv.patch_10_vals = nullptr;
-    if (allele_idx_offsets) {
-      if (unlikely(bigstack_alloc_w(sample_ctl, &(pgv.patch_01_set)) ||
-                   bigstack_alloc_ac(sample_ct, &(pgv.patch_01_vals)) ||
-                   bigstack_alloc_w(sample_ctl, &(pgv.patch_10_set)) ||
-                   bigstack_alloc_ac(sample_ct * 2, &(pgv.patch_10_vals)))) {
-        goto ExportVcf_ret_NOMEM;
-      }
-    }
-    // For now, if phased data is present, each homozygous call is represented
-    // as phased iff the previous heterozygous call was phased.  (If no
-    // previous heterozygous call exists, it's treated as phased.)  This does
-    // the right thing when the entire genome is phased, and it induces about
-    // as good a phase set approximation as you can get without explicitly
-    // saving that info.  But that approximation is still pretty inaccurate; as
-    // soon as we have any use for them, explicit phase set support should be
-    // added to pgenlib.
-    // Note that prev_phased is NOT reinitialized at the beginning of each
-    // chromosome.
-    const uint32_t load_dphase = write_hds && (pgfip->gflags & kfPgenGlobalDosagePhasePresent);
-    const uint32_t some_phased = (!ds_only) && ((pgfip->gflags & kfPgenGlobalHardcallPhasePresent) || load_dphase);
-    uintptr_t* prev_phased = nullptr;
-    pgv.phasepresent = nullptr;
-    pgv.phaseinfo = nullptr;
-    if (some_phased) {
-      if (unlikely(bigstack_alloc_w(sample_ctl, &prev_phased) ||
-                   bigstack_alloc_w(sample_ctl, &(pgv.phasepresent)) ||
-                   bigstack_alloc_w(sample_ctl, &(pgv.phaseinfo)))) {
-        goto ExportVcf_ret_NOMEM;
-      }
-      SetAllBits(sample_ct, prev_phased);
-    }
+THREAD_FUNC_DECL ExportVcfThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uintptr_t tidx = arg->tidx;
+  ExportVcfCtx* ctx = S_CAST(ExportVcfCtx*, arg->sharedp->context);
 
-    pgv.dosage_present = nullptr;
-    pgv.dosage_main = nullptr;
-    pgv.dphase_present = nullptr;
-    pgv.dphase_delta = nullptr;
-    if (write_some_dosage && (pgfip->gflags & kfPgenGlobalDosagePresent)) {
-      if (unlikely(bigstack_alloc_w(sample_ctl, &(pgv.dosage_present)) ||
-                   bigstack_alloc_dosage(sample_ct, &(pgv.dosage_main)))) {
-        goto ExportVcf_ret_NOMEM;
-      }
-      if (load_dphase) {
-        if (unlikely(bigstack_alloc_w(sample_ctl, &(pgv.dphase_present)) ||
-                     bigstack_alloc_dphase(sample_ct, &(pgv.dphase_delta)))) {
-          goto ExportVcf_ret_NOMEM;
+  PgenReader* pgrp = ctx->pgr_ptrs[tidx];
+  PgrSampleSubsetIndex pssi;
+  PgrSetSampleSubsetIndex(ctx->sample_include_cumulative_popcounts, pgrp, &pssi);
+  const uint32_t sample_ct = ctx->sample_ct;
+  PgenVariant pgv;
+  pgv.genovec = ctx->genovecs[tidx];
+  pgv.genovec[BitCtToWordCt(sample_ct) * 2 - 1] = 0;
+  pgv.patch_01_set = nullptr;
+  pgv.patch_01_vals = nullptr;
+  pgv.patch_10_set = nullptr;
+  pgv.patch_10_vals = nullptr;
+  if (ctx->thread_mhc) {
+    SetPgvMhc(sample_ct, ctx->thread_mhc[tidx], &pgv);
+  }
+  pgv.phasepresent = nullptr;
+  pgv.phaseinfo = nullptr;
+  if (ctx->phasepresents) {
+    pgv.phasepresent = ctx->phasepresents[tidx];
+    pgv.phaseinfo = ctx->phaseinfos[tidx];
+  }
+  pgv.dosage_present = ctx->dosage_presents? ctx->dosage_presents[tidx] : nullptr;
+  pgv.dosage_main = pgv.dosage_present? ctx->dosage_mains[tidx] : nullptr;
+  pgv.dphase_present = ctx->dphase_presents? ctx->dphase_presents[tidx] : nullptr;
+  pgv.dphase_delta = pgv.dphase_present? ctx->dphase_deltas[tidx] : nullptr;
+  uintptr_t* prev_phased = ctx->prev_phaseds? ctx->prev_phaseds[tidx] : nullptr;
+  const uintptr_t* variant_include = ctx->variant_include;
+  const ChrInfo* cip = ctx->cip;
+  const uintptr_t* allele_idx_offsets = ctx->allele_idx_offsets;
+  const AlleleCode* allele_permute = ctx->allele_permute;
+  const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
+  const uintptr_t genotext_slot_blen = ctx->genotext_slot_blen;
+  const uint32_t calc_thread_ct = GetThreadCt(arg->sharedp);
+  uint32_t chr_fo_idx = UINT32_MAX;  // deliberate overflow
+  uint32_t chr_end = 0;
+  uint32_t is_x = 0;
+  uint32_t is_haploid = 0;  // includes chrX and chrY
+  uint32_t ref_allele_idx = 0;
+  uint32_t alt1_allele_idx = 1;
+  uint32_t allele_ct = 2;
+  uint32_t parity = 0;
+  uint64_t new_err_info = 0;
+  do {
+    const uintptr_t cur_block_write_ct = ctx->cur_block_write_ct;
+    uint32_t write_idx = (tidx * cur_block_write_ct) / calc_thread_ct;
+    const uint32_t write_idx_end = ((tidx + 1) * cur_block_write_ct) / calc_thread_ct;
+    char* genotext_slot = &(ctx->genotext_bufs[parity][write_idx * genotext_slot_blen]);
+    uintptr_t* genotext_blen_iter = &(ctx->genotext_blens[parity][write_idx]);
+    uintptr_t variant_uidx_base;
+    uintptr_t variant_include_bits;
+    BitIter1Start(variant_include, ctx->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
+    if (ctx->phase_summary_pass) {
+      // The last thread's summary isn't needed.
+      if (tidx + 1 != calc_thread_ct) {
+        const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
+        uintptr_t* range_last_phased = ctx->prev_phaseds[tidx + 1];
+        uintptr_t* het_seen = ctx->het_seens[tidx + 1];
+        ZeroWArr(sample_ctl, range_last_phased);
+        ZeroWArr(sample_ctl, het_seen);
+        for (; write_idx != write_idx_end; ++write_idx) {
+          const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
+          if (allele_idx_offsets) {
+            allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
+          }
+          const PglErr reterr = UpdateVcfPhaseSummary(ctx, pssi, variant_uidx, allele_ct, pgrp, &pgv, range_last_phased, het_seen);
+          if (unlikely(reterr)) {
+            new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+            goto ExportVcfThread_err;
+          }
         }
       }
+      continue;
     }
-
-    char* pvar_reload_line_iter = nullptr;
-    uint32_t info_col_idx = 0;
-    if (pvar_info_reload) {
-      reterr = PvarInfoOpenAndReloadHeader(pvar_info_reload, 1 + (max_thread_ct > 1), &pvar_reload_txs, &pvar_reload_line_iter, &info_col_idx);
-      if (unlikely(reterr)) {
-        goto ExportVcf_ret_TSTREAM_FAIL;
-      }
-    }
-
-    // assumes little-endian
-    // maybe want to pass references to these arrays later, but leave as
-    // C-style for now
-    // \t0/0  \t0/1  \t1/1  \t./.
-    const uint32_t basic_genotext[4] = {0x302f3009, 0x312f3009, 0x312f3109, 0x2e2f2e09};
-
-    // 4-genotype-at-a-time lookup in basic case
-    uint32_t basic_genotext4[1024] ALIGNV16;
-    basic_genotext4[0] = basic_genotext[0];
-    basic_genotext4[4] = basic_genotext[1];
-    basic_genotext4[8] = basic_genotext[2];
-    basic_genotext4[12] = basic_genotext[3];
-    InitLookup256x4bx4(basic_genotext4);
-
-    // 2-genotype-at-a-time lookup in basic phased case
-    uint32_t phased_genotext2[492];
-    phased_genotext2[0] = basic_genotext[0];
-    phased_genotext2[2] = basic_genotext[1];
-    phased_genotext2[4] = basic_genotext[2];
-    phased_genotext2[6] = basic_genotext[3];
-    phased_genotext2[32] = 0x307c3009;
-    phased_genotext2[34] = 0x317c3009;
-    phased_genotext2[36] = 0x317c3109;
-    phased_genotext2[38] = 0x2e7c2e09;
-    phased_genotext2[162] = 0x307c3109;  // 1|0
-    InitVcfPhaseLookup4b(phased_genotext2);
-
-    uint32_t haploid_genotext_blen[8];
-    // lengths [0], [2], and [3] reset at beginning of chromosome
-    // chrX: nonmales are diploid and use indices 0..3, males are 4..7
-    // other: all haploid, indices 0..3
-    haploid_genotext_blen[1] = 4;
-    haploid_genotext_blen[4] = 2;
-    haploid_genotext_blen[5] = 4;
-    haploid_genotext_blen[6] = 2;
-    haploid_genotext_blen[7] = 2;
-    // don't bother exporting GP for hardcalls
-    // usually don't bother for DS, but DS-force is an exception
-
-    // 4..7 = haploid, 5 should never be looked up
-    // :0 :1 :2 :. :0 !! :1 :.
-    // ':' replaced with '\t' if ds_only
-    uint16_t ds_inttext[8] = {0x303a, 0x313a, 0x323a, 0x2e3a, 0x303a, 0x2121, 0x313a, 0x2e3a};
-    uint16_t ds_inttext4[1024];
-    if (ds_only) {
-      ds_inttext[0] = 0x3009;
-      ds_inttext[1] = 0x3109;
-      ds_inttext[2] = 0x3209;
-      ds_inttext[3] = 0x2e09;
-      ds_inttext[4] = 0x3009;
-      ds_inttext[6] = 0x3109;
-      ds_inttext[7] = 0x2e09;
-
-      ds_inttext4[0] = 0x3009;
-      ds_inttext4[4] = 0x3109;
-      ds_inttext4[8] = 0x3209;
-      ds_inttext4[12] = 0x2e09;
-      InitLookup256x2bx4(ds_inttext4);
-    }
-
-    // 0..3 = diploid unphased
-    // 4..5 = phased, phaseinfo=0 first
-    // update (1 Aug 2018): HDS ploidy should be more trustworthy than GT
-    // ploidy when there's a conflict, since GT must render unphased het
-    // haploids as 0/1.  So under HDS-force, diploid missing value is '.,.'
-    // instead of '.'.  (Since we're only interested in storing a trustworthy
-    // ploidy, we don't add more missing entries in the multiallelic case.)
-
-    // could make this include DS text in front
-    // could expand this to e.g. 10 cases and make [4], [5] less fiddly
-    // :0,0  :0.5,0.5  :1,1  :.,.  :0,1  :1,0
-    const uint64_t hds_inttext[6] = {0x302c303a, 0x352e302c352e303aLLU, 0x312c313a, 0x2e2c2e3a, 0x312c303a, 0x302c313a};
-
-    // [4]..[7] = haploid unphased; == 4 for phased
-    uint32_t hds_inttext_blen[8];
-
-    // lengths [0]-[3] reset at beginning of chromosome
-    hds_inttext_blen[4] = 2;
-    hds_inttext_blen[5] = 4;
-    hds_inttext_blen[6] = 2;
-    hds_inttext_blen[7] = 2;
-    const char* dot_ptr = &(g_one_char_strs[92]);
-    const uint32_t sample_ctl2_m1 = (sample_ct - 1) / kBitsPerWordD2;
-    PgrSampleSubsetIndex pssi;
-    PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, simple_pgrp, &pssi);
-    uintptr_t variant_uidx_base = 0;
-    uintptr_t cur_bits = variant_include[0];
-    uint32_t chr_fo_idx = UINT32_MAX;
-    uint32_t chr_end = 0;
-    uint32_t chr_buf_blen = 0;
-    uint32_t is_x = 0;
-    uint32_t is_haploid = 0;  // includes chrX and chrY
-    uint32_t pct = 0;
-    uint32_t next_print_variant_idx = variant_ct / 100;
-    uint32_t rls_variant_uidx = 0;
-    uint32_t ref_allele_idx = 0;
-    uint32_t alt1_allele_idx = 1;
-    uint32_t allele_ct = 2;
-    uint32_t invalid_allele_code_seen = 0;
-    for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
-      // a lot of this is redundant with write_pvar(), may want to factor the
-      // commonalities out
-      const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+    for (; write_idx != write_idx_end; ++write_idx) {
+      const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
       if (variant_uidx >= chr_end) {
         do {
           ++chr_fo_idx;
           chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
         } while (variant_uidx >= chr_end);
-        uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
-        is_x = (chr_idx == cip->xymt_codes[kChrOffsetX]);
+        const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+        is_x = (chr_idx == x_code);
         is_haploid = IsSet(cip->haploid_mask, chr_idx);
-        // forced --merge-par, with diploid male output (is_x NOT set, but
-        // chromosome code is X/chrX)
-        if ((chr_idx == cip->xymt_codes[kChrOffsetPAR1]) || (chr_idx == cip->xymt_codes[kChrOffsetPAR2])) {
-          chr_idx = cip->xymt_codes[kChrOffsetX];
-        }
-        char* chr_name_end = chrtoa(cip, chr_idx, chr_buf);
-        *chr_name_end = '\t';
-        chr_buf_blen = 1 + S_CAST(uintptr_t, chr_name_end - chr_buf);
-        // bugfix (3 May 2018): forgot to update hds_inttext_blen[]
-        hds_inttext_blen[0] = 4;
-        hds_inttext_blen[1] = 8;
-        hds_inttext_blen[2] = 4;
-        hds_inttext_blen[3] = 4;
-        if (is_haploid) {
-          if (is_x) {
-            haploid_genotext_blen[0] = 4;
-            haploid_genotext_blen[2] = 4;
-            haploid_genotext_blen[3] = 4;
-          } else {
-            haploid_genotext_blen[0] = 2;
-            haploid_genotext_blen[2] = 2;
-            haploid_genotext_blen[3] = 2;
-            hds_inttext_blen[0] = 2;
-            hds_inttext_blen[1] = 4;
-            hds_inttext_blen[2] = 2;
-            hds_inttext_blen[3] = 2;
-          }
-        }
       }
-      // #CHROM
-      write_iter = memcpya(write_iter, chr_buf, chr_buf_blen);
-
-      // POS
-      write_iter = u32toa_x(variant_bps[variant_uidx], '\t', write_iter);
-
-      // ID
-      write_iter = strcpyax(write_iter, variant_ids[variant_uidx], '\t');
-
-      // REF, ALT
       uintptr_t allele_idx_offset_base = variant_uidx * 2;
       if (allele_idx_offsets) {
         allele_idx_offset_base = allele_idx_offsets[variant_uidx];
         allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offset_base;
       }
-      const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
       if (allele_permute) {
         ref_allele_idx = allele_permute[allele_idx_offset_base];
         alt1_allele_idx = allele_permute[allele_idx_offset_base + 1];
       }
-      if (cur_alleles[ref_allele_idx] != dot_ptr) {
-        write_iter = strcpya(write_iter, cur_alleles[ref_allele_idx]);
-        if (!invalid_allele_code_seen) {
-          invalid_allele_code_seen = !ValidVcfAlleleCode(cur_alleles[ref_allele_idx]);
-        }
-      } else {
-        *write_iter++ = 'N';
-      }
-      *write_iter++ = '\t';
-      write_iter = strcpya(write_iter, cur_alleles[alt1_allele_idx]);
-      if (!invalid_allele_code_seen) {
-        invalid_allele_code_seen = !ValidVcfAlleleCode(cur_alleles[alt1_allele_idx]);
-      }
-      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
-        goto ExportVcf_ret_WRITE_FAIL;
-      }
-      if (allele_ct > 2) {
-        for (uint32_t cur_allele_uidx = 0; cur_allele_uidx != allele_ct; ++cur_allele_uidx) {
-          if ((cur_allele_uidx == ref_allele_idx) || (cur_allele_uidx == alt1_allele_idx)) {
-            // if this is noticeably suboptimal, have two loops, with inner
-            // loop going up to cur_allele_stop.
-            // (also wrap this in a function, this comes up a bunch of times)
-            continue;
-          }
-          *write_iter++ = ',';
-          write_iter = strcpya(write_iter, cur_alleles[cur_allele_uidx]);
-          if (!invalid_allele_code_seen) {
-            invalid_allele_code_seen = !ValidVcfAlleleCode(cur_alleles[cur_allele_uidx]);
-          }
-          if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
-            goto ExportVcf_ret_WRITE_FAIL;
-          }
-        }
+      char* write_iter = genotext_slot;
+      const PglErr reterr = AppendVcfGenotext(ctx, pssi, variant_uidx, allele_ct, ref_allele_idx, alt1_allele_idx, is_x, is_haploid, pgrp, &pgv, prev_phased, &write_iter);
+      if (unlikely(reterr)) {
+        new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+        goto ExportVcfThread_err;
       }
+      AppendBinaryEoln(&write_iter);
+      *genotext_blen_iter++ = write_iter - genotext_slot;
+      genotext_slot = &(genotext_slot[genotext_slot_blen]);
+    }
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  while (0) {
+  ExportVcfThread_err:
+    UpdateU64IfSmaller(new_err_info, &ctx->err_info);
+    THREAD_BLOCK_FINISH(arg);
+    break;
+  }
+  THREAD_RETURN;
+}
 
-      // QUAL
-      *write_iter++ = '\t';
-      if ((!pvar_qual_present) || (!IsSet(pvar_qual_present, variant_uidx))) {
-        *write_iter++ = '.';
+PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const SampleIdInfo* siip, const uintptr_t* sex_male_collapsed, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* allele_permute, const uintptr_t* pvar_qual_present, const float* pvar_quals, const uintptr_t* pvar_filter_present, const uintptr_t* pvar_filter_npass, const char* const* pvar_filter_storage, const char* pvar_info_reload, const uint32_t* contig_lens, uintptr_t xheader_blen, InfoFlags info_flags, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_slen, uint32_t max_filter_slen, uint32_t info_reload_slen, uint32_t max_thread_ct, ExportfFlags exportf_flags, VcfExportMode vcf_mode, IdpasteFlags exportf_id_paste, char exportf_id_delim, char* xheader, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  TextStream pvar_reload_txs;
+  BgzfCompressStream bgzf;
+  ThreadGroup tg;
+  PreinitTextStream(&pvar_reload_txs);
+  PreinitBgzfCompressStream(&bgzf);
+  PreinitThreads(&tg);
+  ExportVcfCtx ctx;
+  {
+    {
+      uint32_t clvl = 0;
+      if (!(exportf_flags & kfExportfBgz)) {
+        snprintf(outname_end, kMaxOutfnameExtBlen, ".vcf");
       } else {
-        write_iter = ftoa_g(pvar_quals[variant_uidx], write_iter);
+        snprintf(outname_end, kMaxOutfnameExtBlen, ".vcf.gz");
+        clvl = kBgzfDefaultClvl;
       }
-
-      // FILTER
-      *write_iter++ = '\t';
-      if ((!pvar_filter_present) || (!IsSet(pvar_filter_present, variant_uidx))) {
-        *write_iter++ = '.';
-      } else if (!IsSet(pvar_filter_npass, variant_uidx)) {
-        write_iter = strcpya_k(write_iter, "PASS");
-      } else {
-        write_iter = strcpya(write_iter, pvar_filter_storage[variant_uidx]);
+      reterr = InitBgzfCompressStreamEx(outname, 0, clvl, max_thread_ct, &bgzf);
+      if (unlikely(reterr)) {
+        if (reterr == kPglRetOpenFail) {
+          logerrprintfww(kErrprintfFopen, outname, strerror(errno));
+        }
+        goto ExportVcf_ret_1;
       }
-
-      // INFO
-      *write_iter++ = '\t';
-      const uint32_t is_pr = all_nonref || (nonref_flags && IsSet(nonref_flags, variant_uidx));
-      if (pvar_reload_line_iter) {
-        reterr = PvarInfoReloadAndWrite(info_pr_flag_present, info_col_idx, variant_uidx, is_pr, &pvar_reload_txs, &pvar_reload_line_iter, &write_iter, &rls_variant_uidx);
-        if (unlikely(reterr)) {
-          goto ExportVcf_ret_TSTREAM_FAIL;
+    }
+    const uint32_t max_chr_blen = GetMaxChrSlen(cip) + 1;
+    // CHROM, POS, ID, REF, one ALT, eoln
+    uintptr_t writebuf_blen = kMaxIdSlen + 32 + max_chr_blen + 2 * max_allele_slen;
+    // QUAL, FILTER, INFO, FORMAT, genotypes, eoln
+    // needs to be larger for >9 alt alleles
+    uint32_t write_some_dosage = 0;
+    uint32_t write_ds = 0;
+    uint32_t write_hds = 0;
+    uint32_t ds_force = 0;
+    uint32_t ds_only = 0;
+    uint32_t hds_force = 0;
+    if (vcf_mode != kVcfExport0) {
+      write_some_dosage = 1;
+      if (vcf_mode != kVcfExportGp) {
+        write_ds = 1;
+        if (vcf_mode == kVcfExportDsForce) {
+          ds_force = 1;
+        } else if (vcf_mode == kVcfExportDsOnly) {
+          // quasi-bugfix (16 Mar 2022): DS-only is now prohibited when partly-
+          // haploid or all-haploid variants are present, since without GT
+          // there to indicate ploidy, 0..1 vs. 0..2 scaling is not adequately
+          // defined.
+          if (unlikely((cip->haploid_mask[0] & 1) ||
+                       XymtIsNonempty(variant_include, cip, kChrOffsetX) ||
+                       XymtIsNonempty(variant_include, cip, kChrOffsetY) ||
+                       XymtIsNonempty(variant_include, cip, kChrOffsetMT))) {
+            logerrputs("Error: --export vcf-dosage=DS-only mode can only be used with all-diploid data.\n");
+            goto ExportVcf_ret_INCONSISTENT_INPUT;
+          }
+          ds_force = 1;
+          ds_only = 1;
+        } else if (vcf_mode != kVcfExportDs) {
+          write_hds = 1;
+          if (vcf_mode == kVcfExportHdsForce) {
+            ds_force = 1;
+            hds_force = 1;
+          }
         }
-      } else {
-        if (is_pr) {
-          write_iter = strcpya_k(write_iter, "PR");
+      }
+    }
+    if ((!ds_force) && write_some_dosage && (!(pgfip->gflags & kfPgenGlobalDosagePresent))) {
+      write_some_dosage = 0;
+      logerrprintf("Warning: No dosage data present.  %s will not be exported.\n", write_hds? "DS and HDS fields" : (write_ds? "DS field" : "GP field"));
+      write_ds = 0;
+      write_hds = 0;
+    }
+    // max_allele_ct == 2:
+    //   GT: 4 bytes (unless ds_only)
+    //   GP: 3 limited-precision numbers, up to (7 chars + delim) * 3
+    //   DS + HDS: also 3 limited precision numbers
+    //   DS only: 1 limited-precision number
+    // max_allele_ct > 2:
+    //   GT: 2 + 2 * UintSlen(max_allele_ct + 1) (unless ds_only)
+    //   GP: if requested, check max_gp_allele_ct among multiallelic-dosage
+    //         variants.
+    //       if none found (always true for now), 24 chars.
+    //       if present, (max_gp_allele_ct * (max_gp_allele_ct + 1) / 2) * 8,
+    //         which sucks ass
+    //   DS + HDS: 3 * (max_allele_ct - 1) limited-precision numbers
+    //   DS only: (max_allele_ct - 1) limited-precision numbers
+    uintptr_t output_bytes_per_sample;
+    if (!allele_idx_offsets) {
+      if (write_some_dosage) {
+        if (ds_only) {
+          output_bytes_per_sample = 8;
         } else {
-          *write_iter++ = '.';
+          output_bytes_per_sample = (write_ds && (!write_hds))? 12 : 28;
         }
+      } else {
+        output_bytes_per_sample = 4;
       }
-
-      // FORMAT
-      if (!ds_only) {
-        write_iter = strcpya_k(write_iter, "\tGT");
-      }
-
-      // could defensively zero out more counts
-      pgv.dosage_ct = 0;
-      pgv.dphase_ct = 0;
-      uint32_t inner_loop_last = kBitsPerWordD2 - 1;
-      if (allele_ct == 2) {
-        if (!some_phased) {
-          // biallelic, nothing phased in entire file
-          // (technically possible for dosage-phase to be present, if no
-          // hardcalls are phased and HDS output not requested)
-          if (!write_some_dosage) {
-            reterr = PgrGet(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, pgv.genovec);
-          } else {
-            reterr = PgrGetD(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
-          }
-          if (unlikely(reterr)) {
-            PgenErrPrintNV(reterr, variant_uidx);
-            goto ExportVcf_ret_1;
-          }
-          if (!alt1_allele_idx) {
-            // assumes biallelic
-            GenovecInvertUnsafe(sample_ct, pgv.genovec);
-            if (pgv.dosage_ct) {
-              BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
-            }
-          }
-          if ((!pgv.dosage_ct) && (!ds_force)) {
-            if (!is_haploid) {
-              // always 4 bytes wide, exploit that
-              GenoarrLookup256x4bx4(pgv.genovec, basic_genotext4, sample_ct, write_iter);
-              write_iter = &(write_iter[sample_ct * 4]);
+    } else {
+      const uint32_t max_allele_ct = PgrGetMaxAlleleCt(simple_pgrp);
+      if (ds_only) {
+        output_bytes_per_sample = 8 * (max_allele_ct - 1);
+      } else {
+        output_bytes_per_sample = 2 + 2 * UintSlen(max_allele_ct + 1);
+        if (write_some_dosage) {
+          if (write_ds) {
+            if (write_hds) {
+              output_bytes_per_sample += 24 * (max_allele_ct - 1);
             } else {
-              // chrX: male homozygous/missing calls use only one character +
-              //       tab
-              // other haploid/MT: this is true for nonmales too
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                uint32_t sex_male_hw = is_x * (DowncastKWToHW(sex_male_collapsed)[widx]);
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = sex_male_hw & 1;
-                  memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                  write_iter = &(write_iter[haploid_genotext_blen[cur_geno + cur_is_male * 4]]);
-                  genovec_word >>= 2;
-                  sex_male_hw >>= 1;
-                }
-              }
+              output_bytes_per_sample += 8 * (max_allele_ct - 1);
             }
-          } else if ((!pgv.dosage_ct) && ds_only && (!is_haploid)) {
-            write_iter = strcpya_k(write_iter, "\tDS");
-            // always 2 bytes wide, exploit that
-            GenoarrLookup256x2bx4(pgv.genovec, ds_inttext4, sample_ct, write_iter);
-            write_iter = &(write_iter[sample_ct * 2]);
           } else {
-            // some dosages present, or {H}DS-force; unphased
-            if (write_ds) {
-              if (ds_only) {
-                write_iter = strcpya_k(write_iter, "\tDS");
-              } else {
-                write_iter = strcpya_k(write_iter, ":DS");
-                if (hds_force) {
-                  write_iter = strcpya_k(write_iter, ":HDS");
-                }
-              }
-            } else {
-              write_iter = strcpya_k(write_iter, ":GP");
-            }
-            Dosage* dosage_main_iter = pgv.dosage_main;
-            uint32_t dosage_present_hw = 0;
-            if (!is_haploid) {
-              // autosomal diploid, unphased
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (pgv.dosage_ct) {
-                  dosage_present_hw = DowncastWToHW(pgv.dosage_present)[widx];
-                }
-                if (ds_only) {
-                  for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                    const uint32_t cur_geno = genovec_word & 3;
-                    if (dosage_present_hw & 1) {
-                      *write_iter++ = '\t';
-                      const uint32_t dosage_int = *dosage_main_iter++;
-                      write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
-                    } else {
-                      write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                    }
-                    genovec_word >>= 2;
-                    dosage_present_hw >>= 1;
-                  }
-                } else {
-                  for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                    const uint32_t cur_geno = genovec_word & 3;
-                    write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
-                    if (dosage_present_hw & 1) {
-                      *write_iter++ = ':';
-                      const uint32_t dosage_int = *dosage_main_iter++;
-                      write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
-                      if (hds_force) {
-                        *write_iter++ = ':';
-                        char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
-                        write_iter2[0] = ',';
-                        write_iter = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
-                      }
-                    } else if (ds_force) {
-                      write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                      if (hds_force) {
-                        memcpy(write_iter, &(hds_inttext[cur_geno]), 8);
-                        write_iter = &(write_iter[hds_inttext_blen[cur_geno]]);
-                      }
-                    }
-                    genovec_word >>= 2;
-                    dosage_present_hw >>= 1;
-                  }
-                }
-              }
-            } else {
-              // at least partly haploid, unphased
-              const char ds_prechar = ds_only? '\t' : ':';
-              uint32_t sex_male_hw = 0;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (is_x) {
-                  sex_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
-                }
-                if (pgv.dosage_ct) {
-                  dosage_present_hw = DowncastWToHW(pgv.dosage_present)[widx];
-                }
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = sex_male_hw & 1;
-                  const uint32_t cur_genotext_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
-                  memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                  write_iter = &(write_iter[cur_genotext_blen]);
-                  if (dosage_present_hw & 1) {
-                    *write_iter++ = ds_prechar;
-                    uint32_t dosage_int = *dosage_main_iter++;
-                    if (cur_genotext_blen == 2) {
-                      // render current hardcall as haploid
-                      if (write_ds) {
-                        char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
-                        if (hds_force) {
-                          write_iter2[0] = ':';
-                          write_iter2 = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
-                        }
-                        write_iter = write_iter2;
-                      } else {
-                        // GP
-                        write_iter = PrintHaploidNonintDosage(kDosageMax - dosage_int, write_iter);
-                        *write_iter++ = ',';
-                        write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
-                      }
-                    } else {
-                      // render current hardcall as diploid (female X, or het
-                      // haploid)
-                      write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
-                      if (hds_force) {
-                        *write_iter++ = ':';
-                        char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
-                        if (is_x && (!cur_is_male)) {
-                          // but do not render phased-dosage as diploid in het
-                          // haploid case
-                          write_iter2[0] = ',';
-                          write_iter2 = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
-                        }
-                        write_iter = write_iter2;
-                      }
-                    }
-                  } else if (ds_force) {
-                    write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno + 8 - 2 * cur_genotext_blen]), 2);
-                    if (hds_force) {
-                      memcpy(write_iter, &(hds_inttext[cur_geno]), 8);
-                      write_iter = &(write_iter[hds_inttext_blen[cur_is_male * 4 + cur_geno]]);
-                    }
-                  }
-                  genovec_word >>= 2;
-                  sex_male_hw >>= 1;
-                  dosage_present_hw >>= 1;
-                }
-              }
-            }
+            // GP should only be written for biallelic variants, for now
+            // would need to take max of this and GT length, but this is always
+            // larger
+            output_bytes_per_sample = 28;
           }
-        } else {
-          // biallelic, phased
-          if (!write_some_dosage) {
-            reterr = PgrGetP(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, pgv.genovec, pgv.phasepresent, pgv.phaseinfo, &(pgv.phasepresent_ct));
-          } else {
-            reterr = PgrGetDp(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, &pgv);
+        }
+      }
+    }
+    const uintptr_t writebuf_blen_lbound = sample_ct * output_bytes_per_sample + 32 + max_filter_slen + info_reload_slen;
+    if (writebuf_blen < writebuf_blen_lbound) {
+      writebuf_blen = writebuf_blen_lbound;
+    }
+    writebuf_blen += kMaxMediumLine;
+    char* writebuf;
+    if (unlikely(bigstack_alloc_c(writebuf_blen, &writebuf))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    char* writebuf_flush = &(writebuf[kMaxMediumLine]);
+    char* write_iter = writebuf;
+    const uint32_t v43 = (exportf_flags / kfExportfVcf43) & 1;
+    AppendVcfHeaderStart(v43, &write_iter);
+    if (cip->chrset_source) {
+      AppendChrsetLine(cip, &write_iter);
+    }
+    if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf))) {
+      goto ExportVcf_ret_WRITE_FAIL;
+    }
+    const uint32_t chr_ctl = BitCtToWordCt(cip->chr_ct);
+    uintptr_t* written_contig_header_lines;
+    if (unlikely(bigstack_calloc_w(chr_ctl, &written_contig_header_lines))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    // bugfix (30 Aug 2018): remove extraneous PAR1/PAR2 ##contig header lines,
+    // count them as part of chrX
+    const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
+    const uint32_t par1_code = cip->xymt_codes[kChrOffsetPAR1];
+    const uint32_t par2_code = cip->xymt_codes[kChrOffsetPAR2];
+    uint32_t contig_zero_written = 0;
+    uint32_t x_contig_line_written = 0;
+    if (xheader) {
+      memcpyo_k(writebuf, "##contig=<ID=", 13);
+      char* xheader_end = &(xheader[xheader_blen]);
+      for (char* line_end = xheader; line_end != xheader_end; ) {
+        char* xheader_iter = line_end;
+        line_end = AdvPastDelim(xheader_iter, '\n');
+        if (StrStartsWithUnsafe(xheader_iter, "##contig=<")) {
+          xheader_iter = &(xheader_iter[strlen("##contig=<")]);
+          char* idval;
+          uint32_t id_slen;
+          if (unlikely(HkvlineId(&xheader_iter, &idval, &id_slen))) {
+            logerrputs("Error: Malformed ##contig line in .pvar file.\n");
+            goto ExportVcf_ret_MALFORMED_INPUT;
           }
-          if (unlikely(reterr)) {
-            PgenErrPrintNV(reterr, variant_uidx);
-            goto ExportVcf_ret_1;
+          if (xheader_iter[-1] == '>') {
+            // regenerate instead of keeping
+            continue;
           }
-          if (!alt1_allele_idx) {
-            // assumes biallelic
-            GenovecInvertUnsafe(sample_ct, pgv.genovec);
-            if (pgv.phasepresent_ct) {
-              BitvecInvert(sample_ctl, pgv.phaseinfo);
-            }
-            if (pgv.dosage_ct) {
-              BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
-              if (pgv.dphase_ct) {
-                BiallelicDphase16Invert(pgv.dphase_ct, pgv.dphase_delta);
-              }
-            }
+          // if GetChrCodeCounted() is modified to not mutate idval[], xheader
+          // can be changed to const char*
+          const uint32_t chr_idx = GetChrCodeCounted(cip, id_slen, idval);
+          // bugfix (8 Sep 2018): must exclude ##contig lines not present in
+          // input, otherwise chr_fo_idx == 0xffffffffU, etc.
+          if (IsI32Neg(chr_idx) || (!IsSet(cip->chr_mask, chr_idx)) || (chr_idx == par1_code) || (chr_idx == par2_code)) {
+            continue;
           }
-          // little point in trying to optimize this case, thanks to
-          // prev_phased.  Instead, we might want to have a fast path for the
-          // all-phased case.
-          if (!pgv.phasepresent_ct) {
-            ZeroWArr(sample_ctl, pgv.phasepresent);
+          if (chr_idx == x_code) {
+            x_contig_line_written = 1;
           }
-          if ((!pgv.dosage_ct) && (!ds_force)) {
-            if (!is_haploid) {
-              ZeroTrailingNyps(sample_ct, pgv.genovec);
-              UpdateVcfPrevPhased(pgv.genovec, pgv.phasepresent, sample_ct, prev_phased);
-              BitvecAnd(pgv.phasepresent, sample_ctl, pgv.phaseinfo);
-              VcfPhaseLookup4b(pgv.genovec, prev_phased, pgv.phaseinfo, phased_genotext2, sample_ct, write_iter);
-              write_iter = &(write_iter[sample_ct * 4]);
-            } else {
-              uint32_t is_male_hw = 0;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (is_x) {
-                  is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
-                }
-                uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-
-                const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = is_male_hw & 1;
-                  const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
-                  memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                  write_iter = &(write_iter[cur_blen]);
-                  if (cur_blen == 4) {
-                    if (cur_geno == 1) {
-                      // a bit redundant with how is_male_hw is handled, but
-                      // updating this on every loop iteration doesn't seem
-                      // better
-                      const uint32_t cur_shift = (1U << sample_idx_lowbits);
-                      if (phasepresent_hw & cur_shift) {
-                        prev_phased_halfword |= cur_shift;
-                        if (phaseinfo_hw & cur_shift) {
-                          memcpy(&(write_iter[-4]), "\t1|0", 4);
-                        } else {
-                          write_iter[-2] = '|';
-                        }
-                      } else {
-                        prev_phased_halfword &= ~cur_shift;
-                      }
-                    } else if ((prev_phased_halfword >> sample_idx_lowbits) & 1) {
-                      write_iter[-2] = '|';
-                    }
-                  }
-                  genovec_word >>= 2;
-                  is_male_hw >>= 1;
-                }
-                DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-              }
+          const uint32_t chr_fo_idx = cip->chr_idx_to_foidx[chr_idx];
+          if (unlikely(IsSet(written_contig_header_lines, chr_fo_idx))) {
+            logerrputs("Error: Duplicate ##contig line in .pvar file.\n");
+            goto ExportVcf_ret_MALFORMED_INPUT;
+          }
+          SetBit(chr_fo_idx, written_contig_header_lines);
+          // if --output-chr was used at some point, we need to sync the
+          // ##contig chromosome code with the code in the VCF body.
+          char* contig_write_start = &(writebuf[13]);
+          write_iter = chrtoa(cip, chr_idx, contig_write_start);
+          if ((*contig_write_start == '0') && (write_iter == &(contig_write_start[1]))) {
+            // --allow-extra-chr 0 special case
+            contig_zero_written = 1;  // technically we write this a bit later
+            continue;
+          }
+          if (unlikely(!ValidVcfContigName(contig_write_start, write_iter, v43))) {
+            goto ExportVcf_ret_MALFORMED_INPUT;
+          }
+          if (contig_lens && contig_lens[chr_idx]) {
+            *write_iter++ = ',';
+            if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf))) {
+              goto ExportVcf_ret_WRITE_FAIL;
             }
-          } else {
-            // both dosage (or {H}DS-force) and phase present
-            if (write_ds) {
-              write_iter = strcpya_k(write_iter, ":DS");
-              if (hds_force || pgv.dphase_ct ||
-                  (write_hds && pgv.phasepresent_ct && pgv.dosage_ct && (!IntersectionIsEmpty(pgv.phasepresent, pgv.dosage_present, sample_ctl)))) {
-                write_iter = strcpya_k(write_iter, ":HDS");
-                // dphase_present can be nullptr, so we zero-initialize
-                // dphase_present_hw and never refresh it when dphase_ct == 0.
-              }
-            } else {
-              write_iter = strcpya_k(write_iter, ":GP");
+            reterr = BgzfFixAndWriteContigHeaderLine(xheader_iter, idval, line_end, id_slen, contig_lens[chr_idx], &bgzf);
+            if (unlikely(reterr)) {
+              goto ExportVcf_ret_1;
             }
-            Dosage* dosage_main_iter = pgv.dosage_main;
-            SDosage* dphase_delta_iter = pgv.dphase_delta;
-            uint32_t dosage_present_hw = 0;
-            uint32_t dphase_present_hw = 0;
-            if (!is_haploid) {
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                if (pgv.dosage_ct) {
-                  dosage_present_hw = DowncastWToHW(pgv.dosage_present)[widx];
-                  if (pgv.dphase_ct) {
-                    dphase_present_hw = DowncastWToHW(pgv.dphase_present)[widx];
-                  }
-                }
-                uint32_t cur_shift = 1;
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
-                  if (cur_geno == 1) {
-                    if (phasepresent_hw & cur_shift) {
-                      prev_phased_halfword |= cur_shift;
-                      if (phaseinfo_hw & cur_shift) {
-                        memcpy(&(write_iter[-4]), "\t1|0", 4);
-                      }
-                    } else {
-                      prev_phased_halfword &= ~cur_shift;
-                    }
-                  }
-                  if (prev_phased_halfword & cur_shift) {
-                    write_iter[-2] = '|';
-                  }
-                  if (dosage_present_hw & cur_shift) {
-                    *write_iter++ = ':';
-                    const uint32_t dosage_int = *dosage_main_iter++;
-                    write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
-                    // bugfix (29 May 2018): don't print HDS field if not
-                    // requested
-                    if (write_hds) {
-                      if ((phasepresent_hw | dphase_present_hw) & cur_shift) {
-                        int32_t cur_dphase_delta;
-                        if (dphase_present_hw & cur_shift) {
-                          cur_dphase_delta = *dphase_delta_iter++;
-                        } else {
-                          cur_dphase_delta = DosageHomdist(dosage_int);
-                          if (!(phaseinfo_hw & cur_shift)) {
-                            cur_dphase_delta = -cur_dphase_delta;
-                          }
-                        }
-                        *write_iter++ = ':';
-                        write_iter = PrintHdsPair(dosage_int, cur_dphase_delta, write_iter);
-                      } else if (hds_force) {
-                        *write_iter++ = ':';
-                        char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
-                        write_iter2[0] = ',';
-                        write_iter = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
-                      }
-                    }
-                  } else if (ds_force) {
-                    write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                    if (hds_force) {
-                      uint32_t hds_inttext_index = cur_geno;
-                      uint32_t tmp_blen = hds_inttext_blen[cur_geno];
-                      if (phasepresent_hw & cur_shift) {
-                        // do we want to remove this branch?  doubt it's
-                        // worthwhile since variable-length memcpy will branch
-                        // anyway...
-                        hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
-                        tmp_blen = 4;
-                      }
-                      memcpy(write_iter, &(hds_inttext[hds_inttext_index]), 8);
-                      write_iter = &(write_iter[tmp_blen]);
-                    }
-                  }
-                  genovec_word >>= 2;
-                  cur_shift <<= 1;
-                }
-                DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-              }
-            } else {
-              // dosage (or {H}DS-force) and phase present, partly/fully
-              // haploid
-              uint32_t is_male_hw = 0;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (is_x) {
-                  is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
-                }
-                uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                if (pgv.dosage_ct) {
-                  dosage_present_hw = DowncastWToHW(pgv.dosage_present)[widx];
-                  if (pgv.dphase_ct) {
-                    dphase_present_hw = DowncastWToHW(pgv.dphase_present)[widx];
-                  }
-                }
-                uint32_t cur_shift = 1;
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = is_male_hw & 1;
-                  const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
-                  memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                  write_iter = &(write_iter[cur_blen]);
-                  if (cur_blen == 4) {
-                    // render current hardcall as diploid (chrX nonmale, or het
-                    // haploid)
-                    if (cur_geno == 1) {
-                      if (phasepresent_hw & cur_shift) {
-                        prev_phased_halfword |= cur_shift;
-                        if (phaseinfo_hw & cur_shift) {
-                          memcpy(&(write_iter[-4]), "\t1|0", 4);
-                        }
-                      } else {
-                        prev_phased_halfword &= ~cur_shift;
-                      }
-                    }
-                    if (prev_phased_halfword & cur_shift) {
-                      write_iter[-2] = '|';
-                    }
-                    if (dosage_present_hw & cur_shift) {
-                      *write_iter++ = ':';
-                      const uint32_t dosage_int = *dosage_main_iter++;
-                      write_iter = PrintDiploidVcfDosage(dosage_int, write_ds, write_iter);
-                      if (write_hds) {
-                        if ((phasepresent_hw | dphase_present_hw) & cur_shift) {
-                          int32_t cur_dphase_delta;
-                          if (dphase_present_hw & cur_shift) {
-                            cur_dphase_delta = *dphase_delta_iter++;
-                          } else {
-                            cur_dphase_delta = DosageHomdist(dosage_int);
-                            if (!(phaseinfo_hw & cur_shift)) {
-                              cur_dphase_delta = -cur_dphase_delta;
-                            }
-                          }
-                          *write_iter++ = ':';
-                          write_iter = PrintHdsPair(dosage_int, cur_dphase_delta, write_iter);
-                        } else if (hds_force) {
-                          *write_iter++ = ':';
-                          char* write_iter2 = PrintHaploidNonintDosage(dosage_int, write_iter);
-                          // do not render phased-dosage as diploid in unphased
-                          // het haploid case
-                          if (is_x && (!cur_is_male)) {
-                            write_iter2[0] = ',';
-                            write_iter2 = memcpya(&(write_iter2[1]), write_iter, write_iter2 - write_iter);
-                          }
-                          write_iter = write_iter2;
-                        }
-                      }
-                    } else if (ds_force) {
-                      write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                      if (hds_force) {
-                        uint32_t hds_inttext_index = cur_geno;
-                        uint32_t tmp_blen;
-                        if (phasepresent_hw & cur_shift) {
-                          // do we want to remove this branch?  doubt it's
-                          // worthwhile since variable-length memcpy will
-                          // branch anyway...
-                          hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
-                          tmp_blen = 4;
-                        } else {
-                          // do not render phased-dosage as diploid in het
-                          // haploid case
-                          tmp_blen = hds_inttext_blen[cur_is_male * 4 + cur_geno];
-                        }
-                        memcpy(write_iter, &(hds_inttext[hds_inttext_index]), 8);
-                        write_iter = &(write_iter[tmp_blen]);
-                      }
-                    }
-                  } else {
-                    // render current hardcall as haploid
-                    // (can't get here for hardcall-phased)
-                    if (dosage_present_hw & cur_shift) {
-                      *write_iter++ = ':';
-                      const uint32_t dosage_int = *dosage_main_iter++;
-                      if (write_ds) {
-                        write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
-                        if (dphase_present_hw & cur_shift) {
-                          // explicit dosage-phase, so render HDS as diploid
-                          const int32_t cur_dphase_delta = *dphase_delta_iter++;
-                          *write_iter++ = ':';
-                          write_iter = PrintHdsPair(dosage_int, cur_dphase_delta, write_iter);
-                        } else if (hds_force) {
-                          *write_iter++ = ':';
-                          write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
-                        }
-                      } else {
-                        // GP
-                        write_iter = PrintHaploidNonintDosage(kDosageMax - dosage_int, write_iter);
-                        *write_iter++ = ',';
-                        write_iter = PrintHaploidNonintDosage(dosage_int, write_iter);
-                      }
-                    } else if (ds_force) {
-                      write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno + 4]), 2);
-                      if (hds_force) {
-                        memcpy(write_iter, &(hds_inttext[cur_geno]), 8);
-                        write_iter = &(write_iter[hds_inttext_blen[cur_geno + 4]]);
-                      }
-                    }
-                  }
-                  genovec_word >>= 2;
-                  is_male_hw >>= 1;
-                  cur_shift <<= 1;
-                }
-                DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-              }
+          } else {
+            if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf) ||
+                         BgzfWriteRestOfHeaderLine(xheader_iter, idval, line_end, id_slen, &bgzf))) {
+              goto ExportVcf_ret_WRITE_FAIL;
             }
           }
+        } else if (xheader_iter[1] == '#') {
+          // quasi-bugfix (23 Jan 2021): don't export pre-#CHROM header lines
+          // starting with a single '#'
+          const uint32_t slen = line_end - xheader_iter;
+          if (unlikely(!ValidVcfMetaLine(xheader_iter, slen, v43))) {
+            goto ExportVcf_ret_INCONSISTENT_INPUT;
+          }
+          if (unlikely(BgzfWrite(xheader_iter, slen, &bgzf))) {
+            goto ExportVcf_ret_WRITE_FAIL;
+          }
         }
+      }
+    }
+    write_iter = writebuf;
+    // fill in the missing ##contig lines
+    if (contig_zero_written) {
+      write_iter = strcpya_k(write_iter, "##contig=<ID=0,length=2147483645>" EOLN_STR);
+    }
+    uint32_t chrx_exists = 0;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != cip->chr_ct; ++chr_fo_idx) {
+      if (IsSet(written_contig_header_lines, chr_fo_idx)) {
+        continue;
+      }
+      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+      if ((!IsSet(cip->chr_mask, chr_idx)) || AllBitsAreZero(variant_include, cip->chr_fo_vidx_start[chr_fo_idx], cip->chr_fo_vidx_start[chr_fo_idx + 1])) {
+        continue;
+      }
+      if ((chr_idx == x_code) || (chr_idx == par1_code) || (chr_idx == par2_code)) {
+        chrx_exists = 1;
+        continue;
+      }
+      char* chr_name_write_start = strcpya_k(write_iter, "##contig=<ID=");
+      char* chr_name_write_end = chrtoa(cip, chr_idx, chr_name_write_start);
+      if ((*chr_name_write_start == '0') && (chr_name_write_end == &(chr_name_write_start[1]))) {
+        // --allow-extra-chr 0 special case
+        if (contig_zero_written) {
+          continue;
+        }
+        contig_zero_written = 1;
+        write_iter = strcpya_k(chr_name_write_end, ",length=2147483645");
       } else {
-        // multiallelic cases
-        // multiallelic dosage not supported yet
-        // don't bother supporting multiallelic GP export when dosages present:
-        // no clean way to handle e.g. dosage(A) = dosage(C) = dosage(G) =
-        // dosage(T)=0.5
-        if (ref_allele_idx || (alt1_allele_idx != 1)) {
-          // todo: rotation function that can also be used by --make-pgen
-          // maybe add a PgrGetM2() function too
-          logputs("\n");
-          logerrputs("Error: VCF-export multiallelic rotation is under development.\n");
-          reterr = kPglRetNotYetSupported;
-          goto ExportVcf_ret_1;
+        if (unlikely(!ValidVcfContigName(chr_name_write_start, chr_name_write_end, v43))) {
+          goto ExportVcf_ret_MALFORMED_INPUT;
         }
-        if (!some_phased) {
-          reterr = PgrGetM(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, &pgv);
-          if (unlikely(reterr)) {
-            PgenErrPrintNV(reterr, variant_uidx);
-            goto ExportVcf_ret_1;
+        write_iter = chr_name_write_end;
+        if (contig_lens && contig_lens[chr_idx]) {
+          write_iter = strcpya_k(write_iter, ",length=");
+          write_iter = u32toa(contig_lens[chr_idx], write_iter);
+        }
+      }
+      *write_iter++ = '>';
+      AppendBinaryEoln(&write_iter);
+      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
+        goto ExportVcf_ret_WRITE_FAIL;
+      }
+    }
+    if (chrx_exists && (!x_contig_line_written)) {
+      char* chr_name_write_start = strcpya_k(write_iter, "##contig=<ID=");
+      char* chr_name_write_end = chrtoa(cip, x_code, chr_name_write_start);
+      write_iter = strcpya_k(chr_name_write_end, ">" EOLN_STR);
+      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
+        goto ExportVcf_ret_WRITE_FAIL;
+      }
+    }
+    BigstackReset(written_contig_header_lines);
+    const uintptr_t* nonref_flags = pgfip->nonref_flags;
+    const uint32_t all_nonref = (pgfip->gflags & kfPgenGlobalAllNonref) && (!nonref_flags);
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    uint32_t write_pr = all_nonref;
+    if (nonref_flags) {
+      write_pr = !IntersectionIsEmpty(variant_include, nonref_flags, raw_variant_ctl);
+    }
+    const uint32_t info_pr_flag_present = (info_flags / kfInfoPrFlagPresent) & 1;
+    if (write_pr) {
+      if (unlikely(info_flags & kfInfoPrNonflagPresent)) {
+        logerrputs("Error: Conflicting INFO/PR definitions.  Either fix all REF alleles so that the\n'provisional reference' flag is no longer needed, or remove/rename the other\nuse of the INFO/PR key.\n");
+        goto ExportVcf_ret_INCONSISTENT_INPUT;
+      }
+      if (!info_pr_flag_present) {
+        write_iter = strcpya_k(write_iter, "##INFO=<ID=PR,Number=0,Type=Flag,Description=\"Provisional reference allele, may not be based on real reference genome\">" EOLN_STR);
+      }
+    }
+    if (write_ds) {
+      write_iter = strcpya_k(write_iter, "##FORMAT=<ID=DS,Number=A,Type=Float,Description=\"Estimated Alternate Allele Dosage : [P(0/1)+2*P(1/1)]\">" EOLN_STR);
+      if (write_hds) {
+        // bugfix (3 May 2018): 'Number=2' was inaccurate for haploid calls.
+
+        // Note that HDS ploidy intentionally does NOT match GT ploidy in the
+        // unphased het haploid case.
+        write_iter = strcpya_k(write_iter, "##FORMAT=<ID=HDS,Number=.,Type=Float,Description=\"Estimated Haploid Alternate Allele Dosage \">" EOLN_STR);
+      }
+    } else if (write_some_dosage) {
+      write_iter = strcpya_k(write_iter, "##FORMAT=<ID=GP,Number=G,Type=Float,Description=\"Estimated Posterior Probabilities for Genotypes 0/0, 0/1 and 1/1 \">" EOLN_STR);
+    }
+    // possible todo: if there is ever a real standard for encoding pedigree
+    // information in the VCF header, do it here and make --vcf be able to read
+    // it
+    if (!ds_only) {
+      write_iter = strcpya_k(write_iter, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">" EOLN_STR);
+    }
+    write_iter = strcpya_k(write_iter, "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT");
+    char* exported_sample_ids;
+    uintptr_t max_exported_sample_id_blen;
+    if (unlikely(ExportIdpaste(sample_include, siip, "vcf", "vcf", sample_ct, exportf_id_paste, exportf_id_delim, &max_exported_sample_id_blen, &exported_sample_ids))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      *write_iter++ = '\t';
+      write_iter = strcpya(write_iter, &(exported_sample_ids[sample_idx * max_exported_sample_id_blen]));
+      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
+        goto ExportVcf_ret_WRITE_FAIL;
+      }
+    }
+    AppendBinaryEoln(&write_iter);
+    BigstackReset(exported_sample_ids);
+
+    logprintfww5("--export vcf%s to %s ... ", (exportf_flags & kfExportfBgz)? " bgz" : "", outname);
+    fputs("0%", stdout);
+    fflush(stdout);
+
+    // includes trailing tab
+    char* chr_buf;
+    if (unlikely(bigstack_alloc_c(max_chr_blen, &chr_buf))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    // For now, if phased data is present, each homozygous call is represented
+    // as phased iff the previous heterozygous call was phased.  (If no
+    // previous heterozygous call exists, it's treated as phased.)  This does
+    // the right thing when the entire genome is phased, and it induces about
+    // as good a phase set approximation as you can get without explicitly
+    // saving that info.  But that approximation is still pretty inaccurate; as
+    // soon as we have any use for them, explicit phase set support should be
+    // added to pgenlib.
+    // Note that prev_phased is NOT reinitialized at the beginning of each
+    // chromosome.
+    const uint32_t load_dphase = write_hds && (pgfip->gflags & kfPgenGlobalDosagePhasePresent);
+    const uint32_t some_phased = (!ds_only) && ((pgfip->gflags & kfPgenGlobalHardcallPhasePresent) || load_dphase);
+
+    // assumes little-endian
+    // \t0/0  \t0/1  \t1/1  \t./.
+    ctx.basic_genotext[0] = 0x302f3009;
+    ctx.basic_genotext[1] = 0x312f3009;
+    ctx.basic_genotext[2] = 0x312f3109;
+    ctx.basic_genotext[3] = 0x2e2f2e09;
+
+    // 4-genotype-at-a-time lookup in basic case
+    ctx.basic_genotext4[0] = ctx.basic_genotext[0];
+    ctx.basic_genotext4[4] = ctx.basic_genotext[1];
+    ctx.basic_genotext4[8] = ctx.basic_genotext[2];
+    ctx.basic_genotext4[12] = ctx.basic_genotext[3];
+    InitLookup256x4bx4(ctx.basic_genotext4);
+
+    // 2-genotype-at-a-time lookup in basic phased case
+    ctx.phased_genotext2[0] = ctx.basic_genotext[0];
+    ctx.phased_genotext2[2] = ctx.basic_genotext[1];
+    ctx.phased_genotext2[4] = ctx.basic_genotext[2];
+    ctx.phased_genotext2[6] = ctx.basic_genotext[3];
+    ctx.phased_genotext2[32] = 0x307c3009;
+    ctx.phased_genotext2[34] = 0x317c3009;
+    ctx.phased_genotext2[36] = 0x317c3109;
+    ctx.phased_genotext2[38] = 0x2e7c2e09;
+    ctx.phased_genotext2[162] = 0x307c3109;  // 1|0
+    InitVcfPhaseLookup4b(ctx.phased_genotext2);
+
+    // don't bother exporting GP for hardcalls
+    // usually don't bother for DS, but DS-force is an exception
+
+    // 4..7 = haploid, 5 should never be looked up
+    // :0 :1 :2 :. :0 !! :1 :.
+    // ':' replaced with '\t' if ds_only
+    ctx.ds_inttext[0] = 0x303a;
+    ctx.ds_inttext[1] = 0x313a;
+    ctx.ds_inttext[2] = 0x323a;
+    ctx.ds_inttext[3] = 0x2e3a;
+    ctx.ds_inttext[4] = 0x303a;
+    ctx.ds_inttext[5] = 0x2121;
+    ctx.ds_inttext[6] = 0x313a;
+    ctx.ds_inttext[7] = 0x2e3a;
+    if (ds_only) {
+      ctx.ds_inttext[0] = 0x3009;
+      ctx.ds_inttext[1] = 0x3109;
+      ctx.ds_inttext[2] = 0x3209;
+      ctx.ds_inttext[3] = 0x2e09;
+      ctx.ds_inttext[4] = 0x3009;
+      ctx.ds_inttext[6] = 0x3109;
+      ctx.ds_inttext[7] = 0x2e09;
+
+      ctx.ds_inttext4[0] = 0x3009;
+      ctx.ds_inttext4[4] = 0x3109;
+      ctx.ds_inttext4[8] = 0x3209;
+      ctx.ds_inttext4[12] = 0x2e09;
+      InitLookup256x2bx4(ctx.ds_inttext4);
+    }
+
+    // 0..3 = diploid unphased
+    // 4..5 = phased, phaseinfo=0 first
+    // update (1 Aug 2018): HDS ploidy should be more trustworthy than GT
+    // ploidy when there's a conflict, since GT must render unphased het
+    // haploids as 0/1.  So under HDS-force, diploid missing value is '.,.'
+    // instead of '.'.  (Since we're only interested in storing a trustworthy
+    // ploidy, we don't add more missing entries in the multiallelic case.)
+
+    // could make this include DS text in front
+    // could expand this to e.g. 10 cases and make [4], [5] less fiddly
+    // :0,0  :0.5,0.5  :1,1  :.,.  :0,1  :1,0
+    ctx.hds_inttext[0] = 0x302c303a;
+    ctx.hds_inttext[1] = 0x352e302c352e303aLLU;
+    ctx.hds_inttext[2] = 0x312c313a;
+    ctx.hds_inttext[3] = 0x2e2c2e3a;
+    ctx.hds_inttext[4] = 0x312c303a;
+    ctx.hds_inttext[5] = 0x302c313a;
+
+    // Main thread writes CHROM..INFO (INFO may be reloaded from the .pvar, so
+    // that part is inherently sequential), while worker threads render the
+    // FORMAT and sample columns of disjoint variant ranges into fixed-size
+    // slots.  prev_phased carries state from one variant to the next, so when
+    // phased calls may be written and there's more than one worker, each
+    // block is first dispatched in summary mode: every worker records which
+    // samples had a het call in its range and their last phase status, and
+    // the main thread chains these summaries to give each worker its starting
+    // state.
+    uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
+    // Renderers may write a few bytes past the end of the line.
+    const uintptr_t genotext_slot_blen = RoundUpPow2(sample_ct * output_bytes_per_sample + 32 + kCacheline, kCacheline);
+    // limit each slot buffer to 1/4 of remaining workspace
+    uintptr_t max_write_block_size = bigstack_left() / (4 * (genotext_slot_blen + sizeof(intptr_t)));
+    if (max_write_block_size > kPglVblockSize) {
+      max_write_block_size = kPglVblockSize;
+    } else if (unlikely(!max_write_block_size)) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    if (calc_thread_ct > max_write_block_size) {
+      calc_thread_ct = max_write_block_size;
+    }
+    if (unlikely(bigstack_alloc_c(genotext_slot_blen * max_write_block_size, &(ctx.genotext_bufs[0])) ||
+                 bigstack_alloc_c(genotext_slot_blen * max_write_block_size, &(ctx.genotext_bufs[1])) ||
+                 bigstack_alloc_w(max_write_block_size, &(ctx.genotext_blens[0])) ||
+                 bigstack_alloc_w(max_write_block_size, &(ctx.genotext_blens[1])))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    const uint32_t dosage_is_present = write_some_dosage && (pgfip->gflags & kfPgenGlobalDosagePresent);
+    const uint32_t dphase_is_present = dosage_is_present && load_dphase;
+    STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
+    ctx.thread_mhc = nullptr;
+    ctx.phasepresents = nullptr;
+    ctx.phaseinfos = nullptr;
+    ctx.dosage_presents = nullptr;
+    ctx.dosage_mains = nullptr;
+    ctx.dphase_presents = nullptr;
+    ctx.dphase_deltas = nullptr;
+    uint32_t read_block_size;
+    if (unlikely(PgenMtLoadInit(variant_include, sample_ct, variant_ct, bigstack_left(), pgr_alloc_cacheline_ct, 0, 0, 0, pgfip, &calc_thread_ct, &ctx.genovecs, allele_idx_offsets? (&ctx.thread_mhc) : nullptr, some_phased? (&ctx.phasepresents) : nullptr, some_phased? (&ctx.phaseinfos) : nullptr, dosage_is_present? (&ctx.dosage_presents) : nullptr, dosage_is_present? (&ctx.dosage_mains) : nullptr, dphase_is_present? (&ctx.dphase_presents) : nullptr, dphase_is_present? (&ctx.dphase_deltas) : nullptr, &read_block_size, nullptr, main_loadbufs, &ctx.pgr_ptrs, &ctx.read_variant_uidx_starts))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
+    ctx.prev_phaseds = nullptr;
+    ctx.het_seens = nullptr;
+    ctx.phase_summary_pass = 0;
+    if (some_phased) {
+      if (unlikely(bigstack_alloc_wp(calc_thread_ct, &ctx.prev_phaseds))) {
+        goto ExportVcf_ret_NOMEM;
+      }
+      for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+        if (unlikely(bigstack_alloc_w(sample_ctl, &(ctx.prev_phaseds[tidx])))) {
+          goto ExportVcf_ret_NOMEM;
+        }
+      }
+      // The first block copies this into prev_phaseds[0].
+      SetAllBits(sample_ct, ctx.prev_phaseds[calc_thread_ct - 1]);
+      if (calc_thread_ct > 1) {
+        // het_seens[0] is unused.
+        if (unlikely(bigstack_alloc_wp(calc_thread_ct, &ctx.het_seens))) {
+          goto ExportVcf_ret_NOMEM;
+        }
+        ctx.het_seens[0] = nullptr;
+        for (uint32_t tidx = 1; tidx != calc_thread_ct; ++tidx) {
+          if (unlikely(bigstack_alloc_w(sample_ctl, &(ctx.het_seens[tidx])))) {
+            goto ExportVcf_ret_NOMEM;
           }
-          if (!ds_force) {
-            if (!is_haploid) {
-              if (allele_ct <= 10) {
-                GenoarrLookup256x4bx4(pgv.genovec, basic_genotext4, sample_ct, write_iter);
-                if (pgv.patch_01_ct) {
-                  // Patch some 0/1 entries to 0/x.
-                  char* genotext_offset3 = &(write_iter[3]);
-                  uintptr_t sample_idx_base = 0;
-                  uintptr_t patch_01_bits = pgv.patch_01_set[0];
-                  for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                    const uintptr_t sample_idx = BitIter1(pgv.patch_01_set, &sample_idx_base, &patch_01_bits);
-                    genotext_offset3[4 * sample_idx] = '0' + pgv.patch_01_vals[uii];
-                  }
-                }
-                if (pgv.patch_10_ct) {
-                  // Patch some 1/1 entries to x/y.
-                  char* genotext_offset1 = &(write_iter[1]);
-                  uintptr_t sample_idx_base = 0;
-                  uintptr_t patch_10_bits = pgv.patch_10_set[0];
-                  for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                    const uintptr_t sample_idx = BitIter1(pgv.patch_10_set, &sample_idx_base, &patch_10_bits);
-                    genotext_offset1[4 * sample_idx] = '0' + pgv.patch_10_vals[2 * uii];
-                    genotext_offset1[4 * sample_idx + 2] = '0' + pgv.patch_10_vals[2 * uii + 1];
-                  }
-                }
-                write_iter = &(write_iter[sample_ct * 4]);
-              } else {
-                if (!pgv.patch_01_ct) {
-                  ZeroWArr(sample_ctl, pgv.patch_01_set);
-                }
-                if (!pgv.patch_10_ct) {
-                  ZeroWArr(sample_ctl, pgv.patch_10_set);
-                }
-                const AlleleCode* patch_01_vals_iter = pgv.patch_01_vals;
-                const AlleleCode* patch_10_vals_iter = pgv.patch_10_vals;
-                for (uint32_t widx = 0; ; ++widx) {
-                  if (widx >= sample_ctl2_m1) {
-                    if (widx > sample_ctl2_m1) {
-                      break;
-                    }
-                    inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                  }
-                  uintptr_t genovec_word = pgv.genovec[widx];
-                  uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                  for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                    const uint32_t cur_geno = genovec_word & 3;
-                    if (!(multiallelic_hw & 1)) {
-                      write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
-                    } else if (cur_geno == 1) {
-                      write_iter = strcpya_k(write_iter, "\t0/");
-                      const AlleleCode ac = *patch_01_vals_iter++;
-                      write_iter = u32toa(ac, write_iter);
-                    } else {
-                      AlleleCode ac = *patch_10_vals_iter++;
-                      *write_iter++ = '\t';
-                      write_iter = u32toa_x(ac, '/', write_iter);
-                      ac = *patch_10_vals_iter++;
-                      write_iter = u32toa(ac, write_iter);
-                    }
-                    genovec_word >>= 2;
-                    multiallelic_hw >>= 1;
-                  }
-                }
-              }
-            } else {
-              if (!pgv.patch_01_ct) {
-                ZeroWArr(sample_ctl, pgv.patch_01_set);
-              }
-              if (!pgv.patch_10_ct) {
-                ZeroWArr(sample_ctl, pgv.patch_10_set);
-              }
-              // at least partially haploid, !ds_force
-              // We don't separately the allele_ct <= 10 vs. > 10 cases when
-              // entries are already variable-width in the <= 10 case.
-              const AlleleCode* patch_01_vals_iter = pgv.patch_01_vals;
-              const AlleleCode* patch_10_vals_iter = pgv.patch_10_vals;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                uint32_t sex_male_hw = is_x * (DowncastKWToHW(sex_male_collapsed)[widx]);
-                // no need to separate patch_01 and patch_10 since this
-                // information is redundant with genovec_word contents
-                uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                // probable todo: multiallelic_hw == 0 fast path, check
-                // whether <= inner_loop_last vs. < inner_loop_end makes a
-                // difference, etc.
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = sex_male_hw & 1;
-                  if (!(multiallelic_hw & 1)) {
-                    memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                    write_iter = &(write_iter[haploid_genotext_blen[cur_geno + cur_is_male * 4]]);
-                  } else if (cur_geno == 1) {
-                    // always heterozygous, 4 characters
-                    write_iter = strcpya_k(write_iter, "\t0/");
-                    const AlleleCode ac = *patch_01_vals_iter++;
-                    write_iter = u32toa(ac, write_iter);
-                  } else {
-                    const AlleleCode ac0 = *patch_10_vals_iter++;
-                    const AlleleCode ac1 = *patch_10_vals_iter++;
-                    *write_iter++ = '\t';
-                    write_iter = u32toa(ac0, write_iter);
-                    if ((ac0 != ac1) || (haploid_genotext_blen[2 + cur_is_male * 4] == 4)) {
-                      *write_iter++ = '/';
-                      write_iter = u32toa(ac1, write_iter);
-                    }
-                  }
-                  genovec_word >>= 2;
-                  sex_male_hw >>= 1;
-                  multiallelic_hw >>= 1;
-                }
-              }
-            }
-          } else {
-            if (!pgv.patch_01_ct) {
-              ZeroWArr(sample_ctl, pgv.patch_01_set);
-            }
-            if (!pgv.patch_10_ct) {
-              ZeroWArr(sample_ctl, pgv.patch_10_set);
-            }
-            // ds_force, !some_phased
-            if (ds_only) {
-              write_iter = strcpya_k(write_iter, "\tDS");
-            } else {
-              write_iter = strcpya_k(write_iter, ":DS");
-              if (hds_force) {
-                write_iter = strcpya_k(write_iter, ":HDS");
-              }
-            }
-            const uint32_t allele_ct_m2 = allele_ct - 2;
-            const AlleleCode* patch_01_vals_iter = pgv.patch_01_vals;
-            const AlleleCode* patch_10_vals_iter = pgv.patch_10_vals;
-            if (!is_haploid) {
-              // DS-force, autosomal diploid, unphased, dosage_ct == 0
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  if (!(multiallelic_hw & 1)) {
-                    if (!ds_only) {
-                      write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
-                    }
-                    // DS
-                    write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                    if (cur_geno != 3) {
-                      // repeat ",0" if nonmissing
-                      write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                      if (hds_force) {
-                        uint64_t cur_inttext = hds_inttext[cur_geno];
-                        const uint32_t hap_blen = hds_inttext_blen[cur_geno + 4];
-                        memcpy(write_iter, &cur_inttext, 4);
-                        write_iter = &(write_iter[hap_blen]);
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                        cur_inttext = cur_inttext >> (8 * hap_blen);
-                        memcpy(write_iter, &cur_inttext, 4);
-                        write_iter = &(write_iter[hap_blen]);
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                      }
-                    } else {
-                      if (hds_force) {
-                        write_iter = strcpya_k(write_iter, ":.,.");
-                      }
-                    }
-                  } else if (cur_geno == 1) {
-                    const AlleleCode ac = *patch_01_vals_iter++;
-                    write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, ds_only, ds_force, ac, 0, write_iter);
-                  } else {
-                    const AlleleCode ac0 = *patch_10_vals_iter++;
-                    const AlleleCode ac1 = *patch_10_vals_iter++;
-                    if (ac0 != ac1) {
-                      write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, ds_only, hds_force, ac0, ac1, 0, write_iter);
-                    } else {
-                      write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, ds_only, hds_force, ac0, '/', write_iter);
-                    }
-                  }
-                  genovec_word >>= 2;
-                  multiallelic_hw >>= 1;
-                }
-              }
-            } else {
-              // DS-force, at least partly haploid, unphased
-              uint32_t sex_male_hw = 0;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (is_x) {
-                  sex_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
-                }
-                uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = sex_male_hw & 1;
-                  const uint32_t should_be_diploid = is_x && (!cur_is_male);
-                  if (!(multiallelic_hw & 1)) {
-                    const uint32_t cur_genotext_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
-                    memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                    write_iter = &(write_iter[cur_genotext_blen]);
-                    // DS
-                    write_iter = memcpya(write_iter, &(ds_inttext[cur_geno + 8 - 2 * cur_genotext_blen]), 2);
-                    if (cur_geno != 3) {
-                      // repeat ",0"
-                      write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                      if (hds_force) {
-                        uint64_t cur_inttext = hds_inttext[cur_geno];
-                        const uint32_t hap_blen = hds_inttext_blen[4 + cur_geno];
-                        memcpy(write_iter, &cur_inttext, 4);
-                        write_iter = &(write_iter[hap_blen]);
-                        if (should_be_diploid) {
-                          write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                          cur_inttext = cur_inttext >> (8 * hap_blen);
-                          memcpy(write_iter, &cur_inttext, 4);
-                          write_iter = &(write_iter[hap_blen]);
-                        }
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                      }
-                    } else {
-                      if (hds_force) {
-                        strcpy_k(write_iter, ":.,.");
-                        write_iter = &(write_iter[2 + 2 * (is_x & (~cur_is_male))]);
-                      }
-                    }
-                  } else if (cur_geno == 1) {
-                    const AlleleCode ac = *patch_01_vals_iter++;
-                    write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, ds_only, hds_force, ac, !should_be_diploid, write_iter);
-                  } else {
-                    const AlleleCode ac0 = *patch_10_vals_iter++;
-                    const AlleleCode ac1 = *patch_10_vals_iter++;
-                    if (ac0 != ac1) {
-                      write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, ds_only, hds_force, ac0, ac1, !should_be_diploid, write_iter);
-                    } else if (haploid_genotext_blen[cur_geno + cur_is_male * 4] == 2) {
-                      write_iter = AppendVcfMultiallelicDsForce10Haploid(allele_ct_m2, ds_only, hds_force, ac0, write_iter);
-                    } else {
-                      write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, ds_only, hds_force, ac0, '/', write_iter);
-                    }
-                  }
-                  genovec_word >>= 2;
-                  multiallelic_hw >>= 1;
-                }
-              }
-            }
+        }
+      }
+    }
+    ctx.variant_include = variant_include;
+    ctx.cip = cip;
+    ctx.allele_idx_offsets = allele_idx_offsets;
+    ctx.allele_permute = allele_permute;
+    ctx.sample_include = sample_include;
+    ctx.sample_include_cumulative_popcounts = sample_include_cumulative_popcounts;
+    ctx.sex_male_collapsed = sex_male_collapsed;
+    ctx.sample_ct = sample_ct;
+    ctx.write_some_dosage = write_some_dosage;
+    ctx.write_ds = write_ds;
+    ctx.write_hds = write_hds;
+    ctx.ds_force = ds_force;
+    ctx.ds_only = ds_only;
+    ctx.hds_force = hds_force;
+    ctx.some_phased = some_phased;
+    ctx.genotext_slot_blen = genotext_slot_blen;
+    ctx.err_info = (~0LLU) << 32;
+    if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
+      goto ExportVcf_ret_NOMEM;
+    }
+    SetThreadFuncAndData(ExportVcfThread, &ctx, &tg);
+
+    // Opened after the worker allocations, since the INFO text stream takes
+    // most of the remaining workspace.
+    char* pvar_reload_line_iter = nullptr;
+    uint32_t info_col_idx = 0;
+    if (pvar_info_reload) {
+      reterr = PvarInfoOpenAndReloadHeader(pvar_info_reload, 1 + (max_thread_ct > 1), &pvar_reload_txs, &pvar_reload_line_iter, &info_col_idx);
+      if (unlikely(reterr)) {
+        goto ExportVcf_ret_TSTREAM_FAIL;
+      }
+    }
+
+    // Main workflow:
+    // 1. Load read block 0
+    //
+    // 2. Unless all variants have been dispatched, spawn threads rendering
+    //    write block n (up to max_write_block_size variants, never crossing a
+    //    read block boundary)
+    // 3. If n>0, write results for write block (n-1)
+    // 4. Stop if nothing was spawned in step 2
+    // 5. If the current read block is exhausted, load the next one
+    // 6. Join threads
+    // 7. Increment n, goto step 2
+    const char* dot_ptr = &(g_one_char_strs[92]);
+    uintptr_t write_variant_uidx_base = 0;
+    uintptr_t cur_bits = variant_include[0];
+    uint32_t parity = 0;
+    uint32_t load_parity = 0;
+    uint32_t read_block_idx = 0;
+    uint32_t chr_fo_idx = UINT32_MAX;
+    uint32_t chr_end = 0;
+    uint32_t chr_buf_blen = 0;
+    uint32_t pct = 0;
+    uint32_t next_print_variant_idx = variant_ct / 100;
+    uint32_t rls_variant_uidx = 0;
+    uint32_t ref_allele_idx = 0;
+    uint32_t alt1_allele_idx = 1;
+    uint32_t allele_ct = 2;
+    uint32_t invalid_allele_code_seen = 0;
+    uint32_t read_block_rem = MultireadNonempty(variant_include, &tg, raw_variant_ct, read_block_size, pgfip, &read_block_idx, &reterr);
+    if (unlikely(reterr)) {
+      goto ExportVcf_ret_PGR_FAIL;
+    }
+    uint32_t next_block_uidx_start = read_block_idx * read_block_size;
+    uint32_t prev_block_write_ct = 0;
+    for (uint32_t variant_idx = 0; ; ) {
+      uint32_t cur_block_write_ct = 0;
+      if (variant_idx != variant_ct) {
+        cur_block_write_ct = MINV(read_block_rem, max_write_block_size);
+        ctx.cur_block_write_ct = cur_block_write_ct;
+        ComputeUidxStartPartition(variant_include, cur_block_write_ct, calc_thread_ct, next_block_uidx_start, ctx.read_variant_uidx_starts);
+        PgrCopyBaseAndOffset(pgfip, calc_thread_ct, ctx.pgr_ptrs);
+        if (ctx.het_seens) {
+          // The last thread's prev_phased buffer holds the state at the end
+          // of the previous block; the summary pass overwrites it.
+          uintptr_t** prev_phaseds = ctx.prev_phaseds;
+          memcpy(prev_phaseds[0], prev_phaseds[calc_thread_ct - 1], sample_ctl * sizeof(intptr_t));
+          ctx.phase_summary_pass = 1;
+          if (unlikely(SpawnThreads(&tg))) {
+            goto ExportVcf_ret_THREAD_CREATE_FAIL;
           }
-        } else {
-          // multiallelic, phased
-          reterr = PgrGetMP(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, &pgv);
+          JoinThreads(&tg);
+          ctx.phase_summary_pass = 0;
+          reterr = S_CAST(PglErr, ctx.err_info);
           if (unlikely(reterr)) {
-            PgenErrPrintNV(reterr, variant_uidx);
+            PgenErrPrintNV(reterr, ctx.err_info >> 32);
             goto ExportVcf_ret_1;
           }
-          if (!pgv.patch_01_ct) {
-            ZeroWArr(sample_ctl, pgv.patch_01_set);
+          for (uint32_t tidx = 1; tidx != calc_thread_ct; ++tidx) {
+            const uintptr_t* prev_start = prev_phaseds[tidx - 1];
+            const uintptr_t* het_seen = ctx.het_seens[tidx];
+            uintptr_t* cur_start = prev_phaseds[tidx];
+            for (uint32_t widx = 0; widx != sample_ctl; ++widx) {
+              cur_start[widx] |= prev_start[widx] & (~het_seen[widx]);
+            }
           }
-          if (!pgv.patch_10_ct) {
-            ZeroWArr(sample_ctl, pgv.patch_10_set);
+        }
+        variant_idx += cur_block_write_ct;
+        read_block_rem -= cur_block_write_ct;
+        if (variant_idx == variant_ct) {
+          DeclareLastThreadBlock(&tg);
+        }
+        if (unlikely(SpawnThreads(&tg))) {
+          goto ExportVcf_ret_THREAD_CREATE_FAIL;
+        }
+        if (read_block_rem) {
+          next_block_uidx_start = 1 + FindNth1BitFrom(variant_include, ctx.read_variant_uidx_starts[0], cur_block_write_ct);
+        }
+      }
+      if (prev_block_write_ct) {
+        // write *previous* block results
+        const char* genotext_iter = ctx.genotext_bufs[1 - parity];
+        const uintptr_t* genotext_blens = ctx.genotext_blens[1 - parity];
+        for (uint32_t variant_bidx = 0; variant_bidx != prev_block_write_ct; ++variant_bidx) {
+          // a lot of this is redundant with write_pvar(), may want to factor
+          // the commonalities out
+          const uint32_t variant_uidx = BitIter1(variant_include, &write_variant_uidx_base, &cur_bits);
+          if (variant_uidx >= chr_end) {
+            do {
+              ++chr_fo_idx;
+              chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+            } while (variant_uidx >= chr_end);
+            uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+            // forced --merge-par, with diploid male output (is_x NOT set, but
+            // chromosome code is X/chrX)
+            if ((chr_idx == cip->xymt_codes[kChrOffsetPAR1]) || (chr_idx == cip->xymt_codes[kChrOffsetPAR2])) {
+              chr_idx = cip->xymt_codes[kChrOffsetX];
+            }
+            char* chr_name_end = chrtoa(cip, chr_idx, chr_buf);
+            *chr_name_end = '\t';
+            chr_buf_blen = 1 + S_CAST(uintptr_t, chr_name_end - chr_buf);
           }
-          if (!pgv.phasepresent_ct) {
-            ZeroWArr(sample_ctl, pgv.phasepresent);
+          // #CHROM
+          write_iter = memcpya(write_iter, chr_buf, chr_buf_blen);
+
+          // POS
+          write_iter = u32toa_x(variant_bps[variant_uidx], '\t', write_iter);
+
+          // ID
+          write_iter = strcpyax(write_iter, variant_ids[variant_uidx], '\t');
+
+          // REF, ALT
+          uintptr_t allele_idx_offset_base = variant_uidx * 2;
+          if (allele_idx_offsets) {
+            allele_idx_offset_base = allele_idx_offsets[variant_uidx];
+            allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offset_base;
           }
-          const AlleleCode* patch_01_vals_iter = pgv.patch_01_vals;
-          const AlleleCode* patch_10_vals_iter = pgv.patch_10_vals;
-          if (!ds_force) {
-            if (!is_haploid) {
-              if (allele_ct <= 10) {
-                for (uint32_t widx = 0; ; ++widx) {
-                  if (widx >= sample_ctl2_m1) {
-                    if (widx > sample_ctl2_m1) {
-                      break;
-                    }
-                    inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                  }
-                  uintptr_t genovec_word = pgv.genovec[widx];
-                  const uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                  uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                  const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                  const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                  uint32_t cur_shift = 1;
-                  for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                    const uintptr_t cur_geno = genovec_word & 3;
-                    uint32_t cur_basic_genotext;
-                    if (!(multiallelic_hw & cur_shift)) {
-                      // usually "\t0/0", etc.
-                      cur_basic_genotext = basic_genotext[cur_geno];
-                      if (cur_geno == 1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            cur_basic_genotext ^= 0x1000100;  // 0|1 -> 1|0
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      }
-                    } else {
-                      AlleleCode ac0;
-                      AlleleCode ac1;
-                      if (cur_geno == 1) {
-                        ac0 = 0;
-                        ac1 = *patch_01_vals_iter++;
-                      } else {
-                        ac0 = *patch_10_vals_iter++;
-                        ac1 = *patch_10_vals_iter++;
-                      }
-                      if (ac0 != ac1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            const AlleleCode ac_swap = ac0;
-                            ac0 = ac1;
-                            ac1 = ac_swap;
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      }
-                      cur_basic_genotext = 0x302f3009 + (ac0 * 256) + (ac1 * 0x1000000);
-                    }
-                    // '/' = ascii 47, '|' = ascii 124
-                    CAppendU32(cur_basic_genotext + 0x4d0000 * ((prev_phased_halfword >> sample_idx_lowbits) & 1), &write_iter);
-                    genovec_word >>= 2;
-                    cur_shift = cur_shift * 2;
-                  }
-                  DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-                }
-              } else {
-                // phased, allele_ct > 10, !is_haploid, !ds_force
-                for (uint32_t widx = 0; ; ++widx) {
-                  if (widx >= sample_ctl2_m1) {
-                    if (widx > sample_ctl2_m1) {
-                      break;
-                    }
-                    inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                  }
-                  uintptr_t genovec_word = pgv.genovec[widx];
-                  const uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                  uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                  const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                  const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                  uint32_t cur_shift = 1;
-                  for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                    const uint32_t cur_geno = genovec_word & 3;
-                    if (!(multiallelic_hw & cur_shift)) {
-                      write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
-                      if (cur_geno == 1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            memcpy(&(write_iter[-4]), "\t1|0", 4);
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      }
-                      if (prev_phased_halfword & cur_shift) {
-                        write_iter[-2] = '|';
-                      }
-                    } else {
-                      AlleleCode ac0;
-                      AlleleCode ac1;
-                      if (cur_geno == 1) {
-                        ac0 = 0;
-                        ac1 = *patch_01_vals_iter++;
-                      } else {
-                        ac0 = *patch_10_vals_iter++;
-                        ac1 = *patch_10_vals_iter++;
-                      }
-                      if (ac0 != ac1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            const AlleleCode ac_swap = ac0;
-                            ac0 = ac1;
-                            ac1 = ac_swap;
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      }
-                      *write_iter++ = '\t';
-                      write_iter = u32toa(ac0, write_iter);
-                      if (prev_phased_halfword & cur_shift) {
-                        *write_iter++ = '|';
-                      } else {
-                        *write_iter++ = '/';
-                      }
-                      write_iter = u32toa(ac1, write_iter);
-                    }
-                    genovec_word >>= 2;
-                    cur_shift = cur_shift * 2;
-                  }
-                  DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-                }
+          const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
+          if (allele_permute) {
+            ref_allele_idx = allele_permute[allele_idx_offset_base];
+            alt1_allele_idx = allele_permute[allele_idx_offset_base + 1];
+          }
+          if (cur_alleles[ref_allele_idx] != dot_ptr) {
+            write_iter = strcpya(write_iter, cur_alleles[ref_allele_idx]);
+            if (!invalid_allele_code_seen) {
+              invalid_allele_code_seen = !ValidVcfAlleleCode(cur_alleles[ref_allele_idx]);
+            }
+          } else {
+            *write_iter++ = 'N';
+          }
+          *write_iter++ = '\t';
+          write_iter = strcpya(write_iter, cur_alleles[alt1_allele_idx]);
+          if (!invalid_allele_code_seen) {
+            invalid_allele_code_seen = !ValidVcfAlleleCode(cur_alleles[alt1_allele_idx]);
+          }
+          if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
+            goto ExportVcf_ret_WRITE_FAIL;
+          }
+          if (allele_ct > 2) {
+            for (uint32_t cur_allele_uidx = 0; cur_allele_uidx != allele_ct; ++cur_allele_uidx) {
+              if ((cur_allele_uidx == ref_allele_idx) || (cur_allele_uidx == alt1_allele_idx)) {
+                // if this is noticeably suboptimal, have two loops, with inner
+                // loop going up to cur_allele_stop.
+                // (also wrap this in a function, this comes up a bunch of
+                // times)
+                continue;
               }
-            } else {
-              // phased, at least partially haploid, !ds_force
-              // probable todo: merge this with biallelic code, do the same for
-              // other less-common biallelic-variable-width cases
-              uint32_t is_male_hw = 0;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (is_x) {
-                  is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
-                }
-                const uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                uint32_t cur_shift = 1;
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = is_male_hw & 1;
-                  if (!(multiallelic_hw & cur_shift)) {
-                    const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
-                    memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                    write_iter = &(write_iter[cur_blen]);
-                    if (cur_blen == 4) {
-                      if (cur_geno == 1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            memcpy(&(write_iter[-4]), "\t1|0", 4);
-                          } else {
-                            write_iter[-2] = '|';
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      } else if ((prev_phased_halfword >> sample_idx_lowbits) & 1) {
-                        write_iter[-2] = '|';
-                      }
-                    }
-                  } else {
-                    AlleleCode ac0;
-                    AlleleCode ac1;
-                    if (cur_geno == 1) {
-                      ac0 = 0;
-                      ac1 = *patch_01_vals_iter++;
-                    } else {
-                      ac0 = *patch_10_vals_iter++;
-                      ac1 = *patch_10_vals_iter++;
-                    }
-                    *write_iter++ = '\t';
-                    if ((ac0 != ac1) || (haploid_genotext_blen[2 + cur_is_male * 4] == 4)) {
-                      if (ac0 != ac1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            const AlleleCode ac_swap = ac0;
-                            ac0 = ac1;
-                            ac1 = ac_swap;
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      }
-                      write_iter = u32toa(ac0, write_iter);
-                      if (prev_phased_halfword & cur_shift) {
-                        *write_iter++ = '|';
-                      } else {
-                        *write_iter++ = '/';
-                      }
-                    }
-                    write_iter = u32toa(ac1, write_iter);
-                  }
-                  genovec_word >>= 2;
-                  is_male_hw >>= 1;
-                  cur_shift = cur_shift * 2;
-                }
-                DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
+              *write_iter++ = ',';
+              write_iter = strcpya(write_iter, cur_alleles[cur_allele_uidx]);
+              if (!invalid_allele_code_seen) {
+                invalid_allele_code_seen = !ValidVcfAlleleCode(cur_alleles[cur_allele_uidx]);
+              }
+              if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
+                goto ExportVcf_ret_WRITE_FAIL;
               }
             }
+          }
+
+          // QUAL
+          *write_iter++ = '\t';
+          if ((!pvar_qual_present) || (!IsSet(pvar_qual_present, variant_uidx))) {
+            *write_iter++ = '.';
           } else {
-            // phased, ds_force
-            write_iter = strcpya_k(write_iter, ":DS");
-            if (hds_force) {
-              write_iter = strcpya_k(write_iter, ":HDS");
+            write_iter = ftoa_g(pvar_quals[variant_uidx], write_iter);
+          }
+
+          // FILTER
+          *write_iter++ = '\t';
+          if ((!pvar_filter_present) || (!IsSet(pvar_filter_present, variant_uidx))) {
+            *write_iter++ = '.';
+          } else if (!IsSet(pvar_filter_npass, variant_uidx)) {
+            write_iter = strcpya_k(write_iter, "PASS");
+          } else {
+            write_iter = strcpya(write_iter, pvar_filter_storage[variant_uidx]);
+          }
+
+          // INFO
+          *write_iter++ = '\t';
+          const uint32_t is_pr = all_nonref || (nonref_flags && IsSet(nonref_flags, variant_uidx));
+          if (pvar_reload_line_iter) {
+            reterr = PvarInfoReloadAndWrite(info_pr_flag_present, info_col_idx, variant_uidx, is_pr, &pvar_reload_txs, &pvar_reload_line_iter, &write_iter, &rls_variant_uidx);
+            if (unlikely(reterr)) {
+              goto ExportVcf_ret_TSTREAM_FAIL;
             }
-            const uint32_t allele_ct_m2 = allele_ct - 2;
-            if (!is_haploid) {
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                const uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                uint32_t cur_shift = 1;
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  if (!(multiallelic_hw & cur_shift)) {
-                    write_iter = memcpya(write_iter, &(basic_genotext[cur_geno]), 4);
-                    if (cur_geno == 1) {
-                      if (phasepresent_hw & cur_shift) {
-                        prev_phased_halfword |= cur_shift;
-                        if (phaseinfo_hw & cur_shift) {
-                          memcpy(&(write_iter[-4]), "\t1|0", 4);
-                        }
-                      } else {
-                        prev_phased_halfword &= ~cur_shift;
-                      }
-                    }
-                    if (prev_phased_halfword & cur_shift) {
-                      write_iter[-2] = '|';
-                    }
-                    // DS
-                    write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                    if (cur_geno != 3) {
-                      // repeat ",0" if nonmissing
-                      write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                      if (hds_force) {
-                        uint32_t hds_inttext_index = cur_geno;
-                        // bugfix (8 Mar 2020): hap_blen was set incorrectly in
-                        // phased case
-                        uint32_t hap_blen = 2;
-                        if (phasepresent_hw & cur_shift) {
-                          hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
-                        } else {
-                          hap_blen = hds_inttext_blen[hds_inttext_index] / 2;
-                        }
-                        uint64_t cur_inttext = hds_inttext[hds_inttext_index];
-                        memcpy(write_iter, &cur_inttext, 4);
-                        write_iter = &(write_iter[hap_blen]);
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                        cur_inttext = cur_inttext >> (8 * hap_blen);
-                        memcpy(write_iter, &cur_inttext, 4);
-                        write_iter = &(write_iter[hap_blen]);
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                      }
-                    } else {
-                      if (hds_force) {
-                        write_iter = strcpya_k(write_iter, ":.,.");
-                      }
-                    }
-                  } else {
-                    AlleleCode ac0;
-                    AlleleCode ac1;
-                    if (cur_geno == 1) {
-                      ac0 = 0;
-                      ac1 = *patch_01_vals_iter++;
-                    } else {
-                      ac0 = *patch_10_vals_iter++;
-                      ac1 = *patch_10_vals_iter++;
-                    }
-                    if (ac0 != ac1) {
-                      if (phasepresent_hw & cur_shift) {
-                        prev_phased_halfword |= cur_shift;
-                        write_iter = AppendVcfMultiallelicDsForcePhased(allele_ct_m2, hds_force, ac0, ac1, phaseinfo_hw & cur_shift, write_iter);
-                      } else {
-                        prev_phased_halfword &= ~cur_shift;
-                        if (!ac0) {
-                          write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, 0, hds_force, ac1, 0, write_iter);
-                        } else {
-                          write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, 0, hds_force, ac0, ac1, 0, write_iter);
-                        }
-                      }
-                    } else {
-                      write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, 0, hds_force, ac0, (prev_phased_halfword & cur_shift)? '|' : '/', write_iter);
-                    }
-                  }
-                  genovec_word >>= 2;
-                  cur_shift <<= 1;
-                }
-                DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-              }
+          } else {
+            if (is_pr) {
+              write_iter = strcpya_k(write_iter, "PR");
             } else {
-              // dosage (or {H}DS-force) and phase present, partly/fully
-              // haploid
-              uint32_t is_male_hw = 0;
-              for (uint32_t widx = 0; ; ++widx) {
-                if (widx >= sample_ctl2_m1) {
-                  if (widx > sample_ctl2_m1) {
-                    break;
-                  }
-                  inner_loop_last = (sample_ct - 1) % kBitsPerWordD2;
-                }
-                uintptr_t genovec_word = pgv.genovec[widx];
-                if (is_x) {
-                  is_male_hw = DowncastKWToHW(sex_male_collapsed)[widx];
-                }
-                const uint32_t multiallelic_hw = (DowncastKWToHW(pgv.patch_01_set)[widx]) | (DowncastKWToHW(pgv.patch_10_set)[widx]);
-                uint32_t prev_phased_halfword = DowncastWToHW(prev_phased)[widx];
-                const uint32_t phasepresent_hw = DowncastWToHW(pgv.phasepresent)[widx];
-                const uint32_t phaseinfo_hw = DowncastWToHW(pgv.phaseinfo)[widx];
-                uint32_t cur_shift = 1;
-                for (uint32_t sample_idx_lowbits = 0; sample_idx_lowbits <= inner_loop_last; ++sample_idx_lowbits) {
-                  const uint32_t cur_geno = genovec_word & 3;
-                  const uint32_t cur_is_male = is_male_hw & 1;
-                  const uint32_t should_be_diploid = is_x && (!cur_is_male);
-                  // bugfix (29 Dec 2018): need to check correct bit here
-                  if (!(multiallelic_hw & cur_shift)) {
-                    const uint32_t cur_blen = haploid_genotext_blen[cur_geno + cur_is_male * 4];
-                    memcpy(write_iter, &(basic_genotext[cur_geno]), 4);
-                    write_iter = &(write_iter[cur_blen]);
-                    if (cur_blen == 4) {
-                      // render current hardcall as diploid (chrX nonmale, or
-                      // het haploid)
-                      if (cur_geno == 1) {
-                        if (phasepresent_hw & cur_shift) {
-                          prev_phased_halfword |= cur_shift;
-                          if (phaseinfo_hw & cur_shift) {
-                            memcpy(&(write_iter[-4]), "\t1|0", 4);
-                          }
-                        } else {
-                          prev_phased_halfword &= ~cur_shift;
-                        }
-                      }
-                      if (prev_phased_halfword & cur_shift) {
-                        write_iter[-2] = '|';
-                      }
-                      // DS
-                      write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno]), 2);
-                      if (cur_geno != 3) {
-                        // repeat ",0"
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                        if (hds_force) {
-                          uint32_t hds_inttext_index = cur_geno;
-                          uint32_t hap_blen = 2;
-                          if (phasepresent_hw & cur_shift) {
-                            hds_inttext_index = 4 + ((phaseinfo_hw >> sample_idx_lowbits) & 1);
-                          } else {
-                            hap_blen = hds_inttext_blen[hds_inttext_index] / 2;
-                          }
-                          uint64_t cur_inttext = hds_inttext[hds_inttext_index];
-                          memcpy(write_iter, &cur_inttext, 4);
-                          write_iter = &(write_iter[hap_blen]);
-                          write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                          // Don't render unphased het haploid as diploid here
-                          if (should_be_diploid || (phasepresent_hw & cur_shift)) {
-                            cur_inttext = cur_inttext >> (8 * hap_blen);
-                            memcpy(write_iter, &cur_inttext, 4);
-                            write_iter = &(write_iter[hap_blen]);
-                            write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                          }
-                        }
-                      } else {
-                        if (hds_force) {
-                          strcpy_k(write_iter, ":.,.");
-                          write_iter = &(write_iter[2 + 2 * should_be_diploid]);
-                        }
-                      }
-                    } else {
-                      // render current hardcall as haploid
-                      // (can't get here for hardcall-phased)
-                      write_iter = memcpya_k(write_iter, &(ds_inttext[cur_geno + 4]), 2);
-                      if (cur_geno != 3) {
-                        // repeat ",0"
-                        write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                        if (hds_force) {
-                          // don't need to perform generic copy from
-                          // hds_inttext, since only possibilities are :0 and
-                          // :1
-                          CAppendU16(0x303a + 128 * cur_geno, &write_iter);
-                          write_iter = u16setsa(write_iter, 0x302c, allele_ct_m2);
-                        }
-                      } else {
-                        if (hds_force) {
-                          write_iter = strcpya_k(write_iter, ":.");
-                        }
-                      }
-                    }
-                  } else {
-                    AlleleCode ac0;
-                    AlleleCode ac1;
-                    if (cur_geno == 1) {
-                      ac0 = 0;
-                      ac1 = *patch_01_vals_iter++;
-                    } else {
-                      ac0 = *patch_10_vals_iter++;
-                      ac1 = *patch_10_vals_iter++;
-                    }
-                    if (ac0 != ac1) {
-                      if (phasepresent_hw & cur_shift) {
-                        prev_phased_halfword |= cur_shift;
-                        write_iter = AppendVcfMultiallelicDsForcePhased(allele_ct_m2, hds_force, ac0, ac1, phaseinfo_hw & cur_shift, write_iter);
-                      } else {
-                        prev_phased_halfword &= ~cur_shift;
-                        if (!ac0) {
-                          write_iter = AppendVcfMultiallelicDsForce01(allele_ct_m2, 0, hds_force, ac1, !should_be_diploid, write_iter);
-                        } else {
-                          write_iter = AppendVcfMultiallelicDsForce10Het(allele_ct_m2, 0, hds_force, ac0, ac1, !should_be_diploid, write_iter);
-                        }
-                      }
-                    } else {
-                      if (should_be_diploid) {
-                        write_iter = AppendVcfMultiallelicDsForce10HomDiploid(allele_ct_m2, 0, hds_force, ac0, (prev_phased_halfword & cur_shift)? '|' : '/', write_iter);
-                      } else {
-                        write_iter = AppendVcfMultiallelicDsForce10Haploid(allele_ct_m2, 0, hds_force, ac0, write_iter);
-                      }
-                    }
-                  }
-                  genovec_word >>= 2;
-                  is_male_hw >>= 1;
-                  cur_shift <<= 1;
-                }
-                DowncastWToHW(prev_phased)[widx] = prev_phased_halfword;
-              }
+              *write_iter++ = '.';
             }
           }
+
+          // FORMAT, genotypes, eoln
+          if (unlikely(BgzfWrite(writebuf, write_iter - writebuf, &bgzf) ||
+                       BgzfWrite(genotext_iter, genotext_blens[variant_bidx], &bgzf))) {
+            goto ExportVcf_ret_WRITE_FAIL;
+          }
+          write_iter = writebuf;
+          genotext_iter = &(genotext_iter[genotext_slot_blen]);
+        }
+        const uint32_t written_variant_ct = variant_idx - cur_block_write_ct;
+        if (written_variant_ct >= next_print_variant_idx) {
+          if (pct > 10) {
+            putc_unlocked('\b', stdout);
+          }
+          pct = (written_variant_ct * 100LLU) / variant_ct;
+          printf("\b\b%u%%", pct++);
+          fflush(stdout);
+          next_print_variant_idx = (pct * S_CAST(uint64_t, variant_ct)) / 100;
         }
       }
-      AppendBinaryEoln(&write_iter);
-      if (unlikely(bgzfwrite_ck(writebuf_flush, &bgzf, &write_iter))) {
-        goto ExportVcf_ret_WRITE_FAIL;
+      if (!cur_block_write_ct) {
+        break;
       }
-      if (variant_idx >= next_print_variant_idx) {
-        if (pct > 10) {
-          putc_unlocked('\b', stdout);
+      if ((!read_block_rem) && (variant_idx != variant_ct)) {
+        load_parity = 1 - load_parity;
+        pgfip->block_base = main_loadbufs[load_parity];
+        ++read_block_idx;
+        read_block_rem = MultireadNonempty(variant_include, &tg, raw_variant_ct, read_block_size, pgfip, &read_block_idx, &reterr);
+        if (unlikely(reterr)) {
+          goto ExportVcf_ret_PGR_FAIL;
         }
-        pct = (variant_idx * 100LLU) / variant_ct;
-        printf("\b\b%u%%", pct++);
-        fflush(stdout);
-        next_print_variant_idx = (pct * S_CAST(uint64_t, variant_ct)) / 100;
+        next_block_uidx_start = read_block_idx * read_block_size;
+      }
+      JoinThreads(&tg);
+      reterr = S_CAST(PglErr, ctx.err_info);
+      if (unlikely(reterr)) {
+        if (reterr == kPglRetNotYetSupported) {
+          logputs("\n");
+          logerrputs("Error: VCF-export multiallelic rotation is under development.\n");
+        } else {
+          PgenErrPrintNV(reterr, ctx.err_info >> 32);
+        }
+        goto ExportVcf_ret_1;
       }
+      prev_block_write_ct = cur_block_write_ct;
+      parity = 1 - parity;
     }
     if (unlikely(bgzfclose_flush(writebuf_flush, write_iter, &bgzf, &reterr))) {
       goto ExportVcf_ret_1;
@@ -5995,11 +6396,19 @@ PglErr ExportVcf(const uintptr_t* sample_include, const uint32_t* sample_include
   ExportVcf_ret_INCONSISTENT_INPUT:
     reterr = kPglRetInconsistentInput;
     break;
+  ExportVcf_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  ExportVcf_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
   }
  ExportVcf_ret_1:
+  CleanupThreads(&tg);
   CleanupTextStream2(pvar_info_reload, &pvar_reload_txs, &reterr);
   CleanupBgzfCompressStream(&bgzf, &reterr);
   BigstackReset(bigstack_mark);
+  pgfip->block_base = nullptr;
   return reterr;
 }
 
@@ -10787,7 +11196,7 @@ PglErr ExportPhylip(const uintptr_t* orig_sample_include, const SampleIdInfo* si
   return reterr;
 }
 
-PglErr Exportf(const uintptr_t* sample_include, const PedigreeIdInfo* piip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* allele_permute, const uintptr_t* pvar_qual_present, const float* pvar_quals, const uintptr_t* pvar_filter_present, const uintptr_t* pvar_filter_npass, const char* const* pvar_filter_storage, const char* pvar_info_reload, const double* variant_cms, const ExportfInfo* eip, const char* legacy_output_missing_pheno, const uint32_t* contig_lens, uintptr_t xheader_blen, InfoFlags info_flags, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t max_filter_slen, uint32_t info_reload_slen, char input_missing_geno_char, char output_missing_geno_char, char legacy_output_missing_geno_char, uint32_t max_thread_ct, MakePlink2Flags make_plink2_flags, uintptr_t pgr_alloc_cacheline_ct, char* xheader, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
+PglErr Exportf(const uintptr_t* sample_include, const PedigreeIdInfo* piip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* allele_permute, const uintptr_t* pvar_qual_present, const float* pvar_quals, const uintptr_t* pvar_filter_present, const uintptr_t* pvar_filter_npass, const char* const* pvar_filter_storage, const char* pvar_info_reload, const double* variant_cms, const ExportfInfo* eip, const char* legacy_output_missing_pheno, const uint32_t* contig_lens, uintptr_t xheader_blen, InfoFlags info_flags, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t max_filter_slen, uint32_t info_reload_slen, char input_missing_geno_char, char output_missing_geno_char, char legacy_output_missing_geno_char, uint32_t max_thread_ct, MakePlink2Flags make_plink2_flags, uintptr_t pgr_alloc_cacheline_ct, char* xheader, const char* pgenname, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
   PglErr reterr = kPglRetSuccess;
@@ -10942,7 +11351,7 @@ PglErr Exportf(const uintptr_t* sample_include, const PedigreeIdInfo* piip, cons
     }
     if (flags & kfExportfIndMajorBed) {
       // multiallelic not ok, but already checked
-      reterr = ExportIndMajorBed(sample_include, variant_include, allele_idx_offsets, allele_permute, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_thread_ct, pgr_alloc_cacheline_ct, pgfip, outname, outname_end);
+      reterr = ExportIndMajorBed(sample_include, variant_include, allele_idx_offsets, allele_permute, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_thread_ct, pgr_alloc_cacheline_ct, pgenname, pgfip, outname, outname_end);
       if (unlikely(reterr)) {
         goto Exportf_ret_1;
       }
@@ -10999,7 +11408,7 @@ PglErr Exportf(const uintptr_t* sample_include, const PedigreeIdInfo* piip, cons
     }
     if (flags & kfExportfVcf) {
       // multiallelic ok
-      reterr = ExportVcf(sample_include, sample_include_cumulative_popcounts, &(piip->sii), sex_male_collapsed, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, allele_permute, pvar_qual_present, pvar_quals, pvar_filter_present, pvar_filter_npass, pvar_filter_storage, pvar_info_reload, contig_lens, xheader_blen, info_flags, sample_ct, raw_variant_ct, variant_ct, max_allele_slen, max_filter_slen, info_reload_slen, max_thread_ct, flags, eip->vcf_mode, idpaste_flags, id_delim, xheader, pgfip, simple_pgrp, outname, outname_end);
+      reterr = ExportVcf(sample_include, sample_include_cumulative_popcounts, &(piip->sii), sex_male_collapsed, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, allele_permute, pvar_qual_present, pvar_quals, pvar_filter_present, pvar_filter_npass, pvar_filter_storage, pvar_info_reload, contig_lens, xheader_blen, info_flags, sample_ct, raw_variant_ct, variant_ct, max_allele_slen, max_filter_slen, info_reload_slen, max_thread_ct, flags, eip->vcf_mode, idpaste_flags, id_delim, xheader, pgr_alloc_cacheline_ct, pgfip, simple_pgrp, outname, outname_end);
       if (unlikely(reterr)) {
         goto Exportf_ret_1;
       }
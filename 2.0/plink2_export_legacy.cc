@@ -63,28 +63,31 @@ THREAD_FUNC_DECL TransposeToSmajReadThread(void* raw_arg) {
   do {
     const uintptr_t cur_block_copy_ct = ctx->cur_block_write_ct;
     const uint32_t cur_idx_end = ((tidx + 1) * cur_block_copy_ct) / calc_thread_ct;
-    uintptr_t variant_uidx_base;
-    uintptr_t cur_bits;
-    BitIter1Start(variant_include, ctx->variant_uidx_starts[tidx], &variant_uidx_base, &cur_bits);
     const uint32_t cur_idx_start = (tidx * cur_block_copy_ct) / calc_thread_ct;
     uintptr_t* vmaj_readbuf_iter = &(ctx->vmaj_readbuf[(prev_copy_ct + cur_idx_start) * read_sample_ctaw2]);
-    for (uint32_t cur_idx = cur_idx_start; cur_idx != cur_idx_end; ++cur_idx) {
-      const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+    uint32_t variant_uidx = ctx->variant_uidx_starts[tidx];
+    // Load each run of consecutive variants with a single PgrGetBlock() call.
+    for (uint32_t cur_idx = cur_idx_start; cur_idx != cur_idx_end; ) {
+      variant_uidx = AdvTo1Bit(variant_include, variant_uidx);
+      const uint32_t run_end = AdvBoundedTo0Bit(variant_include, variant_uidx, variant_uidx + cur_idx_end - cur_idx);
       // todo: multiallelic case
-      const PglErr reterr = PgrGet(sample_include, pssi, read_sample_ct, variant_uidx, pgrp, vmaj_readbuf_iter);
+      const PglErr reterr = PgrGetBlock(sample_include, pssi, read_sample_ct, variant_uidx, run_end, pgrp, read_sample_ctaw2, vmaj_readbuf_iter);
       if (unlikely(reterr)) {
         new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
         goto TransposeToSmajReadThread_err;
       }
-      if (allele_permute) {
-        const uintptr_t allele_idx_offset_base = allele_idx_offsets? allele_idx_offsets[variant_uidx] : (2 * variant_uidx);
-        if (allele_permute[allele_idx_offset_base]) {
-          assert(allele_permute[allele_idx_offset_base] == 1);
-          GenovecInvertUnsafe(read_sample_ct, vmaj_readbuf_iter);
+      cur_idx += run_end - variant_uidx;
+      for (; variant_uidx != run_end; ++variant_uidx) {
+        if (allele_permute) {
+          const uintptr_t allele_idx_offset_base = allele_idx_offsets? allele_idx_offsets[variant_uidx] : (2 * variant_uidx);
+          if (allele_permute[allele_idx_offset_base]) {
+            assert(allele_permute[allele_idx_offset_base] == 1);
+            GenovecInvertUnsafe(read_sample_ct, vmaj_readbuf_iter);
+          }
+          // don't need ZeroTrailingNyps()
         }
-        // don't need ZeroTrailingNyps()
+        vmaj_readbuf_iter = &(vmaj_readbuf_iter[read_sample_ctaw2]);
       }
-      vmaj_readbuf_iter = &(vmaj_readbuf_iter[read_sample_ctaw2]);
     }
     prev_copy_ct += cur_block_copy_ct;
     while (0) {
@@ -167,7 +170,149 @@ THREAD_FUNC_DECL TransposeToPlink1SmajWriteThread(void* raw_arg) {
   THREAD_RETURN;
 }
 
-PglErr ExportIndMajorBed(const uintptr_t* orig_sample_include, const uintptr_t* variant_include, const uintptr_t* allele_idx_offsets, const AlleleCode* allele_permute, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, char* outname, char* outname_end) {
+// If <pgenname>.smaj exists and was generated from the current .pgen, writes
+// the body of the ind-major .bed from it (one SmajGet() call per sample, so
+// no variant record has to be decoded or transposed) and sets *smaj_used_ptr.
+// A stale or invalid sidecar just produces a warning, and the caller falls
+// back on the .pgen.
+static PglErr IndMajorBedFromSmaj(const uintptr_t* sample_include, const uintptr_t* variant_include, const uintptr_t* allele_idx_offsets, const AlleleCode* allele_permute, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, const char* pgenname, FILE* outfile, uint32_t* smaj_used_ptr) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  char smaj_fname[kPglFnamesize];
+  PgenSmajReader smaj;
+  PreinitSmaj(&smaj);
+  *smaj_used_ptr = 0;
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint32_t pgenname_slen = strlen(pgenname);
+    if (pgenname_slen + strlen(".smaj") >= kPglFnamesize) {
+      goto IndMajorBedFromSmaj_ret_1;
+    }
+    snprintf(smaj_fname, kPglFnamesize, "%s.smaj", pgenname);
+    uintptr_t smaj_alloc_cacheline_ct;
+    reterr = SmajInitPhase1(smaj_fname, pgenname, raw_variant_ct, raw_sample_ct, &smaj, &smaj_alloc_cacheline_ct, g_logbuf);
+    if (reterr) {
+      if (reterr == kPglRetOpenFail) {
+        // usual case: no sidecar
+        reterr = kPglRetSuccess;
+      } else if (reterr == kPglRetInconsistentInput) {
+        logerrprintfww("Warning: Ignoring %s, since it was not generated from the current version of %s.  (Regenerate it with pgen_compress -s, or delete it.)\n", smaj_fname, pgenname);
+        reterr = kPglRetSuccess;
+      } else if ((reterr == kPglRetMalformedInput) || (reterr == kPglRetNotYetSupported)) {
+        logerrprintfww("Warning: Ignoring %s, since it isn't a valid .pgen.smaj file.\n", smaj_fname);
+        reterr = kPglRetSuccess;
+      } else {
+        WordWrapB(0);
+        logerrputsb();
+      }
+      goto IndMajorBedFromSmaj_ret_1;
+    }
+    unsigned char* smaj_alloc;
+    if (unlikely(bigstack_alloc_uc(smaj_alloc_cacheline_ct * kCacheline, &smaj_alloc))) {
+      goto IndMajorBedFromSmaj_ret_NOMEM;
+    }
+    reterr = SmajInitPhase2(&smaj, smaj_alloc, g_logbuf);
+    if (reterr) {
+      if (reterr == kPglRetMalformedInput) {
+        logerrprintfww("Warning: Ignoring %s, since it isn't a valid .pgen.smaj file.\n", smaj_fname);
+        reterr = kPglRetSuccess;
+      } else {
+        WordWrapB(0);
+        logerrputsb();
+      }
+      goto IndMajorBedFromSmaj_ret_1;
+    }
+    // Only the part of each row up to the last included variant is loaded.
+    const uint32_t variant_uidx_end = 1 + FindLast1BitBefore(variant_include, raw_variant_ct);
+    const uint32_t variant_ctaw2 = NypCtToAlignedWordCt(variant_ct);
+    uintptr_t* raw_genovec;
+    uintptr_t* genovec;
+    if (unlikely(bigstack_alloc_w(NypCtToWordCt(variant_uidx_end), &raw_genovec) ||
+                 bigstack_alloc_w(variant_ctaw2, &genovec))) {
+      goto IndMajorBedFromSmaj_ret_NOMEM;
+    }
+    // Bit 2k+1 is set iff output variant k's alleles are swapped.
+    uintptr_t* flip_mask = nullptr;
+    if (allele_permute) {
+      if (unlikely(bigstack_calloc_w(variant_ctaw2, &flip_mask))) {
+        goto IndMajorBedFromSmaj_ret_NOMEM;
+      }
+      uintptr_t variant_uidx_base = 0;
+      uintptr_t cur_bits = variant_include[0];
+      for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+        const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+        const uintptr_t allele_idx_offset_base = allele_idx_offsets? allele_idx_offsets[variant_uidx] : (2 * variant_uidx);
+        if (allele_permute[allele_idx_offset_base]) {
+          SetBit(2 * variant_idx + 1, flip_mask);
+        }
+      }
+    }
+    const uint32_t variant_ct4 = NypCtToByteCt(variant_ct);
+    const uint32_t variant_ctl2 = NypCtToWordCt(variant_ct);
+    uintptr_t* row_target = (variant_uidx_end == variant_ct)? genovec : raw_genovec;
+    uintptr_t sample_uidx_base = 0;
+    uintptr_t cur_bits = sample_include[0];
+    uint32_t pct = 0;
+    uint32_t next_print_idx = sample_ct / 100;
+    printf("--export ind-major-bed: 0%%");
+    fflush(stdout);
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      const uint32_t sample_uidx = BitIter1(sample_include, &sample_uidx_base, &cur_bits);
+      if (unlikely(SmajGet(sample_uidx, 0, variant_uidx_end, &smaj, row_target))) {
+        goto IndMajorBedFromSmaj_ret_READ_FAIL;
+      }
+      if (row_target != genovec) {
+        CopyNyparrNonemptySubset(raw_genovec, variant_include, variant_uidx_end, variant_ct, genovec);
+      }
+      if (flip_mask) {
+        for (uint32_t widx = 0; widx != variant_ctl2; ++widx) {
+          // flip high bit iff low bit is unset, as in GenovecInvertUnsafe()
+          const uintptr_t cur_word = genovec[widx];
+          genovec[widx] = cur_word ^ ((~(cur_word << 1)) & flip_mask[widx]);
+        }
+      }
+      PgrPlink2ToPlink1InplaceUnsafe(variant_ct, genovec);
+      ZeroTrailingNyps(variant_ct, genovec);
+      fwrite_unlocked(genovec, variant_ct4, 1, outfile);
+      if (sample_idx >= next_print_idx) {
+        if (pct > 10) {
+          putc_unlocked('\b', stdout);
+        }
+        pct = (sample_idx * 100LLU) / sample_ct;
+        printf("\b\b%u%%", pct++);
+        fflush(stdout);
+        next_print_idx = (pct * S_CAST(uint64_t, sample_ct)) / 100;
+      }
+    }
+    if (unlikely(ferror_unlocked(outfile))) {
+      goto IndMajorBedFromSmaj_ret_WRITE_FAIL;
+    }
+    if (pct > 10) {
+      putc_unlocked('\b', stdout);
+    }
+    fputs("\b\bdone.\n", stdout);
+    logprintfww("--export ind-major-bed: Hardcalls loaded from %s.\n", smaj_fname);
+    *smaj_used_ptr = 1;
+  }
+  while (0) {
+  IndMajorBedFromSmaj_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  IndMajorBedFromSmaj_ret_READ_FAIL:
+    putc_unlocked('\n', stdout);
+    logerrprintfww(kErrprintfFread, smaj_fname, rstrerror(errno));
+    reterr = kPglRetReadFail;
+    break;
+  IndMajorBedFromSmaj_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+ IndMajorBedFromSmaj_ret_1:
+  CleanupSmaj(&smaj, &reterr);
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
+PglErr ExportIndMajorBed(const uintptr_t* orig_sample_include, const uintptr_t* variant_include, const uintptr_t* allele_idx_offsets, const AlleleCode* allele_permute, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, const char* pgenname, PgenFileInfo* pgfip, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   FILE* outfile = nullptr;
   PglErr reterr = kPglRetSuccess;
@@ -191,7 +336,14 @@ PglErr ExportIndMajorBed(const uintptr_t* orig_sample_include, const uintptr_t*
     if (unlikely(!fwrite_unlocked("l\x1b", 3, 1, outfile))) {
       goto ExportIndMajorBed_ret_WRITE_FAIL;
     }
-    if (variant_ct && sample_ct) {
+    uint32_t smaj_used = 0;
+    if (variant_ct && sample_ct && pgenname[0]) {
+      reterr = IndMajorBedFromSmaj(orig_sample_include, variant_include, allele_idx_offsets, allele_permute, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, pgenname, outfile, &smaj_used);
+      if (unlikely(reterr)) {
+        goto ExportIndMajorBed_ret_1;
+      }
+    }
+    if (variant_ct && sample_ct && (!smaj_used)) {
       const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
       uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
       // todo: if only 1 pass is needed, and no subsetting is happening, this
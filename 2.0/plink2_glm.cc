@@ -1956,6 +1956,28 @@ void SexInteractionReshuffle(uint32_t first_interaction_pred_uidx, uint32_t raw_
   memcpy(parameters_or_tests, parameter_subset_reshuffle_buf, biallelic_raw_predictor_ctl * sizeof(intptr_t));
 }
 
+void GlmMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, uint32_t pheno_ct, uint32_t covar_ct, GlmFlags glm_flags, uint32_t max_thread_ct, MemReq* mrp) {
+  uint32_t calc_thread_ct = (max_thread_ct > 8)? (max_thread_ct - 1) : max_thread_ct;
+  if (calc_thread_ct > variant_ct) {
+    calc_thread_ct = variant_ct;
+  }
+  const uint32_t domdev_present = (glm_flags & (kfGlmGenotypic | kfGlmHethom)) != kfGlm0;
+  // intercept, additive (and dominance-deviation) term, covariates
+  const uint32_t biallelic_predictor_ct = 2 + domdev_present + covar_ct;
+  const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
+  uintptr_t workspace_alloc = GetLinearWorkspaceSize(sample_ct, biallelic_predictor_ct, 0, 0, 0, max_returned_difflist_len);
+  const uint32_t is_sometimes_firth = !(glm_flags & kfGlmNoFirth);
+  const uintptr_t logistic_workspace_alloc = GetLogisticWorkspaceSizeD(sample_ct, biallelic_predictor_ct, domdev_present + 1, 0, 0, 0, 0, is_sometimes_firth, 0);
+  if (logistic_workspace_alloc > workspace_alloc) {
+    workspace_alloc = logistic_workspace_alloc;
+  }
+  PgenMtLoadMemReq(sample_ct, variant_ct, record_byte_ct, calc_thread_ct, workspace_alloc + kCacheline, 2 * biallelic_predictor_ct * sizeof(double), mrp);
+  // phenotype/covariate matrices, plus per-variant result buffers
+  const uint64_t base_byte_ct = S_CAST(uint64_t, sample_ct) * (pheno_ct + covar_ct + 1) * sizeof(double) * 2 + S_CAST(uint64_t, variant_ct) * 3 * sizeof(double);
+  mrp->min_byte_ct += base_byte_ct;
+  mrp->comfortable_byte_ct += base_byte_ct;
+}
+
 PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const PhenoCol* covar_cols, const char* covar_names, const uintptr_t* orig_variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const AlleleCode* maj_alleles, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const AdjustInfo* adjust_info_ptr, const APerm* aperm_ptr, const char* local_covar_fname, const char* local_pvar_fname, const char* local_psam_fname, const GwasSsfInfo* gsip, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t orig_covar_ct, uintptr_t max_covar_name_blen, uint32_t raw_variant_ct, uint32_t orig_variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t xchr_model, double ci_size, double vif_thresh, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
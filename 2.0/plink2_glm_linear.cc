@@ -265,6 +265,8 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
   pgv.genovec = common->genovecs[tidx];
   pgv.dosage_present = nullptr;
   pgv.dosage_main = nullptr;
+  // PgrGetDifflistOrGenovec() doesn't touch this.
+  pgv.dosage_ct = 0;
   if (common->dosage_presents) {
     pgv.dosage_present = common->dosage_presents[tidx];
     pgv.dosage_main = common->dosage_mains[tidx];
@@ -276,7 +278,6 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
   const uintptr_t* sex_male_collapsed = common->sex_male_collapsed;
   const ChrInfo* cip = common->cip;
   const uint32_t* subset_chr_fo_vidx_start = common->subset_chr_fo_vidx_start;
-  const uint32_t calc_thread_ct = GetThreadCt(arg->sharedp);
   const GlmFlags glm_flags = common->glm_flags;
   const uint32_t add_interactions = (glm_flags / kfGlmInteraction) & 1;
   const uint32_t hide_covar = (glm_flags / kfGlmHideCovar) & 1;
@@ -334,1270 +335,1289 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
   uint64_t new_err_info = 0;
   do {
     const uintptr_t cur_block_variant_ct = common->cur_block_variant_ct;
-    uint32_t variant_bidx = (tidx * cur_block_variant_ct) / calc_thread_ct;
-    const uint32_t variant_bidx_end = ((tidx + 1) * cur_block_variant_ct) / calc_thread_ct;
-    uintptr_t variant_uidx_base;
-    uintptr_t variant_include_bits;
-    BitIter1Start(variant_include, common->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
-
-    uintptr_t allele_bidx = variant_bidx;
-    if (max_extra_allele_ct) {
-      allele_bidx = variant_bidx + CountExtraAlleles(variant_include, allele_idx_offsets, common->read_variant_uidx_starts[0], common->read_variant_uidx_starts[tidx], 0);
-    }
-    double* beta_se_iter = common->block_beta_se;
-    if (beta_se_multiallelic_fused) {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
-    } else {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
-    }
+    const uint32_t block_uidx_start = common->read_variant_uidx_starts[0];
+    uint32_t task_bidx_start;
+    uint32_t variant_bidx_end;
+    // Tasks taken from our own range arrive in increasing order, so the
+    // variant_include scan resumes from the previous task start unless we
+    // just stole an earlier range.
+    uint32_t prev_task_bidx_start = 0;
+    uint32_t prev_task_uidx_start = block_uidx_start;
+    uintptr_t prev_task_extra_allele_ct = 0;
+    while (TaskDequesNext(tidx, &common->tdq, &task_bidx_start, &variant_bidx_end)) {
+      uint32_t variant_bidx = task_bidx_start;
+      if (task_bidx_start < prev_task_bidx_start) {
+        prev_task_bidx_start = 0;
+        prev_task_uidx_start = block_uidx_start;
+        prev_task_extra_allele_ct = 0;
+      }
+      const uint32_t task_uidx_start = FindNth1BitFrom(variant_include, prev_task_uidx_start, task_bidx_start - prev_task_bidx_start + 1);
+      uintptr_t variant_uidx_base;
+      uintptr_t variant_include_bits;
+      BitIter1Start(variant_include, task_uidx_start, &variant_uidx_base, &variant_include_bits);
 
-    LinearAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
-    const double* local_covars_iter = nullptr;
-    if (local_covar_ct) {
-      // &(nullptr[0]) is okay in C++, but undefined in C
-      local_covars_iter = &(ctx->local_covars_vcmaj_d[parity][variant_bidx * max_sample_ct * local_covar_ct]);
-    }
-    while (variant_bidx < variant_bidx_end) {
-      const uint32_t variant_idx = variant_bidx + variant_idx_offset;
-      const uint32_t chr_fo_idx = LastLeqU32(subset_chr_fo_vidx_start, 0, cip->chr_ct, variant_idx);
-      // const uint32_t chr_fo_idx = LowerBoundNonemptyU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
-      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
-      uint32_t cur_variant_bidx_end = subset_chr_fo_vidx_start[chr_fo_idx + 1] - variant_idx_offset;
-      if (cur_variant_bidx_end > variant_bidx_end) {
-        cur_variant_bidx_end = variant_bidx_end;
+      uintptr_t allele_bidx = variant_bidx;
+      if (max_extra_allele_ct) {
+        prev_task_extra_allele_ct += CountExtraAlleles(variant_include, allele_idx_offsets, prev_task_uidx_start, task_uidx_start, 0);
+        allele_bidx = variant_bidx + prev_task_extra_allele_ct;
       }
-      const uint32_t is_haploid = IsSet(cip->haploid_mask, chr_idx);
-      const uint32_t is_regular_x = is_haploid && (chr_idx == x_code);
-      const uint32_t is_y = (chr_idx == y_code);
-      const uint32_t is_nonx_haploid = is_haploid && (!is_regular_x);
-      const uintptr_t* cur_sample_include;
-      const uint32_t* cur_sample_include_cumulative_popcounts;
-      const double* cur_pheno;
-      const RegressionNmPrecomp* nm_precomp;
-      const double* cur_covars_cmaj;
-      const uintptr_t* cur_parameter_subset;
-      const uintptr_t* cur_joint_test_params;
-      uint32_t cur_sample_ct;
-      uint32_t cur_covar_ct;
-      uint32_t cur_constraint_ct;
-      if (is_y && common->sample_include_y) {
-        cur_sample_include = common->sample_include_y;
-        cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
-        cur_pheno = ctx->pheno_y_d;
-        nm_precomp = common->nm_precomp_y;
-        cur_covars_cmaj = ctx->covars_cmaj_y_d;
-        cur_parameter_subset = common->parameter_subset_y;
-        cur_joint_test_params = common->joint_test_params_y;
-        cur_sample_ct = common->sample_ct_y;
-        cur_covar_ct = common->covar_ct_y;
-        cur_constraint_ct = common->constraint_ct_y;
-      } else if (is_regular_x && common->sample_include_x) {
-        cur_sample_include = common->sample_include_x;
-        cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
-        cur_pheno = ctx->pheno_x_d;
-        nm_precomp = common->nm_precomp_x;
-        cur_covars_cmaj = ctx->covars_cmaj_x_d;
-        cur_parameter_subset = common->parameter_subset_x;
-        cur_joint_test_params = common->joint_test_params_x;
-        cur_sample_ct = common->sample_ct_x;
-        cur_covar_ct = common->covar_ct_x;
-        cur_constraint_ct = common->constraint_ct_x;
+      prev_task_bidx_start = task_bidx_start;
+      prev_task_uidx_start = task_uidx_start;
+      double* beta_se_iter = common->block_beta_se;
+      if (beta_se_multiallelic_fused) {
+        beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
       } else {
-        cur_sample_include = common->sample_include;
-        cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
-        cur_pheno = ctx->pheno_d;
-        nm_precomp = common->nm_precomp;
-        cur_covars_cmaj = ctx->covars_cmaj_d;
-        cur_parameter_subset = common->parameter_subset;
-        cur_joint_test_params = common->joint_test_params;
-        cur_sample_ct = common->sample_ct;
-        cur_covar_ct = common->covar_ct;
-        cur_constraint_ct = common->constraint_ct;
+        beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
       }
-      const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
-      const uint32_t sample_ctl2 = NypCtToWordCt(cur_sample_ct);
-      const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
-      uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
-      uint32_t literal_covar_ct = cur_covar_ct;
-      if (cur_parameter_subset) {
-        cur_biallelic_predictor_ct = PopcountWords(cur_parameter_subset, BitCtToWordCt(cur_biallelic_predictor_ct_base));
-        literal_covar_ct = PopcountBitRange(cur_parameter_subset, 2 + domdev_present, 2 + domdev_present + cur_covar_ct);
+
+      LinearAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
+      const double* local_covars_iter = nullptr;
+      if (local_covar_ct) {
+        // &(nullptr[0]) is okay in C++, but undefined in C
+        local_covars_iter = &(ctx->local_covars_vcmaj_d[parity][variant_bidx * max_sample_ct * local_covar_ct]);
       }
-      const uint32_t max_predictor_ct = cur_biallelic_predictor_ct + max_extra_allele_ct;
-      uint32_t reported_pred_uidx_biallelic_end;
-      if (hide_covar) {
-        if (!cur_parameter_subset) {
-          reported_pred_uidx_biallelic_end = 2 + domdev_present;
+      while (variant_bidx < variant_bidx_end) {
+        const uint32_t variant_idx = variant_bidx + variant_idx_offset;
+        const uint32_t chr_fo_idx = LastLeqU32(subset_chr_fo_vidx_start, 0, cip->chr_ct, variant_idx);
+        // const uint32_t chr_fo_idx = LowerBoundNonemptyU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
+        const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+        uint32_t cur_variant_bidx_end = subset_chr_fo_vidx_start[chr_fo_idx + 1] - variant_idx_offset;
+        if (cur_variant_bidx_end > variant_bidx_end) {
+          cur_variant_bidx_end = variant_bidx_end;
+        }
+        const uint32_t is_haploid = IsSet(cip->haploid_mask, chr_idx);
+        const uint32_t is_regular_x = is_haploid && (chr_idx == x_code);
+        const uint32_t is_y = (chr_idx == y_code);
+        const uint32_t is_nonx_haploid = is_haploid && (!is_regular_x);
+        const uintptr_t* cur_sample_include;
+        const uint32_t* cur_sample_include_cumulative_popcounts;
+        const double* cur_pheno;
+        const RegressionNmPrecomp* nm_precomp;
+        const double* cur_covars_cmaj;
+        const uintptr_t* cur_parameter_subset;
+        const uintptr_t* cur_joint_test_params;
+        uint32_t cur_sample_ct;
+        uint32_t cur_covar_ct;
+        uint32_t cur_constraint_ct;
+        if (is_y && common->sample_include_y) {
+          cur_sample_include = common->sample_include_y;
+          cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
+          cur_pheno = ctx->pheno_y_d;
+          nm_precomp = common->nm_precomp_y;
+          cur_covars_cmaj = ctx->covars_cmaj_y_d;
+          cur_parameter_subset = common->parameter_subset_y;
+          cur_joint_test_params = common->joint_test_params_y;
+          cur_sample_ct = common->sample_ct_y;
+          cur_covar_ct = common->covar_ct_y;
+          cur_constraint_ct = common->constraint_ct_y;
+        } else if (is_regular_x && common->sample_include_x) {
+          cur_sample_include = common->sample_include_x;
+          cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
+          cur_pheno = ctx->pheno_x_d;
+          nm_precomp = common->nm_precomp_x;
+          cur_covars_cmaj = ctx->covars_cmaj_x_d;
+          cur_parameter_subset = common->parameter_subset_x;
+          cur_joint_test_params = common->joint_test_params_x;
+          cur_sample_ct = common->sample_ct_x;
+          cur_covar_ct = common->covar_ct_x;
+          cur_constraint_ct = common->constraint_ct_x;
         } else {
-          reported_pred_uidx_biallelic_end = IsSet(cur_parameter_subset, 1) + domdev_present_p1;
+          cur_sample_include = common->sample_include;
+          cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
+          cur_pheno = ctx->pheno_d;
+          nm_precomp = common->nm_precomp;
+          cur_covars_cmaj = ctx->covars_cmaj_d;
+          cur_parameter_subset = common->parameter_subset;
+          cur_joint_test_params = common->joint_test_params;
+          cur_sample_ct = common->sample_ct;
+          cur_covar_ct = common->covar_ct;
+          cur_constraint_ct = common->constraint_ct;
         }
-      } else {
-        reported_pred_uidx_biallelic_end = cur_biallelic_predictor_ct;
-      }
-      // nm_predictors_pmaj_buf may require up to two extra columns omitted
-      // from the main regression.
-      // 1. In the multiallelic dominant/recessive/hetonly/hethom cases, the
-      //    original genotype column does not appear in the regression, and
-      //    we'd rather not reconstruct it from genovec, etc. when we need to
-      //    swap it out for another allele, so we keep the original genotype in
-      //    an extra column.
-      //    To reduce code bloat, we now handle the biallelic cases in the same
-      //    way; this is one of the more peripheral code paths so adding more
-      //    complexity to speed it up is less justifiable.
-      // 2. If --parameters excludes the main (possibly
-      //    dominant/recessive/hetonly) genotype column but does care about an
-      //    interaction, we want a copy of what the main genotype column's
-      //    contents would have been to refer to.
-      const uint32_t main_omitted = cur_parameter_subset && (!IsSet(cur_parameter_subset, 1));
-      const uint32_t main_mutated = model_dominant || model_recessive || model_hetonly || joint_hethom;
-      unsigned char* workspace_iter = workspace_buf;
-      uintptr_t* sample_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      uintptr_t* tmp_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      double* nm_pheno_buf = S_CAST(double*, arena_alloc_raw_rd(cur_sample_ct * sizeof(double), &workspace_iter));
-      double* nm_predictors_pmaj_buf = S_CAST(double*, arena_alloc_raw_rd((max_predictor_ct + main_mutated + main_omitted) * cur_sample_ct * sizeof(double), &workspace_iter));
-      double* xtx_inv = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ct * sizeof(double), &workspace_iter));
-      double* fitted_coefs = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * sizeof(double), &workspace_iter));
-      double* xt_y = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * sizeof(double), &workspace_iter));
-      double* semicomputed_biallelic_corr_matrix = S_CAST(double*, arena_alloc_raw_rd((cur_biallelic_predictor_ct - 1) * (cur_biallelic_predictor_ct - 1) * sizeof(double), &workspace_iter));
-      double* semicomputed_biallelic_inv_corr_sqrts = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
-      MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, arena_alloc_raw_rd(MAXV(max_predictor_ct, cur_constraint_ct) * kMatrixInvertBuf1CheckedAlloc, &workspace_iter));
-      double* dbl_2d_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * MAXV(max_predictor_ct, 7) * sizeof(double), &workspace_iter));
-      uint64_t* machr2_dosage_sums = S_CAST(uint64_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(uint64_t) * 2, &workspace_iter));
-      uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
+        const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
+        const uint32_t sample_ctl2 = NypCtToWordCt(cur_sample_ct);
+        const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
+        uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
+        uint32_t literal_covar_ct = cur_covar_ct;
+        if (cur_parameter_subset) {
+          cur_biallelic_predictor_ct = PopcountWords(cur_parameter_subset, BitCtToWordCt(cur_biallelic_predictor_ct_base));
+          literal_covar_ct = PopcountBitRange(cur_parameter_subset, 2 + domdev_present, 2 + domdev_present + cur_covar_ct);
+        }
+        const uint32_t max_predictor_ct = cur_biallelic_predictor_ct + max_extra_allele_ct;
+        uint32_t reported_pred_uidx_biallelic_end;
+        if (hide_covar) {
+          if (!cur_parameter_subset) {
+            reported_pred_uidx_biallelic_end = 2 + domdev_present;
+          } else {
+            reported_pred_uidx_biallelic_end = IsSet(cur_parameter_subset, 1) + domdev_present_p1;
+          }
+        } else {
+          reported_pred_uidx_biallelic_end = cur_biallelic_predictor_ct;
+        }
+        // nm_predictors_pmaj_buf may require up to two extra columns omitted
+        // from the main regression.
+        // 1. In the multiallelic dominant/recessive/hetonly/hethom cases, the
+        //    original genotype column does not appear in the regression, and
+        //    we'd rather not reconstruct it from genovec, etc. when we need to
+        //    swap it out for another allele, so we keep the original genotype in
+        //    an extra column.
+        //    To reduce code bloat, we now handle the biallelic cases in the same
+        //    way; this is one of the more peripheral code paths so adding more
+        //    complexity to speed it up is less justifiable.
+        // 2. If --parameters excludes the main (possibly
+        //    dominant/recessive/hetonly) genotype column but does care about an
+        //    interaction, we want a copy of what the main genotype column's
+        //    contents would have been to refer to.
+        const uint32_t main_omitted = cur_parameter_subset && (!IsSet(cur_parameter_subset, 1));
+        const uint32_t main_mutated = model_dominant || model_recessive || model_hetonly || joint_hethom;
+        unsigned char* workspace_iter = workspace_buf;
+        uintptr_t* sample_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        uintptr_t* tmp_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        double* nm_pheno_buf = S_CAST(double*, arena_alloc_raw_rd(cur_sample_ct * sizeof(double), &workspace_iter));
+        double* nm_predictors_pmaj_buf = S_CAST(double*, arena_alloc_raw_rd((max_predictor_ct + main_mutated + main_omitted) * cur_sample_ct * sizeof(double), &workspace_iter));
+        double* xtx_inv = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ct * sizeof(double), &workspace_iter));
+        double* fitted_coefs = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * sizeof(double), &workspace_iter));
+        double* xt_y = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * sizeof(double), &workspace_iter));
+        double* semicomputed_biallelic_corr_matrix = S_CAST(double*, arena_alloc_raw_rd((cur_biallelic_predictor_ct - 1) * (cur_biallelic_predictor_ct - 1) * sizeof(double), &workspace_iter));
+        double* semicomputed_biallelic_inv_corr_sqrts = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+        MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, arena_alloc_raw_rd(MAXV(max_predictor_ct, cur_constraint_ct) * kMatrixInvertBuf1CheckedAlloc, &workspace_iter));
+        double* dbl_2d_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * MAXV(max_predictor_ct, 7) * sizeof(double), &workspace_iter));
+        uint64_t* machr2_dosage_sums = S_CAST(uint64_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(uint64_t) * 2, &workspace_iter));
+        uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
 
-      // could technically have this overlap fitted_coefs/xt_y, but that sets
-      // the stage for future bugs
-      double* inverse_corr_buf = S_CAST(double*, arena_alloc_raw_rd((max_predictor_ct - 1) * MAXV((max_predictor_ct - 1), 4) * sizeof(double), &workspace_iter));
+        // could technically have this overlap fitted_coefs/xt_y, but that sets
+        // the stage for future bugs
+        double* inverse_corr_buf = S_CAST(double*, arena_alloc_raw_rd((max_predictor_ct - 1) * MAXV((max_predictor_ct - 1), 4) * sizeof(double), &workspace_iter));
 
-      const uint32_t sparse_optimization_eligible = (!is_regular_x) && nm_precomp;
-      // Only try to load difflist in no-covariate no-dosage biallelic case,
-      // where sparse_optimization is guaranteed to be true.
-      const uint32_t difflist_eligible = sparse_optimization_eligible && (!pgv.dosage_present) && (!cur_covar_ct);
-      uintptr_t* raregeno = nullptr;
-      uint32_t* difflist_sample_ids = nullptr;
-      if (difflist_eligible) {
-        max_sparse = cur_sample_ct / kPglMaxDifflistLenDivisor;
-        const uint32_t max_returned_difflist_len = ctx->max_returned_difflist_len;
-        raregeno = S_CAST(uintptr_t*, arena_alloc_raw(DivUp(max_returned_difflist_len, kNypsPerCacheline) * kCacheline, &workspace_iter));
-        difflist_sample_ids = S_CAST(uint32_t*, arena_alloc_raw(DivUp(max_returned_difflist_len, kInt32PerCacheline) * kCacheline, &workspace_iter));
-      }
+        const uint32_t sparse_optimization_eligible = (!is_regular_x) && nm_precomp;
+        // Only try to load difflist in no-covariate no-dosage biallelic case,
+        // where sparse_optimization is guaranteed to be true.
+        const uint32_t difflist_eligible = sparse_optimization_eligible && (!pgv.dosage_present) && (!cur_covar_ct);
+        uintptr_t* raregeno = nullptr;
+        uint32_t* difflist_sample_ids = nullptr;
+        if (difflist_eligible) {
+          max_sparse = cur_sample_ct / kPglMaxDifflistLenDivisor;
+          const uint32_t max_returned_difflist_len = ctx->max_returned_difflist_len;
+          raregeno = S_CAST(uintptr_t*, arena_alloc_raw(DivUp(max_returned_difflist_len, kNypsPerCacheline) * kCacheline, &workspace_iter));
+          difflist_sample_ids = S_CAST(uint32_t*, arena_alloc_raw(DivUp(max_returned_difflist_len, kInt32PerCacheline) * kCacheline, &workspace_iter));
+        }
 
-      // joint test only
-      double* tmphxs_buf = nullptr;
-      double* h_transpose_buf = nullptr;
-      double* inner_buf = nullptr;
-      double* cur_constraints_con_major = nullptr;
-      if (cur_constraint_ct) {
-        tmphxs_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
-        h_transpose_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
-        inner_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * cur_constraint_ct * sizeof(double), &workspace_iter));
-        cur_constraints_con_major = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
-        ZeroDArr(cur_constraint_ct * max_predictor_ct, cur_constraints_con_major);
-        const uint32_t first_joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-        cur_constraints_con_major[first_joint_test_idx] = 1.0;
-        // Rest of this matrix must be updated later, since cur_predictor_ct
-        // changes at multiallelic variants.
-      }
-      // <= instead of == since WorkspaceSize doesn't exclude difflist space on
-      // chrX
-      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) <= GetLinearWorkspaceSize(cur_sample_ct, cur_biallelic_predictor_ct, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, ctx->max_returned_difflist_len));
-      const double pheno_ssq_base = DotprodD(cur_pheno, cur_pheno, cur_sample_ct);
-      const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
-      const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
-      double geno_d_lookup[2];
-      if (sparse_optimization_eligible) {
-        if (model_hetonly) {
-          geno_d_lookup[0] = 1.0;
-          geno_d_lookup[1] = 0.0;
-        } else {
-          geno_d_lookup[1] = 1.0;
-          if (is_nonx_haploid) {
-            geno_d_lookup[0] = 0.5;
-          } else if (model_recessive || joint_hethom) {
-            geno_d_lookup[0] = 0.0;
-          } else {
+        // joint test only
+        double* tmphxs_buf = nullptr;
+        double* h_transpose_buf = nullptr;
+        double* inner_buf = nullptr;
+        double* cur_constraints_con_major = nullptr;
+        if (cur_constraint_ct) {
+          tmphxs_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
+          h_transpose_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
+          inner_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * cur_constraint_ct * sizeof(double), &workspace_iter));
+          cur_constraints_con_major = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
+          ZeroDArr(cur_constraint_ct * max_predictor_ct, cur_constraints_con_major);
+          const uint32_t first_joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+          cur_constraints_con_major[first_joint_test_idx] = 1.0;
+          // Rest of this matrix must be updated later, since cur_predictor_ct
+          // changes at multiallelic variants.
+        }
+        // <= instead of == since WorkspaceSize doesn't exclude difflist space on
+        // chrX
+        assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) <= GetLinearWorkspaceSize(cur_sample_ct, cur_biallelic_predictor_ct, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, ctx->max_returned_difflist_len));
+        const double pheno_ssq_base = DotprodD(cur_pheno, cur_pheno, cur_sample_ct);
+        const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
+        const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
+        double geno_d_lookup[2];
+        if (sparse_optimization_eligible) {
+          if (model_hetonly) {
             geno_d_lookup[0] = 1.0;
-            if (!model_dominant) {
-              geno_d_lookup[1] = 2.0;
+            geno_d_lookup[1] = 0.0;
+          } else {
+            geno_d_lookup[1] = 1.0;
+            if (is_nonx_haploid) {
+              geno_d_lookup[0] = 0.5;
+            } else if (model_recessive || joint_hethom) {
+              geno_d_lookup[0] = 0.0;
+            } else {
+              geno_d_lookup[0] = 1.0;
+              if (!model_dominant) {
+                geno_d_lookup[1] = 2.0;
+              }
             }
           }
         }
-      }
-      const double* xtx_image = nullptr;
-      const double* covarx_dotprod_inv = nullptr;
-      const double* corr_inv = nullptr;
-      const double* xt_y_image = nullptr;
-      if (nm_precomp) {
-        xtx_image = nm_precomp->xtx_image;
-        covarx_dotprod_inv = nm_precomp->covarx_dotprod_inv;
-        corr_inv = nm_precomp->corr_inv;
-        const uintptr_t nongeno_pred_ct = cur_biallelic_predictor_ct - domdev_present - 2;
-        const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
-        memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
-        memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
-        xt_y_image = nm_precomp->xt_y_image;
-      }
-      PgrSampleSubsetIndex pssi;
-      PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
-      // when this is set, the last fully-processed variant had no missing
-      // genotypes, and if the current variant also has no missing genotypes we
-      // may be able to skip reinitialization of most of
-      // nm_predictors_pmaj_buf.
-      uint32_t prev_nm = 0;
-      uint32_t prev_nm_sample_ct = 0;
+        const double* xtx_image = nullptr;
+        const double* covarx_dotprod_inv = nullptr;
+        const double* corr_inv = nullptr;
+        const double* xt_y_image = nullptr;
+        if (nm_precomp) {
+          xtx_image = nm_precomp->xtx_image;
+          covarx_dotprod_inv = nm_precomp->covarx_dotprod_inv;
+          corr_inv = nm_precomp->corr_inv;
+          const uintptr_t nongeno_pred_ct = cur_biallelic_predictor_ct - domdev_present - 2;
+          const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
+          memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
+          memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
+          xt_y_image = nm_precomp->xt_y_image;
+        }
+        PgrSampleSubsetIndex pssi;
+        PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
+        // when this is set, the last fully-processed variant had no missing
+        // genotypes, and if the current variant also has no missing genotypes we
+        // may be able to skip reinitialization of most of
+        // nm_predictors_pmaj_buf.
+        uint32_t prev_nm = 0;
+        uint32_t prev_nm_sample_ct = 0;
 
-      STD_ARRAY_DECL(uint32_t, 4, genocounts);
-      for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
-        const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
-        // DPrintf("\nWorker thread %" PRIuPTR " starting unfiltered variant %u", tidx, variant_uidx);
-        if (allele_idx_offsets) {
-          allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
-          if (!beta_se_multiallelic_fused) {
-            extra_regression_ct = allele_ct - 2;
+        STD_ARRAY_DECL(uint32_t, 4, genocounts);
+        for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
+          const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
+          // DPrintf("\nWorker thread %" PRIuPTR " starting unfiltered variant %u", tidx, variant_uidx);
+          if (allele_idx_offsets) {
+            allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
+            if (!beta_se_multiallelic_fused) {
+              extra_regression_ct = allele_ct - 2;
+            }
           }
-        }
-        const uint32_t allele_ct_m2 = allele_ct - 2;
-        const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
-        uint32_t difflist_common_geno = UINT32_MAX;
-        PglErr reterr;
-        if (!allele_ct_m2) {
-          if (difflist_eligible) {
-            reterr = PgrGetDifflistOrGenovec(cur_sample_include, pssi, cur_sample_ct, max_sparse, variant_uidx, pgrp, pgv.genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+          const uint32_t allele_ct_m2 = allele_ct - 2;
+          const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
+          uint32_t difflist_common_geno = UINT32_MAX;
+          PglErr reterr;
+          if (!allele_ct_m2) {
+            if (difflist_eligible) {
+              reterr = PgrGetDifflistOrGenovec(cur_sample_include, pssi, cur_sample_ct, max_sparse, variant_uidx, pgrp, pgv.genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+            } else {
+              reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+            }
           } else {
-            reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+            reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
+            // todo: proper multiallelic dosage support
           }
-        } else {
-          reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
-          // todo: proper multiallelic dosage support
-        }
-        if (unlikely(reterr)) {
-          new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-          goto GlmLinearThread_err;
-        }
-        if (omitted_alleles) {
-          omitted_allele_idx = omitted_alleles[variant_uidx];
-        }
-        uint32_t missing_ct;
-        if (difflist_common_geno == 2 * omitted_allele_idx) {
-          ZeroTrailingNyps(difflist_len, raregeno);
-          GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
-          genocounts[difflist_common_geno] = cur_sample_ct - difflist_len;
-          missing_ct = genocounts[3];
-          // no need to set sample_nm
-        } else {
-          if (difflist_common_geno <= 2) {
-            PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, cur_sample_ct, difflist_len, pgv.genovec);
-            difflist_common_geno = UINT32_MAX;
+          if (unlikely(reterr)) {
+            new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+            goto GlmLinearThread_err;
           }
-          ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-          GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
-          missing_ct = genocounts[3];
-          if (!missing_ct) {
-            SetAllBits(cur_sample_ct, sample_nm);
+          if (omitted_alleles) {
+            omitted_allele_idx = omitted_alleles[variant_uidx];
+          }
+          uint32_t missing_ct;
+          if (difflist_common_geno == 2 * omitted_allele_idx) {
+            ZeroTrailingNyps(difflist_len, raregeno);
+            GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
+            genocounts[difflist_common_geno] = cur_sample_ct - difflist_len;
+            missing_ct = genocounts[3];
+            // no need to set sample_nm
           } else {
-            GenoarrToNonmissing(pgv.genovec, cur_sample_ct, sample_nm);
-            if (pgv.dosage_ct) {
-              BitvecOr(pgv.dosage_present, sample_ctl, sample_nm);
-              missing_ct = cur_sample_ct - PopcountWords(sample_nm, sample_ctl);
+            if (difflist_common_geno <= 2) {
+              PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, cur_sample_ct, difflist_len, pgv.genovec);
+              difflist_common_geno = UINT32_MAX;
             }
-          }
-        }
-        uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
-        const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
-        ZeroWArr(allele_ctl, const_alleles);
-        const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
-        const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
-        // first predictor column: intercept
-        if (!prev_nm) {
-          assert((!prev_nm_sample_ct) || (nm_predictors_pmaj_buf[prev_nm_sample_ct - 1] == 1.0));
-          for (uint32_t sample_idx = prev_nm_sample_ct; sample_idx < nm_sample_ct; ++sample_idx) {
-            nm_predictors_pmaj_buf[sample_idx] = 1.0;
-          }
-        }
-        prev_nm_sample_ct = nm_sample_ct;
-        // second predictor column: main genotype
-        double* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ct]);
-        if (main_mutated || main_omitted) {
-          genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ct]);
-        }
-        double cur_pheno_ssq = pheno_ssq_base;
-        if (missing_ct) {
-          if (difflist_common_geno != UINT32_MAX) {
-            const uint32_t raregeno_word_ct = NypCtToWordCt(difflist_len);
-            for (uint32_t widx = 0; widx != raregeno_word_ct; ++widx) {
-              uintptr_t missing_word = raregeno[widx];
-              missing_word = missing_word & (missing_word >> 1) & kMask5555;
-              if (!missing_word) {
-                continue;
-              }
-              const uint32_t* cur_difflist_sample_ids = &(difflist_sample_ids[widx * kBitsPerWordD2]);
-              do {
-                const uint32_t difflist_idx = ctzw(missing_word) / 2;
-                const uint32_t sample_idx = cur_difflist_sample_ids[difflist_idx];
-                cur_pheno_ssq -= cur_pheno[sample_idx] * cur_pheno[sample_idx];
-                missing_word &= missing_word - 1;
-              } while (missing_word);
-            }
-          } else {
-            uintptr_t sample_midx_base = 0;
-            uintptr_t sample_nm_inv_bits = ~sample_nm[0];
-            for (uint32_t missing_idx = 0; missing_idx != missing_ct; ++missing_idx) {
-              const uintptr_t sample_midx = BitIter0(sample_nm, &sample_midx_base, &sample_nm_inv_bits);
-              cur_pheno_ssq -= cur_pheno[sample_midx] * cur_pheno[sample_midx];
-            }
-          }
-        }
-        uint32_t sparse_optimization = 0;
-        double* multi_start = nullptr;
-        if (!allele_ct_m2) {
-          // When there are no dosages, and either:
-          //   prev_nm is set and missing_ct is zero, or
-          //   there are no covariates,
-          // we don't need to call MultiplySelfTranspose() on
-          // nm_predictors_pmaj_buf to get all the predictor x predictor dot
-          // products; instead we patch in the genotype x predictor dot
-          // products that may change, copying the rest from xtx_image.
-          // As a side effect, it is no longer strictly necessary to fill the
-          // genotype row of nm_predictors_pmaj_buf.  sparse_optimization
-          // indicates that plink 1.9's QT --assoc sparse dot product algorithm
-          // will be used instead.
-          // probable todos: allow a few dosages to be present, cover chrX
-          // case.
-          if (omitted_allele_idx) {
-            if (difflist_common_geno != UINT32_MAX) {
-              assert(difflist_common_geno == 2);
-              GenovecInvertUnsafe(difflist_len, raregeno);
-              ZeroTrailingNyps(difflist_len, raregeno);
-              difflist_common_geno = 0;
+            ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+            GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+            missing_ct = genocounts[3];
+            if (!missing_ct) {
+              SetAllBits(cur_sample_ct, sample_nm);
             } else {
-              GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
-              ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+              GenoarrToNonmissing(pgv.genovec, cur_sample_ct, sample_nm);
               if (pgv.dosage_ct) {
-                BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
+                BitvecOr(pgv.dosage_present, sample_ctl, sample_nm);
+                missing_ct = cur_sample_ct - PopcountWords(sample_nm, sample_ctl);
               }
             }
-            const uint32_t uii = genocounts[0];
-            genocounts[0] = genocounts[2];
-            genocounts[2] = uii;
           }
-          uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
-          uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
-          if (!missing_ct) {
-            // originally had genocounts[0] > 0.875 * nm_sample_ct threshold,
-            // but then tried this on high-MAF data and it was still
-            // substantially faster
-            sparse_optimization = sparse_optimization_eligible && (!pgv.dosage_ct) && (prev_nm || (!cur_covar_ct));
-            if (!sparse_optimization) {
-              GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, genotype_vals);
-              if (pgv.dosage_ct) {
-                uintptr_t sample_idx_base = 0;
-                uintptr_t dosage_present_bits = pgv.dosage_present[0];
-                for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                  const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
-                  const uintptr_t dosage_val = pgv.dosage_main[dosage_idx];
-                  // 32768 -> 2, 16384 -> 1, 0 -> 0
-                  genotype_vals[sample_idx] = kRecipDosageMid * swtod(dosage_val);
-                  dosage_sum += dosage_val;
-                  dosage_ssq += dosage_val * dosage_val;
-                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
-                  if (cur_geno && (cur_geno != 3)) {
-                    const uintptr_t prev_val = cur_geno * kDosageMid;
-                    dosage_sum -= prev_val;
-                    dosage_ssq -= prev_val * prev_val;
-                  }
-                }
-              }
+          uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
+          const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
+          ZeroWArr(allele_ctl, const_alleles);
+          const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
+          const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
+          // first predictor column: intercept
+          if (!prev_nm) {
+            assert((!prev_nm_sample_ct) || (nm_predictors_pmaj_buf[prev_nm_sample_ct - 1] == 1.0));
+            for (uint32_t sample_idx = prev_nm_sample_ct; sample_idx < nm_sample_ct; ++sample_idx) {
+              nm_predictors_pmaj_buf[sample_idx] = 1.0;
             }
-          } else {
-            if (!pgv.dosage_ct) {
-              sparse_optimization = sparse_optimization_eligible && (!cur_covar_ct);
-              if (!sparse_optimization) {
-                GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, genotype_vals);
+          }
+          prev_nm_sample_ct = nm_sample_ct;
+          // second predictor column: main genotype
+          double* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ct]);
+          if (main_mutated || main_omitted) {
+            genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ct]);
+          }
+          double cur_pheno_ssq = pheno_ssq_base;
+          if (missing_ct) {
+            if (difflist_common_geno != UINT32_MAX) {
+              const uint32_t raregeno_word_ct = NypCtToWordCt(difflist_len);
+              for (uint32_t widx = 0; widx != raregeno_word_ct; ++widx) {
+                uintptr_t missing_word = raregeno[widx];
+                missing_word = missing_word & (missing_word >> 1) & kMask5555;
+                if (!missing_word) {
+                  continue;
+                }
+                const uint32_t* cur_difflist_sample_ids = &(difflist_sample_ids[widx * kBitsPerWordD2]);
+                do {
+                  const uint32_t difflist_idx = ctzw(missing_word) / 2;
+                  const uint32_t sample_idx = cur_difflist_sample_ids[difflist_idx];
+                  cur_pheno_ssq -= cur_pheno[sample_idx] * cur_pheno[sample_idx];
+                  missing_word &= missing_word - 1;
+                } while (missing_word);
               }
             } else {
               uintptr_t sample_midx_base = 0;
-              uintptr_t sample_nm_bits = sample_nm[0];
-              uint32_t dosage_idx = 0;
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
-                double cur_val;
-                if (IsSet(pgv.dosage_present, sample_midx)) {
-                  const uintptr_t dosage_val = pgv.dosage_main[dosage_idx++];
-                  cur_val = kRecipDosageMid * swtod(dosage_val);
-                  dosage_sum += dosage_val;
-                  dosage_ssq += dosage_val * dosage_val;
-                  if (cur_geno && (cur_geno != 3)) {
-                    const uintptr_t prev_val = cur_geno * kDosageMid;
-                    dosage_sum -= prev_val;
-                    dosage_ssq -= prev_val * prev_val;
-                  }
-                } else {
-                  cur_val = kSmallDoubles[cur_geno];
-                }
-                genotype_vals[sample_idx] = cur_val;
+              uintptr_t sample_nm_inv_bits = ~sample_nm[0];
+              for (uint32_t missing_idx = 0; missing_idx != missing_ct; ++missing_idx) {
+                const uintptr_t sample_midx = BitIter0(sample_nm, &sample_midx_base, &sample_nm_inv_bits);
+                cur_pheno_ssq -= cur_pheno[sample_midx] * cur_pheno[sample_midx];
               }
             }
           }
-          // Check for constant genotype column.
-          // (Technically, we should recheck later in the chrX no-sex-covariate
-          // --xchr-model 1 corner case.)
-          if (!pgv.dosage_ct) {
-            if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
-              const_alleles[0] = 3;
-            }
-          } else if (pgv.dosage_ct == nm_sample_ct) {
-            if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
-              const_alleles[0] = 3;
-            }
-          }
-          machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
-          machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
-          machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
-          machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
-        } else {
-          // multiallelic.
-          // If some but not all alleles have constant dosages, we remove just
-          // those alleles from the regressions; trim-alts is not necessary to
-          // see what's going on with the other alleles.  To reduce parsing
-          // complexity, the number of output lines is not affected by this;
-          // the ones corresponding to the constant alleles have NA values.
-          // Punt on sparse_optimization for now; may be worth revisiting after
-          // multiallelic dosage implemented.
-          // dosage_ct == 0 temporarily guaranteed if we reach here.
-          assert(!pgv.dosage_ct);
-          multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ct]);
-          ZeroU64Arr(allele_ct, machr2_dosage_sums);
-          ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
-          // postpone multiply for now, since no multiallelic dosages
-          machr2_dosage_sums[0] = genocounts[1] + 2 * genocounts[0];
-          machr2_dosage_ssqs[0] = genocounts[1] + 4LLU * genocounts[0];
-          if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
-            SetBit(0, const_alleles);
-          }
-          if (omitted_allele_idx) {
-            // Main genotype column starts as REF.
-            if (!missing_ct) {
-              GenoarrLookup16x8bx2(pgv.genovec, kSmallInvDoublePairs, nm_sample_ct, genotype_vals);
-            } else {
-              GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallInvDoubles, cur_sample_ct, genotype_vals);
-            }
-          }
-          uint32_t rare_allele_ct = allele_ct_m2;
-          double* alt1_start = nullptr;
-          double* rarealt_start = multi_start;
-          if (omitted_allele_idx != 1) {
+          uint32_t sparse_optimization = 0;
+          double* multi_start = nullptr;
+          if (!allele_ct_m2) {
+            // When there are no dosages, and either:
+            //   prev_nm is set and missing_ct is zero, or
+            //   there are no covariates,
+            // we don't need to call MultiplySelfTranspose() on
+            // nm_predictors_pmaj_buf to get all the predictor x predictor dot
+            // products; instead we patch in the genotype x predictor dot
+            // products that may change, copying the rest from xtx_image.
+            // As a side effect, it is no longer strictly necessary to fill the
+            // genotype row of nm_predictors_pmaj_buf.  sparse_optimization
+            // indicates that plink 1.9's QT --assoc sparse dot product algorithm
+            // will be used instead.
+            // probable todos: allow a few dosages to be present, cover chrX
+            // case.
             if (omitted_allele_idx) {
-              alt1_start = multi_start;
-              rarealt_start = &(rarealt_start[nm_sample_ct]);
-              --rare_allele_ct;
-            } else {
-              alt1_start = genotype_vals;
-            }
-            if (!missing_ct) {
-              GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, alt1_start);
-            } else {
-              GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, alt1_start);
-            }
-          }
-          ZeroDArr(rare_allele_ct * nm_sample_ct, rarealt_start);
-          // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
-          // actual sums/ssqs later.
-          if (pgv.patch_01_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_01_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
-            }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ct + sample_idx] = 1.0;
-                alt1_start[sample_idx] = 0.0;
-                machr2_dosage_sums[allele_code] += 1;
-              }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ct + sample_idx] = 1.0;
-                machr2_dosage_sums[allele_code] += 1;
-              }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                alt1_start[sample_idx] = 0.0;
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                machr2_dosage_sums[allele_code] += 1;
-                if (allele_code == omitted_allele_idx) {
-                  continue;
+              if (difflist_common_geno != UINT32_MAX) {
+                assert(difflist_common_geno == 2);
+                GenovecInvertUnsafe(difflist_len, raregeno);
+                ZeroTrailingNyps(difflist_len, raregeno);
+                difflist_common_geno = 0;
+              } else {
+                GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
+                ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+                if (pgv.dosage_ct) {
+                  BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
                 }
-                const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
-                rarealt_start[cur_col * nm_sample_ct + sample_idx] = 1.0;
               }
+              const uint32_t uii = genocounts[0];
+              genocounts[0] = genocounts[2];
+              genocounts[2] = uii;
             }
-          }
-          uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
-          if (pgv.patch_10_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_10_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
-            }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] = 2.0;
-                  alt1_start[sample_idx] = 0.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ct + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
-                  } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] += 1.0;
-                    alt1_start[sample_idx] = 0.0;
-                    machr2_dosage_sums[ac0] += 1;
-                  }
-                }
-              }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] = 2.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ct + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                  } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] += 1.0;
-                    machr2_dosage_sums[ac0] += 1;
+            uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
+            uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
+            if (!missing_ct) {
+              // originally had genocounts[0] > 0.875 * nm_sample_ct threshold,
+              // but then tried this on high-MAF data and it was still
+              // substantially faster
+              sparse_optimization = sparse_optimization_eligible && (!pgv.dosage_ct) && (prev_nm || (!cur_covar_ct));
+              if (!sparse_optimization) {
+                GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, genotype_vals);
+                if (pgv.dosage_ct) {
+                  uintptr_t sample_idx_base = 0;
+                  uintptr_t dosage_present_bits = pgv.dosage_present[0];
+                  for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                    const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
+                    const uintptr_t dosage_val = pgv.dosage_main[dosage_idx];
+                    // 32768 -> 2, 16384 -> 1, 0 -> 0
+                    genotype_vals[sample_idx] = kRecipDosageMid * swtod(dosage_val);
+                    dosage_sum += dosage_val;
+                    dosage_ssq += dosage_val * dosage_val;
+                    const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
+                    if (cur_geno && (cur_geno != 3)) {
+                      const uintptr_t prev_val = cur_geno * kDosageMid;
+                      dosage_sum -= prev_val;
+                      dosage_ssq -= prev_val * prev_val;
+                    }
                   }
                 }
               }
             } else {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
-                const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  machr2_dosage_ssqs[ac0] += 1;
-                  alt1_start[sample_idx] = 0.0;
-                  if (ac0 != omitted_allele_idx) {
-                    const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                    rarealt_start[ac0_col * nm_sample_ct + sample_idx] = 2.0;
-                  }
-                } else {
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac1 != omitted_allele_idx) {
-                    const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
-                    rarealt_start[ac1_col * nm_sample_ct + sample_idx] = 1.0;
-                  }
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
-                  } else {
-                    machr2_dosage_sums[ac0] += 1;
-                    alt1_start[sample_idx] = 0.0;
-                    if (ac0 != omitted_allele_idx) {
-                      const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                      rarealt_start[ac0_col * nm_sample_ct + sample_idx] += 1.0;
+              if (!pgv.dosage_ct) {
+                sparse_optimization = sparse_optimization_eligible && (!cur_covar_ct);
+                if (!sparse_optimization) {
+                  GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, genotype_vals);
+                }
+              } else {
+                uintptr_t sample_midx_base = 0;
+                uintptr_t sample_nm_bits = sample_nm[0];
+                uint32_t dosage_idx = 0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
+                  double cur_val;
+                  if (IsSet(pgv.dosage_present, sample_midx)) {
+                    const uintptr_t dosage_val = pgv.dosage_main[dosage_idx++];
+                    cur_val = kRecipDosageMid * swtod(dosage_val);
+                    dosage_sum += dosage_val;
+                    dosage_ssq += dosage_val * dosage_val;
+                    if (cur_geno && (cur_geno != 3)) {
+                      const uintptr_t prev_val = cur_geno * kDosageMid;
+                      dosage_sum -= prev_val;
+                      dosage_ssq -= prev_val * prev_val;
                     }
+                  } else {
+                    cur_val = kSmallDoubles[cur_geno];
                   }
+                  genotype_vals[sample_idx] = cur_val;
                 }
               }
             }
-          }
-          for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
-            const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
-            const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
-            machr2_dosage_sums[allele_idx] = one_ct + 2 * two_ct;
-            machr2_dosage_ssqs[allele_idx] = one_ct + 4LLU * two_ct;
-            if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
-              SetBit(allele_idx, const_alleles);
-            }
-          }
-          const uintptr_t alt1_hom_ct = genocounts[2] - pgv.patch_10_ct;
-          machr2_dosage_sums[1] = alt1_het_ct + 2 * alt1_hom_ct;
-          machr2_dosage_ssqs[1] = alt1_het_ct + 4LLU * alt1_hom_ct;
-          if ((alt1_het_ct == nm_sample_ct) || (alt1_hom_ct == nm_sample_ct) || ((!alt1_het_ct) && (!alt1_hom_ct))) {
-            SetBit(1, const_alleles);
-          }
-          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-            machr2_dosage_sums[allele_idx] *= 0x4000LLU;
-            machr2_dosage_ssqs[allele_idx] *= 0x10000000LLU;
-          }
-        }
-        // usually need to save some of {sample_obs_ct, allele_obs_ct,
-        // a1_dosage, mach_r2 even for skipped variants
-        // compute them all for now, could conditionally skip later
-        uint32_t allele_obs_ct = nm_sample_ct * 2;
-        if (!is_regular_x) {
-          if (is_nonx_haploid) {
-            allele_obs_ct = nm_sample_ct;
-            // everything is on 0..1 scale, not 0..2
-            if (!sparse_optimization) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                genotype_vals[sample_idx] *= 0.5;
+            // Check for constant genotype column.
+            // (Technically, we should recheck later in the chrX no-sex-covariate
+            // --xchr-model 1 corner case.)
+            if (!pgv.dosage_ct) {
+              if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
+                const_alleles[0] = 3;
               }
-              const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
-              for (uint32_t uii = 0; uii != high_ct; ++uii) {
-                multi_start[uii] *= 0.5;
+            } else if (pgv.dosage_ct == nm_sample_ct) {
+              if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
+                const_alleles[0] = 3;
               }
             }
-          }
-        } else {
-          CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
-          const uintptr_t* male_nm = tmp_nm;
-          const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
-          if (is_xchr_model_1) {
-            // special case: multiply male values by 0.5
-            uintptr_t sample_idx_base = 0;
-            uintptr_t male_nm_bits = male_nm[0];
-            for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
-              const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-              genotype_vals[sample_idx] *= 0.5;
-              // could insert multiallelic loop here instead, but I'm guessing
-              // that's worse due to locality of writes?
+            machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
+            machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
+            machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
+            machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
+          } else {
+            // multiallelic.
+            // If some but not all alleles have constant dosages, we remove just
+            // those alleles from the regressions; trim-alts is not necessary to
+            // see what's going on with the other alleles.  To reduce parsing
+            // complexity, the number of output lines is not affected by this;
+            // the ones corresponding to the constant alleles have NA values.
+            // Punt on sparse_optimization for now; may be worth revisiting after
+            // multiallelic dosage implemented.
+            // dosage_ct == 0 temporarily guaranteed if we reach here.
+            assert(!pgv.dosage_ct);
+            multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ct]);
+            ZeroU64Arr(allele_ct, machr2_dosage_sums);
+            ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
+            // postpone multiply for now, since no multiallelic dosages
+            machr2_dosage_sums[0] = genocounts[1] + 2 * genocounts[0];
+            machr2_dosage_ssqs[0] = genocounts[1] + 4LLU * genocounts[0];
+            if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
+              SetBit(0, const_alleles);
             }
-            for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-              double* cur_start = &(multi_start[extra_allele_idx * nm_sample_ct]);
-              sample_idx_base = 0;
-              male_nm_bits = male_nm[0];
-              for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
-                const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-                cur_start[sample_idx] *= 0.5;
+            if (omitted_allele_idx) {
+              // Main genotype column starts as REF.
+              if (!missing_ct) {
+                GenoarrLookup16x8bx2(pgv.genovec, kSmallInvDoublePairs, nm_sample_ct, genotype_vals);
+              } else {
+                GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallInvDoubles, cur_sample_ct, genotype_vals);
               }
             }
-            allele_obs_ct -= nm_male_ct;
-          }
-        }
-        const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
-        for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-          if (allele_idx == omitted_allele_idx) {
-            continue;
-          }
-          block_aux_iter->sample_obs_ct = nm_sample_ct;
-          block_aux_iter->allele_obs_ct = allele_obs_ct;
-          double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
-          if (is_xchr_model_1) {
-            // ugh.
-            double* geno_col = genotype_vals;
-            if (allele_idx > (!omitted_allele_idx)) {
-              geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ct]);
-            }
-            a1_dosage = 0.0;
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              a1_dosage += geno_col[sample_idx];
-            }
-            if (!allele_ct_m2) {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = 0.0;
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const double cur_dosage = geno_col[sample_idx];
-                main_dosage_ssq += cur_dosage * cur_dosage;
+            uint32_t rare_allele_ct = allele_ct_m2;
+            double* alt1_start = nullptr;
+            double* rarealt_start = multi_start;
+            if (omitted_allele_idx != 1) {
+              if (omitted_allele_idx) {
+                alt1_start = multi_start;
+                rarealt_start = &(rarealt_start[nm_sample_ct]);
+                --rare_allele_ct;
+              } else {
+                alt1_start = genotype_vals;
               }
-            }
-          } else {
-            if (is_nonx_haploid) {
-              a1_dosage *= 0.5;
-            }
-            if (!allele_ct_m2) {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
-              if (is_nonx_haploid) {
-                main_dosage_ssq *= 0.25;
+              if (!missing_ct) {
+                GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, alt1_start);
+              } else {
+                GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, alt1_start);
               }
             }
-          }
-          block_aux_iter->a1_dosage = a1_dosage;
-          block_aux_iter->mach_r2 = mach_r2;
-          ++block_aux_iter;
-        }
-        // now free to skip the actual regression if there are too few samples,
-        // or there's a zero-variance genotype column
-        GlmErr glm_err = 0;
-        if (nm_sample_ct <= expected_predictor_ct) {
-          glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
-        } else if (IsSet(const_alleles, omitted_allele_idx)) {
-          glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
-        }
-        if (glm_err) {
-          if (missing_ct) {
-            // covariates have not been copied yet, so we can't usually change
-            // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
-            // reason to optimize the zero-covariate case).
-            prev_nm = 0;
-          }
-          uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-          if (beta_se_multiallelic_fused || (!hide_covar)) {
-            reported_ct += allele_ct_m2;
-          }
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-              memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-              beta_se_iter[uii * 2 + 1] = -9.0;
-            }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
-          }
-        } else {
-          uint32_t parameter_uidx = 2 + domdev_present;
-          double* nm_predictors_pmaj_istart = nullptr;
-          if (!sparse_optimization) {
-            // only need to do this part once per variant in multiallelic case
-            double* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ct * (parameter_uidx - main_omitted)]);
-            if (missing_ct || (!prev_nm)) {
-              // fill phenotype
-              {
-                uintptr_t sample_midx_base = 0;
-                uintptr_t sample_nm_bits = sample_nm[0];
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                  nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
+            ZeroDArr(rare_allele_ct * nm_sample_ct, rarealt_start);
+            // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
+            // actual sums/ssqs later.
+            if (pgv.patch_01_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_01_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ct + sample_idx] = 1.0;
+                  alt1_start[sample_idx] = 0.0;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ct + sample_idx] = 1.0;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  alt1_start[sample_idx] = 0.0;
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  machr2_dosage_sums[allele_code] += 1;
+                  if (allele_code == omitted_allele_idx) {
+                    continue;
+                  }
+                  const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
+                  rarealt_start[cur_col * nm_sample_ct + sample_idx] = 1.0;
                 }
               }
-
-              // fill covariates
-              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
-                // strictly speaking, we don't need cur_covars_cmaj to be
-                // vector-aligned
-                if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
-                  continue;
+            }
+            uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
+            if (pgv.patch_10_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_10_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] = 2.0;
+                    alt1_start[sample_idx] = 0.0;
+                    machr2_dosage_ssqs[ac0] += 1;
+                  } else {
+                    rarealt_start[(ac1 - 2) * nm_sample_ct + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] += 1.0;
+                      alt1_start[sample_idx] = 0.0;
+                      machr2_dosage_sums[ac0] += 1;
+                    }
+                  }
                 }
-                const double* cur_covar_col;
-                if (covar_idx < local_covar_ct) {
-                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-                } else {
-                  cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * cur_sample_ct]);
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] = 2.0;
+                    machr2_dosage_ssqs[ac0] += 1;
+                  } else {
+                    rarealt_start[(ac1 - 2) * nm_sample_ct + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ct + sample_idx] += 1.0;
+                      machr2_dosage_sums[ac0] += 1;
+                    }
+                  }
                 }
-                uintptr_t sample_midx_base = 0;
-                uintptr_t sample_nm_bits = sample_nm[0];
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                  *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
+                  const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    machr2_dosage_ssqs[ac0] += 1;
+                    alt1_start[sample_idx] = 0.0;
+                    if (ac0 != omitted_allele_idx) {
+                      const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
+                      rarealt_start[ac0_col * nm_sample_ct + sample_idx] = 2.0;
+                    }
+                  } else {
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac1 != omitted_allele_idx) {
+                      const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
+                      rarealt_start[ac1_col * nm_sample_ct + sample_idx] = 1.0;
+                    }
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      machr2_dosage_sums[ac0] += 1;
+                      alt1_start[sample_idx] = 0.0;
+                      if (ac0 != omitted_allele_idx) {
+                        const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
+                        rarealt_start[ac0_col * nm_sample_ct + sample_idx] += 1.0;
+                      }
+                    }
+                  }
                 }
               }
-              nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
-              prev_nm = !(missing_ct || local_covar_ct);
-            } else {
-              // bugfix (15 Aug 2018): this was not handling --parameters
-              // correctly when a covariate was only needed as part of an
-              // interaction
-              parameter_uidx += cur_covar_ct;
-              nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ct]);
             }
-          }
-          const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
-          if (const_allele_ct) {
-            // Must delete constant-allele columns from nm_predictors_pmaj, and
-            // shift later columns back.
-            double* read_iter = genotype_vals;
-            double* write_iter = genotype_vals;
-            for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
-              if (read_allele_idx == omitted_allele_idx) {
-                continue;
+            for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
+              const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
+              const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
+              machr2_dosage_sums[allele_idx] = one_ct + 2 * two_ct;
+              machr2_dosage_ssqs[allele_idx] = one_ct + 4LLU * two_ct;
+              if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
+                SetBit(allele_idx, const_alleles);
               }
-              if (!IsSet(const_alleles, read_allele_idx)) {
-                if (write_iter != read_iter) {
-                  memcpy(write_iter, read_iter, nm_sample_ct * sizeof(double));
+            }
+            const uintptr_t alt1_hom_ct = genocounts[2] - pgv.patch_10_ct;
+            machr2_dosage_sums[1] = alt1_het_ct + 2 * alt1_hom_ct;
+            machr2_dosage_ssqs[1] = alt1_het_ct + 4LLU * alt1_hom_ct;
+            if ((alt1_het_ct == nm_sample_ct) || (alt1_hom_ct == nm_sample_ct) || ((!alt1_het_ct) && (!alt1_hom_ct))) {
+              SetBit(1, const_alleles);
+            }
+            for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+              machr2_dosage_sums[allele_idx] *= 0x4000LLU;
+              machr2_dosage_ssqs[allele_idx] *= 0x10000000LLU;
+            }
+          }
+          // usually need to save some of {sample_obs_ct, allele_obs_ct,
+          // a1_dosage, mach_r2 even for skipped variants
+          // compute them all for now, could conditionally skip later
+          uint32_t allele_obs_ct = nm_sample_ct * 2;
+          if (!is_regular_x) {
+            if (is_nonx_haploid) {
+              allele_obs_ct = nm_sample_ct;
+              // everything is on 0..1 scale, not 0..2
+              if (!sparse_optimization) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  genotype_vals[sample_idx] *= 0.5;
                 }
-                if (write_iter == genotype_vals) {
-                  write_iter = multi_start;
-                } else {
-                  write_iter = &(write_iter[nm_sample_ct]);
+                const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
+                for (uint32_t uii = 0; uii != high_ct; ++uii) {
+                  multi_start[uii] *= 0.5;
                 }
               }
-              if (read_iter == genotype_vals) {
-                read_iter = multi_start;
-              } else {
-                read_iter = &(read_iter[nm_sample_ct]);
+            }
+          } else {
+            CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
+            const uintptr_t* male_nm = tmp_nm;
+            const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
+            if (is_xchr_model_1) {
+              // special case: multiply male values by 0.5
+              uintptr_t sample_idx_base = 0;
+              uintptr_t male_nm_bits = male_nm[0];
+              for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
+                const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
+                genotype_vals[sample_idx] *= 0.5;
+                // could insert multiallelic loop here instead, but I'm guessing
+                // that's worse due to locality of writes?
+              }
+              for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                double* cur_start = &(multi_start[extra_allele_idx * nm_sample_ct]);
+                sample_idx_base = 0;
+                male_nm_bits = male_nm[0];
+                for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
+                  const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
+                  cur_start[sample_idx] *= 0.5;
+                }
               }
+              allele_obs_ct -= nm_male_ct;
             }
           }
-          const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
-          uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            if (extra_regression_ct) {
-              if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
-                glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
-                goto GlmLinearThread_skip_regression;
+          const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
+          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+            if (allele_idx == omitted_allele_idx) {
+              continue;
+            }
+            block_aux_iter->sample_obs_ct = nm_sample_ct;
+            block_aux_iter->allele_obs_ct = allele_obs_ct;
+            double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
+            if (is_xchr_model_1) {
+              // ugh.
+              double* geno_col = genotype_vals;
+              if (allele_idx > (!omitted_allele_idx)) {
+                geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ct]);
               }
-              ++nonconst_extra_regression_idx;
-              if (nonconst_extra_regression_idx) {
-                double* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ct]);
-                for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
-                  double dxx = genotype_vals[uii];
-                  genotype_vals[uii] = swap_target[uii];
-                  swap_target[uii] = dxx;
+              a1_dosage = 0.0;
+              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                a1_dosage += geno_col[sample_idx];
+              }
+              if (!allele_ct_m2) {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = 0.0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const double cur_dosage = geno_col[sample_idx];
+                  main_dosage_ssq += cur_dosage * cur_dosage;
+                }
+              }
+            } else {
+              if (is_nonx_haploid) {
+                a1_dosage *= 0.5;
+              }
+              if (!allele_ct_m2) {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
+                if (is_nonx_haploid) {
+                  main_dosage_ssq *= 0.25;
                 }
               }
             }
+            block_aux_iter->a1_dosage = a1_dosage;
+            block_aux_iter->mach_r2 = mach_r2;
+            ++block_aux_iter;
+          }
+          // now free to skip the actual regression if there are too few samples,
+          // or there's a zero-variance genotype column
+          GlmErr glm_err = 0;
+          if (nm_sample_ct <= expected_predictor_ct) {
+            glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
+          } else if (IsSet(const_alleles, omitted_allele_idx)) {
+            glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
+          }
+          if (glm_err) {
+            if (missing_ct) {
+              // covariates have not been copied yet, so we can't usually change
+              // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
+              // reason to optimize the zero-covariate case).
+              prev_nm = 0;
+            }
+            uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+            if (beta_se_multiallelic_fused || (!hide_covar)) {
+              reported_ct += allele_ct_m2;
+            }
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                beta_se_iter[uii * 2 + 1] = -9.0;
+              }
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+            }
+          } else {
+            uint32_t parameter_uidx = 2 + domdev_present;
+            double* nm_predictors_pmaj_istart = nullptr;
             if (!sparse_optimization) {
-              double* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ct]);
-              double* domdev_vals = nullptr;
-              if (main_omitted) {
-                // if main_mutated, this will be filled below
-                // if not, this aliases genotype_vals
-                main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ct]);
-              } else if (joint_genotypic || joint_hethom) {
-                domdev_vals = &(main_vals[nm_sample_ct]);
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  double cur_genotype_val = genotype_vals[sample_idx];
-                  if (cur_genotype_val > 1.0) {
-                    cur_genotype_val = 2.0 - cur_genotype_val;
+              // only need to do this part once per variant in multiallelic case
+              double* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ct * (parameter_uidx - main_omitted)]);
+              if (missing_ct || (!prev_nm)) {
+                // fill phenotype
+                {
+                  uintptr_t sample_midx_base = 0;
+                  uintptr_t sample_nm_bits = sample_nm[0];
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                    nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
                   }
-                  domdev_vals[sample_idx] = cur_genotype_val;
                 }
-              }
-              if (model_dominant) {
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  double cur_genotype_val = genotype_vals[sample_idx];
-                  // 0..1..1
-                  if (cur_genotype_val > 1.0) {
-                    cur_genotype_val = 1.0;
+
+                // fill covariates
+                for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
+                  // strictly speaking, we don't need cur_covars_cmaj to be
+                  // vector-aligned
+                  if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
+                    continue;
+                  }
+                  const double* cur_covar_col;
+                  if (covar_idx < local_covar_ct) {
+                    cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
+                  } else {
+                    cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * cur_sample_ct]);
+                  }
+                  uintptr_t sample_midx_base = 0;
+                  uintptr_t sample_nm_bits = sample_nm[0];
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                    *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
                   }
-                  main_vals[sample_idx] = cur_genotype_val;
                 }
-              } else if (model_recessive || joint_hethom) {
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  double cur_genotype_val = genotype_vals[sample_idx];
-                  // 0..0..1
-                  if (cur_genotype_val < 1.0) {
-                    cur_genotype_val = 0.0;
+                nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
+                prev_nm = !(missing_ct || local_covar_ct);
+              } else {
+                // bugfix (15 Aug 2018): this was not handling --parameters
+                // correctly when a covariate was only needed as part of an
+                // interaction
+                parameter_uidx += cur_covar_ct;
+                nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ct]);
+              }
+            }
+            const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
+            if (const_allele_ct) {
+              // Must delete constant-allele columns from nm_predictors_pmaj, and
+              // shift later columns back.
+              double* read_iter = genotype_vals;
+              double* write_iter = genotype_vals;
+              for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
+                if (read_allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                if (!IsSet(const_alleles, read_allele_idx)) {
+                  if (write_iter != read_iter) {
+                    memcpy(write_iter, read_iter, nm_sample_ct * sizeof(double));
+                  }
+                  if (write_iter == genotype_vals) {
+                    write_iter = multi_start;
                   } else {
-                    cur_genotype_val -= 1.0;
+                    write_iter = &(write_iter[nm_sample_ct]);
                   }
-                  main_vals[sample_idx] = cur_genotype_val;
                 }
-              } else if (model_hetonly) {
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  double cur_genotype_val = genotype_vals[sample_idx];
-                  // 0..1..0
-                  if (cur_genotype_val > 1.0) {
-                    cur_genotype_val = 2.0 - cur_genotype_val;
+                if (read_iter == genotype_vals) {
+                  read_iter = multi_start;
+                } else {
+                  read_iter = &(read_iter[nm_sample_ct]);
+                }
+              }
+            }
+            const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
+            uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              if (extra_regression_ct) {
+                if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
+                  glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
+                  goto GlmLinearThread_skip_regression;
+                }
+                ++nonconst_extra_regression_idx;
+                if (nonconst_extra_regression_idx) {
+                  double* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ct]);
+                  for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
+                    double dxx = genotype_vals[uii];
+                    genotype_vals[uii] = swap_target[uii];
+                    swap_target[uii] = dxx;
                   }
-                  main_vals[sample_idx] = cur_genotype_val;
                 }
               }
-
-              // fill interaction terms
-              if (add_interactions) {
-                double* nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
-                for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
-                  const double* cur_covar_col;
-                  if (covar_idx < local_covar_ct) {
-                    cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-                  } else {
-                    cur_covar_col = &(cur_covars_cmaj[covar_idx * cur_sample_ct]);
+              if (!sparse_optimization) {
+                double* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ct]);
+                double* domdev_vals = nullptr;
+                if (main_omitted) {
+                  // if main_mutated, this will be filled below
+                  // if not, this aliases genotype_vals
+                  main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ct]);
+                } else if (joint_genotypic || joint_hethom) {
+                  domdev_vals = &(main_vals[nm_sample_ct]);
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    double cur_genotype_val = genotype_vals[sample_idx];
+                    if (cur_genotype_val > 1.0) {
+                      cur_genotype_val = 2.0 - cur_genotype_val;
+                    }
+                    domdev_vals[sample_idx] = cur_genotype_val;
                   }
-                  if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
-                    uintptr_t sample_midx_base = 0;
-                    uintptr_t sample_nm_bits = sample_nm[0];
-                    for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                      const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                      *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
+                }
+                if (model_dominant) {
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    double cur_genotype_val = genotype_vals[sample_idx];
+                    // 0..1..1
+                    if (cur_genotype_val > 1.0) {
+                      cur_genotype_val = 1.0;
                     }
+                    main_vals[sample_idx] = cur_genotype_val;
                   }
-                  ++parameter_uidx;
-                  if (domdev_present) {
+                } else if (model_recessive || joint_hethom) {
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    double cur_genotype_val = genotype_vals[sample_idx];
+                    // 0..0..1
+                    if (cur_genotype_val < 1.0) {
+                      cur_genotype_val = 0.0;
+                    } else {
+                      cur_genotype_val -= 1.0;
+                    }
+                    main_vals[sample_idx] = cur_genotype_val;
+                  }
+                } else if (model_hetonly) {
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    double cur_genotype_val = genotype_vals[sample_idx];
+                    // 0..1..0
+                    if (cur_genotype_val > 1.0) {
+                      cur_genotype_val = 2.0 - cur_genotype_val;
+                    }
+                    main_vals[sample_idx] = cur_genotype_val;
+                  }
+                }
+
+                // fill interaction terms
+                if (add_interactions) {
+                  double* nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
+                  for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
+                    const double* cur_covar_col;
+                    if (covar_idx < local_covar_ct) {
+                      cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
+                    } else {
+                      cur_covar_col = &(cur_covars_cmaj[covar_idx * cur_sample_ct]);
+                    }
                     if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
                       uintptr_t sample_midx_base = 0;
                       uintptr_t sample_nm_bits = sample_nm[0];
                       for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                         const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                        *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                        *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
                       }
                     }
                     ++parameter_uidx;
+                    if (domdev_present) {
+                      if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
+                        uintptr_t sample_midx_base = 0;
+                        uintptr_t sample_nm_bits = sample_nm[0];
+                        for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                          const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                          *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                        }
+                      }
+                      ++parameter_uidx;
+                    }
                   }
                 }
               }
-            }
 
-            // bugfix (12 Sep 2017): forgot to implement per-variant VIF and
-            // max-corr checks
-            // DPrintf("\nWorker thread %" PRIuPTR " starting main regression for %u", tidx, variant_uidx);
-            if (xtx_image && (sparse_optimization || (prev_nm && (!allele_ct_m2)))) {
-              // only need to fill in additive and possibly domdev dot
-              // products
-              memcpy(xtx_inv, xtx_image, cur_predictor_ct * cur_predictor_ct * sizeof(double));
-              memcpy(xt_y, xt_y_image, cur_predictor_ct * sizeof(double));
-              if (sparse_optimization) {
-                // currently does not handle chrX
-                double geno_pheno_prod = 0.0;
-                double domdev_pheno_prod = 0.0;
-                double domdev_geno_prod = 0.0;
-                if (!cur_covar_ct) {
-                  // missing genotypes may be present
-                  double pheno_sum = xt_y[0];
-                  if (!difflist_common_geno) {
-                    if (difflist_len) {
-                      const uint32_t word_ct_m1 = (difflist_len - 1) / kBitsPerWordD2;
-                      uint32_t loop_len = kBitsPerWordD2;
-                      for (uint32_t widx = 0; ; ++widx) {
-                        if (widx >= word_ct_m1) {
-                          if (widx > word_ct_m1) {
-                            break;
-                          }
-                          loop_len = ModNz(difflist_len, kBitsPerWordD2);
-                        }
-                        const uint32_t* cur_difflist_sample_ids = &(difflist_sample_ids[widx * kBitsPerWordD2]);
-                        uintptr_t raregeno_word = raregeno[widx];
-                        for (uint32_t uii = 0; uii != loop_len; ++uii) {
-                          const uintptr_t cur_geno = raregeno_word & 3;
-                          const uint32_t sample_midx = cur_difflist_sample_ids[uii];
-                          const double cur_pheno_val = cur_pheno[sample_midx];
-                          if (cur_geno == 3) {
-                            pheno_sum -= cur_pheno[sample_midx];
-                          } else {
-                            const uint32_t cur_geno_m1 = cur_geno - 1;
-                            const double geno_d = geno_d_lookup[cur_geno_m1];
-                            geno_pheno_prod += geno_d * cur_pheno_val;
-                            if (domdev_present && (!cur_geno_m1)) {
-                              // domdev = 1
-                              domdev_pheno_prod += cur_pheno_val;
-                              domdev_geno_prod += geno_d;
+              // bugfix (12 Sep 2017): forgot to implement per-variant VIF and
+              // max-corr checks
+              // DPrintf("\nWorker thread %" PRIuPTR " starting main regression for %u", tidx, variant_uidx);
+              if (xtx_image && (sparse_optimization || (prev_nm && (!allele_ct_m2)))) {
+                // only need to fill in additive and possibly domdev dot
+                // products
+                memcpy(xtx_inv, xtx_image, cur_predictor_ct * cur_predictor_ct * sizeof(double));
+                memcpy(xt_y, xt_y_image, cur_predictor_ct * sizeof(double));
+                if (sparse_optimization) {
+                  // currently does not handle chrX
+                  double geno_pheno_prod = 0.0;
+                  double domdev_pheno_prod = 0.0;
+                  double domdev_geno_prod = 0.0;
+                  if (!cur_covar_ct) {
+                    // missing genotypes may be present
+                    double pheno_sum = xt_y[0];
+                    if (!difflist_common_geno) {
+                      if (difflist_len) {
+                        const uint32_t word_ct_m1 = (difflist_len - 1) / kBitsPerWordD2;
+                        uint32_t loop_len = kBitsPerWordD2;
+                        for (uint32_t widx = 0; ; ++widx) {
+                          if (widx >= word_ct_m1) {
+                            if (widx > word_ct_m1) {
+                              break;
                             }
+                            loop_len = ModNz(difflist_len, kBitsPerWordD2);
+                          }
+                          const uint32_t* cur_difflist_sample_ids = &(difflist_sample_ids[widx * kBitsPerWordD2]);
+                          uintptr_t raregeno_word = raregeno[widx];
+                          for (uint32_t uii = 0; uii != loop_len; ++uii) {
+                            const uintptr_t cur_geno = raregeno_word & 3;
+                            const uint32_t sample_midx = cur_difflist_sample_ids[uii];
+                            const double cur_pheno_val = cur_pheno[sample_midx];
+                            if (cur_geno == 3) {
+                              pheno_sum -= cur_pheno[sample_midx];
+                            } else {
+                              const uint32_t cur_geno_m1 = cur_geno - 1;
+                              const double geno_d = geno_d_lookup[cur_geno_m1];
+                              geno_pheno_prod += geno_d * cur_pheno_val;
+                              if (domdev_present && (!cur_geno_m1)) {
+                                // domdev = 1
+                                domdev_pheno_prod += cur_pheno_val;
+                                domdev_geno_prod += geno_d;
+                              }
+                            }
+                            raregeno_word = raregeno_word >> 2;
                           }
-                          raregeno_word = raregeno_word >> 2;
-                        }
-                      }
-                    }
-                  } else {
-                    for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
-                      uintptr_t geno_word = pgv.genovec[widx];
-                      if (!geno_word) {
-                        continue;
-                      }
-                      const uint32_t sample_midx_base = widx * kBitsPerWordD2;
-                      uintptr_t missing_word = geno_word & (geno_word >> 1) & kMask5555;
-                      if (missing_word) {
-                        geno_word ^= missing_word * 3;
-                        while (missing_word) {
-                          const uint32_t sample_midx_lowbits = ctzw(missing_word) / 2;
-                          const uint32_t sample_midx = sample_midx_base + sample_midx_lowbits;
-                          pheno_sum -= cur_pheno[sample_midx];
-                          missing_word &= missing_word - 1;
-                        }
-                      }
-                      while (geno_word) {
-                        const uint32_t lowest_set_bit = ctzw(geno_word);
-                        const uint32_t sample_midx = sample_midx_base + (lowest_set_bit / 2);
-                        const double geno_d = geno_d_lookup[lowest_set_bit & 1];
-                        const double cur_pheno_val = cur_pheno[sample_midx];
-                        geno_pheno_prod += geno_d * cur_pheno_val;
-                        if (domdev_present && (!(lowest_set_bit & 1))) {
-                          // domdev = 1
-                          domdev_pheno_prod += cur_pheno_val;
-                          domdev_geno_prod += geno_d;
-                        }
-                        geno_word &= geno_word - 1;
-                      }
-                    }
-                  }
-                  xt_y[0] = pheno_sum;
-                  xtx_inv[0] = u31tod(nm_sample_ct);
-                } else {
-                  double* geno_dotprod_row = &(xtx_inv[cur_predictor_ct]);
-                  double* domdev_dotprod_row = &(xtx_inv[2 * cur_predictor_ct]);
-                  for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
-                    uintptr_t geno_word = pgv.genovec[widx];
-                    if (geno_word) {
-                      const uint32_t sample_idx_base = widx * kBitsPerWordD2;
-                      do {
-                        const uint32_t lowest_set_bit = ctzw(geno_word);
-                        // since there are no missing values, we have a het if
-                        // (lowest_set_bit & 1) is zero, and a hom-alt when
-                        // it's one.
-                        const uint32_t sample_idx = sample_idx_base + (lowest_set_bit / 2);
-                        const double geno_d = geno_d_lookup[lowest_set_bit & 1];
-                        const double cur_pheno_val = nm_pheno_buf[sample_idx];
-                        geno_pheno_prod += geno_d * cur_pheno_val;
-                        for (uintptr_t pred_idx = domdev_present + 2; pred_idx != cur_predictor_ct; ++pred_idx) {
-                          geno_dotprod_row[pred_idx] += geno_d * nm_predictors_pmaj_buf[pred_idx * nm_sample_ct + sample_idx];
                         }
-                        // can have a separate categorical loop here
-
-                        if (domdev_present && (!(lowest_set_bit & 1))) {
-                          // domdev = 1
-                          domdev_pheno_prod += cur_pheno_val;
-                          domdev_geno_prod += geno_d;
-                          for (uintptr_t pred_idx = 3; pred_idx != cur_predictor_ct; ++pred_idx) {
-                            domdev_dotprod_row[pred_idx] += nm_predictors_pmaj_buf[pred_idx * nm_sample_ct + sample_idx];
+                      }
+                    } else {
+                      for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
+                        uintptr_t geno_word = pgv.genovec[widx];
+                        if (!geno_word) {
+                          continue;
+                        }
+                        const uint32_t sample_midx_base = widx * kBitsPerWordD2;
+                        uintptr_t missing_word = geno_word & (geno_word >> 1) & kMask5555;
+                        if (missing_word) {
+                          geno_word ^= missing_word * 3;
+                          while (missing_word) {
+                            const uint32_t sample_midx_lowbits = ctzw(missing_word) / 2;
+                            const uint32_t sample_midx = sample_midx_base + sample_midx_lowbits;
+                            pheno_sum -= cur_pheno[sample_midx];
+                            missing_word &= missing_word - 1;
                           }
-                          // categorical optimization possible here
                         }
-                        geno_word &= geno_word - 1;
-                      } while (geno_word);
+                        while (geno_word) {
+                          const uint32_t lowest_set_bit = ctzw(geno_word);
+                          const uint32_t sample_midx = sample_midx_base + (lowest_set_bit / 2);
+                          const double geno_d = geno_d_lookup[lowest_set_bit & 1];
+                          const double cur_pheno_val = cur_pheno[sample_midx];
+                          geno_pheno_prod += geno_d * cur_pheno_val;
+                          if (domdev_present && (!(lowest_set_bit & 1))) {
+                            // domdev = 1
+                            domdev_pheno_prod += cur_pheno_val;
+                            domdev_geno_prod += geno_d;
+                          }
+                          geno_word &= geno_word - 1;
+                        }
+                      }
+                    }
+                    xt_y[0] = pheno_sum;
+                    xtx_inv[0] = u31tod(nm_sample_ct);
+                  } else {
+                    double* geno_dotprod_row = &(xtx_inv[cur_predictor_ct]);
+                    double* domdev_dotprod_row = &(xtx_inv[2 * cur_predictor_ct]);
+                    for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
+                      uintptr_t geno_word = pgv.genovec[widx];
+                      if (geno_word) {
+                        const uint32_t sample_idx_base = widx * kBitsPerWordD2;
+                        do {
+                          const uint32_t lowest_set_bit = ctzw(geno_word);
+                          // since there are no missing values, we have a het if
+                          // (lowest_set_bit & 1) is zero, and a hom-alt when
+                          // it's one.
+                          const uint32_t sample_idx = sample_idx_base + (lowest_set_bit / 2);
+                          const double geno_d = geno_d_lookup[lowest_set_bit & 1];
+                          const double cur_pheno_val = nm_pheno_buf[sample_idx];
+                          geno_pheno_prod += geno_d * cur_pheno_val;
+                          for (uintptr_t pred_idx = domdev_present + 2; pred_idx != cur_predictor_ct; ++pred_idx) {
+                            geno_dotprod_row[pred_idx] += geno_d * nm_predictors_pmaj_buf[pred_idx * nm_sample_ct + sample_idx];
+                          }
+                          // can have a separate categorical loop here
+
+                          if (domdev_present && (!(lowest_set_bit & 1))) {
+                            // domdev = 1
+                            domdev_pheno_prod += cur_pheno_val;
+                            domdev_geno_prod += geno_d;
+                            for (uintptr_t pred_idx = 3; pred_idx != cur_predictor_ct; ++pred_idx) {
+                              domdev_dotprod_row[pred_idx] += nm_predictors_pmaj_buf[pred_idx * nm_sample_ct + sample_idx];
+                            }
+                            // categorical optimization possible here
+                          }
+                          geno_word &= geno_word - 1;
+                        } while (geno_word);
+                      }
                     }
                   }
+                  xt_y[1] = geno_pheno_prod;
+                  const double het_ctd = u31tod(genocounts[1]);
+                  const double homalt_ctd = u31tod(genocounts[2]);
+                  xtx_inv[cur_predictor_ct] = het_ctd * geno_d_lookup[0] + homalt_ctd * geno_d_lookup[1];
+                  xtx_inv[cur_predictor_ct + 1] = het_ctd * geno_d_lookup[0] * geno_d_lookup[0] + homalt_ctd * geno_d_lookup[1] * geno_d_lookup[1];
+                  if (domdev_present) {
+                    xt_y[2] = domdev_pheno_prod;
+                    xtx_inv[cur_predictor_ct + 2] = domdev_geno_prod;
+                    xtx_inv[2 * cur_predictor_ct] = het_ctd;
+                    xtx_inv[2 * cur_predictor_ct + 2] = het_ctd;
+                  }
+                } else {
+                  // !sparse_optimization
+                  xt_y[1] = DotprodD(&(nm_predictors_pmaj_buf[nm_sample_ct]), nm_pheno_buf, nm_sample_ct);
+                  uintptr_t start_pred_idx = 0;
+                  if (!(model_dominant || model_recessive || model_hetonly || joint_hethom)) {
+                    start_pred_idx = domdev_present + 2;
+                    xtx_inv[cur_predictor_ct] = main_dosage_sum;
+                    xtx_inv[cur_predictor_ct + 1] = main_dosage_ssq;
+                  }
+                  if (cur_predictor_ct > start_pred_idx) {
+                    // categorical optimization possible here
+                    ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ct]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ct]), nm_sample_ct, nm_sample_ct, cur_predictor_ct - start_pred_idx, &(xtx_inv[cur_predictor_ct + start_pred_idx]));
+                  }
+                  if (domdev_present) {
+                    xt_y[2] = DotprodD(&(nm_predictors_pmaj_buf[2 * nm_sample_ct]), nm_pheno_buf, nm_sample_ct);
+                    // categorical optimization possible here
+                    ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ct]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ct, cur_predictor_ct, &(xtx_inv[2 * cur_predictor_ct]));
+                    xtx_inv[cur_predictor_ct + 2] = xtx_inv[2 * cur_predictor_ct + 1];
+                  }
                 }
-                xt_y[1] = geno_pheno_prod;
-                const double het_ctd = u31tod(genocounts[1]);
-                const double homalt_ctd = u31tod(genocounts[2]);
-                xtx_inv[cur_predictor_ct] = het_ctd * geno_d_lookup[0] + homalt_ctd * geno_d_lookup[1];
-                xtx_inv[cur_predictor_ct + 1] = het_ctd * geno_d_lookup[0] * geno_d_lookup[0] + homalt_ctd * geno_d_lookup[1] * geno_d_lookup[1];
-                if (domdev_present) {
-                  xt_y[2] = domdev_pheno_prod;
-                  xtx_inv[cur_predictor_ct + 2] = domdev_geno_prod;
-                  xtx_inv[2 * cur_predictor_ct] = het_ctd;
-                  xtx_inv[2 * cur_predictor_ct + 2] = het_ctd;
-                }
-              } else {
-                // !sparse_optimization
-                xt_y[1] = DotprodD(&(nm_predictors_pmaj_buf[nm_sample_ct]), nm_pheno_buf, nm_sample_ct);
-                uintptr_t start_pred_idx = 0;
-                if (!(model_dominant || model_recessive || model_hetonly || joint_hethom)) {
-                  start_pred_idx = domdev_present + 2;
-                  xtx_inv[cur_predictor_ct] = main_dosage_sum;
-                  xtx_inv[cur_predictor_ct + 1] = main_dosage_ssq;
+                const double* covarxx_dotprod_inv = covarx_dotprod_inv;
+                if (!missing_ct) {
+                  glm_err = CheckMaxCorrAndVifNm(xtx_inv, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
+                } else {
+                  for (uint32_t pred_idx = 1; pred_idx != cur_predictor_ct; ++pred_idx) {
+                    dbl_2d_buf[pred_idx] = xtx_inv[pred_idx * cur_predictor_ct];
+                  }
+                  glm_err = CheckMaxCorrAndVif(xtx_inv, 1, cur_predictor_ct, nm_sample_ct, max_corr, vif_thresh, dbl_2d_buf, nullptr, inverse_corr_buf, inv_1d_buf);
+                  covarless_inverse_buf[0] = 1.0 / u31tod(nm_sample_ct);
+                  covarxx_dotprod_inv = covarless_inverse_buf;
                 }
-                if (cur_predictor_ct > start_pred_idx) {
-                  // categorical optimization possible here
-                  ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ct]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ct]), nm_sample_ct, nm_sample_ct, cur_predictor_ct - start_pred_idx, &(xtx_inv[cur_predictor_ct + start_pred_idx]));
+                if (glm_err) {
+                  goto GlmLinearThread_skip_regression;
                 }
-                if (domdev_present) {
-                  xt_y[2] = DotprodD(&(nm_predictors_pmaj_buf[2 * nm_sample_ct]), nm_pheno_buf, nm_sample_ct);
-                  // categorical optimization possible here
-                  ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ct]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ct, cur_predictor_ct, &(xtx_inv[2 * cur_predictor_ct]));
-                  xtx_inv[cur_predictor_ct + 2] = xtx_inv[2 * cur_predictor_ct + 1];
+                const double geno_ssq = xtx_inv[1 + cur_predictor_ct];
+                if (!domdev_present) {
+                  xtx_inv[1 + cur_predictor_ct] = xtx_inv[cur_predictor_ct];
+                  if (InvertRank1Symm(covarxx_dotprod_inv, &(xtx_inv[1 + cur_predictor_ct]), cur_predictor_ct - 1, 1, geno_ssq, dbl_2d_buf, inverse_corr_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
+                    goto GlmLinearThread_skip_regression;
+                  }
+                } else {
+                  const double domdev_geno_prod = xtx_inv[2 + cur_predictor_ct];
+                  const double domdev_ssq = xtx_inv[2 + 2 * cur_predictor_ct];
+                  xtx_inv[2 + cur_predictor_ct] = xtx_inv[cur_predictor_ct];
+                  xtx_inv[2 + 2 * cur_predictor_ct] = xtx_inv[2 * cur_predictor_ct];
+                  if (InvertRank2Symm(covarxx_dotprod_inv, &(xtx_inv[2 + cur_predictor_ct]), cur_predictor_ct - 2, cur_predictor_ct, 1, geno_ssq, domdev_geno_prod, domdev_ssq, dbl_2d_buf, inverse_corr_buf, &(inverse_corr_buf[2 * (cur_predictor_ct - 2)]))) {
+                    glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
+                    goto GlmLinearThread_skip_regression;
+                  }
                 }
-              }
-              const double* covarxx_dotprod_inv = covarx_dotprod_inv;
-              if (!missing_ct) {
-                glm_err = CheckMaxCorrAndVifNm(xtx_inv, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
+                // need to make sure xtx_inv remains reflected in NOLAPACK case
+                memcpy(xtx_inv, dbl_2d_buf, cur_predictor_ct * cur_predictor_ct * sizeof(double));
+                ReflectMatrix(cur_predictor_ct, xtx_inv);
+                ColMajorVectorMatrixMultiplyStrided(xt_y, xtx_inv, cur_predictor_ct, cur_predictor_ct, cur_predictor_ct, fitted_coefs);
               } else {
+                // generic case
+                // major categorical optimization possible here, some
+                // multiallelic optimizations possible
+                MultiplySelfTranspose(nm_predictors_pmaj_buf, cur_predictor_ct, nm_sample_ct, xtx_inv);
                 for (uint32_t pred_idx = 1; pred_idx != cur_predictor_ct; ++pred_idx) {
                   dbl_2d_buf[pred_idx] = xtx_inv[pred_idx * cur_predictor_ct];
                 }
                 glm_err = CheckMaxCorrAndVif(xtx_inv, 1, cur_predictor_ct, nm_sample_ct, max_corr, vif_thresh, dbl_2d_buf, nullptr, inverse_corr_buf, inv_1d_buf);
-                covarless_inverse_buf[0] = 1.0 / u31tod(nm_sample_ct);
-                covarxx_dotprod_inv = covarless_inverse_buf;
-              }
-              if (glm_err) {
-                goto GlmLinearThread_skip_regression;
-              }
-              const double geno_ssq = xtx_inv[1 + cur_predictor_ct];
-              if (!domdev_present) {
-                xtx_inv[1 + cur_predictor_ct] = xtx_inv[cur_predictor_ct];
-                if (InvertRank1Symm(covarxx_dotprod_inv, &(xtx_inv[1 + cur_predictor_ct]), cur_predictor_ct - 1, 1, geno_ssq, dbl_2d_buf, inverse_corr_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
+                if (glm_err) {
                   goto GlmLinearThread_skip_regression;
                 }
-              } else {
-                const double domdev_geno_prod = xtx_inv[2 + cur_predictor_ct];
-                const double domdev_ssq = xtx_inv[2 + 2 * cur_predictor_ct];
-                xtx_inv[2 + cur_predictor_ct] = xtx_inv[cur_predictor_ct];
-                xtx_inv[2 + 2 * cur_predictor_ct] = xtx_inv[2 * cur_predictor_ct];
-                if (InvertRank2Symm(covarxx_dotprod_inv, &(xtx_inv[2 + cur_predictor_ct]), cur_predictor_ct - 2, cur_predictor_ct, 1, geno_ssq, domdev_geno_prod, domdev_ssq, dbl_2d_buf, inverse_corr_buf, &(inverse_corr_buf[2 * (cur_predictor_ct - 2)]))) {
+                if (LinearRegressionInv(nm_pheno_buf, nm_predictors_pmaj_buf, cur_predictor_ct, nm_sample_ct, 1, xtx_inv, fitted_coefs, xt_y, inv_1d_buf, dbl_2d_buf)) {
                   glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
                   goto GlmLinearThread_skip_regression;
                 }
               }
-              // need to make sure xtx_inv remains reflected in NOLAPACK case
-              memcpy(xtx_inv, dbl_2d_buf, cur_predictor_ct * cur_predictor_ct * sizeof(double));
-              ReflectMatrix(cur_predictor_ct, xtx_inv);
-              ColMajorVectorMatrixMultiplyStrided(xt_y, xtx_inv, cur_predictor_ct, cur_predictor_ct, cur_predictor_ct, fitted_coefs);
-            } else {
-              // generic case
-              // major categorical optimization possible here, some
-              // multiallelic optimizations possible
-              MultiplySelfTranspose(nm_predictors_pmaj_buf, cur_predictor_ct, nm_sample_ct, xtx_inv);
-              for (uint32_t pred_idx = 1; pred_idx != cur_predictor_ct; ++pred_idx) {
-                dbl_2d_buf[pred_idx] = xtx_inv[pred_idx * cur_predictor_ct];
-              }
-              glm_err = CheckMaxCorrAndVif(xtx_inv, 1, cur_predictor_ct, nm_sample_ct, max_corr, vif_thresh, dbl_2d_buf, nullptr, inverse_corr_buf, inv_1d_buf);
-              if (glm_err) {
-                goto GlmLinearThread_skip_regression;
-              }
-              if (LinearRegressionInv(nm_pheno_buf, nm_predictors_pmaj_buf, cur_predictor_ct, nm_sample_ct, 1, xtx_inv, fitted_coefs, xt_y, inv_1d_buf, dbl_2d_buf)) {
-                glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
-                goto GlmLinearThread_skip_regression;
-              }
-            }
-            {
-              // DPrintf("\nWorker thread %" PRIuPTR " finished main regression for %u", tidx, variant_uidx);
-              // RSS = y^T y - y^T X (X^T X)^{-1} X^T y
-              //     = cur_pheno_ssq - xt_y * fitted_coefs
-              // s^2 = RSS / df
-              // possible todo: improve numerical stability of this computation
-              // in non-mean-centered phenotype case
-              const double sigma = (cur_pheno_ssq - DotprodxD(xt_y, fitted_coefs, cur_predictor_ct)) / u31tod(nm_sample_ct - cur_predictor_ct);
-              for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
-                double* s_iter = &(xtx_inv[uii * cur_predictor_ct]);
+              {
+                // DPrintf("\nWorker thread %" PRIuPTR " finished main regression for %u", tidx, variant_uidx);
+                // RSS = y^T y - y^T X (X^T X)^{-1} X^T y
+                //     = cur_pheno_ssq - xt_y * fitted_coefs
+                // s^2 = RSS / df
+                // possible todo: improve numerical stability of this computation
+                // in non-mean-centered phenotype case
+                const double sigma = (cur_pheno_ssq - DotprodxD(xt_y, fitted_coefs, cur_predictor_ct)) / u31tod(nm_sample_ct - cur_predictor_ct);
+                for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
+                  double* s_iter = &(xtx_inv[uii * cur_predictor_ct]);
 #ifdef NOLAPACK
-                for (uint32_t ujj = 0; ujj != cur_predictor_ct; ++ujj) {
-                  s_iter[ujj] *= sigma;
-                }
+                  for (uint32_t ujj = 0; ujj != cur_predictor_ct; ++ujj) {
+                    s_iter[ujj] *= sigma;
+                  }
 #else
-                for (uint32_t ujj = 0; ujj <= uii; ++ujj) {
-                  s_iter[ujj] *= sigma;
-                }
+                  for (uint32_t ujj = 0; ujj <= uii; ++ujj) {
+                    s_iter[ujj] *= sigma;
+                  }
 #endif
-              }
-              // validParameters() check
-              for (uint32_t pred_uidx = 1; pred_uidx != cur_predictor_ct; ++pred_uidx) {
-                const double xtx_inv_diag_element = xtx_inv[pred_uidx * (cur_predictor_ct + 1)];
-                if (xtx_inv_diag_element < 1e-20) {
-                  glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
-                  goto GlmLinearThread_skip_regression;
                 }
-                // use dbl_2d_buf[] to store diagonal square roots
-                dbl_2d_buf[pred_uidx] = sqrt(xtx_inv_diag_element);
-              }
-              dbl_2d_buf[0] = sqrt(xtx_inv[0]);
-              for (uint32_t pred_uidx = 1; pred_uidx != cur_predictor_ct; ++pred_uidx) {
-                const double cur_xtx_inv_diag_sqrt = 0.99999 * dbl_2d_buf[pred_uidx];
-                const double* xtx_inv_row = &(xtx_inv[pred_uidx * cur_predictor_ct]);
-                for (uint32_t pred_uidx2 = 0; pred_uidx2 != pred_uidx; ++pred_uidx2) {
-                  if (xtx_inv_row[pred_uidx2] > cur_xtx_inv_diag_sqrt * dbl_2d_buf[pred_uidx2]) {
+                // validParameters() check
+                for (uint32_t pred_uidx = 1; pred_uidx != cur_predictor_ct; ++pred_uidx) {
+                  const double xtx_inv_diag_element = xtx_inv[pred_uidx * (cur_predictor_ct + 1)];
+                  if (xtx_inv_diag_element < 1e-20) {
                     glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
                     goto GlmLinearThread_skip_regression;
                   }
+                  // use dbl_2d_buf[] to store diagonal square roots
+                  dbl_2d_buf[pred_uidx] = sqrt(xtx_inv_diag_element);
                 }
-              }
-              double* beta_se_iter2 = beta_se_iter;
-              for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
-                // In the multiallelic-fused case, if the first allele is
-                // constant, this writes the beta/se values for the first
-                // nonconstant, non-omitted allele where the results for the
-                // first allele belong.  We correct that below.
-                *beta_se_iter2++ = fitted_coefs[pred_uidx];
-                *beta_se_iter2++ = dbl_2d_buf[pred_uidx];
-              }
-              // move this up since dbl_2d_buf may be clobbered
-              if (cur_constraint_ct) {
-                const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
-                memcpy(beta_se_iter2, &glm_err2, 8);
-                ++beta_se_iter2;
-                *beta_se_iter2++ = -9.0;
-              }
-              if (!const_allele_ct) {
-                if (beta_se_multiallelic_fused || (!hide_covar)) {
-                  for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-                    beta_se_iter2[2 * extra_allele_idx] = fitted_coefs[cur_biallelic_predictor_ct + extra_allele_idx];
-                    beta_se_iter2[2 * extra_allele_idx + 1] = dbl_2d_buf[cur_biallelic_predictor_ct + extra_allele_idx];
+                dbl_2d_buf[0] = sqrt(xtx_inv[0]);
+                for (uint32_t pred_uidx = 1; pred_uidx != cur_predictor_ct; ++pred_uidx) {
+                  const double cur_xtx_inv_diag_sqrt = 0.99999 * dbl_2d_buf[pred_uidx];
+                  const double* xtx_inv_row = &(xtx_inv[pred_uidx * cur_predictor_ct]);
+                  for (uint32_t pred_uidx2 = 0; pred_uidx2 != pred_uidx; ++pred_uidx2) {
+                    if (xtx_inv_row[pred_uidx2] > cur_xtx_inv_diag_sqrt * dbl_2d_buf[pred_uidx2]) {
+                      glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
+                      goto GlmLinearThread_skip_regression;
+                    }
                   }
                 }
-              } else if (!beta_se_multiallelic_fused) {
-                if (!hide_covar) {
-                  // Need to insert some {CONST_ALLELE, -9} entries.
+                double* beta_se_iter2 = beta_se_iter;
+                for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
+                  // In the multiallelic-fused case, if the first allele is
+                  // constant, this writes the beta/se values for the first
+                  // nonconstant, non-omitted allele where the results for the
+                  // first allele belong.  We correct that below.
+                  *beta_se_iter2++ = fitted_coefs[pred_uidx];
+                  *beta_se_iter2++ = dbl_2d_buf[pred_uidx];
+                }
+                // move this up since dbl_2d_buf may be clobbered
+                if (cur_constraint_ct) {
+                  const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
+                  memcpy(beta_se_iter2, &glm_err2, 8);
+                  ++beta_se_iter2;
+                  *beta_se_iter2++ = -9.0;
+                }
+                if (!const_allele_ct) {
+                  if (beta_se_multiallelic_fused || (!hide_covar)) {
+                    for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                      beta_se_iter2[2 * extra_allele_idx] = fitted_coefs[cur_biallelic_predictor_ct + extra_allele_idx];
+                      beta_se_iter2[2 * extra_allele_idx + 1] = dbl_2d_buf[cur_biallelic_predictor_ct + extra_allele_idx];
+                    }
+                  }
+                } else if (!beta_se_multiallelic_fused) {
+                  if (!hide_covar) {
+                    // Need to insert some {CONST_ALLELE, -9} entries.
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
+                    const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
+                    uint32_t extra_read_allele_idx = 0;
+                    uint32_t extra_write_allele_idx = 0;
+                    for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                      if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
+                        continue;
+                      }
+                      if (IsSet(const_alleles, allele_idx)) {
+                        memcpy(&(beta_se_iter2[2 * extra_write_allele_idx]), &glm_err2, 8);
+                        beta_se_iter2[2 * extra_write_allele_idx + 1] = -9.0;
+                      } else {
+                        beta_se_iter2[2 * extra_write_allele_idx] = fitted_coefs[cur_biallelic_predictor_ct + extra_read_allele_idx];
+                        beta_se_iter2[2 * extra_write_allele_idx + 1] = dbl_2d_buf[cur_biallelic_predictor_ct + extra_read_allele_idx];
+                        ++extra_read_allele_idx;
+                      }
+                      ++extra_write_allele_idx;
+                    }
+                  }
+                } else {
                   const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                  const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
-                  uint32_t extra_read_allele_idx = 0;
+                  // Special-case first nonconst allele since it's positioned
+                  // discontinuously, and its BETA/SE may already be correctly
+                  // filled.
+                  uint32_t allele_idx = omitted_allele_idx? 0 : 1;
                   uint32_t extra_write_allele_idx = 0;
-                  for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                    if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
+                  if (IsSet(const_alleles, allele_idx)) {
+                    memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
+                    beta_se_iter[2 * include_intercept + 1] = -9.0;
+                    allele_idx = AdvTo0Bit(const_alleles, 1);
+                    if (allele_idx == omitted_allele_idx) {
+                      allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
+                    }
+                    extra_write_allele_idx = allele_idx - 1 - (allele_idx > omitted_allele_idx);
+                    for (uint32_t uii = 0; uii != extra_write_allele_idx; ++uii) {
+                      memcpy(&(beta_se_iter2[2 * uii]), &glm_err2, 8);
+                      beta_se_iter2[2 * uii + 1] = -9.0;
+                    }
+                    beta_se_iter2[2 * extra_write_allele_idx] = fitted_coefs[1];
+                    beta_se_iter2[2 * extra_write_allele_idx + 1] = dbl_2d_buf[1];
+                    ++extra_write_allele_idx;
+                  }
+                  ++allele_idx;
+                  uint32_t nonconst_allele_idx_m1 = 0;
+                  for (; allele_idx != allele_ct; ++allele_idx) {
+                    if (allele_idx == omitted_allele_idx) {
                       continue;
                     }
-                    if (IsSet(const_alleles, allele_idx)) {
+                    if (!IsSet(const_alleles, allele_idx)) {
+                      beta_se_iter2[2 * extra_write_allele_idx] = fitted_coefs[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
+                      beta_se_iter2[2 * extra_write_allele_idx + 1] = dbl_2d_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
+                      ++nonconst_allele_idx_m1;
+                    } else {
                       memcpy(&(beta_se_iter2[2 * extra_write_allele_idx]), &glm_err2, 8);
                       beta_se_iter2[2 * extra_write_allele_idx + 1] = -9.0;
-                    } else {
-                      beta_se_iter2[2 * extra_write_allele_idx] = fitted_coefs[cur_biallelic_predictor_ct + extra_read_allele_idx];
-                      beta_se_iter2[2 * extra_write_allele_idx + 1] = dbl_2d_buf[cur_biallelic_predictor_ct + extra_read_allele_idx];
-                      ++extra_read_allele_idx;
                     }
                     ++extra_write_allele_idx;
                   }
                 }
-              } else {
-                const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                // Special-case first nonconst allele since it's positioned
-                // discontinuously, and its BETA/SE may already be correctly
-                // filled.
-                uint32_t allele_idx = omitted_allele_idx? 0 : 1;
-                uint32_t extra_write_allele_idx = 0;
-                if (IsSet(const_alleles, allele_idx)) {
-                  memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
-                  beta_se_iter[2 * include_intercept + 1] = -9.0;
-                  allele_idx = AdvTo0Bit(const_alleles, 1);
-                  if (allele_idx == omitted_allele_idx) {
-                    allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
-                  }
-                  extra_write_allele_idx = allele_idx - 1 - (allele_idx > omitted_allele_idx);
-                  for (uint32_t uii = 0; uii != extra_write_allele_idx; ++uii) {
-                    memcpy(&(beta_se_iter2[2 * uii]), &glm_err2, 8);
-                    beta_se_iter2[2 * uii + 1] = -9.0;
-                  }
-                  beta_se_iter2[2 * extra_write_allele_idx] = fitted_coefs[1];
-                  beta_se_iter2[2 * extra_write_allele_idx + 1] = dbl_2d_buf[1];
-                  ++extra_write_allele_idx;
-                }
-                ++allele_idx;
-                uint32_t nonconst_allele_idx_m1 = 0;
-                for (; allele_idx != allele_ct; ++allele_idx) {
-                  if (allele_idx == omitted_allele_idx) {
-                    continue;
-                  }
-                  if (!IsSet(const_alleles, allele_idx)) {
-                    beta_se_iter2[2 * extra_write_allele_idx] = fitted_coefs[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
-                    beta_se_iter2[2 * extra_write_allele_idx + 1] = dbl_2d_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
-                    ++nonconst_allele_idx_m1;
-                  } else {
-                    memcpy(&(beta_se_iter2[2 * extra_write_allele_idx]), &glm_err2, 8);
-                    beta_se_iter2[2 * extra_write_allele_idx + 1] = -9.0;
+                if (cur_constraint_ct) {
+                  uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 1.0;
                   }
-                  ++extra_write_allele_idx;
-                }
-              }
-              if (cur_constraint_ct) {
-                uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 1.0;
-                }
 #ifndef NOLAPACK
-                // xtx_inv upper triangle was not filled
-                ReflectMatrix(cur_predictor_ct, xtx_inv);
+                  // xtx_inv upper triangle was not filled
+                  ReflectMatrix(cur_predictor_ct, xtx_inv);
 #endif
-                double chisq;
-                if (!LinearHypothesisChisq(fitted_coefs, cur_constraints_con_major, xtx_inv, cur_constraint_ct, cur_predictor_ct, cur_predictor_ct, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inv_1d_buf, dbl_2d_buf)) {
-                  beta_se_iter2[-1] = chisq;
-                }
-                // next test may have different alt allele count
-                joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 0.0;
+                  double chisq;
+                  if (!LinearHypothesisChisq(fitted_coefs, cur_constraints_con_major, xtx_inv, cur_constraint_ct, cur_predictor_ct, cur_predictor_ct, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inv_1d_buf, dbl_2d_buf)) {
+                    beta_se_iter2[-1] = chisq;
+                  }
+                  // next test may have different alt allele count
+                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 0.0;
+                  }
                 }
               }
-            }
-            while (0) {
-            GlmLinearThread_skip_regression:
-              {
-                uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-                if (beta_se_multiallelic_fused || (!hide_covar)) {
-                  reported_ct += allele_ct_m2;
-                }
-                for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-                  memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-                  beta_se_iter[uii * 2 + 1] = -9.0;
+              while (0) {
+              GlmLinearThread_skip_regression:
+                {
+                  uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+                  if (beta_se_multiallelic_fused || (!hide_covar)) {
+                    reported_ct += allele_ct_m2;
+                  }
+                  for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                    memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                    beta_se_iter[uii * 2 + 1] = -9.0;
+                  }
                 }
               }
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
             }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
           }
-        }
-        // bugfix (1 Apr 2019): this needs to execute when regression is
-        // skipped
-        if (local_covars_iter) {
-          local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
+          // bugfix (1 Apr 2019): this needs to execute when regression is
+          // skipped
+          if (local_covars_iter) {
+            local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
+          }
         }
       }
     }
@@ -1803,6 +1823,11 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     } else {
       per_alt_allele_xalloc_byte_ct += 2 * max_reported_test_ct * sizeof(double);
     }
+    // PgenMtLoadInit() may reduce calc_thread_ct, but not increase it.
+    unsigned char* tdq_alloc;
+    if (unlikely(bigstack_alloc_uc(TaskDequesAllocCachelineCt(calc_thread_ct) * kCacheline, &tdq_alloc))) {
+      goto GlmLinear_ret_NOMEM;
+    }
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
     common->thread_mhc = nullptr;
     common->dosage_presents = nullptr;
@@ -1815,6 +1840,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
       goto GlmLinear_ret_NOMEM;
     }
+    InitTaskDeques(calc_thread_ct, tdq_alloc, &common->tdq);
     LinearAuxResult* linear_block_aux_bufs[2];
     double* block_beta_se_bufs[2];
 
@@ -2013,6 +2039,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
       if (variant_idx) {
         // DPrintf("\nWaiting for worker threads up to filtered variant %u", variant_idx);
         JoinThreads(&tg);
+        TaskDequesBlockDone(&common->tdq);
         reterr = S_CAST(PglErr, common->err_info);
         if (unlikely(reterr)) {
           PgenErrPrintNV(reterr, common->err_info >> 32);
@@ -2021,8 +2048,8 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
       }
       if (!IsLastBlock(&tg)) {
         common->cur_block_variant_ct = cur_block_variant_ct;
-        const uint32_t uidx_start = read_block_idx * read_block_size;
-        ComputeUidxStartPartition(variant_include, cur_block_variant_ct, calc_thread_ct, uidx_start, common->read_variant_uidx_starts);
+        common->read_variant_uidx_starts[0] = AdvTo1Bit(variant_include, read_block_idx * read_block_size);
+        ResetTaskDeques(cur_block_variant_ct, DivUp(cur_block_variant_ct, calc_thread_ct * 64), &common->tdq);
         PgrCopyBaseAndOffset(pgfip, calc_thread_ct, common->pgr_ptrs);
         ctx->block_aux = linear_block_aux_bufs[parity];
         common->block_beta_se = block_beta_se_bufs[parity];
@@ -2433,6 +2460,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     }
     fputs("\b\b", stdout);
     logputs("done.\n");
+    LogTaskDequesIdle("--glm linear regression", &common->tdq);
     logprintf("Results written to %s .\n", outname);
     *valid_allele_ct_ptr = valid_allele_ct;
   }
@@ -2536,6 +2564,8 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
   pgv.genovec = common->genovecs[tidx];
   pgv.dosage_present = nullptr;
   pgv.dosage_main = nullptr;
+  // PgrGetDifflistOrGenovec() doesn't touch this.
+  pgv.dosage_ct = 0;
   if (common->dosage_presents) {
     pgv.dosage_present = common->dosage_presents[tidx];
     pgv.dosage_main = common->dosage_mains[tidx];
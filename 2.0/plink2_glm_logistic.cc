@@ -1158,7 +1158,6 @@ THREAD_FUNC_DECL GlmLogisticThreadF(void* raw_arg) {
   const uintptr_t* sex_male_collapsed = common->sex_male_collapsed;
   const ChrInfo* cip = common->cip;
   const uint32_t* subset_chr_fo_vidx_start = common->subset_chr_fo_vidx_start;
-  const uint32_t calc_thread_ct = GetThreadCt(arg->sharedp);
   const GlmFlags glm_flags = common->glm_flags;
   const uint32_t add_interactions = (glm_flags / kfGlmInteraction) & 1;
   const uint32_t hide_covar = (glm_flags / kfGlmHideCovar) & 1;
@@ -1201,1260 +1200,1279 @@ THREAD_FUNC_DECL GlmLogisticThreadF(void* raw_arg) {
   uint64_t new_err_info = 0;
   do {
     const uintptr_t cur_block_variant_ct = common->cur_block_variant_ct;
-    uint32_t variant_bidx = (tidx * cur_block_variant_ct) / calc_thread_ct;
-    const uint32_t variant_bidx_end = ((tidx + 1) * cur_block_variant_ct) / calc_thread_ct;
-    uintptr_t variant_uidx_base;
-    uintptr_t variant_include_bits;
-    BitIter1Start(variant_include, common->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
-
-    double* beta_se_iter = common->block_beta_se;
-    uintptr_t allele_bidx = variant_bidx;
-    if (max_extra_allele_ct) {
-      allele_bidx = variant_bidx + CountExtraAlleles(variant_include, allele_idx_offsets, common->read_variant_uidx_starts[0], common->read_variant_uidx_starts[tidx], 0);
-    }
-    if (beta_se_multiallelic_fused) {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
-    } else {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
-    }
-
-    LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
-    const float* local_covars_iter = nullptr;
-    if (local_covar_ct) {
-      // &(nullptr[0]) is okay in C++, but undefined in C
-      local_covars_iter = &(ctx->local_covars_vcmaj_f[parity][variant_bidx * max_sample_ct * local_covar_ct]);
-    }
-    while (variant_bidx < variant_bidx_end) {
-      const uint32_t variant_idx = variant_bidx + variant_idx_offset;
-      const uint32_t chr_fo_idx = LastLeqU32(subset_chr_fo_vidx_start, 0, cip->chr_ct, variant_idx);
-      // const uint32_t chr_fo_idx = LowerBoundNonemptyU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
-      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
-      uint32_t cur_variant_bidx_end = subset_chr_fo_vidx_start[chr_fo_idx + 1] - variant_idx_offset;
-      if (cur_variant_bidx_end > variant_bidx_end) {
-        cur_variant_bidx_end = variant_bidx_end;
-      }
-      // "regular" = not all-female special case.
-      const uint32_t is_haploid = IsSet(cip->haploid_mask, chr_idx);
-      const uint32_t is_regular_x = is_haploid && (chr_idx == x_code);
-      const uint32_t is_y = (chr_idx == y_code);
-      const uint32_t is_nonx_haploid = is_haploid && (!is_regular_x);
-      const uintptr_t* cur_sample_include;
-      const uint32_t* cur_sample_include_cumulative_popcounts;
-      const uintptr_t* cur_pheno_cc;
-      const uintptr_t* cur_gcount_case_interleaved_vec;
-      const float* cur_pheno;
-      const RegressionNmPrecomp* nm_precomp;
-      const float* cur_covars_cmaj;
-      const uintptr_t* cur_parameter_subset;
-      const uintptr_t* cur_joint_test_params;
-      const CcResidualizeCtx* cur_cc_residualize;
-      uint32_t cur_sample_ct;
-      uint32_t cur_covar_ct;
-      uint32_t cur_constraint_ct;
-      uint32_t cur_is_always_firth;
-      if (is_y && common->sample_include_y) {
-        cur_sample_include = common->sample_include_y;
-        cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_y_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_y;
-        cur_pheno = ctx->pheno_y_f;
-        nm_precomp = common->nm_precomp_y;
-        cur_covars_cmaj = ctx->covars_cmaj_y_f;
-        cur_parameter_subset = common->parameter_subset_y;
-        cur_joint_test_params = common->joint_test_params_y;
-        cur_cc_residualize = ctx->cc_residualize_y;
-        cur_sample_ct = common->sample_ct_y;
-        cur_covar_ct = common->covar_ct_y;
-        cur_constraint_ct = common->constraint_ct_y;
-        cur_is_always_firth = is_always_firth || ctx->separation_found_y;
-      } else if (is_regular_x && common->sample_include_x) {
-        cur_sample_include = common->sample_include_x;
-        cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_x_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_x;
-        cur_pheno = ctx->pheno_x_f;
-        nm_precomp = common->nm_precomp_x;
-        cur_covars_cmaj = ctx->covars_cmaj_x_f;
-        cur_parameter_subset = common->parameter_subset_x;
-        cur_joint_test_params = common->joint_test_params_x;
-        cur_cc_residualize = ctx->cc_residualize_x;
-        cur_sample_ct = common->sample_ct_x;
-        cur_covar_ct = common->covar_ct_x;
-        cur_constraint_ct = common->constraint_ct_x;
-        cur_is_always_firth = is_always_firth || ctx->separation_found_x;
-      } else {
-        cur_sample_include = common->sample_include;
-        cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec;
-        cur_pheno = ctx->pheno_f;
-        nm_precomp = common->nm_precomp;
-        cur_covars_cmaj = ctx->covars_cmaj_f;
-        cur_parameter_subset = common->parameter_subset;
-        cur_joint_test_params = common->joint_test_params;
-        cur_cc_residualize = ctx->cc_residualize;
-        cur_sample_ct = common->sample_ct;
-        cur_covar_ct = common->covar_ct;
-        cur_constraint_ct = common->constraint_ct;
-        cur_is_always_firth = is_always_firth || ctx->separation_found;
+    const uint32_t block_uidx_start = common->read_variant_uidx_starts[0];
+    uint32_t task_bidx_start;
+    uint32_t variant_bidx_end;
+    // Tasks taken from our own range arrive in increasing order, so the
+    // variant_include scan resumes from the previous task start unless we
+    // just stole an earlier range.
+    uint32_t prev_task_bidx_start = 0;
+    uint32_t prev_task_uidx_start = block_uidx_start;
+    uintptr_t prev_task_extra_allele_ct = 0;
+    while (TaskDequesNext(tidx, &common->tdq, &task_bidx_start, &variant_bidx_end)) {
+      uint32_t variant_bidx = task_bidx_start;
+      if (task_bidx_start < prev_task_bidx_start) {
+        prev_task_bidx_start = 0;
+        prev_task_uidx_start = block_uidx_start;
+        prev_task_extra_allele_ct = 0;
       }
-      const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
-      const uint32_t sample_ctav = RoundUpPow2(cur_sample_ct, kFloatPerFVec);
-      const uint32_t cur_case_ct = PopcountWords(cur_pheno_cc, sample_ctl);
-      const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
-      uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
-      uint32_t literal_covar_ct = cur_covar_ct;
-      if (cur_parameter_subset) {
-        cur_biallelic_predictor_ct = PopcountWords(cur_parameter_subset, BitCtToWordCt(cur_biallelic_predictor_ct_base));
-        literal_covar_ct = PopcountBitRange(cur_parameter_subset, 2 + domdev_present, 2 + domdev_present + cur_covar_ct);
+      const uint32_t task_uidx_start = FindNth1BitFrom(variant_include, prev_task_uidx_start, task_bidx_start - prev_task_bidx_start + 1);
+      uintptr_t variant_uidx_base;
+      uintptr_t variant_include_bits;
+      BitIter1Start(variant_include, task_uidx_start, &variant_uidx_base, &variant_include_bits);
+
+      double* beta_se_iter = common->block_beta_se;
+      uintptr_t allele_bidx = variant_bidx;
+      if (max_extra_allele_ct) {
+        prev_task_extra_allele_ct += CountExtraAlleles(variant_include, allele_idx_offsets, prev_task_uidx_start, task_uidx_start, 0);
+        allele_bidx = variant_bidx + prev_task_extra_allele_ct;
       }
-      const uint32_t max_predictor_ct = cur_biallelic_predictor_ct + max_extra_allele_ct;
-      const uint32_t max_predictor_ctav = RoundUpPow2(max_predictor_ct, kFloatPerFVec);
-      uint32_t reported_pred_uidx_biallelic_end;
-      if (hide_covar) {
-        if (!cur_parameter_subset) {
-          reported_pred_uidx_biallelic_end = 2 + domdev_present;
-        } else {
-          reported_pred_uidx_biallelic_end = 1 + IsSet(cur_parameter_subset, 1) + domdev_present;
-        }
+      prev_task_bidx_start = task_bidx_start;
+      prev_task_uidx_start = task_uidx_start;
+      if (beta_se_multiallelic_fused) {
+        beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
       } else {
-        reported_pred_uidx_biallelic_end = cur_biallelic_predictor_ct;
-      }
-      // nm_predictors_pmaj_buf may require up to two extra columns omitted
-      // from the main regression.
-      // 1. In the multiallelic dominant/recessive/hetonly/hethom cases, the
-      //    original genotype column does not appear in the regression, and
-      //    we'd rather not reconstruct it from genovec, etc. when we need to
-      //    swap it out for another allele, so we keep the original genotype in
-      //    an extra column.
-      //    To reduce code bloat, we now handle the biallelic cases in the same
-      //    way; this is one of the more peripheral code paths so adding more
-      //    complexity to speed it up is less justifiable.
-      // 2. If --parameters excludes the main (possibly
-      //    dominant/recessive/hetonly) genotype column but does care about an
-      //    interaction, we want a copy of what the main genotype column's
-      //    contents would have been to refer to.
-      const uint32_t main_omitted = cur_parameter_subset && (!IsSet(cur_parameter_subset, 1));
-      const uint32_t main_mutated = model_dominant || model_recessive || model_hetonly || joint_hethom;
-      unsigned char* workspace_iter = workspace_buf;
-      uintptr_t* sample_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      uintptr_t* pheno_cc_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      uintptr_t* tmp_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      float* nm_pheno_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
-      float* nm_predictors_pmaj_buf = S_CAST(float*, arena_alloc_raw_rd((max_predictor_ct + main_mutated + main_omitted) * sample_ctav * sizeof(float), &workspace_iter));
-      float* coef_return = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(float), &workspace_iter));
-      float* hh_return = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
-      float* pp_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
-      float* sample_variance_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
-      float* gradient_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(float), &workspace_iter));
-      float* dcoef_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(float), &workspace_iter));
-      float* cholesky_decomp_return = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
-
-      double* semicomputed_biallelic_xtx = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
-      // currently overallocates
-      double* semicomputed_biallelic_corr_matrix = S_CAST(double*, arena_alloc_raw_rd((cur_biallelic_predictor_ct - 1) * (cur_biallelic_predictor_ct - 1) * sizeof(double), &workspace_iter));
-      double* semicomputed_biallelic_inv_corr_sqrts = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
-
-      MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, arena_alloc_raw_rd(max_predictor_ct * kMatrixInvertBuf1CheckedAlloc, &workspace_iter));
-      const uintptr_t dbl_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 7) * sizeof(double), kCacheline);
-      double* dbl_2d_buf = S_CAST(double*, arena_alloc_raw(dbl_2d_byte_ct, &workspace_iter));
-      double* a1_dosages = S_CAST(double*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(double) * 2, &workspace_iter));
-      double* a1_case_dosages = &(a1_dosages[max_extra_allele_ct + 2]);
-      uint64_t* machr2_dosage_sums = S_CAST(uint64_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(uint64_t) * 2, &workspace_iter));
-      uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
-      uint32_t* case_one_cts = nullptr;
-      uint32_t* case_two_cts = nullptr;
-      if (cur_gcount_case_interleaved_vec && max_extra_allele_ct) {
-        case_one_cts = S_CAST(uint32_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(int32_t) * 2, &workspace_iter));
-        case_two_cts = &(case_one_cts[max_extra_allele_ct + 2]);
-      }
-      float* predictor_dotprod_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ct * sizeof(float), &workspace_iter));
-      const uintptr_t other_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 3) * sizeof(double), kCacheline);
-      double* inverse_corr_buf = S_CAST(double*, arena_alloc_raw(other_2d_byte_ct, &workspace_iter));
-
-      // these could use the same memory, but not a big deal, use the less
-      // bug-prone approach for now
-      // Firth-only
-      float* hdiag_buf = nullptr;
-      float* score_buf = nullptr;
-      float* hh0_buf = nullptr;
-      float* tmpnxk_buf = nullptr;
-      if (is_sometimes_firth) {
-        hdiag_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
-        score_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
-        hh0_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
-        tmpnxk_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * sample_ctav * sizeof(float), &workspace_iter));
-      }
-      float* mean_centered_pmaj_buf = nullptr;
-      float* sample_offsets_buf = nullptr;
-      if (cur_cc_residualize) {
-        mean_centered_pmaj_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float) * (domdev_present_p1 + max_extra_allele_ct), &workspace_iter));
-        sample_offsets_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+        beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
       }
 
-      // joint test only
-      float* tmphxs_buf = nullptr;
-      float* h_transpose_buf = nullptr;
-      float* inner_buf = nullptr;
-      float* outer_buf = nullptr;
-      float* cur_constraints_con_major = nullptr;
-      if (cur_constraint_ct) {
-        tmphxs_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
-        h_transpose_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
-        inner_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * cur_constraint_ct * sizeof(float), &workspace_iter));
-        outer_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * sizeof(float), &workspace_iter));
-        // bugfix (27 Jan 2019): forgot sizeof(float) here
-        cur_constraints_con_major = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(float), &workspace_iter));
-        ZeroFArr(cur_constraint_ct * max_predictor_ct, cur_constraints_con_major);
-        const uint32_t first_joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-        cur_constraints_con_major[first_joint_test_idx] = 1.0;
-        // Rest of this matrix must be updated later, since cur_predictor_ct
-        // changes at multiallelic variants.
-      }
-      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLogisticWorkspaceSizeF(cur_sample_ct, cur_biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, cur_gcount_case_interleaved_vec != nullptr, is_sometimes_firth, cur_cc_residualize != nullptr));
-      const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
-      const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
-      const double* corr_inv = nullptr;
-      if (nm_precomp) {
-        memcpy(semicomputed_biallelic_xtx, nm_precomp->xtx_image, cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double));
-        corr_inv = nm_precomp->corr_inv;
-        const uintptr_t nongeno_pred_ct = cur_biallelic_predictor_ct - domdev_present - 2;
-        const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
-        memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
-        memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
+      LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
+      const float* local_covars_iter = nullptr;
+      if (local_covar_ct) {
+        // &(nullptr[0]) is okay in C++, but undefined in C
+        local_covars_iter = &(ctx->local_covars_vcmaj_f[parity][variant_bidx * max_sample_ct * local_covar_ct]);
       }
-      PgrSampleSubsetIndex pssi;
-      PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
-      // when this is set, the last fully-processed variant had no missing
-      // genotypes, and if the current variant also has no missing genotypes we
-      // may be able to skip reinitialization of most of
-      // nm_predictors_pmaj_buf.
-      // (todo: do we want to track prev_biallelic_nm?)
-      uint32_t prev_nm = 0;
-
-      STD_ARRAY_DECL(uint32_t, 4, genocounts);
-      for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
-        const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
-        if (allele_idx_offsets) {
-          allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
-          if (!beta_se_multiallelic_fused) {
-            extra_regression_ct = allele_ct - 2;
-          }
+      while (variant_bidx < variant_bidx_end) {
+        const uint32_t variant_idx = variant_bidx + variant_idx_offset;
+        const uint32_t chr_fo_idx = LastLeqU32(subset_chr_fo_vidx_start, 0, cip->chr_ct, variant_idx);
+        // const uint32_t chr_fo_idx = LowerBoundNonemptyU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
+        const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+        uint32_t cur_variant_bidx_end = subset_chr_fo_vidx_start[chr_fo_idx + 1] - variant_idx_offset;
+        if (cur_variant_bidx_end > variant_bidx_end) {
+          cur_variant_bidx_end = variant_bidx_end;
         }
-        const uint32_t allele_ct_m2 = allele_ct - 2;
-        const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
-        PglErr reterr;
-        if (!allele_ct_m2) {
-          reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+        // "regular" = not all-female special case.
+        const uint32_t is_haploid = IsSet(cip->haploid_mask, chr_idx);
+        const uint32_t is_regular_x = is_haploid && (chr_idx == x_code);
+        const uint32_t is_y = (chr_idx == y_code);
+        const uint32_t is_nonx_haploid = is_haploid && (!is_regular_x);
+        const uintptr_t* cur_sample_include;
+        const uint32_t* cur_sample_include_cumulative_popcounts;
+        const uintptr_t* cur_pheno_cc;
+        const uintptr_t* cur_gcount_case_interleaved_vec;
+        const float* cur_pheno;
+        const RegressionNmPrecomp* nm_precomp;
+        const float* cur_covars_cmaj;
+        const uintptr_t* cur_parameter_subset;
+        const uintptr_t* cur_joint_test_params;
+        const CcResidualizeCtx* cur_cc_residualize;
+        uint32_t cur_sample_ct;
+        uint32_t cur_covar_ct;
+        uint32_t cur_constraint_ct;
+        uint32_t cur_is_always_firth;
+        if (is_y && common->sample_include_y) {
+          cur_sample_include = common->sample_include_y;
+          cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
+          cur_pheno_cc = ctx->pheno_y_cc;
+          cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_y;
+          cur_pheno = ctx->pheno_y_f;
+          nm_precomp = common->nm_precomp_y;
+          cur_covars_cmaj = ctx->covars_cmaj_y_f;
+          cur_parameter_subset = common->parameter_subset_y;
+          cur_joint_test_params = common->joint_test_params_y;
+          cur_cc_residualize = ctx->cc_residualize_y;
+          cur_sample_ct = common->sample_ct_y;
+          cur_covar_ct = common->covar_ct_y;
+          cur_constraint_ct = common->constraint_ct_y;
+          cur_is_always_firth = is_always_firth || ctx->separation_found_y;
+        } else if (is_regular_x && common->sample_include_x) {
+          cur_sample_include = common->sample_include_x;
+          cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
+          cur_pheno_cc = ctx->pheno_x_cc;
+          cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_x;
+          cur_pheno = ctx->pheno_x_f;
+          nm_precomp = common->nm_precomp_x;
+          cur_covars_cmaj = ctx->covars_cmaj_x_f;
+          cur_parameter_subset = common->parameter_subset_x;
+          cur_joint_test_params = common->joint_test_params_x;
+          cur_cc_residualize = ctx->cc_residualize_x;
+          cur_sample_ct = common->sample_ct_x;
+          cur_covar_ct = common->covar_ct_x;
+          cur_constraint_ct = common->constraint_ct_x;
+          cur_is_always_firth = is_always_firth || ctx->separation_found_x;
         } else {
-          reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
-          // todo: proper multiallelic dosage support
+          cur_sample_include = common->sample_include;
+          cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
+          cur_pheno_cc = ctx->pheno_cc;
+          cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec;
+          cur_pheno = ctx->pheno_f;
+          nm_precomp = common->nm_precomp;
+          cur_covars_cmaj = ctx->covars_cmaj_f;
+          cur_parameter_subset = common->parameter_subset;
+          cur_joint_test_params = common->joint_test_params;
+          cur_cc_residualize = ctx->cc_residualize;
+          cur_sample_ct = common->sample_ct;
+          cur_covar_ct = common->covar_ct;
+          cur_constraint_ct = common->constraint_ct;
+          cur_is_always_firth = is_always_firth || ctx->separation_found;
         }
-        if (unlikely(reterr)) {
-          new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-          goto GlmLogisticThreadF_err;
+        const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
+        const uint32_t sample_ctav = RoundUpPow2(cur_sample_ct, kFloatPerFVec);
+        const uint32_t cur_case_ct = PopcountWords(cur_pheno_cc, sample_ctl);
+        const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
+        uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
+        uint32_t literal_covar_ct = cur_covar_ct;
+        if (cur_parameter_subset) {
+          cur_biallelic_predictor_ct = PopcountWords(cur_parameter_subset, BitCtToWordCt(cur_biallelic_predictor_ct_base));
+          literal_covar_ct = PopcountBitRange(cur_parameter_subset, 2 + domdev_present, 2 + domdev_present + cur_covar_ct);
         }
-        ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-        GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
-        uint32_t missing_ct = genocounts[3];
-        if (!missing_ct) {
-          SetAllBits(cur_sample_ct, sample_nm);
-        } else {
-          GenoarrToNonmissing(pgv.genovec, cur_sample_ct, sample_nm);
-          if (pgv.dosage_ct) {
-            BitvecOr(pgv.dosage_present, sample_ctl, sample_nm);
-            missing_ct = cur_sample_ct - PopcountWords(sample_nm, sample_ctl);
+        const uint32_t max_predictor_ct = cur_biallelic_predictor_ct + max_extra_allele_ct;
+        const uint32_t max_predictor_ctav = RoundUpPow2(max_predictor_ct, kFloatPerFVec);
+        uint32_t reported_pred_uidx_biallelic_end;
+        if (hide_covar) {
+          if (!cur_parameter_subset) {
+            reported_pred_uidx_biallelic_end = 2 + domdev_present;
+          } else {
+            reported_pred_uidx_biallelic_end = 1 + IsSet(cur_parameter_subset, 1) + domdev_present;
           }
+        } else {
+          reported_pred_uidx_biallelic_end = cur_biallelic_predictor_ct;
         }
-        if (omitted_alleles) {
-          omitted_allele_idx = omitted_alleles[variant_uidx];
+        // nm_predictors_pmaj_buf may require up to two extra columns omitted
+        // from the main regression.
+        // 1. In the multiallelic dominant/recessive/hetonly/hethom cases, the
+        //    original genotype column does not appear in the regression, and
+        //    we'd rather not reconstruct it from genovec, etc. when we need to
+        //    swap it out for another allele, so we keep the original genotype in
+        //    an extra column.
+        //    To reduce code bloat, we now handle the biallelic cases in the same
+        //    way; this is one of the more peripheral code paths so adding more
+        //    complexity to speed it up is less justifiable.
+        // 2. If --parameters excludes the main (possibly
+        //    dominant/recessive/hetonly) genotype column but does care about an
+        //    interaction, we want a copy of what the main genotype column's
+        //    contents would have been to refer to.
+        const uint32_t main_omitted = cur_parameter_subset && (!IsSet(cur_parameter_subset, 1));
+        const uint32_t main_mutated = model_dominant || model_recessive || model_hetonly || joint_hethom;
+        unsigned char* workspace_iter = workspace_buf;
+        uintptr_t* sample_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        uintptr_t* pheno_cc_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        uintptr_t* tmp_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        float* nm_pheno_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+        float* nm_predictors_pmaj_buf = S_CAST(float*, arena_alloc_raw_rd((max_predictor_ct + main_mutated + main_omitted) * sample_ctav * sizeof(float), &workspace_iter));
+        float* coef_return = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(float), &workspace_iter));
+        float* hh_return = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
+        float* pp_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+        float* sample_variance_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+        float* gradient_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(float), &workspace_iter));
+        float* dcoef_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(float), &workspace_iter));
+        float* cholesky_decomp_return = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
+
+        double* semicomputed_biallelic_xtx = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+        // currently overallocates
+        double* semicomputed_biallelic_corr_matrix = S_CAST(double*, arena_alloc_raw_rd((cur_biallelic_predictor_ct - 1) * (cur_biallelic_predictor_ct - 1) * sizeof(double), &workspace_iter));
+        double* semicomputed_biallelic_inv_corr_sqrts = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+
+        MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, arena_alloc_raw_rd(max_predictor_ct * kMatrixInvertBuf1CheckedAlloc, &workspace_iter));
+        const uintptr_t dbl_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 7) * sizeof(double), kCacheline);
+        double* dbl_2d_buf = S_CAST(double*, arena_alloc_raw(dbl_2d_byte_ct, &workspace_iter));
+        double* a1_dosages = S_CAST(double*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(double) * 2, &workspace_iter));
+        double* a1_case_dosages = &(a1_dosages[max_extra_allele_ct + 2]);
+        uint64_t* machr2_dosage_sums = S_CAST(uint64_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(uint64_t) * 2, &workspace_iter));
+        uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
+        uint32_t* case_one_cts = nullptr;
+        uint32_t* case_two_cts = nullptr;
+        if (cur_gcount_case_interleaved_vec && max_extra_allele_ct) {
+          case_one_cts = S_CAST(uint32_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(int32_t) * 2, &workspace_iter));
+          case_two_cts = &(case_one_cts[max_extra_allele_ct + 2]);
         }
-        // Once sizeof(AlleleCode) > 1, we probably want to allocate this from
-        // g_bigstack instead of the thread stack.
-        uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
-        const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
-        ZeroWArr(allele_ctl, const_alleles);
-        const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
-        const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
-        const uint32_t nm_sample_ctav = RoundUpPow2(nm_sample_ct, kFloatPerFVec);
-        const uint32_t nm_sample_ct_rem = nm_sample_ctav - nm_sample_ct;
-        // first predictor column: intercept
-        if (!prev_nm) {
-          FillFVec(nm_sample_ct, S_CAST(float, 1.0), nm_predictors_pmaj_buf);
+        float* predictor_dotprod_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ct * sizeof(float), &workspace_iter));
+        const uintptr_t other_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 3) * sizeof(double), kCacheline);
+        double* inverse_corr_buf = S_CAST(double*, arena_alloc_raw(other_2d_byte_ct, &workspace_iter));
+
+        // these could use the same memory, but not a big deal, use the less
+        // bug-prone approach for now
+        // Firth-only
+        float* hdiag_buf = nullptr;
+        float* score_buf = nullptr;
+        float* hh0_buf = nullptr;
+        float* tmpnxk_buf = nullptr;
+        if (is_sometimes_firth) {
+          hdiag_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+          score_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+          hh0_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
+          tmpnxk_buf = S_CAST(float*, arena_alloc_raw_rd(max_predictor_ct * sample_ctav * sizeof(float), &workspace_iter));
         }
-        // second predictor column: genotype
-        float* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
-        if (main_mutated || main_omitted) {
-          // bugfix (9 Oct 2024)
-          ZeroFArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
-          genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ctav]);
+        float* mean_centered_pmaj_buf = nullptr;
+        float* sample_offsets_buf = nullptr;
+        if (cur_cc_residualize) {
+          mean_centered_pmaj_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float) * (domdev_present_p1 + max_extra_allele_ct), &workspace_iter));
+          sample_offsets_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
         }
-        CopyBitarrSubset(cur_pheno_cc, sample_nm, nm_sample_ct, pheno_cc_nm);
-        const uint32_t nm_case_ct = PopcountWords(pheno_cc_nm, nm_sample_ctl);
-        float* multi_start = nullptr;
-        if (!allele_ct_m2) {
-          if (omitted_allele_idx) {
-            GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
-            // ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-            if (pgv.dosage_ct) {
-              BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
+
+        // joint test only
+        float* tmphxs_buf = nullptr;
+        float* h_transpose_buf = nullptr;
+        float* inner_buf = nullptr;
+        float* outer_buf = nullptr;
+        float* cur_constraints_con_major = nullptr;
+        if (cur_constraint_ct) {
+          tmphxs_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
+          h_transpose_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(float), &workspace_iter));
+          inner_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * cur_constraint_ct * sizeof(float), &workspace_iter));
+          outer_buf = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * sizeof(float), &workspace_iter));
+          // bugfix (27 Jan 2019): forgot sizeof(float) here
+          cur_constraints_con_major = S_CAST(float*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(float), &workspace_iter));
+          ZeroFArr(cur_constraint_ct * max_predictor_ct, cur_constraints_con_major);
+          const uint32_t first_joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+          cur_constraints_con_major[first_joint_test_idx] = 1.0;
+          // Rest of this matrix must be updated later, since cur_predictor_ct
+          // changes at multiallelic variants.
+        }
+        assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLogisticWorkspaceSizeF(cur_sample_ct, cur_biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, cur_gcount_case_interleaved_vec != nullptr, is_sometimes_firth, cur_cc_residualize != nullptr));
+        const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
+        const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
+        const double* corr_inv = nullptr;
+        if (nm_precomp) {
+          memcpy(semicomputed_biallelic_xtx, nm_precomp->xtx_image, cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double));
+          corr_inv = nm_precomp->corr_inv;
+          const uintptr_t nongeno_pred_ct = cur_biallelic_predictor_ct - domdev_present - 2;
+          const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
+          memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
+          memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
+        }
+        PgrSampleSubsetIndex pssi;
+        PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
+        // when this is set, the last fully-processed variant had no missing
+        // genotypes, and if the current variant also has no missing genotypes we
+        // may be able to skip reinitialization of most of
+        // nm_predictors_pmaj_buf.
+        // (todo: do we want to track prev_biallelic_nm?)
+        uint32_t prev_nm = 0;
+
+        STD_ARRAY_DECL(uint32_t, 4, genocounts);
+        for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
+          const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
+          if (allele_idx_offsets) {
+            allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
+            if (!beta_se_multiallelic_fused) {
+              extra_regression_ct = allele_ct - 2;
             }
-            const uint32_t uii = genocounts[0];
-            genocounts[0] = genocounts[2];
-            genocounts[2] = uii;
           }
-          uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
-          uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
+          const uint32_t allele_ct_m2 = allele_ct - 2;
+          const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
+          PglErr reterr;
+          if (!allele_ct_m2) {
+            reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+          } else {
+            reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
+            // todo: proper multiallelic dosage support
+          }
+          if (unlikely(reterr)) {
+            new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+            goto GlmLogisticThreadF_err;
+          }
+          ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+          GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+          uint32_t missing_ct = genocounts[3];
           if (!missing_ct) {
-            GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, genotype_vals);
+            SetAllBits(cur_sample_ct, sample_nm);
+          } else {
+            GenoarrToNonmissing(pgv.genovec, cur_sample_ct, sample_nm);
             if (pgv.dosage_ct) {
-              uintptr_t sample_idx_base = 0;
-              uintptr_t dosage_present_bits = pgv.dosage_present[0];
-              for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
-                const uint32_t dosage_val = pgv.dosage_main[dosage_idx];
-                // 32768 -> 2, 16384 -> 1, 0 -> 0
-                genotype_vals[sample_idx] = kRecipDosageMidf * u31tof(dosage_val);
-                dosage_sum += dosage_val;
-                dosage_ssq += dosage_val * dosage_val;
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
-                if (cur_geno && (cur_geno != 3)) {
-                  const uintptr_t prev_val = cur_geno * kDosageMid;
-                  dosage_sum -= prev_val;
-                  dosage_ssq -= prev_val * prev_val;
-                }
+              BitvecOr(pgv.dosage_present, sample_ctl, sample_nm);
+              missing_ct = cur_sample_ct - PopcountWords(sample_nm, sample_ctl);
+            }
+          }
+          if (omitted_alleles) {
+            omitted_allele_idx = omitted_alleles[variant_uidx];
+          }
+          // Once sizeof(AlleleCode) > 1, we probably want to allocate this from
+          // g_bigstack instead of the thread stack.
+          uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
+          const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
+          ZeroWArr(allele_ctl, const_alleles);
+          const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
+          const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
+          const uint32_t nm_sample_ctav = RoundUpPow2(nm_sample_ct, kFloatPerFVec);
+          const uint32_t nm_sample_ct_rem = nm_sample_ctav - nm_sample_ct;
+          // first predictor column: intercept
+          if (!prev_nm) {
+            FillFVec(nm_sample_ct, S_CAST(float, 1.0), nm_predictors_pmaj_buf);
+          }
+          // second predictor column: genotype
+          float* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
+          if (main_mutated || main_omitted) {
+            // bugfix (9 Oct 2024)
+            ZeroFArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
+            genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ctav]);
+          }
+          CopyBitarrSubset(cur_pheno_cc, sample_nm, nm_sample_ct, pheno_cc_nm);
+          const uint32_t nm_case_ct = PopcountWords(pheno_cc_nm, nm_sample_ctl);
+          float* multi_start = nullptr;
+          if (!allele_ct_m2) {
+            if (omitted_allele_idx) {
+              GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
+              // ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+              if (pgv.dosage_ct) {
+                BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
               }
+              const uint32_t uii = genocounts[0];
+              genocounts[0] = genocounts[2];
+              genocounts[2] = uii;
             }
-          } else {
-            if (!pgv.dosage_ct) {
-              GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, genotype_vals);
-            } else {
-              uintptr_t sample_midx_base = 0;
-              uintptr_t sample_nm_bits = sample_nm[0];
-              uint32_t dosage_idx = 0;
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
-                float cur_val;
-                if (IsSet(pgv.dosage_present, sample_midx)) {
-                  const uint32_t dosage_val = pgv.dosage_main[dosage_idx++];
-                  cur_val = kRecipDosageMidf * u31tof(dosage_val);
+            uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
+            uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
+            if (!missing_ct) {
+              GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, genotype_vals);
+              if (pgv.dosage_ct) {
+                uintptr_t sample_idx_base = 0;
+                uintptr_t dosage_present_bits = pgv.dosage_present[0];
+                for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                  const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
+                  const uint32_t dosage_val = pgv.dosage_main[dosage_idx];
+                  // 32768 -> 2, 16384 -> 1, 0 -> 0
+                  genotype_vals[sample_idx] = kRecipDosageMidf * u31tof(dosage_val);
                   dosage_sum += dosage_val;
                   dosage_ssq += dosage_val * dosage_val;
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
                   if (cur_geno && (cur_geno != 3)) {
                     const uintptr_t prev_val = cur_geno * kDosageMid;
                     dosage_sum -= prev_val;
                     dosage_ssq -= prev_val * prev_val;
                   }
-                } else {
-                  // cur_geno != 3 guaranteed
-                  cur_val = kSmallFloats[cur_geno];
                 }
-                genotype_vals[sample_idx] = cur_val;
               }
-            }
-          }
-          // Check for constant genotype column.
-          // (Technically, we should recheck later in the chrX no-sex-covariate
-          // --xchr-model 1 corner case.)
-          if (!pgv.dosage_ct) {
-            if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
-              // bugfix (28 Mar 2020): didn't set the bit that actually
-              // mattered last week...
-              const_alleles[0] = 3;
-            }
-          } else if (pgv.dosage_ct == nm_sample_ct) {
-            if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
-              const_alleles[0] = 3;
-            }
-          }
-          machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
-          machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
-          machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
-          machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
-          if (cur_gcount_case_interleaved_vec) {
-            // gcountcc
-            STD_ARRAY_REF(uint32_t, 6) cur_geno_hardcall_cts = block_aux_iter->geno_hardcall_cts;
-            GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, R_CAST(STD_ARRAY_REF(uint32_t, 4), cur_geno_hardcall_cts));
-            for (uint32_t geno_hardcall_idx = 0; geno_hardcall_idx != 3; ++geno_hardcall_idx) {
-              cur_geno_hardcall_cts[3 + geno_hardcall_idx] = genocounts[geno_hardcall_idx] - cur_geno_hardcall_cts[geno_hardcall_idx];
-            }
-          }
-        } else {
-          // multiallelic.
-          // Update (18 Mar 2020): If some but not all alleles have constant
-          // dosages, we remove just those alleles from the regressions;
-          // trim-alts is not necessary to see what's going on with the other
-          // alleles.  To reduce parsing complexity, the number of output lines
-          // is not affected by this; the ones corresponding to the constant
-          // alleles have NA values.
-
-          // dosage_ct == 0 temporarily guaranteed if we reach here.
-          assert(!pgv.dosage_ct);
-          multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ctav]);
-          ZeroU64Arr(allele_ct, machr2_dosage_sums);
-          ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
-          // postpone multiply for now, since no multiallelic dosages
-          // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
-          // actual sums/ssqs later.
-          machr2_dosage_sums[0] = genocounts[1];
-          machr2_dosage_ssqs[0] = genocounts[0];
-          if (omitted_allele_idx) {
-            // Main genotype column starts as REF.
-            if (!missing_ct) {
-              GenoarrLookup16x4bx2(pgv.genovec, kSmallInvFloatPairs, nm_sample_ct, genotype_vals);
             } else {
-              GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallInvFloats, cur_sample_ct, genotype_vals);
-            }
-          }
-          uint32_t rare_allele_ct = allele_ct_m2;
-          float* alt1_start = nullptr;
-          float* rarealt_start = multi_start;
-          if (omitted_allele_idx != 1) {
-            if (omitted_allele_idx) {
-              alt1_start = multi_start;
-              ZeroFArr(nm_sample_ct_rem, &(alt1_start[nm_sample_ct]));
-              rarealt_start = &(rarealt_start[nm_sample_ctav]);
-              --rare_allele_ct;
-            } else {
-              alt1_start = genotype_vals;
+              if (!pgv.dosage_ct) {
+                GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, genotype_vals);
+              } else {
+                uintptr_t sample_midx_base = 0;
+                uintptr_t sample_nm_bits = sample_nm[0];
+                uint32_t dosage_idx = 0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
+                  float cur_val;
+                  if (IsSet(pgv.dosage_present, sample_midx)) {
+                    const uint32_t dosage_val = pgv.dosage_main[dosage_idx++];
+                    cur_val = kRecipDosageMidf * u31tof(dosage_val);
+                    dosage_sum += dosage_val;
+                    dosage_ssq += dosage_val * dosage_val;
+                    if (cur_geno && (cur_geno != 3)) {
+                      const uintptr_t prev_val = cur_geno * kDosageMid;
+                      dosage_sum -= prev_val;
+                      dosage_ssq -= prev_val * prev_val;
+                    }
+                  } else {
+                    // cur_geno != 3 guaranteed
+                    cur_val = kSmallFloats[cur_geno];
+                  }
+                  genotype_vals[sample_idx] = cur_val;
+                }
+              }
             }
-            if (!missing_ct) {
-              GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, alt1_start);
-            } else {
-              GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, alt1_start);
+            // Check for constant genotype column.
+            // (Technically, we should recheck later in the chrX no-sex-covariate
+            // --xchr-model 1 corner case.)
+            if (!pgv.dosage_ct) {
+              if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
+                // bugfix (28 Mar 2020): didn't set the bit that actually
+                // mattered last week...
+                const_alleles[0] = 3;
+              }
+            } else if (pgv.dosage_ct == nm_sample_ct) {
+              if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
+                const_alleles[0] = 3;
+              }
             }
-          }
-          ZeroFArr(rare_allele_ct * nm_sample_ctav, rarealt_start);
-          if (pgv.patch_01_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_01_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
+            machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
+            machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
+            machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
+            machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
+            if (cur_gcount_case_interleaved_vec) {
+              // gcountcc
+              STD_ARRAY_REF(uint32_t, 6) cur_geno_hardcall_cts = block_aux_iter->geno_hardcall_cts;
+              GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, R_CAST(STD_ARRAY_REF(uint32_t, 4), cur_geno_hardcall_cts));
+              for (uint32_t geno_hardcall_idx = 0; geno_hardcall_idx != 3; ++geno_hardcall_idx) {
+                cur_geno_hardcall_cts[3 + geno_hardcall_idx] = genocounts[geno_hardcall_idx] - cur_geno_hardcall_cts[geno_hardcall_idx];
+              }
             }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                alt1_start[sample_idx] = 0.0;
-                machr2_dosage_sums[allele_code] += 1;
+          } else {
+            // multiallelic.
+            // Update (18 Mar 2020): If some but not all alleles have constant
+            // dosages, we remove just those alleles from the regressions;
+            // trim-alts is not necessary to see what's going on with the other
+            // alleles.  To reduce parsing complexity, the number of output lines
+            // is not affected by this; the ones corresponding to the constant
+            // alleles have NA values.
+
+            // dosage_ct == 0 temporarily guaranteed if we reach here.
+            assert(!pgv.dosage_ct);
+            multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ctav]);
+            ZeroU64Arr(allele_ct, machr2_dosage_sums);
+            ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
+            // postpone multiply for now, since no multiallelic dosages
+            // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
+            // actual sums/ssqs later.
+            machr2_dosage_sums[0] = genocounts[1];
+            machr2_dosage_ssqs[0] = genocounts[0];
+            if (omitted_allele_idx) {
+              // Main genotype column starts as REF.
+              if (!missing_ct) {
+                GenoarrLookup16x4bx2(pgv.genovec, kSmallInvFloatPairs, nm_sample_ct, genotype_vals);
+              } else {
+                GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallInvFloats, cur_sample_ct, genotype_vals);
               }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                machr2_dosage_sums[allele_code] += 1;
+            }
+            uint32_t rare_allele_ct = allele_ct_m2;
+            float* alt1_start = nullptr;
+            float* rarealt_start = multi_start;
+            if (omitted_allele_idx != 1) {
+              if (omitted_allele_idx) {
+                alt1_start = multi_start;
+                ZeroFArr(nm_sample_ct_rem, &(alt1_start[nm_sample_ct]));
+                rarealt_start = &(rarealt_start[nm_sample_ctav]);
+                --rare_allele_ct;
+              } else {
+                alt1_start = genotype_vals;
               }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                alt1_start[sample_idx] = 0.0;
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                machr2_dosage_sums[allele_code] += 1;
-                if (allele_code == omitted_allele_idx) {
-                  continue;
-                }
-                const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
-                rarealt_start[cur_col * nm_sample_ctav + sample_idx] = 1.0;
+              if (!missing_ct) {
+                GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, alt1_start);
+              } else {
+                GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, alt1_start);
               }
             }
-          }
-          uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
-          if (pgv.patch_10_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_10_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
-            }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+            ZeroFArr(rare_allele_ct * nm_sample_ctav, rarealt_start);
+            if (pgv.patch_01_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_01_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
                   alt1_start[sample_idx] = 0.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
-                  } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
-                    alt1_start[sample_idx] = 0.0;
-                    machr2_dosage_sums[ac0] += 1;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  alt1_start[sample_idx] = 0.0;
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  machr2_dosage_sums[allele_code] += 1;
+                  if (allele_code == omitted_allele_idx) {
+                    continue;
                   }
+                  const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
+                  rarealt_start[cur_col * nm_sample_ctav + sample_idx] = 1.0;
                 }
               }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
+            }
+            uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
+            if (pgv.patch_10_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_10_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+                    alt1_start[sample_idx] = 0.0;
+                    machr2_dosage_ssqs[ac0] += 1;
                   } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
-                    machr2_dosage_sums[ac0] += 1;
+                    rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      alt1_start[sample_idx] = 0.0;
+                      machr2_dosage_sums[ac0] += 1;
+                    }
                   }
                 }
-              }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
-                const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  machr2_dosage_ssqs[ac0] += 1;
-                  alt1_start[sample_idx] = 0.0;
-                  if (ac0 != omitted_allele_idx) {
-                    const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                    rarealt_start[ac0_col * nm_sample_ctav + sample_idx] = 2.0;
-                  }
-                } else {
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac1 != omitted_allele_idx) {
-                    const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
-                    rarealt_start[ac1_col * nm_sample_ctav + sample_idx] = 1.0;
-                  }
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+                    machr2_dosage_ssqs[ac0] += 1;
                   } else {
-                    machr2_dosage_sums[ac0] += 1;
+                    rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      machr2_dosage_sums[ac0] += 1;
+                    }
+                  }
+                }
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
+                  const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    machr2_dosage_ssqs[ac0] += 1;
                     alt1_start[sample_idx] = 0.0;
                     if (ac0 != omitted_allele_idx) {
                       const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                      rarealt_start[ac0_col * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      rarealt_start[ac0_col * nm_sample_ctav + sample_idx] = 2.0;
+                    }
+                  } else {
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac1 != omitted_allele_idx) {
+                      const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
+                      rarealt_start[ac1_col * nm_sample_ctav + sample_idx] = 1.0;
+                    }
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      machr2_dosage_sums[ac0] += 1;
+                      alt1_start[sample_idx] = 0.0;
+                      if (ac0 != omitted_allele_idx) {
+                        const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
+                        rarealt_start[ac0_col * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      }
                     }
                   }
                 }
               }
             }
-          }
-          machr2_dosage_sums[1] = alt1_het_ct;
-          machr2_dosage_ssqs[1] = genocounts[2] - pgv.patch_10_ct;
-          if (cur_gcount_case_interleaved_vec) {
-            // gcountcc.  Need case-specific one_cts and two_cts for each
-            // allele.
-            STD_ARRAY_DECL(uint32_t, 4, case_hardcall_cts);
-            GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, case_hardcall_cts);
-            ZeroU32Arr(allele_ct, case_one_cts);
-            ZeroU32Arr(allele_ct, case_two_cts);
-            uint32_t case_alt1_het_ct = case_hardcall_cts[1];
-            case_one_cts[0] = case_alt1_het_ct;
-            case_two_cts[0] = case_hardcall_cts[0];
-            if (pgv.patch_01_ct) {
-              uintptr_t sample_widx = 0;
-              uintptr_t cur_bits = pgv.patch_01_set[0];
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &cur_bits);
-                if (cur_pheno_cc[sample_widx] & lowbit) {
-                  const uint32_t allele_code = pgv.patch_01_vals[uii];
-                  case_one_cts[allele_code] += 1;
+            machr2_dosage_sums[1] = alt1_het_ct;
+            machr2_dosage_ssqs[1] = genocounts[2] - pgv.patch_10_ct;
+            if (cur_gcount_case_interleaved_vec) {
+              // gcountcc.  Need case-specific one_cts and two_cts for each
+              // allele.
+              STD_ARRAY_DECL(uint32_t, 4, case_hardcall_cts);
+              GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, case_hardcall_cts);
+              ZeroU32Arr(allele_ct, case_one_cts);
+              ZeroU32Arr(allele_ct, case_two_cts);
+              uint32_t case_alt1_het_ct = case_hardcall_cts[1];
+              case_one_cts[0] = case_alt1_het_ct;
+              case_two_cts[0] = case_hardcall_cts[0];
+              if (pgv.patch_01_ct) {
+                uintptr_t sample_widx = 0;
+                uintptr_t cur_bits = pgv.patch_01_set[0];
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &cur_bits);
+                  if (cur_pheno_cc[sample_widx] & lowbit) {
+                    const uint32_t allele_code = pgv.patch_01_vals[uii];
+                    case_one_cts[allele_code] += 1;
+                  }
+                }
+                for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
+                  case_alt1_het_ct -= case_one_cts[allele_idx];
                 }
               }
-              for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
-                case_alt1_het_ct -= case_one_cts[allele_idx];
-              }
-            }
-            uint32_t case_alt1_hom_ct = case_hardcall_cts[2];
-            if (pgv.patch_10_ct) {
-              uintptr_t sample_widx = 0;
-              uintptr_t cur_bits = pgv.patch_10_set[0];
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &cur_bits);
-                if (cur_pheno_cc[sample_widx] & lowbit) {
-                  const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
-                  const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                  --case_alt1_hom_ct;
-                  if (ac0 == ac1) {
-                    case_two_cts[ac0] += 1;
-                  } else {
-                    case_one_cts[ac1] += 1;
-                    if (ac0 == 1) {
-                      ++case_alt1_het_ct;
+              uint32_t case_alt1_hom_ct = case_hardcall_cts[2];
+              if (pgv.patch_10_ct) {
+                uintptr_t sample_widx = 0;
+                uintptr_t cur_bits = pgv.patch_10_set[0];
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &cur_bits);
+                  if (cur_pheno_cc[sample_widx] & lowbit) {
+                    const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
+                    const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
+                    --case_alt1_hom_ct;
+                    if (ac0 == ac1) {
+                      case_two_cts[ac0] += 1;
                     } else {
-                      case_one_cts[ac0] += 1;
+                      case_one_cts[ac1] += 1;
+                      if (ac0 == 1) {
+                        ++case_alt1_het_ct;
+                      } else {
+                        case_one_cts[ac0] += 1;
+                      }
                     }
                   }
                 }
               }
+              case_one_cts[1] = case_alt1_het_ct;
+              case_two_cts[1] = case_alt1_hom_ct;
+              uint32_t nonomitted_allele_idx = 0;
+              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                if (allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                const uint32_t one_ct = machr2_dosage_sums[allele_idx];
+                const uint32_t two_ct = machr2_dosage_ssqs[allele_idx];
+                const uint32_t case_one_ct = case_one_cts[allele_idx];
+                const uint32_t case_two_ct = case_two_cts[allele_idx];
+                STD_ARRAY_REF(uint32_t, 6) dst = block_aux_iter[nonomitted_allele_idx].geno_hardcall_cts;
+                dst[0] = nm_case_ct - case_one_ct - case_two_ct;
+                dst[1] = case_one_ct;
+                dst[2] = case_two_ct;
+                dst[3] = nm_sample_ct - one_ct - two_ct - dst[0];
+                dst[4] = one_ct - case_one_ct;
+                dst[5] = two_ct - case_two_ct;
+                ++nonomitted_allele_idx;
+              }
             }
-            case_one_cts[1] = case_alt1_het_ct;
-            case_two_cts[1] = case_alt1_hom_ct;
-            uint32_t nonomitted_allele_idx = 0;
             for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-              if (allele_idx == omitted_allele_idx) {
-                continue;
+              const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
+              const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
+              machr2_dosage_sums[allele_idx] = (one_ct + 2 * two_ct) * 0x4000LLU;
+              machr2_dosage_ssqs[allele_idx] = (one_ct + 4LLU * two_ct) * 0x10000000LLU;
+              if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
+                SetBit(allele_idx, const_alleles);
               }
-              const uint32_t one_ct = machr2_dosage_sums[allele_idx];
-              const uint32_t two_ct = machr2_dosage_ssqs[allele_idx];
-              const uint32_t case_one_ct = case_one_cts[allele_idx];
-              const uint32_t case_two_ct = case_two_cts[allele_idx];
-              STD_ARRAY_REF(uint32_t, 6) dst = block_aux_iter[nonomitted_allele_idx].geno_hardcall_cts;
-              dst[0] = nm_case_ct - case_one_ct - case_two_ct;
-              dst[1] = case_one_ct;
-              dst[2] = case_two_ct;
-              dst[3] = nm_sample_ct - one_ct - two_ct - dst[0];
-              dst[4] = one_ct - case_one_ct;
-              dst[5] = two_ct - case_two_ct;
-              ++nonomitted_allele_idx;
-            }
-          }
-          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-            const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
-            const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
-            machr2_dosage_sums[allele_idx] = (one_ct + 2 * two_ct) * 0x4000LLU;
-            machr2_dosage_ssqs[allele_idx] = (one_ct + 4LLU * two_ct) * 0x10000000LLU;
-            if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
-              SetBit(allele_idx, const_alleles);
-            }
-          }
-        }
-        ZeroFArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
-        // usually need to save some of {sample_obs_ct, allele_obs_ct,
-        // a1_dosage, case_allele_obs_ct, a1_case_dosage, mach_r2 even for
-        // skipped variants
-        // compute them all for now, could conditionally skip later
-        uint32_t allele_obs_ct = nm_sample_ct * 2;
-        uint32_t case_allele_obs_ct = nm_case_ct * 2;
-        if (!is_regular_x) {
-          if (is_nonx_haploid) {
-            allele_obs_ct = nm_sample_ct;
-            case_allele_obs_ct = nm_case_ct;
-            // everything is on 0..1 scale, not 0..2
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              genotype_vals[sample_idx] *= S_CAST(float, 0.5);
-            }
-            const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
-            for (uint32_t uii = 0; uii != high_ct; ++uii) {
-              multi_start[uii] *= S_CAST(float, 0.5);
             }
           }
-        } else {
-          CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
-          const uintptr_t* male_nm = tmp_nm;
-          const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
-          if (is_xchr_model_1) {
-            // special case: multiply male values by 0.5
-            uintptr_t sample_idx_base = 0;
-            uintptr_t male_nm_bits = male_nm[0];
-            for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
-              const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-              genotype_vals[sample_idx] *= S_CAST(float, 0.5);
-              // could insert multiallelic loop here isntead, but I'm guessing
-              // that's worse due to locality of writes?
+          ZeroFArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
+          // usually need to save some of {sample_obs_ct, allele_obs_ct,
+          // a1_dosage, case_allele_obs_ct, a1_case_dosage, mach_r2 even for
+          // skipped variants
+          // compute them all for now, could conditionally skip later
+          uint32_t allele_obs_ct = nm_sample_ct * 2;
+          uint32_t case_allele_obs_ct = nm_case_ct * 2;
+          if (!is_regular_x) {
+            if (is_nonx_haploid) {
+              allele_obs_ct = nm_sample_ct;
+              case_allele_obs_ct = nm_case_ct;
+              // everything is on 0..1 scale, not 0..2
+              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                genotype_vals[sample_idx] *= S_CAST(float, 0.5);
+              }
+              const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
+              for (uint32_t uii = 0; uii != high_ct; ++uii) {
+                multi_start[uii] *= S_CAST(float, 0.5);
+              }
             }
-            for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-              float* cur_start = &(multi_start[extra_allele_idx * nm_sample_ctav]);
-              sample_idx_base = 0;
-              male_nm_bits = male_nm[0];
+          } else {
+            CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
+            const uintptr_t* male_nm = tmp_nm;
+            const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
+            if (is_xchr_model_1) {
+              // special case: multiply male values by 0.5
+              uintptr_t sample_idx_base = 0;
+              uintptr_t male_nm_bits = male_nm[0];
               for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
                 const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-                cur_start[sample_idx] *= S_CAST(float, 0.5);
+                genotype_vals[sample_idx] *= S_CAST(float, 0.5);
+                // could insert multiallelic loop here isntead, but I'm guessing
+                // that's worse due to locality of writes?
               }
+              for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                float* cur_start = &(multi_start[extra_allele_idx * nm_sample_ctav]);
+                sample_idx_base = 0;
+                male_nm_bits = male_nm[0];
+                for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
+                  const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
+                  cur_start[sample_idx] *= S_CAST(float, 0.5);
+                }
+              }
+              allele_obs_ct -= nm_male_ct;
+              case_allele_obs_ct -= PopcountWordsIntersect(pheno_cc_nm, male_nm, nm_sample_ctl);
             }
-            allele_obs_ct -= nm_male_ct;
-            case_allele_obs_ct -= PopcountWordsIntersect(pheno_cc_nm, male_nm, nm_sample_ctl);
-          }
-        }
-        const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
-        uint32_t nonomitted_allele_idx = 0;
-        for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-          if (allele_idx == omitted_allele_idx) {
-            continue;
           }
-
-          float* geno_col = genotype_vals;
-          if (allele_idx > (!omitted_allele_idx)) {
-            geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ctav]);
-          }
-          double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
-          if (is_xchr_model_1) {
-            // ugh.
-            a1_dosage = 0.0;
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              a1_dosage += S_CAST(double, geno_col[sample_idx]);
+          const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
+          uint32_t nonomitted_allele_idx = 0;
+          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+            if (allele_idx == omitted_allele_idx) {
+              continue;
             }
-          } else {
-            if (is_nonx_haploid) {
-              a1_dosage *= 0.5;
+
+            float* geno_col = genotype_vals;
+            if (allele_idx > (!omitted_allele_idx)) {
+              geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ctav]);
             }
-          }
-          a1_dosages[allele_idx] = a1_dosage;
-
-          // todo: shortcut if gcountcc computed and no dosages
-          double a1_case_dosage = 0.0;
-          uintptr_t sample_idx_base = 0;
-          uintptr_t pheno_cc_nm_bits = pheno_cc_nm[0];
-          for (uint32_t uii = 0; uii != nm_case_ct; ++uii) {
-            const uintptr_t sample_idx = BitIter1(pheno_cc_nm, &sample_idx_base, &pheno_cc_nm_bits);
-            a1_case_dosage += S_CAST(double, geno_col[sample_idx]);
-          }
-          a1_case_dosages[allele_idx] = a1_case_dosage;
-          block_aux_iter[nonomitted_allele_idx].sample_obs_ct = nm_sample_ct;
-          block_aux_iter[nonomitted_allele_idx].allele_obs_ct = allele_obs_ct;
-          if (!allele_ct_m2) {
-            // Need main_dosage_sum and main_dosage_ssq for now (probably move
-            // this computation in-place later).
+            double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
             if (is_xchr_model_1) {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = 0.0;
+              // ugh.
+              a1_dosage = 0.0;
               for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const double cur_dosage = S_CAST(double, geno_col[sample_idx]);
-                main_dosage_ssq += cur_dosage * cur_dosage;
+                a1_dosage += S_CAST(double, geno_col[sample_idx]);
               }
             } else {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
               if (is_nonx_haploid) {
-                main_dosage_ssq *= 0.25;
+                a1_dosage *= 0.5;
               }
             }
-          }
-          block_aux_iter[nonomitted_allele_idx].a1_dosage = a1_dosage;
-
-          // bugfix (4 Sep 2018): forgot to save this
-          block_aux_iter[nonomitted_allele_idx].case_allele_obs_ct = case_allele_obs_ct;
+            a1_dosages[allele_idx] = a1_dosage;
 
-          block_aux_iter[nonomitted_allele_idx].a1_case_dosage = a1_case_dosage;
-          block_aux_iter[nonomitted_allele_idx].firth_fallback = 0;
-          block_aux_iter[nonomitted_allele_idx].is_unfinished = 0;
-          block_aux_iter[nonomitted_allele_idx].mach_r2 = mach_r2;
-          ++nonomitted_allele_idx;
-        }
-        // Now free to skip the actual regression if there are too few samples,
-        // or omitted allele corresponds to a zero-variance genotype column.
-        // If another allele has zero variance but the omitted allele does not,
-        // we now salvage as many alleles as we can.
-        GlmErr glm_err = 0;
-        if (nm_sample_ct <= expected_predictor_ct) {
-          // reasonable for this to override CONST_ALLELE
-          glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
-        } else if (IsSet(const_alleles, omitted_allele_idx)) {
-          glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
-        }
-        if (glm_err) {
-          if (missing_ct) {
-            // covariates have not been copied yet, so we can't usually change
-            // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
-            // reason to optimize the zero-covariate case)
-            prev_nm = 0;
-          }
-          uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-          if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
-            reported_ct += allele_ct_m2;
-          }
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-              memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-              beta_se_iter[uii * 2 + 1] = -9.0;
+            // todo: shortcut if gcountcc computed and no dosages
+            double a1_case_dosage = 0.0;
+            uintptr_t sample_idx_base = 0;
+            uintptr_t pheno_cc_nm_bits = pheno_cc_nm[0];
+            for (uint32_t uii = 0; uii != nm_case_ct; ++uii) {
+              const uintptr_t sample_idx = BitIter1(pheno_cc_nm, &sample_idx_base, &pheno_cc_nm_bits);
+              a1_case_dosage += S_CAST(double, geno_col[sample_idx]);
             }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
-          }
-        } else {
-          {
-            double omitted_dosage = u63tod(allele_obs_ct);
-            double omitted_case_dosage = u63tod(case_allele_obs_ct);
-            for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-              if (allele_idx == omitted_allele_idx) {
-                continue;
+            a1_case_dosages[allele_idx] = a1_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].sample_obs_ct = nm_sample_ct;
+            block_aux_iter[nonomitted_allele_idx].allele_obs_ct = allele_obs_ct;
+            if (!allele_ct_m2) {
+              // Need main_dosage_sum and main_dosage_ssq for now (probably move
+              // this computation in-place later).
+              if (is_xchr_model_1) {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = 0.0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const double cur_dosage = S_CAST(double, geno_col[sample_idx]);
+                  main_dosage_ssq += cur_dosage * cur_dosage;
+                }
+              } else {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
+                if (is_nonx_haploid) {
+                  main_dosage_ssq *= 0.25;
+                }
               }
-              omitted_dosage -= a1_dosages[allele_idx];
-              omitted_case_dosage -= a1_case_dosages[allele_idx];
             }
-            a1_dosages[omitted_allele_idx] = omitted_dosage;
-            a1_case_dosages[omitted_allele_idx] = omitted_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].a1_dosage = a1_dosage;
+
+            // bugfix (4 Sep 2018): forgot to save this
+            block_aux_iter[nonomitted_allele_idx].case_allele_obs_ct = case_allele_obs_ct;
+
+            block_aux_iter[nonomitted_allele_idx].a1_case_dosage = a1_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].firth_fallback = 0;
+            block_aux_iter[nonomitted_allele_idx].is_unfinished = 0;
+            block_aux_iter[nonomitted_allele_idx].mach_r2 = mach_r2;
+            ++nonomitted_allele_idx;
+          }
+          // Now free to skip the actual regression if there are too few samples,
+          // or omitted allele corresponds to a zero-variance genotype column.
+          // If another allele has zero variance but the omitted allele does not,
+          // we now salvage as many alleles as we can.
+          GlmErr glm_err = 0;
+          if (nm_sample_ct <= expected_predictor_ct) {
+            // reasonable for this to override CONST_ALLELE
+            glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
+          } else if (IsSet(const_alleles, omitted_allele_idx)) {
+            glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
           }
-          uint32_t parameter_uidx = 2 + domdev_present;
-          float* nm_predictors_pmaj_istart = nullptr;
-          // only need to do this part once per variant in multiallelic case
-          float* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ctav * (parameter_uidx - main_omitted)]);
-          if (missing_ct || (!prev_nm)) {
-            // fill phenotype
-            uintptr_t sample_midx_base = 0;
-            uintptr_t sample_nm_bits = sample_nm[0];
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-              nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
+          if (glm_err) {
+            if (missing_ct) {
+              // covariates have not been copied yet, so we can't usually change
+              // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
+              // reason to optimize the zero-covariate case)
+              prev_nm = 0;
+            }
+            uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+            if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
+              reported_ct += allele_ct_m2;
             }
-            // bugfix (13 Oct 2017): must guarantee trailing phenotype values
-            // are valid (exact contents don't matter since they are multiplied
-            // by zero, but they can't be nan)
-            ZeroFArr(nm_sample_ct_rem, &(nm_pheno_buf[nm_sample_ct]));
-
-            // fill covariates
-            for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
-              // strictly speaking, we don't need cur_covars_cmaj to be
-              // vector-aligned
-              if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
-                continue;
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                beta_se_iter[uii * 2 + 1] = -9.0;
               }
-              const float* cur_covar_col;
-              if (covar_idx < local_covar_ct) {
-                cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-              } else {
-                cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * sample_ctav]);
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+            }
+          } else {
+            {
+              double omitted_dosage = u63tod(allele_obs_ct);
+              double omitted_case_dosage = u63tod(case_allele_obs_ct);
+              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                if (allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                omitted_dosage -= a1_dosages[allele_idx];
+                omitted_case_dosage -= a1_case_dosages[allele_idx];
               }
-              sample_midx_base = 0;
-              sample_nm_bits = sample_nm[0];
+              a1_dosages[omitted_allele_idx] = omitted_dosage;
+              a1_case_dosages[omitted_allele_idx] = omitted_case_dosage;
+            }
+            uint32_t parameter_uidx = 2 + domdev_present;
+            float* nm_predictors_pmaj_istart = nullptr;
+            // only need to do this part once per variant in multiallelic case
+            float* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ctav * (parameter_uidx - main_omitted)]);
+            if (missing_ct || (!prev_nm)) {
+              // fill phenotype
+              uintptr_t sample_midx_base = 0;
+              uintptr_t sample_nm_bits = sample_nm[0];
               for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                 const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
-              }
-              ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
-            }
-            nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
-            // bugfix (13 Apr 2021): if local covariates are present, we can't
-            // optimize as aggressively
-            prev_nm = !(missing_ct || local_covar_ct);
-          } else {
-            // bugfix (15 Aug 2018): this was not handling --parameters
-            // correctly when a covariate was only needed as part of an
-            // interaction
-            parameter_uidx += cur_covar_ct;
-            nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ctav]);
-          }
-          const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
-          if (const_allele_ct) {
-            // Must delete constant-allele columns from nm_predictors_pmaj, and
-            // shift later columns back.
-            float* read_iter = genotype_vals;
-            float* write_iter = genotype_vals;
-            for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
-              if (read_allele_idx == omitted_allele_idx) {
-                continue;
+                nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
               }
-              if (!IsSet(const_alleles, read_allele_idx)) {
-                if (write_iter != read_iter) {
-                  memcpy(write_iter, read_iter, nm_sample_ctav * sizeof(float));
+              // bugfix (13 Oct 2017): must guarantee trailing phenotype values
+              // are valid (exact contents don't matter since they are multiplied
+              // by zero, but they can't be nan)
+              ZeroFArr(nm_sample_ct_rem, &(nm_pheno_buf[nm_sample_ct]));
+
+              // fill covariates
+              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
+                // strictly speaking, we don't need cur_covars_cmaj to be
+                // vector-aligned
+                if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
+                  continue;
                 }
-                if (write_iter == genotype_vals) {
-                  write_iter = multi_start;
+                const float* cur_covar_col;
+                if (covar_idx < local_covar_ct) {
+                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
                 } else {
-                  write_iter = &(write_iter[nm_sample_ctav]);
+                  cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * sample_ctav]);
                 }
-              }
-              if (read_iter == genotype_vals) {
-                read_iter = multi_start;
-              } else {
-                read_iter = &(read_iter[nm_sample_ctav]);
-              }
-            }
-          }
-          const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
-          const uint32_t cur_predictor_ctav = RoundUpPow2(cur_predictor_ct, kFloatPerFVec);
-          const uint32_t cur_predictor_ctavp1 = cur_predictor_ctav + 1;
-          uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            float* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
-            float* domdev_vals = nullptr;
-            uint32_t is_unfinished = 0;
-            uint32_t is_residualized = 0;
-            // _stop instead of _ct since, in the residualized case, the
-            // intercept (predictor index 0) is not included; we iterate over
-            // the predictor indices in [1, _stop).
-            uint32_t cur_regressed_predictor_stop = cur_predictor_ct;
-            uint32_t cur_regressed_predictor_ctav = cur_predictor_ctav;
-            uint32_t cur_regressed_predictor_ctavp1 = cur_predictor_ctavp1;
-            uint32_t cur_biallelic_regressed_predictor_stop = cur_biallelic_predictor_ct;
-            if (extra_regression_ct) {
-              if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
-                glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
-                goto GlmLogisticThreadF_skip_regression;
-              }
-              ++nonconst_extra_regression_idx;
-              if (nonconst_extra_regression_idx) {
-                float* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ctav]);
-                for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
-                  float fxx = genotype_vals[uii];
-                  genotype_vals[uii] = swap_target[uii];
-                  swap_target[uii] = fxx;
+                sample_midx_base = 0;
+                sample_nm_bits = sample_nm[0];
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
                 }
+                ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
               }
+              nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
+              // bugfix (13 Apr 2021): if local covariates are present, we can't
+              // optimize as aggressively
+              prev_nm = !(missing_ct || local_covar_ct);
+            } else {
+              // bugfix (15 Aug 2018): this was not handling --parameters
+              // correctly when a covariate was only needed as part of an
+              // interaction
+              parameter_uidx += cur_covar_ct;
+              nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ctav]);
             }
-            if (main_omitted) {
-              // if main_mutated, this will be filled below
-              // if not, this aliases genotype_vals
-              main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ctav]);
-            } else if (joint_genotypic || joint_hethom) {
-              // in hethom case, do this before clobbering genotype data
-              domdev_vals = &(main_vals[nm_sample_ctav]);
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                if (cur_genotype_val > S_CAST(float, 1.0)) {
-                  cur_genotype_val = S_CAST(float, 2.0) - cur_genotype_val;
+            const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
+            if (const_allele_ct) {
+              // Must delete constant-allele columns from nm_predictors_pmaj, and
+              // shift later columns back.
+              float* read_iter = genotype_vals;
+              float* write_iter = genotype_vals;
+              for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
+                if (read_allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                if (!IsSet(const_alleles, read_allele_idx)) {
+                  if (write_iter != read_iter) {
+                    memcpy(write_iter, read_iter, nm_sample_ctav * sizeof(float));
+                  }
+                  if (write_iter == genotype_vals) {
+                    write_iter = multi_start;
+                  } else {
+                    write_iter = &(write_iter[nm_sample_ctav]);
+                  }
+                }
+                if (read_iter == genotype_vals) {
+                  read_iter = multi_start;
+                } else {
+                  read_iter = &(read_iter[nm_sample_ctav]);
                 }
-                domdev_vals[sample_idx] = cur_genotype_val;
               }
-              ZeroFArr(nm_sample_ct_rem, &(domdev_vals[nm_sample_ct]));
             }
-            if (model_dominant) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                // 0..1..1
-                if (cur_genotype_val > S_CAST(float, 1.0)) {
-                  cur_genotype_val = 1.0;
+            const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
+            const uint32_t cur_predictor_ctav = RoundUpPow2(cur_predictor_ct, kFloatPerFVec);
+            const uint32_t cur_predictor_ctavp1 = cur_predictor_ctav + 1;
+            uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              float* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
+              float* domdev_vals = nullptr;
+              uint32_t is_unfinished = 0;
+              uint32_t is_residualized = 0;
+              // _stop instead of _ct since, in the residualized case, the
+              // intercept (predictor index 0) is not included; we iterate over
+              // the predictor indices in [1, _stop).
+              uint32_t cur_regressed_predictor_stop = cur_predictor_ct;
+              uint32_t cur_regressed_predictor_ctav = cur_predictor_ctav;
+              uint32_t cur_regressed_predictor_ctavp1 = cur_predictor_ctavp1;
+              uint32_t cur_biallelic_regressed_predictor_stop = cur_biallelic_predictor_ct;
+              if (extra_regression_ct) {
+                if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
+                  glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
+                  goto GlmLogisticThreadF_skip_regression;
                 }
-                main_vals[sample_idx] = cur_genotype_val;
-              }
-            } else if (model_recessive || joint_hethom) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                // 0..0..1
-                if (cur_genotype_val < S_CAST(float, 1.0)) {
-                  cur_genotype_val = 0.0;
-                } else {
-                  cur_genotype_val -= S_CAST(float, 1.0);
+                ++nonconst_extra_regression_idx;
+                if (nonconst_extra_regression_idx) {
+                  float* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ctav]);
+                  for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
+                    float fxx = genotype_vals[uii];
+                    genotype_vals[uii] = swap_target[uii];
+                    swap_target[uii] = fxx;
+                  }
                 }
-                main_vals[sample_idx] = cur_genotype_val;
               }
-            } else if (model_hetonly) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                // 0..1..0
-                if (cur_genotype_val > S_CAST(float, 1.0)) {
-                  cur_genotype_val = S_CAST(float, 2.0) - cur_genotype_val;
+              if (main_omitted) {
+                // if main_mutated, this will be filled below
+                // if not, this aliases genotype_vals
+                main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ctav]);
+              } else if (joint_genotypic || joint_hethom) {
+                // in hethom case, do this before clobbering genotype data
+                domdev_vals = &(main_vals[nm_sample_ctav]);
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  if (cur_genotype_val > S_CAST(float, 1.0)) {
+                    cur_genotype_val = S_CAST(float, 2.0) - cur_genotype_val;
+                  }
+                  domdev_vals[sample_idx] = cur_genotype_val;
                 }
-                main_vals[sample_idx] = cur_genotype_val;
+                ZeroFArr(nm_sample_ct_rem, &(domdev_vals[nm_sample_ct]));
               }
-            }
-
-            // fill interaction terms
-            if (add_interactions) {
-              nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
-              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
-                const float* cur_covar_col;
-                if (covar_idx < local_covar_ct) {
-                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-                } else {
-                  cur_covar_col = &(cur_covars_cmaj[covar_idx * sample_ctav]);
+              if (model_dominant) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..1..1
+                  if (cur_genotype_val > S_CAST(float, 1.0)) {
+                    cur_genotype_val = 1.0;
+                  }
+                  main_vals[sample_idx] = cur_genotype_val;
                 }
-                if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
-                  uintptr_t sample_midx_base = 0;
-                  uintptr_t sample_nm_bits = sample_nm[0];
-                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                    const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                    *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
+              } else if (model_recessive || joint_hethom) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..0..1
+                  if (cur_genotype_val < S_CAST(float, 1.0)) {
+                    cur_genotype_val = 0.0;
+                  } else {
+                    cur_genotype_val -= S_CAST(float, 1.0);
                   }
-                  ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+                  main_vals[sample_idx] = cur_genotype_val;
                 }
-                ++parameter_uidx;
-                if (domdev_present) {
+              } else if (model_hetonly) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..1..0
+                  if (cur_genotype_val > S_CAST(float, 1.0)) {
+                    cur_genotype_val = S_CAST(float, 2.0) - cur_genotype_val;
+                  }
+                  main_vals[sample_idx] = cur_genotype_val;
+                }
+              }
+
+              // fill interaction terms
+              if (add_interactions) {
+                nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
+                for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
+                  const float* cur_covar_col;
+                  if (covar_idx < local_covar_ct) {
+                    cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
+                  } else {
+                    cur_covar_col = &(cur_covars_cmaj[covar_idx * sample_ctav]);
+                  }
                   if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
                     uintptr_t sample_midx_base = 0;
                     uintptr_t sample_nm_bits = sample_nm[0];
                     for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                       const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                      *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                      *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
                     }
                     ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
                   }
                   ++parameter_uidx;
+                  if (domdev_present) {
+                    if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
+                      uintptr_t sample_midx_base = 0;
+                      uintptr_t sample_nm_bits = sample_nm[0];
+                      for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                        const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                        *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                      }
+                      ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+                    }
+                    ++parameter_uidx;
+                  }
                 }
               }
-            }
-            if (corr_inv && prev_nm && (!allele_ct_m2)) {
-              uintptr_t start_pred_idx = 0;
-              if (!(model_dominant || model_recessive || model_hetonly || joint_hethom)) {
-                start_pred_idx = domdev_present + 2;
-                semicomputed_biallelic_xtx[cur_predictor_ct] = main_dosage_sum;
-                semicomputed_biallelic_xtx[cur_predictor_ct + 1] = main_dosage_ssq;
-              }
-              if (cur_predictor_ct > start_pred_idx) {
-                ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ctav]), nm_sample_ct, nm_sample_ctav, cur_predictor_ct - start_pred_idx, &(predictor_dotprod_buf[start_pred_idx]));
-                for (uint32_t uii = start_pred_idx; uii != cur_predictor_ct; ++uii) {
-                  semicomputed_biallelic_xtx[cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
-                }
-              }
-              if (domdev_present) {
-                ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ctav]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ctav, cur_predictor_ct, predictor_dotprod_buf);
-                for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
-                  semicomputed_biallelic_xtx[2 * cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
+              if (corr_inv && prev_nm && (!allele_ct_m2)) {
+                uintptr_t start_pred_idx = 0;
+                if (!(model_dominant || model_recessive || model_hetonly || joint_hethom)) {
+                  start_pred_idx = domdev_present + 2;
+                  semicomputed_biallelic_xtx[cur_predictor_ct] = main_dosage_sum;
+                  semicomputed_biallelic_xtx[cur_predictor_ct + 1] = main_dosage_ssq;
                 }
-                semicomputed_biallelic_xtx[cur_predictor_ct + 2] = semicomputed_biallelic_xtx[2 * cur_predictor_ct + 1];
-              }
-              glm_err = CheckMaxCorrAndVifNm(semicomputed_biallelic_xtx, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
-              if (glm_err) {
-                goto GlmLogisticThreadF_skip_regression;
-              }
-            } else {
-              glm_err = CheckMaxCorrAndVifF(&(nm_predictors_pmaj_buf[nm_sample_ctav]), cur_predictor_ct - 1, nm_sample_ct, nm_sample_ctav, max_corr, vif_thresh, predictor_dotprod_buf, dbl_2d_buf, inverse_corr_buf, inv_1d_buf);
-              if (glm_err) {
-                goto GlmLogisticThreadF_skip_regression;
-              }
-            }
-            ZeroFArr(cur_predictor_ctav, coef_return);
-            if (!cur_is_always_firth) {
-              // Does any genotype column have zero case or zero control
-              // dosage?  If yes, faster to skip logistic regression than
-              // wait for convergence failure.
-              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                if (IsSet(const_alleles, allele_idx)) {
-                  continue;
-                }
-                const double tot_dosage = a1_dosages[allele_idx];
-                const double case_dosage = a1_case_dosages[allele_idx];
-                if ((case_dosage == 0.0) || (case_dosage == tot_dosage)) {
-                  if (is_sometimes_firth) {
-                    goto GlmLogisticThreadF_firth_fallback;
+                if (cur_predictor_ct > start_pred_idx) {
+                  ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ctav]), nm_sample_ct, nm_sample_ctav, cur_predictor_ct - start_pred_idx, &(predictor_dotprod_buf[start_pred_idx]));
+                  for (uint32_t uii = start_pred_idx; uii != cur_predictor_ct; ++uii) {
+                    semicomputed_biallelic_xtx[cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
                   }
-                  glm_err = SetGlmErr1(kGlmErrcodeSeparation, allele_idx);
-                  goto GlmLogisticThreadF_skip_regression;
                 }
-              }
-              if (!cur_cc_residualize) {
-                if (LogisticRegressionF(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf)) {
-                  if (is_sometimes_firth) {
-                    ZeroFArr(cur_predictor_ctav, coef_return);
-                    goto GlmLogisticThreadF_firth_fallback;
+                if (domdev_present) {
+                  ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ctav]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ctav, cur_predictor_ct, predictor_dotprod_buf);
+                  for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
+                    semicomputed_biallelic_xtx[2 * cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
                   }
-                  glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                  semicomputed_biallelic_xtx[cur_predictor_ct + 2] = semicomputed_biallelic_xtx[2 * cur_predictor_ct + 1];
+                }
+                glm_err = CheckMaxCorrAndVifNm(semicomputed_biallelic_xtx, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
+                if (glm_err) {
                   goto GlmLogisticThreadF_skip_regression;
                 }
               } else {
-                if (LogisticRegressionResidualizedF(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
-                  if (is_sometimes_firth) {
-                    ZeroFArr(cur_predictor_ctav, coef_return);
-                    goto GlmLogisticThreadF_firth_fallback;
-                  }
-                  glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                glm_err = CheckMaxCorrAndVifF(&(nm_predictors_pmaj_buf[nm_sample_ctav]), cur_predictor_ct - 1, nm_sample_ct, nm_sample_ctav, max_corr, vif_thresh, predictor_dotprod_buf, dbl_2d_buf, inverse_corr_buf, inv_1d_buf);
+                if (glm_err) {
                   goto GlmLogisticThreadF_skip_regression;
                 }
-                is_residualized = 1;
-                cur_regressed_predictor_stop = domdev_present + allele_ct;
-                cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
-                cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
-                cur_biallelic_regressed_predictor_stop = domdev_present + 2;
               }
-              // unlike FirthRegressionF(), hh_return isn't inverted yet, do
-              // that here
-              for (uint32_t pred_uidx = is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-                float* hh_inv_row = &(hh_return[pred_uidx * cur_regressed_predictor_ctav]);
-                // ZeroFArr(cur_regressed_predictor_stop, gradient_buf);
-                // gradient_buf[pred_uidx] = 1.0;
-                // (y is gradient_buf, x is dcoef_buf)
-                // SolveLinearSystemF(cholesky_decomp_return, &(gradient_buf[is_residualized]), cur_regressed_predictor_stop - is_residualized, &(hh_inv_row[is_residualized]));
-                // that works, but doesn't exploit the sparsity of y
-
-                // hh_return does now have vector-aligned rows
-                ZeroFArr(pred_uidx, hh_inv_row);
-
-                float fxx = 1.0;
-                for (uint32_t row_idx = pred_uidx; row_idx != cur_regressed_predictor_stop; ++row_idx) {
-                  const float* ll_row = &(cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav]);
-                  for (uint32_t col_idx = pred_uidx; col_idx != row_idx; ++col_idx) {
-                    fxx -= ll_row[col_idx] * hh_inv_row[col_idx];
+              ZeroFArr(cur_predictor_ctav, coef_return);
+              if (!cur_is_always_firth) {
+                // Does any genotype column have zero case or zero control
+                // dosage?  If yes, faster to skip logistic regression than
+                // wait for convergence failure.
+                for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                  if (IsSet(const_alleles, allele_idx)) {
+                    continue;
                   }
-                  hh_inv_row[row_idx] = fxx / ll_row[row_idx];
-                  fxx = 0.0;
-                }
-                for (uint32_t col_idx = cur_regressed_predictor_stop; col_idx > is_residualized; ) {
-                  fxx = hh_inv_row[--col_idx];
-                  float* hh_inv_row_iter = &(hh_inv_row[cur_regressed_predictor_stop - 1]);
-                  for (uint32_t row_idx = cur_regressed_predictor_stop - 1; row_idx > col_idx; --row_idx) {
-                    fxx -= cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav + col_idx] * (*hh_inv_row_iter--);
+                  const double tot_dosage = a1_dosages[allele_idx];
+                  const double case_dosage = a1_case_dosages[allele_idx];
+                  if ((case_dosage == 0.0) || (case_dosage == tot_dosage)) {
+                    if (is_sometimes_firth) {
+                      goto GlmLogisticThreadF_firth_fallback;
+                    }
+                    glm_err = SetGlmErr1(kGlmErrcodeSeparation, allele_idx);
+                    goto GlmLogisticThreadF_skip_regression;
                   }
-                  *hh_inv_row_iter = fxx / cholesky_decomp_return[col_idx * cur_regressed_predictor_ctavp1];
                 }
-              }
-            } else {
-              if (!is_always_firth) {
-              GlmLogisticThreadF_firth_fallback:
-                block_aux_iter[extra_regression_idx].firth_fallback = 1;
-                if (allele_ct_m2 && beta_se_multiallelic_fused) {
-                  for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
-                    block_aux_iter[uii].firth_fallback = 1;
+                if (!cur_cc_residualize) {
+                  if (LogisticRegressionF(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf)) {
+                    if (is_sometimes_firth) {
+                      ZeroFArr(cur_predictor_ctav, coef_return);
+                      goto GlmLogisticThreadF_firth_fallback;
+                    }
+                    glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                    goto GlmLogisticThreadF_skip_regression;
+                  }
+                } else {
+                  if (LogisticRegressionResidualizedF(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
+                    if (is_sometimes_firth) {
+                      ZeroFArr(cur_predictor_ctav, coef_return);
+                      goto GlmLogisticThreadF_firth_fallback;
+                    }
+                    glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                    goto GlmLogisticThreadF_skip_regression;
                   }
+                  is_residualized = 1;
+                  cur_regressed_predictor_stop = domdev_present + allele_ct;
+                  cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
+                  cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
+                  cur_biallelic_regressed_predictor_stop = domdev_present + 2;
                 }
-              }
-              if (!cur_cc_residualize) {
-                if (FirthRegressionF(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
-                  goto GlmLogisticThreadF_skip_regression;
+                // unlike FirthRegressionF(), hh_return isn't inverted yet, do
+                // that here
+                for (uint32_t pred_uidx = is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                  float* hh_inv_row = &(hh_return[pred_uidx * cur_regressed_predictor_ctav]);
+                  // ZeroFArr(cur_regressed_predictor_stop, gradient_buf);
+                  // gradient_buf[pred_uidx] = 1.0;
+                  // (y is gradient_buf, x is dcoef_buf)
+                  // SolveLinearSystemF(cholesky_decomp_return, &(gradient_buf[is_residualized]), cur_regressed_predictor_stop - is_residualized, &(hh_inv_row[is_residualized]));
+                  // that works, but doesn't exploit the sparsity of y
+
+                  // hh_return does now have vector-aligned rows
+                  ZeroFArr(pred_uidx, hh_inv_row);
+
+                  float fxx = 1.0;
+                  for (uint32_t row_idx = pred_uidx; row_idx != cur_regressed_predictor_stop; ++row_idx) {
+                    const float* ll_row = &(cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav]);
+                    for (uint32_t col_idx = pred_uidx; col_idx != row_idx; ++col_idx) {
+                      fxx -= ll_row[col_idx] * hh_inv_row[col_idx];
+                    }
+                    hh_inv_row[row_idx] = fxx / ll_row[row_idx];
+                    fxx = 0.0;
+                  }
+                  for (uint32_t col_idx = cur_regressed_predictor_stop; col_idx > is_residualized; ) {
+                    fxx = hh_inv_row[--col_idx];
+                    float* hh_inv_row_iter = &(hh_inv_row[cur_regressed_predictor_stop - 1]);
+                    for (uint32_t row_idx = cur_regressed_predictor_stop - 1; row_idx > col_idx; --row_idx) {
+                      fxx -= cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav + col_idx] * (*hh_inv_row_iter--);
+                    }
+                    *hh_inv_row_iter = fxx / cholesky_decomp_return[col_idx * cur_regressed_predictor_ctavp1];
+                  }
                 }
               } else {
-                if (FirthRegressionResidualizedF(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
-                  goto GlmLogisticThreadF_skip_regression;
+                if (!is_always_firth) {
+                GlmLogisticThreadF_firth_fallback:
+                  block_aux_iter[extra_regression_idx].firth_fallback = 1;
+                  if (allele_ct_m2 && beta_se_multiallelic_fused) {
+                    for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
+                      block_aux_iter[uii].firth_fallback = 1;
+                    }
+                  }
+                }
+                if (!cur_cc_residualize) {
+                  if (FirthRegressionF(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
+                    goto GlmLogisticThreadF_skip_regression;
+                  }
+                } else {
+                  if (FirthRegressionResidualizedF(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
+                    goto GlmLogisticThreadF_skip_regression;
+                  }
+                  is_residualized = 1;
+                  cur_regressed_predictor_stop = domdev_present + allele_ct;
+                  cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
+                  cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
+                  cur_biallelic_regressed_predictor_stop = domdev_present + 2;
                 }
-                is_residualized = 1;
-                cur_regressed_predictor_stop = domdev_present + allele_ct;
-                cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
-                cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
-                cur_biallelic_regressed_predictor_stop = domdev_present + 2;
-              }
-            }
-            // validParameters() check
-            for (uint32_t pred_uidx = 1; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-              const float hh_inv_diag_element = hh_return[pred_uidx * cur_regressed_predictor_ctavp1];
-              if ((hh_inv_diag_element < S_CAST(float, 1e-20)) || (!isfinite_f(hh_inv_diag_element))) {
-                glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
-                goto GlmLogisticThreadF_skip_regression;
               }
-              // use sample_variance_buf[] to store diagonal square roots
-              sample_variance_buf[pred_uidx] = sqrtf(hh_inv_diag_element);
-            }
-            if (!is_residualized) {
-              sample_variance_buf[0] = sqrtf(hh_return[0]);
-            }
-            for (uint32_t pred_uidx = 1 + is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-              const float cur_hh_inv_diag_sqrt = S_CAST(float, 0.99999) * sample_variance_buf[pred_uidx];
-              const float* hh_inv_row_iter = &(hh_return[pred_uidx * cur_regressed_predictor_ctav + is_residualized]);
-              const float* hh_inv_diag_sqrts_iter = &(sample_variance_buf[is_residualized]);
-              for (uint32_t pred_uidx2 = is_residualized; pred_uidx2 != pred_uidx; ++pred_uidx2) {
-                if ((*hh_inv_row_iter++) > cur_hh_inv_diag_sqrt * (*hh_inv_diag_sqrts_iter++)) {
+              // validParameters() check
+              for (uint32_t pred_uidx = 1; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                const float hh_inv_diag_element = hh_return[pred_uidx * cur_regressed_predictor_ctavp1];
+                if ((hh_inv_diag_element < S_CAST(float, 1e-20)) || (!isfinite_f(hh_inv_diag_element))) {
                   glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
                   goto GlmLogisticThreadF_skip_regression;
                 }
+                // use sample_variance_buf[] to store diagonal square roots
+                sample_variance_buf[pred_uidx] = sqrtf(hh_inv_diag_element);
               }
-            }
-            if (is_unfinished) {
-              block_aux_iter[extra_regression_idx].is_unfinished = 1;
-              if (allele_ct_m2 && beta_se_multiallelic_fused) {
-                for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
-                  block_aux_iter[uii].is_unfinished = 1;
-                }
-              }
-            }
-            {
-              double* beta_se_iter2 = beta_se_iter;
-              for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
-                // In the multiallelic-fused case, if the first allele is
-                // constant, this writes the beta/se values for the first
-                // nonconstant, non-omitted allele where the results for the
-                // first allele belong.  We correct that at the end of this
-                // block.
-                *beta_se_iter2++ = S_CAST(double, coef_return[pred_uidx]);
-                *beta_se_iter2++ = S_CAST(double, sample_variance_buf[pred_uidx]);
+              if (!is_residualized) {
+                sample_variance_buf[0] = sqrtf(hh_return[0]);
               }
-              if (cur_constraint_ct) {
-                // bugfix (4 Sep 2021): forgot to update this for residualize
-                // case
-                *beta_se_iter2++ = 0.0;
-
-                uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 1.0;
-                }
-                double chisq;
-                if (!LinearHypothesisChisqF(coef_return, cur_constraints_con_major, hh_return, cur_constraint_ct, cur_regressed_predictor_stop, cur_regressed_predictor_ctav, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, outer_buf)) {
-                  *beta_se_iter2++ = chisq;
-                } else {
-                  const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
-                  memcpy(&(beta_se_iter2[-1]), &glm_err2, 8);
-                  *beta_se_iter2++ = -9.0;
+              for (uint32_t pred_uidx = 1 + is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                const float cur_hh_inv_diag_sqrt = S_CAST(float, 0.99999) * sample_variance_buf[pred_uidx];
+                const float* hh_inv_row_iter = &(hh_return[pred_uidx * cur_regressed_predictor_ctav + is_residualized]);
+                const float* hh_inv_diag_sqrts_iter = &(sample_variance_buf[is_residualized]);
+                for (uint32_t pred_uidx2 = is_residualized; pred_uidx2 != pred_uidx; ++pred_uidx2) {
+                  if ((*hh_inv_row_iter++) > cur_hh_inv_diag_sqrt * (*hh_inv_diag_sqrts_iter++)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
+                    goto GlmLogisticThreadF_skip_regression;
+                  }
                 }
-                // next test may have different alt allele count
-                joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 0.0;
+              }
+              if (is_unfinished) {
+                block_aux_iter[extra_regression_idx].is_unfinished = 1;
+                if (allele_ct_m2 && beta_se_multiallelic_fused) {
+                  for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
+                    block_aux_iter[uii].is_unfinished = 1;
+                  }
                 }
               }
-              if (!const_allele_ct) {
-                if (beta_se_multiallelic_fused || (!hide_covar)) {
-                  for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-                    *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
-                    *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
+              {
+                double* beta_se_iter2 = beta_se_iter;
+                for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
+                  // In the multiallelic-fused case, if the first allele is
+                  // constant, this writes the beta/se values for the first
+                  // nonconstant, non-omitted allele where the results for the
+                  // first allele belong.  We correct that at the end of this
+                  // block.
+                  *beta_se_iter2++ = S_CAST(double, coef_return[pred_uidx]);
+                  *beta_se_iter2++ = S_CAST(double, sample_variance_buf[pred_uidx]);
+                }
+                if (cur_constraint_ct) {
+                  // bugfix (4 Sep 2021): forgot to update this for residualize
+                  // case
+                  *beta_se_iter2++ = 0.0;
+
+                  uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 1.0;
+                  }
+                  double chisq;
+                  if (!LinearHypothesisChisqF(coef_return, cur_constraints_con_major, hh_return, cur_constraint_ct, cur_regressed_predictor_stop, cur_regressed_predictor_ctav, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, outer_buf)) {
+                    *beta_se_iter2++ = chisq;
+                  } else {
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
+                    memcpy(&(beta_se_iter2[-1]), &glm_err2, 8);
+                    *beta_se_iter2++ = -9.0;
+                  }
+                  // next test may have different alt allele count
+                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 0.0;
                   }
                 }
-              } else if (!beta_se_multiallelic_fused) {
-                if (!hide_covar) {
-                  // Need to insert some {CONST_ALLELE, -9} entries.
+                if (!const_allele_ct) {
+                  if (beta_se_multiallelic_fused || (!hide_covar)) {
+                    for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                      *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
+                      *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
+                    }
+                  }
+                } else if (!beta_se_multiallelic_fused) {
+                  if (!hide_covar) {
+                    // Need to insert some {CONST_ALLELE, -9} entries.
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
+                    const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
+                    uint32_t extra_read_allele_idx = 0;
+                    for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                      if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
+                        continue;
+                      }
+                      if (IsSet(const_alleles, allele_idx)) {
+                        memcpy(beta_se_iter2, &glm_err2, 8);
+                        beta_se_iter2[1] = -9.0;
+                        beta_se_iter2 = &(beta_se_iter2[2]);
+                      } else {
+                        *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
+                        *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
+                        ++extra_read_allele_idx;
+                      }
+                    }
+                  }
+                } else {
                   const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                  const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
-                  uint32_t extra_read_allele_idx = 0;
-                  for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                    if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
-                      continue;
+                  // Special-case first nonconst allele since it's positioned
+                  // discontinuously, and its BETA/SE may already be correctly
+                  // filled.
+                  uint32_t allele_idx = omitted_allele_idx? 0 : 1;
+                  if (IsSet(const_alleles, allele_idx)) {
+                    memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
+                    beta_se_iter[2 * include_intercept + 1] = -9.0;
+                    allele_idx = AdvTo0Bit(const_alleles, 1);
+                    if (allele_idx == omitted_allele_idx) {
+                      allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
                     }
-                    if (IsSet(const_alleles, allele_idx)) {
+                    const uint32_t skip_ct = allele_idx - 1 - (allele_idx > omitted_allele_idx);
+                    for (uint32_t uii = 0; uii != skip_ct; ++uii) {
                       memcpy(beta_se_iter2, &glm_err2, 8);
                       beta_se_iter2[1] = -9.0;
                       beta_se_iter2 = &(beta_se_iter2[2]);
-                    } else {
-                      *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
-                      *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
-                      ++extra_read_allele_idx;
                     }
+                    *beta_se_iter2++ = S_CAST(double, coef_return[1]);
+                    *beta_se_iter2++ = S_CAST(double, sample_variance_buf[1]);
                   }
-                }
-              } else {
-                const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                // Special-case first nonconst allele since it's positioned
-                // discontinuously, and its BETA/SE may already be correctly
-                // filled.
-                uint32_t allele_idx = omitted_allele_idx? 0 : 1;
-                if (IsSet(const_alleles, allele_idx)) {
-                  memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
-                  beta_se_iter[2 * include_intercept + 1] = -9.0;
-                  allele_idx = AdvTo0Bit(const_alleles, 1);
-                  if (allele_idx == omitted_allele_idx) {
-                    allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
-                  }
-                  const uint32_t skip_ct = allele_idx - 1 - (allele_idx > omitted_allele_idx);
-                  for (uint32_t uii = 0; uii != skip_ct; ++uii) {
-                    memcpy(beta_se_iter2, &glm_err2, 8);
-                    beta_se_iter2[1] = -9.0;
-                    beta_se_iter2 = &(beta_se_iter2[2]);
+                  ++allele_idx;
+                  uint32_t nonconst_allele_idx_m1 = 0;
+                  for (; allele_idx != allele_ct; ++allele_idx) {
+                    if (allele_idx == omitted_allele_idx) {
+                      continue;
+                    }
+                    if (!IsSet(const_alleles, allele_idx)) {
+                      *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
+                      *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
+                      ++nonconst_allele_idx_m1;
+                    } else {
+                      memcpy(beta_se_iter2, &glm_err2, 8);
+                      beta_se_iter2[1] = -9.0;
+                      beta_se_iter2 = &(beta_se_iter2[2]);
+                    }
                   }
-                  *beta_se_iter2++ = S_CAST(double, coef_return[1]);
-                  *beta_se_iter2++ = S_CAST(double, sample_variance_buf[1]);
                 }
-                ++allele_idx;
-                uint32_t nonconst_allele_idx_m1 = 0;
-                for (; allele_idx != allele_ct; ++allele_idx) {
-                  if (allele_idx == omitted_allele_idx) {
-                    continue;
+              }
+              while (0) {
+              GlmLogisticThreadF_skip_regression:
+                {
+                  uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+                  if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
+                    reported_ct += allele_ct_m2;
                   }
-                  if (!IsSet(const_alleles, allele_idx)) {
-                    *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
-                    *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
-                    ++nonconst_allele_idx_m1;
-                  } else {
-                    memcpy(beta_se_iter2, &glm_err2, 8);
-                    beta_se_iter2[1] = -9.0;
-                    beta_se_iter2 = &(beta_se_iter2[2]);
+                  for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                    memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                    beta_se_iter[uii * 2 + 1] = -9.0;
                   }
                 }
               }
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
             }
-            while (0) {
-            GlmLogisticThreadF_skip_regression:
-              {
-                uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-                if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
-                  reported_ct += allele_ct_m2;
-                }
-                for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-                  memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-                  beta_se_iter[uii * 2 + 1] = -9.0;
-                }
-              }
-            }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
           }
-        }
-        block_aux_iter = &(block_aux_iter[allele_ct - 1]);
-        if (local_covars_iter) {
-          local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
+          block_aux_iter = &(block_aux_iter[allele_ct - 1]);
+          if (local_covars_iter) {
+            local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
+          }
         }
       }
     }
@@ -3597,7 +3615,6 @@ THREAD_FUNC_DECL GlmLogisticThreadD(void* raw_arg) {
   const uintptr_t* sex_male_collapsed = common->sex_male_collapsed;
   const ChrInfo* cip = common->cip;
   const uint32_t* subset_chr_fo_vidx_start = common->subset_chr_fo_vidx_start;
-  const uint32_t calc_thread_ct = GetThreadCt(arg->sharedp);
   const GlmFlags glm_flags = common->glm_flags;
   const uint32_t add_interactions = (glm_flags / kfGlmInteraction) & 1;
   const uint32_t hide_covar = (glm_flags / kfGlmHideCovar) & 1;
@@ -3640,1264 +3657,1283 @@ THREAD_FUNC_DECL GlmLogisticThreadD(void* raw_arg) {
   uint64_t new_err_info = 0;
   do {
     const uintptr_t cur_block_variant_ct = common->cur_block_variant_ct;
-    uint32_t variant_bidx = (tidx * cur_block_variant_ct) / calc_thread_ct;
-    const uint32_t variant_bidx_end = ((tidx + 1) * cur_block_variant_ct) / calc_thread_ct;
-    uintptr_t variant_uidx_base;
-    uintptr_t variant_include_bits;
-    BitIter1Start(variant_include, common->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
-
-    double* beta_se_iter = common->block_beta_se;
-    uintptr_t allele_bidx = variant_bidx;
-    if (max_extra_allele_ct) {
-      allele_bidx = variant_bidx + CountExtraAlleles(variant_include, allele_idx_offsets, common->read_variant_uidx_starts[0], common->read_variant_uidx_starts[tidx], 0);
-    }
-    if (beta_se_multiallelic_fused) {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
-    } else {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
-    }
-
-    LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
-    const double* local_covars_iter = nullptr;
-    if (local_covar_ct) {
-      local_covars_iter = &(ctx->local_covars_vcmaj_d[parity][variant_bidx * max_sample_ct * local_covar_ct]);
-    }
-    while (variant_bidx < variant_bidx_end) {
-      const uint32_t variant_idx = variant_bidx + variant_idx_offset;
-      const uint32_t chr_fo_idx = LastLeqU32(subset_chr_fo_vidx_start, 0, cip->chr_ct, variant_idx);
-      // const uint32_t chr_fo_idx = LowerBoundNonemptyU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
-      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
-      uint32_t cur_variant_bidx_end = subset_chr_fo_vidx_start[chr_fo_idx + 1] - variant_idx_offset;
-      if (cur_variant_bidx_end > variant_bidx_end) {
-        cur_variant_bidx_end = variant_bidx_end;
-      }
-      // "regular" = not all-female special case.
-      const uint32_t is_haploid = IsSet(cip->haploid_mask, chr_idx);
-      const uint32_t is_regular_x = is_haploid && (chr_idx == x_code);
-      const uint32_t is_y = (chr_idx == y_code);
-      const uint32_t is_nonx_haploid = is_haploid && (!is_regular_x);
-      const uintptr_t* cur_sample_include;
-      const uint32_t* cur_sample_include_cumulative_popcounts;
-      const uintptr_t* cur_pheno_cc;
-      const uintptr_t* cur_gcount_case_interleaved_vec;
-      const double* cur_pheno;
-      const RegressionNmPrecomp* nm_precomp;
-      const double* cur_covars_cmaj;
-      const uintptr_t* cur_parameter_subset;
-      const uintptr_t* cur_joint_test_params;
-      const CcResidualizeCtx* cur_cc_residualize;
-      uint32_t cur_sample_ct;
-      uint32_t cur_covar_ct;
-      uint32_t cur_constraint_ct;
-      uint32_t cur_is_always_firth;
-      if (is_y && common->sample_include_y) {
-        cur_sample_include = common->sample_include_y;
-        cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_y_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_y;
-        cur_pheno = ctx->pheno_y_d;
-        nm_precomp = common->nm_precomp_y;
-        cur_covars_cmaj = ctx->covars_cmaj_y_d;
-        cur_parameter_subset = common->parameter_subset_y;
-        cur_joint_test_params = common->joint_test_params_y;
-        cur_cc_residualize = ctx->cc_residualize_y;
-        cur_sample_ct = common->sample_ct_y;
-        cur_covar_ct = common->covar_ct_y;
-        cur_constraint_ct = common->constraint_ct_y;
-        cur_is_always_firth = is_always_firth || ctx->separation_found_y;
-      } else if (is_regular_x && common->sample_include_x) {
-        cur_sample_include = common->sample_include_x;
-        cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_x_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_x;
-        cur_pheno = ctx->pheno_x_d;
-        nm_precomp = common->nm_precomp_x;
-        cur_covars_cmaj = ctx->covars_cmaj_x_d;
-        cur_parameter_subset = common->parameter_subset_x;
-        cur_joint_test_params = common->joint_test_params_x;
-        cur_cc_residualize = ctx->cc_residualize_x;
-        cur_sample_ct = common->sample_ct_x;
-        cur_covar_ct = common->covar_ct_x;
-        cur_constraint_ct = common->constraint_ct_x;
-        cur_is_always_firth = is_always_firth || ctx->separation_found_x;
-      } else {
-        cur_sample_include = common->sample_include;
-        cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec;
-        cur_pheno = ctx->pheno_d;
-        nm_precomp = common->nm_precomp;
-        cur_covars_cmaj = ctx->covars_cmaj_d;
-        cur_parameter_subset = common->parameter_subset;
-        cur_joint_test_params = common->joint_test_params;
-        cur_cc_residualize = ctx->cc_residualize;
-        cur_sample_ct = common->sample_ct;
-        cur_covar_ct = common->covar_ct;
-        cur_constraint_ct = common->constraint_ct;
-        cur_is_always_firth = is_always_firth || ctx->separation_found;
+    const uint32_t block_uidx_start = common->read_variant_uidx_starts[0];
+    uint32_t task_bidx_start;
+    uint32_t variant_bidx_end;
+    // Tasks taken from our own range arrive in increasing order, so the
+    // variant_include scan resumes from the previous task start unless we
+    // just stole an earlier range.
+    uint32_t prev_task_bidx_start = 0;
+    uint32_t prev_task_uidx_start = block_uidx_start;
+    uintptr_t prev_task_extra_allele_ct = 0;
+    while (TaskDequesNext(tidx, &common->tdq, &task_bidx_start, &variant_bidx_end)) {
+      uint32_t variant_bidx = task_bidx_start;
+      if (task_bidx_start < prev_task_bidx_start) {
+        prev_task_bidx_start = 0;
+        prev_task_uidx_start = block_uidx_start;
+        prev_task_extra_allele_ct = 0;
       }
-      const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
-      const uint32_t sample_ctav = RoundUpPow2(cur_sample_ct, kDoublePerDVec);
-      const uint32_t cur_case_ct = PopcountWords(cur_pheno_cc, sample_ctl);
-      const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
-      uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
-      uint32_t literal_covar_ct = cur_covar_ct;
-      if (cur_parameter_subset) {
-        cur_biallelic_predictor_ct = PopcountWords(cur_parameter_subset, BitCtToWordCt(cur_biallelic_predictor_ct_base));
-        literal_covar_ct = PopcountBitRange(cur_parameter_subset, 2 + domdev_present, 2 + domdev_present + cur_covar_ct);
+      const uint32_t task_uidx_start = FindNth1BitFrom(variant_include, prev_task_uidx_start, task_bidx_start - prev_task_bidx_start + 1);
+      uintptr_t variant_uidx_base;
+      uintptr_t variant_include_bits;
+      BitIter1Start(variant_include, task_uidx_start, &variant_uidx_base, &variant_include_bits);
+
+      double* beta_se_iter = common->block_beta_se;
+      uintptr_t allele_bidx = variant_bidx;
+      if (max_extra_allele_ct) {
+        prev_task_extra_allele_ct += CountExtraAlleles(variant_include, allele_idx_offsets, prev_task_uidx_start, task_uidx_start, 0);
+        allele_bidx = variant_bidx + prev_task_extra_allele_ct;
       }
-      const uint32_t max_predictor_ct = cur_biallelic_predictor_ct + max_extra_allele_ct;
-      const uint32_t max_predictor_ctav = RoundUpPow2(max_predictor_ct, kDoublePerDVec);
-      uint32_t reported_pred_uidx_biallelic_end;
-      if (hide_covar) {
-        if (!cur_parameter_subset) {
-          reported_pred_uidx_biallelic_end = 2 + domdev_present;
-        } else {
-          reported_pred_uidx_biallelic_end = 1 + IsSet(cur_parameter_subset, 1) + domdev_present;
-        }
+      prev_task_bidx_start = task_bidx_start;
+      prev_task_uidx_start = task_uidx_start;
+      if (beta_se_multiallelic_fused) {
+        beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
       } else {
-        reported_pred_uidx_biallelic_end = cur_biallelic_predictor_ct;
-      }
-      // nm_predictors_pmaj_buf may require up to two extra columns omitted
-      // from the main regression.
-      // 1. In the multiallelic dominant/recessive/hetonly/hethom cases, the
-      //    original genotype column does not appear in the regression, and
-      //    we'd rather not reconstruct it from genovec, etc. when we need to
-      //    swap it out for another allele, so we keep the original genotype in
-      //    an extra column.
-      //    To reduce code bloat, we now handle the biallelic cases in the same
-      //    way; this is one of the more peripheral code paths so adding more
-      //    complexity to speed it up is less justifiable.
-      // 2. If --parameters excludes the main (possibly
-      //    dominant/recessive/hetonly) genotype column but does care about an
-      //    interaction, we want a copy of what the main genotype column's
-      //    contents would have been to refer to.
-      const uint32_t main_omitted = cur_parameter_subset && (!IsSet(cur_parameter_subset, 1));
-      const uint32_t main_mutated = model_dominant || model_recessive || model_hetonly || joint_hethom;
-      unsigned char* workspace_iter = workspace_buf;
-      uintptr_t* sample_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      uintptr_t* pheno_cc_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      uintptr_t* tmp_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
-      double* nm_pheno_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
-      double* nm_predictors_pmaj_buf = S_CAST(double*, arena_alloc_raw_rd((max_predictor_ct + main_mutated + main_omitted) * sample_ctav * sizeof(double), &workspace_iter));
-      double* coef_return = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(double), &workspace_iter));
-      double* hh_return = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
-      double* pp_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
-      double* sample_variance_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
-      double* gradient_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(double), &workspace_iter));
-      double* dcoef_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(double), &workspace_iter));
-      double* cholesky_decomp_return = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
-
-      double* semicomputed_biallelic_xtx = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
-      // currently overallocates
-      double* semicomputed_biallelic_corr_matrix = S_CAST(double*, arena_alloc_raw_rd((cur_biallelic_predictor_ct - 1) * (cur_biallelic_predictor_ct - 1) * sizeof(double), &workspace_iter));
-      double* semicomputed_biallelic_inv_corr_sqrts = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
-
-      MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, arena_alloc_raw_rd(max_predictor_ct * kMatrixInvertBuf1CheckedAlloc, &workspace_iter));
-      const uintptr_t dbl_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 7) * sizeof(double), kCacheline);
-      double* dbl_2d_buf = S_CAST(double*, arena_alloc_raw(dbl_2d_byte_ct, &workspace_iter));
-      double* a1_dosages = S_CAST(double*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(double) * 2, &workspace_iter));
-      double* a1_case_dosages = &(a1_dosages[max_extra_allele_ct + 2]);
-      uint64_t* machr2_dosage_sums = S_CAST(uint64_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(uint64_t) * 2, &workspace_iter));
-      uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
-      uint32_t* case_one_cts = nullptr;
-      uint32_t* case_two_cts = nullptr;
-      if (cur_gcount_case_interleaved_vec && max_extra_allele_ct) {
-        case_one_cts = S_CAST(uint32_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(int32_t) * 2, &workspace_iter));
-        case_two_cts = &(case_one_cts[max_extra_allele_ct + 2]);
-      }
-      double* predictor_dotprod_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ct * sizeof(double), &workspace_iter));
-      const uintptr_t other_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 3) * sizeof(double), kCacheline);
-      double* inverse_corr_buf = S_CAST(double*, arena_alloc_raw(other_2d_byte_ct, &workspace_iter));
-
-      // these could use the same memory, but not a big deal, use the less
-      // bug-prone approach for now
-      // Firth-only
-      double* hdiag_buf = nullptr;
-      double* score_buf = nullptr;
-      double* hh0_buf = nullptr;
-      double* tmpnxk_buf = nullptr;
-      if (is_sometimes_firth) {
-        hdiag_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
-        score_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
-        hh0_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
-        tmpnxk_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * sample_ctav * sizeof(double), &workspace_iter));
-      }
-      double* mean_centered_pmaj_buf = nullptr;
-      double* sample_offsets_buf = nullptr;
-      if (cur_cc_residualize) {
-        mean_centered_pmaj_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double) * (domdev_present_p1 + max_extra_allele_ct), &workspace_iter));
-        sample_offsets_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
+        beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
       }
 
-      // joint test only
-      double* tmphxs_buf = nullptr;
-      double* h_transpose_buf = nullptr;
-      double* inner_buf = nullptr;
-      double* outer_buf = nullptr;
-      double* cur_constraints_con_major = nullptr;
-      if (cur_constraint_ct) {
-        tmphxs_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
-        h_transpose_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
-        inner_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * cur_constraint_ct * sizeof(double), &workspace_iter));
-        outer_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * sizeof(double), &workspace_iter));
-        cur_constraints_con_major = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
-        ZeroDArr(cur_constraint_ct * max_predictor_ct, cur_constraints_con_major);
-        const uint32_t first_joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-        cur_constraints_con_major[first_joint_test_idx] = 1.0;
-        // Rest of this matrix must be updated later, since cur_predictor_ct
-        // changes at multiallelic variants.
-      }
-      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLogisticWorkspaceSizeD(cur_sample_ct, cur_biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, cur_gcount_case_interleaved_vec != nullptr, is_sometimes_firth, cur_cc_residualize != nullptr));
-      const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
-      const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
-      const double* corr_inv = nullptr;
-      if (nm_precomp) {
-        memcpy(semicomputed_biallelic_xtx, nm_precomp->xtx_image, cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double));
-        corr_inv = nm_precomp->corr_inv;
-        const uintptr_t nongeno_pred_ct = cur_biallelic_predictor_ct - domdev_present - 2;
-        const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
-        memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
-        memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
+      LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
+      const double* local_covars_iter = nullptr;
+      if (local_covar_ct) {
+        local_covars_iter = &(ctx->local_covars_vcmaj_d[parity][variant_bidx * max_sample_ct * local_covar_ct]);
       }
-      PgrSampleSubsetIndex pssi;
-      PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
-      // when this is set, the last fully-processed variant had no missing
-      // genotypes, and if the current variant also has no missing genotypes we
-      // may be able to skip reinitialization of most of
-      // nm_predictors_pmaj_buf.
-      // (todo: do we want to track prev_biallelic_nm?)
-      uint32_t prev_nm = 0;
-
-      STD_ARRAY_DECL(uint32_t, 4, genocounts);
-      for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
-        const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
-        if (allele_idx_offsets) {
-          allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
-          if (!beta_se_multiallelic_fused) {
-            extra_regression_ct = allele_ct - 2;
-          }
+      while (variant_bidx < variant_bidx_end) {
+        const uint32_t variant_idx = variant_bidx + variant_idx_offset;
+        const uint32_t chr_fo_idx = LastLeqU32(subset_chr_fo_vidx_start, 0, cip->chr_ct, variant_idx);
+        // const uint32_t chr_fo_idx = LowerBoundNonemptyU32(&(subset_chr_fo_vidx_start[1]), cip->chr_ct, variant_idx + 1);
+        const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+        uint32_t cur_variant_bidx_end = subset_chr_fo_vidx_start[chr_fo_idx + 1] - variant_idx_offset;
+        if (cur_variant_bidx_end > variant_bidx_end) {
+          cur_variant_bidx_end = variant_bidx_end;
         }
-        const uint32_t allele_ct_m2 = allele_ct - 2;
-        const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
-        PglErr reterr;
-        if (!allele_ct_m2) {
-          reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+        // "regular" = not all-female special case.
+        const uint32_t is_haploid = IsSet(cip->haploid_mask, chr_idx);
+        const uint32_t is_regular_x = is_haploid && (chr_idx == x_code);
+        const uint32_t is_y = (chr_idx == y_code);
+        const uint32_t is_nonx_haploid = is_haploid && (!is_regular_x);
+        const uintptr_t* cur_sample_include;
+        const uint32_t* cur_sample_include_cumulative_popcounts;
+        const uintptr_t* cur_pheno_cc;
+        const uintptr_t* cur_gcount_case_interleaved_vec;
+        const double* cur_pheno;
+        const RegressionNmPrecomp* nm_precomp;
+        const double* cur_covars_cmaj;
+        const uintptr_t* cur_parameter_subset;
+        const uintptr_t* cur_joint_test_params;
+        const CcResidualizeCtx* cur_cc_residualize;
+        uint32_t cur_sample_ct;
+        uint32_t cur_covar_ct;
+        uint32_t cur_constraint_ct;
+        uint32_t cur_is_always_firth;
+        if (is_y && common->sample_include_y) {
+          cur_sample_include = common->sample_include_y;
+          cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
+          cur_pheno_cc = ctx->pheno_y_cc;
+          cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_y;
+          cur_pheno = ctx->pheno_y_d;
+          nm_precomp = common->nm_precomp_y;
+          cur_covars_cmaj = ctx->covars_cmaj_y_d;
+          cur_parameter_subset = common->parameter_subset_y;
+          cur_joint_test_params = common->joint_test_params_y;
+          cur_cc_residualize = ctx->cc_residualize_y;
+          cur_sample_ct = common->sample_ct_y;
+          cur_covar_ct = common->covar_ct_y;
+          cur_constraint_ct = common->constraint_ct_y;
+          cur_is_always_firth = is_always_firth || ctx->separation_found_y;
+        } else if (is_regular_x && common->sample_include_x) {
+          cur_sample_include = common->sample_include_x;
+          cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
+          cur_pheno_cc = ctx->pheno_x_cc;
+          cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_x;
+          cur_pheno = ctx->pheno_x_d;
+          nm_precomp = common->nm_precomp_x;
+          cur_covars_cmaj = ctx->covars_cmaj_x_d;
+          cur_parameter_subset = common->parameter_subset_x;
+          cur_joint_test_params = common->joint_test_params_x;
+          cur_cc_residualize = ctx->cc_residualize_x;
+          cur_sample_ct = common->sample_ct_x;
+          cur_covar_ct = common->covar_ct_x;
+          cur_constraint_ct = common->constraint_ct_x;
+          cur_is_always_firth = is_always_firth || ctx->separation_found_x;
         } else {
-          reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
-          // todo: proper multiallelic dosage support
+          cur_sample_include = common->sample_include;
+          cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
+          cur_pheno_cc = ctx->pheno_cc;
+          cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec;
+          cur_pheno = ctx->pheno_d;
+          nm_precomp = common->nm_precomp;
+          cur_covars_cmaj = ctx->covars_cmaj_d;
+          cur_parameter_subset = common->parameter_subset;
+          cur_joint_test_params = common->joint_test_params;
+          cur_cc_residualize = ctx->cc_residualize;
+          cur_sample_ct = common->sample_ct;
+          cur_covar_ct = common->covar_ct;
+          cur_constraint_ct = common->constraint_ct;
+          cur_is_always_firth = is_always_firth || ctx->separation_found;
         }
-        if (unlikely(reterr)) {
-          new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
-          goto GlmLogisticThreadD_err;
+        const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
+        const uint32_t sample_ctav = RoundUpPow2(cur_sample_ct, kDoublePerDVec);
+        const uint32_t cur_case_ct = PopcountWords(cur_pheno_cc, sample_ctl);
+        const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
+        uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
+        uint32_t literal_covar_ct = cur_covar_ct;
+        if (cur_parameter_subset) {
+          cur_biallelic_predictor_ct = PopcountWords(cur_parameter_subset, BitCtToWordCt(cur_biallelic_predictor_ct_base));
+          literal_covar_ct = PopcountBitRange(cur_parameter_subset, 2 + domdev_present, 2 + domdev_present + cur_covar_ct);
         }
-        ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-        GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
-        uint32_t missing_ct = genocounts[3];
-        if (!missing_ct) {
-          SetAllBits(cur_sample_ct, sample_nm);
-        } else {
-          GenoarrToNonmissing(pgv.genovec, cur_sample_ct, sample_nm);
-          if (pgv.dosage_ct) {
-            BitvecOr(pgv.dosage_present, sample_ctl, sample_nm);
-            missing_ct = cur_sample_ct - PopcountWords(sample_nm, sample_ctl);
+        const uint32_t max_predictor_ct = cur_biallelic_predictor_ct + max_extra_allele_ct;
+        const uint32_t max_predictor_ctav = RoundUpPow2(max_predictor_ct, kDoublePerDVec);
+        uint32_t reported_pred_uidx_biallelic_end;
+        if (hide_covar) {
+          if (!cur_parameter_subset) {
+            reported_pred_uidx_biallelic_end = 2 + domdev_present;
+          } else {
+            reported_pred_uidx_biallelic_end = 1 + IsSet(cur_parameter_subset, 1) + domdev_present;
           }
+        } else {
+          reported_pred_uidx_biallelic_end = cur_biallelic_predictor_ct;
         }
-        if (omitted_alleles) {
-          omitted_allele_idx = omitted_alleles[variant_uidx];
+        // nm_predictors_pmaj_buf may require up to two extra columns omitted
+        // from the main regression.
+        // 1. In the multiallelic dominant/recessive/hetonly/hethom cases, the
+        //    original genotype column does not appear in the regression, and
+        //    we'd rather not reconstruct it from genovec, etc. when we need to
+        //    swap it out for another allele, so we keep the original genotype in
+        //    an extra column.
+        //    To reduce code bloat, we now handle the biallelic cases in the same
+        //    way; this is one of the more peripheral code paths so adding more
+        //    complexity to speed it up is less justifiable.
+        // 2. If --parameters excludes the main (possibly
+        //    dominant/recessive/hetonly) genotype column but does care about an
+        //    interaction, we want a copy of what the main genotype column's
+        //    contents would have been to refer to.
+        const uint32_t main_omitted = cur_parameter_subset && (!IsSet(cur_parameter_subset, 1));
+        const uint32_t main_mutated = model_dominant || model_recessive || model_hetonly || joint_hethom;
+        unsigned char* workspace_iter = workspace_buf;
+        uintptr_t* sample_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        uintptr_t* pheno_cc_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        uintptr_t* tmp_nm = S_CAST(uintptr_t*, arena_alloc_raw_rd(sample_ctl * sizeof(intptr_t), &workspace_iter));
+        double* nm_pheno_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
+        double* nm_predictors_pmaj_buf = S_CAST(double*, arena_alloc_raw_rd((max_predictor_ct + main_mutated + main_omitted) * sample_ctav * sizeof(double), &workspace_iter));
+        double* coef_return = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(double), &workspace_iter));
+        double* hh_return = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
+        double* pp_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
+        double* sample_variance_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
+        double* gradient_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(double), &workspace_iter));
+        double* dcoef_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ctav * sizeof(double), &workspace_iter));
+        double* cholesky_decomp_return = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
+
+        double* semicomputed_biallelic_xtx = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+        // currently overallocates
+        double* semicomputed_biallelic_corr_matrix = S_CAST(double*, arena_alloc_raw_rd((cur_biallelic_predictor_ct - 1) * (cur_biallelic_predictor_ct - 1) * sizeof(double), &workspace_iter));
+        double* semicomputed_biallelic_inv_corr_sqrts = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+
+        MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, arena_alloc_raw_rd(max_predictor_ct * kMatrixInvertBuf1CheckedAlloc, &workspace_iter));
+        const uintptr_t dbl_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 7) * sizeof(double), kCacheline);
+        double* dbl_2d_buf = S_CAST(double*, arena_alloc_raw(dbl_2d_byte_ct, &workspace_iter));
+        double* a1_dosages = S_CAST(double*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(double) * 2, &workspace_iter));
+        double* a1_case_dosages = &(a1_dosages[max_extra_allele_ct + 2]);
+        uint64_t* machr2_dosage_sums = S_CAST(uint64_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(uint64_t) * 2, &workspace_iter));
+        uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
+        uint32_t* case_one_cts = nullptr;
+        uint32_t* case_two_cts = nullptr;
+        if (cur_gcount_case_interleaved_vec && max_extra_allele_ct) {
+          case_one_cts = S_CAST(uint32_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(int32_t) * 2, &workspace_iter));
+          case_two_cts = &(case_one_cts[max_extra_allele_ct + 2]);
         }
-        // Once sizeof(AlleleCode) > 1, we probably want to allocate this from
-        // g_bigstack instead of the thread stack.
-        uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
-        const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
-        ZeroWArr(allele_ctl, const_alleles);
-        const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
-        const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
-        const uint32_t nm_sample_ctav = RoundUpPow2(nm_sample_ct, kDoublePerDVec);
-        const uint32_t nm_sample_ct_rem = nm_sample_ctav - nm_sample_ct;
-        // first predictor column: intercept
-        if (!prev_nm) {
-          FillDVec(nm_sample_ct, 1.0, nm_predictors_pmaj_buf);
+        double* predictor_dotprod_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ct * sizeof(double), &workspace_iter));
+        const uintptr_t other_2d_byte_ct = RoundUpPow2(max_predictor_ct * MAXV(max_predictor_ct, 3) * sizeof(double), kCacheline);
+        double* inverse_corr_buf = S_CAST(double*, arena_alloc_raw(other_2d_byte_ct, &workspace_iter));
+
+        // these could use the same memory, but not a big deal, use the less
+        // bug-prone approach for now
+        // Firth-only
+        double* hdiag_buf = nullptr;
+        double* score_buf = nullptr;
+        double* hh0_buf = nullptr;
+        double* tmpnxk_buf = nullptr;
+        if (is_sometimes_firth) {
+          hdiag_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
+          score_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
+          hh0_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
+          tmpnxk_buf = S_CAST(double*, arena_alloc_raw_rd(max_predictor_ct * sample_ctav * sizeof(double), &workspace_iter));
         }
-        // second predictor column: genotype
-        double* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
-        if (main_mutated || main_omitted) {
-          // bugfix (9 Oct 2024)
-          ZeroDArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
-          genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ctav]);
+        double* mean_centered_pmaj_buf = nullptr;
+        double* sample_offsets_buf = nullptr;
+        if (cur_cc_residualize) {
+          mean_centered_pmaj_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double) * (domdev_present_p1 + max_extra_allele_ct), &workspace_iter));
+          sample_offsets_buf = S_CAST(double*, arena_alloc_raw_rd(sample_ctav * sizeof(double), &workspace_iter));
         }
-        CopyBitarrSubset(cur_pheno_cc, sample_nm, nm_sample_ct, pheno_cc_nm);
-        const uint32_t nm_case_ct = PopcountWords(pheno_cc_nm, nm_sample_ctl);
-        double* multi_start = nullptr;
-        if (!allele_ct_m2) {
-          if (omitted_allele_idx) {
-            GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
-            // ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-            if (pgv.dosage_ct) {
-              BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
+
+        // joint test only
+        double* tmphxs_buf = nullptr;
+        double* h_transpose_buf = nullptr;
+        double* inner_buf = nullptr;
+        double* outer_buf = nullptr;
+        double* cur_constraints_con_major = nullptr;
+        if (cur_constraint_ct) {
+          tmphxs_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
+          h_transpose_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ctav * sizeof(double), &workspace_iter));
+          inner_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * cur_constraint_ct * sizeof(double), &workspace_iter));
+          outer_buf = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * sizeof(double), &workspace_iter));
+          cur_constraints_con_major = S_CAST(double*, arena_alloc_raw_rd(cur_constraint_ct * max_predictor_ct * sizeof(double), &workspace_iter));
+          ZeroDArr(cur_constraint_ct * max_predictor_ct, cur_constraints_con_major);
+          const uint32_t first_joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+          cur_constraints_con_major[first_joint_test_idx] = 1.0;
+          // Rest of this matrix must be updated later, since cur_predictor_ct
+          // changes at multiallelic variants.
+        }
+        assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLogisticWorkspaceSizeD(cur_sample_ct, cur_biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, cur_gcount_case_interleaved_vec != nullptr, is_sometimes_firth, cur_cc_residualize != nullptr));
+        const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
+        const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
+        const double* corr_inv = nullptr;
+        if (nm_precomp) {
+          memcpy(semicomputed_biallelic_xtx, nm_precomp->xtx_image, cur_biallelic_predictor_ct * cur_biallelic_predictor_ct * sizeof(double));
+          corr_inv = nm_precomp->corr_inv;
+          const uintptr_t nongeno_pred_ct = cur_biallelic_predictor_ct - domdev_present - 2;
+          const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
+          memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
+          memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
+        }
+        PgrSampleSubsetIndex pssi;
+        PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
+        // when this is set, the last fully-processed variant had no missing
+        // genotypes, and if the current variant also has no missing genotypes we
+        // may be able to skip reinitialization of most of
+        // nm_predictors_pmaj_buf.
+        // (todo: do we want to track prev_biallelic_nm?)
+        uint32_t prev_nm = 0;
+
+        STD_ARRAY_DECL(uint32_t, 4, genocounts);
+        for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
+          const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
+          if (allele_idx_offsets) {
+            allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
+            if (!beta_se_multiallelic_fused) {
+              extra_regression_ct = allele_ct - 2;
             }
-            const uint32_t uii = genocounts[0];
-            genocounts[0] = genocounts[2];
-            genocounts[2] = uii;
           }
-          uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
-          uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
+          const uint32_t allele_ct_m2 = allele_ct - 2;
+          const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
+          PglErr reterr;
+          if (!allele_ct_m2) {
+            reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+          } else {
+            reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
+            // todo: proper multiallelic dosage support
+          }
+          if (unlikely(reterr)) {
+            new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
+            goto GlmLogisticThreadD_err;
+          }
+          ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+          GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+          uint32_t missing_ct = genocounts[3];
           if (!missing_ct) {
-            GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, genotype_vals);
+            SetAllBits(cur_sample_ct, sample_nm);
+          } else {
+            GenoarrToNonmissing(pgv.genovec, cur_sample_ct, sample_nm);
             if (pgv.dosage_ct) {
-              uintptr_t sample_idx_base = 0;
-              uintptr_t dosage_present_bits = pgv.dosage_present[0];
-              for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
-                const uint32_t dosage_val = pgv.dosage_main[dosage_idx];
-                // 32768 -> 2, 16384 -> 1, 0 -> 0
-                genotype_vals[sample_idx] = kRecipDosageMid * u31tod(dosage_val);
-                dosage_sum += dosage_val;
-                dosage_ssq += dosage_val * dosage_val;
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
-                if (cur_geno && (cur_geno != 3)) {
-                  const uintptr_t prev_val = cur_geno * kDosageMid;
-                  dosage_sum -= prev_val;
-                  dosage_ssq -= prev_val * prev_val;
-                }
+              BitvecOr(pgv.dosage_present, sample_ctl, sample_nm);
+              missing_ct = cur_sample_ct - PopcountWords(sample_nm, sample_ctl);
+            }
+          }
+          if (omitted_alleles) {
+            omitted_allele_idx = omitted_alleles[variant_uidx];
+          }
+          // Once sizeof(AlleleCode) > 1, we probably want to allocate this from
+          // g_bigstack instead of the thread stack.
+          uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
+          const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
+          ZeroWArr(allele_ctl, const_alleles);
+          const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
+          const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
+          const uint32_t nm_sample_ctav = RoundUpPow2(nm_sample_ct, kDoublePerDVec);
+          const uint32_t nm_sample_ct_rem = nm_sample_ctav - nm_sample_ct;
+          // first predictor column: intercept
+          if (!prev_nm) {
+            FillDVec(nm_sample_ct, 1.0, nm_predictors_pmaj_buf);
+          }
+          // second predictor column: genotype
+          double* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
+          if (main_mutated || main_omitted) {
+            // bugfix (9 Oct 2024)
+            ZeroDArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
+            genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ctav]);
+          }
+          CopyBitarrSubset(cur_pheno_cc, sample_nm, nm_sample_ct, pheno_cc_nm);
+          const uint32_t nm_case_ct = PopcountWords(pheno_cc_nm, nm_sample_ctl);
+          double* multi_start = nullptr;
+          if (!allele_ct_m2) {
+            if (omitted_allele_idx) {
+              GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
+              // ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+              if (pgv.dosage_ct) {
+                BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
               }
+              const uint32_t uii = genocounts[0];
+              genocounts[0] = genocounts[2];
+              genocounts[2] = uii;
             }
-          } else {
-            if (!pgv.dosage_ct) {
-              GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, genotype_vals);
-            } else {
-              uintptr_t sample_midx_base = 0;
-              uintptr_t sample_nm_bits = sample_nm[0];
-              uint32_t dosage_idx = 0;
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
-                double cur_val;
-                if (IsSet(pgv.dosage_present, sample_midx)) {
-                  const uint32_t dosage_val = pgv.dosage_main[dosage_idx++];
-                  cur_val = kRecipDosageMid * u31tod(dosage_val);
+            uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
+            uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
+            if (!missing_ct) {
+              GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, genotype_vals);
+              if (pgv.dosage_ct) {
+                uintptr_t sample_idx_base = 0;
+                uintptr_t dosage_present_bits = pgv.dosage_present[0];
+                for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                  const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
+                  const uint32_t dosage_val = pgv.dosage_main[dosage_idx];
+                  // 32768 -> 2, 16384 -> 1, 0 -> 0
+                  genotype_vals[sample_idx] = kRecipDosageMid * u31tod(dosage_val);
                   dosage_sum += dosage_val;
                   dosage_ssq += dosage_val * dosage_val;
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
                   if (cur_geno && (cur_geno != 3)) {
                     const uintptr_t prev_val = cur_geno * kDosageMid;
                     dosage_sum -= prev_val;
                     dosage_ssq -= prev_val * prev_val;
                   }
-                } else {
-                  // cur_geno != 3 guaranteed
-                  cur_val = kSmallDoubles[cur_geno];
                 }
-                genotype_vals[sample_idx] = cur_val;
               }
-            }
-          }
-          // Check for constant genotype column.
-          // (Technically, we should recheck later in the chrX no-sex-covariate
-          // --xchr-model 1 corner case.)
-          if (!pgv.dosage_ct) {
-            if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
-              const_alleles[0] = 3;
-            }
-          } else if (pgv.dosage_ct == nm_sample_ct) {
-            if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
-              const_alleles[0] = 3;
-            }
-          }
-          machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
-          machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
-          machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
-          machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
-          if (cur_gcount_case_interleaved_vec) {
-            // gcountcc
-            STD_ARRAY_REF(uint32_t, 6) cur_geno_hardcall_cts = block_aux_iter->geno_hardcall_cts;
-            GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, R_CAST(STD_ARRAY_REF(uint32_t, 4), cur_geno_hardcall_cts));
-            for (uint32_t geno_hardcall_idx = 0; geno_hardcall_idx != 3; ++geno_hardcall_idx) {
-              cur_geno_hardcall_cts[3 + geno_hardcall_idx] = genocounts[geno_hardcall_idx] - cur_geno_hardcall_cts[geno_hardcall_idx];
-            }
-          }
-        } else {
-          // multiallelic.
-          // Update (18 Mar 2020): If some but not all alleles have constant
-          // dosages, we remove just those alleles from the regressions;
-          // trim-alts is not necessary to see what's going on with the other
-          // alleles.  To reduce parsing complexity, the number of output lines
-          // is not affected by this; the ones corresponding to the constant
-          // alleles have NA values.
-
-          // dosage_ct == 0 temporarily guaranteed if we reach here.
-          assert(!pgv.dosage_ct);
-          multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ctav]);
-          ZeroU64Arr(allele_ct, machr2_dosage_sums);
-          ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
-          // postpone multiply for now, since no multiallelic dosages
-          // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
-          // actual sums/ssqs later.
-          machr2_dosage_sums[0] = genocounts[1];
-          machr2_dosage_ssqs[0] = genocounts[0];
-          if (omitted_allele_idx) {
-            // Main genotype column starts as REF.
-            if (!missing_ct) {
-              GenoarrLookup16x8bx2(pgv.genovec, kSmallInvDoublePairs, nm_sample_ct, genotype_vals);
-            } else {
-              GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallInvDoubles, cur_sample_ct, genotype_vals);
-            }
-          }
-          uint32_t rare_allele_ct = allele_ct_m2;
-          double* alt1_start = nullptr;
-          double* rarealt_start = multi_start;
-          if (omitted_allele_idx != 1) {
-            if (omitted_allele_idx) {
-              alt1_start = multi_start;
-              ZeroDArr(nm_sample_ct_rem, &(alt1_start[nm_sample_ct]));
-              rarealt_start = &(rarealt_start[nm_sample_ctav]);
-              --rare_allele_ct;
             } else {
-              alt1_start = genotype_vals;
+              if (!pgv.dosage_ct) {
+                GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, genotype_vals);
+              } else {
+                uintptr_t sample_midx_base = 0;
+                uintptr_t sample_nm_bits = sample_nm[0];
+                uint32_t dosage_idx = 0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
+                  double cur_val;
+                  if (IsSet(pgv.dosage_present, sample_midx)) {
+                    const uint32_t dosage_val = pgv.dosage_main[dosage_idx++];
+                    cur_val = kRecipDosageMid * u31tod(dosage_val);
+                    dosage_sum += dosage_val;
+                    dosage_ssq += dosage_val * dosage_val;
+                    if (cur_geno && (cur_geno != 3)) {
+                      const uintptr_t prev_val = cur_geno * kDosageMid;
+                      dosage_sum -= prev_val;
+                      dosage_ssq -= prev_val * prev_val;
+                    }
+                  } else {
+                    // cur_geno != 3 guaranteed
+                    cur_val = kSmallDoubles[cur_geno];
+                  }
+                  genotype_vals[sample_idx] = cur_val;
+                }
+              }
             }
-            if (!missing_ct) {
-              GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, alt1_start);
-            } else {
-              GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, alt1_start);
+            // Check for constant genotype column.
+            // (Technically, we should recheck later in the chrX no-sex-covariate
+            // --xchr-model 1 corner case.)
+            if (!pgv.dosage_ct) {
+              if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
+                const_alleles[0] = 3;
+              }
+            } else if (pgv.dosage_ct == nm_sample_ct) {
+              if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
+                const_alleles[0] = 3;
+              }
             }
-          }
-          ZeroDArr(rare_allele_ct * nm_sample_ctav, rarealt_start);
-          if (pgv.patch_01_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_01_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
+            machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
+            machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
+            machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
+            machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
+            if (cur_gcount_case_interleaved_vec) {
+              // gcountcc
+              STD_ARRAY_REF(uint32_t, 6) cur_geno_hardcall_cts = block_aux_iter->geno_hardcall_cts;
+              GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, R_CAST(STD_ARRAY_REF(uint32_t, 4), cur_geno_hardcall_cts));
+              for (uint32_t geno_hardcall_idx = 0; geno_hardcall_idx != 3; ++geno_hardcall_idx) {
+                cur_geno_hardcall_cts[3 + geno_hardcall_idx] = genocounts[geno_hardcall_idx] - cur_geno_hardcall_cts[geno_hardcall_idx];
+              }
             }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                alt1_start[sample_idx] = 0.0;
-                machr2_dosage_sums[allele_code] += 1;
+          } else {
+            // multiallelic.
+            // Update (18 Mar 2020): If some but not all alleles have constant
+            // dosages, we remove just those alleles from the regressions;
+            // trim-alts is not necessary to see what's going on with the other
+            // alleles.  To reduce parsing complexity, the number of output lines
+            // is not affected by this; the ones corresponding to the constant
+            // alleles have NA values.
+
+            // dosage_ct == 0 temporarily guaranteed if we reach here.
+            assert(!pgv.dosage_ct);
+            multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ctav]);
+            ZeroU64Arr(allele_ct, machr2_dosage_sums);
+            ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
+            // postpone multiply for now, since no multiallelic dosages
+            // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
+            // actual sums/ssqs later.
+            machr2_dosage_sums[0] = genocounts[1];
+            machr2_dosage_ssqs[0] = genocounts[0];
+            if (omitted_allele_idx) {
+              // Main genotype column starts as REF.
+              if (!missing_ct) {
+                GenoarrLookup16x8bx2(pgv.genovec, kSmallInvDoublePairs, nm_sample_ct, genotype_vals);
+              } else {
+                GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallInvDoubles, cur_sample_ct, genotype_vals);
               }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                machr2_dosage_sums[allele_code] += 1;
+            }
+            uint32_t rare_allele_ct = allele_ct_m2;
+            double* alt1_start = nullptr;
+            double* rarealt_start = multi_start;
+            if (omitted_allele_idx != 1) {
+              if (omitted_allele_idx) {
+                alt1_start = multi_start;
+                ZeroDArr(nm_sample_ct_rem, &(alt1_start[nm_sample_ct]));
+                rarealt_start = &(rarealt_start[nm_sample_ctav]);
+                --rare_allele_ct;
+              } else {
+                alt1_start = genotype_vals;
               }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                alt1_start[sample_idx] = 0.0;
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                machr2_dosage_sums[allele_code] += 1;
-                if (allele_code == omitted_allele_idx) {
-                  continue;
-                }
-                const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
-                rarealt_start[cur_col * nm_sample_ctav + sample_idx] = 1.0;
+              if (!missing_ct) {
+                GenoarrLookup16x8bx2(pgv.genovec, kSmallDoublePairs, nm_sample_ct, alt1_start);
+              } else {
+                GenoarrToDoublesRemoveMissing(pgv.genovec, kSmallDoubles, cur_sample_ct, alt1_start);
               }
             }
-          }
-          uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
-          if (pgv.patch_10_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_10_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
-            }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+            ZeroDArr(rare_allele_ct * nm_sample_ctav, rarealt_start);
+            if (pgv.patch_01_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_01_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
                   alt1_start[sample_idx] = 0.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
-                  } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += 1.0;
-                    alt1_start[sample_idx] = 0.0;
-                    machr2_dosage_sums[ac0] += 1;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  alt1_start[sample_idx] = 0.0;
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  machr2_dosage_sums[allele_code] += 1;
+                  if (allele_code == omitted_allele_idx) {
+                    continue;
                   }
+                  const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
+                  rarealt_start[cur_col * nm_sample_ctav + sample_idx] = 1.0;
                 }
               }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
+            }
+            uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
+            if (pgv.patch_10_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_10_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+                    alt1_start[sample_idx] = 0.0;
+                    machr2_dosage_ssqs[ac0] += 1;
                   } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += 1.0;
-                    machr2_dosage_sums[ac0] += 1;
+                    rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += 1.0;
+                      alt1_start[sample_idx] = 0.0;
+                      machr2_dosage_sums[ac0] += 1;
+                    }
                   }
                 }
-              }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
-                const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  machr2_dosage_ssqs[ac0] += 1;
-                  alt1_start[sample_idx] = 0.0;
-                  if (ac0 != omitted_allele_idx) {
-                    const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                    rarealt_start[ac0_col * nm_sample_ctav + sample_idx] = 2.0;
-                  }
-                } else {
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac1 != omitted_allele_idx) {
-                    const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
-                    rarealt_start[ac1_col * nm_sample_ctav + sample_idx] = 1.0;
-                  }
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+                    machr2_dosage_ssqs[ac0] += 1;
                   } else {
-                    machr2_dosage_sums[ac0] += 1;
+                    rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += 1.0;
+                      machr2_dosage_sums[ac0] += 1;
+                    }
+                  }
+                }
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
+                  const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    machr2_dosage_ssqs[ac0] += 1;
                     alt1_start[sample_idx] = 0.0;
                     if (ac0 != omitted_allele_idx) {
                       const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                      rarealt_start[ac0_col * nm_sample_ctav + sample_idx] += 1.0;
+                      rarealt_start[ac0_col * nm_sample_ctav + sample_idx] = 2.0;
+                    }
+                  } else {
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac1 != omitted_allele_idx) {
+                      const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
+                      rarealt_start[ac1_col * nm_sample_ctav + sample_idx] = 1.0;
+                    }
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      machr2_dosage_sums[ac0] += 1;
+                      alt1_start[sample_idx] = 0.0;
+                      if (ac0 != omitted_allele_idx) {
+                        const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
+                        rarealt_start[ac0_col * nm_sample_ctav + sample_idx] += 1.0;
+                      }
                     }
                   }
                 }
               }
             }
-          }
-          machr2_dosage_sums[1] = alt1_het_ct;
-          machr2_dosage_ssqs[1] = genocounts[2] - pgv.patch_10_ct;
-          if (cur_gcount_case_interleaved_vec) {
-            // gcountcc.  Need case-specific one_cts and two_cts for each
-            // allele.
-            STD_ARRAY_DECL(uint32_t, 4, case_hardcall_cts);
-            GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, case_hardcall_cts);
-            ZeroU32Arr(allele_ct, case_one_cts);
-            ZeroU32Arr(allele_ct, case_two_cts);
-            uint32_t case_alt1_het_ct = case_hardcall_cts[1];
-            case_one_cts[0] = case_alt1_het_ct;
-            case_two_cts[0] = case_hardcall_cts[0];
-            if (pgv.patch_01_ct) {
-              uintptr_t sample_widx = 0;
-              uintptr_t cur_bits = pgv.patch_01_set[0];
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &cur_bits);
-                if (cur_pheno_cc[sample_widx] & lowbit) {
-                  const uint32_t allele_code = pgv.patch_01_vals[uii];
-                  case_one_cts[allele_code] += 1;
+            machr2_dosage_sums[1] = alt1_het_ct;
+            machr2_dosage_ssqs[1] = genocounts[2] - pgv.patch_10_ct;
+            if (cur_gcount_case_interleaved_vec) {
+              // gcountcc.  Need case-specific one_cts and two_cts for each
+              // allele.
+              STD_ARRAY_DECL(uint32_t, 4, case_hardcall_cts);
+              GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, case_hardcall_cts);
+              ZeroU32Arr(allele_ct, case_one_cts);
+              ZeroU32Arr(allele_ct, case_two_cts);
+              uint32_t case_alt1_het_ct = case_hardcall_cts[1];
+              case_one_cts[0] = case_alt1_het_ct;
+              case_two_cts[0] = case_hardcall_cts[0];
+              if (pgv.patch_01_ct) {
+                uintptr_t sample_widx = 0;
+                uintptr_t cur_bits = pgv.patch_01_set[0];
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &cur_bits);
+                  if (cur_pheno_cc[sample_widx] & lowbit) {
+                    const uint32_t allele_code = pgv.patch_01_vals[uii];
+                    case_one_cts[allele_code] += 1;
+                  }
+                }
+                for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
+                  case_alt1_het_ct -= case_one_cts[allele_idx];
                 }
               }
-              for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
-                case_alt1_het_ct -= case_one_cts[allele_idx];
-              }
-            }
-            uint32_t case_alt1_hom_ct = case_hardcall_cts[2];
-            if (pgv.patch_10_ct) {
-              uintptr_t sample_widx = 0;
-              uintptr_t cur_bits = pgv.patch_10_set[0];
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &cur_bits);
-                if (cur_pheno_cc[sample_widx] & lowbit) {
-                  const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
-                  const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                  --case_alt1_hom_ct;
-                  if (ac0 == ac1) {
-                    case_two_cts[ac0] += 1;
-                  } else {
-                    case_one_cts[ac1] += 1;
-                    if (ac0 == 1) {
-                      ++case_alt1_het_ct;
+              uint32_t case_alt1_hom_ct = case_hardcall_cts[2];
+              if (pgv.patch_10_ct) {
+                uintptr_t sample_widx = 0;
+                uintptr_t cur_bits = pgv.patch_10_set[0];
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &cur_bits);
+                  if (cur_pheno_cc[sample_widx] & lowbit) {
+                    const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
+                    const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
+                    --case_alt1_hom_ct;
+                    if (ac0 == ac1) {
+                      case_two_cts[ac0] += 1;
                     } else {
-                      case_one_cts[ac0] += 1;
+                      case_one_cts[ac1] += 1;
+                      if (ac0 == 1) {
+                        ++case_alt1_het_ct;
+                      } else {
+                        case_one_cts[ac0] += 1;
+                      }
                     }
                   }
                 }
               }
+              case_one_cts[1] = case_alt1_het_ct;
+              case_two_cts[1] = case_alt1_hom_ct;
+              uint32_t nonomitted_allele_idx = 0;
+              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                if (allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                const uint32_t one_ct = machr2_dosage_sums[allele_idx];
+                const uint32_t two_ct = machr2_dosage_ssqs[allele_idx];
+                const uint32_t case_one_ct = case_one_cts[allele_idx];
+                const uint32_t case_two_ct = case_two_cts[allele_idx];
+                STD_ARRAY_REF(uint32_t, 6) dst = block_aux_iter[nonomitted_allele_idx].geno_hardcall_cts;
+                dst[0] = nm_case_ct - case_one_ct - case_two_ct;
+                dst[1] = case_one_ct;
+                dst[2] = case_two_ct;
+                dst[3] = nm_sample_ct - one_ct - two_ct - dst[0];
+                dst[4] = one_ct - case_one_ct;
+                dst[5] = two_ct - case_two_ct;
+                ++nonomitted_allele_idx;
+              }
             }
-            case_one_cts[1] = case_alt1_het_ct;
-            case_two_cts[1] = case_alt1_hom_ct;
-            uint32_t nonomitted_allele_idx = 0;
             for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-              if (allele_idx == omitted_allele_idx) {
-                continue;
+              const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
+              const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
+              machr2_dosage_sums[allele_idx] = (one_ct + 2 * two_ct) * 0x4000LLU;
+              machr2_dosage_ssqs[allele_idx] = (one_ct + 4LLU * two_ct) * 0x10000000LLU;
+              if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
+                SetBit(allele_idx, const_alleles);
               }
-              const uint32_t one_ct = machr2_dosage_sums[allele_idx];
-              const uint32_t two_ct = machr2_dosage_ssqs[allele_idx];
-              const uint32_t case_one_ct = case_one_cts[allele_idx];
-              const uint32_t case_two_ct = case_two_cts[allele_idx];
-              STD_ARRAY_REF(uint32_t, 6) dst = block_aux_iter[nonomitted_allele_idx].geno_hardcall_cts;
-              dst[0] = nm_case_ct - case_one_ct - case_two_ct;
-              dst[1] = case_one_ct;
-              dst[2] = case_two_ct;
-              dst[3] = nm_sample_ct - one_ct - two_ct - dst[0];
-              dst[4] = one_ct - case_one_ct;
-              dst[5] = two_ct - case_two_ct;
-              ++nonomitted_allele_idx;
-            }
-          }
-          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-            const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
-            const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
-            machr2_dosage_sums[allele_idx] = (one_ct + 2 * two_ct) * 0x4000LLU;
-            machr2_dosage_ssqs[allele_idx] = (one_ct + 4LLU * two_ct) * 0x10000000LLU;
-            if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
-              SetBit(allele_idx, const_alleles);
-            }
-          }
-        }
-        ZeroDArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
-        // usually need to save some of {sample_obs_ct, allele_obs_ct,
-        // a1_dosage, case_allele_obs_ct, a1_case_dosage, mach_r2 even for
-        // skipped variants
-        // compute them all for now, could conditionally skip later
-        uint32_t allele_obs_ct = nm_sample_ct * 2;
-        uint32_t case_allele_obs_ct = nm_case_ct * 2;
-        if (!is_regular_x) {
-          if (is_nonx_haploid) {
-            allele_obs_ct = nm_sample_ct;
-            case_allele_obs_ct = nm_case_ct;
-            // everything is on 0..1 scale, not 0..2
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              genotype_vals[sample_idx] *= 0.5;
-            }
-            const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
-            for (uint32_t uii = 0; uii != high_ct; ++uii) {
-              multi_start[uii] *= 0.5;
             }
           }
-        } else {
-          CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
-          const uintptr_t* male_nm = tmp_nm;
-          const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
-          if (is_xchr_model_1) {
-            // special case: multiply male values by 0.5
-            uintptr_t sample_idx_base = 0;
-            uintptr_t male_nm_bits = male_nm[0];
-            for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
-              const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-              genotype_vals[sample_idx] *= 0.5;
-              // could insert multiallelic loop here isntead, but I'm guessing
-              // that's worse due to locality of writes?
+          ZeroDArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
+          // usually need to save some of {sample_obs_ct, allele_obs_ct,
+          // a1_dosage, case_allele_obs_ct, a1_case_dosage, mach_r2 even for
+          // skipped variants
+          // compute them all for now, could conditionally skip later
+          uint32_t allele_obs_ct = nm_sample_ct * 2;
+          uint32_t case_allele_obs_ct = nm_case_ct * 2;
+          if (!is_regular_x) {
+            if (is_nonx_haploid) {
+              allele_obs_ct = nm_sample_ct;
+              case_allele_obs_ct = nm_case_ct;
+              // everything is on 0..1 scale, not 0..2
+              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                genotype_vals[sample_idx] *= 0.5;
+              }
+              const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
+              for (uint32_t uii = 0; uii != high_ct; ++uii) {
+                multi_start[uii] *= 0.5;
+              }
             }
-            for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-              double* cur_start = &(multi_start[extra_allele_idx * nm_sample_ctav]);
-              sample_idx_base = 0;
-              male_nm_bits = male_nm[0];
+          } else {
+            CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
+            const uintptr_t* male_nm = tmp_nm;
+            const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
+            if (is_xchr_model_1) {
+              // special case: multiply male values by 0.5
+              uintptr_t sample_idx_base = 0;
+              uintptr_t male_nm_bits = male_nm[0];
               for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
                 const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-                cur_start[sample_idx] *= 0.5;
+                genotype_vals[sample_idx] *= 0.5;
+                // could insert multiallelic loop here isntead, but I'm guessing
+                // that's worse due to locality of writes?
               }
+              for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                double* cur_start = &(multi_start[extra_allele_idx * nm_sample_ctav]);
+                sample_idx_base = 0;
+                male_nm_bits = male_nm[0];
+                for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
+                  const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
+                  cur_start[sample_idx] *= 0.5;
+                }
+              }
+              allele_obs_ct -= nm_male_ct;
+              case_allele_obs_ct -= PopcountWordsIntersect(pheno_cc_nm, male_nm, nm_sample_ctl);
             }
-            allele_obs_ct -= nm_male_ct;
-            case_allele_obs_ct -= PopcountWordsIntersect(pheno_cc_nm, male_nm, nm_sample_ctl);
-          }
-        }
-        const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
-        uint32_t nonomitted_allele_idx = 0;
-        for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-          if (allele_idx == omitted_allele_idx) {
-            continue;
           }
-
-          double* geno_col = genotype_vals;
-          if (allele_idx > (!omitted_allele_idx)) {
-            geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ctav]);
-          }
-          double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
-          if (is_xchr_model_1) {
-            // ugh.
-            a1_dosage = 0.0;
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              a1_dosage += geno_col[sample_idx];
+          const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
+          uint32_t nonomitted_allele_idx = 0;
+          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+            if (allele_idx == omitted_allele_idx) {
+              continue;
             }
-          } else {
-            if (is_nonx_haploid) {
-              a1_dosage *= 0.5;
+
+            double* geno_col = genotype_vals;
+            if (allele_idx > (!omitted_allele_idx)) {
+              geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ctav]);
             }
-          }
-          a1_dosages[allele_idx] = a1_dosage;
-
-          // todo: shortcut if gcountcc computed and no dosages
-          double a1_case_dosage = 0.0;
-          uintptr_t sample_idx_base = 0;
-          uintptr_t pheno_cc_nm_bits = pheno_cc_nm[0];
-          for (uint32_t uii = 0; uii != nm_case_ct; ++uii) {
-            const uintptr_t sample_idx = BitIter1(pheno_cc_nm, &sample_idx_base, &pheno_cc_nm_bits);
-            a1_case_dosage += geno_col[sample_idx];
-          }
-          a1_case_dosages[allele_idx] = a1_case_dosage;
-          block_aux_iter[nonomitted_allele_idx].sample_obs_ct = nm_sample_ct;
-          block_aux_iter[nonomitted_allele_idx].allele_obs_ct = allele_obs_ct;
-          if (!allele_ct_m2) {
-            // Need main_dosage_sum and main_dosage_ssq for now (probably move
-            // this computation in-place later).
+            double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
             if (is_xchr_model_1) {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = 0.0;
+              // ugh.
+              a1_dosage = 0.0;
               for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const double cur_dosage = geno_col[sample_idx];
-                main_dosage_ssq += cur_dosage * cur_dosage;
+                a1_dosage += geno_col[sample_idx];
               }
             } else {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
               if (is_nonx_haploid) {
-                main_dosage_ssq *= 0.25;
+                a1_dosage *= 0.5;
               }
             }
-          }
-          block_aux_iter[nonomitted_allele_idx].a1_dosage = a1_dosage;
+            a1_dosages[allele_idx] = a1_dosage;
 
-          // bugfix (4 Sep 2018): forgot to save this
-          block_aux_iter[nonomitted_allele_idx].case_allele_obs_ct = case_allele_obs_ct;
-
-          block_aux_iter[nonomitted_allele_idx].a1_case_dosage = a1_case_dosage;
-          block_aux_iter[nonomitted_allele_idx].firth_fallback = 0;
-          block_aux_iter[nonomitted_allele_idx].is_unfinished = 0;
-          block_aux_iter[nonomitted_allele_idx].mach_r2 = mach_r2;
-          ++nonomitted_allele_idx;
-        }
-        // Now free to skip the actual regression if there are too few samples,
-        // or omitted allele corresponds to a zero-variance genotype column.
-        // If another allele has zero variance but the omitted allele does not,
-        // we now salvage as many alleles as we can.
-        GlmErr glm_err = 0;
-        if (nm_sample_ct <= expected_predictor_ct) {
-          // reasonable for this to override CONST_ALLELE
-          glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
-        } else if (IsSet(const_alleles, omitted_allele_idx)) {
-          glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
-        }
-        if (glm_err) {
-          if (missing_ct) {
-            // covariates have not been copied yet, so we can't usually change
-            // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
-            // reason to optimize the zero-covariate case)
-            prev_nm = 0;
-          }
-          uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-          if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
-            reported_ct += allele_ct_m2;
-          }
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-              memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-              beta_se_iter[uii * 2 + 1] = -9.0;
+            // todo: shortcut if gcountcc computed and no dosages
+            double a1_case_dosage = 0.0;
+            uintptr_t sample_idx_base = 0;
+            uintptr_t pheno_cc_nm_bits = pheno_cc_nm[0];
+            for (uint32_t uii = 0; uii != nm_case_ct; ++uii) {
+              const uintptr_t sample_idx = BitIter1(pheno_cc_nm, &sample_idx_base, &pheno_cc_nm_bits);
+              a1_case_dosage += geno_col[sample_idx];
             }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
-          }
-        } else {
-          {
-            double omitted_dosage = u63tod(allele_obs_ct);
-            double omitted_case_dosage = u63tod(case_allele_obs_ct);
-            for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-              if (allele_idx == omitted_allele_idx) {
-                continue;
+            a1_case_dosages[allele_idx] = a1_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].sample_obs_ct = nm_sample_ct;
+            block_aux_iter[nonomitted_allele_idx].allele_obs_ct = allele_obs_ct;
+            if (!allele_ct_m2) {
+              // Need main_dosage_sum and main_dosage_ssq for now (probably move
+              // this computation in-place later).
+              if (is_xchr_model_1) {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = 0.0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const double cur_dosage = geno_col[sample_idx];
+                  main_dosage_ssq += cur_dosage * cur_dosage;
+                }
+              } else {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
+                if (is_nonx_haploid) {
+                  main_dosage_ssq *= 0.25;
+                }
               }
-              omitted_dosage -= a1_dosages[allele_idx];
-              omitted_case_dosage -= a1_case_dosages[allele_idx];
             }
-            a1_dosages[omitted_allele_idx] = omitted_dosage;
-            a1_case_dosages[omitted_allele_idx] = omitted_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].a1_dosage = a1_dosage;
+
+            // bugfix (4 Sep 2018): forgot to save this
+            block_aux_iter[nonomitted_allele_idx].case_allele_obs_ct = case_allele_obs_ct;
+
+            block_aux_iter[nonomitted_allele_idx].a1_case_dosage = a1_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].firth_fallback = 0;
+            block_aux_iter[nonomitted_allele_idx].is_unfinished = 0;
+            block_aux_iter[nonomitted_allele_idx].mach_r2 = mach_r2;
+            ++nonomitted_allele_idx;
           }
-          uint32_t parameter_uidx = 2 + domdev_present;
-          double* nm_predictors_pmaj_istart = nullptr;
-          // only need to do this part once per variant in multiallelic case
-          double* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ctav * (parameter_uidx - main_omitted)]);
-          if (missing_ct || (!prev_nm)) {
-            // fill phenotype
-            uintptr_t sample_midx_base = 0;
-            uintptr_t sample_nm_bits = sample_nm[0];
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-              nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
+          // Now free to skip the actual regression if there are too few samples,
+          // or omitted allele corresponds to a zero-variance genotype column.
+          // If another allele has zero variance but the omitted allele does not,
+          // we now salvage as many alleles as we can.
+          GlmErr glm_err = 0;
+          if (nm_sample_ct <= expected_predictor_ct) {
+            // reasonable for this to override CONST_ALLELE
+            glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
+          } else if (IsSet(const_alleles, omitted_allele_idx)) {
+            glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
+          }
+          if (glm_err) {
+            if (missing_ct) {
+              // covariates have not been copied yet, so we can't usually change
+              // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
+              // reason to optimize the zero-covariate case)
+              prev_nm = 0;
             }
-            // bugfix (13 Oct 2017): must guarantee trailing phenotype values
-            // are valid (exact contents don't matter since they are multiplied
-            // by zero, but they can't be nan)
-            ZeroDArr(nm_sample_ct_rem, &(nm_pheno_buf[nm_sample_ct]));
-
-            // fill covariates
-            for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
-              // unlike the float case, cur_covars_cmaj is NOT vector-aligned
-              if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
-                continue;
+            uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+            if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
+              reported_ct += allele_ct_m2;
+            }
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                beta_se_iter[uii * 2 + 1] = -9.0;
               }
-              const double* cur_covar_col;
-              if (covar_idx < local_covar_ct) {
-                cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-              } else {
-                cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * cur_sample_ct]);
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+            }
+          } else {
+            {
+              double omitted_dosage = u63tod(allele_obs_ct);
+              double omitted_case_dosage = u63tod(case_allele_obs_ct);
+              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                if (allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                omitted_dosage -= a1_dosages[allele_idx];
+                omitted_case_dosage -= a1_case_dosages[allele_idx];
               }
-              sample_midx_base = 0;
-              sample_nm_bits = sample_nm[0];
+              a1_dosages[omitted_allele_idx] = omitted_dosage;
+              a1_case_dosages[omitted_allele_idx] = omitted_case_dosage;
+            }
+            uint32_t parameter_uidx = 2 + domdev_present;
+            double* nm_predictors_pmaj_istart = nullptr;
+            // only need to do this part once per variant in multiallelic case
+            double* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ctav * (parameter_uidx - main_omitted)]);
+            if (missing_ct || (!prev_nm)) {
+              // fill phenotype
+              uintptr_t sample_midx_base = 0;
+              uintptr_t sample_nm_bits = sample_nm[0];
               for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                 const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
+                nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
               }
-              ZeromovDArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
-            }
-            nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
-            // bugfix (13 Apr 2021): if local covariates are present, we can't
-            // optimize as aggressively
-            prev_nm = !(missing_ct || local_covar_ct);
-          } else {
-            // bugfix (15 Aug 2018): this was not handling --parameters
-            // correctly when a covariate was only needed as part of an
-            // interaction
-            parameter_uidx += cur_covar_ct;
-            nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ctav]);
-          }
-          const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
-          if (const_allele_ct) {
-            // Must delete constant-allele columns from nm_predictors_pmaj, and
-            // shift later columns back.
-            double* read_iter = genotype_vals;
-            double* write_iter = genotype_vals;
-            for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
-              if (read_allele_idx == omitted_allele_idx) {
-                continue;
-              }
-              if (!IsSet(const_alleles, read_allele_idx)) {
-                if (write_iter != read_iter) {
-                  memcpy(write_iter, read_iter, nm_sample_ctav * sizeof(double));
+              // bugfix (13 Oct 2017): must guarantee trailing phenotype values
+              // are valid (exact contents don't matter since they are multiplied
+              // by zero, but they can't be nan)
+              ZeroDArr(nm_sample_ct_rem, &(nm_pheno_buf[nm_sample_ct]));
+
+              // fill covariates
+              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
+                // unlike the float case, cur_covars_cmaj is NOT vector-aligned
+                if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
+                  continue;
                 }
-                if (write_iter == genotype_vals) {
-                  write_iter = multi_start;
+                const double* cur_covar_col;
+                if (covar_idx < local_covar_ct) {
+                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
                 } else {
-                  write_iter = &(write_iter[nm_sample_ctav]);
+                  cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * cur_sample_ct]);
                 }
-              }
-              if (read_iter == genotype_vals) {
-                read_iter = multi_start;
-              } else {
-                read_iter = &(read_iter[nm_sample_ctav]);
-              }
-            }
-          }
-          const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
-          const uint32_t cur_predictor_ctav = RoundUpPow2(cur_predictor_ct, kDoublePerDVec);
-          const uint32_t cur_predictor_ctavp1 = cur_predictor_ctav + 1;
-          uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            double* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
-            double* domdev_vals = nullptr;
-            uint32_t is_unfinished = 0;
-            uint32_t is_residualized = 0;
-            // _stop instead of _ct since, in the residualized case, the
-            // intercept (predictor index 0) is not included; we iterate over
-            // the predictor indices in [1, _stop).
-            uint32_t cur_regressed_predictor_stop = cur_predictor_ct;
-            uint32_t cur_regressed_predictor_ctav = cur_predictor_ctav;
-            uint32_t cur_regressed_predictor_ctavp1 = cur_predictor_ctavp1;
-            uint32_t cur_biallelic_regressed_predictor_stop = cur_biallelic_predictor_ct;
-            if (extra_regression_ct) {
-              if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
-                glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
-                goto GlmLogisticThreadD_skip_regression;
-              }
-              ++nonconst_extra_regression_idx;
-              if (nonconst_extra_regression_idx) {
-                double* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ctav]);
-                for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
-                  double dxx = genotype_vals[uii];
-                  genotype_vals[uii] = swap_target[uii];
-                  swap_target[uii] = dxx;
+                sample_midx_base = 0;
+                sample_nm_bits = sample_nm[0];
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
                 }
+                ZeromovDArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
               }
+              nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
+              // bugfix (13 Apr 2021): if local covariates are present, we can't
+              // optimize as aggressively
+              prev_nm = !(missing_ct || local_covar_ct);
+            } else {
+              // bugfix (15 Aug 2018): this was not handling --parameters
+              // correctly when a covariate was only needed as part of an
+              // interaction
+              parameter_uidx += cur_covar_ct;
+              nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ctav]);
             }
-            if (main_omitted) {
-              // if main_mutated, this will be filled below
-              // if not, this aliases genotype_vals
-              main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ctav]);
-            } else if (joint_genotypic || joint_hethom) {
-              // in hethom case, do this before clobbering genotype data
-              domdev_vals = &(main_vals[nm_sample_ctav]);
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                double cur_genotype_val = genotype_vals[sample_idx];
-                if (cur_genotype_val > 1.0) {
-                  cur_genotype_val = 2.0 - cur_genotype_val;
+            const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
+            if (const_allele_ct) {
+              // Must delete constant-allele columns from nm_predictors_pmaj, and
+              // shift later columns back.
+              double* read_iter = genotype_vals;
+              double* write_iter = genotype_vals;
+              for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
+                if (read_allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                if (!IsSet(const_alleles, read_allele_idx)) {
+                  if (write_iter != read_iter) {
+                    memcpy(write_iter, read_iter, nm_sample_ctav * sizeof(double));
+                  }
+                  if (write_iter == genotype_vals) {
+                    write_iter = multi_start;
+                  } else {
+                    write_iter = &(write_iter[nm_sample_ctav]);
+                  }
+                }
+                if (read_iter == genotype_vals) {
+                  read_iter = multi_start;
+                } else {
+                  read_iter = &(read_iter[nm_sample_ctav]);
                 }
-                domdev_vals[sample_idx] = cur_genotype_val;
               }
-              ZeroDArr(nm_sample_ct_rem, &(domdev_vals[nm_sample_ct]));
             }
-            if (model_dominant) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                double cur_genotype_val = genotype_vals[sample_idx];
-                // 0..1..1
-                if (cur_genotype_val > 1.0) {
-                  cur_genotype_val = 1.0;
+            const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
+            const uint32_t cur_predictor_ctav = RoundUpPow2(cur_predictor_ct, kDoublePerDVec);
+            const uint32_t cur_predictor_ctavp1 = cur_predictor_ctav + 1;
+            uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              double* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
+              double* domdev_vals = nullptr;
+              uint32_t is_unfinished = 0;
+              uint32_t is_residualized = 0;
+              // _stop instead of _ct since, in the residualized case, the
+              // intercept (predictor index 0) is not included; we iterate over
+              // the predictor indices in [1, _stop).
+              uint32_t cur_regressed_predictor_stop = cur_predictor_ct;
+              uint32_t cur_regressed_predictor_ctav = cur_predictor_ctav;
+              uint32_t cur_regressed_predictor_ctavp1 = cur_predictor_ctavp1;
+              uint32_t cur_biallelic_regressed_predictor_stop = cur_biallelic_predictor_ct;
+              if (extra_regression_ct) {
+                if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
+                  glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
+                  goto GlmLogisticThreadD_skip_regression;
                 }
-                main_vals[sample_idx] = cur_genotype_val;
-              }
-            } else if (model_recessive || joint_hethom) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                double cur_genotype_val = genotype_vals[sample_idx];
-                // 0..0..1
-                if (cur_genotype_val < 1.0) {
-                  cur_genotype_val = 0.0;
-                } else {
-                  cur_genotype_val -= 1.0;
+                ++nonconst_extra_regression_idx;
+                if (nonconst_extra_regression_idx) {
+                  double* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ctav]);
+                  for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
+                    double dxx = genotype_vals[uii];
+                    genotype_vals[uii] = swap_target[uii];
+                    swap_target[uii] = dxx;
+                  }
                 }
-                main_vals[sample_idx] = cur_genotype_val;
               }
-            } else if (model_hetonly) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                double cur_genotype_val = genotype_vals[sample_idx];
-                // 0..1..0
-                if (cur_genotype_val > 1.0) {
-                  cur_genotype_val = 2.0 - cur_genotype_val;
+              if (main_omitted) {
+                // if main_mutated, this will be filled below
+                // if not, this aliases genotype_vals
+                main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ctav]);
+              } else if (joint_genotypic || joint_hethom) {
+                // in hethom case, do this before clobbering genotype data
+                domdev_vals = &(main_vals[nm_sample_ctav]);
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  double cur_genotype_val = genotype_vals[sample_idx];
+                  if (cur_genotype_val > 1.0) {
+                    cur_genotype_val = 2.0 - cur_genotype_val;
+                  }
+                  domdev_vals[sample_idx] = cur_genotype_val;
                 }
-                main_vals[sample_idx] = cur_genotype_val;
+                ZeroDArr(nm_sample_ct_rem, &(domdev_vals[nm_sample_ct]));
               }
-            }
-
-            // fill interaction terms
-            if (add_interactions) {
-              nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
-              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
-                const double* cur_covar_col;
-                if (covar_idx < local_covar_ct) {
-                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-                } else {
-                  cur_covar_col = &(cur_covars_cmaj[covar_idx * cur_sample_ct]);
+              if (model_dominant) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  double cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..1..1
+                  if (cur_genotype_val > 1.0) {
+                    cur_genotype_val = 1.0;
+                  }
+                  main_vals[sample_idx] = cur_genotype_val;
                 }
-                if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
-                  uintptr_t sample_midx_base = 0;
-                  uintptr_t sample_nm_bits = sample_nm[0];
-                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                    const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                    *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
+              } else if (model_recessive || joint_hethom) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  double cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..0..1
+                  if (cur_genotype_val < 1.0) {
+                    cur_genotype_val = 0.0;
+                  } else {
+                    cur_genotype_val -= 1.0;
                   }
-                  ZeromovDArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+                  main_vals[sample_idx] = cur_genotype_val;
                 }
-                ++parameter_uidx;
-                if (domdev_present) {
+              } else if (model_hetonly) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  double cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..1..0
+                  if (cur_genotype_val > 1.0) {
+                    cur_genotype_val = 2.0 - cur_genotype_val;
+                  }
+                  main_vals[sample_idx] = cur_genotype_val;
+                }
+              }
+
+              // fill interaction terms
+              if (add_interactions) {
+                nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
+                for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
+                  const double* cur_covar_col;
+                  if (covar_idx < local_covar_ct) {
+                    cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
+                  } else {
+                    cur_covar_col = &(cur_covars_cmaj[covar_idx * cur_sample_ct]);
+                  }
                   if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
                     uintptr_t sample_midx_base = 0;
                     uintptr_t sample_nm_bits = sample_nm[0];
                     for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                       const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                      *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                      *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
                     }
                     ZeromovDArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
                   }
                   ++parameter_uidx;
+                  if (domdev_present) {
+                    if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
+                      uintptr_t sample_midx_base = 0;
+                      uintptr_t sample_nm_bits = sample_nm[0];
+                      for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                        const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                        *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                      }
+                      ZeromovDArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+                    }
+                    ++parameter_uidx;
+                  }
                 }
               }
-            }
-            if (corr_inv && prev_nm && (!allele_ct_m2)) {
-              uintptr_t start_pred_idx = 0;
-              if (!(model_dominant || model_recessive || model_hetonly || joint_hethom)) {
-                start_pred_idx = domdev_present + 2;
-                semicomputed_biallelic_xtx[cur_predictor_ct] = main_dosage_sum;
-                semicomputed_biallelic_xtx[cur_predictor_ct + 1] = main_dosage_ssq;
-              }
-              if (cur_predictor_ct > start_pred_idx) {
-                ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ctav]), nm_sample_ct, nm_sample_ctav, cur_predictor_ct - start_pred_idx, &(predictor_dotprod_buf[start_pred_idx]));
-                for (uint32_t uii = start_pred_idx; uii != cur_predictor_ct; ++uii) {
-                  semicomputed_biallelic_xtx[cur_predictor_ct + uii] = predictor_dotprod_buf[uii];
-                }
-              }
-              if (domdev_present) {
-                ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ctav]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ctav, cur_predictor_ct, predictor_dotprod_buf);
-                for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
-                  semicomputed_biallelic_xtx[2 * cur_predictor_ct + uii] = predictor_dotprod_buf[uii];
-                }
-                semicomputed_biallelic_xtx[cur_predictor_ct + 2] = semicomputed_biallelic_xtx[2 * cur_predictor_ct + 1];
-              }
-              glm_err = CheckMaxCorrAndVifNm(semicomputed_biallelic_xtx, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
-              if (glm_err) {
-                goto GlmLogisticThreadD_skip_regression;
-              }
-            } else {
-              MultiplySelfTransposeStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), cur_predictor_ct - 1, nm_sample_ct, nm_sample_ctav, predictor_dotprod_buf);
-              for (uintptr_t pred_idx = 1; pred_idx != cur_predictor_ct; ++pred_idx) {
-                const double* predictor_row = &(nm_predictors_pmaj_buf[pred_idx * nm_sample_ctav]);
-                double row_sum = 0.0;
-                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                  row_sum += predictor_row[sample_idx];
-                }
-                dbl_2d_buf[pred_idx - 1] = row_sum;
-              }
-              glm_err = CheckMaxCorrAndVif(predictor_dotprod_buf, 0, cur_predictor_ct - 1, nm_sample_ct, max_corr, vif_thresh, dbl_2d_buf, nullptr, inverse_corr_buf, inv_1d_buf);
-              if (glm_err) {
-                goto GlmLogisticThreadD_skip_regression;
-              }
-            }
-            ZeroDArr(cur_predictor_ctav, coef_return);
-            if (!cur_is_always_firth) {
-              // Does any genotype column have zero case or zero control
-              // dosage?  If yes, faster to skip logistic regression than
-              // wait for convergence failure.
-              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                if (IsSet(const_alleles, allele_idx)) {
-                  continue;
+              if (corr_inv && prev_nm && (!allele_ct_m2)) {
+                uintptr_t start_pred_idx = 0;
+                if (!(model_dominant || model_recessive || model_hetonly || joint_hethom)) {
+                  start_pred_idx = domdev_present + 2;
+                  semicomputed_biallelic_xtx[cur_predictor_ct] = main_dosage_sum;
+                  semicomputed_biallelic_xtx[cur_predictor_ct + 1] = main_dosage_ssq;
                 }
-                const double tot_dosage = a1_dosages[allele_idx];
-                const double case_dosage = a1_case_dosages[allele_idx];
-                if ((case_dosage == 0.0) || (case_dosage == tot_dosage)) {
-                  if (is_sometimes_firth) {
-                    goto GlmLogisticThreadD_firth_fallback;
+                if (cur_predictor_ct > start_pred_idx) {
+                  ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ctav]), nm_sample_ct, nm_sample_ctav, cur_predictor_ct - start_pred_idx, &(predictor_dotprod_buf[start_pred_idx]));
+                  for (uint32_t uii = start_pred_idx; uii != cur_predictor_ct; ++uii) {
+                    semicomputed_biallelic_xtx[cur_predictor_ct + uii] = predictor_dotprod_buf[uii];
                   }
-                  glm_err = SetGlmErr1(kGlmErrcodeSeparation, allele_idx);
-                  goto GlmLogisticThreadD_skip_regression;
                 }
-              }
-              if (!cur_cc_residualize) {
-                if (LogisticRegressionD(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, &is_unfinished, coef_return, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, inv_1d_buf, dbl_2d_buf)) {
-                  if (is_sometimes_firth) {
-                    ZeroDArr(cur_predictor_ctav, coef_return);
-                    goto GlmLogisticThreadD_firth_fallback;
+                if (domdev_present) {
+                  ColMajorVectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ctav]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ctav, cur_predictor_ct, predictor_dotprod_buf);
+                  for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
+                    semicomputed_biallelic_xtx[2 * cur_predictor_ct + uii] = predictor_dotprod_buf[uii];
                   }
-                  glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                  semicomputed_biallelic_xtx[cur_predictor_ct + 2] = semicomputed_biallelic_xtx[2 * cur_predictor_ct + 1];
+                }
+                glm_err = CheckMaxCorrAndVifNm(semicomputed_biallelic_xtx, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
+                if (glm_err) {
                   goto GlmLogisticThreadD_skip_regression;
                 }
               } else {
-                if (LogisticRegressionResidualizedD(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, &is_unfinished, coef_return, cholesky_decomp_return, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
-                  if (is_sometimes_firth) {
-                    ZeroDArr(cur_predictor_ctav, coef_return);
-                    goto GlmLogisticThreadD_firth_fallback;
+                MultiplySelfTransposeStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), cur_predictor_ct - 1, nm_sample_ct, nm_sample_ctav, predictor_dotprod_buf);
+                for (uintptr_t pred_idx = 1; pred_idx != cur_predictor_ct; ++pred_idx) {
+                  const double* predictor_row = &(nm_predictors_pmaj_buf[pred_idx * nm_sample_ctav]);
+                  double row_sum = 0.0;
+                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                    row_sum += predictor_row[sample_idx];
                   }
-                  glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                  dbl_2d_buf[pred_idx - 1] = row_sum;
+                }
+                glm_err = CheckMaxCorrAndVif(predictor_dotprod_buf, 0, cur_predictor_ct - 1, nm_sample_ct, max_corr, vif_thresh, dbl_2d_buf, nullptr, inverse_corr_buf, inv_1d_buf);
+                if (glm_err) {
                   goto GlmLogisticThreadD_skip_regression;
                 }
-                is_residualized = 1;
-                cur_regressed_predictor_stop = domdev_present + allele_ct;
-                cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kDoublePerDVec);
-                cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
-                cur_biallelic_regressed_predictor_stop = domdev_present + 2;
               }
-              // unlike FirthRegressionD(), hh_return isn't inverted yet, do
-              // that here
-              for (uint32_t pred_uidx = is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-                double* hh_inv_row = &(hh_return[pred_uidx * cur_regressed_predictor_ctav]);
-                // ZeroDArr(cur_regressed_predictor_stop, gradient_buf);
-                // gradient_buf[pred_uidx] = 1.0;
-                // (y is gradient_buf, x is dcoef_buf)
-                // SolveLinearSystemD(cholesky_decomp_return, &(gradient_buf[is_residualized]), cur_regressed_predictor_stop - is_residualized, &(hh_inv_row[is_residualized]));
-                // that works, but doesn't exploit the sparsity of y
-
-                // hh_return does now have vector-aligned rows
-                ZeroDArr(pred_uidx, hh_inv_row);
-
-                double dxx = 1.0;
-                for (uint32_t row_idx = pred_uidx; row_idx != cur_regressed_predictor_stop; ++row_idx) {
-                  const double* ll_row = &(cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav]);
-                  for (uint32_t col_idx = pred_uidx; col_idx != row_idx; ++col_idx) {
-                    dxx -= ll_row[col_idx] * hh_inv_row[col_idx];
+              ZeroDArr(cur_predictor_ctav, coef_return);
+              if (!cur_is_always_firth) {
+                // Does any genotype column have zero case or zero control
+                // dosage?  If yes, faster to skip logistic regression than
+                // wait for convergence failure.
+                for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                  if (IsSet(const_alleles, allele_idx)) {
+                    continue;
                   }
-                  hh_inv_row[row_idx] = dxx / ll_row[row_idx];
-                  dxx = 0.0;
-                }
-                for (uint32_t col_idx = cur_regressed_predictor_stop; col_idx > is_residualized; ) {
-                  dxx = hh_inv_row[--col_idx];
-                  double* hh_inv_row_iter = &(hh_inv_row[cur_regressed_predictor_stop - 1]);
-                  for (uint32_t row_idx = cur_regressed_predictor_stop - 1; row_idx > col_idx; --row_idx) {
-                    dxx -= cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav + col_idx] * (*hh_inv_row_iter--);
+                  const double tot_dosage = a1_dosages[allele_idx];
+                  const double case_dosage = a1_case_dosages[allele_idx];
+                  if ((case_dosage == 0.0) || (case_dosage == tot_dosage)) {
+                    if (is_sometimes_firth) {
+                      goto GlmLogisticThreadD_firth_fallback;
+                    }
+                    glm_err = SetGlmErr1(kGlmErrcodeSeparation, allele_idx);
+                    goto GlmLogisticThreadD_skip_regression;
                   }
-                  *hh_inv_row_iter = dxx / cholesky_decomp_return[col_idx * cur_regressed_predictor_ctavp1];
                 }
-              }
-            } else {
-              if (!is_always_firth) {
-              GlmLogisticThreadD_firth_fallback:
-                block_aux_iter[extra_regression_idx].firth_fallback = 1;
-                if (allele_ct_m2 && beta_se_multiallelic_fused) {
-                  for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
-                    block_aux_iter[uii].firth_fallback = 1;
+                if (!cur_cc_residualize) {
+                  if (LogisticRegressionD(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, &is_unfinished, coef_return, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, inv_1d_buf, dbl_2d_buf)) {
+                    if (is_sometimes_firth) {
+                      ZeroDArr(cur_predictor_ctav, coef_return);
+                      goto GlmLogisticThreadD_firth_fallback;
+                    }
+                    glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                    goto GlmLogisticThreadD_skip_regression;
                   }
+                } else {
+                  if (LogisticRegressionResidualizedD(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, &is_unfinished, coef_return, cholesky_decomp_return, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
+                    if (is_sometimes_firth) {
+                      ZeroDArr(cur_predictor_ctav, coef_return);
+                      goto GlmLogisticThreadD_firth_fallback;
+                    }
+                    glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                    goto GlmLogisticThreadD_skip_regression;
+                  }
+                  is_residualized = 1;
+                  cur_regressed_predictor_stop = domdev_present + allele_ct;
+                  cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kDoublePerDVec);
+                  cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
+                  cur_biallelic_regressed_predictor_stop = domdev_present + 2;
                 }
-              }
-              if (!cur_cc_residualize) {
-                if (FirthRegressionD(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
-                  goto GlmLogisticThreadD_skip_regression;
+                // unlike FirthRegressionD(), hh_return isn't inverted yet, do
+                // that here
+                for (uint32_t pred_uidx = is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                  double* hh_inv_row = &(hh_return[pred_uidx * cur_regressed_predictor_ctav]);
+                  // ZeroDArr(cur_regressed_predictor_stop, gradient_buf);
+                  // gradient_buf[pred_uidx] = 1.0;
+                  // (y is gradient_buf, x is dcoef_buf)
+                  // SolveLinearSystemD(cholesky_decomp_return, &(gradient_buf[is_residualized]), cur_regressed_predictor_stop - is_residualized, &(hh_inv_row[is_residualized]));
+                  // that works, but doesn't exploit the sparsity of y
+
+                  // hh_return does now have vector-aligned rows
+                  ZeroDArr(pred_uidx, hh_inv_row);
+
+                  double dxx = 1.0;
+                  for (uint32_t row_idx = pred_uidx; row_idx != cur_regressed_predictor_stop; ++row_idx) {
+                    const double* ll_row = &(cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav]);
+                    for (uint32_t col_idx = pred_uidx; col_idx != row_idx; ++col_idx) {
+                      dxx -= ll_row[col_idx] * hh_inv_row[col_idx];
+                    }
+                    hh_inv_row[row_idx] = dxx / ll_row[row_idx];
+                    dxx = 0.0;
+                  }
+                  for (uint32_t col_idx = cur_regressed_predictor_stop; col_idx > is_residualized; ) {
+                    dxx = hh_inv_row[--col_idx];
+                    double* hh_inv_row_iter = &(hh_inv_row[cur_regressed_predictor_stop - 1]);
+                    for (uint32_t row_idx = cur_regressed_predictor_stop - 1; row_idx > col_idx; --row_idx) {
+                      dxx -= cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav + col_idx] * (*hh_inv_row_iter--);
+                    }
+                    *hh_inv_row_iter = dxx / cholesky_decomp_return[col_idx * cur_regressed_predictor_ctavp1];
+                  }
                 }
               } else {
-                if (FirthRegressionResidualizedD(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
-                  goto GlmLogisticThreadD_skip_regression;
+                if (!is_always_firth) {
+                GlmLogisticThreadD_firth_fallback:
+                  block_aux_iter[extra_regression_idx].firth_fallback = 1;
+                  if (allele_ct_m2 && beta_se_multiallelic_fused) {
+                    for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
+                      block_aux_iter[uii].firth_fallback = 1;
+                    }
+                  }
+                }
+                if (!cur_cc_residualize) {
+                  if (FirthRegressionD(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
+                    goto GlmLogisticThreadD_skip_regression;
+                  }
+                } else {
+                  if (FirthRegressionResidualizedD(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, hdiag_buf, score_buf, hh0_buf, tmpnxk_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
+                    goto GlmLogisticThreadD_skip_regression;
+                  }
+                  is_residualized = 1;
+                  cur_regressed_predictor_stop = domdev_present + allele_ct;
+                  cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kDoublePerDVec);
+                  cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
+                  cur_biallelic_regressed_predictor_stop = domdev_present + 2;
                 }
-                is_residualized = 1;
-                cur_regressed_predictor_stop = domdev_present + allele_ct;
-                cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kDoublePerDVec);
-                cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
-                cur_biallelic_regressed_predictor_stop = domdev_present + 2;
-              }
-            }
-            // validParameters() check
-            for (uint32_t pred_uidx = 1; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-              const double hh_inv_diag_element = hh_return[pred_uidx * cur_regressed_predictor_ctavp1];
-              if ((hh_inv_diag_element < 1e-20) || (!isfinite_d(hh_inv_diag_element))) {
-                glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
-                goto GlmLogisticThreadD_skip_regression;
               }
-              // use sample_variance_buf[] to store diagonal square roots
-              sample_variance_buf[pred_uidx] = sqrt(hh_inv_diag_element);
-            }
-            if (!is_residualized) {
-              sample_variance_buf[0] = sqrt(hh_return[0]);
-            }
-            for (uint32_t pred_uidx = 1 + is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-              const double cur_hh_inv_diag_sqrt = 0.99999 * sample_variance_buf[pred_uidx];
-              const double* hh_inv_row_iter = &(hh_return[pred_uidx * cur_regressed_predictor_ctav + is_residualized]);
-              const double* hh_inv_diag_sqrts_iter = &(sample_variance_buf[is_residualized]);
-              for (uint32_t pred_uidx2 = is_residualized; pred_uidx2 != pred_uidx; ++pred_uidx2) {
-                if ((*hh_inv_row_iter++) > cur_hh_inv_diag_sqrt * (*hh_inv_diag_sqrts_iter++)) {
+              // validParameters() check
+              for (uint32_t pred_uidx = 1; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                const double hh_inv_diag_element = hh_return[pred_uidx * cur_regressed_predictor_ctavp1];
+                if ((hh_inv_diag_element < 1e-20) || (!isfinite_d(hh_inv_diag_element))) {
                   glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
                   goto GlmLogisticThreadD_skip_regression;
                 }
+                // use sample_variance_buf[] to store diagonal square roots
+                sample_variance_buf[pred_uidx] = sqrt(hh_inv_diag_element);
               }
-            }
-            if (is_unfinished) {
-              block_aux_iter[extra_regression_idx].is_unfinished = 1;
-              if (allele_ct_m2 && beta_se_multiallelic_fused) {
-                for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
-                  block_aux_iter[uii].is_unfinished = 1;
-                }
-              }
-            }
-            {
-              double* beta_se_iter2 = beta_se_iter;
-              for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
-                // In the multiallelic-fused case, if the first allele is
-                // constant, this writes the beta/se values for the first
-                // nonconstant, non-omitted allele where the results for the
-                // first allele belong.  We correct that at the end of this
-                // block.
-                *beta_se_iter2++ = coef_return[pred_uidx];
-                *beta_se_iter2++ = sample_variance_buf[pred_uidx];
+              if (!is_residualized) {
+                sample_variance_buf[0] = sqrt(hh_return[0]);
               }
-              if (cur_constraint_ct) {
-                // bugfix (4 Sep 2021): forgot to update this for residualize
-                // case
-                *beta_se_iter2++ = 0.0;
-
-                uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 1.0;
-                }
-                double chisq;
-                if (!LinearHypothesisChisq(coef_return, cur_constraints_con_major, hh_return, cur_constraint_ct, cur_regressed_predictor_stop, cur_regressed_predictor_ctav, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inv_1d_buf, outer_buf)) {
-                  *beta_se_iter2++ = chisq;
-                } else {
-                  const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
-                  memcpy(&(beta_se_iter2[-1]), &glm_err2, 8);
-                  *beta_se_iter2++ = -9.0;
+              for (uint32_t pred_uidx = 1 + is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                const double cur_hh_inv_diag_sqrt = 0.99999 * sample_variance_buf[pred_uidx];
+                const double* hh_inv_row_iter = &(hh_return[pred_uidx * cur_regressed_predictor_ctav + is_residualized]);
+                const double* hh_inv_diag_sqrts_iter = &(sample_variance_buf[is_residualized]);
+                for (uint32_t pred_uidx2 = is_residualized; pred_uidx2 != pred_uidx; ++pred_uidx2) {
+                  if ((*hh_inv_row_iter++) > cur_hh_inv_diag_sqrt * (*hh_inv_diag_sqrts_iter++)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
+                    goto GlmLogisticThreadD_skip_regression;
+                  }
                 }
-                // next test may have different alt allele count
-                joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 0.0;
+              }
+              if (is_unfinished) {
+                block_aux_iter[extra_regression_idx].is_unfinished = 1;
+                if (allele_ct_m2 && beta_se_multiallelic_fused) {
+                  for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
+                    block_aux_iter[uii].is_unfinished = 1;
+                  }
                 }
               }
-              if (!const_allele_ct) {
-                if (beta_se_multiallelic_fused || (!hide_covar)) {
-                  for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-                    *beta_se_iter2++ = coef_return[cur_biallelic_regressed_predictor_stop + extra_allele_idx];
-                    *beta_se_iter2++ = sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_allele_idx];
+              {
+                double* beta_se_iter2 = beta_se_iter;
+                for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
+                  // In the multiallelic-fused case, if the first allele is
+                  // constant, this writes the beta/se values for the first
+                  // nonconstant, non-omitted allele where the results for the
+                  // first allele belong.  We correct that at the end of this
+                  // block.
+                  *beta_se_iter2++ = coef_return[pred_uidx];
+                  *beta_se_iter2++ = sample_variance_buf[pred_uidx];
+                }
+                if (cur_constraint_ct) {
+                  // bugfix (4 Sep 2021): forgot to update this for residualize
+                  // case
+                  *beta_se_iter2++ = 0.0;
+
+                  uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 1.0;
+                  }
+                  double chisq;
+                  if (!LinearHypothesisChisq(coef_return, cur_constraints_con_major, hh_return, cur_constraint_ct, cur_regressed_predictor_stop, cur_regressed_predictor_ctav, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inv_1d_buf, outer_buf)) {
+                    *beta_se_iter2++ = chisq;
+                  } else {
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
+                    memcpy(&(beta_se_iter2[-1]), &glm_err2, 8);
+                    *beta_se_iter2++ = -9.0;
+                  }
+                  // next test may have different alt allele count
+                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_regressed_predictor_stop + joint_test_idx] = 0.0;
                   }
                 }
-              } else if (!beta_se_multiallelic_fused) {
-                if (!hide_covar) {
-                  // Need to insert some {CONST_ALLELE, -9} entries.
+                if (!const_allele_ct) {
+                  if (beta_se_multiallelic_fused || (!hide_covar)) {
+                    for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                      *beta_se_iter2++ = coef_return[cur_biallelic_regressed_predictor_stop + extra_allele_idx];
+                      *beta_se_iter2++ = sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_allele_idx];
+                    }
+                  }
+                } else if (!beta_se_multiallelic_fused) {
+                  if (!hide_covar) {
+                    // Need to insert some {CONST_ALLELE, -9} entries.
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
+                    const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
+                    uint32_t extra_read_allele_idx = 0;
+                    for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                      if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
+                        continue;
+                      }
+                      if (IsSet(const_alleles, allele_idx)) {
+                        memcpy(beta_se_iter2, &glm_err2, 8);
+                        beta_se_iter2[1] = -9.0;
+                        beta_se_iter2 = &(beta_se_iter2[2]);
+                      } else {
+                        *beta_se_iter2++ = coef_return[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx];
+                        *beta_se_iter2++ = sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx];
+                        ++extra_read_allele_idx;
+                      }
+                    }
+                  }
+                } else {
                   const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                  const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
-                  uint32_t extra_read_allele_idx = 0;
-                  for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                    if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
-                      continue;
+                  // Special-case first nonconst allele since it's positioned
+                  // discontinuously, and its BETA/SE may already be correctly
+                  // filled.
+                  uint32_t allele_idx = omitted_allele_idx? 0 : 1;
+                  if (IsSet(const_alleles, allele_idx)) {
+                    memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
+                    beta_se_iter[2 * include_intercept + 1] = -9.0;
+                    allele_idx = AdvTo0Bit(const_alleles, 1);
+                    if (allele_idx == omitted_allele_idx) {
+                      allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
                     }
-                    if (IsSet(const_alleles, allele_idx)) {
+                    const uint32_t skip_ct = allele_idx - 1 - (allele_idx > omitted_allele_idx);
+                    for (uint32_t uii = 0; uii != skip_ct; ++uii) {
                       memcpy(beta_se_iter2, &glm_err2, 8);
                       beta_se_iter2[1] = -9.0;
                       beta_se_iter2 = &(beta_se_iter2[2]);
-                    } else {
-                      *beta_se_iter2++ = coef_return[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx];
-                      *beta_se_iter2++ = sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx];
-                      ++extra_read_allele_idx;
                     }
+                    *beta_se_iter2++ = coef_return[1];
+                    *beta_se_iter2++ = sample_variance_buf[1];
                   }
-                }
-              } else {
-                const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                // Special-case first nonconst allele since it's positioned
-                // discontinuously, and its BETA/SE may already be correctly
-                // filled.
-                uint32_t allele_idx = omitted_allele_idx? 0 : 1;
-                if (IsSet(const_alleles, allele_idx)) {
-                  memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
-                  beta_se_iter[2 * include_intercept + 1] = -9.0;
-                  allele_idx = AdvTo0Bit(const_alleles, 1);
-                  if (allele_idx == omitted_allele_idx) {
-                    allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
-                  }
-                  const uint32_t skip_ct = allele_idx - 1 - (allele_idx > omitted_allele_idx);
-                  for (uint32_t uii = 0; uii != skip_ct; ++uii) {
-                    memcpy(beta_se_iter2, &glm_err2, 8);
-                    beta_se_iter2[1] = -9.0;
-                    beta_se_iter2 = &(beta_se_iter2[2]);
+                  ++allele_idx;
+                  uint32_t nonconst_allele_idx_m1 = 0;
+                  for (; allele_idx != allele_ct; ++allele_idx) {
+                    if (allele_idx == omitted_allele_idx) {
+                      continue;
+                    }
+                    if (!IsSet(const_alleles, allele_idx)) {
+                      *beta_se_iter2++ = coef_return[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
+                      *beta_se_iter2++ = sample_variance_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
+                      ++nonconst_allele_idx_m1;
+                    } else {
+                      memcpy(beta_se_iter2, &glm_err2, 8);
+                      beta_se_iter2[1] = -9.0;
+                      beta_se_iter2 = &(beta_se_iter2[2]);
+                    }
                   }
-                  *beta_se_iter2++ = coef_return[1];
-                  *beta_se_iter2++ = sample_variance_buf[1];
                 }
-                ++allele_idx;
-                uint32_t nonconst_allele_idx_m1 = 0;
-                for (; allele_idx != allele_ct; ++allele_idx) {
-                  if (allele_idx == omitted_allele_idx) {
-                    continue;
+              }
+              while (0) {
+              GlmLogisticThreadD_skip_regression:
+                {
+                  uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+                  if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
+                    reported_ct += allele_ct_m2;
                   }
-                  if (!IsSet(const_alleles, allele_idx)) {
-                    *beta_se_iter2++ = coef_return[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
-                    *beta_se_iter2++ = sample_variance_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1];
-                    ++nonconst_allele_idx_m1;
-                  } else {
-                    memcpy(beta_se_iter2, &glm_err2, 8);
-                    beta_se_iter2[1] = -9.0;
-                    beta_se_iter2 = &(beta_se_iter2[2]);
+                  for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                    memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                    beta_se_iter[uii * 2 + 1] = -9.0;
                   }
                 }
               }
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
             }
-            while (0) {
-            GlmLogisticThreadD_skip_regression:
-              {
-                uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-                if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
-                  reported_ct += allele_ct_m2;
-                }
-                for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-                  memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-                  beta_se_iter[uii * 2 + 1] = -9.0;
-                }
-              }
-            }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
           }
-        }
-        block_aux_iter = &(block_aux_iter[allele_ct - 1]);
-        if (local_covars_iter) {
-          local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
+          block_aux_iter = &(block_aux_iter[allele_ct - 1]);
+          if (local_covars_iter) {
+            local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
+          }
         }
       }
     }
@@ -5131,6 +5167,11 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     } else {
       per_alt_allele_xalloc_byte_ct += 2 * max_reported_test_ct * sizeof(double);
     }
+    // PgenMtLoadInit() may reduce calc_thread_ct, but not increase it.
+    unsigned char* tdq_alloc;
+    if (unlikely(bigstack_alloc_uc(TaskDequesAllocCachelineCt(calc_thread_ct) * kCacheline, &tdq_alloc))) {
+      goto GlmLogistic_ret_NOMEM;
+    }
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
     common->thread_mhc = nullptr;
     common->dosage_presents = nullptr;
@@ -5143,6 +5184,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
       goto GlmLogistic_ret_NOMEM;
     }
+    InitTaskDeques(calc_thread_ct, tdq_alloc, &common->tdq);
     LogisticAuxResult* logistic_block_aux_bufs[2];
     double* block_beta_se_bufs[2];
 
@@ -5369,6 +5411,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
       }
       if (variant_idx) {
         JoinThreads(&tg);
+        TaskDequesBlockDone(&common->tdq);
         reterr = S_CAST(PglErr, common->err_info);
         if (unlikely(reterr)) {
           PgenErrPrintNV(reterr, common->err_info >> 32);
@@ -5377,8 +5420,8 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
       }
       if (!IsLastBlock(&tg)) {
         common->cur_block_variant_ct = cur_block_variant_ct;
-        const uint32_t uidx_start = read_block_idx * read_block_size;
-        ComputeUidxStartPartition(variant_include, cur_block_variant_ct, calc_thread_ct, uidx_start, common->read_variant_uidx_starts);
+        common->read_variant_uidx_starts[0] = AdvTo1Bit(variant_include, read_block_idx * read_block_size);
+        ResetTaskDeques(cur_block_variant_ct, DivUp(cur_block_variant_ct, calc_thread_ct * 64), &common->tdq);
         PgrCopyBaseAndOffset(pgfip, calc_thread_ct, common->pgr_ptrs);
         ctx->block_aux = logistic_block_aux_bufs[parity];
         common->block_beta_se = block_beta_se_bufs[parity];
@@ -5856,6 +5899,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     }
     fputs("\b\b", stdout);
     logputs("done.\n");
+    LogTaskDequesIdle("--glm logistic regression", &common->tdq);
     logprintf("Results written to %s .\n", outname);
     *valid_allele_ct_ptr = valid_allele_ct;
   }
@@ -183,6 +183,7 @@ typedef struct GlmCtxStruct {
   uintptr_t** dosage_presents;
   Dosage** dosage_mains;
   uint32_t* read_variant_uidx_starts;
+  TaskDeques tdq;
 
   unsigned char** workspace_bufs;
 
@@ -176,6 +176,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      companion .sample file.\n"
 "    * With 'snpid-chr', chromosome codes are read from the 'SNP ID' field\n"
 "      instead of the usual chromosome field.\n"
+"    * When a chromosome filter is in effect and a bgenix-style <filename>.bgi\n"
+"      index is present, variants on excluded chromosomes are not read.\n"
 "    * The following REF/ALT modes are supported:\n"
 "      'ref-first': The first allele for each variant is REF.\n"
 "      'ref-last': The last allele for each variant is REF.\n"
@@ -298,10 +300,10 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
               );
     HelpPrint("make-pgen\0make-bpgen\0make-bed\0make-just-pvar\0make-just-psam\0make-pfile\0make-bpfile\0make-bfile\0", &help_ctrl, 1,
 "  --make-pgen ['vzs'] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
-"              ['erase-dosage'] ['fill-missing-from-dosage']\n"
+"              ['erase-dosage'] ['fill-missing-from-dosage'] ['ld-window']\n"
 "              ['pvar-cols='<col set desc>] ['psam-cols='<col set desc>]\n"
 "  --make-bpgen ['vzs'] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
-"               ['erase-dosage'] ['fill-missing-from-dosage']\n"
+"               ['erase-dosage'] ['fill-missing-from-dosage'] ['ld-window']\n"
 "  --make-bed ['vzs'] ['trim-alts']\n"
                /*
 "  --make-pgen ['vzs'] ['format='<code>] [{trim-alts | erase-alt2+}]\n"
@@ -342,6 +344,10 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    * When a hardcall is missing but the corresponding dosage is present,\n"
 "      'fill-missing-from-dosage' causes the (Euclidean-)nearest hardcall to be\n"
 "      filled in, with ties broken in favor of the lower-index allele.\n"
+"    * The 'ld-window' modifier causes each variant to be LD-compressed against\n"
+"      the best of the last 8 non-LD-compressed variants, instead of just the\n"
+"      immediately preceding one.  This usually shrinks the .pgen, but writing\n"
+"      is slower, and the resulting file is not readable by older plink2 builds.\n"
                /*
 "    * The 'writer-ver' modifier causes the output .pgen to include this\n"
 "      program's version string.  Note that the resulting .pgen is not readable\n"
@@ -473,7 +479,9 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "            filename extensions.\n"
 "    * 'HV-1chr': Single Haploview .ped + .info file pair.  Does not support\n"
 "                 multiple chromosomes.\n"
-"    * 'ind-major-bed': PLINK 1 sample-major .bed (+ .bim + .fam).\n"
+"    * 'ind-major-bed': PLINK 1 sample-major .bed (+ .bim + .fam).  When\n"
+"                       <.pgen filename>.smaj (see pgen_compress -s) is up to\n"
+"                       date, hardcalls are read from it.\n"
 "    * 'lgen': PLINK 1 long-format (.lgen + .fam + .map), loadable with --lfile.\n"
 "    * 'lgen-ref': .lgen + .fam + .map + .ref, loadable with --lfile +\n"
 "                  --reference.\n"
@@ -1671,8 +1679,10 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    Reports basic information about a .pgen file.\n\n"
                );
     HelpPrint("validate\0", &help_ctrl, 1,
-"  --validate\n"
-"    Validates all variant records in a .pgen file.\n\n"
+"  --validate ['quick']\n"
+"    Validates all variant records in a .pgen file.  Variant blocks are checked\n"
+"    in parallel, and the lowest-index error is reported.\n"
+"    * 'quick' only checks header and index consistency.\n\n"
                );
     HelpPrint("zst-decompress\0zd\0", &help_ctrl, 1,
 "  --zst-decompress <.zst file> [output filename]\n"
@@ -2762,13 +2772,61 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "                       shape instead, and postprocess as necessary.\n"
                );
     HelpPrint("memory\0seed\0", &help_ctrl, 0,
-"  --memory <val> ['require'] : Set size, in MiB, of initial workspace malloc\n"
-"                               attempt.  To error out instead of reducing the\n"
-"                               request size when the initial attempt fails, add\n"
-"                               the 'require' modifier.\n"
+"  --memory <val | 'auto' | 'plan'> ['require'] ['hugetlb'] :\n"
+"    Set size, in MiB, of initial workspace allocation attempt.\n"
+"    * To error out instead of reducing the request size when the initial\n"
+"      attempt fails, add the 'require' modifier.\n"
+"    * On Linux, the workspace requests transparent huge pages by default.  Add\n"
+"      'hugetlb' to use explicitly reserved huge pages (see\n"
+"      /proc/sys/vm/nr_hugepages) instead, when enough are available.\n"
+"    Peak workspace usage of each major command, and the high-water mark for the\n"
+"    whole run, are written to the log; use these to choose a --memory value.\n"
+"    * Instead of a size, 'auto' estimates each requested command's minimum and\n"
+"      full-speed workspace needs from the .pgen/.bed dimensions and thread\n"
+"      count, reserves just enough for full speed (or whatever is available\n"
+"      above the minimum), and errors out up front if even the minimum won't\n"
+"      fit.  'plan' prints the same estimates and exits without running\n"
+"      anything.  Estimates use pre-filtering counts, so they err on the high\n"
+"      side.\n"
+               );
+    HelpPrint("spill-dir\0memory\0", &help_ctrl, 0,
+"  --spill-dir <dir> : When the workspace is too small for the relationship\n"
+"                      matrix (--make-rel, --make-grm-list/-bin, --pca), its\n"
+"                      missingness correction table, or the --pca approx\n"
+"                      variant matrix, back that buffer with a temporary file\n"
+"                      in the given directory instead of erroring out.  Use a\n"
+"                      local SSD; the amount spilled is logged.  Not\n"
+"                      supported on Windows.\n"
                );
     HelpPrint("threads\0num_threads\0thread-num\0seed\0", &help_ctrl, 0,
-"  --threads <val>    : Set maximum number of compute threads.\n"
+"  --threads <val> ['pin' | 'numa'] : Set maximum number of compute threads.\n"
+"    Worker threads are started once and reused by every command.  These\n"
+"    modifiers are Linux-only:\n"
+"    * 'pin' binds each worker to its own CPU.\n"
+"    * 'numa' spreads workers across NUMA nodes, binding each to one node.\n"
+"      Then, per-thread workspace is first touched by the thread that uses\n"
+"      it, and --make-king keeps one copy of each genotype block per node.\n"
+"      The multi-node path has not yet been run on multi-socket hardware; please\n"
+"      report any --make-king result which differs from a run without 'numa'.\n"
+               );
+    HelpPrint("pvar-cache\0pvar\0bfile\0", &help_ctrl, 0,
+"  --pvar-cache       : Load the .pvar/.bim from a binary <filename>.pvc sidecar\n"
+"                       when it's up to date, and (re)write the sidecar after\n"
+"                       parsing the text otherwise.  Ignored when --var-filter,\n"
+"                       --var-min-qual, an INFO filter, --snps-only,\n"
+"                       --{min,max}-alleles, --set-{all,missing}-var-ids, or\n"
+"                       --merge-{par,x} is present.\n"
+               );
+    HelpPrint("pgen-cache\0", &help_ctrl, 0,
+"  --pgen-cache <MiB> : Cache up to this much decoded .pgen hardcall data, so\n"
+"                       that window-based commands (e.g. --indep-pairwise,\n"
+"                       --clump, --r2-unphased) don't repeatedly decode the\n"
+"                       same variants.\n"
+               );
+    HelpPrint("pgen-readahead\0", &help_ctrl, 0,
+"  --pgen-readahead <n> : Number of .pgen variant blocks to ask the OS to\n"
+"                         prefetch while the current block is being processed\n"
+"                         (default 1, max 64; 0 disables).\n"
                );
     HelpPrint("d\0covar-name\0exclude-snps\0pheno-name\0snps", &help_ctrl, 0,
 "  --d <char>         : Change variant/covariate range delimiter (normally '-').\n"
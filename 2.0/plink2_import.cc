@@ -16,6 +16,7 @@
 
 
 #include "include/pgenlib_write.h"
+#include "plink2_bgi.h"
 #include "plink2_compress_stream.h"
 #include "plink2_import.h"
 #include "plink2_import_legacy.h"
@@ -1082,7 +1083,14 @@ ENUM_U31_DEF_START()
   kVcfParseInvalidGt,
   kVcfParseHalfCallError,
   kVcfParseInvalidDosage,
-  kVcfParsePolyploidError
+  kVcfParsePolyploidError,
+  // only reported by the scanning pass
+  kVcfParseLeadingSpace,
+  kVcfParseLongId,
+  kVcfParseInvalidRef,
+  kVcfParseInvalidAlt,
+  kVcfParseMalformedAlt,
+  kVcfParseMultiallelicDosage
 ENUM_U31_DEF_END(VcfParseErr);
 
 VcfParseErr VcfScanBiallelicHdsLine(const VcfImportContext* vicp, const char* format_end, uint32_t* phase_or_dosage_found_ptr, char** line_iter_ptr) {
@@ -2728,12 +2736,1433 @@ THREAD_FUNC_DECL VcfGenoToPgenThread(void* raw_arg) {
   THREAD_RETURN;
 }
 
+// Minimal .tbi/.csi reader.  We need the virtual offset of each contig's
+// first record, and (when --from-bp/--to-bp is in effect) the offset to start
+// reading the requested range from.
+typedef struct BgzfIdxContigStruct {
+  uint64_t vbeg;
+  // Same as vbeg when no --from-bp was given, or the index couldn't narrow it
+  // down.
+  uint64_t range_vbeg;
+  // nullptr when the index doesn't store contig names (.csi files for BCF).
+  const char* name;
+  uint32_t name_slen;
+  // Reference index; for BCF, this is the header contig dictionary index.
+  uint32_t ref_idx;
+} BgzfIdxContig;
+
+// A maximal set of file-adjacent contigs which must be read.
+typedef struct BgzfIdxRunStruct {
+  uint64_t vbeg;
+  // The run ends as soon as a record on the stop contig (the next contig in
+  // file order) is encountered.  stop_name is nullptr, and stop_ref_idx is
+  // UINT32_MAX, if the run extends to eof.
+  const char* stop_name;
+  uint32_t stop_slen;
+  uint32_t stop_ref_idx;
+  // The run also ends at the first record with POS > stop_bp.  UINT32_MAX if
+  // there's no --to-bp bound.
+  uint32_t stop_bp;
+} BgzfIdxRun;
+
+typedef struct BgzfIdxCursorStruct {
+  BgzfIdxRun* runs;
+  uint32_t run_ct;
+  uint32_t run_idx;
+  uint32_t seek_pending;
+} BgzfIdxCursor;
+
+static inline BoolErr BgzfIdxScanI32(const unsigned char* idx_end, const unsigned char** idx_iterp, int32_t* valp) {
+  if (S_CAST(uintptr_t, idx_end - (*idx_iterp)) < sizeof(int32_t)) {
+    return 1;
+  }
+  memcpy(valp, *idx_iterp, sizeof(int32_t));
+  *idx_iterp += sizeof(int32_t);
+  return 0;
+}
+
+// Parses the tabix-style name block shared by .tbi files and .csi aux data.
+static BoolErr BgzfIdxScanNames(const unsigned char* aux_end, const unsigned char* aux_iter, uint32_t ref_ct, BgzfIdxContig* contigs) {
+  // format, col_seq, col_beg, col_end, meta, skip, l_nm
+  if (S_CAST(uintptr_t, aux_end - aux_iter) < 7 * sizeof(int32_t)) {
+    return 1;
+  }
+  int32_t names_blen;
+  memcpy(&names_blen, &(aux_iter[6 * sizeof(int32_t)]), sizeof(int32_t));
+  aux_iter = &(aux_iter[7 * sizeof(int32_t)]);
+  if ((names_blen < 0) || (names_blen > aux_end - aux_iter)) {
+    return 1;
+  }
+  const char* names_iter = R_CAST(const char*, aux_iter);
+  const char* names_end = &(names_iter[S_CAST(uint32_t, names_blen)]);
+  for (uint32_t ref_idx = 0; ref_idx != ref_ct; ++ref_idx) {
+    const char* name_end = S_CAST(const char*, memchr(names_iter, '\0', names_end - names_iter));
+    if (!name_end) {
+      return 1;
+    }
+    contigs[ref_idx].name = names_iter;
+    contigs[ref_idx].name_slen = name_end - names_iter;
+    names_iter = &(name_end[1]);
+  }
+  return 0;
+}
+
+// Bins/chunks of one reference were already validated by the caller.  Returns
+// the smallest virtual offset at which a record overlapping [beg, end) may
+// start, using the same logic as htslib's hts_itr_query(): chunks in bins
+// overlapping the region are considered, clamped below by min_off (from the
+// linear index for .tbi, and the loffset of the smallest bin containing beg
+// for .csi).  Returns UINT64_MAX if no chunk qualifies.
+static uint64_t BgzfIdxRegionVbeg(const unsigned char* bins_iter, uint32_t bin_ct, uint32_t is_csi, uint32_t min_shift, uint32_t depth, uint32_t pseudo_bin, uint64_t min_off, uint64_t beg, uint64_t end) {
+  if (is_csi) {
+    // Find loffsets of the bins on the path from beg's leaf bin to the root,
+    // and use the deepest one present.  (htslib stops before the root.)
+    uint64_t path_loffs[10];
+    for (uint32_t level = 0; level <= depth; ++level) {
+      path_loffs[level] = UINT64_MAX;
+    }
+    const unsigned char* scan_iter = bins_iter;
+    for (uint32_t bin_idx = 0; bin_idx != bin_ct; ++bin_idx) {
+      uint32_t bin;
+      memcpy(&bin, scan_iter, sizeof(int32_t));
+      int32_t chunk_ct;
+      memcpy(&chunk_ct, &(scan_iter[12]), sizeof(int32_t));
+      uint32_t level = 0;
+      while ((level < depth) && (bin >= (((1U << (3 * (level + 1))) - 1) / 7))) {
+        ++level;
+      }
+      const uint32_t level_first_bin = ((1U << (3 * level)) - 1) / 7;
+      if ((bin != pseudo_bin) && (bin - level_first_bin == (beg >> (min_shift + 3 * (depth - level))))) {
+        memcpy(&(path_loffs[level]), &(scan_iter[4]), 8);
+      }
+      scan_iter = &(scan_iter[16 + 16 * S_CAST(uint32_t, chunk_ct)]);
+    }
+    min_off = 0;
+    for (uint32_t level = depth; level; --level) {
+      if (path_loffs[level] != UINT64_MAX) {
+        min_off = path_loffs[level];
+        break;
+      }
+    }
+  }
+  uint64_t region_vbeg = UINT64_MAX;
+  for (uint32_t bin_idx = 0; bin_idx != bin_ct; ++bin_idx) {
+    uint32_t bin;
+    memcpy(&bin, bins_iter, sizeof(int32_t));
+    bins_iter = &(bins_iter[4 + is_csi * 8]);
+    int32_t chunk_ct;
+    memcpy(&chunk_ct, bins_iter, sizeof(int32_t));
+    bins_iter = &(bins_iter[4]);
+    const unsigned char* chunks_end = &(bins_iter[16 * S_CAST(uint32_t, chunk_ct)]);
+    if (bin != pseudo_bin) {
+      uint32_t level = 0;
+      while ((level < depth) && (bin >= (((1U << (3 * (level + 1))) - 1) / 7))) {
+        ++level;
+      }
+      const uint32_t bin_shift = min_shift + 3 * (depth - level);
+      const uint64_t bin_start = S_CAST(uint64_t, bin - (((1U << (3 * level)) - 1) / 7)) << bin_shift;
+      if ((bin_start < end) && (bin_start + (1LLU << bin_shift) > beg)) {
+        for (; bins_iter != chunks_end; bins_iter = &(bins_iter[16])) {
+          uint64_t chunk_vbeg;
+          uint64_t chunk_vend;
+          memcpy(&chunk_vbeg, bins_iter, 8);
+          memcpy(&chunk_vend, &(bins_iter[8]), 8);
+          if (chunk_vend > min_off) {
+            if (chunk_vbeg < min_off) {
+              chunk_vbeg = min_off;
+            }
+            if (chunk_vbeg < region_vbeg) {
+              region_vbeg = chunk_vbeg;
+            }
+          }
+        }
+      }
+    }
+    bins_iter = chunks_end;
+  }
+  return region_vbeg;
+}
+
+static int32_t BgzfIdxContigCmp(const void* aa, const void* bb) {
+  const uint64_t vbeg1 = S_CAST(const BgzfIdxContig*, aa)->vbeg;
+  const uint64_t vbeg2 = S_CAST(const BgzfIdxContig*, bb)->vbeg;
+  return (vbeg1 > vbeg2) - (vbeg1 < vbeg2);
+}
+
+// Looks for data_fname + ".tbi" (if tbi_ok) and data_fname + ".csi".  On
+// success, *contigs_ptr is allocated at the end of bigstack, and contains
+// every contig with at least one record, sorted in file order.  *contig_ct_ptr
+// is set to zero if no usable index was found.  from_bp/to_bp are -1 if
+// unspecified; otherwise, each contig's range_vbeg is set.  Only kPglRetNomem is returned
+// as an error; problems with the index file itself just produce a warning,
+// since the caller can always fall back on a full scan.
+static PglErr LoadBgzfIdx(const char* data_fname, const char* flagname_p, uint32_t tbi_ok, uint32_t names_required, int32_t from_bp, int32_t to_bp, char* idx_fname, BgzfIdxContig** contigs_ptr, uint32_t* contig_ct_ptr) {
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  FILE* idxfile = nullptr;
+  struct libdeflate_decompressor* ldc = nullptr;
+  *contig_ct_ptr = 0;
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint32_t data_fname_slen = strlen(data_fname);
+    if (data_fname_slen + 5 > kPglFnamesize) {
+      goto LoadBgzfIdx_ret_1;
+    }
+    char* idx_fname_ext = memcpya(idx_fname, data_fname, data_fname_slen);
+    uint32_t is_csi = 0;
+    if (tbi_ok) {
+      snprintf(idx_fname_ext, 5, ".tbi");
+      idxfile = fopen(idx_fname, FOPEN_RB);
+    }
+    if (!idxfile) {
+      snprintf(idx_fname_ext, 5, ".csi");
+      idxfile = fopen(idx_fname, FOPEN_RB);
+      if (!idxfile) {
+        goto LoadBgzfIdx_ret_1;
+      }
+      is_csi = 1;
+    }
+#ifndef _WIN32
+    // A stale index would send us to the wrong records.  htslib only warns
+    // here, but we may as well fall back on the full scan.
+    struct stat data_statbuf;
+    struct stat idx_statbuf;
+    if ((!stat(data_fname, &data_statbuf)) && (!stat(idx_fname, &idx_statbuf)) && (idx_statbuf.st_mtime < data_statbuf.st_mtime)) {
+      logerrprintfww("Warning: %s is older than %s; ignoring it.\n", idx_fname, data_fname);
+      goto LoadBgzfIdx_ret_1;
+    }
+#endif
+    if (unlikely(fseeko(idxfile, 0, SEEK_END))) {
+      goto LoadBgzfIdx_ret_READ_FAIL;
+    }
+    const int64_t compressed_size = ftello(idxfile);
+    if (unlikely(compressed_size < 28)) {
+      goto LoadBgzfIdx_ret_MALFORMED;
+    }
+    if (S_CAST(uint64_t, compressed_size) >= bigstack_left() / 2) {
+      goto LoadBgzfIdx_ret_NOMEM;
+    }
+    unsigned char* compressed_buf = S_CAST(unsigned char*, bigstack_end_alloc_raw_rd(compressed_size));
+    rewind(idxfile);
+    if (unlikely(fread_checked(compressed_buf, compressed_size, idxfile))) {
+      goto LoadBgzfIdx_ret_READ_FAIL;
+    }
+    fclose(idxfile);
+    idxfile = nullptr;
+
+    // Sum up the decompressed block sizes, then decompress everything.
+    const unsigned char* compressed_end = &(compressed_buf[S_CAST(uint64_t, compressed_size)]);
+    uint64_t idx_size = 0;
+    for (const unsigned char* block_iter = compressed_buf; block_iter != compressed_end; ) {
+      if ((compressed_end - block_iter < 28) || (!IsBgzfHeader(block_iter))) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      uint16_t bsize_minus1;
+      memcpy(&bsize_minus1, &(block_iter[16]), 2);
+      if ((bsize_minus1 < 25) || (bsize_minus1 >= compressed_end - block_iter)) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      block_iter = &(block_iter[bsize_minus1 + 1]);
+      uint32_t out_size;
+      memcpy(&out_size, &(block_iter[-4]), 4);
+      idx_size += out_size;
+    }
+    if (idx_size >= bigstack_left()) {
+      goto LoadBgzfIdx_ret_NOMEM;
+    }
+    unsigned char* idx_buf = S_CAST(unsigned char*, bigstack_end_alloc_raw_rd(idx_size));
+    ldc = libdeflate_alloc_decompressor();
+    if (unlikely(!ldc)) {
+      goto LoadBgzfIdx_ret_NOMEM;
+    }
+    unsigned char* idx_write_iter = idx_buf;
+    for (const unsigned char* block_iter = compressed_buf; block_iter != compressed_end; ) {
+      uint16_t bsize_minus1;
+      memcpy(&bsize_minus1, &(block_iter[16]), 2);
+      const unsigned char* block_end = &(block_iter[bsize_minus1 + 1]);
+      uint32_t out_size;
+      memcpy(&out_size, &(block_end[-4]), 4);
+      if (out_size) {
+        if (libdeflate_deflate_decompress(ldc, &(block_iter[18]), bsize_minus1 - 25, idx_write_iter, out_size, nullptr)) {
+          goto LoadBgzfIdx_ret_MALFORMED;
+        }
+        idx_write_iter = &(idx_write_iter[out_size]);
+      }
+      block_iter = block_end;
+    }
+    libdeflate_free_decompressor(ldc);
+    ldc = nullptr;
+
+    const unsigned char* idx_end = idx_write_iter;
+    const unsigned char* idx_iter = &(idx_buf[4]);
+    if ((idx_size < 8) || (!memequal(idx_buf, is_csi? "CSI\1" : "TBI\1", 4))) {
+      goto LoadBgzfIdx_ret_MALFORMED;
+    }
+    const unsigned char* aux_start = nullptr;
+    const unsigned char* aux_end = nullptr;
+    uint32_t pseudo_bin = 37450;
+    int32_t min_shift = 14;
+    int32_t depth = 5;
+    int32_t ref_ct;
+    if (is_csi) {
+      int32_t aux_blen;
+      if (BgzfIdxScanI32(idx_end, &idx_iter, &min_shift) ||
+          BgzfIdxScanI32(idx_end, &idx_iter, &depth) ||
+          BgzfIdxScanI32(idx_end, &idx_iter, &aux_blen) ||
+          (min_shift < 0) || (depth < 0) || (depth > 9) ||
+          (min_shift + 3 * depth > 62) || (aux_blen < 0) ||
+          (aux_blen > idx_end - idx_iter)) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      pseudo_bin = (((1U << (3 * depth + 3)) - 1) / 7) + 1;
+      if (aux_blen) {
+        aux_start = idx_iter;
+        idx_iter = &(idx_iter[S_CAST(uint32_t, aux_blen)]);
+        aux_end = idx_iter;
+      }
+      if (BgzfIdxScanI32(idx_end, &idx_iter, &ref_ct)) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+    } else {
+      if (BgzfIdxScanI32(idx_end, &idx_iter, &ref_ct)) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      aux_start = idx_iter;
+      aux_end = idx_end;
+    }
+    if ((ref_ct <= 0) || (S_CAST(uint32_t, ref_ct) > kMaxContigs)) {
+      goto LoadBgzfIdx_ret_MALFORMED;
+    }
+    if (S_CAST(uintptr_t, ref_ct) * sizeof(BgzfIdxContig) + kEndAllocAlign > bigstack_left()) {
+      goto LoadBgzfIdx_ret_NOMEM;
+    }
+    BgzfIdxContig* contigs = S_CAST(BgzfIdxContig*, bigstack_end_alloc_raw_rd(ref_ct * sizeof(BgzfIdxContig)));
+    if (aux_start) {
+      if (BgzfIdxScanNames(aux_end, aux_start, ref_ct, contigs)) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      if (!is_csi) {
+        // Name block immediately follows the other tabix header fields.
+        int32_t names_blen;
+        memcpy(&names_blen, &(aux_start[6 * sizeof(int32_t)]), sizeof(int32_t));
+        idx_iter = &(aux_start[7 * sizeof(int32_t) + S_CAST(uint32_t, names_blen)]);
+      }
+    } else {
+      if (names_required) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      for (int32_t ref_idx = 0; ref_idx != ref_ct; ++ref_idx) {
+        contigs[ref_idx].name = nullptr;
+        contigs[ref_idx].name_slen = 0;
+      }
+    }
+    // 0-based half-open region, as in the index
+    const uint64_t region_beg = (from_bp > 0)? (from_bp - 1) : 0;
+    const uint64_t region_end = (to_bp >= 0)? to_bp : (1LLU << (min_shift + 3 * depth));
+    uint32_t contig_ct = 0;
+    for (int32_t ref_idx = 0; ref_idx != ref_ct; ++ref_idx) {
+      int32_t bin_ct;
+      if (BgzfIdxScanI32(idx_end, &idx_iter, &bin_ct) || (bin_ct < 0)) {
+        goto LoadBgzfIdx_ret_MALFORMED;
+      }
+      const unsigned char* bins_start = idx_iter;
+      uint64_t vbeg = UINT64_MAX;
+      for (int32_t bin_idx = 0; bin_idx != bin_ct; ++bin_idx) {
+        int32_t bin;
+        if (BgzfIdxScanI32(idx_end, &idx_iter, &bin)) {
+          goto LoadBgzfIdx_ret_MALFORMED;
+        }
+        if (is_csi) {
+          // skip loffset
+          if (idx_end - idx_iter < 8) {
+            goto LoadBgzfIdx_ret_MALFORMED;
+          }
+          idx_iter = &(idx_iter[8]);
+        }
+        int32_t chunk_ct;
+        if (BgzfIdxScanI32(idx_end, &idx_iter, &chunk_ct) || (chunk_ct < 0) || (S_CAST(uint64_t, chunk_ct) * 16 > S_CAST(uintptr_t, idx_end - idx_iter))) {
+          goto LoadBgzfIdx_ret_MALFORMED;
+        }
+        // The pseudo-bin's "chunks" are summary statistics (record counts in
+        // the second one), not proper chunks.
+        if (S_CAST(uint32_t, bin) != pseudo_bin) {
+          for (int32_t chunk_idx = 0; chunk_idx != chunk_ct; ++chunk_idx) {
+            uint64_t chunk_vbeg;
+            memcpy(&chunk_vbeg, &(idx_iter[16 * S_CAST(uint32_t, chunk_idx)]), 8);
+            if (chunk_vbeg < vbeg) {
+              vbeg = chunk_vbeg;
+            }
+          }
+        }
+        idx_iter = &(idx_iter[16 * S_CAST(uint32_t, chunk_ct)]);
+      }
+      uint64_t min_off = 0;
+      if (!is_csi) {
+        int32_t intv_ct;
+        if (BgzfIdxScanI32(idx_end, &idx_iter, &intv_ct) || (intv_ct < 0) || (S_CAST(uint64_t, intv_ct) * 8 > S_CAST(uintptr_t, idx_end - idx_iter))) {
+          goto LoadBgzfIdx_ret_MALFORMED;
+        }
+        if (intv_ct) {
+          const uint32_t intv_idx = MINV(S_CAST(uint32_t, region_beg >> 14), S_CAST(uint32_t, intv_ct) - 1);
+          memcpy(&min_off, &(idx_iter[8 * intv_idx]), 8);
+        }
+        idx_iter = &(idx_iter[8 * S_CAST(uint32_t, intv_ct)]);
+      }
+      if (vbeg != UINT64_MAX) {
+        BgzfIdxContig* cur_contig = &(contigs[contig_ct++]);
+        cur_contig->vbeg = vbeg;
+        cur_contig->range_vbeg = vbeg;
+        if (from_bp > 1) {
+          const uint64_t region_vbeg = BgzfIdxRegionVbeg(bins_start, bin_ct, is_csi, min_shift, depth, pseudo_bin, min_off, region_beg, region_end);
+          // If no chunk overlaps the region, just read the whole contig.
+          if ((region_vbeg != UINT64_MAX) && (region_vbeg > vbeg)) {
+            cur_contig->range_vbeg = region_vbeg;
+          }
+        }
+        cur_contig->name = contigs[ref_idx].name;
+        cur_contig->name_slen = contigs[ref_idx].name_slen;
+        cur_contig->ref_idx = ref_idx;
+      }
+    }
+    // Contigs are contiguous in any indexed file, but reference-index order
+    // need not match file order (BCF files use the header contig order).
+    qsort(contigs, contig_ct, sizeof(BgzfIdxContig), BgzfIdxContigCmp);
+    *contigs_ptr = contigs;
+    *contig_ct_ptr = contig_ct;
+    bigstack_end_mark = nullptr;
+  }
+  while (0) {
+  LoadBgzfIdx_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  LoadBgzfIdx_ret_READ_FAIL:
+    logerrprintfww("Warning: Failed to read %s : %s. Performing full %s scan instead.\n", idx_fname, strerror(errno), flagname_p);
+    break;
+  LoadBgzfIdx_ret_MALFORMED:
+    logerrprintfww("Warning: %s is not a valid index for %s. Performing full %s scan instead.\n", idx_fname, data_fname, flagname_p);
+    break;
+  }
+ LoadBgzfIdx_ret_1:
+  if (ldc) {
+    libdeflate_free_decompressor(ldc);
+  }
+  fclose_cond(idxfile);
+  if (bigstack_end_mark) {
+    BigstackEndReset(bigstack_end_mark);
+  }
+  return reterr;
+}
+
+// contigs[] must be in file order, and keep_contigs[] has the corresponding
+// ChrNameMayBeKept() results.  Allocates the run array, and copies of
+// the stop-contig names, from the bottom of bigstack.  *run_ct_ptr is set to
+// zero if no contig would be skipped, since the index is useless in that case.
+// When exactly one contig is kept, its range_vbeg and to_bp (-1 = unset) are
+// also applied; the caller still performs the exact position filter.
+static PglErr InitBgzfIdxRuns(const BgzfIdxContig* contigs, const uintptr_t* keep_contigs, uint32_t contig_ct, int32_t to_bp, BgzfIdxCursor* cursorp, uint32_t* range_used_ptr) {
+  cursorp->run_ct = 0;
+  cursorp->run_idx = 0;
+  cursorp->seek_pending = 0;
+  *range_used_ptr = 0;
+  const uint32_t keep_ct = PopcountWords(keep_contigs, BitCtToWordCt(contig_ct));
+  if (keep_ct == 1) {
+    const BgzfIdxContig* keep_contig = &(contigs[AdvTo1Bit(keep_contigs, 0)]);
+    *range_used_ptr = (to_bp >= 0) || (keep_contig->range_vbeg != keep_contig->vbeg);
+  }
+  if ((keep_ct == contig_ct) && (!(*range_used_ptr))) {
+    return kPglRetSuccess;
+  }
+  const uint32_t stop_bp = ((*range_used_ptr) && (to_bp >= 0))? to_bp : UINT32_MAX;
+  uint32_t run_ct = 0;
+  uintptr_t stop_names_blen = 0;
+  for (uint32_t contig_idx = 0; contig_idx != contig_ct; ++contig_idx) {
+    if (IsSet(keep_contigs, contig_idx) && ((!contig_idx) || (!IsSet(keep_contigs, contig_idx - 1)))) {
+      ++run_ct;
+    } else if ((!IsSet(keep_contigs, contig_idx)) && contig_idx && IsSet(keep_contigs, contig_idx - 1) && contigs[contig_idx].name) {
+      stop_names_blen += contigs[contig_idx].name_slen + 1;
+    }
+  }
+  BgzfIdxRun* runs;
+  char* stop_names_iter;
+  if (unlikely(BIGSTACK_ALLOC_X(BgzfIdxRun, run_ct, &runs) ||
+               bigstack_alloc_c(stop_names_blen, &stop_names_iter))) {
+    return kPglRetNomem;
+  }
+  BgzfIdxRun* run_iter = runs;
+  uint32_t contig_idx = 0;
+  for (uint32_t run_idx = 0; run_idx != run_ct; ++run_idx, ++run_iter) {
+    contig_idx = AdvTo1Bit(keep_contigs, contig_idx);
+    run_iter->vbeg = contigs[contig_idx].range_vbeg;
+    run_iter->stop_bp = stop_bp;
+    contig_idx = AdvBoundedTo0Bit(keep_contigs, contig_idx, contig_ct);
+    if (contig_idx == contig_ct) {
+      run_iter->stop_name = nullptr;
+      run_iter->stop_slen = 0;
+      run_iter->stop_ref_idx = UINT32_MAX;
+    } else {
+      const BgzfIdxContig* stop_contig = &(contigs[contig_idx]);
+      run_iter->stop_ref_idx = stop_contig->ref_idx;
+      if (stop_contig->name) {
+        const uint32_t stop_slen = stop_contig->name_slen;
+        run_iter->stop_name = stop_names_iter;
+        run_iter->stop_slen = stop_slen;
+        stop_names_iter = memcpya(stop_names_iter, stop_contig->name, stop_slen);
+        *stop_names_iter++ = '\0';
+      } else {
+        run_iter->stop_name = nullptr;
+        run_iter->stop_slen = 0;
+      }
+    }
+  }
+  cursorp->runs = runs;
+  cursorp->run_ct = run_ct;
+  cursorp->seek_pending = 1;
+  return kPglRetSuccess;
+}
+
+// Describes VcfToPgen()'s current data line for error messages.  After an
+// index seek, line numbers are unknown, so the line is identified by its
+// position among the records read instead.
+CONSTI32(kVcfErrLineDescripBlen, 80);
+
+static void VcfErrLineDescrip(uintptr_t line_idx, uintptr_t idx_line_idx_base, uint32_t capitalize, char* line_descrip) {
+  if (!idx_line_idx_base) {
+    snprintf(line_descrip, kVcfErrLineDescripBlen, "%cine %" PRIuPTR " of --vcf file", capitalize? 'L' : 'l', line_idx);
+  } else {
+    snprintf(line_descrip, kVcfErrLineDescripBlen, "%cecord %" PRIuPTR " of --vcf file read via its index", capitalize? 'R' : 'r', line_idx - idx_line_idx_base);
+  }
+}
+
+// Replacement for TextNextLineUnsafe() when an index is in use.  On the first
+// call, and whenever the current run's stop contig (or stop position) is
+// reached, jumps to the next run; returns kPglRetEof after the last run.
+static PglErr BgzfIdxNextLineUnsafe(BgzfIdxCursor* cursorp, TextStream* txsp, char** line_iterp) {
+  PglErr reterr;
+  if (cursorp->seek_pending) {
+    cursorp->seek_pending = 0;
+    reterr = TextBgzfSeek(cursorp->runs[cursorp->run_idx].vbeg, txsp);
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+    *line_iterp = TextLineEnd(txsp);
+  }
+  reterr = TextNextLineUnsafe(txsp, line_iterp);
+  if (reterr) {
+    return reterr;
+  }
+  const BgzfIdxRun* cur_run = &(cursorp->runs[cursorp->run_idx]);
+  const char* line_iter = *line_iterp;
+  const char* stop_name = cur_run->stop_name;
+  uint32_t run_end = 0;
+  if (stop_name) {
+    const uint32_t stop_slen = cur_run->stop_slen;
+    run_end = memequal(line_iter, stop_name, stop_slen) && (line_iter[stop_slen] == '\t');
+  }
+  if ((!run_end) && (cur_run->stop_bp != UINT32_MAX)) {
+    // Malformed POS fields are left for the main loop to report.
+    const char* pos_str = NextPrespace(line_iter);
+    uint32_t cur_bp;
+    if ((*pos_str == '\t') && (!ScanUintDefcap(&(pos_str[1]), &cur_bp))) {
+      run_end = (cur_bp > cur_run->stop_bp);
+    }
+  }
+  if (run_end) {
+    if (++cursorp->run_idx == cursorp->run_ct) {
+      return kPglRetEof;
+    }
+    cursorp->seek_pending = 1;
+    return BgzfIdxNextLineUnsafe(cursorp, txsp, line_iterp);
+  }
+  return kPglRetSuccess;
+}
+
+// BCF counterpart of the stop checks in BgzfIdxNextLineUnsafe().
+// vrec_header[] starts with l_shared, l_indiv, CHROM, POS.
+static inline uint32_t BcfIdxRunEnded(const BgzfIdxRun* cur_run, const uint32_t* vrec_header) {
+  if (vrec_header[2] == cur_run->stop_ref_idx) {
+    return 1;
+  }
+  // POS is 0-based.
+  return (cur_run->stop_bp != UINT32_MAX) && (vrec_header[3] < 0x80000000U) && (vrec_header[3] >= cur_run->stop_bp);
+}
+
+static_assert(kTextbufSize >= 65536, "BcfIdxSeek() requires kTextbufSize >= 65536.");
+
+// BCF counterpart of the seek in BgzfIdxNextLineUnsafe().
+static PglErr BcfIdxSeek(BgzfIdxCursor* cursorp, BgzfRawMtDecompressStream* bgzfp, const char** errmsgp) {
+  cursorp->seek_pending = 0;
+  const uint64_t voffset = cursorp->runs[cursorp->run_idx].vbeg;
+  PglErr reterr = BgzfRawMtStreamSeek(voffset >> 16, bgzfp, errmsgp);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  unsigned char* skip_iter = R_CAST(unsigned char*, g_textbuf);
+  unsigned char* skip_end = &(skip_iter[voffset & 0xffff]);
+  reterr = BgzfRawMtStreamRead(skip_end, bgzfp, &skip_iter, errmsgp);
+  if (unlikely((!reterr) && (skip_iter != skip_end))) {
+    *errmsgp = kShortErrInvalidBgzf;
+    return kPglRetDecompressFail;
+  }
+  return reterr;
+}
+
+// Per-line logic of the VcfToPgen() scanning pass, shared by the serial loop
+// and VcfRangeScanMain().  Problems are reported via *vcf_parse_err_ptr; only
+// the serial loop turns them into error messages.
+typedef struct VcfScanParamsStruct {
+  const char* dosage_import_field;
+  STD_ARRAY_DECL(int32_t, 2, qual_mins);
+  STD_ARRAY_DECL(int32_t, 2, qual_maxs);
+  int32_t vcf_min_gq;
+  int32_t vcf_min_dp;
+  int32_t vcf_max_dp;
+  uint32_t dosage_import_field_slen;
+  uint32_t import_max_allele_ct;
+  uint32_t require_gt;
+  uint32_t format_dosage_relevant;
+  uint32_t format_hds_search;
+  uint32_t format_gq_or_dp_relevant;
+} VcfScanParams;
+
+typedef struct VcfScanStatsStruct {
+  uintptr_t variant_skip_ct;
+  uintptr_t allele_idx_end;
+  uintptr_t max_postformat_blen;  // starting from tab at end of FORMAT
+  uint32_t variant_ct;
+  uint32_t max_line_blen;
+  uint32_t max_alt_ct;
+  uint32_t max_allele_slen;
+  uint32_t max_qualfilterinfo_slen;
+  uint32_t phase_or_dosage_found;
+  uint32_t not_single_sample_no_nonvar;
+  uint32_t nonvar_nonmissing_ct;
+} VcfScanStats;
+
+void InitVcfScanStats(uint32_t not_single_sample_no_nonvar, VcfScanStats* statsp) {
+  statsp->variant_skip_ct = 0;
+  statsp->allele_idx_end = 0;
+  statsp->max_postformat_blen = 1;
+  statsp->variant_ct = 0;
+  statsp->max_line_blen = 1;
+  statsp->max_alt_ct = 1;
+  statsp->max_allele_slen = 1;
+  statsp->max_qualfilterinfo_slen = 6;
+  statsp->phase_or_dosage_found = 0;
+  statsp->not_single_sample_no_nonvar = not_single_sample_no_nonvar;
+  statsp->nonvar_nonmissing_ct = 0;
+}
+
+typedef struct VcfScanLineStruct {
+  char* chr_code_end;
+  char* info_start;
+  char* info_end;
+  char* format_start;  // only set when there are samples
+  uint32_t alt_ct;  // 0 if the line is filtered out
+  uint32_t max_allele_slen;
+  uint32_t qualfilterinfo_slen;
+} VcfScanLine;
+
+// Parses CHROM..INFO (and checks for FORMAT:GT) on a nonheader line.  If the
+// line is filtered out by --max-alleles or --vcf-require-gt, slp->alt_ct is
+// set to 0 and statsp->variant_skip_ct is incremented.  The chromosome filter
+// is left to the caller, since the two scanners handle contig names
+// differently.
+BoolErr VcfScanLineHead(const VcfScanParams* paramsp, char* line_iter, VcfImportContext* vicp, VcfScanStats* statsp, VcfScanLine* slp, VcfParseErr* vcf_parse_err_ptr) {
+  // we were previously tolerating trailing newlines here, but there wasn't a
+  // good reason for doing so.
+  if (unlikely(ctou32(*line_iter) <= 32)) {
+    *vcf_parse_err_ptr = ((*line_iter == ' ') || (*line_iter == '\t'))? kVcfParseLeadingSpace : kVcfParseMissingTokens;
+    return 1;
+  }
+  char* chr_code_end = NextPrespace(line_iter);
+  slp->chr_code_end = chr_code_end;
+  if (unlikely(*chr_code_end != '\t')) {
+    *vcf_parse_err_ptr = kVcfParseMissingTokens;
+    return 1;
+  }
+  // QUAL/FILTER enforcement is now postponed till .pvar loading.  only other
+  // things we do during the scanning pass are (i) count alt alleles, and (ii)
+  // check whether any phased genotype calls are present.
+
+  char* pos_end = NextPrespace(chr_code_end);
+  if (unlikely(*pos_end != '\t')) {
+    *vcf_parse_err_ptr = kVcfParseMissingTokens;
+    return 1;
+  }
+
+  // may as well check ID length here
+  // postpone POS validation till second pass so we only have to parse it once
+  char* id_end = NextPrespace(pos_end);
+  if (unlikely(*id_end != '\t')) {
+    *vcf_parse_err_ptr = kVcfParseMissingTokens;
+    return 1;
+  }
+  if (unlikely(S_CAST(uintptr_t, id_end - pos_end) > kMaxIdBlen)) {
+    *vcf_parse_err_ptr = kVcfParseLongId;
+    return 1;
+  }
+
+  // note REF length
+  char* ref_allele_start = &(id_end[1]);
+  char* linebuf_iter = FirstPrespace(ref_allele_start);
+  if (unlikely(*linebuf_iter != '\t')) {
+    *vcf_parse_err_ptr = kVcfParseMissingTokens;
+    return 1;
+  }
+  uint32_t cur_max_allele_slen = linebuf_iter - ref_allele_start;
+  if (unlikely(memchr(ref_allele_start, ',', cur_max_allele_slen) != nullptr)) {
+    *vcf_parse_err_ptr = kVcfParseInvalidRef;
+    return 1;
+  }
+
+  uint32_t alt_ct = 1;
+  unsigned char ucc;
+  // treat ALT=. as if it were an actual allele for now
+  for (; ; ++alt_ct) {
+    char* cur_allele_start = ++linebuf_iter;
+    ucc = *linebuf_iter;
+    if (unlikely((ucc <= ',') && (ucc != '*'))) {
+      *vcf_parse_err_ptr = kVcfParseInvalidAlt;
+      return 1;
+    }
+    do {
+      ucc = *(++linebuf_iter);
+      // allow GATK 3.4 <*:DEL> symbolic allele
+    } while ((ucc > ',') || (ucc == '*'));
+    const uint32_t cur_allele_slen = linebuf_iter - cur_allele_start;
+    if (cur_allele_slen > cur_max_allele_slen) {
+      cur_max_allele_slen = cur_allele_slen;
+    }
+    if (ucc != ',') {
+      break;
+    }
+  }
+
+  if (unlikely(ucc != '\t')) {
+    *vcf_parse_err_ptr = kVcfParseMalformedAlt;
+    return 1;
+  }
+  if (alt_ct > statsp->max_alt_ct) {
+    if (alt_ct >= paramsp->import_max_allele_ct) {
+      ++statsp->variant_skip_ct;
+      slp->alt_ct = 0;
+      return 0;
+    }
+    statsp->max_alt_ct = alt_ct;
+  }
+
+  // skip QUAL, FILTER
+  char* qual_start_m1 = linebuf_iter;
+  for (uint32_t uii = 0; uii != 2; ++uii) {
+    linebuf_iter = NextPrespace(linebuf_iter);
+    if (unlikely(*linebuf_iter != '\t')) {
+      *vcf_parse_err_ptr = kVcfParseMissingTokens;
+      return 1;
+    }
+  }
+
+  // --vcf-require-gt
+  char* info_start = &(linebuf_iter[1]);
+  char* info_end = FirstPrespace(info_start);
+  if (vicp->vibc.sample_ct) {
+    if (unlikely(*info_end != '\t')) {
+      *vcf_parse_err_ptr = kVcfParseMissingTokens;
+      return 1;
+    }
+    linebuf_iter = &(info_end[1]);
+    vicp->vibc.gt_exists = memequal_sk(linebuf_iter, "GT") && ((linebuf_iter[2] == ':') || (linebuf_iter[2] == '\t'));
+    if (paramsp->require_gt && (!vicp->vibc.gt_exists)) {
+      ++statsp->variant_skip_ct;
+      slp->alt_ct = 0;
+      return 0;
+    }
+    slp->format_start = linebuf_iter;
+  }
+  slp->info_start = info_start;
+  slp->info_end = info_end;
+  slp->alt_ct = alt_ct;
+  slp->max_allele_slen = cur_max_allele_slen;
+  slp->qualfilterinfo_slen = info_end - qual_start_m1;
+  return 0;
+}
+
+// Scans FORMAT and the genotype columns of a retained line (only call this
+// when there are samples), checking for phased calls, dosages, and (in the
+// single-sample case) hom-REF calls.  *line_iter_ptr is set to the line's
+// terminating '\n'.
+BoolErr VcfScanLineTail(const VcfScanParams* paramsp, const VcfScanLine* slp, VcfImportContext* vicp, VcfScanStats* statsp, char** line_iter_ptr, VcfParseErr* vcf_parse_err_ptr) {
+  char* format_start = slp->format_start;
+  char* format_end = FirstPrespace(format_start);
+  if (unlikely(*format_end != '\t')) {
+    *vcf_parse_err_ptr = kVcfParseMissingTokens;
+    return 1;
+  }
+  char* line_iter = format_end;
+  if ((!statsp->phase_or_dosage_found) || (!statsp->not_single_sample_no_nonvar)) {
+    if (paramsp->format_dosage_relevant) {
+      vicp->dosage_field_idx = GetVcfFormatPosition(paramsp->dosage_import_field, format_start, format_end, paramsp->dosage_import_field_slen);
+    }
+    if (paramsp->format_hds_search) {
+      // theoretically possible for HDS to be in VCF header without
+      // accompanying DS
+      vicp->hds_field_idx = GetVcfFormatPosition("HDS", format_start, format_end, 3);
+    }
+    if (paramsp->format_gq_or_dp_relevant) {
+      STD_ARRAY_DECL(uint32_t, 2, qual_field_idxs);
+      uint32_t qual_field_ct = VcfQualScanInit1(format_start, format_end, paramsp->vcf_min_gq, paramsp->vcf_min_dp, paramsp->vcf_max_dp, qual_field_idxs);
+      // bugfix (5 Jun 2018): must initialize qual_field_ct to zero
+      vicp->vibc.qual_field_ct = 0;
+      if (qual_field_ct) {
+        vicp->vibc.qual_field_ct = VcfQualScanInit2(qual_field_idxs, paramsp->qual_mins, paramsp->qual_maxs, vicp->vibc.qual_field_skips, vicp->vibc.qual_line_mins, vicp->vibc.qual_line_maxs);
+      }
+    }
+
+    // Check if there's at least one phased het call, and/or at least one
+    // relevant dosage.
+    // If there's only one sample, maybe also check whether the VCF has any
+    // hom-REF calls at all.
+    // Don't bother multithreading this since it's trivial.
+    if ((vicp->hds_field_idx != UINT32_MAX) || (vicp->dosage_field_idx != UINT32_MAX)) {
+      if (unlikely(slp->alt_ct != 1)) {
+        *vcf_parse_err_ptr = kVcfParseMultiallelicDosage;
+        return 1;
+      }
+      const VcfParseErr vcf_parse_err = VcfScanBiallelicHdsLine(vicp, format_end, &statsp->phase_or_dosage_found, &line_iter);
+      if (unlikely(vcf_parse_err)) {
+        *vcf_parse_err_ptr = vcf_parse_err;
+        return 1;
+      }
+    } else if (vicp->vibc.gt_exists) {
+      if (!statsp->not_single_sample_no_nonvar) {
+        if (format_end[1] == '0') {
+          const char cc = format_end[2];
+          statsp->not_single_sample_no_nonvar = (((cc == '/') || (cc == '|')) && (format_end[3] == '0')) || (cc == ':') || (cc == '\t');
+        }
+        // This can miss ./0 and the like, but that should practically never
+        // matter.
+        statsp->nonvar_nonmissing_ct += (format_end[1] != '.');
+      }
+      if (!statsp->phase_or_dosage_found) {
+        if (slp->alt_ct < 10) {
+          statsp->phase_or_dosage_found = VcfScanShortallelicLine(&(vicp->vibc), format_end, &line_iter);
+        } else {
+          statsp->phase_or_dosage_found = VcfScanLongallelicLine(&(vicp->vibc), format_end, &line_iter);
+        }
+      }
+    }
+  }
+  line_iter = AdvToDelim(line_iter, '\n');
+  const uint32_t cur_postformat_slen = line_iter - format_end;
+  if (cur_postformat_slen >= statsp->max_postformat_blen) {
+    statsp->max_postformat_blen = cur_postformat_slen + 1;
+  }
+  *line_iter_ptr = line_iter;
+  return 0;
+}
+
+// --vcf scanning pass, split across threads.  A bgzf-compressed file is cut
+// at verified bgzf block boundaries into up to max_thread_ct byte ranges,
+// each of which is decompressed and scanned independently; a line belongs to
+// the range containing its first byte.  Each range records one uint32 per
+// retained variant (ALT count, with the INFO/PR flag in the top bit), and one
+// VcfRangeContig each time the chromosome name changes.  VcfRangeScanBgzf()
+// then registers the contig names, and fills allele_idx_offsets and
+// nonref_flags, in file order.
+//
+// Anything the serial scan would complain about (and a few things it
+// wouldn't, e.g. a line too long for the per-range buffer) just causes the
+// parallel result to be discarded; the serial scan then runs as before and
+// produces the usual error message.
+CONSTI32(kVcfRangeMinBytes, 1048576);
+
+// Enough for a candidate header plus two successor headers.
+CONSTI32(kVcfRangeSplitWindow, 4 * 65536 + 32);
+
+typedef struct VcfRangeContigStruct {
+  uintptr_t line_idx;  // 1-based, relative to the start of the range
+  uint32_t name_slen;
+  uint32_t is_kept;
+  // null-terminated name follows
+} VcfRangeContig;
+
+typedef struct VcfRangeStruct {
+  uint64_t read_coffset;  // first block to decompress
+  uint64_t stop_coffset;  // first block of the next range, UINT64_MAX if none
+  uint32_t skip_blen;  // uncompressed size of the block preceding the range
+  unsigned char* in;
+  char* textbuf;
+  uintptr_t textbuf_size;
+  uint32_t* variant_recs;
+  uintptr_t variant_rec_capacity;
+  unsigned char* contig_arena;
+  uintptr_t contig_arena_size;
+
+  // set by VcfRangeScanMain()
+  VcfScanStats stats;
+  uintptr_t line_ct;
+  uintptr_t header_line_ct;  // leading lines starting with '#'
+  uintptr_t contig_arena_used;
+  uint32_t failed;
+} VcfRange;
+
+typedef struct VcfRangeScanCtxStruct {
+  const char* vcfname;
+  const ChrInfo* cip;
+  VcfScanParams params;
+  VcfImportContext vic;
+  uint32_t prohibit_extra_chr;
+  uint32_t info_pr_exists;
+  uint32_t not_single_sample_no_nonvar;
+
+  VcfRange* ranges;
+  uint32_t abort;  // set by the first range to fail
+} VcfRangeScanCtx;
+
+typedef struct VcfRangeReaderStruct {
+  FILE* ff;
+  struct libdeflate_decompressor* ldc;
+  unsigned char* in;
+  unsigned char* in_iter;
+  unsigned char* in_end;
+  uint64_t coffset;  // compressed offset of in_iter
+  uint64_t stop_coffset;
+  uint64_t stop_uoffset;  // UINT64_MAX until stop_coffset is reached
+  uint64_t uoffset;  // uncompressed offset of the next decompressed byte
+  uint32_t eof;
+} VcfRangeReader;
+
+// Decompresses whole blocks into [*dst_iterp, dst_end).  Once the range's
+// stop block has been reached, at most one block is decompressed per call,
+// since only the line straddling the boundary still needs to be completed.
+// Returns 1 on read error or invalid bgzf.
+static BoolErr VcfRangeRead(char* dst_end, VcfRangeReader* rrp, char** dst_iterp) {
+  struct libdeflate_decompressor* ldc = rrp->ldc;
+  unsigned char* in = rrp->in;
+  unsigned char* in_iter = rrp->in_iter;
+  unsigned char* in_end = rrp->in_end;
+  uint64_t coffset = rrp->coffset;
+  char* dst_iter = *dst_iterp;
+  while (1) {
+    if (coffset >= rrp->stop_coffset) {
+      if (rrp->stop_uoffset == UINT64_MAX) {
+        if (unlikely(coffset != rrp->stop_coffset)) {
+          return 1;
+        }
+        rrp->stop_uoffset = rrp->uoffset;
+      } else if (dst_iter != *dst_iterp) {
+        break;
+      }
+    }
+    const uint32_t n_inbytes = in_end - in_iter;
+    if (n_inbytes > 25) {
+      if (unlikely(!IsBgzfHeader(in_iter))) {
+        return 1;
+      }
+      uint16_t bsize_minus1_u16;
+      memcpy(&bsize_minus1_u16, &(in_iter[16]), 2);
+      const uint32_t bsize_minus1 = bsize_minus1_u16;
+      if (unlikely(bsize_minus1 < 25)) {
+        return 1;
+      }
+      if (bsize_minus1 < n_inbytes) {
+        const uint32_t in_size = bsize_minus1 - 25;
+        uint32_t out_size;
+        memcpy(&out_size, &(in_iter[in_size + 22]), 4);
+        if (unlikely(out_size > 65536)) {
+          return 1;
+        }
+        if (out_size > S_CAST(uintptr_t, dst_end - dst_iter)) {
+          break;
+        }
+        if (unlikely(libdeflate_deflate_decompress(ldc, &(in_iter[18]), in_size, dst_iter, out_size, nullptr))) {
+          return 1;
+        }
+        in_iter = &(in_iter[bsize_minus1 + 1]);
+        coffset += bsize_minus1 + 1;
+        dst_iter = &(dst_iter[out_size]);
+        rrp->uoffset += out_size;
+        continue;
+      }
+    }
+    if (rrp->eof) {
+      break;
+    }
+    memmove(in, in_iter, n_inbytes);
+    const uint32_t nbytes = fread_unlocked(&(in[n_inbytes]), 1, kDecompressChunkSize - n_inbytes, rrp->ff);
+    if (unlikely(ferror_unlocked(rrp->ff))) {
+      return 1;
+    }
+    in_iter = in;
+    in_end = &(in[n_inbytes + nbytes]);
+    if (!nbytes) {
+      if (unlikely(n_inbytes)) {
+        return 1;
+      }
+      rrp->eof = 1;
+      break;
+    }
+  }
+  rrp->in_iter = in_iter;
+  rrp->in_end = in_end;
+  rrp->coffset = coffset;
+  *dst_iterp = dst_iter;
+  return 0;
+}
+
+// Uses the same per-line helpers as the serial scanning loop in VcfToPgen(),
+// except that all errors just mark the range as failed, and contig names are
+// only looked up (see ChrNameMayBeKept()), not registered.
+static void VcfRangeScanMain(uint32_t tidx, VcfRangeScanCtx* ctx) {
+  VcfRange* rp = &(ctx->ranges[tidx]);
+  const ChrInfo* cip = ctx->cip;
+  const VcfScanParams* paramsp = &(ctx->params);
+  const uint32_t prohibit_extra_chr = ctx->prohibit_extra_chr;
+  const uint32_t info_pr_exists = ctx->info_pr_exists;
+  VcfImportContext vic = ctx->vic;
+  const uint32_t sample_ct = vic.vibc.sample_ct;
+  VcfScanStats* statsp = &(rp->stats);
+  InitVcfScanStats(ctx->not_single_sample_no_nonvar, statsp);
+  rp->line_ct = 0;
+  rp->header_line_ct = 0;
+  rp->contig_arena_used = 0;
+  rp->failed = 0;
+  VcfRangeReader rr;
+  rr.ff = fopen(ctx->vcfname, FOPEN_RB);
+  rr.ldc = nullptr;
+  {
+    if (unlikely((!rr.ff) || fseeko(rr.ff, rp->read_coffset, SEEK_SET))) {
+      goto VcfRangeScanMain_fail;
+    }
+    rr.ldc = libdeflate_alloc_decompressor();
+    if (unlikely(!rr.ldc)) {
+      goto VcfRangeScanMain_fail;
+    }
+    rr.in = rp->in;
+    rr.in_iter = rr.in;
+    rr.in_end = rr.in;
+    rr.coffset = rp->read_coffset;
+    rr.stop_coffset = rp->stop_coffset;
+    rr.stop_uoffset = UINT64_MAX;
+    rr.uoffset = 0;
+    rr.eof = 0;
+    char* textbuf = rp->textbuf;
+    // Leave room for a '\n' after an unterminated last line.
+    char* text_stop = &(textbuf[rp->textbuf_size - 1]);
+    char* text_end = textbuf;
+    uint64_t textbuf_uoffset = 0;
+    char* line_start = textbuf;
+    const uint32_t skip_blen = rp->skip_blen;
+    if (skip_blen) {
+      // The range starts right after the first '\n' at or after uncompressed
+      // offset (skip_blen - 1), i.e. the last byte of the preceding block.
+      if (unlikely(VcfRangeRead(text_stop, &rr, &text_end) || (S_CAST(uintptr_t, text_end - textbuf) < skip_blen))) {
+        goto VcfRangeScanMain_fail;
+      }
+      char* search_start = &(textbuf[skip_blen - 1]);
+      while (1) {
+        char* nl = S_CAST(char*, memchr(search_start, '\n', text_end - search_start));
+        if (nl) {
+          line_start = &(nl[1]);
+          break;
+        }
+        textbuf_uoffset += text_end - textbuf;
+        text_end = textbuf;
+        line_start = textbuf;
+        if (rr.eof || __atomic_load_n(&ctx->abort, __ATOMIC_RELAXED)) {
+          break;
+        }
+        if (unlikely(VcfRangeRead(text_stop, &rr, &text_end))) {
+          goto VcfRangeScanMain_fail;
+        }
+        search_start = textbuf;
+      }
+    }
+    uint32_t* variant_recs = rp->variant_recs;
+    const uintptr_t variant_rec_capacity = rp->variant_rec_capacity;
+    unsigned char* contig_arena = rp->contig_arena;
+    unsigned char* contig_arena_iter = contig_arena;
+    unsigned char* contig_arena_end = &(contig_arena[rp->contig_arena_size]);
+    VcfRangeContig* cur_contig = nullptr;
+    const char* cur_contig_name = nullptr;
+    uintptr_t line_idx = 0;
+    uint32_t variant_ct = 0;
+    VcfScanLine sl;
+    VcfParseErr vcf_parse_err;
+    while (1) {
+      if (textbuf_uoffset + S_CAST(uintptr_t, line_start - textbuf) >= rr.stop_uoffset) {
+        break;
+      }
+      char* line_end = S_CAST(char*, memchr(line_start, '\n', text_end - line_start));
+      if (!line_end) {
+        if (rr.eof) {
+          if (line_start == text_end) {
+            break;
+          }
+          line_end = text_end;
+          *text_end++ = '\n';
+        } else {
+          if (__atomic_load_n(&ctx->abort, __ATOMIC_RELAXED)) {
+            goto VcfRangeScanMain_fail;
+          }
+          const uintptr_t carry_blen = text_end - line_start;
+          memmove(textbuf, line_start, carry_blen);
+          textbuf_uoffset += line_start - textbuf;
+          line_start = textbuf;
+          text_end = &(textbuf[carry_blen]);
+          char* prev_text_end = text_end;
+          if (unlikely(VcfRangeRead(text_stop, &rr, &text_end) ||
+                       ((text_end == prev_text_end) && (!rr.eof)))) {
+            // read failure, or line too long for this buffer
+            goto VcfRangeScanMain_fail;
+          }
+          continue;
+        }
+      }
+      ++line_idx;
+      char* line_iter = line_start;
+      line_start = &(line_end[1]);
+      const uint32_t line_blen = line_start - line_iter;
+      if (line_blen > statsp->max_line_blen) {
+        statsp->max_line_blen = line_blen;
+      }
+      if (*line_iter == '#') {
+        // header line, or (if not at the start of the file) an error
+        if (unlikely(line_idx != rp->header_line_ct + 1)) {
+          goto VcfRangeScanMain_fail;
+        }
+        ++rp->header_line_ct;
+        continue;
+      }
+      if (unlikely(VcfScanLineHead(paramsp, line_iter, &vic, statsp, &sl, &vcf_parse_err))) {
+        goto VcfRangeScanMain_fail;
+      }
+      if (!sl.alt_ct) {
+        continue;
+      }
+      const uint32_t chr_slen = sl.chr_code_end - line_iter;
+      if ((!cur_contig) || (cur_contig->name_slen != chr_slen) || (!memequal(cur_contig_name, line_iter, chr_slen))) {
+        const uintptr_t entry_blen = RoundUpPow2(sizeof(VcfRangeContig) + chr_slen + 1, sizeof(intptr_t));
+        if (unlikely(S_CAST(uintptr_t, contig_arena_end - contig_arena_iter) < entry_blen)) {
+          goto VcfRangeScanMain_fail;
+        }
+        cur_contig = R_CAST(VcfRangeContig*, contig_arena_iter);
+        contig_arena_iter = &(contig_arena_iter[entry_blen]);
+        char* name_copy = R_CAST(char*, &(cur_contig[1]));
+        memcpyx(name_copy, line_iter, chr_slen, '\0');
+        cur_contig->line_idx = line_idx;
+        cur_contig->name_slen = chr_slen;
+        cur_contig->is_kept = ChrNameMayBeKept(cip, name_copy, chr_slen, prohibit_extra_chr);
+        cur_contig_name = name_copy;
+      }
+      if (!cur_contig->is_kept) {
+        ++statsp->variant_skip_ct;
+        continue;
+      }
+      if (sl.max_allele_slen > statsp->max_allele_slen) {
+        statsp->max_allele_slen = sl.max_allele_slen;
+      }
+      if (sl.qualfilterinfo_slen > statsp->max_qualfilterinfo_slen) {
+        statsp->max_qualfilterinfo_slen = sl.qualfilterinfo_slen;
+      }
+      if (unlikely(variant_ct == variant_rec_capacity)) {
+        goto VcfRangeScanMain_fail;
+      }
+      uint32_t variant_rec = sl.alt_ct;
+      if (info_pr_exists && PrInInfo(sl.info_end - sl.info_start, sl.info_start)) {
+        variant_rec |= 0x80000000U;
+      }
+      variant_recs[variant_ct++] = variant_rec;
+      if (sample_ct) {
+        if (unlikely(VcfScanLineTail(paramsp, &sl, &vic, statsp, &line_iter, &vcf_parse_err))) {
+          goto VcfRangeScanMain_fail;
+        }
+      }
+    }
+    rp->line_ct = line_idx;
+    rp->contig_arena_used = contig_arena_iter - contig_arena;
+    statsp->variant_ct = variant_ct;
+  }
+  while (0) {
+  VcfRangeScanMain_fail:
+    rp->failed = 1;
+    __atomic_store_n(&ctx->abort, 1, __ATOMIC_RELAXED);
+  }
+  if (rr.ldc) {
+    libdeflate_free_decompressor(rr.ldc);
+  }
+  if (rr.ff) {
+    fclose(rr.ff);
+  }
+}
+
+THREAD_FUNC_DECL VcfRangeScanThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  VcfRangeScanCtx* ctx = S_CAST(VcfRangeScanCtx*, arg->sharedp->context);
+  VcfRangeScanMain(arg->tidx, ctx);
+  THREAD_RETURN;
+}
+
+// Looks for a bgzf block starting in [target_coffset, target_coffset + 64
+// KiB) which is followed by two more valid block headers (or eof), and which
+// decompresses to at least one byte.  On success, *prev_coffset_ptr is set to
+// that block's offset, *split_coffset_ptr to the next block's, and
+// *prev_isize_ptr to the block's uncompressed size.  Returns 0 if no such
+// block was found.
+static uint32_t FindBgzfSplit(FILE* ff, uint64_t file_size, uint64_t target_coffset, unsigned char* window, uint64_t* prev_coffset_ptr, uint64_t* split_coffset_ptr, uint32_t* prev_isize_ptr) {
+  if (fseeko(ff, target_coffset, SEEK_SET)) {
+    return 0;
+  }
+  const uint32_t window_size = fread_unlocked(window, 1, kVcfRangeSplitWindow, ff);
+  if (window_size < 18) {
+    return 0;
+  }
+  uint32_t pos = 0;
+  while (pos < 65536) {
+    if ((pos + 18 > window_size) || (!IsBgzfHeader(&(window[pos])))) {
+      ++pos;
+      continue;
+    }
+    uint16_t bsize_minus1;
+    memcpy(&bsize_minus1, &(window[pos + 16]), 2);
+    const uint32_t next_pos = pos + bsize_minus1 + 1;
+    if ((bsize_minus1 < 25) || (next_pos + 18 > window_size) || (!IsBgzfHeader(&(window[next_pos])))) {
+      // A header match at the end of the file would mean there's nothing
+      // left to split off anyway.
+      ++pos;
+      continue;
+    }
+    memcpy(&bsize_minus1, &(window[next_pos + 16]), 2);
+    const uint32_t next_next_pos = next_pos + bsize_minus1 + 1;
+    if ((target_coffset + next_next_pos != file_size) && ((next_next_pos + 16 > window_size) || (!IsBgzfHeader(&(window[next_next_pos]))))) {
+      ++pos;
+      continue;
+    }
+    uint32_t isize;
+    memcpy(&isize, &(window[next_pos - 4]), 4);
+    if (!isize) {
+      // e.g. a flush block; look at the next one instead.
+      pos = next_pos;
+      continue;
+    }
+    *prev_coffset_ptr = target_coffset + pos;
+    *split_coffset_ptr = target_coffset + next_pos;
+    *prev_isize_ptr = isize;
+    return 1;
+  }
+  return 0;
+}
+
+// Tries to perform the VcfToPgen() scanning pass with VcfRangeScanMain()
+// workers.  ctx must be filled in apart from ranges and abort.  On success,
+// *scan_done_ptr is set to 1, *statsp is overwritten, contig names are
+// registered,
+// and base_chr_present, nonref_flags (if non-null) and
+// allele_idx_offsets[0..variant_ct) are filled.  Otherwise the caller should
+// perform the serial scan.  The only errors returned are the ones reported
+// while registering contig names, and thread-creation failure.
+static PglErr VcfRangeScanBgzf(uintptr_t header_line_ct, uint32_t header_max_line_blen, uintptr_t max_variant_ct, uint32_t max_thread_ct, VcfRangeScanCtx* ctx, ChrInfo* cip, uintptr_t* base_chr_present, uintptr_t* nonref_flags, uintptr_t* allele_idx_offsets, VcfScanStats* statsp, uint32_t* scan_done_ptr) {
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  FILE* vcffile = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  ThreadGroup tg;
+  PreinitThreads(&tg);
+  *scan_done_ptr = 0;
+  {
+    vcffile = fopen(ctx->vcfname, FOPEN_RB);
+    if ((!vcffile) || fseeko(vcffile, 0, SEEK_END)) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+    const int64_t file_size = ftello(vcffile);
+    if (file_size < 2 * kVcfRangeMinBytes) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+    uint32_t range_ct = MINV(max_thread_ct, S_CAST(uint64_t, file_size) / kVcfRangeMinBytes);
+    VcfRange* ranges = S_CAST(VcfRange*, bigstack_end_alloc(range_ct * sizeof(VcfRange)));
+    unsigned char* window;
+    if ((!ranges) || bigstack_end_alloc_uc(kVcfRangeSplitWindow, &window)) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+    ranges[0].read_coffset = 0;
+    ranges[0].skip_blen = 0;
+    uint64_t prev_split_coffset = 0;
+    uint32_t found_ct = 1;
+    for (uint32_t range_idx = 1; range_idx != range_ct; ++range_idx) {
+      const uint64_t target_coffset = (S_CAST(uint64_t, file_size) * range_idx) / range_ct;
+      uint64_t prev_coffset;
+      uint64_t split_coffset;
+      uint32_t prev_isize;
+      if ((target_coffset >= prev_split_coffset) && FindBgzfSplit(vcffile, file_size, target_coffset, window, &prev_coffset, &split_coffset, &prev_isize)) {
+        ranges[found_ct - 1].stop_coffset = split_coffset;
+        ranges[found_ct].read_coffset = prev_coffset;
+        ranges[found_ct].skip_blen = prev_isize;
+        ++found_ct;
+        prev_split_coffset = split_coffset;
+      }
+    }
+    ranges[found_ct - 1].stop_coffset = UINT64_MAX;
+    fclose(vcffile);
+    vcffile = nullptr;
+    BigstackEndReset(ranges);
+    range_ct = found_ct;
+    if (range_ct < 2) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+
+    // Leave at least half of the remaining workspace for allele_idx_offsets.
+    // Each range gets a decompression buffer, a text buffer (a quarter of the
+    // rest), a contig arena (1/16), and the variant record array.
+    const uintptr_t per_range_alloc = RoundDownPow2(bigstack_left() / (2 * range_ct), kCacheline);
+    if (per_range_alloc < 2 * kDecompressChunkSize) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+    const uintptr_t textbuf_alloc = RoundDownPow2(MINV((per_range_alloc - kDecompressChunkSize) / 4, kMaxLongLine), kCacheline);
+    const uintptr_t contig_arena_alloc = RoundDownPow2((per_range_alloc - kDecompressChunkSize) / 16, kCacheline);
+    const uintptr_t variant_rec_alloc = per_range_alloc - kDecompressChunkSize - textbuf_alloc - contig_arena_alloc;
+    if (textbuf_alloc < MAXV(4 * 65536, 2 * S_CAST(uintptr_t, header_max_line_blen))) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+    for (uint32_t range_idx = 0; range_idx != range_ct; ++range_idx) {
+      VcfRange* rp = &(ranges[range_idx]);
+      rp->in = S_CAST(unsigned char*, bigstack_end_alloc_raw(kDecompressChunkSize));
+      // Keep a vector's worth of slack at the end for the line scanners.
+      rp->textbuf = S_CAST(char*, bigstack_end_alloc_raw(textbuf_alloc));
+      rp->textbuf_size = textbuf_alloc - kBytesPerVec;
+      rp->contig_arena = S_CAST(unsigned char*, bigstack_end_alloc_raw(contig_arena_alloc));
+      rp->contig_arena_size = contig_arena_alloc;
+      rp->variant_recs = S_CAST(uint32_t*, bigstack_end_alloc_raw(variant_rec_alloc));
+      rp->variant_rec_capacity = variant_rec_alloc / sizeof(int32_t);
+    }
+    ctx->ranges = ranges;
+    ctx->abort = 0;
+    if (SetThreadCt(range_ct - 1, &tg)) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+    SetThreadFuncAndData(VcfRangeScanThread, ctx, &tg);
+    DeclareLastThreadBlock(&tg);
+    if (unlikely(SpawnThreads(&tg))) {
+      goto VcfRangeScanBgzf_ret_THREAD_CREATE_FAIL;
+    }
+    VcfRangeScanMain(range_ct - 1, ctx);
+    JoinThreads(&tg);
+    if (ctx->abort) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+
+    // Header lines must all be at the start of the file, and agree with what
+    // the caller saw.
+    uintptr_t line_ct = 0;
+    uintptr_t header_line_ct_seen = 0;
+    uintptr_t variant_ct = 0;
+    for (uint32_t range_idx = 0; range_idx != range_ct; ++range_idx) {
+      const VcfRange* rp = &(ranges[range_idx]);
+      if (rp->header_line_ct && (header_line_ct_seen != line_ct)) {
+        goto VcfRangeScanBgzf_ret_1;
+      }
+      header_line_ct_seen += rp->header_line_ct;
+      line_ct += rp->line_ct;
+      variant_ct += rp->stats.variant_ct;
+    }
+    if ((header_line_ct_seen != header_line_ct) || (variant_ct > max_variant_ct) || ((variant_ct + 1) * sizeof(intptr_t) > bigstack_left())) {
+      goto VcfRangeScanBgzf_ret_1;
+    }
+
+    // Register contig names in file order, as the serial scan would.
+    line_ct = 0;
+    for (uint32_t range_idx = 0; range_idx != range_ct; ++range_idx) {
+      const VcfRange* rp = &(ranges[range_idx]);
+      unsigned char* contig_arena_iter = rp->contig_arena;
+      unsigned char* contig_arena_end = &(contig_arena_iter[rp->contig_arena_used]);
+      while (contig_arena_iter != contig_arena_end) {
+        const VcfRangeContig* cur_contig = R_CAST(const VcfRangeContig*, contig_arena_iter);
+        const uint32_t name_slen = cur_contig->name_slen;
+        char* name = R_CAST(char*, contig_arena_iter + sizeof(VcfRangeContig));
+        contig_arena_iter = &(contig_arena_iter[RoundUpPow2(sizeof(VcfRangeContig) + name_slen + 1, sizeof(intptr_t))]);
+        uint32_t chr_code;
+        reterr = GetOrAddChrCodeDestructive("--vcf file", line_ct + cur_contig->line_idx, ctx->prohibit_extra_chr, name, &(name[name_slen]), cip, &chr_code);
+        if (unlikely(reterr)) {
+          goto VcfRangeScanBgzf_ret_1;
+        }
+        const uint32_t is_kept = IsSet(cip->chr_mask, chr_code);
+        if (is_kept != cur_contig->is_kept) {
+          // shouldn't happen; let the serial scan sort it out
+          goto VcfRangeScanBgzf_ret_1;
+        }
+        if (is_kept && (chr_code <= cip->max_code)) {
+          SetBit(chr_code, base_chr_present);
+        }
+      }
+      line_ct += rp->line_ct;
+    }
+
+    if (nonref_flags) {
+      ZeroWArr(BitCtToWordCt(variant_ct), nonref_flags);
+    }
+    uintptr_t allele_idx_end = 0;
+    uint32_t variant_idx = 0;
+    VcfScanStats* first_statsp = &(ranges[0].stats);
+    *statsp = *first_statsp;
+    statsp->max_line_blen = MAXV(statsp->max_line_blen, header_max_line_blen);
+    for (uint32_t range_idx = 0; range_idx != range_ct; ++range_idx) {
+      const VcfRange* rp = &(ranges[range_idx]);
+      const VcfScanStats* cur_statsp = &(rp->stats);
+      const uint32_t* variant_recs = rp->variant_recs;
+      const uint32_t cur_variant_ct = cur_statsp->variant_ct;
+      for (uint32_t uii = 0; uii != cur_variant_ct; ++uii, ++variant_idx) {
+        const uint32_t variant_rec = variant_recs[uii];
+        allele_idx_offsets[variant_idx] = allele_idx_end;
+        allele_idx_end += (variant_rec & 0x7fffffff) + 1;
+        if (variant_rec & 0x80000000U) {
+          SetBit(variant_idx, nonref_flags);
+        }
+      }
+      if (!range_idx) {
+        continue;
+      }
+      statsp->variant_skip_ct += cur_statsp->variant_skip_ct;
+      if (cur_statsp->max_postformat_blen > statsp->max_postformat_blen) {
+        statsp->max_postformat_blen = cur_statsp->max_postformat_blen;
+      }
+      statsp->variant_ct += cur_variant_ct;
+      if (cur_statsp->max_line_blen > statsp->max_line_blen) {
+        statsp->max_line_blen = cur_statsp->max_line_blen;
+      }
+      if (cur_statsp->max_alt_ct > statsp->max_alt_ct) {
+        statsp->max_alt_ct = cur_statsp->max_alt_ct;
+      }
+      if (cur_statsp->max_allele_slen > statsp->max_allele_slen) {
+        statsp->max_allele_slen = cur_statsp->max_allele_slen;
+      }
+      if (cur_statsp->max_qualfilterinfo_slen > statsp->max_qualfilterinfo_slen) {
+        statsp->max_qualfilterinfo_slen = cur_statsp->max_qualfilterinfo_slen;
+      }
+      statsp->phase_or_dosage_found |= cur_statsp->phase_or_dosage_found;
+      statsp->not_single_sample_no_nonvar |= cur_statsp->not_single_sample_no_nonvar;
+      statsp->nonvar_nonmissing_ct += cur_statsp->nonvar_nonmissing_ct;
+    }
+    statsp->allele_idx_end = allele_idx_end;
+    snprintf(g_logbuf, kLogbufSize, "--vcf: Scanning pass split across %u byte ranges.\n", range_ct);
+    logputs_silent(g_logbuf);
+    *scan_done_ptr = 1;
+  }
+  while (0) {
+  VcfRangeScanBgzf_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  }
+ VcfRangeScanBgzf_ret_1:
+  if (vcffile) {
+    fclose(vcffile);
+  }
+  CleanupThreads(&tg);
+  BigstackEndReset(bigstack_end_mark);
+  return reterr;
+}
+
 static const char kGpText[] = "GP";
 
 // pgen_generated and psam_generated assumed to be initialized to 1.
 static_assert(!kVcfHalfCallReference, "VcfToPgen() assumes kVcfHalfCallReference == 0.");
 static_assert(kVcfHalfCallHaploid == 1, "VcfToPgen() assumes kVcfHalfCallHaploid == 1.");
-PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const char* const_fid, const char* dosage_import_field, MiscFlags misc_flags, ImportFlags import_flags, uint32_t no_samples_ok, uint32_t is_update_sex, uint32_t is_splitpar, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, double import_dosage_certainty, char id_delim, char idspace_to, int32_t vcf_min_gq, int32_t vcf_min_dp, int32_t vcf_max_dp, VcfHalfCall halfcall_mode, FamCol fam_cols, uint32_t import_max_allele_ct, uint32_t max_thread_ct, char* outname, char* outname_end, ChrInfo* cip, uint32_t* pgen_generated_ptr, uint32_t* psam_generated_ptr) {
+PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const char* const_fid, const char* dosage_import_field, MiscFlags misc_flags, ImportFlags import_flags, uint32_t no_samples_ok, uint32_t is_update_sex, uint32_t is_splitpar, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, double import_dosage_certainty, char id_delim, char idspace_to, int32_t vcf_min_gq, int32_t vcf_min_dp, int32_t vcf_max_dp, VcfHalfCall halfcall_mode, FamCol fam_cols, uint32_t import_max_allele_ct, int32_t from_bp, int32_t to_bp, uint32_t max_thread_ct, char* outname, char* outname_end, ChrInfo* cip, uint32_t* pgen_generated_ptr, uint32_t* psam_generated_ptr) {
   // Performs a 2-pass load.  Probably staying that way after sequential writer
   // is implemented since header lines are a pain.
   //
@@ -2742,6 +4171,10 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
   unsigned char* bigstack_end_mark = g_bigstack_end;
   char* pvar_cswritep = nullptr;
   uintptr_t line_idx = 1;
+  // Nonzero iff .tbi/.csi seeks are in use, in which case line_idx counts only
+  // the lines actually read, and this is the header line count.
+  uintptr_t idx_line_idx_base = 0;
+  char line_descrip[kVcfErrLineDescripBlen];
   const uint32_t half_call_explicit_error = (halfcall_mode == kVcfHalfCallError);
   PglErr reterr = kPglRetSuccess;
   VcfParseErr vcf_parse_err = kVcfParseOk;
@@ -2759,10 +4192,9 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
     if (StandardizeMaxLineBlen(bigstack_left() / 4, &max_line_blen)) {
       goto VcfToPgen_ret_NOMEM;
     }
-    // probable todo: if chromosome filter specified, take advantage of an
-    // index file with the standard extension if it's present.  (The index
-    // reader can be very simple since *only* chromosome filters are supported
-    // by import functions.)  Do the same for .bgen and .bcf files.
+    // If a chromosome filter is specified, and a .tbi/.csi index is present,
+    // we jump straight to the retained contigs' records (see
+    // LoadBgzfIdx()).
 
     reterr = ForceNonFifo(vcfname);
     if (unlikely(reterr)) {
@@ -3061,6 +4493,48 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
     // bugfix (5 Jun 2018): must initialize qual_field_ct to zero
     vic.vibc.qual_field_ct = 0;
 
+    BgzfIdxCursor idx_cursor;
+    idx_cursor.run_ct = 0;
+    if (TextIsBgzf(&vcf_txs)) {
+      unsigned char* bigstack_end_mark2 = g_bigstack_end;
+      char idx_fname[kPglFnamesize];
+      BgzfIdxContig* idx_contigs;
+      uint32_t idx_contig_ct;
+      reterr = LoadBgzfIdx(vcfname, "--vcf", 1, 1, from_bp, to_bp, idx_fname, &idx_contigs, &idx_contig_ct);
+      if (unlikely(reterr)) {
+        goto VcfToPgen_ret_1;
+      }
+      if (idx_contig_ct) {
+        uintptr_t* keep_contigs;
+        if (unlikely(bigstack_end_calloc_w(BitCtToWordCt(idx_contig_ct), &keep_contigs))) {
+          goto VcfToPgen_ret_NOMEM;
+        }
+        uint32_t keep_ct = 0;
+        for (uint32_t contig_idx = 0; contig_idx != idx_contig_ct; ++contig_idx) {
+          if (ChrNameMayBeKept(cip, idx_contigs[contig_idx].name, idx_contigs[contig_idx].name_slen, prohibit_extra_chr)) {
+            SetBit(contig_idx, keep_contigs);
+            ++keep_ct;
+          }
+        }
+        if (keep_ct) {
+          uint32_t range_used;
+          reterr = InitBgzfIdxRuns(idx_contigs, keep_contigs, idx_contig_ct, to_bp, &idx_cursor, &range_used);
+          if (unlikely(reterr)) {
+            goto VcfToPgen_ret_1;
+          }
+          if (idx_cursor.run_ct) {
+            if (keep_ct != idx_contig_ct) {
+              logprintfww("--vcf: Using %s to skip %u of %u contig%s.\n", idx_fname, idx_contig_ct - keep_ct, idx_contig_ct, (idx_contig_ct == 1)? "" : "s");
+            }
+            if (range_used) {
+              logprintfww("--vcf: Using %s to restrict import to the --from-bp/--to-bp range.\n", idx_fname);
+            }
+          }
+        }
+      }
+      BigstackEndReset(bigstack_end_mark2);
+    }
+
     uint32_t variant_ct = 0;
     uintptr_t max_variant_ct = bigstack_left() / sizeof(intptr_t);
     if (info_pr_exists) {
@@ -3076,6 +4550,9 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
     ZeroWArr(kChrExcludeWords, base_chr_present);
 
     const uintptr_t header_line_ct = line_idx;
+    if (idx_cursor.run_ct) {
+      idx_line_idx_base = header_line_ct;
+    }
     const uint32_t max_variant_ctaw = BitCtToAlignedWordCt(max_variant_ct);
     // don't need dosage_flags or dphase_flags; dosage overrides GT so slow
     // parse needed
@@ -3085,16 +4562,47 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
     }
     uintptr_t* nonref_flags_iter = nonref_flags;
     uintptr_t* allele_idx_offsets = R_CAST(uintptr_t*, g_bigstack_base);
-    uintptr_t max_postformat_blen = 1;  // starting from tab at end of FORMAT
-    uintptr_t variant_skip_ct = 0;
     uintptr_t nonref_word = 0;
-    uintptr_t allele_idx_end = 0;
-    uint32_t max_alt_ct = 1;
-    uint32_t max_allele_slen = 1;
-    uint32_t max_qualfilterinfo_slen = 6;
-    uint32_t phase_or_dosage_found = 0;
-    uint32_t not_single_sample_no_nonvar = (sample_ct != 1) || format_dosage_relevant || format_hds_search || (import_flags & kfImportVcfAllowNoNonvar);
-    uint32_t nonvar_nonmissing_ct = 0;
+    VcfScanParams scan_params;
+    scan_params.dosage_import_field = dosage_import_field;
+    STD_ARRAY_COPY(ctx.qual_mins, 2, scan_params.qual_mins);
+    STD_ARRAY_COPY(ctx.qual_maxs, 2, scan_params.qual_maxs);
+    scan_params.vcf_min_gq = vcf_min_gq;
+    scan_params.vcf_min_dp = vcf_min_dp;
+    scan_params.vcf_max_dp = vcf_max_dp;
+    scan_params.dosage_import_field_slen = dosage_import_field_slen;
+    scan_params.import_max_allele_ct = import_max_allele_ct;
+    scan_params.require_gt = require_gt;
+    scan_params.format_dosage_relevant = format_dosage_relevant;
+    scan_params.format_hds_search = format_hds_search;
+    scan_params.format_gq_or_dp_relevant = format_gq_or_dp_relevant;
+    VcfScanStats scan_stats;
+    InitVcfScanStats((sample_ct != 1) || format_dosage_relevant || format_hds_search || (import_flags & kfImportVcfAllowNoNonvar), &scan_stats);
+
+    if (TextIsBgzf(&vcf_txs) && (!idx_cursor.run_ct) && (max_thread_ct > 1)) {
+      VcfRangeScanCtx range_ctx;
+      range_ctx.vcfname = vcfname;
+      range_ctx.cip = cip;
+      range_ctx.params = scan_params;
+      range_ctx.vic = vic;
+      range_ctx.prohibit_extra_chr = prohibit_extra_chr;
+      range_ctx.info_pr_exists = info_pr_exists;
+      range_ctx.not_single_sample_no_nonvar = scan_stats.not_single_sample_no_nonvar;
+      uint32_t range_scan_done;
+      reterr = VcfRangeScanBgzf(header_line_ct, max_line_blen, max_variant_ct, max_thread_ct, &range_ctx, cip, base_chr_present, nonref_flags, allele_idx_offsets, &scan_stats, &range_scan_done);
+      if (unlikely(reterr)) {
+        goto VcfToPgen_ret_1;
+      }
+      if (range_scan_done) {
+        variant_ct = scan_stats.variant_ct;
+        max_line_blen = scan_stats.max_line_blen;
+        if (nonref_flags && (variant_ct % kBitsPerWord)) {
+          nonref_flags_iter = &(nonref_flags[variant_ct / kBitsPerWord]);
+          nonref_word = *nonref_flags_iter;
+        }
+        goto VcfToPgen_linescan_finished;
+      }
+    }
 
     while (1) {
       ++line_idx;
@@ -3103,7 +4611,11 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
       if (prev_line_blen > max_line_blen) {
         max_line_blen = prev_line_blen;
       }
-      reterr = TextNextLineUnsafe(&vcf_txs, &line_iter);
+      if (!idx_cursor.run_ct) {
+        reterr = TextNextLineUnsafe(&vcf_txs, &line_iter);
+      } else {
+        reterr = BgzfIdxNextLineUnsafe(&idx_cursor, &vcf_txs, &line_iter);
+      }
       if (reterr) {
         if (likely(reterr == kPglRetEof)) {
           // reterr = kPglRetSuccess;
@@ -3112,144 +4624,44 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
         goto VcfToPgen_ret_TSTREAM_FAIL;
       }
       prev_line_start = line_iter;
-      // we were previously tolerating trailing newlines here, but there wasn't
-      // a good reason for doing so.
-      if (unlikely(ctou32(*line_iter) <= 32)) {
-        if ((*line_iter == ' ') || (*line_iter == '\t')) {
-          snprintf(g_logbuf, kLogbufSize, "Error: Leading space or tab on line %" PRIuPTR " of --vcf file.\n", line_idx);
-          goto VcfToPgen_ret_MALFORMED_INPUT_2N;
-        }
-        goto VcfToPgen_ret_MISSING_TOKENS;
-      }
-      linebuf_iter = line_iter;
-      char* chr_code_end = NextPrespace(line_iter);
-      if (unlikely(*chr_code_end != '\t')) {
-        goto VcfToPgen_ret_MISSING_TOKENS;
-      }
-      // QUAL/FILTER enforcement is now postponed till .pvar loading.  only
-      // other things we do during the scanning pass are (i) count alt alleles,
-      // and (ii) check whether any phased genotype calls are present.
-
-      char* pos_end = NextPrespace(chr_code_end);
-      if (unlikely(*pos_end != '\t')) {
-        goto VcfToPgen_ret_MISSING_TOKENS;
-      }
-
-      // may as well check ID length here
-      // postpone POS validation till second pass so we only have to parse it
-      // once
-      char* id_end = NextPrespace(pos_end);
-      if (unlikely(*id_end != '\t')) {
-        goto VcfToPgen_ret_MISSING_TOKENS;
-      }
-      if (unlikely(S_CAST(uintptr_t, id_end - pos_end) > kMaxIdBlen)) {
-        snprintf(g_logbuf, kLogbufSize, "Error: Invalid ID on line %" PRIuPTR " of --vcf file (max " MAX_ID_SLEN_STR " chars).\n", line_idx);
-        goto VcfToPgen_ret_MALFORMED_INPUT_WWN;
-      }
-
-      // note REF length
-      char* ref_allele_start = &(id_end[1]);
-      linebuf_iter = FirstPrespace(ref_allele_start);
-      if (unlikely(*linebuf_iter != '\t')) {
-        goto VcfToPgen_ret_MISSING_TOKENS;
-      }
-      uint32_t cur_max_allele_slen = linebuf_iter - ref_allele_start;
-      if (unlikely(memchr(ref_allele_start, ',', cur_max_allele_slen) != nullptr)) {
-        snprintf(g_logbuf, kLogbufSize, "Error: Invalid REF allele on line %" PRIuPTR " of --vcf file.\n", line_idx);
-        goto VcfToPgen_ret_MALFORMED_INPUT_WWN;
-      }
-
-      uint32_t alt_ct = 1;
-      unsigned char ucc;
-      // treat ALT=. as if it were an actual allele for now
-      for (; ; ++alt_ct) {
-        char* cur_allele_start = ++linebuf_iter;
-        ucc = *linebuf_iter;
-        if (unlikely((ucc <= ',') && (ucc != '*'))) {
-          snprintf(g_logbuf, kLogbufSize, "Error: Invalid alternate allele on line %" PRIuPTR " of --vcf file.\n", line_idx);
-          goto VcfToPgen_ret_MALFORMED_INPUT_2N;
-        }
-        do {
-          ucc = *(++linebuf_iter);
-          // allow GATK 3.4 <*:DEL> symbolic allele
-        } while ((ucc > ',') || (ucc == '*'));
-        const uint32_t cur_allele_slen = linebuf_iter - cur_allele_start;
-        if (cur_allele_slen > cur_max_allele_slen) {
-          cur_max_allele_slen = cur_allele_slen;
-        }
-        if (ucc != ',') {
-          break;
-        }
-      }
-
-      if (unlikely(ucc != '\t')) {
-        snprintf(g_logbuf, kLogbufSize, "Error: Malformed ALT field on line %" PRIuPTR " of --vcf file.\n", line_idx);
-        goto VcfToPgen_ret_MALFORMED_INPUT_2N;
-      }
-      if (alt_ct > max_alt_ct) {
-        if (alt_ct >= import_max_allele_ct) {
-          ++variant_skip_ct;
-          line_iter = linebuf_iter;
-          continue;
-        }
-        max_alt_ct = alt_ct;
-      }
-
-      // skip QUAL, FILTER
-      char* qual_start_m1 = linebuf_iter;
-      for (uint32_t uii = 0; uii != 2; ++uii) {
-        linebuf_iter = NextPrespace(linebuf_iter);
-        if (unlikely(*linebuf_iter != '\t')) {
-          goto VcfToPgen_ret_MISSING_TOKENS;
-        }
+      VcfScanLine sl;
+      if (unlikely(VcfScanLineHead(&scan_params, line_iter, &vic, &scan_stats, &sl, &vcf_parse_err))) {
+        goto VcfToPgen_ret_PARSE;
       }
-
-      // --vcf-require-gt
-      char* info_start = &(linebuf_iter[1]);
-      char* info_end = FirstPrespace(info_start);
-      if (sample_ct) {
-        if (unlikely(*info_end != '\t')) {
-          goto VcfToPgen_ret_MISSING_TOKENS;
-        }
-        linebuf_iter = &(info_end[1]);
-        vic.vibc.gt_exists = memequal_sk(linebuf_iter, "GT") && ((linebuf_iter[2] == ':') || (linebuf_iter[2] == '\t'));
-        if (require_gt && (!vic.vibc.gt_exists)) {
-          ++variant_skip_ct;
-          line_iter = linebuf_iter;
-          continue;
-        }
+      if (!sl.alt_ct) {
+        line_iter = sl.chr_code_end;
+        continue;
       }
-      const uint32_t cur_qualfilterinfo_slen = info_end - qual_start_m1;
 
       // all converters *do* respect chromosome filters
       // wait till this point to apply it, since we don't want to
       // add a contig name to the hash table unless at least one variant on
       // that contig wasn't filtered out for other reasons.
       uint32_t cur_chr_code;
-      reterr = GetOrAddChrCodeDestructive("--vcf file", line_idx, prohibit_extra_chr, line_iter, chr_code_end, cip, &cur_chr_code);
+      reterr = GetOrAddChrCodeDestructive("--vcf file", idx_line_idx_base? 0 : line_idx, prohibit_extra_chr, line_iter, sl.chr_code_end, cip, &cur_chr_code);
       if (unlikely(reterr)) {
         goto VcfToPgen_ret_1;
       }
       if (!IsSet(cip->chr_mask, cur_chr_code)) {
-        ++variant_skip_ct;
-        line_iter = info_end;
+        ++scan_stats.variant_skip_ct;
+        line_iter = sl.info_end;
         continue;
       }
-      if (cur_max_allele_slen > max_allele_slen) {
-        max_allele_slen = cur_max_allele_slen;
+      if (sl.max_allele_slen > scan_stats.max_allele_slen) {
+        scan_stats.max_allele_slen = sl.max_allele_slen;
       }
-      if (cur_qualfilterinfo_slen > max_qualfilterinfo_slen) {
-        max_qualfilterinfo_slen = cur_qualfilterinfo_slen;
+      if (sl.qualfilterinfo_slen > scan_stats.max_qualfilterinfo_slen) {
+        scan_stats.max_qualfilterinfo_slen = sl.qualfilterinfo_slen;
       }
       if (cur_chr_code <= cip->max_code) {
         SetBit(cur_chr_code, base_chr_present);
       }
 
-      allele_idx_offsets[variant_ct] = allele_idx_end;
-      allele_idx_end += alt_ct + 1;
+      allele_idx_offsets[variant_ct] = scan_stats.allele_idx_end;
+      scan_stats.allele_idx_end += sl.alt_ct + 1;
       const uint32_t variant_idx_lowbits = variant_ct % kBitsPerWord;
       if (info_pr_exists) {
-        if (PrInInfo(info_end - info_start, info_start)) {
+        if (PrInInfo(sl.info_end - sl.info_start, sl.info_start)) {
           nonref_word |= k1LU << variant_idx_lowbits;
         }
         if (variant_idx_lowbits == (kBitsPerWord - 1)) {
@@ -3258,77 +4670,11 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
         }
       }
       if (sample_ct) {
-        // linebuf_iter currently points to beginning of FORMAT field
-        const char* format_end = FirstPrespace(linebuf_iter);
-        if (unlikely(*format_end != '\t')) {
-          goto VcfToPgen_ret_MISSING_TOKENS;
-        }
-        if (phase_or_dosage_found && not_single_sample_no_nonvar) {
-          goto VcfToPgen_linescan_done;
-        }
-
-        if (format_dosage_relevant) {
-          vic.dosage_field_idx = GetVcfFormatPosition(dosage_import_field, linebuf_iter, format_end, dosage_import_field_slen);
-        }
-        if (format_hds_search) {
-          // theoretically possible for HDS to be in VCF header without
-          // accompanying DS
-          vic.hds_field_idx = GetVcfFormatPosition("HDS", linebuf_iter, format_end, 3);
-        }
-        if (format_gq_or_dp_relevant) {
-          STD_ARRAY_DECL(uint32_t, 2, qual_field_idxs);
-          uint32_t qual_field_ct = VcfQualScanInit1(linebuf_iter, format_end, vcf_min_gq, vcf_min_dp, vcf_max_dp, qual_field_idxs);
-          // bugfix (5 Jun 2018): must initialize qual_field_ct to zero
-          vic.vibc.qual_field_ct = 0;
-          if (qual_field_ct) {
-            vic.vibc.qual_field_ct = VcfQualScanInit2(qual_field_idxs, ctx.qual_mins, ctx.qual_maxs, vic.vibc.qual_field_skips, vic.vibc.qual_line_mins, vic.vibc.qual_line_maxs);
-          }
-        }
-
-        // Check if there's at least one phased het call, and/or at least one
-        // relevant dosage.
-        // If there's only one sample, maybe also check whether the VCF has any
-        // hom-REF calls at all.
-        // Don't bother multithreading this since it's trivial.
-        if ((vic.hds_field_idx != UINT32_MAX) || (vic.dosage_field_idx != UINT32_MAX)) {
-          if (alt_ct == 1) {
-            vcf_parse_err = VcfScanBiallelicHdsLine(&vic, format_end, &phase_or_dosage_found, &line_iter);
-          } else {
-            putc_unlocked('\n', stdout);
-            logerrputs("Error: --vcf multiallelic dosage import is under development.\n");
-            reterr = kPglRetNotYetSupported;
-            goto VcfToPgen_ret_1;
-          }
-          if (unlikely(vcf_parse_err)) {
-            goto VcfToPgen_ret_PARSE;
-          }
-        } else {
-          if (!vic.vibc.gt_exists) {
-            goto VcfToPgen_linescan_done;
-          }
-          if (!not_single_sample_no_nonvar) {
-            if (format_end[1] == '0') {
-              const char cc = format_end[2];
-              not_single_sample_no_nonvar = (((cc == '/') || (cc == '|')) && (format_end[3] == '0')) || (cc == ':') || (cc == '\t');
-            }
-            // This can miss ./0 and the like, but that should practically
-            // never matter.
-            nonvar_nonmissing_ct += (format_end[1] != '.');
-          }
-          if (!phase_or_dosage_found) {
-            if (alt_ct < 10) {
-              phase_or_dosage_found = VcfScanShortallelicLine(&(vic.vibc), format_end, &line_iter);
-            } else {
-              phase_or_dosage_found = VcfScanLongallelicLine(&(vic.vibc), format_end, &line_iter);
-            }
-          }
-        }
-      VcfToPgen_linescan_done:
-        line_iter = AdvToDelim(line_iter, '\n');
-        const uint32_t cur_postformat_slen = line_iter - format_end;
-        if (cur_postformat_slen >= max_postformat_blen) {
-          max_postformat_blen = cur_postformat_slen + 1;
+        if (unlikely(VcfScanLineTail(&scan_params, &sl, &vic, &scan_stats, &line_iter, &vcf_parse_err))) {
+          goto VcfToPgen_ret_PARSE;
         }
+      } else {
+        line_iter = sl.info_end;
       }
       if (unlikely(variant_ct++ == max_variant_ct)) {
 #ifdef __LP64__
@@ -3345,6 +4691,16 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
         fflush(stdout);
       }
     }
+  VcfToPgen_linescan_finished:
+    const uintptr_t variant_skip_ct = scan_stats.variant_skip_ct;
+    const uintptr_t max_postformat_blen = scan_stats.max_postformat_blen;
+    const uintptr_t allele_idx_end = scan_stats.allele_idx_end;
+    const uint32_t max_alt_ct = scan_stats.max_alt_ct;
+    const uint32_t max_allele_slen = scan_stats.max_allele_slen;
+    const uint32_t max_qualfilterinfo_slen = scan_stats.max_qualfilterinfo_slen;
+    const uint32_t phase_or_dosage_found = scan_stats.phase_or_dosage_found;
+    const uint32_t not_single_sample_no_nonvar = scan_stats.not_single_sample_no_nonvar;
+    const uint32_t nonvar_nonmissing_ct = scan_stats.nonvar_nonmissing_ct;
     if (variant_ct % kBitsPerWord) {
       if (nonref_flags_iter) {
         *nonref_flags_iter = nonref_word;
@@ -3397,6 +4753,10 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
       if (unlikely(reterr)) {
         goto VcfToPgen_ret_TSTREAM_FAIL;
       }
+      if (idx_cursor.run_ct) {
+        idx_cursor.run_idx = 0;
+        idx_cursor.seek_pending = 1;
+      }
       if (calc_thread_ct + decompress_thread_ct > max_thread_ct) {
         calc_thread_ct = MAXV(1, max_thread_ct - decompress_thread_ct);
       }
@@ -3770,7 +5130,11 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
           line_iter = AdvPastDelim(line_iter, '\n');
           // In principle, it shouldn't be necessary to check the exact value
           // of reterr, but this may be useful for bug investigation.
-          reterr = TextNextLineUnsafe(&vcf_txs, &line_iter);
+          if (!idx_cursor.run_ct) {
+            reterr = TextNextLineUnsafe(&vcf_txs, &line_iter);
+          } else {
+            reterr = BgzfIdxNextLineUnsafe(&idx_cursor, &vcf_txs, &line_iter);
+          }
           if (unlikely(reterr)) {
             goto VcfToPgen_ret_TSTREAM_FAIL;
           }
@@ -3848,7 +5212,8 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
           // make sure POS starts with an integer, apply --output-chr setting
           uint32_t cur_bp;
           if (unlikely(ScanUintDefcap(pos_str, &cur_bp))) {
-            snprintf(g_logbuf, kLogbufSize, "Error: Invalid POS on line %" PRIuPTR " of --vcf file.\n", line_idx);
+            VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+            snprintf(g_logbuf, kLogbufSize, "Error: Invalid POS on %s.\n", line_descrip);
             goto VcfToPgen_ret_MALFORMED_INPUT_2N;
           }
 
@@ -3891,7 +5256,8 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
             // VCF specification permits whitespace in INFO field, while PVAR
             // does not.  Check for whitespace and error out if necessary.
             if (unlikely(memchr(filter_end, ' ', info_end - filter_end))) {
-              snprintf(g_logbuf, kLogbufSize, "Error: INFO field on line %" PRIuPTR " of --vcf file contains a space; this cannot be imported by " PROG_NAME_STR ". Remove or reformat the field before reattempting import.\n", line_idx);
+              VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+              snprintf(g_logbuf, kLogbufSize, "Error: INFO field on %s contains a space; this cannot be imported by " PROG_NAME_STR ". Remove or reformat the field before reattempting import.\n", line_descrip);
               goto VcfToPgen_ret_MALFORMED_INPUT_WWN;
             }
             pvar_cswritep = memcpya(pvar_cswritep, linebuf_iter, info_end - linebuf_iter);
@@ -3930,7 +5296,8 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
               if (unlikely(fail_on_ds_only && (!vic.vibc.gt_exists) && (vic.dosage_field_idx != UINT32_MAX) && (vic.hds_field_idx == UINT32_MAX))) {
                 // could allow the chrX all-female case, but let's keep this
                 // simple for now
-                snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of --vcf file is for a chrX, chrM, or fully-haploid variant, and has a DS field without a companion GT field to clarify whether each DS value is on a 0..1 or 0..2 scale. This cannot be imported by " PROG_NAME_STR "; please e.g. regenerate the file with GT present.\n", line_idx);
+                VcfErrLineDescrip(line_idx, idx_line_idx_base, 1, line_descrip);
+                snprintf(g_logbuf, kLogbufSize, "Error: %s is for a chrX, chrM, or fully-haploid variant, and has a DS field without a companion GT field to clarify whether each DS value is on a 0..1 or 0..2 scale. This cannot be imported by " PROG_NAME_STR "; please e.g. regenerate the file with GT present.\n", line_descrip);
                 goto VcfToPgen_ret_MALFORMED_INPUT_WWN;
               }
               gparse_flags = ((vic.dosage_field_idx != UINT32_MAX) || (vic.hds_field_idx != UINT32_MAX))? (kfGparseHphase | kfGparseDosage | kfGparseDphase) : kfGparseHphase;
@@ -4057,12 +5424,14 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
   VcfToPgen_ret_PARSE:
     if (vcf_parse_err == kVcfParseInvalidGt) {
       putc_unlocked('\n', stdout);
-      logerrprintf("Error: Line %" PRIuPTR " of --vcf file has an invalid GT field.\n", line_idx);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 1, line_descrip);
+      logerrprintf("Error: %s has an invalid GT field.\n", line_descrip);
       reterr = kPglRetMalformedInput;
       break;
     } else if (vcf_parse_err == kVcfParseHalfCallError) {
       putc_unlocked('\n', stdout);
-      logerrprintf("Error: Line %" PRIuPTR " of --vcf file has a GT half-call.\n", line_idx);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 1, line_descrip);
+      logerrprintf("Error: %s has a GT half-call.\n", line_descrip);
       if (!half_call_explicit_error) {
         logerrputs("Use --vcf-half-call to specify how these should be processed.\n");
       }
@@ -4072,18 +5441,56 @@ PglErr VcfToPgen(const char* vcfname, const char* preexisting_psamname, const ch
       // probable todo: distinguish HDS errors (right now, it just prints
       // "invalid DS field" on all HDS errors).
       putc_unlocked('\n', stdout);
-      logerrprintfww("Error: Line %" PRIuPTR " of --vcf file has an invalid %s field.\n", line_idx, dosage_import_field);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 1, line_descrip);
+      logerrprintfww("Error: %s has an invalid %s field.\n", line_descrip, dosage_import_field);
       reterr = kPglRetInconsistentInput;
       break;
     } else if (vcf_parse_err == kVcfParsePolyploidError) {
       putc_unlocked('\n', stdout);
-      logerrprintfww("Error: Line %" PRIuPTR " of --vcf file has a polyploid genotype.%s\n", line_idx, (import_flags & kfImportPolyploidExplicitError)? "" : " (Use '--polyploid-mode missing' to treat these as missing values.)");
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 1, line_descrip);
+      logerrprintfww("Error: %s has a polyploid genotype.%s\n", line_descrip, (import_flags & kfImportPolyploidExplicitError)? "" : " (Use '--polyploid-mode missing' to treat these as missing values.)");
       reterr = kPglRetInconsistentInput;
       break;
+    } else if (vcf_parse_err == kVcfParseLeadingSpace) {
+      putc_unlocked('\n', stdout);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+      logerrprintf("Error: Leading space or tab on %s.\n", line_descrip);
+      reterr = kPglRetMalformedInput;
+      break;
+    } else if (vcf_parse_err == kVcfParseLongId) {
+      putc_unlocked('\n', stdout);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+      logerrprintfww("Error: Invalid ID on %s (max " MAX_ID_SLEN_STR " chars).\n", line_descrip);
+      reterr = kPglRetMalformedInput;
+      break;
+    } else if (vcf_parse_err == kVcfParseInvalidRef) {
+      putc_unlocked('\n', stdout);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+      logerrprintfww("Error: Invalid REF allele on %s.\n", line_descrip);
+      reterr = kPglRetMalformedInput;
+      break;
+    } else if (vcf_parse_err == kVcfParseInvalidAlt) {
+      putc_unlocked('\n', stdout);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+      logerrprintf("Error: Invalid alternate allele on %s.\n", line_descrip);
+      reterr = kPglRetMalformedInput;
+      break;
+    } else if (vcf_parse_err == kVcfParseMalformedAlt) {
+      putc_unlocked('\n', stdout);
+      VcfErrLineDescrip(line_idx, idx_line_idx_base, 0, line_descrip);
+      logerrprintf("Error: Malformed ALT field on %s.\n", line_descrip);
+      reterr = kPglRetMalformedInput;
+      break;
+    } else if (vcf_parse_err == kVcfParseMultiallelicDosage) {
+      putc_unlocked('\n', stdout);
+      logerrputs("Error: --vcf multiallelic dosage import is under development.\n");
+      reterr = kPglRetNotYetSupported;
+      break;
     }
   VcfToPgen_ret_MISSING_TOKENS:
     putc_unlocked('\n', stdout);
-    logerrprintf("Error: Line %" PRIuPTR " of --vcf file has fewer tokens than expected.\n", line_idx);
+    VcfErrLineDescrip(line_idx, idx_line_idx_base, 1, line_descrip);
+    logerrprintf("Error: %s has fewer tokens than expected.\n", line_descrip);
     reterr = kPglRetMalformedInput;
     break;
   VcfToPgen_ret_MALFORMED_INPUT_2N:
@@ -7246,7 +8653,7 @@ THREAD_FUNC_DECL BcfGenoToPgenThread(void* raw_arg) {
 }
 
 // pgen_generated and psam_generated assumed to be initialized to 1.
-PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const char* const_fid, const char* dosage_import_field, MiscFlags misc_flags, ImportFlags import_flags, uint32_t no_samples_ok, uint32_t is_update_sex, uint32_t is_splitpar, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, double import_dosage_certainty, char id_delim, char idspace_to, int32_t vcf_min_gq, int32_t vcf_min_dp, int32_t vcf_max_dp, VcfHalfCall halfcall_mode, FamCol fam_cols, uint32_t import_max_allele_ct, uint32_t max_thread_ct, char* outname, char* outname_end, ChrInfo* cip, uint32_t* pgen_generated_ptr, uint32_t* psam_generated_ptr) {
+PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const char* const_fid, const char* dosage_import_field, MiscFlags misc_flags, ImportFlags import_flags, uint32_t no_samples_ok, uint32_t is_update_sex, uint32_t is_splitpar, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, double import_dosage_certainty, char id_delim, char idspace_to, int32_t vcf_min_gq, int32_t vcf_min_dp, int32_t vcf_max_dp, VcfHalfCall halfcall_mode, FamCol fam_cols, uint32_t import_max_allele_ct, int32_t from_bp, int32_t to_bp, uint32_t max_thread_ct, char* outname, char* outname_end, ChrInfo* cip, uint32_t* pgen_generated_ptr, uint32_t* psam_generated_ptr) {
   // Yes, lots of this is copied-and-pasted from VcfToPgen(), but there are
   // enough differences that I don't think trying to handle them with the same
   // function is wise.
@@ -7871,6 +9278,54 @@ PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const ch
     memcpy(contig_out_names, contig_names, contig_string_idx_end * sizeof(intptr_t));
     memcpy(contig_out_slens, contig_slens, contig_string_idx_end * sizeof(int32_t));
 
+    // See the corresponding VcfToPgen() code.  .csi indexes for BCF files
+    // don't store contig names; their reference indexes are contig dictionary
+    // indexes.
+    BgzfIdxCursor idx_cursor;
+    {
+      idx_cursor.run_ct = 0;
+      unsigned char* bigstack_end_mark_idx = g_bigstack_end;
+      char idx_fname[kPglFnamesize];
+      BgzfIdxContig* idx_contigs;
+      uint32_t idx_contig_ct;
+      reterr = LoadBgzfIdx(bcfname, "--bcf", 0, 0, from_bp, to_bp, idx_fname, &idx_contigs, &idx_contig_ct);
+      if (unlikely(reterr)) {
+        goto BcfToPgen_ret_1;
+      }
+      if (idx_contig_ct) {
+        uintptr_t* keep_contigs;
+        if (unlikely(bigstack_end_calloc_w(BitCtToWordCt(idx_contig_ct), &keep_contigs))) {
+          goto BcfToPgen_ret_NOMEM;
+        }
+        uint32_t keep_ct = 0;
+        for (uint32_t contig_idx = 0; contig_idx != idx_contig_ct; ++contig_idx) {
+          const uint32_t chrom = idx_contigs[contig_idx].ref_idx;
+          // Invalid and undeclared contigs are kept, so the main loop reports
+          // the same errors it would without the index.
+          if ((chrom >= contig_string_idx_end) || (!contig_slens[chrom]) || ChrNameMayBeKept(cip, contig_names[chrom], contig_slens[chrom], prohibit_extra_chr)) {
+            SetBit(contig_idx, keep_contigs);
+            ++keep_ct;
+          }
+        }
+        if (keep_ct) {
+          uint32_t range_used;
+          reterr = InitBgzfIdxRuns(idx_contigs, keep_contigs, idx_contig_ct, to_bp, &idx_cursor, &range_used);
+          if (unlikely(reterr)) {
+            goto BcfToPgen_ret_1;
+          }
+          if (idx_cursor.run_ct) {
+            if (keep_ct != idx_contig_ct) {
+              logprintfww("--bcf: Using %s to skip %u of %u contig%s.\n", idx_fname, idx_contig_ct - keep_ct, idx_contig_ct, (idx_contig_ct == 1)? "" : "s");
+            }
+            if (range_used) {
+              logprintfww("--bcf: Using %s to restrict import to the --from-bp/--to-bp range.\n", idx_fname);
+            }
+          }
+        }
+      }
+      BigstackEndReset(bigstack_end_mark_idx);
+    }
+
     unsigned char* bigstack_end_mark2 = g_bigstack_end;
     uintptr_t loadbuf_size = RoundDownPow2(bigstack_left() / 2, kEndAllocAlign);
 #ifdef __LP64__
@@ -7926,6 +9381,12 @@ PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const ch
     uint32_t par_warn_bcf_chrom = UINT32_MAX;
     while (1) {
       ++vrec_idx;  // 1-based since it's only used in error messages
+      if (idx_cursor.seek_pending) {
+        reterr = BcfIdxSeek(&idx_cursor, &bgzf, &bgzf_errmsg);
+        if (unlikely(reterr)) {
+          goto BcfToPgen_ret_BGZF_FAIL_N;
+        }
+      }
       unsigned char* loadbuf_read_iter = loadbuf;
       reterr = BgzfRawMtStreamRead(&(loadbuf[32]), &bgzf, &loadbuf_read_iter, &bgzf_errmsg);
       if (unlikely(reterr)) {
@@ -7940,6 +9401,16 @@ PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const ch
         goto BcfToPgen_ret_VREC_GENERIC;
       }
       const uint32_t* vrec_header = R_CAST(uint32_t*, loadbuf);
+      if (idx_cursor.run_ct && BcfIdxRunEnded(&(idx_cursor.runs[idx_cursor.run_idx]), vrec_header)) {
+        // End of the current run of retained contigs.  (vrec_idx is left
+        // one past the last record on the final run, as it is at eof.)
+        if (++idx_cursor.run_idx == idx_cursor.run_ct) {
+          break;
+        }
+        --vrec_idx;
+        idx_cursor.seek_pending = 1;
+        continue;
+      }
       // IMPORTANT: Official specification is wrong about the ordering of these
       // fields as of Feb 2020!!  The correct ordering can be inferred from
       // bcf_read1_core() in htslib vcf.c:
@@ -8380,6 +9851,10 @@ PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const ch
         goto BcfToPgen_ret_BGZF_FAIL;
       }
     }
+    if (idx_cursor.run_ct) {
+      idx_cursor.run_idx = 0;
+      idx_cursor.seek_pending = 1;
+    }
 
     uint32_t calc_thread_ct;
     // todo: tune this for BCF, these values were derived from VCF testing
@@ -8760,6 +10235,12 @@ PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const ch
         while (1) {
           {
             ++vrec_idx;
+            if (idx_cursor.seek_pending) {
+              reterr = BcfIdxSeek(&idx_cursor, &bgzf, &bgzf_errmsg);
+              if (unlikely(reterr)) {
+                goto BcfToPgen_ret_BGZF_FAIL_N;
+              }
+            }
             unsigned char* loadbuf_read_iter = loadbuf;
             reterr = BgzfRawMtStreamRead(&(loadbuf[32]), &bgzf, &loadbuf_read_iter, &bgzf_errmsg);
             if (unlikely(reterr)) {
@@ -8769,6 +10250,14 @@ PglErr BcfToPgen(const char* bcfname, const char* preexisting_psamname, const ch
               DPrintf("read only %" PRIdPTR " out of 32 initial bytes, vrec_idx=%" PRIuPTR "\n", loadbuf_read_iter - loadbuf, vrec_idx);
               goto BcfToPgen_ret_REWIND_FAIL_N;
             }
+            if (idx_cursor.run_ct && BcfIdxRunEnded(&(idx_cursor.runs[idx_cursor.run_idx]), R_CAST(uint32_t*, loadbuf))) {
+              --vrec_idx;
+              if (unlikely(++idx_cursor.run_idx == idx_cursor.run_ct)) {
+                goto BcfToPgen_ret_REWIND_FAIL_N;
+              }
+              idx_cursor.seek_pending = 1;
+              continue;
+            }
             // [0]: l_shared
             // [1]: l_indiv
             // [2]: chrom
@@ -12661,6 +14150,17 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
 
     const uint32_t snpid_chr = (oxford_import_flags & kfOxfordImportBgenSnpIdChr);
 
+    // With a chromosome filter and a .bgi index, both passes only read the
+    // runs of variants on retained chromosomes.
+    BgenIdxCursor idx_cursor;
+    idx_cursor.run_ct = 0;
+    if (chr_filter_exists && (!ox_single_chr_str) && (!snpid_chr)) {
+      reterr = LoadBgenIdx(bgenname, cip, initial_uints[0] + 4, header_variant_ct, prohibit_extra_chr, &idx_cursor);
+      if (unlikely(reterr)) {
+        goto OxBgenToPgen_ret_1;
+      }
+    }
+
     // true for both provisional-reference and real-reference second
     const uint32_t prov_ref_allele_second = !(oxford_import_flags & kfOxfordImportRefFirst);
 
@@ -12811,6 +14311,16 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
       unsigned char* bgen_geno_iter = compressed_geno_bufs[0];
       uint32_t skip = 0;
       for (uint32_t variant_uidx = 0; variant_uidx != header_variant_ct; ) {
+        if (idx_cursor.run_ct) {
+          reterr = BgenIdxNextVariant(&idx_cursor, bgenfile);
+          if (reterr) {
+            if (likely(reterr == kPglRetEof)) {
+              reterr = kPglRetSuccess;
+              break;
+            }
+            goto OxBgenToPgen_ret_READ_FAIL;
+          }
+        }
         uint32_t uii;
         {
           const uintptr_t bytes_read = fread_unlocked(&uii, 1, 4, bgenfile);
@@ -13018,6 +14528,7 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
       if (unlikely(fseeko(bgenfile, initial_uints[0] + 4, SEEK_SET))) {
         goto OxBgenToPgen_ret_READ_FAIL;
       }
+      BgenIdxRewind(&idx_cursor);
       snprintf(outname_end, kMaxOutfnameExtBlen, ".pgen");
       uintptr_t spgw_alloc_cacheline_ct;
       uint32_t max_vrec_len;
@@ -13059,6 +14570,11 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
           compressed_geno_starts = common.compressed_geno_starts[parity];
           bgen_geno_iter = compressed_geno_bufs[parity];
           for (block_vidx = 0; block_vidx != cur_block_write_ct; ) {
+            if (idx_cursor.run_ct) {
+              if (unlikely(BgenIdxNextVariant(&idx_cursor, bgenfile))) {
+                goto OxBgenToPgen_ret_READ_FAIL;
+              }
+            }
             uint32_t uii;
             if (unlikely(!fread_unlocked(&uii, 4, 1, bgenfile))) {
               goto OxBgenToPgen_ret_READ_FAIL;
@@ -13500,6 +15016,16 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
       uint32_t multiallelic_tmp_skip_ct = 0;
 
       for (uint32_t variant_uidx = 0; variant_uidx != header_variant_ct; ) {
+        if (idx_cursor.run_ct) {
+          reterr = BgenIdxNextVariant(&idx_cursor, bgenfile);
+          if (reterr) {
+            if (likely(reterr == kPglRetEof)) {
+              reterr = kPglRetSuccess;
+              break;
+            }
+            goto OxBgenToPgen_ret_READ_FAIL;
+          }
+        }
         // format is mostly identical to bgen 1.1; but there's no sample count,
         // and there is an allele count
         // logic is more similar to the second bgen 1.1 pass since we write the
@@ -13935,6 +15461,7 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
       if (unlikely(fseeko(bgenfile, initial_uints[0] + 4, SEEK_SET))) {
         goto OxBgenToPgen_ret_READ_FAIL;
       }
+      BgenIdxRewind(&idx_cursor);
       snprintf(outname_end, kMaxOutfnameExtBlen, ".pgen");
       uintptr_t spgw_alloc_cacheline_ct;
       uint32_t max_vrec_len;
@@ -14118,6 +15645,11 @@ PglErr OxBgenToPgen(const char* bgenname, const char* samplename, const char* co
               break;
             }
           OxBgenToPgen_load13_start:
+            if (idx_cursor.run_ct) {
+              if (unlikely(BgenIdxNextVariant(&idx_cursor, bgenfile))) {
+                goto OxBgenToPgen_ret_READ_FAIL;
+              }
+            }
             if (unlikely(!fread_unlocked(&snpid_slen, 2, 1, bgenfile))) {
               goto OxBgenToPgen_ret_READ_FAIL;
             }
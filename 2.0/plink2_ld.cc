@@ -7481,6 +7481,24 @@ static const double kClumpDefaultLnBinBounds[4] = {
 };
 
 static_assert(kClumpMaxBinBounds * (kMaxLnGSlen + 1) + 256 <= kMaxLongLine, "ClumpReports() needs to be updated.");
+void ClumpMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, uint32_t max_thread_ct, MemReq* mrp) {
+  const uint32_t calc_thread_ct = MAXV(1, max_thread_ct - 1);
+  const uintptr_t bitvec_byte_ct = BitCtToCachelineCt(sample_ct) * S_CAST(uintptr_t, kCacheline);
+  // hardcalls + phase; dosage-bearing datasets need more
+  const uintptr_t pgv_byte_stride = NypCtToCachelineCt(sample_ct) * S_CAST(uintptr_t, kCacheline) + 2 * bitvec_byte_ct;
+  const uintptr_t unpacked_byte_stride = RoundUpPow2(16 + 5 * bitvec_byte_ct, kCacheline);
+  const uintptr_t pgr_byte_ct = RoundUpPow2(sizeof(PgenReader), kCacheline) + EstimatePgrAllocByteCt(sample_ct);
+  const uint32_t min_pgv_per_thread = 1 + 4194303 / pgv_byte_stride;
+  const uint64_t per_thread_target_alloc = 2 * S_CAST(uint64_t, min_pgv_per_thread) * pgv_byte_stride + unpacked_byte_stride + pgr_byte_ct + WordCtToCachelineCt(min_pgv_per_thread + 1) * kCacheline;
+  // variant ID hash table gets at most half the workspace
+  const uint64_t base_byte_ct = 2 * S_CAST(uint64_t, variant_ct) * 4 * sizeof(int32_t) + pgr_byte_ct + 2 * unpacked_byte_stride;
+  mrp->min_byte_ct = base_byte_ct + 2 * per_thread_target_alloc;
+  // highmem mode wants a full Vblock in the multiread buffer, which can take
+  // up to 1/8 of what's left.
+  const uint64_t vblock_byte_ct = S_CAST(uint64_t, MINV(variant_ct, kPglVblockSize)) * record_byte_ct;
+  mrp->comfortable_byte_ct = base_byte_ct + calc_thread_ct * per_thread_target_alloc + 8 * vblock_byte_ct;
+}
+
 PglErr ClumpReports(const uintptr_t* orig_variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const uintptr_t* founder_info, const uintptr_t* sex_nm, const uintptr_t* sex_male, const ClumpInfo* clump_ip, uint32_t raw_variant_ct, uint32_t orig_variant_ct, uint32_t raw_sample_ct, uint32_t founder_ct, uint32_t nosex_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
@@ -879,12 +879,26 @@ typedef struct CalcKingSparseCtxStruct {
 
   // single global copy
   uint32_t* king_counts;
+  // CalcKingDenseThread()'s row partition; zero-initialization follows it so
+  // that each thread first-touches the part of king_counts it later updates.
+  const uint32_t* thread_start;
 
   uintptr_t** thread_sparse_excludes[2];
 
+  // When workers span multiple NUMA nodes, the first worker on each node
+  // claims and zero-fills chunks of that node's replica of the dense-phase
+  // genotype buffers, and sets its bit in numa_active_node_mask.
+  uintptr_t* node_smaj_bufs;
+  uintptr_t node_bufsizew;
+  uint32_t* node_touch_chunk_cts;
+  uint32_t numa_node_ct;
+  uint64_t numa_active_node_mask;
+
   uint64_t err_info;
 } CalcKingSparseCtx;
 
+CONSTI32(kKingNodeTouchChunkWords, 8192);
+
 THREAD_FUNC_DECL CalcKingSparseThread(void* raw_arg) {
   ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
   const uintptr_t tidx = arg->tidx;
@@ -931,14 +945,32 @@ THREAD_FUNC_DECL CalcKingSparseThread(void* raw_arg) {
   uint64_t new_err_info = 0;
   {
     // This matrix can be huge, so we multithread zero-initialization.
-    const uint64_t entry_ct = homhom_needed_p4 * (((sample_ct - 1) * S_CAST(uint64_t, sample_ct)) / 2 - tri_start);
-    const uintptr_t fill_start = RoundDownPow2((tidx * entry_ct) / calc_thread_ct, kInt32PerCacheline);
-    uintptr_t fill_end = entry_ct;
-    if (tidx + 1 != calc_thread_ct) {
-      fill_end = RoundDownPow2(((tidx + 1) * entry_ct) / calc_thread_ct, kInt32PerCacheline);
-    }
+    // Each thread clears exactly the rows it'll be incrementing in
+    // CalcKingDenseThread(), so on NUMA machines those pages are allocated on
+    // its own node.
+    // (thread_start[0] == ctx->row_start_idx, so tri_start applies.)
+    const uint64_t start_idx = ctx->thread_start[tidx];
+    const uint64_t end_idx = ctx->thread_start[tidx + 1];
+    const uintptr_t fill_start = homhom_needed_p4 * ((start_idx * (start_idx - 1)) / 2 - tri_start);
+    const uintptr_t fill_end = homhom_needed_p4 * ((end_idx * (end_idx - 1)) / 2 - tri_start);
     ZeroU32Arr(fill_end - fill_start, &(king_counts[fill_start]));
   }
+  const uint32_t numa_node_ct = ctx->numa_node_ct;
+  if (numa_node_ct > 1) {
+    const uint32_t node_idx = CurNumaNode();
+    __atomic_fetch_or(&ctx->numa_active_node_mask, 1LLU << node_idx, __ATOMIC_RELAXED);
+    const uintptr_t node_bufsizew = ctx->node_bufsizew;
+    uintptr_t* node_bufs = &(ctx->node_smaj_bufs[node_idx * node_bufsizew]);
+    const uint32_t chunk_ct = DivUp(node_bufsizew, kKingNodeTouchChunkWords);
+    while (1) {
+      const uint32_t chunk_idx = __atomic_fetch_add(&(ctx->node_touch_chunk_cts[node_idx]), 1, __ATOMIC_RELAXED);
+      if (chunk_idx >= chunk_ct) {
+        break;
+      }
+      const uintptr_t chunk_start = chunk_idx * S_CAST(uintptr_t, kKingNodeTouchChunkWords);
+      ZeroWArr(MINV(node_bufsizew - chunk_start, kKingNodeTouchChunkWords), &(node_bufs[chunk_start]));
+    }
+  }
   uint32_t parity = 0;
   // sync.Once before main loop; we need the other threads to be done with
   // their zero-initialization jobs before we can proceed.
@@ -1509,6 +1541,15 @@ typedef struct CalcKingDenseCtxStruct {
   uintptr_t* smaj_ref2het[2];
   uint32_t homhom_needed;
 
+  // If numa_node_ct > 1, the main thread copies each block into
+  // node_smaj_bufs, laid out as [node][parity][hom, ref2het] with
+  // king_bufsizew words per buffer, for every node in numa_active_node_mask;
+  // threads read their own node's copy when it's present.
+  uintptr_t* node_smaj_bufs;
+  uint32_t numa_node_ct;
+  uint32_t king_bufsizew;
+  uint64_t numa_active_node_mask;
+
   uint32_t* thread_start;
 
   uint32_t* king_counts;
@@ -1523,12 +1564,28 @@ THREAD_FUNC_DECL CalcKingDenseThread(void* raw_arg) {
   const uint64_t start_idx = ctx->thread_start[tidx];
   const uint32_t end_idx = ctx->thread_start[tidx + 1];
   const uint32_t homhom_needed = ctx->homhom_needed;
+  uintptr_t* smaj_hom[2];
+  uintptr_t* smaj_ref2het[2];
+  const uint32_t node_idx = CurNumaNode();
+  if ((ctx->numa_active_node_mask >> node_idx) & 1) {
+    const uintptr_t king_bufsizew = ctx->king_bufsizew;
+    uintptr_t* node_bufs = &(ctx->node_smaj_bufs[node_idx * 4 * king_bufsizew]);
+    smaj_hom[0] = node_bufs;
+    smaj_ref2het[0] = &(node_bufs[king_bufsizew]);
+    smaj_hom[1] = &(node_bufs[2 * king_bufsizew]);
+    smaj_ref2het[1] = &(node_bufs[3 * king_bufsizew]);
+  } else {
+    smaj_hom[0] = ctx->smaj_hom[0];
+    smaj_ref2het[0] = ctx->smaj_ref2het[0];
+    smaj_hom[1] = ctx->smaj_hom[1];
+    smaj_ref2het[1] = ctx->smaj_ref2het[1];
+  }
   uint32_t parity = 0;
   do {
     if (homhom_needed) {
-      IncrKingHomhom(ctx->smaj_hom[parity], ctx->smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[((start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) / 2) * 5]));
+      IncrKingHomhom(smaj_hom[parity], smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[((start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) / 2) * 5]));
     } else {
-      IncrKing(ctx->smaj_hom[parity], ctx->smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[(start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) * 2]));
+      IncrKing(smaj_hom[parity], smaj_ref2het[parity], start_idx, end_idx, &(ctx->king_counts[(start_idx * (start_idx - 1) - mem_start_idx * (mem_start_idx - 1)) * 2]));
     }
     parity = 1 - parity;
   } while (!THREAD_BLOCK_FINISH(arg));
@@ -1640,6 +1697,37 @@ uint32_t KingMaxSparseCt(uint32_t row_end_idx) {
 #endif
 }
 
+void CalcKingMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, KingFlags king_flags, uint32_t cutoff_present, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, MemReq* mrp) {
+  uint32_t grand_row_start_idx;
+  uint32_t grand_row_end_idx;
+  ParallelBounds(sample_ct, 1, parallel_idx, parallel_tot, R_CAST(int32_t*, &grand_row_start_idx), R_CAST(int32_t*, &grand_row_end_idx));
+  uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
+  if (calc_thread_ct > sample_ct / 32) {
+    calc_thread_ct = sample_ct / 32;
+  }
+  if (!calc_thread_ct) {
+    calc_thread_ct = 1;
+  }
+  const uint32_t homhom_needed = (king_flags & kfKingColNsnp) || ((!(king_flags & kfKingCounts)) && (king_flags & (kfKingColHethet | kfKingColIbs0 | kfKingColIbs1)));
+  const uint32_t max_sparse_ct = KingMaxSparseCt(grand_row_end_idx);
+  const uintptr_t thread_xalloc_byte_ct = (3 * k1LU) * (max_sparse_ct + grand_row_end_idx) * sizeof(int32_t) + (kPglVblockSize * 2) / CHAR_BIT;
+  MemReq load_req;
+  PgenMtLoadMemReq(grand_row_end_idx, variant_ct, record_byte_ct, calc_thread_ct, thread_xalloc_byte_ct, 0, &load_req);
+  // transpose buffers, and the double-buffered sample-major genotype blocks
+  uint64_t fixed_byte_ct = (2 * k1LU * kPglBitTransposeBatch * BitCtToAlignedWordCt(grand_row_end_idx) + 4 * S_CAST(uint64_t, kKingMultiplexWords) * grand_row_end_idx) * sizeof(intptr_t);
+  if (cutoff_present) {
+    fixed_byte_ct += S_CAST(uint64_t, sample_ct) * BitCtToWordCt(sample_ct) * sizeof(intptr_t);
+  }
+  const uint64_t cell_byte_ct = sizeof(int32_t) * (homhom_needed + 4);
+  // CountTrianglePasses() needs room for one full row; a single pass needs
+  // the whole (diagonal-free) triangle.
+  const uint64_t row_byte_ct = cell_byte_ct * grand_row_end_idx;
+  const uint64_t triangle_byte_ct = cell_byte_ct * ((S_CAST(uint64_t, grand_row_end_idx) * (grand_row_end_idx - 1) - S_CAST(uint64_t, grand_row_start_idx) * (grand_row_start_idx - (grand_row_start_idx != 0))) / 2);
+  // CalcKing() only lets the load buffers have 1/8 of the workspace.
+  mrp->min_byte_ct = MAXV(8 * load_req.min_byte_ct, load_req.min_byte_ct + fixed_byte_ct + row_byte_ct);
+  mrp->comfortable_byte_ct = MAXV(8 * load_req.comfortable_byte_ct, load_req.comfortable_byte_ct + fixed_byte_ct + triangle_byte_ct);
+}
+
 PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   FILE* outfile = nullptr;
@@ -1791,6 +1879,27 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
                  bigstack_alloc_v(kPglBitTransposeBufvecs, &vecaligned_buf))) {
       goto CalcKing_ret_NOMEM;
     }
+    // The dense-phase genotype buffers are read by every thread on every
+    // block; when the workers span several NUMA nodes, give each node its own
+    // copy if there's room.
+    dense_ctx.node_smaj_bufs = nullptr;
+    dense_ctx.numa_node_ct = 1;
+    dense_ctx.king_bufsizew = king_bufsizew;
+    sparse_ctx.numa_node_ct = 1;
+    {
+      const uint32_t numa_node_ct = ThreadPoolNumaNodeCt();
+      if ((numa_node_ct > 1) && (calc_thread_ct > 1)) {
+        const uintptr_t node_bufsizew = 4 * S_CAST(uintptr_t, king_bufsizew);
+        if ((!bigstack_alloc_u32(numa_node_ct, &sparse_ctx.node_touch_chunk_cts)) &&
+            (!bigstack_alloc_w(numa_node_ct * node_bufsizew, &dense_ctx.node_smaj_bufs))) {
+          dense_ctx.numa_node_ct = numa_node_ct;
+          sparse_ctx.node_smaj_bufs = dense_ctx.node_smaj_bufs;
+          sparse_ctx.node_bufsizew = node_bufsizew;
+          sparse_ctx.numa_node_ct = numa_node_ct;
+          logprintf("%s: Replicating genotype blocks across %u NUMA nodes.\n", flagname, numa_node_ct);
+        }
+      }
+    }
 
     // Make this automatically multipass when there's insufficient memory.  So
     // we open the output file(s) here, and just append in the main loop.
@@ -1847,7 +1956,9 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
     }
     uint32_t row_end_idx = grand_row_start_idx;
     sparse_ctx.king_counts = R_CAST(uint32_t*, g_bigstack_base);
+    sparse_ctx.thread_start = dense_ctx.thread_start;
     dense_ctx.king_counts = sparse_ctx.king_counts;
+    dense_ctx.numa_active_node_mask = 0;
     for (uint32_t pass_idx_p1 = 1; pass_idx_p1 <= pass_ct; ++pass_idx_p1) {
       const uint32_t row_start_idx = row_end_idx;
       row_end_idx = NextTrianglePass(row_start_idx, grand_row_end_idx, 1, cells_avail);
@@ -1869,6 +1980,10 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
       sparse_ctx.row_start_idx = row_start_idx;
       sparse_ctx.row_end_idx = row_end_idx;
       sparse_ctx.max_sparse_ct = KingMaxSparseCt(row_end_idx);
+      if (sparse_ctx.numa_node_ct > 1) {
+        ZeroU32Arr(sparse_ctx.numa_node_ct, sparse_ctx.node_touch_chunk_cts);
+        sparse_ctx.numa_active_node_mask = 0;
+      }
       logprintf("%s pass %u/%u: Scanning for rare variants... ", flagname, pass_idx_p1, pass_ct);
       fputs("0%", stdout);
       fflush(stdout);
@@ -1948,6 +2063,9 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
       }
       sparse_variant_ct -= skip_ct;
       if (cur_variant_ct) {
+        if (dense_ctx.numa_node_ct > 1) {
+          dense_ctx.numa_active_node_mask = sparse_ctx.numa_active_node_mask;
+        }
         SetThreadFuncAndData(CalcKingDenseThread, &dense_ctx, &tg);
         const uint32_t row_end_idxaw = BitCtToAlignedWordCt(row_end_idx);
         const uint32_t row_end_idxaw2 = NypCtToAlignedWordCt(row_end_idx);
@@ -2079,6 +2197,19 @@ PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig,
               write_ref2het_iter = &(write_ref2het_iter[kKingMultiplexWords]);
             }
           }
+          if (dense_ctx.numa_active_node_mask) {
+            // As with the master buffers, it's safe to overwrite this parity's
+            // copies before JoinThreads(): the block still in flight only
+            // reads the other parity.
+            const uintptr_t copy_wordct = S_CAST(uintptr_t, row_end_idx) * kKingMultiplexWords;
+            for (uint32_t node_idx = 0; node_idx != dense_ctx.numa_node_ct; ++node_idx) {
+              if ((dense_ctx.numa_active_node_mask >> node_idx) & 1) {
+                uintptr_t* node_bufs = &(dense_ctx.node_smaj_bufs[(node_idx * 4 + 2 * parity) * S_CAST(uintptr_t, king_bufsizew)]);
+                memcpy(node_bufs, cur_smaj_hom, copy_wordct * sizeof(intptr_t));
+                memcpy(&(node_bufs[king_bufsizew]), cur_smaj_ref2het, copy_wordct * sizeof(intptr_t));
+              }
+            }
+          }
           if (variants_completed) {
             JoinThreads(&tg);
             // CalcKingThread() never errors out
@@ -4332,8 +4463,9 @@ PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample
     uintptr_t* missing_vmaj = nullptr;
     uintptr_t* genovec_buf = nullptr;
     CalcDblMissingCtx ctx;
+    *missing_dbl_exclude_cts_ptr = nullptr;
     if (unlikely(bigstack_calloc_u32(row_end_idx, missing_cts_ptr) ||
-                 bigstack_calloc_u32((S_CAST(uint64_t, row_end_idx) * (row_end_idx - 1) - S_CAST(uint64_t, row_start_idx) * (row_start_idx - 1)) / 2, missing_dbl_exclude_cts_ptr) ||
+                 bigstack_or_spill_calloc64_u32((S_CAST(uint64_t, row_end_idx) * (row_end_idx - 1) - S_CAST(uint64_t, row_start_idx) * (row_start_idx - 1)) / 2, "Missingness correction", missing_dbl_exclude_cts_ptr) ||
                  bigstack_calloc_w(row_end_idxl, &ctx.missing_nz[0]) ||
                  bigstack_calloc_w(row_end_idxl, &ctx.missing_nz[1]) ||
                  bigstack_alloc_w(NypCtToWordCt(row_end_idx), &genovec_buf) ||
@@ -4466,13 +4598,36 @@ PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample
   }
  CalcMissingMatrix_ret_1:
   CleanupThreads(&tg);
+  if (reterr) {
+    SpillFree(*missing_dbl_exclude_cts_ptr);
+  }
   BigstackReset(bigstack_mark);
   return reterr;
 }
 
+void CalcGrmMemReq(uint32_t sample_ct, uintptr_t record_byte_ct, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, MemReq* mrp) {
+  uint32_t row_bounds[2];
+  TriangleFill2(sample_ct, 1, parallel_idx, parallel_tot, 0, row_bounds);
+  const uint64_t row_start_idx = row_bounds[0];
+  const uint64_t row_end_idx = row_bounds[1];
+  // grm rectangle, and up to four normed-dosage block buffers
+  uint64_t byte_ct = (row_end_idx - row_start_idx) * row_end_idx * sizeof(double) + 4 * row_end_idx * kGrmVariantBlockSize * sizeof(double);
+  if (!(grm_flags & kfGrmMeanimpute)) {
+    // CalcMissingMatrix()
+    byte_ct += ((row_end_idx * (row_end_idx - 1) - row_start_idx * (row_start_idx - (row_start_idx != 0))) / 2) * sizeof(int32_t) + BitCtToAlignedWordCt(row_end_idx) * kDblMissingBlockSize * sizeof(intptr_t) + 2 * RoundUpPow2(row_end_idx, 2) * kDblMissingBlockWordCt * sizeof(intptr_t);
+  }
+  // single reader, no PgenMtLoadInit() call
+  byte_ct += EstimatePgrAllocByteCt(sample_ct) + record_byte_ct;
+  // no multipass mode
+  mrp->min_byte_ct = byte_ct;
+  mrp->comfortable_byte_ct = byte_ct;
+}
+
 PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end, double** grm_ptr) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
+  double* grm = nullptr;
+  uint32_t* missing_dbl_exclude_cts = nullptr;
   FILE* outfile = nullptr;
   char* cswritep = nullptr;
   CompressStreamState css;
@@ -4541,11 +4696,10 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
 
     CalcGrmPartCtx ctx;
     ctx.thread_start = thread_start;
-    double* grm;
     if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
       goto CalcGrm_ret_NOMEM;
     }
-    if (unlikely(bigstack_calloc64_d(S_CAST(uint64_t, row_end_idx - row_start_idx) * row_end_idx, &grm))) {
+    if (unlikely(bigstack_or_spill_calloc64_d(S_CAST(uint64_t, row_end_idx - row_start_idx) * row_end_idx, "GRM construction", &grm))) {
       if (!grm_ptr) {
         logerrputs("Error: Out of memory.  If you are SURE you are performing the right matrix\ncomputation, you can split it into smaller pieces with --parallel, and then\nconcatenate the results.  But before you try this, make sure the program you're\nproviding the matrix to can actually handle such a large input file.\n");
       } else {
@@ -4672,7 +4826,6 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     fputs("\b\b", stdout);
     logputs("done.\n");
     uint32_t* missing_cts = nullptr;  // stays null iff meanimpute
-    uint32_t* missing_dbl_exclude_cts = nullptr;
     if (variant_include_has_missing) {
       const uint32_t variant_ct_with_missing = PopcountWords(variant_include_has_missing, raw_variant_ctl);
       // if no missing calls at all, act as if meanimpute was on
@@ -5064,6 +5217,10 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
   fclose_cond(outfile);
   CleanupThreads(&tg);
   BLAS_SET_NUM_THREADS(1);
+  SpillFree(missing_dbl_exclude_cts);
+  if (reterr || (!grm_ptr)) {
+    SpillFree(grm);
+  }
   BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
   return reterr;
 }
@@ -5478,8 +5635,37 @@ PglErr FlushAlleleWts(const uintptr_t* variant_include, const ChrInfo* cip, cons
   return kPglRetSuccess;
 }
 
+void CalcPcaMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, uint32_t pc_ct, GrmFlags grm_flags, PcaFlags pca_flags, uint32_t max_thread_ct, MemReq* mrp) {
+  const uint64_t sample_ct64 = sample_ct;
+  if (!(pca_flags & kfPcaApprox)) {
+    // GRM construction, followed by eigendecomposition while the GRM is kept
+    CalcGrmMemReq(sample_ct, record_byte_ct, grm_flags, 0, 1, mrp);
+    // dsyevr() lwork ~26n, liwork ~10n
+    const uint64_t eig_byte_ct = sample_ct64 * sample_ct64 * sizeof(double) + 2 * pc_ct * sample_ct64 * sizeof(double) + sample_ct64 * (26 * sizeof(double) + 10 * sizeof(int32_t));
+    if (mrp->min_byte_ct < eig_byte_ct) {
+      mrp->min_byte_ct = eig_byte_ct;
+      mrp->comfortable_byte_ct = eig_byte_ct;
+    }
+    return;
+  }
+  uint32_t calc_thread_ct = (max_thread_ct > 8)? (max_thread_ct - 1) : max_thread_ct;
+  if ((calc_thread_ct - 1) * kPcaVariantBlockSize >= variant_ct) {
+    calc_thread_ct = 1 + (variant_ct - 1) / kPcaVariantBlockSize;
+  }
+  const uint64_t pc_ct_x2 = pc_ct * 2;
+  const uint64_t qq_col_ct = (pc_ct + 1) * pc_ct_x2;
+  // ss, qq, SvdRectFused() workspace (approximate lwork), g1
+  const uint64_t svd_lwork = qq_col_ct * (qq_col_ct + 3) + MAXV(sample_ct, variant_ct);
+  const uint64_t fixed_byte_ct = (qq_col_ct + variant_ct * qq_col_ct + svd_lwork + qq_col_ct * qq_col_ct + sample_ct64 * pc_ct_x2) * sizeof(double) + EstimatePgrAllocByteCt(sample_ct) + record_byte_ct;
+  const uint64_t yy_alloc_incr = RoundUpPow2(kPcaVariantBlockSize * sample_ct64 * sizeof(double), kCacheline);
+  const uint64_t per_thread_alloc = 3 * yy_alloc_incr + RoundUpPow2(sample_ct64 * qq_col_ct * sizeof(double), kCacheline);
+  mrp->min_byte_ct = fixed_byte_ct + per_thread_alloc + 2 * yy_alloc_incr;
+  mrp->comfortable_byte_ct = fixed_byte_ct + calc_thread_ct * (per_thread_alloc + 2 * yy_alloc_incr);
+}
+
 PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* maj_alleles, const double* allele_freqs, uint32_t raw_sample_ct, uintptr_t pca_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_allele_slen, uint32_t pc_ct, PcaFlags pca_flags, uint32_t max_thread_ct, PgenReader* simple_pgrp, sfmt_t* sfmtp, double* grm, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
+  double* qq = nullptr;
   FILE* outfile = nullptr;
   char* cswritep = nullptr;
   CompressStreamState css;
@@ -5578,7 +5764,6 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
     const uintptr_t pca_row_ct = CountAlleles(variant_include, allele_idx_offsets, raw_variant_ct, variant_ct) - biallelic_variant_ct;
     const uint32_t is_haploid = cip->haploid_mask[0] & 1;
     uint32_t cur_allele_ct = 2;
-    double* qq = nullptr;
     double* eigvecs_smaj;
     char* writebuf;
     if (is_approx) {
@@ -5632,7 +5817,7 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
       double* ss;
       double* g1;
       if (unlikely(bigstack_alloc_d(qq_col_ct, &ss) ||
-                   bigstack_alloc_d(pca_row_ct * qq_col_ct, &qq) ||
+                   bigstack_or_spill_calloc64_d(pca_row_ct * qq_col_ct, "--pca approx", &qq) ||
                    bigstack_alloc_dp(calc_thread_ct, &ctx.y_transpose_bufs) ||
                    bigstack_alloc_dp(calc_thread_ct, &ctx.g2_bb_part_bufs) ||
                    bigstack_alloc_uc(svd_rect_wkspace_size, &svd_rect_wkspace) ||
@@ -6014,10 +6199,11 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
         // non-approximate PCA, some buffers have not been allocated yet
 
         // if grm[] (which we no longer need) has at least as much remaining
-        // space as bigstack, allocate from grm
+        // space as bigstack, allocate from grm.  (Not applicable when grm[]
+        // was spilled to disk; it doesn't border bigstack_mark then.)
         unsigned char* arena_bottom = R_CAST(unsigned char*, grm);
         unsigned char* arena_top = bigstack_mark;
-        uintptr_t arena_avail = arena_top - arena_bottom;
+        uintptr_t arena_avail = IsSpilled(grm)? 0 : (arena_top - arena_bottom);
         if (arena_avail < bigstack_left()) {
           arena_bottom = g_bigstack_base;
           arena_top = g_bigstack_end;
@@ -6200,10 +6386,12 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
   BLAS_SET_NUM_THREADS(1);
   CswriteCloseCond(&css, cswritep);
   fclose_cond(outfile);
-  if (grm) {
+  SpillFree(qq);
+  if (grm && (!IsSpilled(grm))) {
     // nothing after --pca in the plink2 order of operations uses grm[]
     BigstackReset(grm);
   } else {
+    SpillFree(grm);
     BigstackReset(bigstack_mark);
   }
   return reterr;
@@ -8618,7 +8806,8 @@ typedef struct VscoreCtxStruct {
   Dosage** dosage_mains;
   uint32_t* read_variant_uidx_starts;
 
-  uint32_t cur_block_size;
+  TaskDeques tdq;
+  uint32_t cur_block_uidx_start;
 
   float** dosage_f_vmaj_bufs;
   float** tmp_f_result_bufs;
@@ -8678,7 +8867,6 @@ THREAD_FUNC_DECL VscoreThread(void* raw_arg) {
   const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
   const uint32_t y_code = cip->xymt_codes[kChrOffsetY];
   const uint32_t is_xchr_model_1 = ctx->is_xchr_model_1;
-  const uint32_t calc_thread_ct = GetThreadCt(arg->sharedp);
 
   const uint32_t single_prec = (wts_f_smaj != nullptr);
 #ifdef USE_CUDA
@@ -8719,16 +8907,29 @@ THREAD_FUNC_DECL VscoreThread(void* raw_arg) {
   uint32_t parity = 0;
   uint64_t new_err_info = 0;
   do {
-    const uintptr_t cur_block_size = ctx->cur_block_size;
-    const uint32_t bidx_end = ((tidx + 1) * cur_block_size) / calc_thread_ct;
     float* cur_results_f = ctx->results_f[parity];
     double* cur_results_d = ctx->results_d[parity];
     uint32_t* missing_cts = ctx->missing_cts[parity];
     uintptr_t row_idx = 0;
+    uint32_t variant_bidx = 0;
+    uint32_t bidx_end = 0;
     uintptr_t variant_uidx_base;
     uintptr_t variant_include_bits;
-    BitIter1Start(variant_include, ctx->read_variant_uidx_starts[tidx], &variant_uidx_base, &variant_include_bits);
-    for (uint32_t variant_bidx = (tidx * cur_block_size) / calc_thread_ct; variant_bidx != bidx_end; ++variant_bidx) {
+    BitIter1Start(variant_include, ctx->cur_block_uidx_start, &variant_uidx_base, &variant_include_bits);
+    for (; ; ++variant_bidx) {
+      if (variant_bidx == bidx_end) {
+        const uint32_t prev_bidx_end = bidx_end;
+        if (!TaskDequesNext(tidx, &ctx->tdq, &variant_bidx, &bidx_end)) {
+          break;
+        }
+        // The next chunk of our own range picks up where the iterator left
+        // off; only a stolen task needs a fresh variant_include scan.
+        if (variant_bidx != prev_bidx_end) {
+          BitIter1Start(variant_include, FindNth1BitFrom(variant_include, ctx->cur_block_uidx_start, variant_bidx + 1), &variant_uidx_base, &variant_include_bits);
+          // a stolen task may lie on an earlier chromosome
+          chr_end = 0;
+        }
+      }
       const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &variant_include_bits);
       if (variant_uidx >= chr_end) {
         const uint32_t chr_fo_idx = GetVariantChrFoIdx(cip, variant_uidx);
@@ -9674,6 +9875,11 @@ PglErr Vscore(const uintptr_t* variant_include, const ChrInfo* cip, const uint32
 
     // ctx.results must have space for 2 * vscore_ct * read_block_size values.
     const uintptr_t per_variant_xalloc_byte_ct = 2 * vscore_ct * ((8 * k1LU) >> single_prec);
+    // PgenMtLoadInit() may reduce calc_thread_ct, but not increase it.
+    unsigned char* tdq_alloc;
+    if (unlikely(bigstack_alloc_uc(TaskDequesAllocCachelineCt(calc_thread_ct) * kCacheline, &tdq_alloc))) {
+      goto Vscore_ret_NOMEM;
+    }
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
     // defensive
     ctx.dosage_presents = nullptr;
@@ -9685,6 +9891,7 @@ PglErr Vscore(const uintptr_t* variant_include, const ChrInfo* cip, const uint32
     if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
       goto Vscore_ret_NOMEM;
     }
+    InitTaskDeques(calc_thread_ct, tdq_alloc, &ctx.tdq);
     {
       // could vector-align individual allocations and only cacheline-align at
       // thread boundaries, but the savings are microscopic
@@ -9754,6 +9961,7 @@ PglErr Vscore(const uintptr_t* variant_include, const ChrInfo* cip, const uint32
       }
       if (variant_idx) {
         JoinThreads(&tg);
+        TaskDequesBlockDone(&ctx.tdq);
         reterr = S_CAST(PglErr, ctx.err_info);
         if (unlikely(reterr)) {
 #ifdef USE_CUDA
@@ -9770,8 +9978,8 @@ PglErr Vscore(const uintptr_t* variant_include, const ChrInfo* cip, const uint32
       if (!IsLastBlock(&tg)) {
         // it may make sense to put this boilerplate into its own function,
         // too...
-        ctx.cur_block_size = cur_block_size;
-        ComputeUidxStartPartition(variant_include, cur_block_size, calc_thread_ct, read_block_idx * read_block_size, ctx.read_variant_uidx_starts);
+        ctx.cur_block_uidx_start = AdvTo1Bit(variant_include, read_block_idx * read_block_size);
+        ResetTaskDeques(cur_block_size, DivUp(cur_block_size, calc_thread_ct * 16), &ctx.tdq);
         PgrCopyBaseAndOffset(pgfip, calc_thread_ct, ctx.pgr_ptrs);
         if (variant_idx + cur_block_size == variant_ct) {
           DeclareLastThreadBlock(&tg);
@@ -9927,6 +10135,7 @@ PglErr Vscore(const uintptr_t* variant_include, const ChrInfo* cip, const uint32
       goto Vscore_ret_WRITE_FAIL;
     }
     putc_unlocked('\r', stdout);
+    LogTaskDequesIdle("--variant-score", &ctx.tdq);
     if (!binfile) {
       logprintfww("--variant-score: Results written to %s .\n", outname);
     } else {
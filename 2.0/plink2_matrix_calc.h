@@ -214,6 +214,17 @@ PglErr KingCutoffBatchBinary(const SampleIdInfo* siip, uint32_t raw_sample_ct, d
 
 PglErr KingCutoffBatchTable(const SampleIdInfo* siip, const char* kin0_fname, uint32_t raw_sample_ct, double king_cutoff, uintptr_t* sample_include, uint32_t* sample_ct_ptr);
 
+// Workspace estimates for the --memory auto/plan planner.  cutoff_present
+// should be set when --king-cutoff is computed from genotypes.
+void CalcKingMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, KingFlags king_flags, uint32_t cutoff_present, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, MemReq* mrp);
+
+void CalcGrmMemReq(uint32_t sample_ct, uintptr_t record_byte_ct, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, MemReq* mrp);
+
+#ifndef NOLAPACK
+// Includes the GRM when pca_flags doesn't have kfPcaApprox set.
+void CalcPcaMemReq(uint32_t sample_ct, uint32_t variant_ct, uintptr_t record_byte_ct, uint32_t pc_ct, GrmFlags grm_flags, PcaFlags pca_flags, uint32_t max_thread_ct, MemReq* mrp);
+#endif
+
 PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end);
 
 PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* subset_fname, const char* require_fnames, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_table_filter, double king_table_subset_thresh, uint32_t rel_check, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end);
@@ -924,6 +924,9 @@ PglErr LoadPhenos(const char* pheno_fname, const RangeList* pheno_range_list_ptr
     uint32_t* col_skips = nullptr;
     XidMode xid_mode;
     uint32_t new_pheno_ct;
+#ifndef USE_AVX2
+    uint32_t file_pheno_col_ct;
+#endif
     uint32_t final_pheno_ct;
     uintptr_t final_pheno_names_byte_ct;
     if ((memequal_sk(line_iter, "FID") || memequal_sk(line_iter, "IID")) && ((ctou32(line_iter[3]) <= 32) || (line_iter[3] == ','))) {
@@ -984,6 +987,9 @@ PglErr LoadPhenos(const char* pheno_fname, const RangeList* pheno_range_list_ptr
         logerrputs("Error: Phenotype/covariate names are limited to " MAX_ID_SLEN_STR " characters.\n");
         goto LoadPhenos_ret_MALFORMED_INPUT;
       }
+#ifndef USE_AVX2
+      file_pheno_col_ct = pheno_col_ct;
+#endif
       if (pheno_range_list_ptr->names && pheno_col_ct) {
         // bugfix (20 Oct 2017): forgot to make error message different in
         // --covar case
@@ -1066,6 +1072,9 @@ PglErr LoadPhenos(const char* pheno_fname, const RangeList* pheno_range_list_ptr
         // todo: tolerate col_ct == 2 with --allow-no-phenos
         goto LoadPhenos_ret_MISSING_TOKENS;
       }
+#ifndef USE_AVX2
+      file_pheno_col_ct = col_ct + iid_only - 2;
+#endif
       if (pheno_range_list_ptr->names) {
         if (unlikely(!numeric_ranges)) {
           snprintf(g_logbuf, kLogbufSize, "Error: Header line expected in %s, due to --pheno-name/--covar-name. (This line must start with '#FID', 'FID', '#IID', or 'IID'.)\n", pheno_fname);
@@ -1196,6 +1205,28 @@ PglErr LoadPhenos(const char* pheno_fname, const RangeList* pheno_range_list_ptr
                  bigstack_calloc_w(new_pheno_ctl, &quantitative_phenos))) {
       goto LoadPhenos_ret_NOMEM;
     }
+#ifndef USE_AVX2
+    // For wide tables where most columns are skipped, index each loaded block
+    // once instead of rescanning the skipped columns byte-by-byte.
+    TextFieldIdx field_idx;
+    uint32_t use_field_idx = 0;
+    if (!comma_delim) {
+      uint32_t skipped_col_ct = 0;
+      for (uint32_t new_pheno_idx = 0; new_pheno_idx != new_pheno_ct; ++new_pheno_idx) {
+        skipped_col_ct += col_skips[new_pheno_idx];
+      }
+      if (TextFieldIdxWorthwhile(skipped_col_ct - new_pheno_ct, file_pheno_col_ct)) {
+        uintptr_t* delim_bitarr;
+        uintptr_t* eoln_bitarr;
+        if (unlikely(bigstack_alloc_w(kTextFieldIdxDefaultWords, &delim_bitarr) ||
+                     bigstack_alloc_w(kTextFieldIdxDefaultWords, &eoln_bitarr))) {
+          goto LoadPhenos_ret_NOMEM;
+        }
+        TextFieldIdxInit(33, kTextFieldIdxDefaultWords, delim_bitarr, eoln_bitarr, &field_idx);
+        use_field_idx = 1;
+      }
+    }
+#endif
     const uint32_t missing_catname_blen = strlen(missing_catname) + 1;
     const uint32_t missing_catname_hval = Hashceil(missing_catname, missing_catname_blen - 1, kCatHtableSize);
     unsigned char* bigstack_base_copy = g_bigstack_base;
@@ -1216,6 +1247,14 @@ PglErr LoadPhenos(const char* pheno_fname, const RangeList* pheno_range_list_ptr
         }
         continue;
       }
+#ifndef USE_AVX2
+      if (use_field_idx && TextFieldIdxStartLine(&pheno_txs, line_iter, &field_idx)) {
+        if (unlikely(!TextFieldIdxTokenLexK(&field_idx, line_iter, col_types, col_skips, new_pheno_ct, token_ptrs, token_slens))) {
+          goto LoadPhenos_ret_MISSING_TOKENS;
+        }
+        line_iter = TextFieldIdxLineEnd(&field_idx);
+      } else
+#endif
       if (!comma_delim) {
         line_iter = TokenLexK(line_iter, col_types, col_skips, new_pheno_ct, token_ptrs, token_slens);
       } else {
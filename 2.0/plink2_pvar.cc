@@ -25,9 +25,12 @@ namespace plink2 {
 // size-64k pos[], allele_idxs[], ids[], cms[], etc. blocks, and just memcpy
 // those chunks at the end.  (cms[] is lazy-initialized.)
 //
-// probable todo: try making this more parallel.  could e.g. repeatedly peek at
-// end of ReadLineStream buffer, count # of '\n's, and divvy them up between
-// worker threads.
+// Tokenization is parallel: we repeatedly peek at the complete lines in the
+// TextStream buffer, divvy up (at most kLoadPvarLexBatchSize of) them between
+// worker threads which lex them into PvarLexedLine records, and then consume
+// the records in order on the main thread.  Everything that touches shared
+// state (allele/ID storage, ChrInfo, sort-status tracking) stays on the main
+// thread, so the results are independent of the thread count.
 CONSTI32(kLoadPvarBlockSize, 65536);
 static_assert(!(kLoadPvarBlockSize & (kLoadPvarBlockSize - 1)), "kLoadPvarBlockSize must be a power of 2.");
 static_assert(kLoadPvarBlockSize >= (kMaxMediumLine / 8), "kLoadPvarBlockSize cannot be smaller than kMaxMediumLine / 8.");
@@ -855,6 +858,958 @@ PglErr SplitPar(const uint32_t* variant_bps, UnsortedVar vpos_sortstatus, uint32
   return kPglRetSuccess;
 }
 
+CONSTI32(kLoadPvarLexBatchSize, 16384);
+CONSTI32(kMaxLoadPvarLexThreads, 16);
+
+FLAGSET_DEF_START()
+  kfPvarLex0,
+  kfPvarLexBpErr = (1 << 0),
+  kfPvarLexQualPresent = (1 << 1),
+  kfPvarLexQualErr = (1 << 2),
+  kfPvarLexCmPresent = (1 << 3),
+  kfPvarLexCmErr = (1 << 4),
+  kfPvarLexNonref = (1 << 5),
+  kfPvarLexInfoSkip = (1 << 6)
+FLAGSET_DEF_END(PvarLexFlags);
+
+// Everything LoadPvar() needs to know about a line which can be determined
+// without looking at other lines.  Errors are recorded instead of reported,
+// since the main thread may decide to skip the variant before it would have
+// noticed them.
+typedef struct PvarLexedLineStruct {
+  char* line_start;  // filled by main thread
+  char* chr_end;
+  char* line_end;  // nullptr iff TokenLex() failed
+  char* token_ptrs[8];
+  uint32_t token_slens[8];
+  uint32_t chr_code;  // negative if GetOrAddChrCode() must be called
+  uint32_t extra_alt_ct;
+  int32_t bp;
+  float qual;
+  double cm;
+  PvarLexFlags flags;
+} PvarLexedLine;
+
+typedef struct LoadPvarLexCtxStruct {
+  const ChrInfo* cip;
+  const uint32_t* col_types;
+  const uint32_t* col_skips;
+  const InfoExist* info_existp;
+  const InfoExist* info_nonexistp;
+  const InfoFilter* info_keepp;
+  const InfoFilter* info_removep;
+  uint32_t relevant_postchr_col_ct;
+  uint32_t info_col_present;
+  uint32_t info_pr_exists;
+  uint32_t load_qual_col;
+  uint32_t cm_col_present;
+
+  PvarLexedLine* lexed_lines;
+  uint32_t cur_line_ct;
+} LoadPvarLexCtx;
+
+// Mutates the INFO token (null-terminating it), and may temporarily
+// null-terminate the chromosome code.  Reads ChrInfo, so the main thread must
+// not call GetOrAddChrCode() concurrently.
+void LoadPvarLexLines(const LoadPvarLexCtx* ctx, uint32_t line_idx_start, uint32_t line_idx_end) {
+  const ChrInfo* cip = ctx->cip;
+  const uint32_t* col_types = ctx->col_types;
+  const uint32_t* col_skips = ctx->col_skips;
+  const InfoExist* info_existp = ctx->info_existp;
+  const InfoExist* info_nonexistp = ctx->info_nonexistp;
+  const InfoFilter* info_keepp = ctx->info_keepp;
+  const InfoFilter* info_removep = ctx->info_removep;
+  const uint32_t relevant_postchr_col_ct = ctx->relevant_postchr_col_ct;
+  const uint32_t info_col_present = ctx->info_col_present;
+  const uint32_t info_pr_exists = ctx->info_pr_exists;
+  const uint32_t load_qual_col = ctx->load_qual_col;
+  const uint32_t cm_col_present = ctx->cm_col_present;
+  PvarLexedLine* lexed_lines = ctx->lexed_lines;
+  for (uint32_t line_idx = line_idx_start; line_idx != line_idx_end; ++line_idx) {
+    PvarLexedLine* lexp = &(lexed_lines[line_idx]);
+    char* line_start = lexp->line_start;
+    char* chr_end = CurTokenEnd(line_start);
+    lexp->chr_end = chr_end;
+    lexp->line_end = nullptr;
+    if (*chr_end == '\n') {
+      continue;
+    }
+    lexp->chr_code = GetChrCodeCounted(cip, chr_end - line_start, line_start);
+    char** token_ptrs = lexp->token_ptrs;
+    uint32_t* token_slens = lexp->token_slens;
+    char* lex_end = TokenLex(chr_end, col_types, col_skips, relevant_postchr_col_ct, token_ptrs, token_slens);
+    if (!lex_end) {
+      continue;
+    }
+    lexp->extra_alt_ct = CountByte(token_ptrs[3], ',', token_slens[3]);
+    // Must happen before INFO is null-terminated.
+    lexp->line_end = AdvToDelim(lex_end, '\n');
+    PvarLexFlags flags = kfPvarLex0;
+    if (info_col_present) {
+      const uint32_t info_slen = token_slens[6];
+      char* info_token = token_ptrs[6];
+      info_token[info_slen] = '\0';
+      if (info_pr_exists) {
+        if ((memequal_sk(info_token, "PR") && ((info_slen == 2) || (info_token[2] == ';'))) || memequal_sk(&(info_token[S_CAST(int32_t, info_slen) - 3]), ";PR")) {
+          flags |= kfPvarLexNonref;
+        } else {
+          const char* first_info_end = strchr(info_token, ';');
+          if (first_info_end && strstr(first_info_end, ";PR;")) {
+            flags |= kfPvarLexNonref;
+          }
+        }
+      }
+      if ((info_existp && (!InfoExistCheck(info_token, info_existp))) ||
+          (info_nonexistp && (!InfoNonexistCheck(info_token, info_nonexistp))) ||
+          (info_keepp->prekey && (!InfoConditionSatisfied(info_token, info_keepp))) ||
+          (info_removep->prekey && InfoConditionSatisfied(info_token, info_removep))) {
+        flags |= kfPvarLexInfoSkip;
+      }
+    }
+    if (ScanIntAbsDefcap(token_ptrs[0], &(lexp->bp))) {
+      flags |= kfPvarLexBpErr;
+    }
+    if (load_qual_col) {
+      const char* qual_token = token_ptrs[4];
+      if ((qual_token[0] != '.') || (qual_token[1] > ' ')) {
+        flags |= kfPvarLexQualPresent;
+        if (ScanFloatAllowInf(qual_token, &(lexp->qual))) {
+          flags |= kfPvarLexQualErr;
+        }
+      }
+    }
+    if (cm_col_present) {
+      const char* cm_token = token_ptrs[7];
+      if ((cm_token[0] != '0') || (cm_token[1] > ' ')) {
+        flags |= kfPvarLexCmPresent;
+        if (!ScantokDouble(cm_token, &(lexp->cm))) {
+          flags |= kfPvarLexCmErr;
+        }
+      }
+    }
+    lexp->flags = flags;
+  }
+}
+
+THREAD_FUNC_DECL LoadPvarLexThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx_p1 = arg->tidx + 1;
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp) + 1;
+  LoadPvarLexCtx* ctx = S_CAST(LoadPvarLexCtx*, arg->sharedp->context);
+  do {
+    const uint32_t cur_line_ct = ctx->cur_line_ct;
+    LoadPvarLexLines(ctx, (S_CAST(uint64_t, cur_line_ct) * tidx_p1) / thread_ct, (S_CAST(uint64_t, cur_line_ct) * (tidx_p1 + 1)) / thread_ct);
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+// --pvar-cache sidecar (<.pvar/.bim filename>.pvc).  This is a native-endian
+// snapshot of what the main LoadPvar() loop produced for a file where no
+// variant was skipped: one summary record per chromosome, followed by one
+// section per column (positions, ID/allele offsets into a string blob,
+// allele_idx_offsets, nonref flags, CMs, QUAL/FILTER).  Sections are 64-byte
+// aligned and located via the header's offset table, so they can be read (or
+// mapped) independently.  The key covers the source file's size, mtime, and
+// the hashes of its first and last 64 KiB, along with the settings which
+// affect how the text is interpreted (chromosome-code configuration, missing
+// genotype character).
+CONSTI32(kPvarCacheVersion, 1);
+CONSTI32(kPvarCacheHashBlen, 65536);
+CONSTI32(kPvarCacheAlign, 64);
+static_assert(kTextbufSize >= kPvarCacheHashBlen, "GetPvarCacheKey() assumes g_textbuf can hold kPvarCacheHashBlen bytes.");
+
+// Allele offsets with this bit set refer to g_one_char_strs[] instead of the
+// string blob.
+static const uintptr_t kPvarCacheOneCharTag = k1LU << (kBitsPerWord - 1);
+
+ENUM_U31_DEF_START()
+  kPvcSecRuns,
+  kPvcSecRunNames,
+  kPvcSecBps,
+  kPvcSecIds,
+  kPvcSecAlleles,
+  kPvcSecAlleleIdxs,
+  kPvcSecNonref,
+  kPvcSecCms,
+  kPvcSecQualPresent,
+  kPvcSecQuals,
+  kPvcSecFilterPresent,
+  kPvcSecFilterNpass,
+  kPvcSecFilters,
+  kPvcSecStrings,
+  kPvcSecCt
+ENUM_U31_DEF_END(PvcSection);
+
+typedef struct PvarCacheKeyStruct {
+  uint64_t fsize;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint32_t head_hash;
+  uint32_t tail_hash;
+  uint32_t chr_config_hash;
+  int32_t missing_geno_char;
+} PvarCacheKey;
+
+typedef struct PvarCacheHeaderStruct {
+  char magic[8];
+  uint32_t version;
+  uint32_t word_blen;
+  PvarCacheKey key;
+  uint64_t allele_ct;
+  uint64_t run_names_blen;
+  uint64_t strings_blen;
+  uint32_t raw_variant_ct;
+  uint32_t run_ct;
+  uint32_t info_slen;  // UINT32_MAX if the INFO column wasn't scanned
+  uint32_t reserved;
+  uint64_t sec_offsets[kPvcSecCt];  // 0 = absent
+} PvarCacheHeader;
+
+FLAGSET_DEF_START()
+  kfPvcRun0,
+  kfPvcRunUnsortedBp = (1 << 0),
+  kfPvcRunUnsortedCm = (1 << 1),
+  kfPvcRunNzeroCm = (1 << 2),
+  kfPvcRunNpassFilter = (1 << 3)
+FLAGSET_DEF_END(PvcRunFlags);
+
+// Per-chromosome maxima and sort status, so that chromosome filters can still
+// be applied at load time.
+typedef struct PvarCacheRunStruct {
+  uint32_t chr_code;  // UINT32_MAX for nonstandard names
+  uint32_t name_offset;  // into kPvcSecRunNames
+  uint32_t start_vidx;
+  uint32_t max_allele_slen;
+  uint32_t max_extra_alt_ct;
+  uint32_t max_id_slen;
+  uint32_t max_filter_slen;
+  uint32_t flags;
+} PvarCacheRun;
+
+// Byte offsets of the optional columns within a main-loop block, in the
+// no-split-chromosome case.
+typedef struct PvarBlockLayoutStruct {
+  uintptr_t qual_present_offset;
+  uintptr_t quals_offset;
+  uintptr_t filter_present_offset;
+  uintptr_t filter_npass_offset;
+  uintptr_t filter_storage_offset;
+  uintptr_t nonref_offset;
+  // cms[] starts here in blocks where it's present.
+  uintptr_t stride_base;
+} PvarBlockLayout;
+
+void InitPvarBlockLayout(uint32_t qual_stored, uint32_t filter_stored, uint32_t nonref_stored, PvarBlockLayout* layoutp) {
+  uintptr_t offset = kLoadPvarBlockSize * (sizeof(int32_t) + 2 * sizeof(intptr_t)) + (kLoadPvarBlockSize / CHAR_BIT);
+  layoutp->qual_present_offset = offset;
+  layoutp->quals_offset = offset + (kLoadPvarBlockSize / CHAR_BIT);
+  if (qual_stored) {
+    offset += (kLoadPvarBlockSize / CHAR_BIT) + kLoadPvarBlockSize * sizeof(float);
+  }
+  layoutp->filter_present_offset = offset;
+  layoutp->filter_npass_offset = offset + (kLoadPvarBlockSize / CHAR_BIT);
+  layoutp->filter_storage_offset = offset + 2 * (kLoadPvarBlockSize / CHAR_BIT);
+  if (filter_stored) {
+    offset += 2 * (kLoadPvarBlockSize / CHAR_BIT) + kLoadPvarBlockSize * sizeof(intptr_t);
+  }
+  layoutp->nonref_offset = offset;
+  if (nonref_stored) {
+    offset += kLoadPvarBlockSize / CHAR_BIT;
+  }
+  layoutp->stride_base = offset;
+}
+
+unsigned char* PvarBlockStart(const PvarBlockLayout* layoutp, uint32_t cms_start_block, uint32_t block_idx, unsigned char* block_base) {
+  uintptr_t offset = S_CAST(uintptr_t, block_idx) * layoutp->stride_base;
+  if (block_idx > cms_start_block) {
+    offset += S_CAST(uintptr_t, block_idx - cms_start_block) * (kLoadPvarBlockSize * sizeof(double));
+  }
+  return &(block_base[offset]);
+}
+
+// Returns 1 if pvarname isn't a regular file, or the cache filename would be
+// too long.
+BoolErr InitPvarCache(const char* pvarname, const ChrInfo* cip, char input_missing_geno_char, char* cache_fname, PvarCacheKey* keyp) {
+#ifdef _WIN32
+  return 1;
+#else
+  const uint32_t pvarname_slen = strlen(pvarname);
+  if (pvarname_slen + strlen(".pvc.tmp") >= kPglFnamesize) {
+    return 1;
+  }
+  struct stat statbuf;
+  if (stat(pvarname, &statbuf) || (!S_ISREG(statbuf.st_mode))) {
+    return 1;
+  }
+  snprintf(cache_fname, kPglFnamesize, "%s.pvc", pvarname);
+  memset(keyp, 0, sizeof(PvarCacheKey));
+  keyp->fsize = statbuf.st_size;
+  keyp->mtime_sec = statbuf.st_mtime;
+#  ifdef __APPLE__
+  keyp->mtime_nsec = statbuf.st_mtimespec.tv_nsec;
+#  else
+  keyp->mtime_nsec = statbuf.st_mtim.tv_nsec;
+#  endif
+  FILE* infile = fopen(pvarname, FOPEN_RB);
+  if (!infile) {
+    return 1;
+  }
+  unsigned char* hashbuf = R_CAST(unsigned char*, g_textbuf);
+  const uint32_t head_blen = MINV(keyp->fsize, S_CAST(uint64_t, kPvarCacheHashBlen));
+  if (fread_checked(hashbuf, head_blen, infile)) {
+    fclose(infile);
+    return 1;
+  }
+  keyp->head_hash = Hash32(hashbuf, head_blen);
+  if (keyp->fsize > kPvarCacheHashBlen) {
+    if (fseeko(infile, keyp->fsize - kPvarCacheHashBlen, SEEK_SET) ||
+        fread_checked(hashbuf, kPvarCacheHashBlen, infile)) {
+      fclose(infile);
+      return 1;
+    }
+    keyp->tail_hash = Hash32(hashbuf, kPvarCacheHashBlen);
+  }
+  fclose(infile);
+  // Everything GetChrCode() looks at, other than the nonstandard-name table.
+  uint32_t chr_config[kChrOffsetCt + 3];
+  for (uint32_t xymt_idx = 0; xymt_idx != kChrOffsetCt; ++xymt_idx) {
+    chr_config[xymt_idx] = cip->xymt_codes[xymt_idx];
+  }
+  chr_config[kChrOffsetCt] = cip->max_numeric_code;
+  chr_config[kChrOffsetCt + 1] = cip->max_code;
+  chr_config[kChrOffsetCt + 2] = cip->autosome_ct;
+  keyp->chr_config_hash = Hash32(chr_config, sizeof(chr_config));
+  keyp->missing_geno_char = ctou32(input_missing_geno_char);
+  return 0;
+#endif
+}
+
+BoolErr PvcWrite(const void* buf, uintptr_t len, FILE* outfile, uint64_t* fpos_ptr) {
+  *fpos_ptr += len;
+  return fwrite_checked(buf, len, outfile);
+}
+
+// Pads to the next kPvarCacheAlign boundary, and records the section offset.
+BoolErr PvcStartSection(PvcSection sec_idx, FILE* outfile, uint64_t* fpos_ptr, PvarCacheHeader* headerp) {
+  const unsigned char zeroes[kPvarCacheAlign] = {0};
+  const uint64_t fpos = *fpos_ptr;
+  const uint32_t pad_blen = RoundUpPow2(fpos, kPvarCacheAlign) - fpos;
+  if (PvcWrite(zeroes, pad_blen, outfile, fpos_ptr)) {
+    return 1;
+  }
+  headerp->sec_offsets[sec_idx] = *fpos_ptr;
+  return 0;
+}
+
+// Writes the per-variant column starting col_offset bytes into each block.
+// elem_blen == 0 indicates a bitarray.
+BoolErr PvcWriteColumn(const PvarBlockLayout* layoutp, unsigned char* block_base, uintptr_t col_offset, uint32_t elem_blen, uint32_t cms_start_block, uint32_t raw_variant_ct, FILE* outfile, uint64_t* fpos_ptr) {
+  const uint32_t block_ct = DivUp(raw_variant_ct, kLoadPvarBlockSize);
+  for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+    const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+    const uintptr_t cur_blen = elem_blen? (cur_variant_ct * elem_blen) : (BitCtToWordCt(cur_variant_ct) * sizeof(intptr_t));
+    unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, block_idx, block_base);
+    if (PvcWrite(&(block_start[col_offset]), cur_blen, outfile, fpos_ptr)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Writes a char* column as offsets into the string blob.  If mask_offset is
+// nonzero, entries whose bit in that column is clear are written as 0.
+BoolErr PvcWriteStrColumn(const PvarBlockLayout* layoutp, unsigned char* block_base, const unsigned char* strings_start, uintptr_t col_offset, uintptr_t mask_offset, uint32_t cms_start_block, uint32_t raw_variant_ct, uintptr_t* conv_buf, FILE* outfile, uint64_t* fpos_ptr) {
+  const uint32_t block_ct = DivUp(raw_variant_ct, kLoadPvarBlockSize);
+  for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+    const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+    unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, block_idx, block_base);
+    char** strs = R_CAST(char**, &(block_start[col_offset]));
+    const uintptr_t* mask = mask_offset? R_CAST(const uintptr_t*, &(block_start[mask_offset])) : nullptr;
+    for (uint32_t uii = 0; uii != cur_variant_ct; ++uii) {
+      if (mask && (!IsSet(mask, uii))) {
+        conv_buf[uii] = 0;
+      } else {
+        conv_buf[uii] = R_CAST(uintptr_t, strs[uii]) - R_CAST(uintptr_t, strings_start);
+      }
+    }
+    if (PvcWrite(conv_buf, cur_variant_ct * sizeof(intptr_t), outfile, fpos_ptr)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+uintptr_t PvarBlockAlleleIdx(const PvarBlockLayout* layoutp, unsigned char* block_base, uint32_t cms_start_block, uint32_t variant_uidx) {
+  unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, variant_uidx / kLoadPvarBlockSize, block_base);
+  return R_CAST(const uintptr_t*, &(block_start[kLoadPvarBlockSize * sizeof(int32_t)]))[variant_uidx % kLoadPvarBlockSize];
+}
+
+// Nonfatal: on failure, a warning is printed and the partial file is removed.
+// [scratch_start, scratch_end) must be unused workspace.
+void WritePvarCache(const char* cache_fname, const PvarCacheKey* keyp, const ChrInfo* cip, const uintptr_t* cm_unsorted_runs, const PvarBlockLayout* layoutp, unsigned char* block_base, const char* const* allele_storage, const unsigned char* strings_start, const unsigned char* strings_end, unsigned char* scratch_start, unsigned char* scratch_end, uintptr_t allele_ct, uint32_t raw_variant_ct, uint32_t run_ct, uint32_t qual_stored, uint32_t filter_stored, uint32_t npass_present, uint32_t nonref_stored, uint32_t cms_start_block, uint32_t info_slen) {
+  char tmp_fname[kPglFnamesize];
+  snprintf(tmp_fname, kPglFnamesize, "%s.tmp", cache_fname);
+  FILE* outfile = nullptr;
+  {
+    const uintptr_t runs_alloc = RoundUpPow2(run_ct * sizeof(PvarCacheRun), kCacheline);
+    if (S_CAST(uintptr_t, scratch_end - scratch_start) < runs_alloc + kLoadPvarBlockSize * sizeof(intptr_t)) {
+      goto WritePvarCache_fail;
+    }
+    PvarCacheRun* runs = R_CAST(PvarCacheRun*, scratch_start);
+    uintptr_t* conv_buf = R_CAST(uintptr_t*, &(scratch_start[runs_alloc]));
+    const uintptr_t strings_blen = strings_end - strings_start;
+    uint64_t run_names_blen = 0;
+    for (uint32_t run_idx = 0; run_idx != run_ct; ++run_idx) {
+      PvarCacheRun* runp = &(runs[run_idx]);
+      const uint32_t chr_code = cip->chr_file_order[run_idx];
+      const uint32_t vidx_start = cip->chr_fo_vidx_start[run_idx];
+      const uint32_t vidx_end = (run_idx + 1 == run_ct)? raw_variant_ct : cip->chr_fo_vidx_start[run_idx + 1];
+      runp->chr_code = chr_code;
+      runp->name_offset = 0;
+      if (chr_code > cip->max_code) {
+        runp->chr_code = UINT32_MAX;
+        runp->name_offset = run_names_blen;
+        run_names_blen += strlen(cip->nonstd_names[chr_code]) + 1;
+      }
+      runp->start_vidx = vidx_start;
+      uint32_t max_allele_slen = 1;
+      uint32_t max_extra_alt_ct = 0;
+      uint32_t max_id_slen = 0;
+      uint32_t max_filter_slen = 0;
+      uint32_t flags = IsSet(cm_unsorted_runs, run_idx) * kfPvcRunUnsortedCm;
+      uint32_t last_bp = 0;
+      uintptr_t prev_allele_idx = PvarBlockAlleleIdx(layoutp, block_base, cms_start_block, vidx_start);
+      const uintptr_t allele_idx_start = prev_allele_idx;
+      for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+        const uint32_t vidx_lowbits = vidx % kLoadPvarBlockSize;
+        const uint32_t block_idx = vidx / kLoadPvarBlockSize;
+        unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, block_idx, block_base);
+        const uint32_t cur_bp = R_CAST(const uint32_t*, block_start)[vidx_lowbits];
+        if (cur_bp < last_bp) {
+          flags |= kfPvcRunUnsortedBp;
+        }
+        last_bp = cur_bp;
+        if (vidx != vidx_start) {
+          const uintptr_t cur_allele_idx = R_CAST(const uintptr_t*, &(block_start[kLoadPvarBlockSize * sizeof(int32_t)]))[vidx_lowbits];
+          const uint32_t extra_alt_ct = cur_allele_idx - prev_allele_idx - 2;
+          if (extra_alt_ct > max_extra_alt_ct) {
+            max_extra_alt_ct = extra_alt_ct;
+          }
+          prev_allele_idx = cur_allele_idx;
+        }
+        const uint32_t id_slen = strlen(R_CAST(char* const*, &(block_start[kLoadPvarBlockSize * (sizeof(int32_t) + sizeof(intptr_t))]))[vidx_lowbits]);
+        if (id_slen > max_id_slen) {
+          max_id_slen = id_slen;
+        }
+        if (filter_stored && IsSet(R_CAST(const uintptr_t*, &(block_start[layoutp->filter_npass_offset])), vidx_lowbits)) {
+          flags |= kfPvcRunNpassFilter;
+          const uint32_t filter_slen = strlen(R_CAST(char* const*, &(block_start[layoutp->filter_storage_offset]))[vidx_lowbits]);
+          if (filter_slen > max_filter_slen) {
+            max_filter_slen = filter_slen;
+          }
+        }
+        if ((block_idx >= cms_start_block) && (R_CAST(const double*, &(block_start[layoutp->stride_base]))[vidx_lowbits] != 0.0)) {
+          flags |= kfPvcRunNzeroCm;
+        }
+      }
+      const uintptr_t allele_idx_end = (vidx_end == raw_variant_ct)? allele_ct : PvarBlockAlleleIdx(layoutp, block_base, cms_start_block, vidx_end);
+      const uint32_t last_extra_alt_ct = allele_idx_end - prev_allele_idx - 2;
+      if (last_extra_alt_ct > max_extra_alt_ct) {
+        max_extra_alt_ct = last_extra_alt_ct;
+      }
+      for (uintptr_t allele_idx = allele_idx_start; allele_idx != allele_idx_end; ++allele_idx) {
+        const char* cur_allele = allele_storage[allele_idx];
+        if (R_CAST(uintptr_t, cur_allele) - R_CAST(uintptr_t, strings_start) < strings_blen) {
+          const uint32_t allele_slen = strlen(cur_allele);
+          if (allele_slen > max_allele_slen) {
+            max_allele_slen = allele_slen;
+          }
+        }
+      }
+      runp->max_allele_slen = max_allele_slen;
+      runp->max_extra_alt_ct = max_extra_alt_ct;
+      runp->max_id_slen = max_id_slen;
+      runp->max_filter_slen = max_filter_slen;
+      runp->flags = flags;
+    }
+
+    outfile = fopen(tmp_fname, FOPEN_WB);
+    if (!outfile) {
+      goto WritePvarCache_fail;
+    }
+    PvarCacheHeader header;
+    memset(&header, 0, sizeof(PvarCacheHeader));
+    memcpy(header.magic, "PLINKPVC", 8);
+    header.version = kPvarCacheVersion;
+    header.word_blen = sizeof(intptr_t);
+    header.key = *keyp;
+    header.allele_ct = allele_ct;
+    header.run_names_blen = run_names_blen;
+    header.strings_blen = strings_blen;
+    header.raw_variant_ct = raw_variant_ct;
+    header.run_ct = run_ct;
+    header.info_slen = info_slen;
+    uint64_t fpos = 0;
+    if (PvcWrite(&header, sizeof(PvarCacheHeader), outfile, &fpos) ||
+        PvcStartSection(kPvcSecRuns, outfile, &fpos, &header) ||
+        PvcWrite(runs, run_ct * sizeof(PvarCacheRun), outfile, &fpos)) {
+      goto WritePvarCache_fail;
+    }
+    if (run_names_blen) {
+      if (PvcStartSection(kPvcSecRunNames, outfile, &fpos, &header)) {
+        goto WritePvarCache_fail;
+      }
+      for (uint32_t run_idx = 0; run_idx != run_ct; ++run_idx) {
+        const uint32_t chr_code = cip->chr_file_order[run_idx];
+        if (chr_code > cip->max_code) {
+          const char* chr_name = cip->nonstd_names[chr_code];
+          if (PvcWrite(chr_name, strlen(chr_name) + 1, outfile, &fpos)) {
+            goto WritePvarCache_fail;
+          }
+        }
+      }
+    }
+    if (PvcStartSection(kPvcSecBps, outfile, &fpos, &header) ||
+        PvcWriteColumn(layoutp, block_base, 0, sizeof(int32_t), cms_start_block, raw_variant_ct, outfile, &fpos) ||
+        PvcStartSection(kPvcSecIds, outfile, &fpos, &header) ||
+        PvcWriteStrColumn(layoutp, block_base, strings_start, kLoadPvarBlockSize * (sizeof(int32_t) + sizeof(intptr_t)), 0, cms_start_block, raw_variant_ct, conv_buf, outfile, &fpos) ||
+        PvcStartSection(kPvcSecAlleles, outfile, &fpos, &header)) {
+      goto WritePvarCache_fail;
+    }
+    for (uintptr_t allele_idx_base = 0; allele_idx_base < allele_ct; allele_idx_base += kLoadPvarBlockSize) {
+      const uintptr_t cur_allele_ct = MINV(allele_ct - allele_idx_base, kLoadPvarBlockSize);
+      const char* const* cur_alleles = &(allele_storage[allele_idx_base]);
+      for (uintptr_t ulii = 0; ulii != cur_allele_ct; ++ulii) {
+        const uintptr_t str_offset = R_CAST(uintptr_t, cur_alleles[ulii]) - R_CAST(uintptr_t, strings_start);
+        if (str_offset < strings_blen) {
+          conv_buf[ulii] = str_offset;
+        } else {
+          conv_buf[ulii] = kPvarCacheOneCharTag | (R_CAST(uintptr_t, cur_alleles[ulii]) - R_CAST(uintptr_t, g_one_char_strs));
+        }
+      }
+      if (PvcWrite(conv_buf, cur_allele_ct * sizeof(intptr_t), outfile, &fpos)) {
+        goto WritePvarCache_fail;
+      }
+    }
+    if (allele_ct != 2 * S_CAST(uintptr_t, raw_variant_ct)) {
+      if (PvcStartSection(kPvcSecAlleleIdxs, outfile, &fpos, &header) ||
+          PvcWriteColumn(layoutp, block_base, kLoadPvarBlockSize * sizeof(int32_t), sizeof(intptr_t), cms_start_block, raw_variant_ct, outfile, &fpos)) {
+        goto WritePvarCache_fail;
+      }
+    }
+    if (nonref_stored) {
+      if (PvcStartSection(kPvcSecNonref, outfile, &fpos, &header) ||
+          PvcWriteColumn(layoutp, block_base, layoutp->nonref_offset, 0, cms_start_block, raw_variant_ct, outfile, &fpos)) {
+        goto WritePvarCache_fail;
+      }
+    }
+    if (cms_start_block != UINT32_MAX) {
+      if (PvcStartSection(kPvcSecCms, outfile, &fpos, &header)) {
+        goto WritePvarCache_fail;
+      }
+      // blocks before the first nonzero CM don't have a cms[] column
+      ZeroWArr(kLoadPvarBlockSize, conv_buf);
+      for (uint32_t block_idx = 0; block_idx != cms_start_block; ++block_idx) {
+        if (PvcWrite(conv_buf, kLoadPvarBlockSize * sizeof(double), outfile, &fpos)) {
+          goto WritePvarCache_fail;
+        }
+      }
+      const uint32_t block_ct = DivUp(raw_variant_ct, kLoadPvarBlockSize);
+      for (uint32_t block_idx = cms_start_block; block_idx != block_ct; ++block_idx) {
+        const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+        unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, block_idx, block_base);
+        if (PvcWrite(&(block_start[layoutp->stride_base]), cur_variant_ct * sizeof(double), outfile, &fpos)) {
+          goto WritePvarCache_fail;
+        }
+      }
+    }
+    if (qual_stored) {
+      if (PvcStartSection(kPvcSecQualPresent, outfile, &fpos, &header) ||
+          PvcWriteColumn(layoutp, block_base, layoutp->qual_present_offset, 0, cms_start_block, raw_variant_ct, outfile, &fpos) ||
+          PvcStartSection(kPvcSecQuals, outfile, &fpos, &header) ||
+          PvcWriteColumn(layoutp, block_base, layoutp->quals_offset, sizeof(float), cms_start_block, raw_variant_ct, outfile, &fpos)) {
+        goto WritePvarCache_fail;
+      }
+    }
+    if (filter_stored) {
+      if (PvcStartSection(kPvcSecFilterPresent, outfile, &fpos, &header) ||
+          PvcWriteColumn(layoutp, block_base, layoutp->filter_present_offset, 0, cms_start_block, raw_variant_ct, outfile, &fpos) ||
+          PvcStartSection(kPvcSecFilterNpass, outfile, &fpos, &header) ||
+          PvcWriteColumn(layoutp, block_base, layoutp->filter_npass_offset, 0, cms_start_block, raw_variant_ct, outfile, &fpos)) {
+        goto WritePvarCache_fail;
+      }
+      if (npass_present) {
+        if (PvcStartSection(kPvcSecFilters, outfile, &fpos, &header) ||
+            PvcWriteStrColumn(layoutp, block_base, strings_start, layoutp->filter_storage_offset, layoutp->filter_npass_offset, cms_start_block, raw_variant_ct, conv_buf, outfile, &fpos)) {
+          goto WritePvarCache_fail;
+        }
+      }
+    }
+    if (PvcStartSection(kPvcSecStrings, outfile, &fpos, &header) ||
+        PvcWrite(strings_start, strings_blen, outfile, &fpos) ||
+        fseeko(outfile, 0, SEEK_SET) ||
+        fwrite_checked(&header, sizeof(PvarCacheHeader), outfile) ||
+        fclose_null(&outfile) ||
+        rename(tmp_fname, cache_fname)) {
+      goto WritePvarCache_fail;
+    }
+    logprintfww("--pvar-cache: %s written.\n", cache_fname);
+  }
+  while (0) {
+  WritePvarCache_fail:
+    if (outfile) {
+      fclose(outfile);
+    }
+    unlink(tmp_fname);
+    logerrprintfww("Warning: Failed to write --pvar-cache file %s.\n", cache_fname);
+  }
+}
+
+typedef struct PvarCacheLoadStruct {
+  unsigned char* tmp_alloc_base;
+  unsigned char* tmp_alloc_end;
+  uintptr_t allele_ct;
+  uint32_t raw_variant_ct;
+  uint32_t chr_ct;
+  uint32_t exclude_ct;
+  uint32_t max_extra_alt_ct;
+  uint32_t max_allele_slen;
+  uint32_t max_variant_id_slen;
+  uint32_t max_filter_slen;
+  uint32_t info_slen;
+  uint32_t at_least_one_npass_filter;
+  uint32_t at_least_one_nzero_cm;
+  UnsortedVar vpos_sortstatus;
+} PvarCacheLoad;
+
+BoolErr PvcReadColumn(const PvarBlockLayout* layoutp, uint64_t sec_offset, uintptr_t col_offset, uint32_t elem_blen, uint32_t cms_start_block, uint32_t raw_variant_ct, unsigned char* block_base, FILE* infile) {
+  if (fseeko(infile, sec_offset, SEEK_SET)) {
+    return 1;
+  }
+  const uint32_t block_ct = DivUp(raw_variant_ct, kLoadPvarBlockSize);
+  for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+    const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+    const uintptr_t cur_blen = elem_blen? (cur_variant_ct * elem_blen) : (BitCtToWordCt(cur_variant_ct) * sizeof(intptr_t));
+    unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, block_idx, block_base);
+    if (fread_checked(&(block_start[col_offset]), cur_blen, infile)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Converts a column written by PvcWriteStrColumn() back to pointers.
+BoolErr PvcReadStrColumn(const PvarBlockLayout* layoutp, uint64_t sec_offset, const unsigned char* strings_start, uintptr_t strings_blen, uintptr_t col_offset, uint32_t cms_start_block, uint32_t raw_variant_ct, unsigned char* block_base, FILE* infile) {
+  if (PvcReadColumn(layoutp, sec_offset, col_offset, sizeof(intptr_t), cms_start_block, raw_variant_ct, block_base, infile)) {
+    return 1;
+  }
+  const uint32_t block_ct = DivUp(raw_variant_ct, kLoadPvarBlockSize);
+  for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+    const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+    unsigned char* block_start = PvarBlockStart(layoutp, cms_start_block, block_idx, block_base);
+    uintptr_t* strs = R_CAST(uintptr_t*, &(block_start[col_offset]));
+    for (uint32_t uii = 0; uii != cur_variant_ct; ++uii) {
+      const uintptr_t str_offset = strs[uii];
+      if (str_offset >= strings_blen) {
+        return 1;
+      }
+      strs[uii] = R_CAST(uintptr_t, &(strings_start[str_offset]));
+    }
+  }
+  return 0;
+}
+
+// Returns 1 if the cache is missing, stale, or corrupt, or lacks a column the
+// current run needs; the caller then zeroes loaded_chr_mask and parses the
+// text.  Variants on chromosomes outside chr_mask are marked as skipped, the
+// same way the main loop would do it.
+BoolErr LoadPvarCache(const char* cache_fname, const PvarCacheKey* keyp, const uintptr_t* chr_mask, uint32_t prohibit_extra_chrs, uint32_t qual_needed, uint32_t filter_needed, uint32_t nonref_needed, uint32_t info_needed, const char** allele_storage, const char* const* allele_storage_limit, unsigned char* block_base, unsigned char* strings_end, ChrInfo* cip, uintptr_t* loaded_chr_mask, PvarCacheLoad* resultp) {
+  FILE* infile = fopen(cache_fname, FOPEN_RB);
+  if (!infile) {
+    return 1;
+  }
+  BoolErr reterr = 1;
+  {
+    PvarCacheHeader header;
+    if (fread_checked(&header, sizeof(PvarCacheHeader), infile) ||
+        (!memequal(header.magic, "PLINKPVC", 8)) ||
+        (header.version != kPvarCacheVersion) ||
+        (header.word_blen != sizeof(intptr_t)) ||
+        (!memequal(&(header.key), keyp, sizeof(PvarCacheKey)))) {
+      goto LoadPvarCache_ret_1;
+    }
+    const uint32_t raw_variant_ct = header.raw_variant_ct;
+    const uint32_t run_ct = header.run_ct;
+    const uintptr_t allele_ct = header.allele_ct;
+    const uintptr_t run_names_blen = header.run_names_blen;
+    const uintptr_t strings_blen = header.strings_blen;
+    const uint64_t* sec_offsets = header.sec_offsets;
+    if ((!raw_variant_ct) || (raw_variant_ct > kPglMaxVariantCt) || (!run_ct) || (run_ct > raw_variant_ct) ||
+        (allele_ct < 2 * S_CAST(uintptr_t, raw_variant_ct)) ||
+        (S_CAST(uintptr_t, allele_storage_limit - allele_storage) < allele_ct) ||
+        (!sec_offsets[kPvcSecRuns]) || (!sec_offsets[kPvcSecBps]) || (!sec_offsets[kPvcSecIds]) || (!sec_offsets[kPvcSecAlleles]) || (!sec_offsets[kPvcSecStrings]) ||
+        ((!sec_offsets[kPvcSecAlleleIdxs]) && (allele_ct != 2 * S_CAST(uintptr_t, raw_variant_ct))) ||
+        (run_names_blen && (!sec_offsets[kPvcSecRunNames])) ||
+        (qual_needed && ((!sec_offsets[kPvcSecQualPresent]) || (!sec_offsets[kPvcSecQuals]))) ||
+        (filter_needed && ((!sec_offsets[kPvcSecFilterPresent]) || (!sec_offsets[kPvcSecFilterNpass]))) ||
+        (nonref_needed && (!sec_offsets[kPvcSecNonref])) ||
+        (info_needed && (header.info_slen == UINT32_MAX))) {
+      goto LoadPvarCache_ret_1;
+    }
+    // Run records and names go just below the string blob; they're only
+    // needed until the end of this function.
+    unsigned char* strings_start = &(strings_end[-S_CAST(intptr_t, strings_blen)]);
+    const uintptr_t runs_blen = run_ct * sizeof(PvarCacheRun);
+    if (S_CAST(uintptr_t, strings_start - block_base) < runs_blen + run_names_blen + kCacheline) {
+      goto LoadPvarCache_ret_1;
+    }
+    PvarCacheRun* runs = R_CAST(PvarCacheRun*, RoundDownPow2(R_CAST(uintptr_t, strings_start) - runs_blen - run_names_blen, kCacheline));
+    char* run_names = R_CAST(char*, &(runs[run_ct]));
+    if (fseeko(infile, sec_offsets[kPvcSecRuns], SEEK_SET) ||
+        fread_checked(runs, runs_blen, infile)) {
+      goto LoadPvarCache_ret_1;
+    }
+    if (run_names_blen) {
+      if (fseeko(infile, sec_offsets[kPvcSecRunNames], SEEK_SET) ||
+          fread_checked(run_names, run_names_blen, infile) ||
+          run_names[run_names_blen - 1]) {
+        goto LoadPvarCache_ret_1;
+      }
+    }
+
+    uint32_t exclude_ct = 0;
+    uint32_t max_extra_alt_ct = 0;
+    uint32_t max_allele_slen = 1;
+    uint32_t max_variant_id_slen = 0;
+    uint32_t max_filter_slen = 0;
+    uint32_t at_least_one_npass_filter = 0;
+    uint32_t at_least_one_nzero_cm = 0;
+    UnsortedVar vpos_sortstatus = kfUnsortedVar0;
+    for (uint32_t run_idx = 0; run_idx != run_ct; ++run_idx) {
+      PvarCacheRun* runp = &(runs[run_idx]);
+      const uint32_t vidx_start = runp->start_vidx;
+      const uint32_t vidx_end = (run_idx + 1 == run_ct)? raw_variant_ct : runs[run_idx + 1].start_vidx;
+      // (vidx_end <= vidx_start check on the previous iteration ensures
+      // start_vidx is strictly increasing)
+      if (((!run_idx) && vidx_start) || (vidx_end <= vidx_start) || (vidx_end > raw_variant_ct)) {
+        goto LoadPvarCache_ret_1;
+      }
+      uint32_t chr_code = runp->chr_code;
+      if (chr_code == UINT32_MAX) {
+        if (runp->name_offset >= run_names_blen) {
+          goto LoadPvarCache_ret_1;
+        }
+        const char* chr_name = &(run_names[runp->name_offset]);
+        const uint32_t name_slen = strlen(chr_name);
+        chr_code = GetChrCode(chr_name, cip, name_slen);
+        if (IsI32Neg(chr_code)) {
+          // leave error reporting to the text parser
+          if (prohibit_extra_chrs || (chr_code == UINT32_MAXM1) || TryToAddChrName(chr_name, cache_fname, 0, name_slen, 0, &chr_code, cip)) {
+            goto LoadPvarCache_ret_1;
+          }
+        }
+      } else if (chr_code > cip->max_code) {
+        goto LoadPvarCache_ret_1;
+      }
+      if (IsSet(loaded_chr_mask, chr_code)) {
+        goto LoadPvarCache_ret_1;
+      }
+      SetBit(chr_code, loaded_chr_mask);
+      cip->chr_file_order[run_idx] = chr_code;
+      cip->chr_fo_vidx_start[run_idx] = vidx_start;
+      cip->chr_idx_to_foidx[chr_code] = run_idx;
+      runp->chr_code = chr_code;
+      const uint32_t flags = runp->flags;
+      if (((flags & kfPvcRunNzeroCm) && (!sec_offsets[kPvcSecCms])) ||
+          (filter_needed && (flags & kfPvcRunNpassFilter) && (!sec_offsets[kPvcSecFilters]))) {
+        goto LoadPvarCache_ret_1;
+      }
+      if (!IsSet(chr_mask, chr_code)) {
+        exclude_ct += vidx_end - vidx_start;
+        if (nonref_needed && (runp->max_extra_alt_ct > max_extra_alt_ct)) {
+          max_extra_alt_ct = runp->max_extra_alt_ct;
+        }
+        continue;
+      }
+      max_extra_alt_ct = MAXV(max_extra_alt_ct, runp->max_extra_alt_ct);
+      max_allele_slen = MAXV(max_allele_slen, runp->max_allele_slen);
+      max_variant_id_slen = MAXV(max_variant_id_slen, runp->max_id_slen);
+      if (flags & kfPvcRunUnsortedBp) {
+        vpos_sortstatus |= kfUnsortedVarBp;
+      }
+      if (flags & kfPvcRunUnsortedCm) {
+        vpos_sortstatus |= kfUnsortedVarCm;
+      }
+      if (flags & kfPvcRunNzeroCm) {
+        at_least_one_nzero_cm = 1;
+      }
+      if (filter_needed) {
+        max_filter_slen = MAXV(max_filter_slen, runp->max_filter_slen);
+        if (flags & kfPvcRunNpassFilter) {
+          at_least_one_npass_filter = 1;
+        }
+      }
+    }
+    if (max_extra_alt_ct >= kPglMaxAltAlleleCt) {
+      goto LoadPvarCache_ret_1;
+    }
+
+    // Now lay out the blocks the same way the main loop would have.
+    PvarBlockLayout layout;
+    InitPvarBlockLayout(qual_needed, filter_needed, nonref_needed, &layout);
+    const uint32_t cms_start_block = at_least_one_nzero_cm? 0 : UINT32_MAX;
+    const uint32_t block_ct = DivUp(raw_variant_ct, kLoadPvarBlockSize);
+    const uintptr_t blocks_blen = S_CAST(uintptr_t, block_ct) * (layout.stride_base + at_least_one_nzero_cm * kLoadPvarBlockSize * sizeof(double));
+    if (blocks_blen > S_CAST(uintptr_t, R_CAST(unsigned char*, runs) - block_base)) {
+      goto LoadPvarCache_ret_1;
+    }
+    if (fseeko(infile, sec_offsets[kPvcSecStrings], SEEK_SET) ||
+        fread_checked(strings_start, strings_blen, infile) ||
+        (strings_blen && strings_start[strings_blen - 1])) {
+      goto LoadPvarCache_ret_1;
+    }
+    if (fseeko(infile, sec_offsets[kPvcSecAlleles], SEEK_SET) ||
+        fread_checked(allele_storage, allele_ct * sizeof(intptr_t), infile)) {
+      goto LoadPvarCache_ret_1;
+    }
+    uintptr_t* allele_offsets = R_CAST(uintptr_t*, allele_storage);
+    for (uintptr_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+      const uintptr_t allele_offset = allele_offsets[allele_idx];
+      if (allele_offset & kPvarCacheOneCharTag) {
+        const uintptr_t one_char_offset = allele_offset ^ kPvarCacheOneCharTag;
+        if ((one_char_offset >= 512) || (one_char_offset & 1)) {
+          goto LoadPvarCache_ret_1;
+        }
+        allele_storage[allele_idx] = &(g_one_char_strs[one_char_offset]);
+      } else {
+        if (allele_offset >= strings_blen) {
+          goto LoadPvarCache_ret_1;
+        }
+        allele_storage[allele_idx] = R_CAST(const char*, &(strings_start[allele_offset]));
+      }
+    }
+    const uintptr_t allele_idxs_col_offset = kLoadPvarBlockSize * sizeof(int32_t);
+    if (sec_offsets[kPvcSecAlleleIdxs]) {
+      if (PvcReadColumn(&layout, sec_offsets[kPvcSecAlleleIdxs], allele_idxs_col_offset, sizeof(intptr_t), cms_start_block, raw_variant_ct, block_base, infile)) {
+        goto LoadPvarCache_ret_1;
+      }
+      // must be strictly increasing in steps of at least 2
+      uintptr_t expected_min = 0;
+      for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+        const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+        const uintptr_t* cur_allele_idxs = R_CAST(const uintptr_t*, &(PvarBlockStart(&layout, cms_start_block, block_idx, block_base)[allele_idxs_col_offset]));
+        for (uint32_t uii = 0; uii != cur_variant_ct; ++uii) {
+          const uintptr_t cur_allele_idx = cur_allele_idxs[uii];
+          if ((cur_allele_idx < expected_min) || ((!block_idx) && (!uii) && cur_allele_idx)) {
+            goto LoadPvarCache_ret_1;
+          }
+          expected_min = cur_allele_idx + 2;
+        }
+      }
+      if (expected_min > allele_ct) {
+        goto LoadPvarCache_ret_1;
+      }
+    } else {
+      for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+        const uint32_t cur_variant_ct = MINV(raw_variant_ct - block_idx * kLoadPvarBlockSize, kLoadPvarBlockSize);
+        uintptr_t* cur_allele_idxs = R_CAST(uintptr_t*, &(PvarBlockStart(&layout, cms_start_block, block_idx, block_base)[allele_idxs_col_offset]));
+        const uintptr_t allele_idx_base = 2 * S_CAST(uintptr_t, block_idx) * kLoadPvarBlockSize;
+        for (uint32_t uii = 0; uii != cur_variant_ct; ++uii) {
+          cur_allele_idxs[uii] = allele_idx_base + 2 * uii;
+        }
+      }
+    }
+    if (PvcReadColumn(&layout, sec_offsets[kPvcSecBps], 0, sizeof(int32_t), cms_start_block, raw_variant_ct, block_base, infile) ||
+        PvcReadStrColumn(&layout, sec_offsets[kPvcSecIds], strings_start, strings_blen, kLoadPvarBlockSize * (sizeof(int32_t) + sizeof(intptr_t)), cms_start_block, raw_variant_ct, block_base, infile)) {
+      goto LoadPvarCache_ret_1;
+    }
+    for (uint32_t block_idx = 0; block_idx != block_ct; ++block_idx) {
+      unsigned char* block_start = PvarBlockStart(&layout, cms_start_block, block_idx, block_base);
+      SetAllWArr(kLoadPvarBlockSize / kBitsPerWord, R_CAST(uintptr_t*, &(block_start[kLoadPvarBlockSize * (sizeof(int32_t) + 2 * sizeof(intptr_t))])));
+    }
+    if (qual_needed) {
+      if (PvcReadColumn(&layout, sec_offsets[kPvcSecQualPresent], layout.qual_present_offset, 0, cms_start_block, raw_variant_ct, block_base, infile) ||
+          PvcReadColumn(&layout, sec_offsets[kPvcSecQuals], layout.quals_offset, sizeof(float), cms_start_block, raw_variant_ct, block_base, infile)) {
+        goto LoadPvarCache_ret_1;
+      }
+    }
+    if (filter_needed) {
+      if (PvcReadColumn(&layout, sec_offsets[kPvcSecFilterPresent], layout.filter_present_offset, 0, cms_start_block, raw_variant_ct, block_base, infile) ||
+          PvcReadColumn(&layout, sec_offsets[kPvcSecFilterNpass], layout.filter_npass_offset, 0, cms_start_block, raw_variant_ct, block_base, infile)) {
+        goto LoadPvarCache_ret_1;
+      }
+      if (at_least_one_npass_filter) {
+        // PASS entries were written as offset 0, which is always valid
+        if (PvcReadStrColumn(&layout, sec_offsets[kPvcSecFilters], strings_start, strings_blen, layout.filter_storage_offset, cms_start_block, raw_variant_ct, block_base, infile)) {
+          goto LoadPvarCache_ret_1;
+        }
+      }
+    }
+    if (nonref_needed) {
+      if (PvcReadColumn(&layout, sec_offsets[kPvcSecNonref], layout.nonref_offset, 0, cms_start_block, raw_variant_ct, block_base, infile)) {
+        goto LoadPvarCache_ret_1;
+      }
+    }
+    if (at_least_one_nzero_cm) {
+      if (PvcReadColumn(&layout, sec_offsets[kPvcSecCms], layout.stride_base, sizeof(double), cms_start_block, raw_variant_ct, block_base, infile)) {
+        goto LoadPvarCache_ret_1;
+      }
+    }
+
+    if (exclude_ct) {
+      const char* missing_allele_str = &(g_one_char_strs[92]);
+      for (uint32_t run_idx = 0; run_idx != run_ct; ++run_idx) {
+        if (IsSet(chr_mask, runs[run_idx].chr_code)) {
+          continue;
+        }
+        const uint32_t vidx_start = runs[run_idx].start_vidx;
+        const uint32_t vidx_end = (run_idx + 1 == run_ct)? raw_variant_ct : runs[run_idx + 1].start_vidx;
+        for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+          const uint32_t vidx_lowbits = vidx % kLoadPvarBlockSize;
+          unsigned char* block_start = PvarBlockStart(&layout, cms_start_block, vidx / kLoadPvarBlockSize, block_base);
+          // skipped variants keep the last included position on their
+          // chromosome, which is always 0 here
+          R_CAST(uint32_t*, block_start)[vidx_lowbits] = 0;
+          ClearBit(vidx_lowbits, R_CAST(uintptr_t*, &(block_start[kLoadPvarBlockSize * (sizeof(int32_t) + 2 * sizeof(intptr_t))])));
+          if (qual_needed) {
+            ClearBit(vidx_lowbits, R_CAST(uintptr_t*, &(block_start[layout.qual_present_offset])));
+          }
+          if (filter_needed) {
+            ClearBit(vidx_lowbits, R_CAST(uintptr_t*, &(block_start[layout.filter_present_offset])));
+            ClearBit(vidx_lowbits, R_CAST(uintptr_t*, &(block_start[layout.filter_npass_offset])));
+          }
+          if (at_least_one_nzero_cm) {
+            R_CAST(double*, &(block_start[layout.stride_base]))[vidx_lowbits] = 0.0;
+          }
+        }
+        const uintptr_t allele_idx_start = PvarBlockAlleleIdx(&layout, block_base, cms_start_block, vidx_start);
+        const uintptr_t allele_idx_end = (vidx_end == raw_variant_ct)? allele_ct : PvarBlockAlleleIdx(&layout, block_base, cms_start_block, vidx_end);
+        for (uintptr_t allele_idx = allele_idx_start; allele_idx != allele_idx_end; ++allele_idx) {
+          allele_storage[allele_idx] = missing_allele_str;
+        }
+      }
+    }
+    resultp->tmp_alloc_base = &(block_base[blocks_blen]);
+    resultp->tmp_alloc_end = strings_start;
+    resultp->allele_ct = allele_ct;
+    resultp->raw_variant_ct = raw_variant_ct;
+    resultp->chr_ct = run_ct;
+    resultp->exclude_ct = exclude_ct;
+    resultp->max_extra_alt_ct = max_extra_alt_ct;
+    resultp->max_allele_slen = max_allele_slen;
+    resultp->max_variant_id_slen = max_variant_id_slen;
+    resultp->max_filter_slen = max_filter_slen;
+    resultp->info_slen = header.info_slen;
+    resultp->at_least_one_npass_filter = at_least_one_npass_filter;
+    resultp->at_least_one_nzero_cm = at_least_one_nzero_cm;
+    resultp->vpos_sortstatus = vpos_sortstatus;
+    reterr = 0;
+  }
+ LoadPvarCache_ret_1:
+  fclose(infile);
+  return reterr;
+}
+
 PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, char input_missing_geno_char, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr) {
   // chr_info, max_variant_id_slen, and info_reload_slen are in/out; just
   // outparameters after them.  (Due to its large size in some VCFs, INFO is
@@ -892,7 +1847,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
   uint32_t max_allele_slen = 1;
   PglErr reterr = kPglRetSuccess;
   TextStream pvar_txs;
+  ThreadGroup tg;
   PreinitTextStream(&pvar_txs);
+  PreinitThreads(&tg);
   {
     const uintptr_t quarter_left = RoundDownPow2(bigstack_left() / 4, kCacheline);
     uint32_t max_line_blen;
@@ -903,12 +1860,16 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     // we're limited to 134M variants
     unsigned char* rlstream_start = &(bigstack_mark[quarter_left]);
     g_bigstack_base = rlstream_start;
-    uint32_t decompress_thread_ct = max_thread_ct - 1;
-    // 3 still seems best on a heavily multicore Linux test machine
-    if (decompress_thread_ct > 3) {
-      decompress_thread_ct = 3;
-    } else if (!decompress_thread_ct) {
-      decompress_thread_ct = 1;
+    // Main thread + lexing threads do most of the work now, so decompression
+    // gets a quarter of the threads (up to 3, which still seems best on a
+    // heavily multicore Linux test machine).
+    uint32_t decompress_thread_ct = 1;
+    if (max_thread_ct > 4) {
+      decompress_thread_ct = MINV(max_thread_ct / 4, 3);
+    }
+    uint32_t lex_thread_ct = 1;
+    if (max_thread_ct > decompress_thread_ct) {
+      lex_thread_ct = MINV(max_thread_ct - decompress_thread_ct, kMaxLoadPvarLexThreads);
     }
     reterr = InitTextStream(pvarname, max_line_blen, decompress_thread_ct, &pvar_txs);
     if (unlikely(reterr)) {
@@ -1189,6 +2150,8 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     const char** allele_storage_limit = R_CAST(const char**, &(rlstream_start[-S_CAST(intptr_t, kLoadPvarBlockSize * 2 * sizeof(intptr_t))]));
 
     uintptr_t* loaded_chr_mask = R_CAST(uintptr_t*, tmp_alloc_base);
+    // indexed by chrs_encountered_m1; only needed for --pvar-cache
+    uintptr_t* cm_unsorted_runs = &(loaded_chr_mask[kChrMaskWords]);
     unsigned char* tmp_alloc_end = bigstack_end_mark;
     // guaranteed to succeed since max_line_blen > 128k, etc.
     /*
@@ -1196,9 +2159,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       goto LoadPvar_ret_NOMEM;
     }
     */
-    tmp_alloc_base = &(tmp_alloc_base[RoundUpPow2(kChrMaskWords * sizeof(intptr_t), kCacheline)]);
+    tmp_alloc_base = &(tmp_alloc_base[RoundUpPow2(2 * kChrMaskWords * sizeof(intptr_t), kCacheline)]);
     // bugfix (2 Jun 2017): forgot to zero-initialize loaded_chr_mask
-    ZeroWArr(kChrMaskWords, loaded_chr_mask);
+    ZeroWArr(2 * kChrMaskWords, loaded_chr_mask);
 
     InfoExist* info_existp = nullptr;
     if (require_info_flattened) {
@@ -1268,6 +2231,33 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       }
     }
 
+    const uintptr_t lexed_lines_alloc = RoundUpPow2(kLoadPvarLexBatchSize * sizeof(PvarLexedLine), kCacheline);
+    if (unlikely((S_CAST(uintptr_t, tmp_alloc_end - tmp_alloc_base) < lexed_lines_alloc) ||
+                 SetThreadCt0(lex_thread_ct - 1, &tg))) {
+      goto LoadPvar_ret_NOMEM;
+    }
+    PvarLexedLine* lexed_lines = R_CAST(PvarLexedLine*, tmp_alloc_base);
+    tmp_alloc_base = &(tmp_alloc_base[lexed_lines_alloc]);
+    LoadPvarLexCtx lex_ctx;
+    lex_ctx.cip = cip;
+    lex_ctx.col_types = col_types;
+    lex_ctx.col_skips = col_skips;
+    lex_ctx.info_existp = info_existp;
+    lex_ctx.info_nonexistp = info_nonexistp;
+    lex_ctx.info_keepp = &info_keep;
+    lex_ctx.info_removep = &info_remove;
+    lex_ctx.relevant_postchr_col_ct = relevant_postchr_col_ct;
+    lex_ctx.info_col_present = info_col_present;
+    lex_ctx.info_pr_exists = info_pr_exists;
+    lex_ctx.load_qual_col = load_qual_col;
+    lex_ctx.cm_col_present = cm_col_present;
+    lex_ctx.lexed_lines = lexed_lines;
+    lex_ctx.cur_line_ct = 0;
+    if (lex_thread_ct > 1) {
+      SetThreadFuncAndData(LoadPvarLexThread, &lex_ctx, &tg);
+    }
+    uint32_t lexed_line_idx = 0;
+
     // prevent later return-array allocations from overlapping with temporary
     // storage
     g_bigstack_end = tmp_alloc_base;
@@ -1276,6 +2266,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     if (R_CAST(const char*, tmp_alloc_end) > (&(g_one_char_strs[512 - kMaxIdSlen]))) {
       tmp_alloc_end = R_CAST(unsigned char*, K_CAST(char*, &(g_one_char_strs[512 - kMaxIdSlen])));
     }
+    // IDs, long alleles, and FILTER strings end up in [tmp_alloc_end,
+    // strings_end).
+    unsigned char* strings_end = tmp_alloc_end;
     const uint32_t prohibit_extra_chrs = (misc_flags / kfMiscProhibitExtraChr) & 1;
     const uint32_t merge_par = ((misc_flags & (kfMiscMergePar | kfMiscMergeX)) != 0);
     const uint32_t x_code = cip->xymt_codes[kChrOffsetX];
@@ -1349,6 +2342,44 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     uint32_t is_split_chr = 0;
     UnsortedVar vpos_sortstatus = kfUnsortedVar0;
 
+    // --pvar-cache is bypassed when anything other than the chromosome filter
+    // could cause variants to be skipped, or IDs to be rewritten.
+    char pvar_cache_fname[kPglFnamesize];
+    PvarCacheKey pvar_cache_key;
+    uint32_t pvar_cache_ok = 0;
+    if ((pvar_psam_flags & kfPvarCache) && (!(load_qual_col & 1)) && (!(load_filter_col & 1)) && (!info_existp) && (!info_nonexistp) && (!info_keep.prekey) && (!info_remove.prekey) && (!varid_templatep) && (!snps_only) && (!filter_min_allele_ct) && (filter_max_allele_ct > kPglMaxAltAlleleCt) && (!merge_par) && (!cip->zero_extra_chrs)) {
+      pvar_cache_ok = !InitPvarCache(pvarname, cip, input_missing_geno_char, pvar_cache_fname, &pvar_cache_key);
+    }
+    if (pvar_cache_ok) {
+      PvarCacheLoad pcl;
+      if (!LoadPvarCache(pvar_cache_fname, &pvar_cache_key, chr_mask, prohibit_extra_chrs, load_qual_col > 1, load_filter_col > 1, info_pr_exists, info_col_present, allele_storage, allele_storage_limit, tmp_alloc_base, strings_end, cip, loaded_chr_mask, &pcl)) {
+        tmp_alloc_base = pcl.tmp_alloc_base;
+        tmp_alloc_end = pcl.tmp_alloc_end;
+        allele_storage_iter = &(allele_storage[pcl.allele_ct]);
+        raw_variant_ct = pcl.raw_variant_ct;
+        chrs_encountered_m1 = pcl.chr_ct - 1;
+        exclude_ct = pcl.exclude_ct;
+        max_extra_alt_ct = pcl.max_extra_alt_ct;
+        max_allele_slen = pcl.max_allele_slen;
+        if (pcl.max_variant_id_slen > max_variant_id_slen) {
+          max_variant_id_slen = pcl.max_variant_id_slen;
+        }
+        max_filter_slen = pcl.max_filter_slen;
+        if (info_col_present && (pcl.info_slen > info_reload_slen)) {
+          info_reload_slen = pcl.info_slen;
+        }
+        at_least_one_npass_filter = pcl.at_least_one_npass_filter;
+        if (pcl.at_least_one_nzero_cm) {
+          at_least_one_nzero_cm = 1;
+          cms_start_block = 0;
+        }
+        vpos_sortstatus = pcl.vpos_sortstatus;
+        logprintfww("--pvar-cache: Variant data loaded from %s.\n", pvar_cache_fname);
+        goto LoadPvar_cache_loaded;
+      }
+      ZeroWArr(kChrMaskWords, loaded_chr_mask);
+    }
+
     if (IsEolnKns(*line_start)) {
       ++line_iter;
       ++line_idx;
@@ -1356,6 +2387,35 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       line_iter = line_start;
     }
     for (; TextGetUnsafe2(&pvar_txs, &line_iter); ++line_iter, ++line_idx) {
+      if (lexed_line_idx == lex_ctx.cur_line_ct) {
+        // Collect the next batch of complete lines from the current buffer,
+        // stopping early at a blank line (which TextGetUnsafe2() will then
+        // handle), and lex them.
+        const char* consume_stop = TextConsumeStop(&pvar_txs);
+        char* scan_iter = line_iter;
+        uint32_t cur_line_ct = 0;
+        while (1) {
+          lexed_lines[cur_line_ct++].line_start = scan_iter;
+          scan_iter = AdvPastDelim(scan_iter, '\n');
+          if ((cur_line_ct == kLoadPvarLexBatchSize) || (scan_iter == consume_stop)) {
+            break;
+          }
+          scan_iter = FirstNonTspace(scan_iter);
+          if (IsEolnKns(*scan_iter)) {
+            break;
+          }
+        }
+        lex_ctx.cur_line_ct = cur_line_ct;
+        if (lex_thread_ct > 1) {
+          if (unlikely(SpawnThreads(&tg))) {
+            goto LoadPvar_ret_THREAD_CREATE_FAIL;
+          }
+        }
+        LoadPvarLexLines(&lex_ctx, 0, cur_line_ct / lex_thread_ct);
+        JoinThreads0(&tg);
+        lexed_line_idx = 0;
+      }
+      const PvarLexedLine* lexp = &(lexed_lines[lexed_line_idx++]);
       if (unlikely(line_iter[0] == '#')) {
         snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of %s starts with a '#'. (This is only permitted before the first nonheader line, and if a #CHROM header line is present it must denote the end of the header block.)\n", line_idx, pvarname);
         goto LoadPvar_ret_MALFORMED_INPUT_WW;
@@ -1415,15 +2475,18 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           tmp_alloc_base = R_CAST(unsigned char*, &(cur_chr_idxs[kLoadPvarBlockSize]));
         }
       }
-      char* linebuf_iter = CurTokenEnd(line_iter);
+      char* linebuf_iter = lexp->chr_end;
       // #CHROM
       if (unlikely(*linebuf_iter == '\n')) {
         goto LoadPvar_ret_MISSING_TOKENS;
       }
-      uint32_t cur_chr_code;
-      reterr = GetOrAddChrCodeDestructive(".pvar file", line_idx, prohibit_extra_chrs, line_iter, linebuf_iter, cip, &cur_chr_code);
-      if (unlikely(reterr)) {
-        goto LoadPvar_ret_1;
+      uint32_t cur_chr_code = lexp->chr_code;
+      if (IsI32Neg(cur_chr_code)) {
+        // new nonstandard code (or an invalid one)
+        reterr = GetOrAddChrCodeDestructive(".pvar file", line_idx, prohibit_extra_chrs, line_iter, linebuf_iter, cip, &cur_chr_code);
+        if (unlikely(reterr)) {
+          goto LoadPvar_ret_1;
+        }
       }
       if (merge_par) {
         if (cur_chr_code == par2_code) {
@@ -1494,16 +2557,15 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       // this should become common
       cur_allele_idxs[variant_idx_lowbits] = allele_storage_iter - allele_storage;
 
-      char* token_ptrs[8];
-      uint32_t token_slens[8];
+      char* const* token_ptrs = lexp->token_ptrs;
+      const uint32_t* token_slens = lexp->token_slens;
       uint32_t extra_alt_ct;
       if (IsSet(chr_mask, cur_chr_code) || info_pr_exists) {
-        linebuf_iter = TokenLex(linebuf_iter, col_types, col_skips, relevant_postchr_col_ct, token_ptrs, token_slens);
-        if (unlikely(!linebuf_iter)) {
+        if (unlikely(!lexp->line_end)) {
           goto LoadPvar_ret_MISSING_TOKENS;
         }
 
-        extra_alt_ct = CountByte(token_ptrs[3], ',', token_slens[3]);
+        extra_alt_ct = lexp->extra_alt_ct;
         if (extra_alt_ct > max_extra_alt_ct) {
           if (extra_alt_ct >= kPglMaxAltAlleleCt) {
             logerrprintfww("Error: Too many ALT alleles on line %" PRIuPTR " of %s. (This " PROG_NAME_STR " build is limited to " PGL_MAX_ALT_ALLELE_CT_STR ".)\n", line_idx, pvarname);
@@ -1513,60 +2575,38 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           max_extra_alt_ct = extra_alt_ct;
         }
 
-        // It is possible for the info_token[info_slen] assignment below to
-        // clobber the line terminator, so we advance line_iter to eoln here
-        // and never reference it again before the next line.
-        line_iter = AdvToDelim(linebuf_iter, '\n');
+        // The INFO token may have been null-terminated in place, clobbering
+        // the line terminator; lexp->line_end was saved before that.
+        line_iter = lexp->line_end;
+        const PvarLexFlags lex_flags = lexp->flags;
         if (info_col_present) {
           const uint32_t info_slen = token_slens[6];
           if (info_slen > info_reload_slen) {
             info_reload_slen = info_slen;
           }
-          char* info_token = token_ptrs[6];
-          info_token[info_slen] = '\0';
           if (info_pr_exists) {
             // always load all nonref_flags entries so (i) --ref-from-fa +
             // --make-just-pvar works and (ii) they can be compared against
             // the .pgen.
-            if ((memequal_sk(info_token, "PR") && ((info_slen == 2) || (info_token[2] == ';'))) || memequal_sk(&(info_token[S_CAST(int32_t, info_slen) - 3]), ";PR")) {
+            if (lex_flags & kfPvarLexNonref) {
               SetBit(variant_idx_lowbits, cur_nonref_flags);
-            } else {
-              const char* first_info_end = strchr(info_token, ';');
-              if (first_info_end && strstr(first_info_end, ";PR;")) {
-                SetBit(variant_idx_lowbits, cur_nonref_flags);
-              }
             }
             if (!IsSet(chr_mask, cur_chr_code)) {
               goto LoadPvar_skip_variant;
             }
           }
-          if (info_existp) {
-            if (!InfoExistCheck(info_token, info_existp)) {
-              goto LoadPvar_skip_variant;
-            }
-          }
-          if (info_nonexistp) {
-            if (!InfoNonexistCheck(info_token, info_nonexistp)) {
-              goto LoadPvar_skip_variant;
-            }
-          }
-          if (info_keep.prekey) {
-            if (!InfoConditionSatisfied(info_token, &info_keep)) {
-              goto LoadPvar_skip_variant;
-            }
-          }
-          if (info_remove.prekey) {
-            if (InfoConditionSatisfied(info_token, &info_remove)) {
-              goto LoadPvar_skip_variant;
-            }
+          // --require-info, --require-no-info, --extract-if-info,
+          // --exclude-if-info
+          if (lex_flags & kfPvarLexInfoSkip) {
+            goto LoadPvar_skip_variant;
           }
         }
         // POS
-        int32_t cur_bp;
-        if (unlikely(ScanIntAbsDefcap(token_ptrs[0], &cur_bp))) {
+        if (unlikely(lex_flags & kfPvarLexBpErr)) {
           snprintf(g_logbuf, kLogbufSize, "Error: Invalid bp coordinate on line %" PRIuPTR " of %s.\n", line_idx, pvarname);
           goto LoadPvar_ret_MALFORMED_INPUT_WW;
         }
+        const int32_t cur_bp = lexp->bp;
 
         if (cur_bp < 0) {
           goto LoadPvar_skip_variant;
@@ -1574,13 +2614,12 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
 
         // QUAL
         if (load_qual_col) {
-          const char* qual_token = token_ptrs[4];
-          if ((qual_token[0] != '.') || (qual_token[1] > ' ')) {
-            float cur_qual;
-            if (unlikely(ScanFloatAllowInf(qual_token, &cur_qual))) {
+          if (lex_flags & kfPvarLexQualPresent) {
+            if (unlikely(lex_flags & kfPvarLexQualErr)) {
               snprintf(g_logbuf, kLogbufSize, "Error: Invalid QUAL value on line %" PRIuPTR " of %s.\n", line_idx, pvarname);
               goto LoadPvar_ret_MALFORMED_INPUT_WW;
             }
+            const float cur_qual = lexp->qual;
             if ((load_qual_col & 1) && (cur_qual < var_min_qual)) {
               goto LoadPvar_skip_variant;
             }
@@ -1815,15 +2854,15 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
 
         // CM
         if (cm_col_present) {
-          const char* cm_token = token_ptrs[7];
-          if ((cm_token[0] != '0') || (cm_token[1] > ' ')) {
-            double cur_cm;
-            if (unlikely(!ScantokDouble(cm_token, &cur_cm))) {
+          if (lex_flags & kfPvarLexCmPresent) {
+            if (unlikely(lex_flags & kfPvarLexCmErr)) {
               snprintf(g_logbuf, kLogbufSize, "Error: Invalid centimorgan position on line %" PRIuPTR " of %s.\n", line_idx, pvarname);
               goto LoadPvar_ret_MALFORMED_INPUT_WW;
             }
+            const double cur_cm = lexp->cm;
             if (cur_cm < last_cm) {
               vpos_sortstatus |= kfUnsortedVarCm;
+              SetBit(chrs_encountered_m1, cm_unsorted_runs);
             } else {
               last_cm = cur_cm;
             }
@@ -1851,7 +2890,12 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           }
         }
       } else {
-        {
+        if (lexp->line_end) {
+          extra_alt_ct = lexp->extra_alt_ct;
+          line_iter = lexp->line_end;
+        } else {
+          // Line has fewer columns than the header promised, but we only need
+          // ALT here.
           // linebuf_iter guaranteed to be at '\t' after chromosome code
           char* alt_col_start = NextTokenMult(linebuf_iter, alt_col_idx);
           if (unlikely(!alt_col_start)) {
@@ -1924,6 +2968,12 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
         goto LoadPvar_ret_INCONSISTENT_INPUT;
       }
     }
+    if (pvar_cache_ok && (!exclude_ct) && (!is_split_chr) && raw_variant_ct) {
+      PvarBlockLayout layout;
+      InitPvarBlockLayout(load_qual_col > 1, load_filter_col > 1, info_pr_exists, &layout);
+      WritePvarCache(pvar_cache_fname, &pvar_cache_key, cip, cm_unsorted_runs, &layout, g_bigstack_end, allele_storage, tmp_alloc_end, strings_end, tmp_alloc_base, tmp_alloc_end, allele_storage_iter - allele_storage, raw_variant_ct, chrs_encountered_m1 + 1, load_qual_col > 1, load_filter_col > 1, at_least_one_npass_filter, info_pr_exists, cms_start_block, info_col_present? info_reload_slen : UINT32_MAX);
+    }
+  LoadPvar_cache_loaded:
     *max_variant_id_slen_ptr = max_variant_id_slen;
     *max_allele_ct_ptr = max_extra_alt_ct + 2;
     *max_allele_slen_ptr = max_allele_slen;
@@ -2213,8 +3263,12 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     logerrprintfww("Error: Line %" PRIuPTR " of %s has a nonmissing ALT allele code that's identical to the REF allele code.\n", line_idx, pvarname);
     reterr = kPglRetMalformedInput;
     break;
+  LoadPvar_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
   }
  LoadPvar_ret_1:
+  CleanupThreads(&tg);
   CleanupTextStream2(pvarname, &pvar_txs, &reterr);
   if (reterr) {
     BigstackDoubleReset(bigstack_mark, bigstack_end_mark);